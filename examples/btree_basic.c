@@ -103,10 +103,10 @@ int main() {
     fi_btree_node *max_node = fi_btree_find_max(tree->root);
     
     if (min_node) {
-        printf("最小值: %d\n", *(int*)min_node->data);
+        printf("最小值: %d\n", *(int*)FI_BTREE_NODE_DATA(min_node));
     }
     if (max_node) {
-        printf("最大值: %d\n", *(int*)max_node->data);
+        printf("最大值: %d\n", *(int*)FI_BTREE_NODE_DATA(max_node));
     }
     
     // 6. 树的遍历
@@ -162,10 +162,10 @@ int main() {
         fi_btree_node *predecessor = fi_btree_predecessor(node_40);
         
         if (successor) {
-            printf("40 的后继: %d\n", *(int*)successor->data);
+            printf("40 的后继: %d\n", *(int*)FI_BTREE_NODE_DATA(successor));
         }
         if (predecessor) {
-            printf("40 的前驱: %d\n", *(int*)predecessor->data);
+            printf("40 的前驱: %d\n", *(int*)FI_BTREE_NODE_DATA(predecessor));
         }
     }
     
@@ -0,0 +1,191 @@
+#include "test_support.h"
+
+#define ROW_COUNT 4000
+#define REGIONS 7
+
+/* Aggregates checked against the same sums computed in C, with GROUP BY
+ * answered both through the hash table (no index) and by streaming rows in
+ * index order (B-tree index on the group column). */
+
+static bool qty_null(int i) { return i % 9 == 0; }
+static int64_t qty_of(int i) { return (i * 31) % 200 - 50; }
+static double price_of(int i) { return (double)(i % 80) * 0.25; }
+static int region_of(int i) { return (i * 3) % REGIONS; }
+
+typedef struct {
+    int64_t rows, qty_count, qty_sum, qty_min, qty_max;
+} expected_group_t;
+
+static void expected_groups(expected_group_t *groups) {
+    memset(groups, 0, REGIONS * sizeof(expected_group_t));
+    for (int i = 0; i < ROW_COUNT; i++) {
+        expected_group_t *g = &groups[region_of(i)];
+        g->rows++;
+        if (qty_null(i)) continue;
+
+        int64_t qty = qty_of(i);
+        if (g->qty_count == 0 || qty < g->qty_min) g->qty_min = qty;
+        if (g->qty_count == 0 || qty > g->qty_max) g->qty_max = qty;
+        g->qty_count++;
+        g->qty_sum += qty;
+    }
+}
+
+/* One row per region, in any order, holding the expected aggregates */
+static void check_grouped(rdb_database_t *db) {
+    expected_group_t groups[REGIONS];
+    expected_groups(groups);
+
+    test_result_t *result = test_query(db, "SELECT region, COUNT(*), COUNT(qty), SUM(qty), MIN(qty), MAX(qty) "
+                                           "FROM sales GROUP BY region");
+    assert(result != NULL && result->rows == REGIONS && result->columns == 6);
+    test_sort_result(result);
+    for (size_t r = 0; r < REGIONS; r++) {
+        const expected_group_t *g = &groups[r];
+        assert(test_int(result, r, 0) == (int64_t)r);
+        assert(test_int(result, r, 1) == g->rows);
+        assert(test_int(result, r, 2) == g->qty_count);
+        assert(test_int(result, r, 3) == g->qty_sum);
+        assert(test_int(result, r, 4) == g->qty_min);
+        assert(test_int(result, r, 5) == g->qty_max);
+    }
+    test_result_free(result);
+}
+
+static void check_totals(rdb_database_t *db) {
+    int64_t rows = 0, count = 0, sum = 0;
+    double price_sum = 0.0;
+    for (int i = 0; i < ROW_COUNT; i++) {
+        rows++;
+        price_sum += price_of(i);
+        if (qty_null(i)) continue;
+        count++;
+        sum += qty_of(i);
+    }
+
+    test_result_t *result = test_query(db, "SELECT COUNT(*), COUNT(qty), SUM(qty), AVG(qty), SUM(price) FROM sales");
+    assert(result != NULL && result->rows == 1);
+    assert(test_int(result, 0, 0) == rows);
+    assert(test_int(result, 0, 1) == count);
+    assert(test_int(result, 0, 2) == sum);
+    assert(test_value(result, 0, 3)->type == RDB_TYPE_FLOAT);
+    assert(test_value(result, 0, 3)->data.float_val == (double)sum / (double)count);
+    assert(test_value(result, 0, 4)->data.float_val == price_sum);
+    test_result_free(result);
+
+    /* No input: COUNT gives 0, the others NULL */
+    result = test_query(db, "SELECT COUNT(*), COUNT(qty), SUM(qty), MIN(qty), AVG(price) FROM sales WHERE id < 0");
+    assert(result != NULL && result->rows == 1);
+    assert(test_int(result, 0, 0) == 0 && test_int(result, 0, 1) == 0);
+    for (size_t c = 2; c < 5; c++) assert(test_value(result, 0, c)->is_null);
+    test_result_free(result);
+
+    result = test_query(db, "SELECT region, COUNT(*) FROM sales WHERE id < 0 GROUP BY region");
+    assert(result != NULL && result->rows == 0);
+    test_result_free(result);
+}
+
+/* SUM of INT continues in FLOAT once it would overflow */
+static void check_overflow(rdb_database_t *db) {
+    assert(test_exec(db, "CREATE TABLE big (v INT)") == 0);
+    /* 2^62, which the parser reads exactly */
+    for (int i = 0; i < 3; i++) assert(test_exec(db, "INSERT INTO big VALUES (4611686018427387904)") == 0);
+
+    test_result_t *result = test_query(db, "SELECT SUM(v), MAX(v) FROM big");
+    assert(result != NULL && result->rows == 1);
+    assert(test_value(result, 0, 0)->type == RDB_TYPE_FLOAT);
+    assert(test_value(result, 0, 0)->data.float_val == 3.0 * 4611686018427387904.0);
+    assert(test_int(result, 0, 1) == INT64_C(4611686018427387904));
+    test_result_free(result);
+}
+
+/* GROUP BY k on `mixed` (streamed once k is indexed) and on `mixed_plain`
+ * (always hashed) give the same groups */
+static void expect_same_groups(rdb_database_t *db, size_t groups) {
+    test_result_t *streamed = test_query(db, "SELECT k, COUNT(*), SUM(v) FROM mixed GROUP BY k");
+    test_result_t *hashed = test_query(db, "SELECT k, COUNT(*), SUM(v) FROM mixed_plain GROUP BY k");
+    assert(streamed != NULL && hashed != NULL && hashed->rows == groups);
+    test_sort_result(streamed);
+    test_sort_result(hashed);
+    assert(test_same_result(streamed, hashed));
+    test_result_free(streamed);
+    test_result_free(hashed);
+}
+
+/* Keys that are equal as numbers group together whatever their type, keys
+ * that differ in a fraction do not, and values of another type than the
+ * column (indexed as NULL) never merge with the NULLs */
+static void check_mixed_keys(rdb_database_t *db) {
+    const char *keys[] = {"2", "2.5", "2", "2.0", "NULL", "10.7", "10", "-0.5", "NULL", "2.5"};
+    const char *tables[] = {"mixed", "mixed_plain"};
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "CREATE TABLE %s (k INT, v INT)", tables[t]) == 0);
+        for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES (%s, %zu)", tables[t], keys[i], i) == 0);
+        }
+    }
+    expect_same_groups(db, 6);
+
+    test_result_t *result = test_query(db, "SELECT COUNT(*), SUM(v) FROM mixed_plain WHERE k = 2");
+    assert(result != NULL && test_int(result, 0, 0) == 3 && test_int(result, 0, 1) == 5);
+    test_result_free(result);
+
+    assert(test_exec(db, "CREATE INDEX idx_mixed_k ON mixed (k)") == 0);
+    rdb_index_t *index = rdb_get_table_index(rdb_get_table(db, "mixed"), "idx_mixed_k");
+    assert(index != NULL && index->misfit_count == 0);
+    expect_same_groups(db, 6);
+
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "INSERT INTO %s VALUES ('x', 100)", tables[t]) == 0);
+        assert(test_exec(db, "INSERT INTO %s VALUES (NULL, 101)", tables[t]) == 0);
+        assert(test_exec(db, "INSERT INTO %s VALUES ('x', 102)", tables[t]) == 0);
+    }
+    assert(index->misfit_count == 2);
+    expect_same_groups(db, 7);
+
+    for (int t = 0; t < 2; t++) assert(test_exec(db, "UPDATE %s SET k = 7 WHERE v = 102", tables[t]) == 1);
+    assert(index->misfit_count == 1);
+    expect_same_groups(db, 8);
+
+    for (int t = 0; t < 2; t++) assert(test_exec(db, "DELETE FROM %s WHERE v >= 100", tables[t]) == 3);
+    assert(index->misfit_count == 0);
+    expect_same_groups(db, 6);
+}
+
+int main() {
+    printf("=== FI RDB Aggregate Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("aggregate_test");
+    assert(test_exec(db, "CREATE TABLE sales (id INT, region INT, qty INT, price FLOAT)") == 0);
+    for (int i = 0; i < ROW_COUNT; i++) {
+        char qty[32];
+        snprintf(qty, sizeof(qty), qty_null(i) ? "NULL" : "%lld", (long long)qty_of(i));
+        assert(test_exec(db, "INSERT INTO sales VALUES (%d, %d, %s, %.2f)", i, region_of(i), qty, price_of(i)) == 0);
+    }
+
+    printf("Checking hash aggregation...\n");
+    check_totals(db);
+    check_grouped(db);
+
+    /* The same groups, streamed in index order */
+    printf("Checking streaming aggregation...\n");
+    test_result_t *hashed = test_query(db, "SELECT region, SUM(price), MIN(price), AVG(qty) FROM sales GROUP BY region");
+    assert(test_exec(db, "CREATE INDEX idx_sales_region ON sales (region)") == 0);
+    check_grouped(db);
+    test_result_t *streamed = test_query(db, "SELECT region, SUM(price), MIN(price), AVG(qty) FROM sales GROUP BY region");
+    assert(hashed != NULL && streamed != NULL);
+    test_sort_result(hashed);
+    test_sort_result(streamed);
+    assert(test_same_result(hashed, streamed));
+    test_result_free(hashed);
+    test_result_free(streamed);
+
+    printf("Checking mixed keys...\n");
+    check_mixed_keys(db);
+
+    check_overflow(db);
+    rdb_destroy_database(db);
+
+    printf("\nAggregate test PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "test_support.h"
+#include "persistence.h"
+#include <math.h>
+
+#define ROW_COUNT 20000
+#define DATA_DIR "./analyze_test_data"
+
+/* ANALYZE statistics against the known distribution of the data: id is
+ * unique, g is skewed (half of the rows hold 0), n is mostly NULL. The
+ * estimates may be off by the sketch and sampling error, not more. */
+
+static int g_of(int i) { return i % 2 == 0 ? 0 : i % 20; }
+static bool n_null(int i) { return i % 4 != 0; }
+
+static bool near(double value, double expected, double tolerance) {
+    return fabs(value - expected) <= tolerance;
+}
+
+static double estimate(rdb_table_t *table, const char *where) {
+    char sql[256];
+    snprintf(sql, sizeof(sql), "SELECT * FROM a WHERE %s", where);
+    sql_parser_t *parser = sql_parser_create(sql);
+    assert(parser != NULL);
+    rdb_statement_t *stmt = sql_parse_statement(parser);
+    assert(stmt != NULL && stmt->where_conditions != NULL);
+
+    double rows = rdb_stats_estimate_rows(table, stmt->where_conditions);
+    sql_statement_free(stmt);
+    sql_parser_destroy(parser);
+    return rows;
+}
+
+static void check_stats(rdb_table_t *table) {
+    const rdb_table_stats_t *stats = table->stats;
+    assert(stats != NULL && stats->row_count == ROW_COUNT && stats->column_count == 4);
+
+    /* id: unique, no NULLs, histogram spans the values */
+    const rdb_column_stats_t *id = &stats->columns[0];
+    assert(id->null_fraction == 0.0);
+    assert(near(id->distinct_count, ROW_COUNT, ROW_COUNT * 0.05));
+    assert(id->bound_count > 2);
+    for (size_t b = 1; b < id->bound_count; b++) {
+        bool comparable = true;
+        assert(rdb_condition_compare(id->bounds[b - 1], id->bounds[b], &comparable) <= 0 && comparable);
+    }
+
+    /* g: 0 is by far the most common value */
+    const rdb_column_stats_t *g = &stats->columns[1];
+    assert(near(g->distinct_count, 11, 1));
+    assert(g->mcv_count > 0 && g->mcv_values[0]->data.int_val == 0);
+    assert(near(g->mcv_fractions[0], 0.5, 0.02));
+
+    /* n: NULLs counted exactly */
+    assert(stats->columns[2].null_fraction == 0.75);
+}
+
+static void check_estimates(rdb_table_t *table) {
+    assert(near(estimate(table, "id < 5000"), 5000, 500));
+    assert(near(estimate(table, "id >= 19000"), 1000, 500));
+    assert(near(estimate(table, "g = 0"), ROW_COUNT / 2, 500));
+    assert(near(estimate(table, "g = 7"), ROW_COUNT / 20, 300));
+    assert(near(estimate(table, "n IS NULL"), ROW_COUNT * 0.75, 1));
+    assert(near(estimate(table, "g = 0 AND id < 10000"), ROW_COUNT / 4, 1000));
+    assert(near(estimate(table, "id < 2000 OR id >= 18000"), 4000, 800));
+}
+
+int main() {
+    printf("=== FI RDB Analyze Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("analyze_test");
+    assert(test_exec(db, "CREATE TABLE a (id INT, g INT, n INT, s VARCHAR(8))") == 0);
+    assert(test_exec(db, "CREATE TABLE a_plain (id INT, g INT, n INT, s VARCHAR(8))") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_a_g ON a (g)") == 0);
+    for (int i = 0; i < ROW_COUNT; i++) {
+        char n[16];
+        snprintf(n, sizeof(n), n_null(i) ? "NULL" : "%d", i);
+        const char *tables[] = {"a", "a_plain"};
+        for (int t = 0; t < 2; t++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES (%d, %d, %s, 's%d')", tables[t], i, g_of(i), n,
+                             i % 300) == 0);
+        }
+    }
+
+    rdb_table_t *table = rdb_get_table(db, "a");
+    assert(table->stats == NULL);
+    assert(rdb_stats_estimate_rows(table, NULL) == ROW_COUNT);
+
+    printf("Checking statistics...\n");
+    assert(test_exec(db, "ANALYZE a") == 0);
+    assert(rdb_get_table(db, "a_plain")->stats == NULL);
+    check_stats(table);
+    check_estimates(table);
+    assert(rdb_analyze(db, NULL) == 2);
+
+    /* Whether the planner takes the index or scans, the rows are the same */
+    printf("Checking plans...\n");
+    test_expect_same(db, "SELECT * FROM a WHERE g = 0", "SELECT * FROM a_plain WHERE g = 0");
+    test_expect_same(db, "SELECT * FROM a WHERE g = 7", "SELECT * FROM a_plain WHERE g = 7");
+    test_expect_same(db, "SELECT * FROM a WHERE g = 0 AND id < 100", "SELECT * FROM a_plain WHERE g = 0 AND id < 100");
+
+    /* Writes leave the statistics alone */
+    assert(test_exec(db, "DELETE FROM a WHERE id >= 10000") > 0);
+    assert(table->stats->row_count == ROW_COUNT);
+
+    printf("Checking persistence...\n");
+    system("rm -rf " DATA_DIR);
+    rdb_persistence_manager_t *pm = rdb_persistence_create(DATA_DIR, RDB_PERSISTENCE_FULL);
+    assert(pm != NULL);
+    assert(rdb_persistence_init(pm) == 0);
+    assert(rdb_persistence_save_database(pm, db) == 0);
+    rdb_destroy_database(db);
+
+    db = rdb_create_database("analyze_test");
+    assert(db != NULL);
+    assert(rdb_persistence_load_database(pm, db) == 0);
+    check_stats(rdb_get_table(db, "a"));
+
+    rdb_persistence_destroy(pm);
+    rdb_destroy_database(db);
+    system("rm -rf " DATA_DIR);
+
+    printf("\nAnalyze test PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "test_support.h"
+
+#define ROW_COUNT 3000
+#define QUERY_COUNT 400
+
+/* Batched WHERE evaluation must select exactly the rows the row-at-a-time
+ * evaluator does. Random WHERE clauses over INT, FLOAT, BOOLEAN and
+ * VARCHAR columns, with NULLs and values of other types than their
+ * column's, run through rdb_find_matching_rows() and are checked against
+ * rdb_row_matches_conditions() over every row. */
+
+static uint64_t rng_state = 88172645463325252ULL;
+
+static unsigned next_random(unsigned bound) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned)(rng_state % bound);
+}
+
+static void insert_row(rdb_database_t *db, int i) {
+    char qty[32], price[32], flag[8], name[16];
+
+    if (i % 7 == 0) snprintf(qty, sizeof(qty), "NULL");
+    else if (i % 50 == 1) snprintf(qty, sizeof(qty), "%d.5", i % 200 - 100);
+    else if (i % 97 == 3) snprintf(qty, sizeof(qty), "'many'");
+    else snprintf(qty, sizeof(qty), "%d", i % 200 - 100);
+
+    if (i % 11 == 0) snprintf(price, sizeof(price), "NULL");
+    else if (i % 40 == 2) snprintf(price, sizeof(price), "%d", i % 100);
+    else snprintf(price, sizeof(price), "%.2f", (double)(i % 400) * 0.25);
+
+    snprintf(flag, sizeof(flag), "%s", i % 13 == 0 ? "NULL" : i % 3 == 0 ? "TRUE" : "FALSE");
+
+    if (i % 17 == 0) snprintf(name, sizeof(name), "NULL");
+    else snprintf(name, sizeof(name), "'n%d'", i % 30);
+
+    assert(test_exec(db, "INSERT INTO t VALUES (%d, %s, %s, %s, %s)", i, qty, price, flag, name) == 0);
+}
+
+/* A random "column op literal" predicate */
+static void random_predicate(char *buffer, size_t size) {
+    static const char *columns[] = {"id", "qty", "price", "flag", "name", "missing"};
+    static const char *operators[] = {"=", "!=", "<", ">", "<=", ">="};
+
+    const char *column = columns[next_random(6)];
+    if (next_random(8) == 0) {
+        snprintf(buffer, size, "%s IS NULL", column);
+        return;
+    }
+
+    char literal[32];
+    switch (next_random(6)) {
+        case 0: snprintf(literal, sizeof(literal), "%d", (int)next_random(240) - 120); break;
+        case 1: snprintf(literal, sizeof(literal), "%d.5", (int)next_random(200) - 100); break;
+        case 2: snprintf(literal, sizeof(literal), "%.2f", (double)next_random(400) * 0.25); break;
+        case 3: snprintf(literal, sizeof(literal), "%s", next_random(2) ? "TRUE" : "FALSE"); break;
+        case 4: snprintf(literal, sizeof(literal), "'n%d'", (int)next_random(30)); break;
+        default: snprintf(literal, sizeof(literal), "%d", (int)next_random(ROW_COUNT)); break;
+    }
+    snprintf(buffer, size, "%s %s %s", column, operators[next_random(6)], literal);
+}
+
+static void check_query(rdb_table_t *table, const char *where) {
+    char sql[512];
+    snprintf(sql, sizeof(sql), "SELECT * FROM t WHERE %s", where);
+    sql_parser_t *parser = sql_parser_create(sql);
+    assert(parser != NULL);
+    rdb_statement_t *stmt = sql_parse_statement(parser);
+    assert(stmt != NULL && stmt->where_conditions != NULL);
+
+    fi_array *matches = rdb_find_matching_rows(table, stmt->where_conditions);
+    assert(matches != NULL);
+
+    size_t expected = 0;
+    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (row->deleted || !rdb_row_matches_conditions(table, row, stmt->where_conditions)) continue;
+
+        /* Same rows, in table order */
+        if (expected >= fi_array_count(matches) ||
+            *(rdb_row_t**)fi_array_get(matches, expected) != row) {
+            printf("Mismatch at row %zu of '%s'\n", row->row_id, where);
+            fflush(stdout);
+            assert(false);
+        }
+        expected++;
+    }
+    assert(expected == fi_array_count(matches));
+
+    fi_array_destroy(matches);
+    sql_statement_free(stmt);
+    sql_parser_destroy(parser);
+}
+
+int main() {
+    printf("=== FI RDB Batch Filter Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("batch_test");
+    assert(test_exec(db, "CREATE TABLE t (id INT, qty INT, price FLOAT, flag BOOLEAN, name VARCHAR(16))") == 0);
+    for (int i = 0; i < ROW_COUNT; i++) insert_row(db, i);
+
+    /* Tombstones in the middle of batches */
+    assert(test_exec(db, "DELETE FROM t WHERE price > 90 AND price < 91") >= 0);
+
+    rdb_table_t *table = rdb_get_table(db, "t");
+    static const char *fixed[] = {
+        "qty = 5", "qty > 10.5", "qty != 'many'", "price <= 50", "price = 12",
+        "flag = TRUE", "flag IS NULL", "name = 'n3' OR qty < -50", "missing = 1",
+        "qty < 0 AND price > 10 OR flag = FALSE AND name != 'n1'",
+    };
+    for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) check_query(table, fixed[i]);
+
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        char where[400] = "";
+        int predicates = 1 + (int)next_random(4);
+        for (int p = 0; p < predicates; p++) {
+            char predicate[96];
+            random_predicate(predicate, sizeof(predicate));
+            if (p > 0) strcat(where, next_random(3) == 0 ? " OR " : " AND ");
+            strcat(where, predicate);
+        }
+        check_query(table, where);
+    }
+    printf("%d random WHERE clauses agree\n", QUERY_COUNT);
+
+    rdb_destroy_database(db);
+
+    printf("\nBatch filter test PASSED!\n");
+    return 0;
+}
@@ -534,12 +534,10 @@ int cached_rdb_insert_row(cached_rdb_t *cached_rdb, const char *table_name, fi_a
     
     /* Get the inserted row */
     rdb_table_t *table = rdb_get_table(cached_rdb->db, table_name);
-    if (table && fi_array_count(table->rows) > 0) {
-        rdb_row_t **last_row_ptr = (rdb_row_t**)fi_array_get(table->rows, fi_array_count(table->rows) - 1);
-        if (last_row_ptr && *last_row_ptr) {
-            /* Cache the row data */
-            cached_rdb_cache_row_data(cached_rdb, table_name, (*last_row_ptr)->row_id, *last_row_ptr);
-        }
+    rdb_row_t *row = table ? rdb_table_find_row(table, table->next_row_id - 1) : NULL;
+    if (row) {
+        /* Cache the row data */
+        cached_rdb_cache_row_data(cached_rdb, table_name, row->row_id, row);
     }
     
     pthread_rwlock_unlock(&cached_rdb->rwlock);
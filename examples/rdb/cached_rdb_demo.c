@@ -1,4 +1,5 @@
 #include "cached_rdb.h"
+#include "sql_parser.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,6 +20,7 @@ rdb_column_t* create_column(const char *name, rdb_data_type_t type, bool primary
     column->nullable = nullable;
     column->default_value[0] = '\0';
     column->is_foreign_key = false;
+    column->dictionary = false;
     column->foreign_table[0] = '\0';
     column->foreign_column[0] = '\0';
     
@@ -53,6 +55,40 @@ fi_array* create_values(int64_t id, const char *name, int age, double salary) {
 }
 
 /* Performance test function */
+/* Helper function to create the WHERE condition "id = <id>" */
+fi_array* create_id_condition(int64_t id) {
+    fi_array *conditions = fi_array_create(1, sizeof(sql_where_condition_t*));
+    if (!conditions) return NULL;
+    
+    sql_where_condition_t *condition = malloc(sizeof(sql_where_condition_t));
+    if (!condition) {
+        fi_array_destroy(conditions);
+        return NULL;
+    }
+    
+    strcpy(condition->column_name, "id");
+    condition->operator = SQL_OP_EQUAL;
+    condition->value = rdb_create_int_value(id);
+    condition->logical_connector[0] = '\0';
+    condition->expr = NULL;
+    fi_array_push(conditions, &condition);
+    return conditions;
+}
+
+/* Helper function to free a WHERE condition list */
+void free_conditions(fi_array *conditions) {
+    if (!conditions) return;
+    
+    for (size_t i = 0; i < fi_array_count(conditions); i++) {
+        sql_where_condition_t *condition = *(sql_where_condition_t**)fi_array_get(conditions, i);
+        if (condition) {
+            rdb_value_free(condition->value);
+            free(condition);
+        }
+    }
+    fi_array_destroy(conditions);
+}
+
 void performance_test(cached_rdb_t *cached_rdb) {
     printf("\n=== Performance Test ===\n");
     
@@ -89,14 +125,8 @@ void performance_test(cached_rdb_t *cached_rdb) {
     
     for (int i = 0; i < num_selects; i++) {
         /* Create where conditions for random employee */
-        fi_array *where_conditions = fi_array_create(1, sizeof(char*));
-        char condition[256];
         int random_id = (rand() % num_inserts) + 1;
-        sprintf(condition, "id = %d", random_id);
-        
-        char *condition_ptr = malloc(strlen(condition) + 1);
-        strcpy(condition_ptr, condition);
-        fi_array_push(where_conditions, &condition_ptr);
+        fi_array *where_conditions = create_id_condition(random_id);
         
         /* Select columns */
         fi_array *columns = fi_array_create(1, sizeof(char*));
@@ -108,9 +138,8 @@ void performance_test(cached_rdb_t *cached_rdb) {
         
         /* Clean up */
         if (result) fi_array_destroy(result);
-        free(condition_ptr);
         free(name_col);
-        fi_array_destroy(where_conditions);
+        free_conditions(where_conditions);
         fi_array_destroy(columns);
     }
     
@@ -143,12 +172,7 @@ void cache_hit_ratio_test(cached_rdb_t *cached_rdb) {
     /* First round - should be cache misses */
     printf("First round - accessing data (should be cache misses):\n");
     for (int i = 1; i <= 50; i++) {
-        fi_array *where_conditions = fi_array_create(1, sizeof(char*));
-        char condition[256];
-        sprintf(condition, "id = %d", i);
-        char *condition_ptr = malloc(strlen(condition) + 1);
-        strcpy(condition_ptr, condition);
-        fi_array_push(where_conditions, &condition_ptr);
+        fi_array *where_conditions = create_id_condition(i);
         
         fi_array *columns = fi_array_create(1, sizeof(char*));
         char *name_col = malloc(5);
@@ -158,21 +182,15 @@ void cache_hit_ratio_test(cached_rdb_t *cached_rdb) {
         fi_array *result = cached_rdb_select_rows(cached_rdb, "employees", columns, where_conditions);
         
         if (result) fi_array_destroy(result);
-        free(condition_ptr);
         free(name_col);
-        fi_array_destroy(where_conditions);
+        free_conditions(where_conditions);
         fi_array_destroy(columns);
     }
     
     /* Second round - should be cache hits */
     printf("Second round - accessing same data (should be cache hits):\n");
     for (int i = 1; i <= 50; i++) {
-        fi_array *where_conditions = fi_array_create(1, sizeof(char*));
-        char condition[256];
-        sprintf(condition, "id = %d", i);
-        char *condition_ptr = malloc(strlen(condition) + 1);
-        strcpy(condition_ptr, condition);
-        fi_array_push(where_conditions, &condition_ptr);
+        fi_array *where_conditions = create_id_condition(i);
         
         fi_array *columns = fi_array_create(1, sizeof(char*));
         char *name_col = malloc(5);
@@ -182,9 +200,8 @@ void cache_hit_ratio_test(cached_rdb_t *cached_rdb) {
         fi_array *result = cached_rdb_select_rows(cached_rdb, "employees", columns, where_conditions);
         
         if (result) fi_array_destroy(result);
-        free(condition_ptr);
         free(name_col);
-        fi_array_destroy(where_conditions);
+        free_conditions(where_conditions);
         fi_array_destroy(columns);
     }
 }
@@ -0,0 +1,130 @@
+#include "test_support.h"
+#include "persistence.h"
+
+#define ROW_COUNT 5000
+#define DATA_DIR "./columnar_test_data"
+
+/* Columnar scans and aggregates must answer exactly like the row store.
+ * The same rows go into a row table "r" and a columnar table "c",
+ * including NULLs and, in one row group, values of other types than their
+ * column's; every query then runs on both and the results are compared
+ * value by value. */
+
+static const char *queries[] = {
+    "SELECT * FROM %s",
+    "SELECT * FROM %s WHERE qty > 100",
+    "SELECT * FROM %s WHERE qty <= 0 AND flag = TRUE",
+    "SELECT * FROM %s WHERE price >= 500.5 OR qty IS NULL",
+    "SELECT * FROM %s WHERE flag IS NULL",
+    "SELECT * FROM %s WHERE qty = 2100.5",
+    "SELECT price, id FROM %s WHERE price < 100",
+    "SELECT name, qty FROM %s WHERE name = 'n42'",
+    "SELECT COUNT(*), COUNT(qty), SUM(qty), AVG(qty), MIN(qty), MAX(qty) FROM %s",
+    "SELECT SUM(price), AVG(price), MIN(price), MAX(price), COUNT(flag), MIN(name), MAX(name) FROM %s",
+    "SELECT COUNT(*), SUM(qty), MAX(price) FROM %s WHERE flag = TRUE",
+    "SELECT flag, COUNT(*), SUM(price) FROM %s GROUP BY flag",
+};
+
+#define QUERY_COUNT (sizeof(queries) / sizeof(queries[0]))
+
+static void compare_all(rdb_database_t *db, const char *phase) {
+    for (size_t q = 0; q < QUERY_COUNT; q++) {
+        char row_query[256], column_query[256];
+        snprintf(row_query, sizeof(row_query), queries[q], "r");
+        snprintf(column_query, sizeof(column_query), queries[q], "c");
+        test_expect_same(db, column_query, row_query);
+    }
+    printf("%s: %zu queries agree\n", phase, QUERY_COUNT);
+}
+
+/* Row group 2 (rows 2048-3071) holds FLOAT and string values in the INT
+ * column and INT values in the FLOAT column */
+static void insert_row(rdb_database_t *db, const char *table, int64_t i) {
+    bool mixed = i >= 2048 && i < 3072;
+    char qty[32], price[32], flag[8], name[16];
+
+    if (i % 7 == 0) snprintf(qty, sizeof(qty), "NULL");
+    else if (mixed && i % 50 == 1) snprintf(qty, sizeof(qty), "%lld.5", (long long)i);
+    else if (mixed && i % 97 == 3) snprintf(qty, sizeof(qty), "'many'");
+    else snprintf(qty, sizeof(qty), "%lld", (long long)((i * 37) % 1000 - 500));
+
+    if (i % 11 == 0) snprintf(price, sizeof(price), "NULL");
+    else if (mixed && i % 40 == 2) snprintf(price, sizeof(price), "%lld", (long long)i);
+    else snprintf(price, sizeof(price), "%.2f", (double)i * 0.25);
+
+    snprintf(flag, sizeof(flag), "%s", i % 13 == 0 ? "NULL" : i % 3 == 0 ? "TRUE" : "FALSE");
+
+    if (i % 17 == 0) snprintf(name, sizeof(name), "NULL");
+    else snprintf(name, sizeof(name), "'n%d'", (int)(i % 100));
+
+    assert(test_exec(db, "INSERT INTO %s VALUES (%lld, %s, %s, %s, %s)", table, (long long)i,
+                     qty, price, flag, name) == 0);
+}
+
+static void insert_rows(rdb_database_t *db, int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+        insert_row(db, "r", i);
+        insert_row(db, "c", i);
+    }
+}
+
+static void run_on_both(rdb_database_t *db, const char *format) {
+    assert(test_exec(db, format, "r") >= 0);
+    assert(test_exec(db, format, "c") >= 0);
+}
+
+int main() {
+    printf("=== FI RDB Columnar Scan Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("columnar_test");
+    assert(test_exec(db, "CREATE TABLE r (id INT, qty INT, price FLOAT, flag BOOLEAN, name VARCHAR(32))") == 0);
+    assert(test_exec(db, "CREATE TABLE c (id INT, qty INT, price FLOAT, flag BOOLEAN, name VARCHAR(32)) "
+                         "USING COLUMNAR") == 0);
+
+    insert_rows(db, 0, ROW_COUNT);
+    rdb_table_t *c = rdb_get_table(db, "c");
+    assert(c->column_store != NULL && c->column_store->ordered);
+    compare_all(db, "After load");
+
+    /* Summaries cover every live row */
+    rdb_column_summary_t summary;
+    assert(rdb_column_summarize(c, "qty", &summary) == 0);
+    assert(summary.row_count == ROW_COUNT);
+
+    /* Deleting most rows compacts the store during the deletes */
+    run_on_both(db, "DELETE FROM %s WHERE id < 3000");
+    c = rdb_get_table(db, "c");
+    assert(c->column_store->deleted_count < RDB_ROW_GROUP_SIZE);
+    compare_all(db, "After delete");
+
+    /* Updated rows move to the end of the store */
+    run_on_both(db, "UPDATE %s SET qty = 7 WHERE id >= 4990");
+    assert(!c->column_store->ordered);
+    compare_all(db, "After update");
+
+    insert_rows(db, ROW_COUNT, ROW_COUNT + 100);
+    compare_all(db, "After more inserts");
+
+    /* The storage layout survives a save and reload */
+    system("rm -rf " DATA_DIR);
+    rdb_persistence_manager_t *pm = rdb_persistence_create(DATA_DIR, RDB_PERSISTENCE_FULL);
+    assert(pm != NULL);
+    assert(rdb_persistence_init(pm) == 0);
+    assert(rdb_persistence_save_database(pm, db) == 0);
+    rdb_destroy_database(db);
+
+    db = rdb_create_database("columnar_test");
+    assert(db != NULL);
+    assert(rdb_persistence_load_database(pm, db) == 0);
+    c = rdb_get_table(db, "c");
+    assert(c != NULL && c->storage == RDB_STORAGE_COLUMNAR && c->column_store != NULL);
+    assert(rdb_get_table(db, "r")->storage == RDB_STORAGE_ROW);
+    compare_all(db, "After reload");
+
+    rdb_persistence_destroy(pm);
+    rdb_destroy_database(db);
+    system("rm -rf " DATA_DIR);
+
+    printf("\nColumnar scan test PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "test_support.h"
+#include "persistence.h"
+
+#define ROW_COUNT 200
+#define DATA_DIR "./constraint_test_data"
+
+/* How many rows of `table` match `where` */
+static size_t count_rows(rdb_database_t *db, const char *table, const char *where) {
+    test_result_t *result = test_query(db, "SELECT * FROM %s WHERE %s", table, where);
+    assert(result != NULL);
+    size_t rows = result->rows;
+    test_result_free(result);
+    return rows;
+}
+
+static void check_primary_key(rdb_database_t *db) {
+    printf("Checking PRIMARY KEY...\n");
+    assert(rdb_get_table_index(rdb_get_table(db, "users"), "users_pkey") != NULL);
+
+    assert(test_exec(db, "INSERT INTO users VALUES (7, 'again', 'again@example.com')") != 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (NULL, 'nobody', 'nobody@example.com')") != 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (%d, 'next', 'next@example.com')", ROW_COUNT) == 0);
+    assert(count_rows(db, "users", "id = 7") == 1);
+
+    /* A rejected UPDATE leaves every row as it was */
+    test_result_t *before = test_query(db, "SELECT * FROM users");
+    assert(test_exec(db, "UPDATE users SET id = 8 WHERE id = 9") != 0);
+    assert(test_exec(db, "UPDATE users SET id = 1000 WHERE id < 5") != 0);
+    assert(test_exec(db, "UPDATE users SET id = NULL WHERE id = 9") != 0);
+    test_result_t *after = test_query(db, "SELECT * FROM users");
+    assert(test_same_result(before, after));
+    test_result_free(before);
+    test_result_free(after);
+
+    /* A row may keep its own key, and a freed key can be reused */
+    assert(test_exec(db, "UPDATE users SET id = 9, name = 'nine' WHERE id = 9") >= 0);
+    assert(test_exec(db, "UPDATE users SET id = 1000 WHERE id = 9") >= 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (9, 'nine again', 'nine@example.com')") == 0);
+    assert(test_exec(db, "DELETE FROM users WHERE id = 10") >= 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (10, 'ten again', 'ten@example.com')") == 0);
+
+    /* The index enforcing the key cannot be dropped */
+    assert(test_exec(db, "DROP INDEX users_pkey FROM users") != 0);
+    assert(rdb_get_table_index(rdb_get_table(db, "users"), "users_pkey") != NULL);
+}
+
+static void check_unique(rdb_database_t *db) {
+    printf("Checking UNIQUE...\n");
+    assert(test_exec(db, "INSERT INTO users VALUES (2000, 'copy', 'user3@example.com')") != 0);
+    assert(test_exec(db, "UPDATE users SET email = 'user4@example.com' WHERE id = 5") != 0);
+
+    /* Any number of NULLs */
+    for (int i = 0; i < 3; i++) {
+        assert(test_exec(db, "INSERT INTO users VALUES (%d, 'anonymous', NULL)", 3000 + i) == 0);
+    }
+    assert(test_exec(db, "UPDATE users SET email = NULL WHERE id = 5") >= 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (5000, 'moved', 'user5@example.com')") == 0);
+}
+
+/* Keys that differ only in a fraction are different keys, also in an INT
+ * column; equal numbers of either type are duplicates */
+static void check_fractional_keys(rdb_database_t *db) {
+    printf("Checking non-integral keys...\n");
+    assert(test_exec(db, "CREATE TABLE scores (k INT PRIMARY KEY, u INT UNIQUE)") == 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (2, 1)") == 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (2.5, 1.5)") == 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (2, 7)") != 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (2.0, 8)") != 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (2.5, 9)") != 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (10, 3)") == 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (10.7, 4)") == 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (10, 5)") != 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (20, 1.5)") != 0);
+    assert(test_exec(db, "INSERT INTO scores VALUES (21, 1.25)") == 0);
+    assert(count_rows(db, "scores", "k = 2") == 1 && count_rows(db, "scores", "k = 2.5") == 1);
+    assert(count_rows(db, "scores", "k > 0") == 5);
+
+    assert(test_exec(db, "UPDATE scores SET k = 2.5 WHERE k = 10") != 0);
+    assert(test_exec(db, "UPDATE scores SET k = 2.25 WHERE k = 10") == 1);
+    assert(count_rows(db, "scores", "k = 2.25") == 1);
+
+    /* Per-row new values: 1, 1.5, 1.25 become 1.5, 2, 1.75 */
+    assert(test_exec(db, "UPDATE scores SET u = u + 0.5 WHERE u < 2") == 3);
+    assert(count_rows(db, "scores", "u = 1.5") == 1 && count_rows(db, "scores", "u = 2") == 1);
+    assert(test_exec(db, "UPDATE scores SET u = u - u WHERE u < 3") != 0);
+    assert(test_exec(db, "UPDATE scores SET u = u + 0.25 WHERE u >= 1.75 AND u < 3") == 2);
+}
+
+/* Duplicates are caught inside a transaction, and a rollback frees the keys
+ * the transaction took */
+static void check_transaction(rdb_database_t *db) {
+    printf("Checking transactions...\n");
+    assert(rdb_begin_transaction(db, RDB_ISOLATION_READ_COMMITTED) == 0);
+    assert(test_exec_transactional(db, "INSERT INTO users VALUES (6000, 'tx', 'tx@example.com')") == 0);
+    assert(test_exec_transactional(db, "INSERT INTO users VALUES (6000, 'tx2', 'tx2@example.com')") != 0);
+    assert(test_exec_transactional(db, "INSERT INTO users VALUES (6001, 'tx3', 'tx@example.com')") != 0);
+    assert(rdb_rollback_transaction(db) == 0);
+
+    assert(count_rows(db, "users", "id = 6000") == 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (6000, 'after', 'tx@example.com')") == 0);
+}
+
+int main() {
+    printf("=== FI RDB Constraint Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("constraint_test");
+    assert(test_exec(db, "CREATE TABLE users (id INT PRIMARY KEY, name VARCHAR(32), "
+                         "email VARCHAR(64) UNIQUE)") == 0);
+    for (int i = 0; i < ROW_COUNT; i++) {
+        assert(test_exec(db, "INSERT INTO users VALUES (%d, 'user %d', 'user%d@example.com')", i, i, i) == 0);
+    }
+
+    check_primary_key(db);
+    check_unique(db);
+    check_transaction(db);
+    check_fractional_keys(db);
+
+    /* Constraints come back with the table after a reload */
+    printf("Checking persistence...\n");
+    system("rm -rf " DATA_DIR);
+    rdb_persistence_manager_t *pm = rdb_persistence_create(DATA_DIR, RDB_PERSISTENCE_FULL);
+    assert(pm != NULL);
+    assert(rdb_persistence_init(pm) == 0);
+    assert(rdb_persistence_save_database(pm, db) == 0);
+    rdb_destroy_database(db);
+
+    db = rdb_create_database("constraint_test");
+    assert(db != NULL);
+    assert(rdb_persistence_load_database(pm, db) == 0);
+    assert(count_rows(db, "users", "id = 7") == 1);
+    assert(test_exec(db, "INSERT INTO users VALUES (7, 'again', 'again@example.com')") != 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (7000, 'again', 'user8@example.com')") != 0);
+    assert(test_exec(db, "INSERT INTO users VALUES (7000, 'fresh', 'fresh@example.com')") == 0);
+
+    rdb_persistence_destroy(pm);
+    rdb_destroy_database(db);
+    system("rm -rf " DATA_DIR);
+
+    printf("\nConstraint test PASSED!\n");
+    return 0;
+}
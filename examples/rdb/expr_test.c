@@ -0,0 +1,211 @@
+#include "test_support.h"
+#include <ctype.h>
+#include <strings.h>  /* for strcasecmp, strncasecmp */
+
+#define ROW_COUNT 1000
+
+/* WHERE and SET expressions checked against the same expressions computed
+ * in C over a model of the table. Columns hold NULLs, so comparisons with
+ * them must come out unknown and drop the row, also under NOT. */
+
+typedef struct {
+    bool a_null, b_null, s_null;
+    int64_t a;
+    double b;
+    char s[16];
+} model_row_t;
+
+static model_row_t model[ROW_COUNT];
+
+static void init_model(rdb_database_t *db) {
+    for (int i = 0; i < ROW_COUNT; i++) {
+        model_row_t *m = &model[i];
+        m->a_null = i % 10 == 0;
+        m->a = i % 37 - 18;
+        m->b_null = i % 15 == 0;
+        m->b = i * 0.5;
+        m->s_null = i % 21 == 0;
+        snprintf(m->s, sizeof(m->s), "Name%d", i % 20);
+
+        char a[32], b[32], s[32];
+        snprintf(a, sizeof(a), m->a_null ? "NULL" : "%lld", (long long)m->a);
+        if (m->b_null) snprintf(b, sizeof(b), "NULL");
+        else snprintf(b, sizeof(b), "%.1f", m->b);
+        if (m->s_null) snprintf(s, sizeof(s), "NULL");
+        else snprintf(s, sizeof(s), "'%s'", m->s);
+        assert(test_exec(db, "INSERT INTO t VALUES (%d, %s, %s, %s)", i, a, b, s) == 0);
+    }
+}
+
+/* The table holds exactly the model */
+static void check_table(rdb_database_t *db) {
+    test_result_t *result = test_query(db, "SELECT * FROM t");
+    assert(result != NULL && result->rows == ROW_COUNT);
+    for (size_t r = 0; r < result->rows; r++) {
+        const model_row_t *m = &model[test_int(result, r, 0)];
+        const rdb_value_t *a = test_value(result, r, 1);
+        const rdb_value_t *b = test_value(result, r, 2);
+        const rdb_value_t *s = test_value(result, r, 3);
+
+        assert(a->is_null == m->a_null && (m->a_null || a->data.int_val == m->a));
+        assert(b->is_null == m->b_null && (m->b_null || b->data.float_val == m->b));
+        assert(s->is_null == m->s_null && (m->s_null || strcmp(rdb_get_string_value(s), m->s) == 0));
+    }
+    test_result_free(result);
+}
+
+static bool starts_with(const char *s, const char *prefix) {
+    return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+static bool q_arith(int i, const model_row_t *m) { (void)i; return !m->a_null && m->a * 2 + 1 > 5; }
+static bool q_not(int i, const model_row_t *m) { (void)i; return !m->a_null && !(m->a < 0); }
+static bool q_mod_and(int i, const model_row_t *m) {
+    (void)i;
+    return !m->a_null && m->a % 5 == 0 && !m->b_null && m->b < 100;
+}
+static bool q_abs_or(int i, const model_row_t *m) {
+    (void)i;
+    return (!m->a_null && (m->a < 0 ? -m->a : m->a) <= 3) || m->s_null;
+}
+static bool q_length(int i, const model_row_t *m) { (void)i; return !m->s_null && strlen(m->s) == 6; }
+static bool q_lower(int i, const model_row_t *m) {
+    (void)i;
+    return !m->s_null && strcasecmp(m->s, "name7") == 0;
+}
+static bool q_upper_like(int i, const model_row_t *m) {
+    (void)i;
+    return !m->s_null && strncasecmp(m->s, "name1", 5) == 0;
+}
+static bool q_in(int i, const model_row_t *m) {
+    return (!m->a_null && m->a >= 1 && m->a <= 3) || i == 500 || i == 501;
+}
+static bool q_coalesce(int i, const model_row_t *m) { (void)i; return m->a_null; }
+static bool q_mixed(int i, const model_row_t *m) {
+    (void)i;
+    return !m->a_null && !m->b_null && (m->a + m->b) / 2 > 10;
+}
+static bool q_not_like(int i, const model_row_t *m) {
+    (void)i;
+    return !m->a_null && m->a != 3 && !m->s_null && !starts_with(m->s, "Name1");
+}
+static bool q_is_not_null(int i, const model_row_t *m) { (void)i; return !m->s_null && m->b_null; }
+static bool q_id(int i, const model_row_t *m) { (void)m; return i % 100 == 42 || i + 4 == 1; }
+static bool q_nested(int i, const model_row_t *m) {
+    bool left = !m->a_null && m->a > 0;
+    bool right = i < 100 || (!m->b_null && m->b > 400);
+    return left && right;
+}
+
+static const struct {
+    const char *where;
+    bool (*expected)(int i, const model_row_t *m);
+} queries[] = {
+    {"a * 2 + 1 > 5", q_arith},
+    {"NOT (a < 0)", q_not},
+    {"a % 5 = 0 AND b < 100", q_mod_and},
+    {"ABS(a) <= 3 OR s IS NULL", q_abs_or},
+    {"LENGTH(s) = 6", q_length},
+    {"LOWER(s) = 'name7'", q_lower},
+    {"UPPER(s) LIKE 'NAME1%'", q_upper_like},
+    {"a IN (1, 2, 3) OR id IN (500, 501)", q_in},
+    {"COALESCE(a, 100) > 50", q_coalesce},
+    {"(a + b) / 2 > 10", q_mixed},
+    {"a <> 3 AND NOT (s LIKE 'Name1%')", q_not_like},
+    {"s IS NOT NULL AND b IS NULL", q_is_not_null},
+    {"id % 100 = 42 OR id + 4 = 1", q_id},
+    {"a > 0 AND (id < 100 OR b > 400)", q_nested},
+};
+
+static void check_queries(rdb_database_t *db) {
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+        test_result_t *result = test_query(db, "SELECT * FROM t WHERE %s", queries[q].where);
+        assert(result != NULL);
+
+        size_t r = 0;
+        for (int i = 0; i < ROW_COUNT; i++) {
+            if (!queries[q].expected(i, &model[i])) continue;
+            if (r >= result->rows || test_int(result, r, 0) != i) {
+                printf("Mismatch at row %d of '%s'\n", i, queries[q].where);
+                fflush(stdout);
+                assert(false);
+            }
+            r++;
+        }
+        assert(r == result->rows);
+        test_result_free(result);
+    }
+}
+
+static void check_updates(rdb_database_t *db) {
+    printf("Checking computed UPDATE...\n");
+    assert(test_exec(db, "UPDATE t SET a = a * 2 WHERE a > 0") >= 0);
+    for (int i = 0; i < ROW_COUNT; i++) {
+        if (!model[i].a_null && model[i].a > 0) model[i].a *= 2;
+    }
+    check_table(db);
+
+    /* Every SET expression sees the row as it was */
+    assert(test_exec(db, "UPDATE t SET b = b + a, a = 0 - a, s = UPPER(s) WHERE id < 200") >= 0);
+    for (int i = 0; i < 200; i++) {
+        model_row_t *m = &model[i];
+        m->b_null = m->b_null || m->a_null;
+        if (!m->b_null) m->b = m->b + (double)m->a;
+        m->a = -m->a;
+        for (char *c = m->s; *c; c++) *c = (char)toupper((unsigned char)*c);
+    }
+    check_table(db);
+    check_queries(db);
+}
+
+/* A key shift is checked as a whole, not row by row against the old keys */
+static void check_key_shift(rdb_database_t *db) {
+    printf("Checking key shifts...\n");
+    assert(test_exec(db, "CREATE TABLE k (id INT PRIMARY KEY, v INT)") == 0);
+    for (int i = 0; i < 100; i++) assert(test_exec(db, "INSERT INTO k VALUES (%d, %d)", i, i * 3) == 0);
+
+    assert(test_exec(db, "UPDATE k SET id = id + 1") >= 0);
+    test_expect_same(db, "SELECT * FROM k WHERE id = 100", "SELECT * FROM k WHERE v = 297");
+    test_result_t *none = test_query(db, "SELECT * FROM k WHERE id = 0");
+    assert(none != NULL && none->rows == 0);
+    test_result_free(none);
+
+    test_result_t *before = test_query(db, "SELECT * FROM k");
+    assert(test_exec(db, "UPDATE k SET id = id * 0 + 5 WHERE id < 10") != 0);
+    assert(test_exec(db, "UPDATE k SET id = id + 1 WHERE id > 50 AND id < 60") != 0);
+
+    assert(rdb_begin_transaction(db, RDB_ISOLATION_READ_COMMITTED) == 0);
+    assert(test_exec_transactional(db, "UPDATE k SET id = id - 1") >= 0);
+    assert(rdb_rollback_transaction(db) == 0);
+
+    test_result_t *after = test_query(db, "SELECT * FROM k");
+    assert(test_same_result(before, after));
+    test_result_free(before);
+    test_result_free(after);
+    for (int i = 1; i <= 100; i++) {
+        test_result_t *one = test_query(db, "SELECT * FROM k WHERE id = %d", i);
+        assert(one != NULL && one->rows == 1 && test_int(one, 0, 1) == (i - 1) * 3);
+        test_result_free(one);
+    }
+    assert(test_exec(db, "INSERT INTO k VALUES (0, 0)") == 0);
+    assert(test_exec(db, "INSERT INTO k VALUES (100, 0)") != 0);
+}
+
+int main() {
+    printf("=== FI RDB Expression Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("expr_test");
+    assert(test_exec(db, "CREATE TABLE t (id INT, a INT, b FLOAT, s VARCHAR(16))") == 0);
+    init_model(db);
+    check_table(db);
+
+    printf("Checking WHERE expressions...\n");
+    check_queries(db);
+    check_updates(db);
+    check_key_shift(db);
+
+    rdb_destroy_database(db);
+
+    printf("\nExpression test PASSED!\n");
+    return 0;
+}
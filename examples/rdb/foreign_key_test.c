@@ -0,0 +1,112 @@
+#include "test_support.h"
+
+#define DEPARTMENTS 10
+#define EMPLOYEES 300
+
+/* How many rows of `table` match `where` */
+static size_t count_rows(rdb_database_t *db, const char *table, const char *where) {
+    test_result_t *result = test_query(db, "SELECT * FROM %s WHERE %s", table, where);
+    assert(result != NULL);
+    size_t rows = result->rows;
+    test_result_free(result);
+    return rows;
+}
+
+static void add_foreign_key(rdb_database_t *db, bool cascade) {
+    rdb_foreign_key_t *fk = rdb_create_foreign_key("fk_employees_dept", "employees", "dept_id",
+                                                   "departments", "id");
+    assert(fk != NULL);
+    fk->on_delete_cascade = cascade;
+    fk->on_update_cascade = cascade;
+    assert(rdb_add_foreign_key(db, fk) == 0);
+    rdb_foreign_key_free(fk);
+}
+
+/* Without cascades, a change that would orphan a row fails as a whole */
+static void check_restrict(rdb_database_t *db) {
+    printf("Checking checks without cascade...\n");
+    assert(rdb_get_table_index(rdb_get_table(db, "employees"), "employees_dept_id_fkey") != NULL);
+
+    assert(test_exec(db, "INSERT INTO employees VALUES (1000, %d, 'nowhere')", DEPARTMENTS) != 0);
+    assert(test_exec(db, "INSERT INTO employees VALUES (1001, NULL, 'unassigned')") == 0);
+    assert(test_exec(db, "INSERT INTO employees VALUES (1002, 3, 'three')") == 0);
+
+    test_result_t *before = test_query(db, "SELECT * FROM departments");
+    assert(test_exec(db, "DELETE FROM departments WHERE id = 3") != 0);
+    assert(test_exec(db, "DELETE FROM departments WHERE id >= 0") != 0);
+    assert(test_exec(db, "UPDATE departments SET id = 100 WHERE id = 4") != 0);
+    test_result_t *after = test_query(db, "SELECT * FROM departments");
+    assert(test_same_result(before, after));
+    test_result_free(before);
+    test_result_free(after);
+
+    assert(test_exec(db, "UPDATE employees SET dept_id = %d WHERE id = 5", DEPARTMENTS) != 0);
+    assert(test_exec(db, "UPDATE employees SET dept_id = 9 WHERE id = 5") >= 0);
+
+    /* A department nobody works in can go */
+    assert(test_exec(db, "INSERT INTO departments VALUES (%d, 'empty')", DEPARTMENTS) == 0);
+    assert(test_exec(db, "DELETE FROM departments WHERE id = %d", DEPARTMENTS) >= 0);
+    assert(count_rows(db, "departments", "id >= 0") == DEPARTMENTS);
+}
+
+static void check_cascade(rdb_database_t *db) {
+    printf("Checking cascades...\n");
+    assert(rdb_drop_foreign_key(db, "fk_employees_dept") == 0);
+    add_foreign_key(db, true);
+
+    size_t in_two = count_rows(db, "employees", "dept_id = 2");
+    assert(in_two > 0);
+    assert(test_exec(db, "UPDATE departments SET id = 200 WHERE id = 2") >= 0);
+    assert(count_rows(db, "employees", "dept_id = 2") == 0);
+    assert(count_rows(db, "employees", "dept_id = 200") == in_two);
+
+    size_t total = count_rows(db, "employees", "id >= 0");
+    size_t in_one = count_rows(db, "employees", "dept_id = 1");
+    assert(test_exec(db, "DELETE FROM departments WHERE id = 1") >= 0);
+    assert(count_rows(db, "employees", "dept_id = 1") == 0);
+    assert(count_rows(db, "employees", "id >= 0") == total - in_one);
+
+    /* A rollback undoes the cascaded changes too */
+    test_result_t *before = test_query(db, "SELECT * FROM employees");
+    assert(rdb_begin_transaction(db, RDB_ISOLATION_READ_COMMITTED) == 0);
+    assert(test_exec_transactional(db, "DELETE FROM departments WHERE id = 5") >= 0);
+    assert(test_exec_transactional(db, "UPDATE departments SET id = 600 WHERE id = 6") >= 0);
+    assert(count_rows(db, "employees", "dept_id = 5") == 0);
+    assert(count_rows(db, "employees", "dept_id = 6") == 0);
+    assert(rdb_rollback_transaction(db) == 0);
+    test_result_t *after = test_query(db, "SELECT * FROM employees");
+    assert(test_same_result(before, after));
+    test_result_free(before);
+    test_result_free(after);
+    assert(count_rows(db, "departments", "id = 5") == 1);
+}
+
+int main() {
+    printf("=== FI RDB Foreign Key Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("foreign_key_test");
+    assert(test_exec(db, "CREATE TABLE departments (id INT PRIMARY KEY, name VARCHAR(32))") == 0);
+    assert(test_exec(db, "CREATE TABLE employees (id INT PRIMARY KEY, dept_id INT, name VARCHAR(32))") == 0);
+    for (int i = 0; i < DEPARTMENTS; i++) {
+        assert(test_exec(db, "INSERT INTO departments VALUES (%d, 'department %d')", i, i) == 0);
+    }
+    for (int i = 0; i < EMPLOYEES; i++) {
+        assert(test_exec(db, "INSERT INTO employees VALUES (%d, %d, 'employee %d')",
+                         i, (i * 7) % DEPARTMENTS, i) == 0);
+    }
+
+    add_foreign_key(db, false);
+    check_restrict(db);
+    check_cascade(db);
+
+    /* Dropping a table drops the constraints that involve it */
+    printf("Checking DROP TABLE...\n");
+    assert(test_exec(db, "DROP TABLE departments") == 0);
+    assert(rdb_get_foreign_key(db, "fk_employees_dept") == NULL);
+    assert(test_exec(db, "INSERT INTO employees VALUES (2000, 42, 'anywhere')") == 0);
+
+    rdb_destroy_database(db);
+
+    printf("\nForeign key test PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,345 @@
+#include "test_support.h"
+#include <sys/time.h>
+
+#define TENANTS 8
+#define ROW_COUNT 6000
+
+/* Scrambled but repeatable (tenant_id, created_at) keys, with duplicates */
+static int64_t tenant_of(int64_t i) { return (i * 5) % TENANTS; }
+static int64_t created_at_of(int64_t i) { return (int64_t)(((uint64_t)i * 2654435761u) >> 7) % 1000; }
+
+static void insert_rows(rdb_database_t *db, int64_t from, int64_t to) {
+    for (int64_t i = from; i < to; i++) {
+        const char *table = "events";
+        for (int copy = 0; copy < 2; copy++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES (%lld, %lld, %lld)", table,
+                             (long long)tenant_of(i), (long long)created_at_of(i), (long long)i) == 0);
+            table = "events_plain";
+        }
+    }
+}
+
+/* The indexed table gives the same rows as the unindexed copy */
+static void expect_same_rows(rdb_database_t *db, const char *where) {
+    char query[256], expected[256];
+    snprintf(query, sizeof(query), "SELECT * FROM events WHERE %s", where);
+    snprintf(expected, sizeof(expected), "SELECT * FROM events_plain WHERE %s", where);
+    test_expect_same_rows(db, query, expected);
+}
+
+static void check_queries(rdb_database_t *db) {
+    expect_same_rows(db, "tenant_id = 3");
+    expect_same_rows(db, "tenant_id = 3 AND created_at = 500");
+    expect_same_rows(db, "created_at = 500 AND tenant_id = 3");
+    expect_same_rows(db, "tenant_id = 5 AND created_at > 900");
+    expect_same_rows(db, "tenant_id = 5 AND created_at >= 100 AND created_at < 200");
+    expect_same_rows(db, "tenant_id = 0 AND created_at <= 10");
+    expect_same_rows(db, "tenant_id = 7 AND created_at < 0");
+    expect_same_rows(db, "tenant_id = 2 AND created_at > 400 AND payload < 3000");
+    expect_same_rows(db, "created_at = 17");
+    expect_same_rows(db, "tenant_id > 5");
+    expect_same_rows(db, "tenant_id = 9");
+}
+
+/* URL-like keys: a long shared prefix, then remainders that agree on their
+ * first 8 bytes and differ only after them */
+static void check_string_keys(rdb_database_t *db) {
+    assert(test_exec(db, "CREATE TABLE pages (url VARCHAR(200), hits INT)") == 0);
+    assert(test_exec(db, "CREATE TABLE pages_plain (url VARCHAR(200), hits INT)") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_pages_url ON pages (url)") == 0);
+
+    const char *tables[] = {"pages", "pages_plain"};
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < 300; i++) {
+            int n = (i * 37) % 300;
+            assert(test_exec(db, "INSERT INTO %s VALUES ('https://example.com/articles/%d', %d)",
+                             tables[t], n, i) == 0);
+            assert(test_exec(db, "INSERT INTO %s VALUES ('https://example.com/articles/%d/comments', %d)",
+                             tables[t], n, i) == 0);
+            assert(test_exec(db, "INSERT INTO %s VALUES ('https://example.com/articles/%d/comments?page=%d', %d)",
+                             tables[t], n, i % 3, i) == 0);
+        }
+        /* Keys that end inside, and exactly at, the abbreviated bytes */
+        assert(test_exec(db, "INSERT INTO %s VALUES ('https://example.com/articles/', 1)", tables[t]) == 0);
+        assert(test_exec(db, "INSERT INTO %s VALUES ('https://example.com/articles', 2)", tables[t]) == 0);
+        assert(test_exec(db, "INSERT INTO %s VALUES ('https://example.com/articles/1234567', 3)", tables[t]) == 0);
+    }
+
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = 'https://example.com/articles/12'",
+                          "SELECT * FROM pages_plain WHERE url = 'https://example.com/articles/12'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = 'https://example.com/articles/12/comments'",
+                          "SELECT * FROM pages_plain WHERE url = 'https://example.com/articles/12/comments'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = 'https://example.com/articles/12/comments?page=0'",
+                          "SELECT * FROM pages_plain WHERE url = 'https://example.com/articles/12/comments?page=0'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url > 'https://example.com/articles/12/comments' "
+                              "AND url <= 'https://example.com/articles/12/comments?page=1'",
+                          "SELECT * FROM pages_plain WHERE url > 'https://example.com/articles/12/comments' "
+                              "AND url <= 'https://example.com/articles/12/comments?page=1'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = 'https://example.com/articles/1234567'",
+                          "SELECT * FROM pages_plain WHERE url = 'https://example.com/articles/1234567'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = 'https://example.com/articles'",
+                          "SELECT * FROM pages_plain WHERE url = 'https://example.com/articles'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url > 'https://example.com/articles/2' "
+                              "AND url < 'https://example.com/articles/25/comments'",
+                          "SELECT * FROM pages_plain WHERE url > 'https://example.com/articles/2' "
+                              "AND url < 'https://example.com/articles/25/comments'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url >= 'https://example.com/articles/299'",
+                          "SELECT * FROM pages_plain WHERE url >= 'https://example.com/articles/299'");
+
+    /* A key outside the shared prefix shrinks it; every key is still found */
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "INSERT INTO %s VALUES ('http://example.org/', 4)", tables[t]) == 0);
+        assert(test_exec(db, "INSERT INTO %s VALUES ('', 5)", tables[t]) == 0);
+    }
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = 'https://example.com/articles/12/comments'",
+                          "SELECT * FROM pages_plain WHERE url = 'https://example.com/articles/12/comments'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = 'http://example.org/'",
+                          "SELECT * FROM pages_plain WHERE url = 'http://example.org/'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url = ''",
+                          "SELECT * FROM pages_plain WHERE url = ''");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url < 'https://example.com/articles/1'",
+                          "SELECT * FROM pages_plain WHERE url < 'https://example.com/articles/1'");
+    test_expect_same_rows(db, "SELECT * FROM pages WHERE url > 'https'",
+                          "SELECT * FROM pages_plain WHERE url > 'https'");
+
+    test_result_t *one = test_query(db, "SELECT * FROM pages WHERE url = 'https://example.com/articles/1234567'");
+    assert(one != NULL && one->rows == 1 && test_int(one, 0, 1) == 3);
+    test_result_free(one);
+}
+
+/* Equality on two single-column indexes intersects their row ids */
+static void check_intersection(rdb_database_t *db) {
+    const char *tables[] = {"orders", "orders_plain"};
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "CREATE TABLE %s (customer INT, status INT, amount INT)", tables[t]) == 0);
+        for (int i = 0; i < 3000; i++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES (%d, %d, %d)", tables[t],
+                             (i * 7) % 50, (i * 11) % 6, i) == 0);
+        }
+    }
+    assert(test_exec(db, "CREATE INDEX idx_orders_customer ON orders (customer)") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_orders_status ON orders (status)") == 0);
+
+    test_expect_same_rows(db, "SELECT * FROM orders WHERE customer = 7 AND status = 3",
+                          "SELECT * FROM orders_plain WHERE customer = 7 AND status = 3");
+    test_expect_same_rows(db, "SELECT * FROM orders WHERE status = 0 AND customer = 42",
+                          "SELECT * FROM orders_plain WHERE status = 0 AND customer = 42");
+    test_expect_same_rows(db, "SELECT * FROM orders WHERE customer = 7 AND status = 3 AND amount > 1500",
+                          "SELECT * FROM orders_plain WHERE customer = 7 AND status = 3 AND amount > 1500");
+    test_expect_same_rows(db, "SELECT * FROM orders WHERE customer = 7 AND status = 9",
+                          "SELECT * FROM orders_plain WHERE customer = 7 AND status = 9");
+
+    /* Deleted rows drop out of both sides */
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "DELETE FROM %s WHERE amount < 1000", tables[t]) >= 0);
+    }
+    test_expect_same_rows(db, "SELECT * FROM orders WHERE customer = 7 AND status = 3",
+                          "SELECT * FROM orders_plain WHERE customer = 7 AND status = 3");
+}
+
+/* LIKE 'prefix%' and equality on ordered and ART indexes */
+static void check_like_prefix(rdb_database_t *db) {
+    const char *tables[] = {"customers_btree", "customers_art", "customers_plain"};
+    const char *names[] = {"Anderson", "Andrews", "Andy", "Anna", "Annabel", "Bob", "Bobby", "Carla", "An", "A"};
+    for (int t = 0; t < 3; t++) {
+        assert(test_exec(db, "CREATE TABLE %s (name VARCHAR(64), region INT)", tables[t]) == 0);
+        for (int i = 0; i < 1000; i++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES ('%s%d', %d)", tables[t],
+                             names[(i * 7) % 10], i % 13, i % 4) == 0);
+            assert(test_exec(db, "INSERT INTO %s VALUES ('%s', %d)", tables[t], names[i % 10], i % 4) == 0);
+        }
+    }
+    assert(test_exec(db, "CREATE INDEX idx_customers_btree ON customers_btree (name)") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_customers_art ON customers_art (region, name) USING ART") == 0);
+
+    const char *wheres[] = {
+        "name LIKE 'And%'", "name LIKE 'Ann%'", "name LIKE 'An%'", "name LIKE 'A%'", "name LIKE 'Z%'",
+        "name LIKE 'Bob%1'", "name = 'Andy'", "name = 'Andy7'", "name LIKE '%by'",
+        "region = 2 AND name LIKE 'Anna%'", "region = 1 AND name = 'Bobby'", "region = 3",
+    };
+    for (size_t w = 0; w < sizeof(wheres) / sizeof(wheres[0]); w++) {
+        for (int t = 0; t < 2; t++) {
+            char query[256], expected[256];
+            snprintf(query, sizeof(query), "SELECT * FROM %s WHERE %s", tables[t], wheres[w]);
+            snprintf(expected, sizeof(expected), "SELECT * FROM customers_plain WHERE %s", wheres[w]);
+            test_expect_same_rows(db, query, expected);
+        }
+    }
+}
+
+/* Non-integral values in an INT column keep their own keys and order */
+static void check_fractional_keys(rdb_database_t *db) {
+    const char *values[] = {"2", "2.5", "3", "10", "10.7", "-0.5", "-1", "0", "2.0", "-1.25", "1000000000000000000000000000000.5",
+                            "9007199254740992", "9007199254740993", "9007199254740995", "-9007199254740993",
+                            "9223372036854775807", "-9223372036854775807"};
+    const char *tables[] = {"nums", "nums_plain"};
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "CREATE TABLE %s (v INT, tag INT)", tables[t]) == 0);
+        for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES (%s, %zu)", tables[t], values[i], i) == 0);
+        }
+    }
+    assert(test_exec(db, "CREATE INDEX idx_nums_v ON nums (v)") == 0);
+
+    const char *wheres[] = {
+        "v = 2", "v = 2.5", "v = 10.7", "v > 2", "v >= 2.5", "v < 3", "v <= 2", "v > 2 AND v < 3",
+        "v >= -1 AND v <= 0", "v < 0", "v > 10", "v = 9007199254740993", "v > 9007199254740992",
+        "v >= 9007199254740993 AND v < 9007199254740995", "v < -9007199254740992", "v = 9223372036854775807",
+    };
+    for (size_t w = 0; w < sizeof(wheres) / sizeof(wheres[0]); w++) {
+        char query[256], expected[256];
+        snprintf(query, sizeof(query), "SELECT * FROM nums WHERE %s", wheres[w]);
+        snprintf(expected, sizeof(expected), "SELECT * FROM nums_plain WHERE %s", wheres[w]);
+        test_expect_same_rows(db, query, expected);
+    }
+
+    /* The index walk for ORDER BY sees the true order of the values */
+    test_expect_same(db, "SELECT * FROM nums ORDER BY v LIMIT 100", "SELECT * FROM nums_plain ORDER BY v LIMIT 100");
+
+    test_result_t *result = test_query(db, "SELECT tag FROM nums WHERE v = 2.5");
+    assert(result != NULL && result->rows == 1 && test_int(result, 0, 0) == 1);
+    test_result_free(result);
+}
+
+static double elapsed_seconds(const struct timeval *start) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_usec - start->tv_usec) / 1e6;
+}
+
+/* Height bound of the index tree: log_{3/2}(n) + 1 levels, plus slack */
+static size_t height_bound(size_t count) {
+    size_t height = 2;
+    double levels = 1.0;
+    while (levels <= (double)count) {
+        levels *= 1.5;
+        height++;
+    }
+    return height;
+}
+
+/* Rows SELECT returns for one (tenant_id, created_at) key; the payload of
+ * the last one goes to `payload` */
+static size_t lookup(rdb_prepared_t *select, int64_t tenant, int64_t created_at, int64_t *payload) {
+    size_t rows = 0;
+
+    assert(rdb_bind_int(select, 1, tenant) == 0);
+    assert(rdb_bind_int(select, 2, created_at) == 0);
+    while (rdb_step(select) == RDB_STEP_ROW) {
+        *payload = rdb_get_int_value(rdb_column_value(select, 0));
+        rows++;
+    }
+    return rows;
+}
+
+/* Keys arriving in ascending (tenant_id, created_at) order, the way an
+ * append-only event log is loaded, keep the index tree shallow */
+static void check_bulk_load(rdb_database_t *db) {
+    const int64_t per_tenant = 10000;
+    const size_t total = (size_t)(TENANTS * per_tenant);
+
+    assert(test_exec(db, "CREATE TABLE log (tenant_id INT, created_at INT, payload INT)") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_log_tenant_time ON log (tenant_id, created_at)") == 0);
+
+    struct timeval start;
+    gettimeofday(&start, NULL);
+    rdb_prepared_t *insert = rdb_prepare(db, "INSERT INTO log VALUES (?, ?, ?)");
+    assert(insert != NULL);
+    for (int64_t tenant = 0; tenant < TENANTS; tenant++) {
+        for (int64_t t = 0; t < per_tenant; t++) {
+            assert(rdb_bind_int(insert, 1, tenant) == 0);
+            assert(rdb_bind_int(insert, 2, t) == 0);
+            assert(rdb_bind_int(insert, 3, tenant * per_tenant + t) == 0);
+            assert(rdb_step(insert) == RDB_STEP_DONE);
+        }
+    }
+    rdb_finalize(insert);
+    printf("Loaded %zu rows in %.3f s\n", total, elapsed_seconds(&start));
+
+    fi_btree *tree = rdb_get_index(db, "log", "idx_log_tenant_time");
+    assert(tree != NULL && fi_btree_size(tree) == total);
+    assert(fi_btree_height(tree) <= height_bound(total));
+    assert(fi_btree_is_bst(tree));
+
+    /* Every key is found through the index */
+    rdb_prepared_t *select = rdb_prepare(db, "SELECT payload FROM log WHERE tenant_id = ? AND created_at = ?");
+    assert(select != NULL);
+    for (int64_t tenant = 0; tenant < TENANTS; tenant++) {
+        for (int64_t t = 0; t < per_tenant; t += 97) {
+            int64_t payload = -1;
+            assert(lookup(select, tenant, t, &payload) == 1);
+            assert(payload == tenant * per_tenant + t);
+        }
+    }
+    int64_t payload = -1;
+    assert(lookup(select, TENANTS, 0, &payload) == 0);
+
+    /* Dropping the older half of the log keeps the tree balanced */
+    assert(test_exec(db, "DELETE FROM log WHERE tenant_id < %d", TENANTS / 2) == (int)(total / 2));
+    assert(fi_btree_size(tree) == total / 2);
+    assert(fi_btree_height(tree) <= height_bound(total / 2));
+    assert(fi_btree_is_bst(tree));
+
+    assert(lookup(select, 0, 0, &payload) == 0);
+    assert(lookup(select, TENANTS - 1, per_tenant - 1, &payload) == 1);
+    assert(payload == (int64_t)total - 1);
+    rdb_finalize(select);
+}
+
+int main() {
+    printf("=== FI RDB Composite Index Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("index_test");
+    assert(test_exec(db, "CREATE TABLE events (tenant_id INT, created_at INT, payload INT)") == 0);
+    assert(test_exec(db, "CREATE TABLE events_plain (tenant_id INT, created_at INT, payload INT)") == 0);
+
+    /* The index is built over rows already in the table, then kept up to
+     * date by the inserts that follow */
+    insert_rows(db, 0, ROW_COUNT / 2);
+    assert(test_exec(db, "CREATE INDEX idx_events_tenant_time ON events (tenant_id, created_at)") == 0);
+    insert_rows(db, ROW_COUNT / 2, ROW_COUNT);
+
+    fi_btree *tree = rdb_get_index(db, "events", "idx_events_tenant_time");
+    assert(tree != NULL);
+    assert(fi_btree_size(tree) == ROW_COUNT);
+
+    printf("Checking prefix and range lookups against a scan...\n");
+    check_queries(db);
+
+    /* Deletes and key updates leave no stale entries behind */
+    printf("Checking lookups after DELETE and UPDATE...\n");
+    const char *tables[] = {"events", "events_plain"};
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "DELETE FROM %s WHERE tenant_id = 3 AND created_at > 500", tables[t]) >= 0);
+        assert(test_exec(db, "DELETE FROM %s WHERE payload < 1000", tables[t]) >= 0);
+        assert(test_exec(db, "UPDATE %s SET created_at = 2000 WHERE tenant_id = 5 AND created_at < 300",
+                         tables[t]) >= 0);
+    }
+    check_queries(db);
+    expect_same_rows(db, "tenant_id = 5 AND created_at = 2000");
+
+    test_result_t *all = test_query(db, "SELECT * FROM events");
+    assert(all != NULL);
+    assert(fi_btree_size(tree) == all->rows);
+    test_result_free(all);
+
+    printf("Checking prefix-compressed string keys...\n");
+    check_string_keys(db);
+
+    printf("Checking index intersection...\n");
+    check_intersection(db);
+
+    printf("Checking LIKE prefixes on B-tree and ART indexes...\n");
+    check_like_prefix(db);
+
+    printf("Checking non-integral keys...\n");
+    check_fractional_keys(db);
+
+    printf("Checking an ascending bulk load...\n");
+    check_bulk_load(db);
+
+    rdb_destroy_database(db);
+
+    printf("\nComposite index test PASSED!\n");
+    return 0;
+}
@@ -12,6 +12,13 @@
 static rdb_database_t *g_db = NULL;
 static rdb_persistence_manager_t *g_pm = NULL;
 
+/* Statements created with PREPARE, by name */
+typedef struct {
+    char name[64];
+    rdb_prepared_t *prepared;
+} named_statement_t;
+static fi_array *g_prepared = NULL;
+
 /* Global flag to track cleanup state */
 static volatile int cleanup_in_progress = 0;
 
@@ -32,6 +39,8 @@ void print_table_schema(const char *table_name);
 void print_persistence_status(void);
 int initialize_persistence(const char *db_name, const char *data_dir, rdb_persistence_mode_t mode);
 void print_usage(const char *program_name);
+int execute_prepared_command(const rdb_statement_t *stmt);
+void free_prepared_statements(void);
 
 /* Main function */
 int main(int argc, char *argv[]) {
@@ -161,17 +170,25 @@ void print_welcome_message(void) {
 void print_help_message(void) {
     printf("\n=== Available Commands ===\n");
     printf("SQL Commands:\n");
-    printf("  CREATE TABLE <name> (<column_definitions>)\n");
+    printf("  CREATE TABLE <name> (<column_definitions>) [USING ROW|COLUMNAR]\n");
+    printf("    column options: PRIMARY KEY, UNIQUE, NOT NULL, DICTIONARY (VARCHAR/TEXT)\n");
     printf("  DROP TABLE <name>\n");
     printf("  INSERT INTO <table> VALUES (<values>)\n");
-    printf("  SELECT <columns> FROM <table> [WHERE <conditions>]\n");
+    printf("  SELECT <columns> FROM <table> [WHERE <conditions>] [GROUP BY <columns>]\n");
+    printf("    [ORDER BY <column> [ASC|DESC], ...] [LIMIT <n> [OFFSET <m>]]\n");
+    printf("    aggregates: COUNT(*), COUNT(col), SUM(col), AVG(col), MIN(col), MAX(col)\n");
     printf("  UPDATE <table> SET <column>=<value> [WHERE <conditions>]\n");
     printf("  DELETE FROM <table> [WHERE <conditions>]\n");
-    printf("  CREATE INDEX <name> ON <table> (<column>)\n");
+    printf("  CREATE INDEX <name> ON <table> (<column>[, ...]) [USING BTREE|ART]\n");
     printf("  DROP INDEX <name>\n");
     printf("  BEGIN TRANSACTION\n");
     printf("  COMMIT\n");
     printf("  ROLLBACK\n");
+    printf("  VACUUM [<table>]  - Reclaim the slots of deleted rows\n");
+    printf("  ANALYZE [<table>] - Collect column statistics for the planner\n");
+    printf("  PREPARE <name> AS <statement>  - Parse a statement once, ? marks parameters\n");
+    printf("  EXECUTE <name> [(<values>)]    - Run a prepared statement\n");
+    printf("  DEALLOCATE [PREPARE] <name>    - Discard a prepared statement\n");
     printf("\nSpecial Commands:\n");
     printf("  help          - Show this help message\n");
     printf("  tables        - List all tables\n");
@@ -185,8 +202,12 @@ void print_help_message(void) {
     printf("  CREATE TABLE students (id INT PRIMARY KEY, name VARCHAR(50), age INT)\n");
     printf("  INSERT INTO students VALUES (1, 'Alice', 20)\n");
     printf("  SELECT * FROM students WHERE age > 18\n");
+    printf("  SELECT age, COUNT(*) FROM students GROUP BY age\n");
+    printf("  SELECT * FROM students ORDER BY age DESC LIMIT 10 OFFSET 20\n");
     printf("  UPDATE students SET age = 21 WHERE name = 'Alice'\n");
     printf("  DELETE FROM students WHERE id = 1\n");
+    printf("  PREPARE by_age AS SELECT * FROM students WHERE age > ?\n");
+    printf("  EXECUTE by_age (18)\n");
     printf("========================\n\n");
 }
 
@@ -247,6 +268,9 @@ int execute_statement(const rdb_statement_t *stmt) {
     switch (stmt->type) {
         case RDB_STMT_CREATE_TABLE:
             result = rdb_create_table_thread_safe(g_db, stmt->table_name, stmt->columns);
+            if (result == 0 && stmt->storage_mode == RDB_STORAGE_COLUMNAR) {
+                result = rdb_set_table_storage(g_db, stmt->table_name, RDB_STORAGE_COLUMNAR);
+            }
             if (result == 0) {
                 print_success_message("Table created successfully");
                 /* Save to persistence if enabled */
@@ -296,12 +320,37 @@ int execute_statement(const rdb_statement_t *stmt) {
                 } else {
                     table_name = stmt->table_name;
                 }
-                query_result = rdb_select_rows_thread_safe(g_db, table_name, 
-                                                          stmt->select_columns, 
-                                                          stmt->where_conditions);
+                bool ordered = stmt->order_by || stmt->limit_value != RDB_NO_LIMIT ||
+                               stmt->offset_value > 0;
+                if (stmt->aggregates) {
+                    query_result = rdb_select_aggregate_thread_safe(g_db, table_name,
+                                                                    stmt->aggregates,
+                                                                    stmt->group_by,
+                                                                    stmt->where_conditions);
+                    if (query_result && ordered) {
+                        query_result = rdb_aggregate_order(query_result, stmt->select_columns,
+                                                           stmt->order_by, stmt->limit_value,
+                                                           stmt->offset_value);
+                    }
+                } else if (ordered) {
+                    query_result = rdb_select_rows_ordered_thread_safe(g_db, table_name,
+                                                                       stmt->select_columns,
+                                                                       stmt->where_conditions,
+                                                                       stmt->order_by,
+                                                                       stmt->limit_value,
+                                                                       stmt->offset_value);
+                } else {
+                    query_result = rdb_select_rows_thread_safe(g_db, table_name, 
+                                                              stmt->select_columns, 
+                                                              stmt->where_conditions);
+                }
             }
             
-            if (query_result) {
+            if (query_result && stmt->aggregates) {
+                print_query_result(query_result, stmt);
+                rdb_aggregate_result_free(query_result);
+                result = 0;
+            } else if (query_result) {
                 print_query_result(query_result, stmt);
                 fi_array_destroy(query_result);
                 result = 0;
@@ -312,10 +361,17 @@ int execute_statement(const rdb_statement_t *stmt) {
             break;
             
         case RDB_STMT_UPDATE:
-            result = rdb_update_rows_thread_safe(g_db, stmt->table_name, 
-                                                stmt->columns, stmt->values, 
-                                                stmt->where_conditions);
-            if (result == 0) {
+            if (stmt->set_expressions) {
+                result = rdb_update_rows_computed_thread_safe(g_db, stmt->table_name,
+                                                              stmt->columns, stmt->values,
+                                                              stmt->set_expressions,
+                                                              stmt->where_conditions);
+            } else {
+                result = rdb_update_rows_thread_safe(g_db, stmt->table_name, 
+                                                    stmt->columns, stmt->values, 
+                                                    stmt->where_conditions);
+            }
+            if (result >= 0) {
                 print_success_message("Rows updated successfully");
                 /* Save to persistence if enabled */
                 if (g_pm) {
@@ -329,7 +385,7 @@ int execute_statement(const rdb_statement_t *stmt) {
         case RDB_STMT_DELETE:
             result = rdb_delete_rows_thread_safe(g_db, stmt->table_name, 
                                                 stmt->where_conditions);
-            if (result == 0) {
+            if (result >= 0) {
                 print_success_message("Rows deleted successfully");
                 /* Save to persistence if enabled */
                 if (g_pm) {
@@ -341,7 +397,15 @@ int execute_statement(const rdb_statement_t *stmt) {
             break;
             
         case RDB_STMT_CREATE_INDEX:
-            result = rdb_create_index(g_db, stmt->table_name, stmt->index_name, stmt->index_column);
+            {
+                const char *index_columns[RDB_MAX_INDEX_COLUMNS];
+                for (size_t i = 0; i < stmt->index_column_count; i++) {
+                    index_columns[i] = stmt->index_columns[i];
+                }
+                result = rdb_create_index_using(g_db, stmt->table_name, stmt->index_name,
+                                                index_columns, stmt->index_column_count,
+                                                stmt->index_kind);
+            }
             if (result == 0) {
                 print_success_message("Index created successfully");
                 /* Save to persistence if enabled */
@@ -393,6 +457,38 @@ int execute_statement(const rdb_statement_t *stmt) {
             }
             break;
             
+        case RDB_STMT_VACUUM:
+            result = rdb_vacuum(g_db, stmt->table_name);
+            if (result >= 0) {
+                print_success_message("Vacuum completed");
+                /* Save to persistence if enabled */
+                if (g_pm) {
+                    rdb_persistence_save_database(g_pm, g_db);
+                }
+            } else {
+                print_error_message("Failed to vacuum");
+            }
+            break;
+            
+        case RDB_STMT_ANALYZE:
+            result = rdb_analyze(g_db, stmt->table_name);
+            if (result >= 0) {
+                print_success_message("Analyze completed");
+                /* Save to persistence if enabled */
+                if (g_pm) {
+                    rdb_persistence_save_database(g_pm, g_db);
+                }
+            } else {
+                print_error_message("Failed to analyze");
+            }
+            break;
+            
+        case RDB_STMT_PREPARE:
+        case RDB_STMT_EXECUTE:
+        case RDB_STMT_DEALLOCATE:
+            result = execute_prepared_command(stmt);
+            break;
+            
         default:
             print_error_message("Unsupported statement type");
             result = -1;
@@ -402,6 +498,88 @@ int execute_statement(const rdb_statement_t *stmt) {
     return result;
 }
 
+/* Position of the prepared statement called `name`, or -1 */
+static int find_prepared_statement(const char *name) {
+    for (size_t i = 0; g_prepared && i < fi_array_count(g_prepared); i++) {
+        named_statement_t *entry = (named_statement_t*)fi_array_get(g_prepared, i);
+        if (strcmp(entry->name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+/* PREPARE, EXECUTE and DEALLOCATE */
+int execute_prepared_command(const rdb_statement_t *stmt) {
+    int index = find_prepared_statement(stmt->prepared_name);
+    char message[160];
+    
+    if (stmt->type == RDB_STMT_PREPARE) {
+        if (index >= 0) {
+            snprintf(message, sizeof(message), "Prepared statement '%s' already exists",
+                     stmt->prepared_name);
+            print_error_message(message);
+            return -1;
+        }
+        if (!g_prepared) {
+            g_prepared = fi_array_create(8, sizeof(named_statement_t));
+            if (!g_prepared) return -1;
+        }
+        
+        named_statement_t entry;
+        strcpy(entry.name, stmt->prepared_name);
+        entry.prepared = rdb_prepare(g_db, stmt->prepared_sql);
+        if (!entry.prepared || fi_array_push(g_prepared, &entry) != 0) {
+            rdb_finalize(entry.prepared);
+            print_error_message("Failed to prepare statement");
+            return -1;
+        }
+        snprintf(message, sizeof(message), "Statement '%s' prepared with %zu parameter(s)",
+                 entry.name, rdb_parameter_count(entry.prepared));
+        print_success_message(message);
+        return 0;
+    }
+    
+    if (index < 0) {
+        snprintf(message, sizeof(message), "Prepared statement '%s' does not exist", stmt->prepared_name);
+        print_error_message(message);
+        return -1;
+    }
+    named_statement_t *entry = (named_statement_t*)fi_array_get(g_prepared, index);
+    
+    if (stmt->type == RDB_STMT_DEALLOCATE) {
+        rdb_finalize(entry->prepared);
+        named_statement_t last;
+        fi_array_pop(g_prepared, &last);
+        if ((size_t)index < fi_array_count(g_prepared)) fi_array_set(g_prepared, index, &last);
+        print_success_message("Prepared statement deallocated");
+        return 0;
+    }
+    
+    /* EXECUTE: bind the arguments in order, then run the parsed statement */
+    size_t argument_count = stmt->values ? fi_array_count(stmt->values) : 0;
+    if (argument_count != rdb_parameter_count(entry->prepared)) {
+        snprintf(message, sizeof(message), "Statement '%s' takes %zu parameter(s), %zu given",
+                 entry->name, rdb_parameter_count(entry->prepared), argument_count);
+        print_error_message(message);
+        return -1;
+    }
+    for (size_t i = 0; i < argument_count; i++) {
+        if (rdb_bind_value(entry->prepared, i + 1, *(rdb_value_t**)fi_array_get(stmt->values, i)) != 0) {
+            print_error_message("Failed to bind parameter");
+            return -1;
+        }
+    }
+    return execute_statement(rdb_prepared_statement(entry->prepared));
+}
+
+/* Finalize every prepared statement before the database goes away */
+void free_prepared_statements(void) {
+    for (size_t i = 0; g_prepared && i < fi_array_count(g_prepared); i++) {
+        rdb_finalize(((named_statement_t*)fi_array_get(g_prepared, i))->prepared);
+    }
+    if (g_prepared) fi_array_destroy(g_prepared);
+    g_prepared = NULL;
+}
+
 /* Print query result */
 void print_query_result(fi_array *result, const rdb_statement_t *stmt) {
     if (!result || fi_array_count(result) == 0) {
@@ -558,7 +736,7 @@ void print_table_list(void) {
             printf("%-20s (%zu columns, %zu rows)\n", 
                    *table_name, 
                    fi_array_count(table->columns),
-                   fi_array_count(table->rows));
+                   rdb_table_live_row_count(table));
         }
         
         while (fi_map_iterator_next(&iter)) {
@@ -570,7 +748,7 @@ void print_table_list(void) {
                 printf("%-20s (%zu columns, %zu rows)\n", 
                        *table_name, 
                        fi_array_count(table->columns),
-                       fi_array_count(table->rows));
+                       rdb_table_live_row_count(table));
             }
         }
     }
@@ -602,6 +780,7 @@ void print_table_schema(const char *table_name) {
             if (col->primary_key) printf(" PRIMARY KEY");
             if (col->unique) printf(" UNIQUE");
             if (!col->nullable) printf(" NOT NULL");
+            if (col->dictionary) printf(" DICTIONARY");
             if (col->is_foreign_key) {
                 printf(" REFERENCES %s(%s)", col->foreign_table, col->foreign_column);
             }
@@ -609,7 +788,10 @@ void print_table_schema(const char *table_name) {
         }
     }
     
-    printf("----------------------------------------\n\n");
+    printf("----------------------------------------\n");
+    if (table->storage == RDB_STORAGE_COLUMNAR) printf("Storage: columnar\n");
+    rdb_print_table_stats(table);
+    printf("\n");
 }
 
 /* Signal handler for graceful shutdown */
@@ -637,6 +819,8 @@ void cleanup_and_exit(void) {
         return; /* Already in cleanup, avoid recursion */
     }
     
+    free_prepared_statements();
+    
     if (g_pm && g_db) {
         /* Save database state before shutdown with timeout protection */
         printf("Saving database state before exit...\n");
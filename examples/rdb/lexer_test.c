@@ -0,0 +1,141 @@
+#include "test_support.h"
+#include <ctype.h>
+#include <strings.h>  /* for strcasecmp */
+
+/* Keyword recognition and token slices. Every keyword must be recognized
+ * in any letter case, and words close to a keyword (a letter short, a
+ * letter more, a letter changed) must only be keywords when they spell
+ * another keyword. The expected answer comes from the list below, so a
+ * keyword missing from the lexer's switch fails here. */
+
+/* Keyword text by sql_keyword_t, from SQL_KW_SELECT on */
+static const char *keywords[] = {
+    "SELECT", "FROM", "WHERE", "INSERT", "INTO", "VALUES", "UPDATE", "SET", "DELETE", "CREATE",
+    "TABLE", "INDEX", "DROP", "INT", "FLOAT", "VARCHAR", "TEXT", "BOOLEAN", "PRIMARY", "KEY",
+    "UNIQUE", "NOT", "NULL", "DEFAULT", "AND", "OR", "ORDER", "BY", "LIMIT", "OFFSET",
+    "JOIN", "INNER", "LEFT", "RIGHT", "FULL", "ON", "FOREIGN", "REFERENCES", "CASCADE", "CONSTRAINT",
+    "BEGIN", "COMMIT", "ROLLBACK", "TRANSACTION", "AUTOCOMMIT", "ISOLATION", "LEVEL", "READ",
+    "UNCOMMITTED", "COMMITTED", "REPEATABLE", "SERIALIZABLE", "TRUE", "FALSE", "LIKE", "IS", "IN",
+    "USING", "DICTIONARY", "VACUUM", "GROUP", "ASC", "DESC", "ANALYZE", "PREPARE", "EXECUTE",
+    "DEALLOCATE", "AS",
+};
+#define KEYWORD_COUNT (sizeof(keywords) / sizeof(keywords[0]))
+
+/* Keyword `word` spells in the list, or 0 */
+static sql_keyword_t expected_keyword(const char *word) {
+    for (size_t k = 0; k < KEYWORD_COUNT; k++) {
+        if (strcasecmp(word, keywords[k]) == 0) return (sql_keyword_t)(SQL_KW_SELECT + k);
+    }
+    return 0;
+}
+
+/* `word` alone is lexed as the expected keyword or as an identifier */
+static void check_word(const char *word) {
+    sql_keyword_t expected = expected_keyword(word);
+    if (sql_get_keyword(word) != expected || sql_is_keyword(word) != (expected != 0)) {
+        printf("'%s' looked up wrong\n", word);
+        fflush(stdout);
+        assert(false);
+    }
+
+    sql_parser_t *parser = sql_parser_create(word);
+    assert(parser != NULL);
+    assert(sql_parser_next_token(parser) == 0);
+    sql_token_t *token = sql_parser_get_current_token(parser);
+    assert(token->type == (expected ? SQL_TOKEN_KEYWORD : SQL_TOKEN_IDENTIFIER));
+    assert(token->keyword == expected);
+    assert(token->length == strlen(word) && strcmp(token->value, word) == 0);
+    assert(sql_parser_next_token(parser) == 0 && token->type == SQL_TOKEN_EOF);
+    sql_parser_destroy(parser);
+}
+
+static void check_keywords(void) {
+    /* The list covers the enum */
+    assert(SQL_KW_SELECT + KEYWORD_COUNT - 1 == SQL_KW_AS);
+
+    for (size_t k = 0; k < KEYWORD_COUNT; k++) {
+        char word[32];
+        size_t length = strlen(keywords[k]);
+
+        check_word(keywords[k]);
+        for (size_t i = 0; i <= length; i++) word[i] = (char)tolower((unsigned char)keywords[k][i]);
+        check_word(word);
+        for (size_t i = 0; i < length; i++) word[i] = (char)(i % 2 ? keywords[k][i] : word[i]);
+        check_word(word);
+
+        /* Near misses */
+        snprintf(word, sizeof(word), "%.*s", (int)(length - 1), keywords[k]);
+        if (length > 1) check_word(word);
+        snprintf(word, sizeof(word), "%sS", keywords[k]);
+        check_word(word);
+        snprintf(word, sizeof(word), "%s_", keywords[k]);
+        check_word(word);
+        snprintf(word, sizeof(word), "%s1", keywords[k]);
+        check_word(word);
+        snprintf(word, sizeof(word), "X%s", keywords[k]);
+        check_word(word);
+        for (size_t i = 0; i < length; i++) {
+            snprintf(word, sizeof(word), "%s", keywords[k]);
+            word[i] = word[i] == 'Z' ? 'A' : (char)(word[i] + 1);
+            check_word(word);
+        }
+    }
+}
+
+typedef struct {
+    sql_token_type_t type;
+    const char *value;
+} expected_token_t;
+
+/* Tokens are slices of the text, NUL-terminated while current */
+static void check_statement(void) {
+    const char *sql = "select Name, qty from T where qty >= -10 and s = 'it is' order by Name desc limit 5;";
+    static const expected_token_t expected[] = {
+        {SQL_TOKEN_KEYWORD, "select"}, {SQL_TOKEN_IDENTIFIER, "Name"}, {SQL_TOKEN_PUNCTUATION, ","},
+        {SQL_TOKEN_IDENTIFIER, "qty"}, {SQL_TOKEN_KEYWORD, "from"}, {SQL_TOKEN_IDENTIFIER, "T"},
+        {SQL_TOKEN_KEYWORD, "where"}, {SQL_TOKEN_IDENTIFIER, "qty"}, {SQL_TOKEN_OPERATOR, ">="},
+        {SQL_TOKEN_NUMBER, "-10"}, {SQL_TOKEN_KEYWORD, "and"}, {SQL_TOKEN_IDENTIFIER, "s"},
+        {SQL_TOKEN_OPERATOR, "="}, {SQL_TOKEN_STRING, "it is"}, {SQL_TOKEN_KEYWORD, "order"},
+        {SQL_TOKEN_KEYWORD, "by"}, {SQL_TOKEN_IDENTIFIER, "Name"}, {SQL_TOKEN_KEYWORD, "desc"},
+        {SQL_TOKEN_KEYWORD, "limit"}, {SQL_TOKEN_NUMBER, "5"}, {SQL_TOKEN_PUNCTUATION, ";"},
+    };
+
+    sql_parser_t *parser = sql_parser_create(sql);
+    assert(parser != NULL);
+    for (size_t t = 0; t < sizeof(expected) / sizeof(expected[0]); t++) {
+        assert(sql_parser_next_token(parser) == 0);
+        sql_token_t *token = sql_parser_get_current_token(parser);
+        assert(token->type == expected[t].type);
+        assert(token->length == strlen(expected[t].value) && strcmp(token->value, expected[t].value) == 0);
+        assert(token->keyword == (token->type == SQL_TOKEN_KEYWORD ? expected_keyword(token->value) : 0));
+        if (token->type != SQL_TOKEN_STRING) assert(strncmp(sql + token->position, token->value, token->length) == 0);
+    }
+    assert(sql_parser_next_token(parser) == 0);
+    assert(sql_parser_get_current_token(parser)->type == SQL_TOKEN_EOF);
+    sql_parser_destroy(parser);
+
+    /* Case does not matter to the parser either */
+    parser = sql_parser_create("sElEcT * fRoM t WhErE a Is NoT nUlL oRdEr By a DeSc");
+    rdb_statement_t *stmt = sql_parse_statement(parser);
+    assert(stmt != NULL && stmt->type == RDB_STMT_SELECT);
+    assert(stmt->from_tables != NULL && fi_array_count(stmt->from_tables) == 1);
+    assert(strcmp(*(char**)fi_array_get(stmt->from_tables, 0), "t") == 0);
+    assert(stmt->where_conditions != NULL && fi_array_count(stmt->where_conditions) == 1);
+    assert(stmt->order_by != NULL);
+    sql_statement_free(stmt);
+    sql_parser_destroy(parser);
+}
+
+int main() {
+    printf("=== FI RDB Lexer Test ===\n\n");
+
+    printf("Checking keywords...\n");
+    check_keywords();
+    printf("%zu keywords and their near misses agree\n", KEYWORD_COUNT);
+
+    printf("Checking token slices...\n");
+    check_statement();
+
+    printf("\nLexer test PASSED!\n");
+    return 0;
+}
@@ -505,6 +505,7 @@ rdb_column_t* create_column(const char *name, rdb_data_type_t type, bool primary
     column->nullable = nullable;
     column->default_value[0] = '\0';
     column->is_foreign_key = false;
+    column->dictionary = false;
     column->foreign_table[0] = '\0';
     column->foreign_column[0] = '\0';
     
@@ -20,7 +20,7 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
     if (fi_array_count(stmt->from_tables) == 1) {
         for (size_t i = 0; i < fi_array_count(table1->rows); i++) {
             rdb_row_t *row = *(rdb_row_t**)fi_array_get(table1->rows, i);
-            if (!row) continue;
+            if (!row || row->deleted) continue;
             
             /* Create result row */
             fi_array *table_names = fi_array_create(1, sizeof(char*));
@@ -40,17 +40,8 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
                         snprintf(key, sizeof(key), "%s.%s", first_table, col->name);
                         
                         /* Create a copy of the value */
-                        rdb_value_t *val_copy = malloc(sizeof(rdb_value_t));
+                        rdb_value_t *val_copy = rdb_value_copy(val);
                         if (val_copy) {
-                            *val_copy = *val;
-                            if (val->type == RDB_TYPE_VARCHAR || val->type == RDB_TYPE_TEXT) {
-                                if (val->data.string_val) {
-                                    val_copy->data.string_val = malloc(strlen(val->data.string_val) + 1);
-                                    if (val_copy->data.string_val) {
-                                        strcpy(val_copy->data.string_val, val->data.string_val);
-                                    }
-                                }
-                            }
                             fi_map_put(values, &key, &val_copy);
                         }
                     }
@@ -80,11 +71,11 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
         /* Perform cartesian product with join conditions */
         for (size_t i = 0; i < fi_array_count(table1->rows); i++) {
             rdb_row_t *row1 = *(rdb_row_t**)fi_array_get(table1->rows, i);
-            if (!row1) continue;
+            if (!row1 || row1->deleted) continue;
             
             for (size_t j = 0; j < fi_array_count(table2->rows); j++) {
                 rdb_row_t *row2 = *(rdb_row_t**)fi_array_get(table2->rows, j);
-                if (!row2) continue;
+                if (!row2 || row2->deleted) continue;
                 
                 /* Check join conditions if any */
                 bool matches = true;
@@ -118,17 +109,8 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
                                 char key[128];
                                 snprintf(key, sizeof(key), "%s.%s", first_table, col->name);
                                 
-                                rdb_value_t *val_copy = malloc(sizeof(rdb_value_t));
+                                rdb_value_t *val_copy = rdb_value_copy(val);
                                 if (val_copy) {
-                                    *val_copy = *val;
-                                    if (val->type == RDB_TYPE_VARCHAR || val->type == RDB_TYPE_TEXT) {
-                                        if (val->data.string_val) {
-                                            val_copy->data.string_val = malloc(strlen(val->data.string_val) + 1);
-                                            if (val_copy->data.string_val) {
-                                                strcpy(val_copy->data.string_val, val->data.string_val);
-                                            }
-                                        }
-                                    }
                                     fi_map_put(values, &key, &val_copy);
                                 }
                             }
@@ -143,17 +125,8 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
                                 char key[128];
                                 snprintf(key, sizeof(key), "%s.%s", second_table, col->name);
                                 
-                                rdb_value_t *val_copy = malloc(sizeof(rdb_value_t));
+                                rdb_value_t *val_copy = rdb_value_copy(val);
                                 if (val_copy) {
-                                    *val_copy = *val;
-                                    if (val->type == RDB_TYPE_VARCHAR || val->type == RDB_TYPE_TEXT) {
-                                        if (val->data.string_val) {
-                                            val_copy->data.string_val = malloc(strlen(val->data.string_val) + 1);
-                                            if (val_copy->data.string_val) {
-                                                strcpy(val_copy->data.string_val, val->data.string_val);
-                                            }
-                                        }
-                                    }
                                     fi_map_put(values, &key, &val_copy);
                                 }
                             }
@@ -228,7 +201,7 @@ int rdb_validate_foreign_key(rdb_database_t *db, const char *table_name,
                 /* Search for matching value in referenced table */
                 for (size_t i = 0; i < fi_array_count(ref_table->rows); i++) {
                     rdb_row_t *row = *(rdb_row_t**)fi_array_get(ref_table->rows, i);
-                    if (!row || !row->values) continue;
+                    if (!row || row->deleted || !row->values) continue;
                     
                     rdb_value_t *ref_val = *(rdb_value_t**)fi_array_get(row->values, ref_col_idx);
                     if (ref_val && rdb_value_compare(&value, &ref_val) == 0) {
@@ -259,7 +232,7 @@ int rdb_validate_foreign_key(rdb_database_t *db, const char *table_name,
                 /* Search for matching value in referenced table */
                 for (size_t i = 0; i < fi_array_count(ref_table->rows); i++) {
                     rdb_row_t *row = *(rdb_row_t**)fi_array_get(ref_table->rows, i);
-                    if (!row || !row->values) continue;
+                    if (!row || row->deleted || !row->values) continue;
                     
                     rdb_value_t *ref_val = *(rdb_value_t**)fi_array_get(row->values, ref_col_idx);
                     if (ref_val && rdb_value_compare(&value, &ref_val) == 0) {
@@ -0,0 +1,145 @@
+#include "test_support.h"
+
+#define ROW_COUNT 2000
+#define GROUPS 10
+
+/* ORDER BY and LIMIT/OFFSET. Table "t" has a B-tree index on k, so its
+ * sorted queries walk the index; "t_plain" holds the same rows without
+ * indexes and goes through the top-K heap. Both must give the same rows in
+ * the same order. */
+
+/* A permutation of 0 .. ROW_COUNT-1, so k has no ties */
+static int key_of(int i) { return (int)(((int64_t)i * 7919) % ROW_COUNT); }
+
+static void insert_rows(rdb_database_t *db) {
+    for (int i = 0; i < ROW_COUNT; i++) {
+        const char *tables[] = {"t", "t_plain"};
+        for (int t = 0; t < 2; t++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES (%d, %d, %d, 's%03d')", tables[t], i, key_of(i),
+                             i % GROUPS, (i * 13) % 500) == 0);
+        }
+    }
+}
+
+/* The query on "t" and on "t_plain" give identical results */
+static void expect_same_order(rdb_database_t *db, const char *format) {
+    char query[256], expected[256];
+    snprintf(query, sizeof(query), format, "t");
+    snprintf(expected, sizeof(expected), format, "t_plain");
+    test_expect_same(db, query, expected);
+}
+
+static void check_window(rdb_database_t *db, const char *query, size_t rows, int64_t first_id) {
+    test_result_t *result = test_query(db, "%s", query);
+    assert(result != NULL && result->rows == rows);
+    if (rows > 0) assert(test_int(result, 0, 0) == first_id);
+    test_result_free(result);
+}
+
+/* Rows with equal sort keys come in row id order on every path: "d_one"
+ * walks an index on g alone, "d_pair" one on (g, k), whose order inside a
+ * run of g follows k, and "d_plain" sorts. g repeats, holds NULLs and a
+ * fraction; k is a permutation, so it never agrees with row id order. */
+static void check_index_ties(rdb_database_t *db) {
+    const char *tables[] = {"d_one", "d_pair", "d_plain"};
+    for (int t = 0; t < 3; t++) {
+        assert(test_exec(db, "CREATE TABLE %s (id INT, k INT, g INT)", tables[t]) == 0);
+        for (int i = 0; i < 500; i++) {
+            char g[16];
+            snprintf(g, sizeof(g), i % 11 == 0 ? "NULL" : i % 13 == 0 ? "2.5" : "%d", i % GROUPS);
+            assert(test_exec(db, "INSERT INTO %s VALUES (%d, %d, %s)", tables[t], i, key_of(i) % 500, g) == 0);
+        }
+    }
+    assert(test_exec(db, "CREATE INDEX idx_d_one_g ON d_one (g)") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_d_pair_g_k ON d_pair (g, k)") == 0);
+
+    static const char *queries[] = {
+        "SELECT * FROM %s ORDER BY g",
+        "SELECT * FROM %s ORDER BY g DESC",
+        "SELECT * FROM %s ORDER BY g LIMIT 15",
+        "SELECT * FROM %s ORDER BY g DESC LIMIT 15",
+        "SELECT * FROM %s ORDER BY g DESC LIMIT 20 OFFSET 37",
+        "SELECT * FROM %s ORDER BY g LIMIT 60 OFFSET 40",
+        "SELECT * FROM %s WHERE k > 200 ORDER BY g DESC LIMIT 30",
+        "SELECT * FROM %s WHERE id < 100 ORDER BY g LIMIT 25",
+        "SELECT * FROM %s ORDER BY g, k LIMIT 40",
+        "SELECT * FROM %s ORDER BY g DESC, k DESC LIMIT 40",
+    };
+    for (int round = 0; round < 2; round++) {
+        for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+            for (int t = 0; t < 2; t++) {
+                char query[256], expected[256];
+                snprintf(query, sizeof(query), queries[q], tables[t]);
+                snprintf(expected, sizeof(expected), queries[q], "d_plain");
+                test_expect_same(db, query, expected);
+            }
+        }
+
+        /* Move rows between runs and drop some */
+        for (int t = 0; t < 3; t++) {
+            assert(test_exec(db, "UPDATE %s SET g = 3 WHERE k < 60", tables[t]) > 0);
+            assert(test_exec(db, "DELETE FROM %s WHERE k > %d", tables[t], 450 - 100 * round) > 0);
+        }
+    }
+}
+
+int main() {
+    printf("=== FI RDB Order Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("order_test");
+    assert(test_exec(db, "CREATE TABLE t (id INT, k INT, g INT, s VARCHAR(8))") == 0);
+    assert(test_exec(db, "CREATE TABLE t_plain (id INT, k INT, g INT, s VARCHAR(8))") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_t_k ON t (k)") == 0);
+    insert_rows(db);
+
+    printf("Checking index order against the heap...\n");
+    static const char *queries[] = {
+        "SELECT * FROM %s ORDER BY k",
+        "SELECT * FROM %s ORDER BY k DESC",
+        "SELECT * FROM %s ORDER BY k LIMIT 10",
+        "SELECT * FROM %s ORDER BY k DESC LIMIT 10 OFFSET 5",
+        "SELECT * FROM %s ORDER BY k LIMIT 50 OFFSET 1990",
+        "SELECT * FROM %s WHERE g = 3 ORDER BY k LIMIT 20",
+        "SELECT * FROM %s WHERE k > 100 ORDER BY k DESC LIMIT 25",
+        "SELECT * FROM %s ORDER BY s DESC, k LIMIT 30",
+        "SELECT * FROM %s ORDER BY g, s, id",
+        "SELECT * FROM %s LIMIT 7 OFFSET 3",
+        "SELECT * FROM %s WHERE g = 4 LIMIT 5",
+    };
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) expect_same_order(db, queries[q]);
+
+    /* Windows at the edges */
+    check_window(db, "SELECT * FROM t ORDER BY k LIMIT 0", 0, 0);
+    check_window(db, "SELECT * FROM t ORDER BY k LIMIT 10 OFFSET 5000", 0, 0);
+    check_window(db, "SELECT * FROM t LIMIT 3", 3, 0);
+    check_window(db, "SELECT * FROM t LIMIT 2 OFFSET 1999", 1, 1999);
+
+    /* Equal keys keep row id order, ascending or descending */
+    printf("Checking ties...\n");
+    test_result_t *result = test_query(db, "SELECT * FROM t_plain ORDER BY g DESC LIMIT 50");
+    assert(result != NULL && result->rows == 50);
+    for (size_t r = 0; r < result->rows; r++) {
+        assert(test_int(result, r, 2) == GROUPS - 1);
+        assert(test_int(result, r, 0) == (int64_t)(r * GROUPS + GROUPS - 1));
+    }
+    test_result_free(result);
+    check_index_ties(db);
+
+    /* Aggregates sort by select item, by name or by position */
+    printf("Checking ordered aggregates...\n");
+    assert(test_exec(db, "DELETE FROM t WHERE g = 2 AND id > 1000") >= 0);
+    result = test_query(db, "SELECT g, COUNT(*) FROM t GROUP BY g ORDER BY COUNT(*), g DESC LIMIT 3");
+    assert(result != NULL && result->rows == 3);
+    assert(test_int(result, 0, 0) == 2 && test_int(result, 0, 1) == 100);
+    assert(test_int(result, 1, 0) == 9 && test_int(result, 2, 0) == 8);
+    test_result_free(result);
+    result = test_query(db, "SELECT g, SUM(k) FROM t GROUP BY g ORDER BY 1 DESC LIMIT 5 OFFSET 8");
+    assert(result != NULL && result->rows == 2);
+    assert(test_int(result, 0, 0) == 1 && test_int(result, 1, 0) == 0);
+    test_result_free(result);
+
+    rdb_destroy_database(db);
+
+    printf("\nOrder test PASSED!\n");
+    return 0;
+}
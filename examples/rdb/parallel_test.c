@@ -0,0 +1,112 @@
+#include "test_support.h"
+
+#define ROW_COUNT (2 * RDB_MORSEL_SIZE + 5000)
+#define PARALLELISM 4
+
+/* Parallel scans against a single-threaded run. The same queries run with
+ * four scan workers and with parallel scans off, over a row table "t" and a
+ * columnar table "c" holding the same rows, and must give the same rows in
+ * the same order. Tables hold more than two morsels so the workers are
+ * actually used. */
+
+static const char *queries[] = {
+    "SELECT * FROM %s WHERE qty > 10",
+    "SELECT * FROM %s WHERE qty < 0 OR name = 'n7'",
+    "SELECT * FROM %s WHERE flag = TRUE AND price >= 40",
+    "SELECT * FROM %s WHERE qty IS NULL",
+    "SELECT id, name FROM %s WHERE id % 3 = 1",
+    "SELECT id, qty FROM %s",
+    "SELECT name, COUNT(*), SUM(qty), MIN(qty), MAX(price), AVG(qty) FROM %s GROUP BY name",
+    "SELECT flag, COUNT(qty), SUM(id) FROM %s WHERE qty > 0 GROUP BY flag",
+    "SELECT COUNT(*), SUM(qty), MIN(price), MAX(id) FROM %s",
+    "SELECT COUNT(*), SUM(id) FROM %s WHERE price < 10",
+};
+#define QUERY_COUNT (sizeof(queries) / sizeof(queries[0]))
+
+static void insert_rows(rdb_database_t *db) {
+    for (int i = 0; i < ROW_COUNT; i++) {
+        char qty[32];
+        snprintf(qty, sizeof(qty), i % 11 == 0 ? "NULL" : "%d", (i * 37) % 101 - 50);
+        const char *tables[] = {"t", "c"};
+        for (int t = 0; t < 2; t++) {
+            assert(test_exec(db, "INSERT INTO %s VALUES (%d, %s, %.2f, %s, 'n%d')", tables[t], i, qty,
+                             (double)(i % 320) * 0.25, i % 3 ? "TRUE" : "FALSE", i % 13) == 0);
+        }
+    }
+}
+
+/* Results of every query on `table` with the current parallelism */
+static void run_queries(rdb_database_t *db, const char *table, test_result_t **results) {
+    for (size_t q = 0; q < QUERY_COUNT; q++) {
+        char query[256];
+        snprintf(query, sizeof(query), queries[q], table);
+        results[q] = test_query(db, "%s", query);
+        assert(results[q] != NULL);
+    }
+}
+
+static void check_tables(rdb_database_t *db) {
+    const char *tables[] = {"t", "c"};
+    for (int t = 0; t < 2; t++) {
+        test_result_t *parallel[QUERY_COUNT], *serial[QUERY_COUNT];
+
+        assert(rdb_set_scan_parallelism(db, PARALLELISM) == 0);
+        run_queries(db, tables[t], parallel);
+        assert(rdb_set_scan_parallelism(db, 1) == 0);
+        run_queries(db, tables[t], serial);
+
+        for (size_t q = 0; q < QUERY_COUNT; q++) {
+            if (!test_same_result(parallel[q], serial[q])) {
+                printf("Mismatch on %s: %s\n", tables[t], queries[q]);
+                fflush(stdout);
+                assert(false);
+            }
+            test_result_free(parallel[q]);
+            test_result_free(serial[q]);
+        }
+    }
+
+    /* Both storages agree, so the columnar morsels cover every row group */
+    assert(rdb_set_scan_parallelism(db, PARALLELISM) == 0);
+    for (size_t q = 0; q < QUERY_COUNT; q++) {
+        char query[256], expected[256];
+        snprintf(query, sizeof(query), queries[q], "c");
+        snprintf(expected, sizeof(expected), queries[q], "t");
+        test_expect_same(db, query, expected);
+    }
+}
+
+int main() {
+    printf("=== FI RDB Parallel Scan Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("parallel_test");
+    assert(test_exec(db, "CREATE TABLE t (id INT, qty INT, price FLOAT, flag BOOLEAN, name VARCHAR(8))") == 0);
+    assert(test_exec(db, "CREATE TABLE c (id INT, qty INT, price FLOAT, flag BOOLEAN, name VARCHAR(8)) "
+                         "USING COLUMNAR") == 0);
+    insert_rows(db);
+
+    assert(rdb_set_scan_parallelism(db, 3) == 0);
+    assert(rdb_get_scan_parallelism(db) == 3);
+
+    printf("Checking parallel scans...\n");
+    check_tables(db);
+
+    /* Writes find their rows through the parallel filter */
+    printf("Checking parallel writes...\n");
+    assert(rdb_set_scan_parallelism(db, PARALLELISM) == 0);
+    const char *tables[] = {"t", "c"};
+    for (int t = 0; t < 2; t++) {
+        assert(test_exec(db, "DELETE FROM %s WHERE qty > 30 OR price = 1.5", tables[t]) > 0);
+        assert(test_exec(db, "UPDATE %s SET qty = qty + 1000 WHERE flag = FALSE AND qty < -40", tables[t]) > 0);
+    }
+    check_tables(db);
+
+    test_result_t *result = test_query(db, "SELECT COUNT(*) FROM c WHERE qty > 30 AND qty < 900");
+    assert(result != NULL && result->rows == 1 && test_int(result, 0, 0) == 0);
+    test_result_free(result);
+
+    rdb_destroy_database(db);
+
+    printf("\nParallel scan test PASSED!\n");
+    return 0;
+}
@@ -7,10 +7,23 @@
 /* Magic number for database files */
 #define RDB_MAGIC_NUMBER "FI_RDB_PERSIST"
 #define RDB_VERSION 1
+#define RDB_STORAGE_SECTION_MAGIC 0x4c4f4353u /* "SCOL" */
+
+/* Serialized type flag: the payload is a uint32 code into the column
+ * dictionary stored after the table's rows */
+#define RDB_SERIALIZED_DICT_CODE 0x100
+/* Marks the column dictionary section at the end of a table */
+#define RDB_DICT_SECTION_MAGIC 0x54434944u /* "DICT" */
+#define RDB_ZONE_SECTION_MAGIC 0x454e4f5au /* "ZONE" */
+#define RDB_STATS_SECTION_MAGIC 0x54415453u /* "STAT" */
 
 /* Forward declarations for static functions */
 static int rdb_serialize_value(const rdb_value_t *value, void **data, size_t *data_size);
 static int rdb_deserialize_value(const void *data, size_t data_size, rdb_value_t **value);
+static int rdb_serialize_row_encoded(rdb_row_t *row, fi_array *dictionaries,
+                                     void **data, size_t *data_size);
+static int rdb_deserialize_row_encoded(const void *data, size_t data_size, fi_array *dictionaries,
+                                       rdb_row_t **row);
 static int rdb_serialize_column(const rdb_column_t *column, void **data, size_t *data_size);
 static int rdb_deserialize_column(const void *data, size_t data_size, rdb_column_t **column);
 static int rdb_persistence_save_header(rdb_persistence_manager_t *pm, rdb_database_t *db);
@@ -823,8 +836,10 @@ int rdb_wal_replay(rdb_wal_t *wal, rdb_database_t *db) {
                     if (rdb_deserialize_row(entry->data, entry->data_size, &row) == 0) {
                         /* Find the table and insert the row */
                         rdb_table_t *table = rdb_get_table(db, entry->table_name);
-                        if (table && row) {
-                            fi_array_push(table->rows, &row);
+                        if (table && row && rdb_table_insert_row_slot(table, row) == 0) {
+                            rdb_update_table_indexes(table, row);
+                        } else if (row) {
+                            rdb_row_free(row);
                         }
                     }
                 }
@@ -838,14 +853,16 @@ int rdb_wal_replay(rdb_wal_t *wal, rdb_database_t *db) {
                         /* Find the table and update the row */
                         rdb_table_t *table = rdb_get_table(db, entry->table_name);
                         if (table && row) {
-                            /* Find and replace the row with matching row_id */
-                            for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-                                rdb_row_t **existing_row = (rdb_row_t**)fi_array_get(table->rows, i);
-                                if (existing_row && *existing_row && (*existing_row)->row_id == row->row_id) {
-                                    rdb_row_free(*existing_row);
-                                    *existing_row = row;
-                                    break;
-                                }
+                            /* Replace the row with matching row_id */
+                            size_t slot;
+                            if (rdb_table_row_slot(table, row->row_id, &slot) == 0) {
+                                rdb_row_t **existing_row = (rdb_row_t**)fi_array_get(table->rows, slot);
+                                rdb_remove_row_from_indexes(table, *existing_row);
+                                rdb_row_free(*existing_row);
+                                *existing_row = row;
+                                rdb_update_table_indexes(table, row);
+                            } else {
+                                rdb_row_free(row);
                             }
                         }
                     }
@@ -857,15 +874,8 @@ int rdb_wal_replay(rdb_wal_t *wal, rdb_database_t *db) {
                 {
                     rdb_table_t *table = rdb_get_table(db, entry->table_name);
                     if (table) {
-                        /* Find and remove the row with matching row_id */
-                        for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-                            rdb_row_t **existing_row = (rdb_row_t**)fi_array_get(table->rows, i);
-                            if (existing_row && *existing_row && (*existing_row)->row_id == entry->row_id) {
-                                rdb_row_free(*existing_row);
-                                fi_array_splice(table->rows, i, 1, NULL);
-                                break;
-                            }
-                        }
+                        /* Tombstone the row with matching row_id */
+                        rdb_table_delete_row(table, rdb_table_find_row(table, entry->row_id));
                     }
                 }
                 break;
@@ -876,6 +886,7 @@ int rdb_wal_replay(rdb_wal_t *wal, rdb_database_t *db) {
                     rdb_table_t *table = NULL;
                     if (rdb_deserialize_table(entry->data, entry->data_size, &table) == 0) {
                         if (table) {
+                            table->workers = db->workers;
                             fi_map_put(db->tables, entry->table_name, &table);
                         }
                     }
@@ -1027,9 +1038,7 @@ static int rdb_serialize_value(const rdb_value_t *value, void **data, size_t *da
                 break;
             case RDB_TYPE_VARCHAR:
             case RDB_TYPE_TEXT:
-                if (value->data.string_val) {
-                    value_size = strlen(value->data.string_val) + 1; /* +1 for null terminator */
-                }
+                value_size = rdb_get_string_length(value) + 1; /* +1 for null terminator */
                 break;
             case RDB_TYPE_BOOLEAN:
                 value_size = sizeof(bool);
@@ -1048,7 +1057,8 @@ static int rdb_serialize_value(const rdb_value_t *value, void **data, size_t *da
     char *ptr = (char*)buffer;
     
     /* Write type */
-    memcpy(ptr, &value->type, sizeof(rdb_data_type_t));
+    rdb_data_type_t type = (rdb_data_type_t)value->type;
+    memcpy(ptr, &type, sizeof(rdb_data_type_t));
     ptr += sizeof(rdb_data_type_t);
     
     /* Write is_null flag */
@@ -1066,9 +1076,7 @@ static int rdb_serialize_value(const rdb_value_t *value, void **data, size_t *da
                 break;
             case RDB_TYPE_VARCHAR:
             case RDB_TYPE_TEXT:
-                if (value->data.string_val) {
-                    strcpy(ptr, value->data.string_val);
-                }
+                memcpy(ptr, rdb_get_string_value(value), value_size);
                 break;
             case RDB_TYPE_BOOLEAN:
                 memcpy(ptr, &value->data.bool_val, sizeof(bool));
@@ -1081,64 +1089,116 @@ static int rdb_serialize_value(const rdb_value_t *value, void **data, size_t *da
     return 0;
 }
 
+/* Serialize a value, writing cells that reference an entry of the column's
+ * dictionary as the entry code */
+static int rdb_serialize_value_encoded(const rdb_value_t *value, const rdb_string_dict_t *dict,
+                                       void **data, size_t *data_size) {
+    if (!dict || !value || value->is_null || value->str_len != RDB_VALUE_SHARED_STRING ||
+        value->data.string_ref->dict != dict) {
+        return rdb_serialize_value(value, data, data_size);
+    }
+
+    size_t total_size = sizeof(rdb_data_type_t) + sizeof(bool) + sizeof(uint32_t);
+    char *buffer = malloc(total_size);
+    if (!buffer) return -1;
+
+    int type = value->type | RDB_SERIALIZED_DICT_CODE;
+    bool is_null = false;
+    memcpy(buffer, &type, sizeof(rdb_data_type_t));
+    memcpy(buffer + sizeof(rdb_data_type_t), &is_null, sizeof(bool));
+    memcpy(buffer + sizeof(rdb_data_type_t) + sizeof(bool), &value->data.string_ref->code,
+           sizeof(uint32_t));
+
+    *data = buffer;
+    *data_size = total_size;
+    return 0;
+}
+
+/* Dictionary of column `column`, or NULL */
+static rdb_string_dict_t* rdb_persistence_dictionary(fi_array *dictionaries, size_t column) {
+    if (!dictionaries || column >= fi_array_count(dictionaries)) return NULL;
+    return *(rdb_string_dict_t**)fi_array_get(dictionaries, column);
+}
+
+/* Decode a dictionary code written by rdb_serialize_value_encoded() */
+static int rdb_deserialize_dict_code(const void *data, size_t data_size, rdb_string_dict_t *dict,
+                                     rdb_value_t **value) {
+    if (data_size < sizeof(rdb_data_type_t) + sizeof(bool) + sizeof(uint32_t)) return -1;
+
+    int type;
+    uint32_t code;
+    memcpy(&type, data, sizeof(rdb_data_type_t));
+    memcpy(&code, (const char*)data + sizeof(rdb_data_type_t) + sizeof(bool), sizeof(uint32_t));
+
+    rdb_string_t *entry = (rdb_string_t*)rdb_string_dict_entry(dict, code);
+    if (!entry) return -1;
+
+    rdb_value_t *v = rdb_create_shared_string_value(entry);
+    if (!v) return -1;
+    v->type = (uint8_t)(type & ~RDB_SERIALIZED_DICT_CODE);
+
+    *value = v;
+    return 0;
+}
+
 /* Deserialize a value from binary format */
 static int rdb_deserialize_value(const void *data, size_t data_size, rdb_value_t **value) {
     if (!data || !value || data_size < sizeof(rdb_data_type_t) + sizeof(bool)) return -1;
     
-    rdb_value_t *v = malloc(sizeof(rdb_value_t));
-    if (!v) return -1;
-    
     const char *ptr = (const char*)data;
+    rdb_data_type_t type;
+    bool is_null;
     
     /* Read type */
-    memcpy(&v->type, ptr, sizeof(rdb_data_type_t));
+    memcpy(&type, ptr, sizeof(rdb_data_type_t));
     ptr += sizeof(rdb_data_type_t);
     
     /* Read is_null flag */
-    memcpy(&v->is_null, ptr, sizeof(bool));
+    memcpy(&is_null, ptr, sizeof(bool));
     ptr += sizeof(bool);
     
+    size_t remaining = data_size - (ptr - (const char*)data);
+    rdb_value_t *v = NULL;
+    
     /* Read value data */
-    if (!v->is_null) {
-        switch (v->type) {
-            case RDB_TYPE_INT:
-                if (data_size < sizeof(rdb_data_type_t) + sizeof(bool) + sizeof(int64_t)) {
-                    free(v);
-                    return -1;
-                }
-                memcpy(&v->data.int_val, ptr, sizeof(int64_t));
+    if (is_null) {
+        v = rdb_create_null_value(type);
+    } else {
+        switch (type) {
+            case RDB_TYPE_INT: {
+                int64_t int_val;
+                if (remaining < sizeof(int64_t)) return -1;
+                memcpy(&int_val, ptr, sizeof(int64_t));
+                v = rdb_create_int_value(int_val);
                 break;
-            case RDB_TYPE_FLOAT:
-                if (data_size < sizeof(rdb_data_type_t) + sizeof(bool) + sizeof(double)) {
-                    free(v);
-                    return -1;
-                }
-                memcpy(&v->data.float_val, ptr, sizeof(double));
+            }
+            case RDB_TYPE_FLOAT: {
+                double float_val;
+                if (remaining < sizeof(double)) return -1;
+                memcpy(&float_val, ptr, sizeof(double));
+                v = rdb_create_float_value(float_val);
                 break;
+            }
             case RDB_TYPE_VARCHAR:
-            case RDB_TYPE_TEXT:
-                {
-                    size_t remaining = data_size - (ptr - (const char*)data);
-                    v->data.string_val = malloc(remaining);
-                    if (!v->data.string_val) {
-                        free(v);
-                        return -1;
-                    }
-                    strcpy(v->data.string_val, ptr);
-                }
+            case RDB_TYPE_TEXT: {
+                const char *end = memchr(ptr, '\0', remaining);
+                if (!end) return -1;
+                v = rdb_create_string_value_n(ptr, end - ptr);
+                if (v) v->type = type;
                 break;
-            case RDB_TYPE_BOOLEAN:
-                if (data_size < sizeof(rdb_data_type_t) + sizeof(bool) + sizeof(bool)) {
-                    free(v);
-                    return -1;
-                }
-                memcpy(&v->data.bool_val, ptr, sizeof(bool));
+            }
+            case RDB_TYPE_BOOLEAN: {
+                bool bool_val;
+                if (remaining < sizeof(bool)) return -1;
+                memcpy(&bool_val, ptr, sizeof(bool));
+                v = rdb_create_bool_value(bool_val);
                 break;
+            }
             default:
-                free(v);
                 return -1;
         }
     }
+    if (!v) return -1;
     
     *value = v;
     return 0;
@@ -1174,6 +1234,12 @@ static int rdb_deserialize_column(const void *data, size_t data_size, rdb_column
 
 /* Serialize a row */
 int rdb_serialize_row(rdb_row_t *row, void **data, size_t *data_size) {
+    return rdb_serialize_row_encoded(row, NULL, data, data_size);
+}
+
+/* Serialize a row; cells of dictionary-encoded columns are written as codes */
+static int rdb_serialize_row_encoded(rdb_row_t *row, fi_array *dictionaries,
+                                     void **data, size_t *data_size) {
     if (!row || !data || !data_size) return -1;
     
     size_t total_size = sizeof(size_t); /* row_id */
@@ -1189,7 +1255,8 @@ int rdb_serialize_row(rdb_row_t *row, void **data, size_t *data_size) {
                 void *value_data = NULL;
                 size_t value_data_size = 0;
                 
-                if (rdb_serialize_value(*value_ptr, &value_data, &value_data_size) == 0) {
+                if (rdb_serialize_value_encoded(*value_ptr, rdb_persistence_dictionary(dictionaries, i),
+                                                &value_data, &value_data_size) == 0) {
                     total_size += sizeof(size_t) + value_data_size; /* size + data */
                     free(value_data);
                 }
@@ -1219,7 +1286,8 @@ int rdb_serialize_row(rdb_row_t *row, void **data, size_t *data_size) {
                 void *value_data = NULL;
                 size_t value_data_size = 0;
                 
-                if (rdb_serialize_value(*value_ptr, &value_data, &value_data_size) == 0) {
+                if (rdb_serialize_value_encoded(*value_ptr, rdb_persistence_dictionary(dictionaries, i),
+                                                &value_data, &value_data_size) == 0) {
                     memcpy(ptr, &value_data_size, sizeof(size_t));
                     ptr += sizeof(size_t);
                     memcpy(ptr, value_data, value_data_size);
@@ -1240,6 +1308,12 @@ int rdb_serialize_row(rdb_row_t *row, void **data, size_t *data_size) {
 
 /* Deserialize a row */
 int rdb_deserialize_row(const void *data, size_t data_size, rdb_row_t **row) {
+    return rdb_deserialize_row_encoded(data, data_size, NULL, row);
+}
+
+/* Deserialize a row, resolving dictionary codes against `dictionaries` */
+static int rdb_deserialize_row_encoded(const void *data, size_t data_size, fi_array *dictionaries,
+                                       rdb_row_t **row) {
     if (!data || !row || data_size < sizeof(size_t)) return -1;
     
     rdb_row_t *r = malloc(sizeof(rdb_row_t));
@@ -1249,6 +1323,7 @@ int rdb_deserialize_row(const void *data, size_t data_size, rdb_row_t **row) {
     
     /* Read row_id */
     memcpy(&r->row_id, ptr, sizeof(size_t));
+    r->deleted = false;
     ptr += sizeof(size_t);
     
     /* Read values */
@@ -1273,7 +1348,14 @@ int rdb_deserialize_row(const void *data, size_t data_size, rdb_row_t **row) {
             if (ptr + value_data_size > (const char*)data + data_size) break;
             
             rdb_value_t *value = NULL;
-            if (rdb_deserialize_value(ptr, value_data_size, &value) == 0) {
+            int type = 0;
+            if (value_data_size >= sizeof(rdb_data_type_t)) memcpy(&type, ptr, sizeof(rdb_data_type_t));
+
+            int status = (type & RDB_SERIALIZED_DICT_CODE)
+                ? rdb_deserialize_dict_code(ptr, value_data_size,
+                                            rdb_persistence_dictionary(dictionaries, i), &value)
+                : rdb_deserialize_value(ptr, value_data_size, &value);
+            if (status == 0) {
                 fi_array_push(r->values, &value);
             }
             ptr += value_data_size;
@@ -1286,6 +1368,156 @@ int rdb_deserialize_row(const void *data, size_t data_size, rdb_row_t **row) {
     return 0;
 }
 
+/* Append `size` bytes to a growing section buffer */
+static int rdb_section_put(char **buffer, size_t *length, size_t *capacity, const void *bytes, size_t size) {
+    if (*length + size > *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 256;
+        while (new_capacity < *length + size) new_capacity *= 2;
+        char *grown = realloc(*buffer, new_capacity);
+        if (!grown) return -1;
+        *buffer = grown;
+        *capacity = new_capacity;
+    }
+    memcpy(*buffer + *length, bytes, size);
+    *length += size;
+    return 0;
+}
+
+/* Append a value as its serialized size and bytes */
+static int rdb_section_put_value(char **buffer, size_t *length, size_t *capacity, const rdb_value_t *value) {
+    void *value_data = NULL;
+    size_t value_size = 0;
+    if (rdb_serialize_value(value, &value_data, &value_size) != 0) return -1;
+
+    uint32_t size = (uint32_t)value_size;
+    int result = rdb_section_put(buffer, length, capacity, &size, sizeof(uint32_t)) == 0 &&
+                 rdb_section_put(buffer, length, capacity, value_data, value_size) == 0 ? 0 : -1;
+    free(value_data);
+    return result;
+}
+
+/* Serialize ANALYZE statistics: magic, row count, analyze time and column
+ * count, then per column its null fraction, distinct count, MCV and bound
+ * counts, the MCV fractions, and the MCV and bound values */
+static int rdb_serialize_stats(const rdb_table_stats_t *stats, void **data, size_t *data_size) {
+    char *buffer = NULL;
+    size_t length = 0, capacity = 0;
+    uint32_t magic = RDB_STATS_SECTION_MAGIC;
+    uint64_t row_count = stats->row_count;
+    int64_t analyzed_time = (int64_t)stats->analyzed_time;
+    uint32_t column_count = (uint32_t)stats->column_count;
+
+    int result = rdb_section_put(&buffer, &length, &capacity, &magic, sizeof(uint32_t)) |
+                 rdb_section_put(&buffer, &length, &capacity, &row_count, sizeof(uint64_t)) |
+                 rdb_section_put(&buffer, &length, &capacity, &analyzed_time, sizeof(int64_t)) |
+                 rdb_section_put(&buffer, &length, &capacity, &column_count, sizeof(uint32_t));
+
+    for (size_t c = 0; c < stats->column_count && result == 0; c++) {
+        const rdb_column_stats_t *column = &stats->columns[c];
+        uint32_t mcv_count = (uint32_t)column->mcv_count;
+        uint32_t bound_count = (uint32_t)column->bound_count;
+        result |= rdb_section_put(&buffer, &length, &capacity, &column->null_fraction, sizeof(double));
+        result |= rdb_section_put(&buffer, &length, &capacity, &column->distinct_count, sizeof(double));
+        result |= rdb_section_put(&buffer, &length, &capacity, &mcv_count, sizeof(uint32_t));
+        result |= rdb_section_put(&buffer, &length, &capacity, &bound_count, sizeof(uint32_t));
+        for (size_t i = 0; i < column->mcv_count && result == 0; i++) {
+            result |= rdb_section_put(&buffer, &length, &capacity, &column->mcv_fractions[i], sizeof(double));
+            result |= rdb_section_put_value(&buffer, &length, &capacity, column->mcv_values[i]);
+        }
+        for (size_t i = 0; i < column->bound_count && result == 0; i++) {
+            result |= rdb_section_put_value(&buffer, &length, &capacity, column->bounds[i]);
+        }
+    }
+
+    if (result != 0) {
+        free(buffer);
+        return -1;
+    }
+    *data = buffer;
+    *data_size = length;
+    return 0;
+}
+
+/* Read `size` bytes of a section, failing past its end */
+static bool rdb_section_get(const char **ptr, const char *end, void *bytes, size_t size) {
+    if ((size_t)(end - *ptr) < size) return false;
+    memcpy(bytes, *ptr, size);
+    *ptr += size;
+    return true;
+}
+
+static rdb_value_t* rdb_section_get_value(const char **ptr, const char *end) {
+    uint32_t size;
+    rdb_value_t *value = NULL;
+    if (!rdb_section_get(ptr, end, &size, sizeof(uint32_t)) || (size_t)(end - *ptr) < size) return NULL;
+    if (rdb_deserialize_value(*ptr, size, &value) != 0) return NULL;
+    *ptr += size;
+    return value;
+}
+
+/* Read the statistics section at `*ptr`, if there is one. Returns NULL when
+ * it is missing, damaged, or made for another number of columns. */
+static rdb_table_stats_t* rdb_deserialize_stats(const char **ptr, const char *end, size_t column_count) {
+    uint32_t magic = 0;
+    if ((size_t)(end - *ptr) < sizeof(uint32_t)) return NULL;
+    memcpy(&magic, *ptr, sizeof(uint32_t));
+    if (magic != RDB_STATS_SECTION_MAGIC) return NULL;
+    *ptr += sizeof(uint32_t);
+
+    uint64_t row_count;
+    int64_t analyzed_time;
+    uint32_t stats_columns;
+    if (!rdb_section_get(ptr, end, &row_count, sizeof(uint64_t)) ||
+        !rdb_section_get(ptr, end, &analyzed_time, sizeof(int64_t)) ||
+        !rdb_section_get(ptr, end, &stats_columns, sizeof(uint32_t)) ||
+        stats_columns != column_count) {
+        return NULL;
+    }
+
+    rdb_table_stats_t *stats = rdb_table_stats_create(column_count);
+    if (!stats) return NULL;
+    stats->row_count = (size_t)row_count;
+    stats->analyzed_time = (time_t)analyzed_time;
+
+    bool ok = true;
+    for (size_t c = 0; c < column_count && ok; c++) {
+        rdb_column_stats_t *column = &stats->columns[c];
+        uint32_t mcv_count, bound_count;
+        ok = rdb_section_get(ptr, end, &column->null_fraction, sizeof(double)) &&
+             rdb_section_get(ptr, end, &column->distinct_count, sizeof(double)) &&
+             rdb_section_get(ptr, end, &mcv_count, sizeof(uint32_t)) &&
+             rdb_section_get(ptr, end, &bound_count, sizeof(uint32_t)) &&
+             mcv_count <= (size_t)(end - *ptr) && bound_count <= (size_t)(end - *ptr);
+        if (!ok) break;
+
+        if (mcv_count > 0) {
+            column->mcv_values = calloc(mcv_count, sizeof(rdb_value_t*));
+            column->mcv_fractions = calloc(mcv_count, sizeof(double));
+            ok = column->mcv_values && column->mcv_fractions;
+        }
+        for (uint32_t i = 0; i < mcv_count && ok; i++) {
+            ok = rdb_section_get(ptr, end, &column->mcv_fractions[i], sizeof(double)) &&
+                 (column->mcv_values[i] = rdb_section_get_value(ptr, end)) != NULL;
+            if (ok) column->mcv_count++;
+        }
+
+        if (ok && bound_count > 0) {
+            column->bounds = calloc(bound_count, sizeof(rdb_value_t*));
+            ok = column->bounds != NULL;
+        }
+        for (uint32_t i = 0; i < bound_count && ok; i++) {
+            ok = (column->bounds[i] = rdb_section_get_value(ptr, end)) != NULL;
+            if (ok) column->bound_count++;
+        }
+    }
+
+    if (!ok) {
+        rdb_table_stats_destroy(stats);
+        return NULL;
+    }
+    return stats;
+}
+
 /* Serialize a table */
 int rdb_serialize_table(rdb_table_t *table, void **data, size_t *data_size) {
     if (!table || !data || !data_size) return -1;
@@ -1299,6 +1531,34 @@ int rdb_serialize_table(rdb_table_t *table, void **data, size_t *data_size) {
     total_size += 64; /* primary key */
     total_size += sizeof(size_t); /* next_row_id */
     
+    /* Column dictionaries: magic, column count, then per column the entry
+     * count and each entry as length + bytes, in code order */
+    if (table->dictionaries) {
+        total_size += 2 * sizeof(uint32_t);
+        for (size_t i = 0; i < fi_array_count(table->dictionaries); i++) {
+            rdb_string_dict_t *dict = rdb_persistence_dictionary(table->dictionaries, i);
+            total_size += sizeof(uint32_t);
+            for (size_t code = 0; code < rdb_string_dict_count(dict); code++) {
+                total_size += sizeof(uint32_t) + rdb_string_dict_entry(dict, (uint32_t)code)->length;
+            }
+        }
+    }
+    
+    /* Zone maps: magic, column count, block count, then the live row count
+     * of every block and the block_count * column_count summaries */
+    if (table->zones) {
+        total_size += 2 * sizeof(uint32_t) + sizeof(uint64_t);
+        total_size += table->zones->block_count *
+                      (sizeof(uint32_t) + table->zones->column_count * sizeof(rdb_zone_t));
+    }
+    
+    /* Statistics from the last ANALYZE */
+    void *stats_data = NULL;
+    size_t stats_size = 0;
+    if (table->stats && rdb_serialize_stats(table->stats, &stats_data, &stats_size) == 0) {
+        total_size += stats_size;
+    }
+    
     /* Calculate columns size */
     if (table->columns) {
         size_t column_count = fi_array_count(table->columns);
@@ -1310,10 +1570,11 @@ int rdb_serialize_table(rdb_table_t *table, void **data, size_t *data_size) {
         size_t row_count = fi_array_count(table->rows);
         for (size_t i = 0; i < row_count; i++) {
             rdb_row_t **row_ptr = (rdb_row_t**)fi_array_get(table->rows, i);
-            if (row_ptr && *row_ptr) {
+            if (row_ptr && *row_ptr && !(*row_ptr)->deleted) {
                 void *row_data = NULL;
                 size_t row_data_size = 0;
-                if (rdb_serialize_row(*row_ptr, &row_data, &row_data_size) == 0) {
+                if (rdb_serialize_row_encoded(*row_ptr, table->dictionaries,
+                                              &row_data, &row_data_size) == 0) {
                     total_size += sizeof(size_t) + row_data_size;
                     free(row_data);
                 }
@@ -1321,9 +1582,17 @@ int rdb_serialize_table(rdb_table_t *table, void **data, size_t *data_size) {
         }
     }
     
+    /* Storage layout: magic, then the mode, written for columnar tables only */
+    if (table->storage == RDB_STORAGE_COLUMNAR) {
+        total_size += 2 * sizeof(uint32_t);
+    }
+    
     /* Allocate buffer */
     void *buffer = malloc(total_size);
-    if (!buffer) return -1;
+    if (!buffer) {
+        free(stats_data);
+        return -1;
+    }
     
     char *ptr = (char*)buffer;
     
@@ -1348,19 +1617,20 @@ int rdb_serialize_table(rdb_table_t *table, void **data, size_t *data_size) {
         }
     }
     
-    /* Write row count */
-    size_t row_count = table->rows ? fi_array_count(table->rows) : 0;
+    /* Write row count (tombstoned rows are not persisted) */
+    size_t row_count = rdb_table_live_row_count(table);
     memcpy(ptr, &row_count, sizeof(size_t));
     ptr += sizeof(size_t);
     
     /* Write rows */
     if (table->rows) {
-        for (size_t i = 0; i < row_count; i++) {
+        for (size_t i = 0; i < fi_array_count(table->rows); i++) {
             rdb_row_t **row_ptr = (rdb_row_t**)fi_array_get(table->rows, i);
-            if (row_ptr && *row_ptr) {
+            if (row_ptr && *row_ptr && !(*row_ptr)->deleted) {
                 void *row_data = NULL;
                 size_t row_data_size = 0;
-                if (rdb_serialize_row(*row_ptr, &row_data, &row_data_size) == 0) {
+                if (rdb_serialize_row_encoded(*row_ptr, table->dictionaries,
+                                              &row_data, &row_data_size) == 0) {
                     memcpy(ptr, &row_data_size, sizeof(size_t));
                     ptr += sizeof(size_t);
                     memcpy(ptr, row_data, row_data_size);
@@ -1378,6 +1648,69 @@ int rdb_serialize_table(rdb_table_t *table, void **data, size_t *data_size) {
     
     /* Write next_row_id */
     memcpy(ptr, &table->next_row_id, sizeof(size_t));
+    ptr += sizeof(size_t);
+    
+    /* Write column dictionaries */
+    if (table->dictionaries) {
+        uint32_t magic = RDB_DICT_SECTION_MAGIC;
+        uint32_t dict_columns = (uint32_t)fi_array_count(table->dictionaries);
+        memcpy(ptr, &magic, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+        memcpy(ptr, &dict_columns, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+        
+        for (uint32_t i = 0; i < dict_columns; i++) {
+            rdb_string_dict_t *dict = rdb_persistence_dictionary(table->dictionaries, i);
+            uint32_t count = (uint32_t)rdb_string_dict_count(dict);
+            memcpy(ptr, &count, sizeof(uint32_t));
+            ptr += sizeof(uint32_t);
+            
+            for (uint32_t code = 0; code < count; code++) {
+                const rdb_string_t *entry = rdb_string_dict_entry(dict, code);
+                memcpy(ptr, &entry->length, sizeof(uint32_t));
+                ptr += sizeof(uint32_t);
+                memcpy(ptr, entry->data, entry->length);
+                ptr += entry->length;
+            }
+        }
+    }
+    
+    /* Write zone maps */
+    if (table->zones) {
+        uint32_t magic = RDB_ZONE_SECTION_MAGIC;
+        uint32_t zone_columns = (uint32_t)table->zones->column_count;
+        uint64_t blocks = table->zones->block_count;
+        memcpy(ptr, &magic, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+        memcpy(ptr, &zone_columns, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+        memcpy(ptr, &blocks, sizeof(uint64_t));
+        ptr += sizeof(uint64_t);
+        
+        if (blocks > 0) {
+            memcpy(ptr, table->zones->row_counts, blocks * sizeof(uint32_t));
+            ptr += blocks * sizeof(uint32_t);
+            memcpy(ptr, table->zones->zones, blocks * zone_columns * sizeof(rdb_zone_t));
+            ptr += blocks * zone_columns * sizeof(rdb_zone_t);
+        }
+    }
+    
+    /* Write storage layout */
+    if (table->storage == RDB_STORAGE_COLUMNAR) {
+        uint32_t magic = RDB_STORAGE_SECTION_MAGIC;
+        uint32_t mode = (uint32_t)table->storage;
+        memcpy(ptr, &magic, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+        memcpy(ptr, &mode, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+    }
+    
+    /* Write statistics */
+    if (stats_data) {
+        memcpy(ptr, stats_data, stats_size);
+        ptr += stats_size;
+        free(stats_data);
+    }
     
     *data = buffer;
     *data_size = total_size;
@@ -1392,6 +1725,7 @@ int rdb_deserialize_table(const void *data, size_t data_size, rdb_table_t **tabl
     if (!t) return -1;
     
     const char *ptr = (const char*)data;
+    const char *end = ptr + data_size;
     
     /* Read table name */
     strncpy(t->name, ptr, 63);
@@ -1431,11 +1765,124 @@ int rdb_deserialize_table(const void *data, size_t data_size, rdb_table_t **tabl
     memcpy(&row_count, ptr, sizeof(size_t));
     ptr += sizeof(size_t);
     
+    /* The column dictionaries follow the rows, and the rows need them:
+     * skip ahead to the trailer first */
+    const char *rows_start = ptr;
+    for (size_t i = 0; i < row_count; i++) {
+        size_t row_data_size;
+        if (ptr + sizeof(size_t) > end) break;
+        memcpy(&row_data_size, ptr, sizeof(size_t));
+        ptr += sizeof(size_t) + row_data_size;
+    }
+    if (ptr + 64 + sizeof(size_t) > end) {
+        if (t->columns) fi_array_destroy(t->columns);
+        free(t);
+        return -1;
+    }
+    
+    /* Read primary key */
+    strncpy(t->primary_key, ptr, 63);
+    t->primary_key[63] = '\0';
+    ptr += 64;
+    
+    /* Read next_row_id */
+    memcpy(&t->next_row_id, ptr, sizeof(size_t));
+    ptr += sizeof(size_t);
+    
+    /* Read column dictionaries (absent in files written before them) */
+    t->dictionaries = NULL;
+    uint32_t magic = 0;
+    if (ptr + 2 * sizeof(uint32_t) <= end) memcpy(&magic, ptr, sizeof(uint32_t));
+    if (magic == RDB_DICT_SECTION_MAGIC) {
+        uint32_t dict_columns;
+        memcpy(&dict_columns, ptr + sizeof(uint32_t), sizeof(uint32_t));
+        ptr += 2 * sizeof(uint32_t);
+        
+        t->dictionaries = fi_array_create(dict_columns ? dict_columns : 1, sizeof(rdb_string_dict_t*));
+        for (uint32_t i = 0; t->dictionaries && i < dict_columns; i++) {
+            uint32_t count = 0;
+            if (ptr + sizeof(uint32_t) <= end) memcpy(&count, ptr, sizeof(uint32_t));
+            ptr += sizeof(uint32_t);
+            
+            rdb_string_dict_t *dict = count > 0 ? rdb_string_dict_create() : NULL;
+            for (uint32_t code = 0; dict && code < count; code++) {
+                uint32_t length;
+                if (ptr + sizeof(uint32_t) > end) break;
+                memcpy(&length, ptr, sizeof(uint32_t));
+                ptr += sizeof(uint32_t);
+                if (ptr + length > end) break;
+                
+                /* Entries were written in code order, so re-adding them
+                 * reproduces the codes */
+                char *text = malloc(length + 1);
+                if (!text) break;
+                memcpy(text, ptr, length);
+                text[length] = '\0';
+                rdb_string_dict_add(dict, text, length);
+                free(text);
+                ptr += length;
+            }
+            fi_array_push(t->dictionaries, &dict);
+        }
+    }
+    
+    /* Read zone maps (rebuilt from the rows when absent or not matching
+     * the columns) */
+    t->zones = NULL;
+    magic = 0;
+    if (ptr + 2 * sizeof(uint32_t) + sizeof(uint64_t) <= end) memcpy(&magic, ptr, sizeof(uint32_t));
+    if (magic == RDB_ZONE_SECTION_MAGIC) {
+        uint32_t zone_columns;
+        uint64_t blocks;
+        memcpy(&zone_columns, ptr + sizeof(uint32_t), sizeof(uint32_t));
+        memcpy(&blocks, ptr + 2 * sizeof(uint32_t), sizeof(uint64_t));
+        ptr += 2 * sizeof(uint32_t) + sizeof(uint64_t);
+        
+        size_t column_total = t->columns ? fi_array_count(t->columns) : 0;
+        size_t block_size = sizeof(uint32_t) + zone_columns * sizeof(rdb_zone_t);
+        if (blocks <= (size_t)(end - ptr) / block_size) {
+            if (zone_columns == column_total) t->zones = rdb_zone_map_create(column_total);
+            if (t->zones && blocks > 0) {
+                t->zones->row_counts = malloc(blocks * sizeof(uint32_t));
+                t->zones->zones = malloc(blocks * (column_total ? column_total : 1) * sizeof(rdb_zone_t));
+                if (t->zones->row_counts && t->zones->zones) {
+                    memcpy(t->zones->row_counts, ptr, blocks * sizeof(uint32_t));
+                    memcpy(t->zones->zones, ptr + blocks * sizeof(uint32_t),
+                           blocks * column_total * sizeof(rdb_zone_t));
+                    t->zones->block_count = blocks;
+                } else {
+                    rdb_zone_map_destroy(t->zones);
+                    t->zones = NULL;
+                }
+            }
+            ptr += blocks * block_size;
+        } else {
+            ptr = end;
+        }
+    }
+    
+    /* Read storage layout (row storage when absent) */
+    t->storage = RDB_STORAGE_ROW;
+    magic = 0;
+    if (ptr + 2 * sizeof(uint32_t) <= end) memcpy(&magic, ptr, sizeof(uint32_t));
+    if (magic == RDB_STORAGE_SECTION_MAGIC) {
+        uint32_t mode;
+        memcpy(&mode, ptr + sizeof(uint32_t), sizeof(uint32_t));
+        ptr += 2 * sizeof(uint32_t);
+        if (mode == RDB_STORAGE_COLUMNAR) t->storage = RDB_STORAGE_COLUMNAR;
+    }
+    
+    /* Read statistics from the last ANALYZE */
+    t->stats = rdb_deserialize_stats(&ptr, end, t->columns ? fi_array_count(t->columns) : 0);
+    
     /* Read rows */
+    ptr = rows_start;
     if (row_count > 0) {
         t->rows = fi_array_create(row_count, sizeof(rdb_row_t*));
         if (!t->rows) {
             if (t->columns) fi_array_destroy(t->columns);
+            rdb_zone_map_destroy(t->zones);
+            rdb_table_stats_destroy(t->stats);
             free(t);
             return -1;
         }
@@ -1446,25 +1893,38 @@ int rdb_deserialize_table(const void *data, size_t data_size, rdb_table_t **tabl
             ptr += sizeof(size_t);
             
             rdb_row_t *row = NULL;
-            if (rdb_deserialize_row(ptr, row_data_size, &row) == 0) {
+            if (rdb_deserialize_row_encoded(ptr, row_data_size, t->dictionaries, &row) == 0) {
                 fi_array_push(t->rows, &row);
             }
             ptr += row_data_size;
         }
     } else {
-        t->rows = NULL;
+        t->rows = fi_array_create(100, sizeof(rdb_row_t*));
+    }
+    if (!t->zones) rdb_zone_map_rebuild(t);
+    
+    /* Initialize other fields (indexes and the column store are not persisted;
+     * tables reload with only their constraint indexes, and the column
+     * store of a columnar table is rebuilt from the rows below) */
+    t->column_store = NULL;
+    t->record_layout = NULL;
+    t->dead_rows = 0;
+    t->foreign_keys = NULL;
+    t->referenced_by = NULL;
+    t->workers = NULL;
+    t->row_map = NULL;
+    rdb_table_build_row_map(t);
+    rdb_table_init_dictionaries(t);
+    t->indexes = fi_map_create(8, sizeof(char*), sizeof(rdb_index_t*),
+                               fi_map_hash_string, fi_map_compare_string);
+    rdb_table_create_constraint_indexes(t);
+    if (t->storage == RDB_STORAGE_COLUMNAR) {
+        t->column_store = rdb_column_store_create(t);
+        if (!t->column_store) {
+            printf("Error: Failed to build column store for table '%s', using row storage\n", t->name);
+            t->storage = RDB_STORAGE_ROW;
+        }
     }
-    
-    /* Read primary key */
-    strncpy(t->primary_key, ptr, 63);
-    t->primary_key[63] = '\0';
-    ptr += 64;
-    
-    /* Read next_row_id */
-    memcpy(&t->next_row_id, ptr, sizeof(size_t));
-    
-    /* Initialize other fields */
-    t->indexes = NULL;
     pthread_mutex_init(&t->rwlock, NULL);
     pthread_mutex_init(&t->mutex, NULL);
     
@@ -1577,10 +2037,11 @@ static int rdb_persistence_save_table(rdb_persistence_manager_t *pm, rdb_table_t
     metadata->table_name[63] = '\0';
     metadata->first_page_id = 1;
     metadata->last_page_id = 1;
-    metadata->row_count = table->rows ? fi_array_count(table->rows) : 0;
+    metadata->row_count = rdb_table_live_row_count(table);
     metadata->total_pages = 1;
     metadata->created_time = time(NULL);
     metadata->last_modified = time(NULL);
+    metadata->analyzed_time = table->stats ? table->stats->analyzed_time : 0;
     metadata->is_compressed = false;
     metadata->compression_type = 0;
     
@@ -1688,6 +2149,7 @@ static int rdb_persistence_load_table(rdb_persistence_manager_t *pm, rdb_databas
     strcpy(table_name_copy, table_name);
     
     /* Add table to database */
+    table->workers = db->workers;
     if (fi_map_put(db->tables, &table_name_copy, &table) != 0) {
         free(table_name_copy);
         rdb_destroy_table(table);
@@ -1717,35 +2179,28 @@ static int rdb_persistence_save_foreign_keys(rdb_persistence_manager_t *pm, rdb_
     }
     
     /* Write foreign keys */
-    if (db->foreign_keys && fk_count > 0) {
-        fi_map_iterator iter = fi_map_iterator_create(db->foreign_keys);
-        while (fi_map_iterator_next(&iter)) {
-            const char *constraint_name = (const char*)fi_map_iterator_key(&iter);
-            rdb_foreign_key_t **fk_ptr = (rdb_foreign_key_t**)fi_map_iterator_value(&iter);
-            
-            if (fk_ptr && *fk_ptr) {
-                /* Write constraint name length and name */
-                size_t name_len = strlen(constraint_name);
-                if (write(fk_fd, &name_len, sizeof(size_t)) != sizeof(size_t)) {
-                    close(fk_fd);
-                    return -1;
-                }
-                if (write(fk_fd, constraint_name, name_len) != (ssize_t)name_len) {
-                    close(fk_fd);
-                    return -1;
-                }
-                
-                /* Write foreign key structure */
-                if (write(fk_fd, *fk_ptr, sizeof(rdb_foreign_key_t)) != sizeof(rdb_foreign_key_t)) {
-                    close(fk_fd);
-                    return -1;
-                }
-            }
+    int result = 0;
+    fi_array *fks = fk_count > 0 ? fi_map_values(db->foreign_keys) : NULL;
+    for (size_t i = 0; fks && i < fi_array_count(fks) && result == 0; i++) {
+        rdb_foreign_key_t *fk = *(rdb_foreign_key_t**)fi_array_get(fks, i);
+        if (!fk) continue;
+
+        /* Write constraint name length and name */
+        size_t name_len = strlen(fk->constraint_name);
+        if (write(fk_fd, &name_len, sizeof(size_t)) != sizeof(size_t) ||
+            write(fk_fd, fk->constraint_name, name_len) != (ssize_t)name_len) {
+            result = -1;
+        }
+
+        /* Write foreign key structure */
+        if (result == 0 && write(fk_fd, fk, sizeof(rdb_foreign_key_t)) != sizeof(rdb_foreign_key_t)) {
+            result = -1;
         }
     }
+    if (fks) fi_array_destroy(fks);
     
     close(fk_fd);
-    return 0;
+    return result;
 }
 
 /* Load foreign key constraints */
@@ -1809,13 +2264,15 @@ static int rdb_persistence_load_foreign_keys(rdb_persistence_manager_t *pm, rdb_
             return -1;
         }
         
-        /* Add to database */
-        if (fi_map_put(db->foreign_keys, constraint_name, &fk) != 0) {
+        /* Add to database; the map key points at the name inside the constraint */
+        const char *key = fk->constraint_name;
+        if (fi_map_put(db->foreign_keys, &key, &fk) != 0) {
             free(constraint_name);
             free(fk);
             close(fk_fd);
             return -1;
         }
+        rdb_link_foreign_key(db, fk);
         
         free(constraint_name);
     }
@@ -92,6 +92,7 @@ typedef struct {
     uint64_t total_pages;        /* Total pages used by table */
     time_t created_time;         /* Table creation time */
     time_t last_modified;        /* Last modification time */
+    time_t analyzed_time;        /* Last ANALYZE (statistics saved in the table file), 0 if never */
     bool is_compressed;          /* Whether table data is compressed */
     uint32_t compression_type;   /* Compression algorithm used */
 } rdb_persistent_table_metadata_t;
@@ -0,0 +1,310 @@
+#include "test_support.h"
+#include <pthread.h>
+
+#define THREADS 4
+#define ITERATIONS 200
+
+/* Prepared statements and the statement cache: bindings, re-execution,
+ * reuse of cached statements, LRU eviction, and that a statement is only
+ * ever handed to one caller at a time. Cache hits and misses are counted
+ * with rdb_statement_cache_stats(). */
+
+static rdb_database_t *db = NULL;
+static size_t last_hits = 0;
+static size_t last_misses = 0;
+
+static rdb_database_t* create_database(void) {
+    rdb_database_t *database = test_open_database("prepare_test");
+    assert(test_exec(database, "CREATE TABLE kv (id INT, name VARCHAR(32), score INT)") == 0);
+    return database;
+}
+
+/* Check the cache hits and misses since the last call */
+static void expect_cache(size_t hits, size_t misses) {
+    size_t total_hits, total_misses;
+    assert(rdb_statement_cache_stats(db, &total_hits, &total_misses) == 0);
+    if (total_hits - last_hits != hits || total_misses - last_misses != misses) {
+        printf("Expected %zu hits and %zu misses, got %zu and %zu\n", hits, misses,
+               total_hits - last_hits, total_misses - last_misses);
+        fflush(stdout);
+        assert(false);
+    }
+    last_hits = total_hits;
+    last_misses = total_misses;
+}
+
+static void reset_cache_counts(void) {
+    assert(rdb_statement_cache_stats(db, &last_hits, &last_misses) == 0);
+}
+
+/* Rows the SELECT returns; the first column of the last one goes to `first` */
+static size_t step_all(rdb_prepared_t *select, int64_t *first) {
+    size_t rows = 0;
+    int step;
+    while ((step = rdb_step(select)) == RDB_STEP_ROW) {
+        const rdb_value_t *value = rdb_column_value(select, 0);
+        if (first) *first = value->is_null ? -1 : rdb_get_int_value(value);
+        rows++;
+    }
+    assert(step == RDB_STEP_DONE);
+    return rows;
+}
+
+/* Single-value result of an aggregate query */
+static int64_t query_int(const char *sql) {
+    rdb_prepared_t *stmt = rdb_prepare(db, sql);
+    assert(stmt != NULL);
+    assert(rdb_step(stmt) == RDB_STEP_ROW);
+    int64_t value = rdb_get_int_value(rdb_column_value(stmt, 0));
+    assert(rdb_step(stmt) == RDB_STEP_DONE);
+    rdb_finalize(stmt);
+    return value;
+}
+
+static void test_bindings_persist(void) {
+    printf("Test: bindings persist across steps...\n");
+
+    rdb_prepared_t *insert = rdb_prepare(db, "INSERT INTO kv VALUES (?, ?, ?)");
+    assert(insert != NULL);
+    assert(rdb_parameter_count(insert) == 3);
+    assert(rdb_bind_int(insert, 1, 1) == 0);
+    assert(rdb_bind_string(insert, 2, "one") == 0);
+    assert(rdb_bind_int(insert, 3, 10) == 0);
+    assert(rdb_step(insert) == RDB_STEP_DONE);
+    assert(rdb_changes(insert) == 1);
+
+    /* Stepping again runs the statement again with the same values */
+    assert(rdb_step(insert) == RDB_STEP_DONE);
+    assert(query_int("SELECT COUNT(*) FROM kv WHERE id = 1 AND name = 'one' AND score = 10") == 2);
+
+    /* Rebinding one parameter keeps the others */
+    assert(rdb_bind_int(insert, 1, 2) == 0);
+    assert(rdb_step(insert) == RDB_STEP_DONE);
+    assert(query_int("SELECT COUNT(*) FROM kv WHERE id = 2 AND name = 'one' AND score = 10") == 1);
+
+    /* Out of range indexes are rejected */
+    assert(rdb_bind_int(insert, 0, 5) == -1);
+    assert(rdb_bind_int(insert, 4, 5) == -1);
+    rdb_finalize(insert);
+
+    rdb_prepared_t *select = rdb_prepare(db, "SELECT score, name FROM kv WHERE id = ?");
+    assert(select != NULL);
+    assert(rdb_bind_int(select, 1, 1) == 0);
+    int64_t score = 0;
+    assert(step_all(select, &score) == 2 && score == 10);
+    assert(step_all(select, &score) == 2 && score == 10);
+
+    /* rdb_reset() drops the unread rows; the binding stays */
+    assert(rdb_step(select) == RDB_STEP_ROW);
+    assert(rdb_reset(select) == 0);
+    assert(step_all(select, NULL) == 2);
+
+    assert(rdb_bind_int(select, 1, 2) == 0);
+    assert(step_all(select, NULL) == 1);
+    rdb_finalize(select);
+}
+
+static void test_clear_bindings(void) {
+    printf("Test: rdb_clear_bindings...\n");
+
+    rdb_prepared_t *select = rdb_prepare(db, "SELECT score FROM kv WHERE id = ?");
+    assert(select != NULL);
+    assert(rdb_bind_int(select, 1, 1) == 0);
+    assert(step_all(select, NULL) == 2);
+
+    /* id = NULL matches nothing */
+    assert(rdb_clear_bindings(select) == 0);
+    assert(step_all(select, NULL) == 0);
+    rdb_finalize(select);
+
+    rdb_prepared_t *insert = rdb_prepare(db, "INSERT INTO kv VALUES (?, ?, ?)");
+    assert(insert != NULL);
+    assert(rdb_bind_int(insert, 1, 3) == 0);
+    assert(rdb_bind_string(insert, 2, "three") == 0);
+    assert(rdb_bind_int(insert, 3, 30) == 0);
+    assert(rdb_clear_bindings(insert) == 0);
+    assert(rdb_step(insert) == RDB_STEP_DONE);
+    rdb_finalize(insert);
+
+    assert(query_int("SELECT COUNT(*) FROM kv WHERE id IS NULL AND name IS NULL AND score IS NULL") == 1);
+}
+
+static void test_cache_reuse(void) {
+    printf("Test: re-preparing reuses the cached statement...\n");
+
+    const char *sql = "SELECT score FROM kv WHERE id = ? AND name = ?";
+    reset_cache_counts();
+    rdb_prepared_t *first = rdb_prepare(db, sql);
+    assert(first != NULL);
+    expect_cache(0, 1);
+    assert(rdb_bind_int(first, 1, 1) == 0);
+    assert(rdb_bind_string(first, 2, "one") == 0);
+    assert(step_all(first, NULL) == 2);
+    rdb_finalize(first);
+
+    /* Same statement back, with its parameters NULL again */
+    rdb_prepared_t *again = rdb_prepare(db, sql);
+    expect_cache(1, 0);
+    assert(again == first);
+    assert(step_all(again, NULL) == 0);
+    rdb_finalize(again);
+
+    /* Only the exact same text is a hit */
+    rdb_prepared_t *other = rdb_prepare(db, "SELECT score FROM kv WHERE id = ?  AND name = ?");
+    assert(other != NULL && other != first);
+    expect_cache(0, 1);
+    rdb_finalize(other);
+}
+
+static void test_no_double_handout(void) {
+    printf("Test: a statement in use is not handed out twice...\n");
+
+    const char *sql = "SELECT score FROM kv WHERE id = ?";
+    reset_cache_counts();
+    rdb_prepared_t *a = rdb_prepare(db, sql);
+    rdb_prepared_t *b = rdb_prepare(db, sql);
+    assert(a != NULL && b != NULL && a != b);
+    expect_cache(1, 1);
+
+    /* Each caller keeps its own bindings and results */
+    int64_t score_a = 0, score_b = 0;
+    assert(rdb_bind_int(a, 1, 2) == 0);
+    assert(rdb_bind_int(b, 1, 1) == 0);
+    assert(rdb_step(a) == RDB_STEP_ROW);
+    assert(rdb_step(b) == RDB_STEP_ROW);
+    score_a = rdb_get_int_value(rdb_column_value(a, 0));
+    score_b = rdb_get_int_value(rdb_column_value(b, 0));
+    assert(score_a == 10 && score_b == 10);
+    assert(rdb_step(a) == RDB_STEP_DONE);
+    assert(rdb_step(b) == RDB_STEP_ROW);
+    assert(rdb_step(b) == RDB_STEP_DONE);
+
+    /* Both stay cached, and both come back while both are taken again */
+    rdb_finalize(a);
+    rdb_finalize(b);
+    rdb_prepared_t *c = rdb_prepare(db, sql);
+    rdb_prepared_t *d = rdb_prepare(db, sql);
+    expect_cache(2, 0);
+    assert((c == a && d == b) || (c == b && d == a));
+    rdb_finalize(c);
+    rdb_finalize(d);
+}
+
+static void* prepare_thread(void *arg) {
+    int64_t id = 100 + *(int*)arg;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        rdb_prepared_t *select = rdb_prepare(db, "SELECT score FROM kv WHERE id = ?");
+        assert(select != NULL);
+        assert(rdb_bind_int(select, 1, id) == 0);
+        int64_t score = 0;
+        assert(step_all(select, &score) == 1);
+        assert(score == id * 10);
+        rdb_finalize(select);
+    }
+    return NULL;
+}
+
+static void test_concurrent_prepare(void) {
+    printf("Test: concurrent callers preparing the same text...\n");
+
+    rdb_prepared_t *insert = rdb_prepare(db, "INSERT INTO kv VALUES (?, 'thread', ?)");
+    assert(insert != NULL);
+    for (int64_t id = 100; id < 100 + THREADS; id++) {
+        assert(rdb_bind_int(insert, 1, id) == 0);
+        assert(rdb_bind_int(insert, 2, id * 10) == 0);
+        assert(rdb_step(insert) == RDB_STEP_DONE);
+    }
+    rdb_finalize(insert);
+
+    pthread_t threads[THREADS];
+    int ids[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        ids[i] = i;
+        assert(pthread_create(&threads[i], NULL, prepare_thread, &ids[i]) == 0);
+    }
+    for (int i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+}
+
+static void prepare_nth(size_t n, rdb_prepared_t **out) {
+    char sql[64];
+    snprintf(sql, sizeof(sql), "SELECT score FROM kv WHERE id = %zu", n);
+    rdb_prepared_t *stmt = rdb_prepare(db, sql);
+    assert(stmt != NULL);
+    if (out) *out = stmt;
+    else rdb_finalize(stmt);
+}
+
+static void test_lru_eviction(void) {
+    printf("Test: LRU eviction at RDB_STATEMENT_CACHE_SIZE...\n");
+
+    /* A fresh database starts with an empty cache */
+    rdb_destroy_database(db);
+    db = create_database();
+    reset_cache_counts();
+
+    /* Fill the cache, then use statement 0 again so statement 1 is the
+     * least recently used */
+    for (size_t n = 0; n < RDB_STATEMENT_CACHE_SIZE; n++) prepare_nth(n, NULL);
+    expect_cache(0, RDB_STATEMENT_CACHE_SIZE);
+    prepare_nth(0, NULL);
+    expect_cache(1, 0);
+
+    /* One more evicts statement 1 */
+    prepare_nth(RDB_STATEMENT_CACHE_SIZE, NULL);
+    expect_cache(0, 1);
+    prepare_nth(0, NULL);
+    expect_cache(1, 0);
+    prepare_nth(1, NULL);
+    expect_cache(0, 1);
+
+    /* Re-adding statement 1 evicted statement 2, the next oldest */
+    for (size_t n = 3; n <= RDB_STATEMENT_CACHE_SIZE; n++) prepare_nth(n, NULL);
+    expect_cache(RDB_STATEMENT_CACHE_SIZE - 2, 0);
+    /* Statement 0 is now the least recently used and makes room for 2 */
+    prepare_nth(2, NULL);
+    expect_cache(0, 1);
+
+    /* Statements in use are never evicted: with all of them taken, a new
+     * text is parsed but not cached */
+    rdb_prepared_t *held[RDB_STATEMENT_CACHE_SIZE];
+    size_t count = 0;
+    for (size_t n = 0; n <= RDB_STATEMENT_CACHE_SIZE; n++) {
+        if (n == 0) continue;  /* Evicted by statement 2 */
+        prepare_nth(n, &held[count++]);
+    }
+    assert(count == RDB_STATEMENT_CACHE_SIZE);
+    expect_cache(RDB_STATEMENT_CACHE_SIZE, 0);
+
+    rdb_prepared_t *extra = NULL;
+    prepare_nth(1000, &extra);
+    expect_cache(0, 1);
+    rdb_finalize(extra);
+    prepare_nth(1000, NULL);
+    expect_cache(0, 1);
+
+    for (size_t i = 0; i < count; i++) {
+        assert(step_all(held[i], NULL) == 0);
+        rdb_finalize(held[i]);
+    }
+    prepare_nth(1, NULL);
+    expect_cache(1, 0);
+}
+
+int main() {
+    printf("=== FI RDB Prepared Statement Test ===\n\n");
+
+    db = create_database();
+
+    test_bindings_persist();
+    test_clear_bindings();
+    test_cache_reuse();
+    test_no_double_handout();
+    test_concurrent_prepare();
+    test_lru_eviction();
+
+    rdb_destroy_database(db);
+
+    printf("\nPrepared statement test PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "test_support.h"
+
+#define ROW_COUNT 500
+
+/* A column list returns those columns only, in list order, with the same
+ * values the full rows hold */
+
+/* Every row of `projected` holds columns `columns` of the same row of `full` */
+static void expect_projection(const test_result_t *projected, const test_result_t *full,
+                              const size_t *columns, size_t count) {
+    assert(projected != NULL && full != NULL);
+    assert(projected->rows == full->rows && projected->columns == count);
+    for (size_t r = 0; r < full->rows; r++) {
+        for (size_t c = 0; c < count; c++) {
+            assert(test_same_value(test_value(projected, r, c), test_value(full, r, columns[c])));
+        }
+    }
+}
+
+static void check_projection(rdb_database_t *db, const char *list, const char *rest,
+                             const size_t *columns, size_t count) {
+    test_result_t *projected = test_query(db, "SELECT %s FROM t %s", list, rest);
+    test_result_t *full = test_query(db, "SELECT * FROM t %s", rest);
+    expect_projection(projected, full, columns, count);
+    test_result_free(projected);
+    test_result_free(full);
+}
+
+int main() {
+    printf("=== FI RDB Projection Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("projection_test");
+    assert(test_exec(db, "CREATE TABLE t (id INT, name VARCHAR(32), price FLOAT, flag BOOLEAN)") == 0);
+    for (int i = 0; i < ROW_COUNT; i++) {
+        assert(test_exec(db, "INSERT INTO t VALUES (%d, %s, %.2f, %s)", i,
+                         i % 9 == 0 ? "NULL" : "'a name long enough to be shared'",
+                         i * 1.5, i % 2 ? "TRUE" : "FALSE") == 0);
+    }
+
+    printf("Checking column lists...\n");
+    const size_t all[] = {0, 1, 2, 3};
+    const size_t one[] = {2};
+    const size_t reordered[] = {3, 0, 1};
+    const size_t repeated[] = {0, 0, 2};
+    check_projection(db, "*", "", all, 4);
+    check_projection(db, "id, name, price, flag", "", all, 4);
+    check_projection(db, "price", "WHERE id < 50", one, 1);
+    check_projection(db, "flag, id, name", "WHERE flag = TRUE", reordered, 3);
+    check_projection(db, "id, id, price", "WHERE name IS NULL", repeated, 3);
+    check_projection(db, "flag, id, name", "ORDER BY price DESC LIMIT 20 OFFSET 3", reordered, 3);
+    check_projection(db, "price", "LIMIT 10", one, 1);
+
+    /* Sorting by a column left out of the list */
+    test_result_t *result = test_query(db, "SELECT name FROM t WHERE id >= 10 ORDER BY id DESC LIMIT 2");
+    assert(result != NULL && result->rows == 2 && result->columns == 1);
+    assert(strcmp(rdb_get_string_value(test_value(result, 0, 0)), "a name long enough to be shared") == 0);
+    test_result_free(result);
+
+    /* Unknown columns are errors, not silently dropped */
+    printf("Checking unknown columns...\n");
+    assert(test_query(db, "SELECT id, missing FROM t") == NULL);
+    assert(test_query(db, "SELECT missing FROM t ORDER BY id LIMIT 5") == NULL);
+
+    rdb_destroy_database(db);
+
+    printf("\nProjection test PASSED!\n");
+    return 0;
+}
@@ -1,14 +1,55 @@
 #include "rdb.h"
+#include "sql_parser.h"
+#include <strings.h>  /* for strcasecmp */
+#include <stddef.h>
+
+/* rdb_value_t must stay 16 bytes for inline strings to fit */
+typedef char rdb_value_size_check[sizeof(rdb_value_t) == 16 ? 1 : -1];
+
+/* Inline strings start at inline_str and continue into data */
+static char* rdb_value_inline_string(rdb_value_t *value) {
+    return (char*)value + offsetof(rdb_value_t, inline_str);
+}
+
+/* Shared strings */
+rdb_string_t* rdb_string_create(const char *value, size_t length) {
+    if (!value) return NULL;
+
+    if (length > UINT32_MAX) {
+        printf("Error: String value of %zu bytes is too long\n", length);
+        return NULL;
+    }
+
+    rdb_string_t *str = malloc(sizeof(rdb_string_t) + length + 1);
+    if (!str) return NULL;
+
+    str->dict = NULL;
+    atomic_init(&str->refcount, 1);
+    str->length = (uint32_t)length;
+    str->code = 0;
+    memcpy(str->data, value, length);
+    str->data[length] = '\0';
+    return str;
+}
+
+rdb_string_t* rdb_string_retain(rdb_string_t *str) {
+    if (str) atomic_fetch_add_explicit(&str->refcount, 1, memory_order_relaxed);
+    return str;
+}
+
+void rdb_string_release(rdb_string_t *str) {
+    if (str && atomic_fetch_sub_explicit(&str->refcount, 1, memory_order_acq_rel) == 1) {
+        free(str);
+    }
+}
 
 /* Memory management functions */
 void rdb_value_free(void *value) {
     if (!value) return;
 
     rdb_value_t *val = (rdb_value_t*)value;
-    if (val->type == RDB_TYPE_VARCHAR || val->type == RDB_TYPE_TEXT) {
-        if (val->data.string_val) {
-            free(val->data.string_val);
-        }
+    if (val->str_len == RDB_VALUE_SHARED_STRING) {
+        rdb_string_release(val->data.string_ref);
     }
     free(val);
 }
@@ -71,7 +112,7 @@ void rdb_join_condition_free(void *join_condition) {
 /* Transaction log entry management */
 rdb_transaction_log_entry_t* rdb_create_transaction_log_entry(rdb_operation_type_t op_type,
                                                              const char *table_name, size_t row_id,
-                                                             rdb_row_t *old_row, rdb_row_t *new_row) {
+                                                             rdb_record_t *old_record) {
     if (!table_name) return NULL;
 
     rdb_transaction_log_entry_t *entry = malloc(sizeof(rdb_transaction_log_entry_t));
@@ -82,27 +123,8 @@ rdb_transaction_log_entry_t* rdb_create_transaction_log_entry(rdb_operation_type
     entry->table_name[sizeof(entry->table_name) - 1] = '\0';
     entry->row_id = row_id;
 
-    /* Copy old row if provided */
-    if (old_row) {
-        entry->old_row = malloc(sizeof(rdb_row_t));
-        if (entry->old_row) {
-            entry->old_row->row_id = old_row->row_id;
-            entry->old_row->values = fi_array_copy(old_row->values);
-        }
-    } else {
-        entry->old_row = NULL;
-    }
-
-    /* Copy new row if provided */
-    if (new_row) {
-        entry->new_row = malloc(sizeof(rdb_row_t));
-        if (entry->new_row) {
-            entry->new_row->row_id = new_row->row_id;
-            entry->new_row->values = fi_array_copy(new_row->values);
-        }
-    } else {
-        entry->new_row = NULL;
-    }
+    /* The entry takes ownership of the packed before-image */
+    entry->old_record = old_record;
 
     entry->index_name[0] = '\0';
     entry->column_name[0] = '\0';
@@ -115,13 +137,7 @@ rdb_transaction_log_entry_t* rdb_create_transaction_log_entry(rdb_operation_type
 void rdb_destroy_transaction_log_entry(rdb_transaction_log_entry_t *entry) {
     if (!entry) return;
 
-    if (entry->old_row) {
-        rdb_row_free(entry->old_row);
-    }
-
-    if (entry->new_row) {
-        rdb_row_free(entry->new_row);
-    }
+    free(entry->old_record);
 
     if (entry->column_def) {
         rdb_column_free(entry->column_def);
@@ -273,29 +289,39 @@ int rdb_set_isolation_level(rdb_database_t *db, rdb_isolation_level_t level) {
     return 0;
 }
 
-/* Transaction logging functions */
+/* Transaction logging functions
+ * The log takes ownership of `old_record`, the packed image of the row
+ * before an UPDATE or DELETE (NULL for INSERT). */
 int rdb_log_operation(rdb_database_t *db, rdb_operation_type_t op_type, const char *table_name,
-                     size_t row_id, rdb_row_t *old_row, rdb_row_t *new_row) {
-    if (!db || !db->transaction_manager || !table_name) return -1;
+                     size_t row_id, rdb_record_t *old_record) {
+    if (!db || !db->transaction_manager || !table_name) {
+        free(old_record);
+        return -1;
+    }
 
     rdb_transaction_t *transaction = db->transaction_manager->current_transaction;
     if (!transaction) {
         /* If autocommit is enabled, create a temporary transaction */
         if (db->transaction_manager->autocommit_enabled) {
             if (rdb_begin_transaction(db, db->transaction_manager->default_isolation) != 0) {
+                free(old_record);
                 return -1;
             }
             transaction = db->transaction_manager->current_transaction;
             transaction->is_autocommit = true;
         } else {
+            free(old_record);
             return -1;
         }
     }
 
     /* Create log entry */
     rdb_transaction_log_entry_t *entry = rdb_create_transaction_log_entry(
-        op_type, table_name, row_id, old_row, new_row);
-    if (!entry) return -1;
+        op_type, table_name, row_id, old_record);
+    if (!entry) {
+        free(old_record);
+        return -1;
+    }
 
     /* Add to transaction log */
     if (fi_array_push(transaction->log_entries, &entry) != 0) {
@@ -325,45 +351,40 @@ int rdb_rollback_operations(rdb_database_t *db, rdb_transaction_t *transaction)
         switch (entry->operation_type) {
             case RDB_OP_INSERT:
                 /* For INSERT, we need to remove the row */
-                if (entry->new_row) {
-                    for (size_t j = 0; j < fi_array_count(table->rows); j++) {
-                        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, j);
-                        if (row && row->row_id == entry->new_row->row_id) {
-                            fi_array_splice(table->rows, j, 1, NULL);
-                            rdb_row_free(row);
-                            break;
-                        }
-                    }
-                }
+                rdb_table_delete_row(table, rdb_table_find_row(table, entry->row_id));
                 break;
 
             case RDB_OP_UPDATE:
                 /* For UPDATE, restore the old row */
-                if (entry->old_row && entry->new_row) {
-                    for (size_t j = 0; j < fi_array_count(table->rows); j++) {
-                        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, j);
-                        if (row && row->row_id == entry->new_row->row_id) {
-                            rdb_row_free(row);
-                            rdb_row_t *restored_row = malloc(sizeof(rdb_row_t));
-                            if (restored_row) {
-                                restored_row->row_id = entry->old_row->row_id;
-                                restored_row->values = fi_array_copy(entry->old_row->values);
-                                fi_array_set(table->rows, j, &restored_row);
-                            }
-                            break;
-                        }
+                if (entry->old_record) {
+                    rdb_row_t *row = rdb_table_find_row(table, entry->row_id);
+                    rdb_row_t *restored_row = row ? rdb_record_unpack(rdb_table_record_layout(table),
+                                                                      entry->old_record) : NULL;
+                    if (restored_row) {
+                        /* Swap the old values into the row object, which keeps its slot */
+                        fi_array *current_values = row->values;
+                        rdb_remove_row_from_indexes(table, row);
+                        row->values = restored_row->values;
+                        restored_row->values = current_values;
+                        rdb_row_free(restored_row);
+                        rdb_update_table_indexes(table, row);
                     }
                 }
                 break;
 
             case RDB_OP_DELETE:
-                /* For DELETE, restore the old row */
-                if (entry->old_row) {
-                    rdb_row_t *restored_row = malloc(sizeof(rdb_row_t));
-                    if (restored_row) {
-                        restored_row->row_id = entry->old_row->row_id;
-                        restored_row->values = fi_array_copy(entry->old_row->values);
-                        fi_array_push(table->rows, &restored_row);
+                /* For DELETE, restore the old row: clear its tombstone, or
+                 * rebuild it from the log if it has been compacted away */
+                if (rdb_table_restore_row(table, entry->row_id)) {
+                    break;
+                }
+                if (entry->old_record) {
+                    rdb_row_t *restored_row = rdb_record_unpack(rdb_table_record_layout(table),
+                                                                entry->old_record);
+                    if (restored_row && rdb_table_insert_row_slot(table, restored_row) == 0) {
+                        rdb_update_table_indexes(table, restored_row);
+                    } else if (restored_row) {
+                        rdb_row_free(restored_row);
                     }
                 }
                 break;
@@ -411,6 +432,7 @@ int rdb_insert_row_transactional(rdb_database_t *db, const char *table_name, fi_
 
     row->row_id = table->next_row_id++;
     row->values = fi_array_copy(values);
+    row->deleted = false;
     if (!row->values) {
         free(row);
         return -1;
@@ -422,8 +444,14 @@ int rdb_insert_row_transactional(rdb_database_t *db, const char *table_name, fi_
         return -1;
     }
 
+    /* Reject duplicate PRIMARY KEY / UNIQUE values */
+    if (rdb_table_check_unique(table, row) != 0) {
+        rdb_row_free(row);
+        return -1;
+    }
+
     /* Log the operation before performing it */
-    if (rdb_log_operation(db, RDB_OP_INSERT, table_name, row->row_id, NULL, row) != 0) {
+    if (rdb_log_operation(db, RDB_OP_INSERT, table_name, row->row_id, NULL) != 0) {
         rdb_row_free(row);
         return -1;
     }
@@ -460,67 +488,57 @@ int rdb_update_rows_transactional(rdb_database_t *db, const char *table_name, fi
 
     int updated_count = 0;
 
-    /* Update each row that matches WHERE conditions */
-    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
-        if (!row || !row->values) continue;
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) return -1;
 
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For now, assume all rows match if WHERE conditions are provided */
-            /* In a real implementation, this would evaluate the conditions */
-            matches = true;
-        }
+    if (rdb_table_check_unique_update(table, matches, set_columns, set_values) != 0 ||
+        rdb_check_update_references(db, table, matches, set_columns, set_values) != 0) {
+        fi_array_destroy(matches);
+        return -1;
+    }
 
-        if (matches) {
-            /* Create a copy of the old row for logging */
-            rdb_row_t *old_row = malloc(sizeof(rdb_row_t));
-            if (old_row) {
-                old_row->row_id = row->row_id;
-                old_row->values = fi_array_copy(row->values);
-            }
+    const rdb_record_layout_t *layout = rdb_table_record_layout(table);
 
-            /* Update the specified columns */
-            for (size_t j = 0; j < fi_array_count(set_columns); j++) {
-                const char *col_name = *(const char**)fi_array_get(set_columns, j);
-                rdb_value_t *new_value = *(rdb_value_t**)fi_array_get(set_values, j);
+    for (size_t i = 0; i < fi_array_count(matches); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        rdb_cascade_update(db, table, row, set_columns, set_values, true);
 
-                int col_index = rdb_get_column_index(table, col_name);
-                if (col_index >= 0 && col_index < (int)fi_array_count(row->values)) {
-                    rdb_value_t *old_value = *(rdb_value_t**)fi_array_get(row->values, col_index);
-                    if (old_value) {
-                        rdb_value_free(old_value);
-                    }
+        /* Pack the old row for the log; the replaced values can then be freed */
+        rdb_record_t *old_record = rdb_record_pack(layout, row);
 
-                    /* Create a copy of the new value */
-                    rdb_value_t *value_copy = malloc(sizeof(rdb_value_t));
-                    if (value_copy) {
-                        *value_copy = *new_value;
-                        if (new_value->type == RDB_TYPE_VARCHAR || new_value->type == RDB_TYPE_TEXT) {
-                            if (new_value->data.string_val) {
-                                value_copy->data.string_val = malloc(strlen(new_value->data.string_val) + 1);
-                                if (value_copy->data.string_val) {
-                                    strcpy(value_copy->data.string_val, new_value->data.string_val);
-                                }
-                            }
-                        }
-                        fi_array_set(row->values, col_index, &value_copy);
-                    }
+        /* Index keys are derived from the values being replaced */
+        rdb_remove_row_from_indexes(table, row);
+
+        /* Update the specified columns */
+        for (size_t j = 0; j < fi_array_count(set_columns); j++) {
+            const char *col_name = *(const char**)fi_array_get(set_columns, j);
+            rdb_value_t *new_value = *(rdb_value_t**)fi_array_get(set_values, j);
+
+            int col_index = rdb_get_column_index(table, col_name);
+            if (col_index >= 0 && col_index < (int)fi_array_count(row->values)) {
+                /* Create a copy of the new value */
+                rdb_value_t *value_copy = rdb_value_copy(new_value);
+                if (!value_copy) continue;
+
+                rdb_value_t *old_value = *(rdb_value_t**)fi_array_get(row->values, col_index);
+                if (old_value) {
+                    rdb_value_free(old_value);
                 }
+                fi_array_set(row->values, col_index, &value_copy);
             }
+        }
 
-            /* Log the operation */
-            rdb_log_operation(db, RDB_OP_UPDATE, table_name, row->row_id, old_row, row);
+        rdb_update_table_indexes(table, row);
 
-            if (old_row) {
-                rdb_row_free(old_row);
-            }
+        /* Log the operation */
+        rdb_log_operation(db, RDB_OP_UPDATE, table_name, row->row_id, old_record);
 
-            updated_count++;
-        }
+        updated_count++;
     }
 
+    fi_array_destroy(matches);
+
     printf("Updated %d rows in table '%s'\n", updated_count, table_name);
     return updated_count;
 }
@@ -536,42 +554,32 @@ int rdb_delete_rows_transactional(rdb_database_t *db, const char *table_name, fi
 
     int deleted_count = 0;
 
-    /* Delete rows that match WHERE conditions */
-    for (size_t i = fi_array_count(table->rows); i > 0; i--) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i - 1);
-        if (!row) continue;
-
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For now, assume all rows match if WHERE conditions are provided */
-            /* In a real implementation, this would evaluate the conditions */
-            matches = true;
-        }
-
-        if (matches) {
-            /* Create a copy of the row for logging before deletion */
-            rdb_row_t *old_row = malloc(sizeof(rdb_row_t));
-            if (old_row) {
-                old_row->row_id = row->row_id;
-                old_row->values = fi_array_copy(row->values);
-            }
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) return -1;
 
-            /* Log the operation before deletion */
-            rdb_log_operation(db, RDB_OP_DELETE, table_name, row->row_id, old_row, NULL);
+    if (rdb_check_delete_references(db, table, matches) != 0) {
+        fi_array_destroy(matches);
+        return -1;
+    }
 
-            /* Remove from array and free memory */
-            fi_array_splice(table->rows, i - 1, 1, NULL);
-            rdb_row_free(row);
+    for (size_t i = 0; i < fi_array_count(matches); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        if (row->deleted) continue; /* Removed by a cascade */
 
-            if (old_row) {
-                rdb_row_free(old_row);
-            }
+        /* Log the packed row before deletion */
+        rdb_log_operation(db, RDB_OP_DELETE, table_name, row->row_id,
+                          rdb_record_pack(rdb_table_record_layout(table), row));
 
-            deleted_count++;
-        }
+        /* Leave a tombstone; the slot is reclaimed by compaction */
+        rdb_table_delete_row(table, row);
+        rdb_cascade_delete(db, table, row, true);
+        deleted_count++;
     }
 
+    fi_array_destroy(matches);
+    rdb_schedule_compaction(db, table);
+
     printf("Deleted %d rows from table '%s'\n", deleted_count, table_name);
     return deleted_count;
 }
@@ -726,6 +734,16 @@ rdb_database_t* rdb_create_database(const char *name) {
 
     db->is_open = true;
 
+    db->compaction_running = false;
+    db->compaction_interval_ms = 0;
+    pthread_mutex_init(&db->compaction_mutex, NULL);
+    pthread_cond_init(&db->compaction_cond, NULL);
+
+    /* Threads are only started by the first large scan */
+    db->workers = rdb_worker_pool_create(0);
+
+    db->statements = rdb_statement_cache_create();
+
     /* Initialize thread safety */
     if (rdb_init_thread_safety(db) != 0) {
         printf("Warning: Thread safety initialization failed, continuing without thread safety\n");
@@ -753,6 +771,10 @@ int rdb_close_database(rdb_database_t *db) {
 void rdb_destroy_database(rdb_database_t *db) {
     if (!db) return;
 
+    if (db->compaction_running) {
+        rdb_stop_compaction(db);
+    }
+
     if (db->tables) {
         fi_map_iterator iter = fi_map_iterator_create(db->tables);
 
@@ -799,8 +821,13 @@ void rdb_destroy_database(rdb_database_t *db) {
         rdb_destroy_transaction_manager(db->transaction_manager);
     }
 
+    rdb_worker_pool_destroy(db->workers);
+    rdb_statement_cache_destroy(db->statements);
+
     /* Cleanup thread safety */
     rdb_cleanup_thread_safety(db);
+    pthread_mutex_destroy(&db->compaction_mutex);
+    pthread_cond_destroy(&db->compaction_cond);
 
     free(db);
 }
@@ -842,17 +869,37 @@ rdb_table_t* rdb_create_table_object(const char *name, fi_array *columns) {
         return NULL;
     }
 
-    table->indexes = fi_map_create(8, sizeof(char*), sizeof(fi_btree*),
+    table->row_map = NULL;
+    if (rdb_table_build_row_map(table) != 0) {
+        fi_array_destroy(table->columns);
+        fi_array_destroy(table->rows);
+        free(table);
+        return NULL;
+    }
+
+    table->indexes = fi_map_create(8, sizeof(char*), sizeof(rdb_index_t*),
                                    fi_map_hash_string, fi_map_compare_string);
     if (!table->indexes) {
         fi_array_destroy(table->columns);
         fi_array_destroy(table->rows);
+        fi_map_destroy(table->row_map);
         free(table);
         return NULL;
     }
 
     table->primary_key[0] = '\0';
     table->next_row_id = 1;
+    table->dead_rows = 0;
+    table->storage = RDB_STORAGE_ROW;
+    table->column_store = NULL;
+    table->record_layout = NULL;
+    table->dictionaries = NULL;
+    table->foreign_keys = NULL;
+    table->referenced_by = NULL;
+    table->workers = NULL;
+    table->zones = rdb_zone_map_create(fi_array_count(table->columns));
+    table->stats = NULL;
+    rdb_table_init_dictionaries(table);
 
     /* Find primary key column */
     for (size_t i = 0; i < fi_array_count(table->columns); i++) {
@@ -868,11 +915,15 @@ rdb_table_t* rdb_create_table_object(const char *name, fi_array *columns) {
     if (rdb_table_init_thread_safety(table) != 0) {
         fi_array_destroy(table->columns);
         fi_array_destroy(table->rows);
+        fi_map_destroy(table->row_map);
         fi_map_destroy(table->indexes);
         free(table);
         return NULL;
     }
 
+    /* PRIMARY KEY and UNIQUE columns are enforced through hash indexes */
+    rdb_table_create_constraint_indexes(table);
+
     return table;
 }
 
@@ -887,22 +938,36 @@ void rdb_destroy_table(rdb_table_t *table) {
         fi_array_destroy(table->rows);
     }
 
+    if (table->row_map) {
+        fi_map_destroy(table->row_map);
+    }
+
+    rdb_column_store_destroy(table->column_store);
+    rdb_zone_map_destroy(table->zones);
+    rdb_table_stats_destroy(table->stats);
+    rdb_record_layout_destroy(table->record_layout);
+    rdb_table_destroy_dictionaries(table);
+
+    /* The constraints themselves belong to the database */
+    if (table->foreign_keys) fi_array_destroy(table->foreign_keys);
+    if (table->referenced_by) fi_array_destroy(table->referenced_by);
+
     if (table->indexes) {
         fi_map_iterator iter = fi_map_iterator_create(table->indexes);
 
         /* Handle first element if iterator is valid */
         if (iter.is_valid) {
-            fi_btree **tree_ptr = (fi_btree**)fi_map_iterator_value(&iter);
-            if (tree_ptr && *tree_ptr) {
-                fi_btree_destroy(*tree_ptr);
+            rdb_index_t **index_ptr = (rdb_index_t**)fi_map_iterator_value(&iter);
+            if (index_ptr && *index_ptr) {
+                rdb_index_destroy(*index_ptr);
             }
         }
 
         /* Handle remaining elements */
         while (fi_map_iterator_next(&iter)) {
-            fi_btree **tree_ptr = (fi_btree**)fi_map_iterator_value(&iter);
-            if (tree_ptr && *tree_ptr) {
-                fi_btree_destroy(*tree_ptr);
+            rdb_index_t **index_ptr = (rdb_index_t**)fi_map_iterator_value(&iter);
+            if (index_ptr && *index_ptr) {
+                rdb_index_destroy(*index_ptr);
             }
         }
         fi_map_destroy(table->indexes);
@@ -935,6 +1000,7 @@ int rdb_create_table(rdb_database_t *db, const char *table_name, fi_array *colum
     }
     strcpy(table_name_copy, table_name);
 
+    table->workers = db->workers;
     if (fi_map_put(db->tables, &table_name_copy, &table) != 0) {
         free(table_name_copy);
         rdb_destroy_table(table);
@@ -956,6 +1022,7 @@ int rdb_drop_table(rdb_database_t *db, const char *table_name) {
         return -1;
     }
 
+    rdb_drop_table_foreign_keys(db, table);
     fi_map_remove(db->tables, &table_name);
     rdb_destroy_table(table);
 
@@ -987,6 +1054,7 @@ rdb_value_t* rdb_create_int_value(int64_t value) {
     val->type = RDB_TYPE_INT;
     val->data.int_val = value;
     val->is_null = false;
+    val->str_len = 0;
     return val;
 }
 
@@ -997,24 +1065,53 @@ rdb_value_t* rdb_create_float_value(double value) {
     val->type = RDB_TYPE_FLOAT;
     val->data.float_val = value;
     val->is_null = false;
+    val->str_len = 0;
     return val;
 }
 
 rdb_value_t* rdb_create_string_value(const char *value) {
     if (!value) return NULL;
+    return rdb_create_string_value_n(value, strlen(value));
+}
+
+/* String value from the first `length` bytes of `value` */
+rdb_value_t* rdb_create_string_value_n(const char *value, size_t length) {
+    if (!value) return NULL;
+
+    if (length > RDB_VALUE_INLINE_MAX) {
+        rdb_string_t *str = rdb_string_create(value, length);
+        if (!str) return NULL;
+
+        rdb_value_t *val = rdb_create_shared_string_value(str);
+        rdb_string_release(str);
+        return val;
+    }
 
     rdb_value_t *val = malloc(sizeof(rdb_value_t));
     if (!val) return NULL;
 
     val->type = RDB_TYPE_VARCHAR;
-    val->data.string_val = malloc(strlen(value) + 1);
-    if (!val->data.string_val) {
-        free(val);
-        return NULL;
-    }
+    val->is_null = false;
+
+    char *dst = rdb_value_inline_string(val);
+    memcpy(dst, value, length);
+    dst[length] = '\0';
+    val->str_len = (uint8_t)length;
+    return val;
+}
 
-    strcpy(val->data.string_val, value);
+/* String value referencing `str`; takes a new reference */
+rdb_value_t* rdb_create_shared_string_value(rdb_string_t *str) {
+    if (!str) return NULL;
+
+    rdb_value_t *val = malloc(sizeof(rdb_value_t));
+    if (!val) return NULL;
+
+    val->type = RDB_TYPE_VARCHAR;
     val->is_null = false;
+    val->str_len = RDB_VALUE_SHARED_STRING;
+    memset(val->inline_str, 0, sizeof(val->inline_str));
+    val->data.string_ref = rdb_string_retain(str);
     return val;
 }
 
@@ -1025,6 +1122,7 @@ rdb_value_t* rdb_create_bool_value(bool value) {
     val->type = RDB_TYPE_BOOLEAN;
     val->data.bool_val = value;
     val->is_null = false;
+    val->str_len = 0;
     return val;
 }
 
@@ -1034,6 +1132,7 @@ rdb_value_t* rdb_create_null_value(rdb_data_type_t type) {
 
     val->type = type;
     val->is_null = true;
+    val->str_len = 0;
     memset(&val->data, 0, sizeof(val->data));
     return val;
 }
@@ -1041,43 +1140,18 @@ rdb_value_t* rdb_create_null_value(rdb_data_type_t type) {
 rdb_value_t* rdb_value_copy(const rdb_value_t *original) {
     if (!original) return NULL;
 
+    if (!original->is_null &&
+        (original->type < RDB_TYPE_INT || original->type > RDB_TYPE_BOOLEAN)) {
+        return NULL;
+    }
+
     rdb_value_t *copy = malloc(sizeof(rdb_value_t));
     if (!copy) return NULL;
 
-    copy->type = original->type;
-    copy->is_null = original->is_null;
-
-    if (original->is_null) {
-        memset(&copy->data, 0, sizeof(copy->data));
-    } else {
-        switch (original->type) {
-            case RDB_TYPE_INT:
-                copy->data.int_val = original->data.int_val;
-                break;
-            case RDB_TYPE_FLOAT:
-                copy->data.float_val = original->data.float_val;
-                break;
-            case RDB_TYPE_VARCHAR:
-            case RDB_TYPE_TEXT:
-                if (original->data.string_val) {
-                    copy->data.string_val = malloc(strlen(original->data.string_val) + 1);
-                    if (copy->data.string_val) {
-                        strcpy(copy->data.string_val, original->data.string_val);
-                    } else {
-                        free(copy);
-                        return NULL;
-                    }
-                } else {
-                    copy->data.string_val = NULL;
-                }
-                break;
-            case RDB_TYPE_BOOLEAN:
-                copy->data.bool_val = original->data.bool_val;
-                break;
-            default:
-                free(copy);
-                return NULL;
-        }
+    /* Inline strings come along with the bytes; shared ones gain a reference */
+    memcpy(copy, original, sizeof(rdb_value_t));
+    if (copy->str_len == RDB_VALUE_SHARED_STRING) {
+        rdb_string_retain(copy->data.string_ref);
     }
 
     return copy;
@@ -1096,7 +1170,22 @@ double rdb_get_float_value(const rdb_value_t *value) {
 
 const char* rdb_get_string_value(const rdb_value_t *value) {
     if (!value || value->is_null) return NULL;
-    return value->data.string_val;
+    if (value->type != RDB_TYPE_VARCHAR && value->type != RDB_TYPE_TEXT) return NULL;
+
+    if (value->str_len == RDB_VALUE_SHARED_STRING) {
+        return value->data.string_ref->data;
+    }
+    return rdb_value_inline_string((rdb_value_t*)value);
+}
+
+size_t rdb_get_string_length(const rdb_value_t *value) {
+    if (!value || value->is_null) return 0;
+    if (value->type != RDB_TYPE_VARCHAR && value->type != RDB_TYPE_TEXT) return 0;
+
+    if (value->str_len == RDB_VALUE_SHARED_STRING) {
+        return value->data.string_ref->length;
+    }
+    return value->str_len;
 }
 
 bool rdb_get_bool_value(const rdb_value_t *value) {
@@ -1133,6 +1222,7 @@ int rdb_insert_row(rdb_database_t *db, const char *table_name, fi_array *values)
 
     row->row_id = table->next_row_id++;
     row->values = fi_array_copy(values);
+    row->deleted = false;
     if (!row->values) {
         free(row);
         return -1;
@@ -1144,6 +1234,12 @@ int rdb_insert_row(rdb_database_t *db, const char *table_name, fi_array *values)
         return -1;
     }
 
+    /* Reject duplicate PRIMARY KEY / UNIQUE values */
+    if (rdb_table_check_unique(table, row) != 0) {
+        rdb_row_free(row);
+        return -1;
+    }
+
     /* Add row to table */
     if (fi_array_push(table->rows, &row) != 0) {
         rdb_row_free(row);
@@ -1157,59 +1253,6 @@ int rdb_insert_row(rdb_database_t *db, const char *table_name, fi_array *values)
     return 0;
 }
 
-/* Index operations */
-int rdb_create_index(rdb_database_t *db, const char *table_name, const char *index_name,
-                     const char *column_name) {
-    if (!db || !table_name || !index_name || !column_name) return -1;
-
-    rdb_table_t *table = rdb_get_table(db, table_name);
-    if (!table) {
-        printf("Error: Table '%s' does not exist\n", table_name);
-        return -1;
-    }
-
-    /* Find column */
-    rdb_column_t *column = NULL;
-    for (size_t i = 0; i < fi_array_count(table->columns); i++) {
-        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
-        if (col && strcmp(col->name, column_name) == 0) {
-            column = col;
-            break;
-        }
-    }
-
-    if (!column) {
-        printf("Error: Column '%s' does not exist in table '%s'\n", column_name, table_name);
-        return -1;
-    }
-
-    /* Create index tree */
-    fi_btree *index_tree = fi_btree_create(sizeof(rdb_value_t*), rdb_value_compare);
-    if (!index_tree) return -1;
-
-    /* Build index from existing rows */
-    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
-        if (row && row->values) {
-            rdb_value_t *value = *(rdb_value_t**)fi_array_get(row->values,
-                rdb_get_column_index(table, column_name));
-            if (value) {
-                fi_btree_insert(index_tree, &value);
-            }
-        }
-    }
-
-    /* Add index to table */
-    if (fi_map_put(table->indexes, &index_name, &index_tree) != 0) {
-        fi_btree_destroy(index_tree);
-        return -1;
-    }
-
-    printf("Index '%s' created on column '%s' in table '%s'\n",
-           index_name, column_name, table_name);
-    return 0;
-}
-
 /* Utility functions */
 int rdb_get_column_index(rdb_table_t *table, const char *column_name) {
     if (!table || !column_name) return -1;
@@ -1223,19 +1266,6 @@ int rdb_get_column_index(rdb_table_t *table, const char *column_name) {
     return -1;
 }
 
-void rdb_update_table_indexes(rdb_table_t *table, rdb_row_t *row) {
-    if (!table || !row) return;
-
-    /* Update all indexes with new row data */
-    fi_map_iterator iter = fi_map_iterator_create(table->indexes);
-    while (fi_map_iterator_next(&iter)) {
-        /* For simplicity, we'll rebuild the index */
-        /* In a real implementation, we'd update incrementally */
-        (void)fi_map_iterator_key(&iter);   /* Suppress unused variable warning */
-        (void)fi_map_iterator_value(&iter); /* Suppress unused variable warning */
-    }
-}
-
 /* Comparison functions */
 int rdb_value_compare(const void *a, const void *b) {
     const rdb_value_t *val_a = *(const rdb_value_t**)a;
@@ -1267,10 +1297,12 @@ int rdb_value_compare(const void *a, const void *b) {
 
         case RDB_TYPE_VARCHAR:
         case RDB_TYPE_TEXT:
-            if (!val_a->data.string_val && !val_b->data.string_val) return 0;
-            if (!val_a->data.string_val) return -1;
-            if (!val_b->data.string_val) return 1;
-            return strcmp(val_a->data.string_val, val_b->data.string_val);
+            if (val_a->str_len == RDB_VALUE_SHARED_STRING &&
+                val_b->str_len == RDB_VALUE_SHARED_STRING &&
+                val_a->data.string_ref == val_b->data.string_ref) {
+                return 0;
+            }
+            return strcmp(rdb_get_string_value(val_a), rdb_get_string_value(val_b));
 
         case RDB_TYPE_BOOLEAN:
             if (val_a->data.bool_val == val_b->data.bool_val) return 0;
@@ -1281,6 +1313,36 @@ int rdb_value_compare(const void *a, const void *b) {
     }
 }
 
+/* Decide string equality from shared buffers alone: one buffer is one
+ * string, and distinct entries of the same column dictionary are distinct
+ * strings. Returns false when the text has to be compared. */
+static bool rdb_shared_string_equality(const rdb_value_t *a, const rdb_value_t *b, bool *equal) {
+    if (a->str_len != RDB_VALUE_SHARED_STRING || b->str_len != RDB_VALUE_SHARED_STRING) return false;
+
+    const rdb_string_t *sa = a->data.string_ref;
+    const rdb_string_t *sb = b->data.string_ref;
+    if (sa == sb) {
+        *equal = true;
+        return true;
+    }
+    if (sa->dict && sa->dict == sb->dict) {
+        *equal = false;
+        return true;
+    }
+    return false;
+}
+
+/* Equality with the semantics of rdb_value_compare() == 0, without ordering
+ * work for dictionary-encoded strings */
+bool rdb_value_equals(const rdb_value_t *a, const rdb_value_t *b) {
+    bool equal;
+    if (a && b && !a->is_null && !b->is_null && a->type == b->type &&
+        rdb_shared_string_equality(a, b, &equal)) {
+        return equal;
+    }
+    return rdb_value_compare(&a, &b) == 0;
+}
+
 uint32_t rdb_string_hash(const void *key, size_t key_size) {
     return fi_map_hash_string(key, key_size);
 }
@@ -1306,7 +1368,7 @@ char* rdb_value_to_string(const rdb_value_t *value) {
             break;
         case RDB_TYPE_VARCHAR:
         case RDB_TYPE_TEXT:
-            snprintf(str, 256, "'%s'", value->data.string_val ? value->data.string_val : "NULL");
+            snprintf(str, 256, "'%s'", rdb_get_string_value(value));
             break;
         case RDB_TYPE_BOOLEAN:
             strcpy(str, value->data.bool_val ? "true" : "false");
@@ -1341,7 +1403,10 @@ void rdb_print_table_info(rdb_database_t *db, const char *table_name) {
     }
 
     printf("\n=== Table: %s ===\n", table_name);
-    printf("Columns: %zu, Rows: %zu\n", fi_array_count(table->columns), fi_array_count(table->rows));
+    printf("Columns: %zu, Rows: %zu\n", fi_array_count(table->columns), rdb_table_live_row_count(table));
+    if (table->column_store) {
+        printf("Storage: columnar (%zu row groups)\n", fi_array_count(table->column_store->groups));
+    }
 
     printf("\nColumn Definitions:\n");
     printf("%-20s %-15s %-8s %-8s %-8s %s\n",
@@ -1361,16 +1426,32 @@ void rdb_print_table_info(rdb_database_t *db, const char *table_name) {
         }
     }
 
+    for (size_t i = 0; table->dictionaries && i < fi_array_count(table->dictionaries); i++) {
+        rdb_string_dict_t *dict = rdb_table_column_dictionary(table, i);
+        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
+        if (dict) {
+            printf("Dictionary: %s (%zu distinct values)\n", col->name, rdb_string_dict_count(dict));
+        }
+    }
+
     printf("\nIndexes:\n");
-    if (fi_map_size(table->indexes) == 0) {
+    if (!table->indexes || fi_map_size(table->indexes) == 0) {
         printf("No indexes\n");
     } else {
-        fi_map_iterator iter = fi_map_iterator_create(table->indexes);
-        while (fi_map_iterator_next(&iter)) {
-            const char *index_name = (const char*)fi_map_iterator_key(&iter);
-            printf("- %s\n", index_name);
+        fi_array *indexes = fi_map_values(table->indexes);
+        for (size_t i = 0; indexes && i < fi_array_count(indexes); i++) {
+            rdb_index_t *index = *(rdb_index_t**)fi_array_get(indexes, i);
+            printf("- %s (", index->name);
+            for (size_t c = 0; c < index->column_count; c++) {
+                printf("%s%s", c ? ", " : "", index->column_names[c]);
+            }
+            printf(")%s\n", index->kind == RDB_INDEX_ART ? " USING ART" :
+                             index->kind == RDB_INDEX_HASH ? " USING HASH" : "");
         }
+        if (indexes) fi_array_destroy(indexes);
     }
+
+    rdb_print_table_stats(table);
 }
 
 void rdb_print_table_data(rdb_database_t *db, const char *table_name, size_t limit) {
@@ -1384,7 +1465,7 @@ void rdb_print_table_data(rdb_database_t *db, const char *table_name, size_t lim
 
     printf("\n=== Table Data: %s ===\n", table_name);
 
-    size_t row_count = fi_array_count(table->rows);
+    size_t row_count = rdb_table_live_row_count(table);
     size_t display_count = (limit > 0 && limit < row_count) ? limit : row_count;
 
     if (display_count == 0) {
@@ -1404,9 +1485,11 @@ void rdb_print_table_data(rdb_database_t *db, const char *table_name, size_t lim
     printf("%s\n", "------------------------------------------------------------------------");
 
     /* Print data rows */
-    for (size_t i = 0; i < display_count; i++) {
+    size_t displayed = 0;
+    for (size_t i = 0; i < fi_array_count(table->rows) && displayed < display_count; i++) {
         rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
-        if (row && row->values) {
+        if (row && !row->deleted && row->values) {
+            displayed++;
             printf("%-8zu", row->row_id);
 
             for (size_t j = 0; j < fi_array_count(row->values); j++) {
@@ -1444,7 +1527,7 @@ void rdb_print_database_info(rdb_database_t *db) {
             const char **table_name_ptr = (const char**)fi_map_iterator_key(&iter);
             rdb_table_t **table_ptr = (rdb_table_t**)fi_map_iterator_value(&iter);
             if (table_name_ptr && *table_name_ptr && table_ptr && *table_ptr) {
-                printf("- %s (%zu rows)\n", *table_name_ptr, fi_array_count((*table_ptr)->rows));
+                printf("- %s (%zu rows)\n", *table_name_ptr, rdb_table_live_row_count(*table_ptr));
             }
         }
 
@@ -1453,7 +1536,7 @@ void rdb_print_database_info(rdb_database_t *db) {
             const char **table_name_ptr = (const char**)fi_map_iterator_key(&iter);
             rdb_table_t **table_ptr = (rdb_table_t**)fi_map_iterator_value(&iter);
             if (table_name_ptr && *table_name_ptr && table_ptr && *table_ptr) {
-                printf("- %s (%zu rows)\n", *table_name_ptr, fi_array_count((*table_ptr)->rows));
+                printf("- %s (%zu rows)\n", *table_name_ptr, rdb_table_live_row_count(*table_ptr));
             }
         }
     }
@@ -1485,52 +1568,48 @@ int rdb_update_rows(rdb_database_t *db, const char *table_name, fi_array *set_co
 
     int updated_count = 0;
 
-    /* Update each row that matches WHERE conditions */
-    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
-        if (!row || !row->values) continue;
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) return -1;
 
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For now, assume all rows match if WHERE conditions are provided */
-            /* In a real implementation, this would evaluate the conditions */
-            matches = true;
-        }
+    if (rdb_table_check_unique_update(table, matches, set_columns, set_values) != 0 ||
+        rdb_check_update_references(db, table, matches, set_columns, set_values) != 0) {
+        fi_array_destroy(matches);
+        return -1;
+    }
 
-        if (matches) {
-            /* Update the specified columns */
-            for (size_t j = 0; j < fi_array_count(set_columns); j++) {
-                const char *col_name = *(const char**)fi_array_get(set_columns, j);
-                rdb_value_t *new_value = *(rdb_value_t**)fi_array_get(set_values, j);
-
-                int col_index = rdb_get_column_index(table, col_name);
-                if (col_index >= 0 && col_index < (int)fi_array_count(row->values)) {
-                    rdb_value_t *old_value = *(rdb_value_t**)fi_array_get(row->values, col_index);
-                    if (old_value) {
-                        rdb_value_free(old_value);
-                    }
+    for (size_t i = 0; i < fi_array_count(matches); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        rdb_cascade_update(db, table, row, set_columns, set_values, false);
 
-                    /* Create a copy of the new value */
-                    rdb_value_t *value_copy = malloc(sizeof(rdb_value_t));
-                    if (value_copy) {
-                        *value_copy = *new_value;
-                        if (new_value->type == RDB_TYPE_VARCHAR || new_value->type == RDB_TYPE_TEXT) {
-                            if (new_value->data.string_val) {
-                                value_copy->data.string_val = malloc(strlen(new_value->data.string_val) + 1);
-                                if (value_copy->data.string_val) {
-                                    strcpy(value_copy->data.string_val, new_value->data.string_val);
-                                }
-                            }
-                        }
-                        fi_array_set(row->values, col_index, &value_copy);
-                    }
+        /* Index keys are derived from the values being replaced */
+        rdb_remove_row_from_indexes(table, row);
+
+        /* Update the specified columns */
+        for (size_t j = 0; j < fi_array_count(set_columns); j++) {
+            const char *col_name = *(const char**)fi_array_get(set_columns, j);
+            rdb_value_t *new_value = *(rdb_value_t**)fi_array_get(set_values, j);
+
+            int col_index = rdb_get_column_index(table, col_name);
+            if (col_index >= 0 && col_index < (int)fi_array_count(row->values)) {
+                /* Create a copy of the new value */
+                rdb_value_t *value_copy = rdb_value_copy(new_value);
+                if (!value_copy) continue;
+
+                rdb_value_t *old_value = *(rdb_value_t**)fi_array_get(row->values, col_index);
+                if (old_value) {
+                    rdb_value_free(old_value);
                 }
+                fi_array_set(row->values, col_index, &value_copy);
             }
-            updated_count++;
         }
+
+        rdb_update_table_indexes(table, row);
+        updated_count++;
     }
 
+    fi_array_destroy(matches);
+
     printf("Updated %d rows in table '%s'\n", updated_count, table_name);
     return updated_count;
 }
@@ -1553,117 +1632,176 @@ int rdb_delete_rows(rdb_database_t *db, const char *table_name, fi_array *where_
 
     int deleted_count = 0;
 
-    /* Delete rows that match WHERE conditions */
-    for (size_t i = fi_array_count(table->rows); i > 0; i--) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i - 1);
-        if (!row) continue;
-
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For now, assume all rows match if WHERE conditions are provided */
-            /* In a real implementation, this would evaluate the conditions */
-            matches = true;
-        }
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) return -1;
 
-        if (matches) {
-            /* Remove from array and free memory */
-            fi_array_splice(table->rows, i - 1, 1, NULL);
-            rdb_row_free(row);
-            deleted_count++;
-        }
+    if (rdb_check_delete_references(db, table, matches) != 0) {
+        fi_array_destroy(matches);
+        return -1;
+    }
+
+    for (size_t i = 0; i < fi_array_count(matches); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        if (row->deleted) continue; /* Removed by a cascade */
+
+        /* Leave a tombstone; the slot is reclaimed by compaction */
+        rdb_table_delete_row(table, row);
+        rdb_cascade_delete(db, table, row, false);
+        deleted_count++;
     }
 
+    fi_array_destroy(matches);
+    rdb_schedule_compaction(db, table);
+
     printf("Deleted %d rows from table '%s'\n", deleted_count, table_name);
     return deleted_count;
 }
 
-/* Row operations - SELECT */
-fi_array* rdb_select_rows(rdb_database_t *db, const char *table_name, fi_array *columns,
-                          fi_array *where_conditions) {
-    (void)columns; /* Suppress unused parameter warning - columns selection not yet implemented */
-    if (!db || !table_name) return NULL;
-
-    rdb_table_t *table = rdb_get_table(db, table_name);
-    if (!table) {
-        printf("Error: Table '%s' does not exist\n", table_name);
-        return NULL;
+/* Resolve a SELECT column list to column ordinals. An empty list, a NULL
+ * list or `*` selects every column and leaves *ordinals NULL. */
+int rdb_table_projection(rdb_table_t *table, fi_array *columns, int **ordinals, size_t *count) {
+    *ordinals = NULL;
+    *count = 0;
+    if (!columns || fi_array_count(columns) == 0 ||
+        strcmp(*(char**)fi_array_get(columns, 0), "*") == 0) {
+        return 0;
     }
 
-    /* Create result array */
-    fi_array *result = fi_array_create(100, sizeof(rdb_row_t*));
-    if (!result) return NULL;
+    int *resolved = malloc(fi_array_count(columns) * sizeof(int));
+    if (!resolved) return -1;
 
-    /* Select rows that match WHERE conditions */
-    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
-        if (!row) continue;
-
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For now, assume all rows match if WHERE conditions are provided */
-            /* In a real implementation, this would evaluate the conditions */
-            matches = true;
+    for (size_t i = 0; i < fi_array_count(columns); i++) {
+        const char *name = *(char**)fi_array_get(columns, i);
+        resolved[i] = rdb_get_column_index(table, name);
+        if (resolved[i] < 0) {
+            printf("Error: Column '%s' does not exist in table '%s'\n", name, table->name);
+            free(resolved);
+            return -1;
         }
+    }
 
-        if (matches) {
-            /* Create a copy of the row for the result */
-            rdb_row_t *row_copy = malloc(sizeof(rdb_row_t));
-            if (row_copy) {
-                row_copy->row_id = row->row_id;
-                row_copy->values = fi_array_copy(row->values);
-                if (row_copy->values) {
-                    fi_array_push(result, &row_copy);
-                } else {
-                    free(row_copy);
-                }
-            }
+    *ordinals = resolved;
+    *count = fi_array_count(columns);
+    return 0;
+}
+
+/* A result row holding the projected values of `row`. The values are
+ * borrowed from the table, as for every SELECT result. */
+rdb_row_t* rdb_project_row(const rdb_row_t *row, const int *ordinals, size_t count) {
+    rdb_row_t *row_copy = malloc(sizeof(rdb_row_t));
+    if (!row_copy) return NULL;
+
+    row_copy->row_id = row->row_id;
+    row_copy->deleted = false;
+    if (!ordinals) {
+        row_copy->values = fi_array_copy(row->values);
+    } else {
+        row_copy->values = fi_array_create(count ? count : 1, sizeof(rdb_value_t*));
+        for (size_t i = 0; row_copy->values && i < count; i++) {
+            rdb_value_t *value = (size_t)ordinals[i] < fi_array_count(row->values) ?
+                                 *(rdb_value_t**)fi_array_get(row->values, ordinals[i]) : NULL;
+            fi_array_push(row_copy->values, &value);
         }
     }
 
-    return result;
+    if (!row_copy->values) {
+        free(row_copy);
+        return NULL;
+    }
+    return row_copy;
+}
+
+/* Rows projected by the scan workers, each into its own result slot */
+typedef struct {
+    fi_array *rows;
+    fi_array *result;           /* Padded to the row count */
+    const int *ordinals;
+    size_t count;
+    atomic_bool failed;
+} rdb_projection_scan_t;
+
+static void rdb_project_morsel(void *context, size_t worker, size_t morsel, size_t begin, size_t end) {
+    rdb_projection_scan_t *scan = (rdb_projection_scan_t*)context;
+    (void)worker;
+    (void)morsel;
+
+    for (size_t i = begin; i < end; i++) {
+        rdb_row_t *row_copy = rdb_project_row(*(rdb_row_t**)fi_array_get(scan->rows, i),
+                                              scan->ordinals, scan->count);
+        if (row_copy) fi_array_set(scan->result, i, &row_copy);
+        if (!row_copy || !fi_array_get(scan->result, i)) {
+            rdb_row_free(row_copy);
+            atomic_store(&scan->failed, true);
+        }
+    }
 }
 
-/* Index operations - DROP INDEX */
-int rdb_drop_index(rdb_database_t *db, const char *table_name, const char *index_name) {
-    if (!db || !table_name || !index_name) return -1;
+/* Project each of `rows` into a new result array, in parallel when there
+ * are enough rows for the table's scan workers */
+static fi_array* rdb_project_rows(rdb_table_t *table, fi_array *rows, const int *ordinals, size_t count) {
+    size_t total = fi_array_count(rows);
+    fi_array *result = fi_array_create(total ? total : 16, sizeof(rdb_row_t*));
+    if (!result) return NULL;
 
-    rdb_table_t *table = rdb_get_table(db, table_name);
-    if (!table) {
-        printf("Error: Table '%s' does not exist\n", table_name);
-        return -1;
+    size_t workers = rdb_parallel_workers(table->workers, total);
+    if (workers <= 1) {
+        for (size_t i = 0; i < total; i++) {
+            rdb_row_t *row_copy = rdb_project_row(*(rdb_row_t**)fi_array_get(rows, i), ordinals, count);
+            if (row_copy) fi_array_push(result, &row_copy);
+        }
+        return result;
     }
 
-    fi_btree *index_tree = NULL;
-    if (fi_map_get(table->indexes, &index_name, &index_tree) != 0) {
-        printf("Error: Index '%s' does not exist in table '%s'\n", index_name, table_name);
-        return -1;
+    rdb_projection_scan_t scan;
+    scan.rows = rows;
+    scan.result = result;
+    scan.ordinals = ordinals;
+    scan.count = count;
+    atomic_init(&scan.failed, fi_array_pad(result, total, NULL) != 0);
+    if (!atomic_load(&scan.failed)) {
+        rdb_parallel_for(table->workers, total, workers, rdb_project_morsel, &scan);
     }
 
-    /* Remove index from map and destroy tree */
-    fi_map_remove(table->indexes, &index_name);
-    if (index_tree) {
-        fi_btree_destroy(index_tree);
+    if (atomic_load(&scan.failed)) {
+        for (size_t i = 0; i < fi_array_count(result); i++) {
+            rdb_row_t **row_ptr = (rdb_row_t**)fi_array_get(result, i);
+            if (row_ptr) rdb_row_free(*row_ptr);
+        }
+        fi_array_destroy(result);
+        return NULL;
     }
-
-    printf("Index '%s' dropped from table '%s'\n", index_name, table_name);
-    return 0;
+    return result;
 }
 
-/* Index operations - GET INDEX */
-fi_btree* rdb_get_index(rdb_database_t *db, const char *table_name, const char *index_name) {
-    if (!db || !table_name || !index_name) return NULL;
+/* Row operations - SELECT */
+fi_array* rdb_select_rows(rdb_database_t *db, const char *table_name, fi_array *columns,
+                          fi_array *where_conditions) {
+    if (!db || !table_name) return NULL;
 
     rdb_table_t *table = rdb_get_table(db, table_name);
-    if (!table) return NULL;
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return NULL;
+    }
 
-    fi_btree *index_tree = NULL;
-    if (fi_map_get(table->indexes, &index_name, &index_tree) != 0) {
+    /* Resolve the column list once; only those values go into the result */
+    int *ordinals;
+    size_t ordinal_count;
+    if (rdb_table_projection(table, columns, &ordinals, &ordinal_count) != 0) return NULL;
+
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) {
+        free(ordinals);
         return NULL;
     }
 
-    return index_tree;
+    fi_array *result = rdb_project_rows(table, matches, ordinals, ordinal_count);
+
+    fi_array_destroy(matches);
+    free(ordinals);
+    return result;
 }
 
 /* Column operations - ADD COLUMN */
@@ -1744,6 +1882,14 @@ int rdb_add_column(rdb_database_t *db, const char *table_name, const rdb_column_
         }
     }
 
+    rdb_table_init_dictionaries(table);
+    rdb_table_invalidate_record_layout(table);
+    if (table->column_store) rdb_column_store_rebuild(table);
+    rdb_zone_map_rebuild(table);
+    rdb_table_stats_destroy(table->stats);
+    table->stats = NULL;
+    rdb_table_create_constraint_indexes(table);
+
     printf("Column '%s' added to table '%s'\n", column->name, table_name);
     return 0;
 }
@@ -1790,6 +1936,16 @@ int rdb_drop_column(rdb_database_t *db, const char *table_name, const char *colu
         }
     }
 
+    /* Column ordinals shifted; indexes over the dropped column go away */
+    rdb_refresh_table_indexes(table, column_name);
+    rdb_table_destroy_dictionaries(table);
+    rdb_table_init_dictionaries(table);
+    rdb_table_invalidate_record_layout(table);
+    if (table->column_store) rdb_column_store_rebuild(table);
+    rdb_zone_map_rebuild(table);
+    rdb_table_stats_destroy(table->stats);
+    table->stats = NULL;
+
     printf("Column '%s' dropped from table '%s'\n", column_name, table_name);
     return 0;
 }
@@ -1925,6 +2081,15 @@ int rdb_add_foreign_key(rdb_database_t *db, const rdb_foreign_key_t *foreign_key
         return -1;
     }
 
+    /* Check that both columns exist */
+    if (rdb_get_column_index(rdb_get_table(db, foreign_key->table_name), foreign_key->column_name) < 0 ||
+        rdb_get_column_index(rdb_get_table(db, foreign_key->ref_table_name),
+                             foreign_key->ref_column_name) < 0) {
+        printf("Error: Foreign key constraint '%s' names a column that does not exist\n",
+               foreign_key->constraint_name);
+        return -1;
+    }
+
     /* Check if constraint name already exists */
     const char *constraint_name = foreign_key->constraint_name;
     if (fi_map_contains(db->foreign_keys, &constraint_name)) {
@@ -1938,12 +2103,19 @@ int rdb_add_foreign_key(rdb_database_t *db, const rdb_foreign_key_t *foreign_key
 
     *fk_copy = *foreign_key;
 
-    /* Add to database */
+    /* Add to database; the map key points at the name inside the copy */
+    constraint_name = fk_copy->constraint_name;
     if (fi_map_put(db->foreign_keys, &constraint_name, &fk_copy) != 0) {
         free(fk_copy);
         return -1;
     }
 
+    if (rdb_link_foreign_key(db, fk_copy) != 0) {
+        fi_map_remove(db->foreign_keys, &constraint_name);
+        free(fk_copy);
+        return -1;
+    }
+
     printf("Foreign key constraint '%s' added successfully\n", foreign_key->constraint_name);
     return 0;
 }
@@ -1960,6 +2132,7 @@ int rdb_drop_foreign_key(rdb_database_t *db, const char *constraint_name) {
     }
 
     /* Remove from database */
+    rdb_unlink_foreign_key(db, foreign_key);
     fi_map_remove(db->foreign_keys, &constraint_name);
     if (foreign_key) {
         rdb_foreign_key_free(foreign_key);
@@ -2028,7 +2201,7 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
     if (fi_array_count(stmt->from_tables) == 1) {
         for (size_t i = 0; i < fi_array_count(table1->rows); i++) {
             rdb_row_t *row = *(rdb_row_t**)fi_array_get(table1->rows, i);
-            if (!row) continue;
+            if (!row || row->deleted) continue;
 
             /* Create result row */
             fi_array *table_names = fi_array_create(1, sizeof(char*));
@@ -2048,17 +2221,8 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
                         snprintf(key, sizeof(key), "%s.%s", first_table, col->name);
 
                         /* Create a copy of the value */
-                        rdb_value_t *val_copy = malloc(sizeof(rdb_value_t));
+                        rdb_value_t *val_copy = rdb_value_copy(val);
                         if (val_copy) {
-                            *val_copy = *val;
-                            if (val->type == RDB_TYPE_VARCHAR || val->type == RDB_TYPE_TEXT) {
-                                if (val->data.string_val) {
-                                    val_copy->data.string_val = malloc(strlen(val->data.string_val) + 1);
-                                    if (val_copy->data.string_val) {
-                                        strcpy(val_copy->data.string_val, val->data.string_val);
-                                    }
-                                }
-                            }
                             const char *key_ptr = key; fi_map_put(values, &key_ptr, &val_copy);
                         }
                     }
@@ -2088,11 +2252,11 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
         /* Perform cartesian product with join conditions */
         for (size_t i = 0; i < fi_array_count(table1->rows); i++) {
             rdb_row_t *row1 = *(rdb_row_t**)fi_array_get(table1->rows, i);
-            if (!row1) continue;
+            if (!row1 || row1->deleted) continue;
 
             for (size_t j = 0; j < fi_array_count(table2->rows); j++) {
                 rdb_row_t *row2 = *(rdb_row_t**)fi_array_get(table2->rows, j);
-                if (!row2) continue;
+                if (!row2 || row2->deleted) continue;
 
                 /* Check join conditions if any */
                 bool matches = true;
@@ -2126,17 +2290,8 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
                                 char key[128];
                                 snprintf(key, sizeof(key), "%s.%s", first_table, col->name);
 
-                                rdb_value_t *val_copy = malloc(sizeof(rdb_value_t));
+                                rdb_value_t *val_copy = rdb_value_copy(val);
                                 if (val_copy) {
-                                    *val_copy = *val;
-                                    if (val->type == RDB_TYPE_VARCHAR || val->type == RDB_TYPE_TEXT) {
-                                        if (val->data.string_val) {
-                                            val_copy->data.string_val = malloc(strlen(val->data.string_val) + 1);
-                                            if (val_copy->data.string_val) {
-                                                strcpy(val_copy->data.string_val, val->data.string_val);
-                                            }
-                                        }
-                                    }
                                     const char *key_ptr = key; fi_map_put(values, &key_ptr, &val_copy);
                                 }
                             }
@@ -2151,17 +2306,8 @@ fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt) {
                                 char key[128];
                                 snprintf(key, sizeof(key), "%s.%s", second_table, col->name);
 
-                                rdb_value_t *val_copy = malloc(sizeof(rdb_value_t));
+                                rdb_value_t *val_copy = rdb_value_copy(val);
                                 if (val_copy) {
-                                    *val_copy = *val;
-                                    if (val->type == RDB_TYPE_VARCHAR || val->type == RDB_TYPE_TEXT) {
-                                        if (val->data.string_val) {
-                                            val_copy->data.string_val = malloc(strlen(val->data.string_val) + 1);
-                                            if (val_copy->data.string_val) {
-                                                strcpy(val_copy->data.string_val, val->data.string_val);
-                                            }
-                                        }
-                                    }
                                     const char *key_ptr = key; fi_map_put(values, &key_ptr, &val_copy);
                                 }
                             }
@@ -2208,106 +2354,152 @@ bool rdb_row_matches_join_condition(const rdb_row_t *left_row, const rdb_row_t *
     }
 
     /* Compare values */
-    return rdb_value_compare(&left_val, &right_val) == 0;
+    return rdb_value_equals(left_val, right_val);
 }
 
-int rdb_validate_foreign_key(rdb_database_t *db, const char *table_name,
-                            const char *column_name, const rdb_value_t *value) {
-    if (!db || !table_name || !column_name || !value) return -1;
+/* WHERE evaluation */
 
-    /* Find foreign key constraints for this table/column */
-    fi_map_iterator iter = fi_map_iterator_create(db->foreign_keys);
-
-    /* Handle first element if iterator is valid */
-    if (iter.is_valid) {
-        rdb_foreign_key_t **fk_ptr = (rdb_foreign_key_t**)fi_map_iterator_value(&iter);
-        if (fk_ptr && *fk_ptr) {
-            rdb_foreign_key_t *fk = *fk_ptr;
-            if (strcmp(fk->table_name, table_name) == 0 &&
-                strcmp(fk->column_name, column_name) == 0) {
+/* Order a row value against a condition value. Numbers compare across INT
+ * and FLOAT; other types only compare with themselves. */
+int rdb_condition_compare(const rdb_value_t *a, const rdb_value_t *b, bool *comparable) {
+    *comparable = true;
 
-                /* Check if referenced value exists */
-                rdb_table_t *ref_table = rdb_get_table(db, fk->ref_table_name);
-                if (!ref_table) return -1;
+    if ((a->type == RDB_TYPE_INT || a->type == RDB_TYPE_FLOAT) &&
+        (b->type == RDB_TYPE_INT || b->type == RDB_TYPE_FLOAT)) {
+        if (a->type == RDB_TYPE_INT && b->type == RDB_TYPE_INT) {
+            return (a->data.int_val > b->data.int_val) - (a->data.int_val < b->data.int_val);
+        }
+        double da = a->type == RDB_TYPE_INT ? (double)a->data.int_val : a->data.float_val;
+        double db = b->type == RDB_TYPE_INT ? (double)b->data.int_val : b->data.float_val;
+        return (da > db) - (da < db);
+    }
 
-                int ref_col_idx = rdb_get_column_index(ref_table, fk->ref_column_name);
-                if (ref_col_idx < 0) return -1;
+    if ((a->type == RDB_TYPE_VARCHAR || a->type == RDB_TYPE_TEXT) &&
+        (b->type == RDB_TYPE_VARCHAR || b->type == RDB_TYPE_TEXT)) {
+        return strcmp(rdb_get_string_value(a), rdb_get_string_value(b));
+    }
 
-                /* Search for matching value in referenced table */
-                for (size_t i = 0; i < fi_array_count(ref_table->rows); i++) {
-                    rdb_row_t *row = *(rdb_row_t**)fi_array_get(ref_table->rows, i);
-                    if (!row || !row->values) continue;
+    if (a->type == RDB_TYPE_BOOLEAN && b->type == RDB_TYPE_BOOLEAN) {
+        return (int)a->data.bool_val - (int)b->data.bool_val;
+    }
 
-                    rdb_value_t *ref_val = *(rdb_value_t**)fi_array_get(row->values, ref_col_idx);
-                    if (ref_val && rdb_value_compare(&value, &ref_val) == 0) {
-                        return 0; /* Valid foreign key */
-                    }
-                }
+    *comparable = false;
+    return 0;
+}
 
-                return -1; /* Foreign key violation */
-            }
+/* SQL LIKE with '%' (any run) and '_' (any single character) */
+bool rdb_like_match(const char *text, const char *pattern) {
+    const char *star_pattern = NULL;
+    const char *star_text = NULL;
+
+    while (*text) {
+        if (*pattern == '%') {
+            star_pattern = ++pattern;
+            star_text = text;
+        } else if (*pattern == '_' || *pattern == *text) {
+            pattern++;
+            text++;
+        } else if (star_pattern) {
+            pattern = star_pattern;
+            text = ++star_text;
+        } else {
+            return false;
         }
     }
 
-    /* Handle remaining elements */
-    while (fi_map_iterator_next(&iter)) {
-        rdb_foreign_key_t **fk_ptr = (rdb_foreign_key_t**)fi_map_iterator_value(&iter);
-        if (fk_ptr && *fk_ptr) {
-            rdb_foreign_key_t *fk = *fk_ptr;
-            if (strcmp(fk->table_name, table_name) == 0 &&
-                strcmp(fk->column_name, column_name) == 0) {
+    while (*pattern == '%') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
 
-                /* Check if referenced value exists */
-                rdb_table_t *ref_table = rdb_get_table(db, fk->ref_table_name);
-                if (!ref_table) return -1;
+bool rdb_condition_matches(const rdb_value_t *value, const sql_where_condition_t *cond) {
+    bool value_null = !value || value->is_null;
+    bool cond_null = !cond->value || cond->value->is_null;
 
-                int ref_col_idx = rdb_get_column_index(ref_table, fk->ref_column_name);
-                if (ref_col_idx < 0) return -1;
+    if (cond->operator == SQL_OP_IS && cond_null) {
+        return value_null;
+    }
 
-                /* Search for matching value in referenced table */
-                for (size_t i = 0; i < fi_array_count(ref_table->rows); i++) {
-                    rdb_row_t *row = *(rdb_row_t**)fi_array_get(ref_table->rows, i);
-                    if (!row || !row->values) continue;
+    /* Comparisons involving NULL are never true */
+    if (value_null || cond_null) return false;
 
-                    rdb_value_t *ref_val = *(rdb_value_t**)fi_array_get(row->values, ref_col_idx);
-                    if (ref_val && rdb_value_compare(&value, &ref_val) == 0) {
-                        return 0; /* Valid foreign key */
-                    }
-                }
+    if (cond->operator == SQL_OP_LIKE) {
+        bool strings = (value->type == RDB_TYPE_VARCHAR || value->type == RDB_TYPE_TEXT) &&
+                       (cond->value->type == RDB_TYPE_VARCHAR || cond->value->type == RDB_TYPE_TEXT);
+        const char *text = strings ? rdb_get_string_value(value) : NULL;
+        const char *pattern = strings ? rdb_get_string_value(cond->value) : NULL;
+        return text && pattern && rdb_like_match(text, pattern);
+    }
 
-                return -1; /* Foreign key violation */
-            }
-        }
+    /* Literals bound to a column dictionary match by entry */
+    bool equal;
+    if ((cond->operator == SQL_OP_EQUAL || cond->operator == SQL_OP_NOT_EQUAL) &&
+        rdb_shared_string_equality(value, cond->value, &equal)) {
+        return cond->operator == SQL_OP_EQUAL ? equal : !equal;
     }
 
-    return 0; /* No foreign key constraint found */
+    bool comparable;
+    int cmp = rdb_condition_compare(value, cond->value, &comparable);
+    if (!comparable) return false;
+
+    switch (cond->operator) {
+        case SQL_OP_EQUAL:
+        case SQL_OP_IS:
+        case SQL_OP_IN:         /* The parser accepts a single IN value */
+            return cmp == 0;
+        case SQL_OP_NOT_EQUAL:
+            return cmp != 0;
+        case SQL_OP_LESS_THAN:
+            return cmp < 0;
+        case SQL_OP_GREATER_THAN:
+            return cmp > 0;
+        case SQL_OP_LESS_EQUAL:
+            return cmp <= 0;
+        case SQL_OP_GREATER_EQUAL:
+            return cmp >= 0;
+        default:
+            return false;
+    }
 }
 
-int rdb_enforce_foreign_key_constraints(rdb_database_t *db, const char *table_name,
-                                       rdb_row_t *row) {
-    if (!db || !table_name || !row) return -1;
+/* Evaluate a WHERE clause. Conditions are joined left to right by their
+ * logical connectors, with AND binding tighter than OR. */
+bool rdb_row_matches_conditions(rdb_table_t *table, const rdb_row_t *row, fi_array *where_conditions) {
+    if (row && row->deleted) return false;
+    if (!where_conditions || fi_array_count(where_conditions) == 0) return true;
+    if (!table || !row || !row->values) return false;
 
-    rdb_table_t *table = rdb_get_table(db, table_name);
-    if (!table) return -1;
+    bool group = true;
+    size_t count = fi_array_count(where_conditions);
 
-    /* Check each column for foreign key constraints */
-    for (size_t i = 0; i < fi_array_count(table->columns); i++) {
-        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
-        if (!col) continue;
+    for (size_t i = 0; i < count; i++) {
+        sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(where_conditions, i);
 
-        rdb_value_t *val = *(rdb_value_t**)fi_array_get(row->values, i);
-        if (!val) continue;
+        if (group && cond && cond->expr) {
+            rdb_program_t *program = rdb_expr_compile(table, cond->expr);
+            group = program && rdb_program_matches(program, row);
+            rdb_program_free(program);
+        } else if (group && cond) {
+            int col_index = rdb_get_column_index(table, cond->column_name);
+            rdb_value_t *value = NULL;
+            if (col_index >= 0 && col_index < (int)fi_array_count(row->values)) {
+                value = *(rdb_value_t**)fi_array_get(row->values, col_index);
+            }
+            group = col_index >= 0 && rdb_condition_matches(value, cond);
+        }
 
-        if (rdb_validate_foreign_key(db, table_name, col->name, val) != 0) {
-            printf("Error: Foreign key constraint violation on column '%s'\n", col->name);
-            return -1;
+        bool ends_group = i + 1 == count ||
+                          (cond && strcasecmp(cond->logical_connector, "OR") == 0);
+        if (ends_group) {
+            if (group) return true;
+            group = true;
         }
     }
 
-    return 0;
+    return false;
 }
 
-
 /* Utility functions for multi-table operations */
 void rdb_print_join_result(fi_array *result, const rdb_statement_t *stmt) {
     if (!result || !stmt) return;
@@ -2625,6 +2817,7 @@ int rdb_insert_row_thread_safe(rdb_database_t *db, const char *table_name, fi_ar
     }
 
     row->row_id = table->next_row_id++;
+    row->deleted = false;
     pthread_mutex_unlock(&table->mutex);
 
     /* Create deep copy of values array */
@@ -2660,6 +2853,13 @@ int rdb_insert_row_thread_safe(rdb_database_t *db, const char *table_name, fi_ar
         return -1;
     }
 
+    /* Reject duplicate PRIMARY KEY / UNIQUE values */
+    if (rdb_table_check_unique(table, row) != 0) {
+        rdb_row_free(row);
+        rdb_unlock_table(table);
+        return -1;
+    }
+
     /* Add row to table */
     if (fi_array_push(table->rows, &row) != 0) {
         rdb_row_free(row);
@@ -2701,37 +2901,49 @@ int rdb_update_rows_thread_safe(rdb_database_t *db, const char *table_name, fi_a
 
     int updated_count = 0;
 
-    /* Update each row that matches WHERE conditions */
-    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
-        if (!row || !row->values) continue;
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) {
+        rdb_unlock_table(table);
+        return -1;
+    }
 
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For simplicity, we'll assume all rows match if conditions exist */
-            /* In a real implementation, you'd evaluate the conditions here */
-        }
+    if (rdb_table_check_unique_update(table, matches, set_columns, set_values) != 0 ||
+        rdb_check_update_references(db, table, matches, set_columns, set_values) != 0) {
+        fi_array_destroy(matches);
+        rdb_unlock_table(table);
+        return -1;
+    }
 
-        if (matches) {
-            /* Update the row with new values */
-            for (size_t j = 0; j < fi_array_count(set_columns); j++) {
-                const char *column_name = *(const char**)fi_array_get(set_columns, j);
-                rdb_value_t *new_value = *(rdb_value_t**)fi_array_get(set_values, j);
-
-                int col_index = rdb_get_column_index(table, column_name);
-                if (col_index >= 0 && col_index < (int)fi_array_count(row->values)) {
-                    rdb_value_t **old_value_ptr = (rdb_value_t**)fi_array_get(row->values, col_index);
-                    if (old_value_ptr) {
-                        rdb_value_free(*old_value_ptr);
-                        *old_value_ptr = rdb_create_int_value(rdb_get_int_value(new_value));
-                    }
+    for (size_t i = 0; i < fi_array_count(matches); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        rdb_cascade_update(db, table, row, set_columns, set_values, false);
+
+        /* Index keys are derived from the values being replaced */
+        rdb_remove_row_from_indexes(table, row);
+
+        /* Update the row with new values */
+        for (size_t j = 0; j < fi_array_count(set_columns); j++) {
+            const char *column_name = *(const char**)fi_array_get(set_columns, j);
+            rdb_value_t *new_value = *(rdb_value_t**)fi_array_get(set_values, j);
+
+            int col_index = rdb_get_column_index(table, column_name);
+            if (col_index >= 0 && col_index < (int)fi_array_count(row->values)) {
+                rdb_value_t **old_value_ptr = (rdb_value_t**)fi_array_get(row->values, col_index);
+                rdb_value_t *value_copy = rdb_value_copy(new_value);
+                if (old_value_ptr && value_copy) {
+                    rdb_value_free(*old_value_ptr);
+                    *old_value_ptr = value_copy;
                 }
             }
-            updated_count++;
         }
+
+        rdb_update_table_indexes(table, row);
+        updated_count++;
     }
 
+    fi_array_destroy(matches);
+
     rdb_unlock_table(table);
 
     printf("Updated %d rows in table '%s'\n", updated_count, table_name);
@@ -2762,38 +2974,31 @@ int rdb_delete_rows_thread_safe(rdb_database_t *db, const char *table_name, fi_a
 
     int deleted_count = 0;
 
-    /* Delete rows that match WHERE conditions */
-    for (size_t i = fi_array_count(table->rows); i > 0; i--) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i - 1);
-        if (!row) continue;
-
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For simplicity, we'll assume all rows match if conditions exist */
-            /* In a real implementation, you'd evaluate the conditions here */
-        }
-
-        if (matches) {
-            /* Create a copy of the old row for potential rollback */
-            rdb_row_t *old_row = malloc(sizeof(rdb_row_t));
-            if (old_row) {
-                old_row->row_id = row->row_id;
-                old_row->values = fi_array_copy(row->values);
-            }
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) {
+        rdb_unlock_table(table);
+        return -1;
+    }
 
-            /* Remove from array and free memory */
-            fi_array_splice(table->rows, i - 1, 1, NULL);
-            rdb_row_free(row);
+    if (rdb_check_delete_references(db, table, matches) != 0) {
+        fi_array_destroy(matches);
+        rdb_unlock_table(table);
+        return -1;
+    }
 
-            if (old_row) {
-                rdb_row_free(old_row);
-            }
+    for (size_t i = 0; i < fi_array_count(matches); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        if (row->deleted) continue; /* Removed by a cascade */
 
-            deleted_count++;
-        }
+        /* Leave a tombstone; the slot is reclaimed by compaction */
+        rdb_table_delete_row(table, row);
+        rdb_cascade_delete(db, table, row, false);
+        deleted_count++;
     }
 
+    fi_array_destroy(matches);
+    rdb_schedule_compaction(db, table);
     rdb_unlock_table(table);
 
     printf("Deleted %d rows from table '%s'\n", deleted_count, table_name);
@@ -2802,7 +3007,6 @@ int rdb_delete_rows_thread_safe(rdb_database_t *db, const char *table_name, fi_a
 
 fi_array* rdb_select_rows_thread_safe(rdb_database_t *db, const char *table_name, fi_array *columns,
                                      fi_array *where_conditions) {
-    (void)columns; /* Suppress unused parameter warning */
     if (!db || !table_name) return NULL;
 
     /* Lock database for read to get table */
@@ -2824,37 +3028,28 @@ fi_array* rdb_select_rows_thread_safe(rdb_database_t *db, const char *table_name
     /* Unlock database now that we have the table */
     rdb_unlock_database(db);
 
-    /* Create result array */
-    fi_array *result = fi_array_create(16, sizeof(rdb_row_t*));
-    if (!result) {
+    int *ordinals;
+    size_t ordinal_count;
+    if (rdb_table_projection(table, columns, &ordinals, &ordinal_count) != 0) {
         rdb_unlock_table(table);
         return NULL;
     }
 
-    /* Select rows that match WHERE conditions */
-    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
-        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
-        if (!row || !row->values) continue;
+    /* Find rows that match WHERE conditions */
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) {
+        free(ordinals);
+        rdb_unlock_table(table);
+        return NULL;
+    }
 
-        /* Check WHERE conditions (simplified - just check if conditions exist) */
-        bool matches = true;
-        if (where_conditions && fi_array_count(where_conditions) > 0) {
-            /* For simplicity, we'll assume all rows match if conditions exist */
-            /* In a real implementation, you'd evaluate the conditions here */
-        }
+    fi_array *result = rdb_project_rows(table, matches, ordinals, ordinal_count);
 
-        if (matches) {
-            /* Create a copy of the row for the result */
-            rdb_row_t *result_row = malloc(sizeof(rdb_row_t));
-            if (result_row) {
-                result_row->row_id = row->row_id;
-                result_row->values = fi_array_copy(row->values);
-                fi_array_push(result, &result_row);
-            }
-        }
-    }
+    fi_array_destroy(matches);
+    free(ordinals);
 
     rdb_unlock_table(table);
+    if (!result) return NULL;
 
     printf("Selected %zu rows from table '%s'\n", fi_array_count(result), table_name);
     return result;
@@ -2897,6 +3092,7 @@ int rdb_create_table_thread_safe(rdb_database_t *db, const char *table_name, fi_
     }
     strcpy(table_name_copy, table_name);
 
+    table->workers = db->workers;
     if (fi_map_put(db->tables, &table_name_copy, &table) != 0) {
         free(table_name_copy);
         rdb_table_cleanup_thread_safety(table);
@@ -2929,6 +3125,7 @@ int rdb_drop_table_thread_safe(rdb_database_t *db, const char *table_name) {
     /* Cleanup thread safety for the table before destroying */
     rdb_table_cleanup_thread_safety(table);
 
+    rdb_drop_table_foreign_keys(db, table);
     fi_map_remove(db->tables, &table_name);
     rdb_destroy_table(table);
 
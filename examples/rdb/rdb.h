@@ -8,11 +8,13 @@
 #include <stdint.h>
 #include <time.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 /* Include FI data structures */
 #include "../../src/include/fi.h"
 #include "../../src/include/fi_map.h"
 #include "../../src/include/fi_btree.h"
+#include "../../src/include/fi_art.h"
 
 /* Data types supported by the database */
 typedef enum {
@@ -36,16 +38,97 @@ typedef struct {
     char foreign_table[64];     /* Referenced table name */
     char foreign_column[64];    /* Referenced column name */
     bool is_foreign_key;        /* Whether this is a foreign key */
+    bool dictionary;            /* VARCHAR/TEXT values stored once in a column dictionary */
 } rdb_column_t;
 
+/* Table storage layouts */
+typedef enum {
+    RDB_STORAGE_ROW = 0,        /* Row objects only */
+    RDB_STORAGE_COLUMNAR        /* Row objects plus a columnar copy for analytical scans */
+} rdb_storage_mode_t;
+
+/* Row ids per zone map block */
+#define RDB_ZONE_ROWS 4096
+
+/* rdb_zone_t flags */
+#define RDB_ZONE_HAS_INT   0x01 /* int_min/int_max hold the INT values */
+#define RDB_ZONE_HAS_FLOAT 0x02 /* float_min/float_max hold the FLOAT values */
+#define RDB_ZONE_UNBOUNDED 0x04 /* Some value has no range (string, boolean, NaN) */
+
+/* Summary of one column over one block of row ids. The counts are exact;
+ * the ranges only widen until the map is rebuilt. */
+typedef struct {
+    uint32_t null_count;        /* NULL values among the live rows */
+    uint8_t flags;              /* RDB_ZONE_* */
+    int64_t int_min;            /* Smallest INT value */
+    int64_t int_max;            /* Largest INT value */
+    double float_min;           /* Smallest FLOAT value */
+    double float_max;           /* Largest FLOAT value */
+} rdb_zone_t;
+
+/* Zone maps of a table: per block, its live row count and one rdb_zone_t
+ * per column */
+typedef struct {
+    size_t column_count;        /* Columns summarized per block */
+    size_t block_count;         /* Blocks allocated */
+    uint32_t *row_counts;       /* Live rows per block */
+    rdb_zone_t *zones;          /* block_count * column_count summaries */
+} rdb_zone_map_t;
+
+/* Forward declarations */
+typedef struct rdb_column_store rdb_column_store_t;
+typedef struct rdb_worker_pool rdb_worker_pool_t;
+typedef struct rdb_table_stats rdb_table_stats_t;
+typedef struct rdb_statement_cache rdb_statement_cache_t;
+typedef struct rdb_prepared rdb_prepared_t;
+
+/* Packed record layout derived from a table schema: a null bitmap and an
+ * other-type bitmap followed by one fixed-width slot per column */
+typedef struct {
+    size_t column_count;        /* Columns in the schema */
+    size_t null_bytes;          /* Size of each bitmap */
+    size_t fixed_size;          /* Both bitmaps plus fixed-width slots */
+    size_t *slot_offsets;       /* Offset of each column's slot */
+    rdb_data_type_t *types;     /* Type of each column */
+} rdb_record_layout_t;
+
+/* Packed row image: the whole row in one allocation, copied with memcpy.
+ * `data` holds the null and other-type bitmaps, the fixed slots (8 bytes
+ * for INT/FLOAT, 1 for BOOLEAN, offset + length for strings) and the tail:
+ * values of another type than their column, then the strings. Used for
+ * row images kept aside, such as transaction log before-images; live rows
+ * are rdb_row_t. */
+typedef struct {
+    uint32_t size;              /* Total bytes, header included */
+    uint32_t column_count;      /* Columns the record was packed with */
+    size_t row_id;              /* Row identifier */
+    uint8_t data[];             /* Bitmaps, fixed slots, tail */
+} rdb_record_t;
+
+/* Tables are compacted once tombstones make up this percentage of their
+ * row slots, and number at least RDB_COMPACT_MIN_DEAD_ROWS */
+#define RDB_COMPACT_DEAD_PERCENT 25
+#define RDB_COMPACT_MIN_DEAD_ROWS 64
+
 /* Table definition */
 typedef struct {
     char name[64];              /* Table name */
     fi_array *columns;          /* Array of rdb_column_t */
-    fi_array *rows;             /* Array of row data */
-    fi_map *indexes;            /* Map of index_name -> fi_btree */
+    fi_array *rows;             /* Array of row data, in row_id order, tombstones included */
+    size_t dead_rows;           /* Tombstoned rows awaiting compaction */
+    fi_map *row_map;            /* row_id -> rdb_row_t*, for point operations by id */
+    fi_map *indexes;            /* Map of index_name -> rdb_index_t */
     char primary_key[64];       /* Primary key column name */
     size_t next_row_id;         /* Next available row ID */
+    rdb_storage_mode_t storage; /* Storage layout */
+    rdb_column_store_t *column_store; /* RDB_STORAGE_COLUMNAR: column row groups */
+    rdb_record_layout_t *record_layout; /* Packed record layout, built on first use */
+    fi_array *dictionaries;     /* rdb_string_dict_t* per column (NULL if not encoded), or NULL */
+    fi_array *foreign_keys;     /* rdb_foreign_key_t* declared by this table, or NULL */
+    fi_array *referenced_by;    /* rdb_foreign_key_t* referencing this table, or NULL */
+    rdb_zone_map_t *zones;      /* Per-block column summaries, or NULL */
+    rdb_table_stats_t *stats;   /* Statistics from the last ANALYZE, or NULL */
+    rdb_worker_pool_t *workers; /* Scan workers of the owning database (borrowed), or NULL */
     /* Thread safety */
     pthread_mutex_t rwlock;     /* Mutex for table operations */
     pthread_mutex_t mutex;      /* Mutex for next_row_id counter */
@@ -55,20 +138,185 @@ typedef struct {
 typedef struct {
     size_t row_id;              /* Unique row identifier */
     fi_array *values;           /* Array of column values */
+    bool deleted;               /* Tombstone: deleted, slot not yet compacted away */
 } rdb_row_t;
 
-/* Value structure */
+/* Shared, reference-counted string buffer. Holds long string values and
+ * the entries of column dictionaries, which also carry their owner and code. */
+typedef struct rdb_string {
+    const struct rdb_string_dict *dict; /* Owning dictionary, NULL for plain strings */
+    atomic_uint refcount;       /* Values (and dictionary) referencing the buffer */
+    uint32_t length;            /* String length in bytes */
+    uint32_t code;              /* Dense code within the dictionary */
+    char data[];                /* NUL-terminated text */
+} rdb_string_t;
+
+/* Column dictionary: each distinct string of a column stored once. Cells of
+ * an encoded column reference the entry, so equal cells share one buffer and
+ * equality within the column is entry identity. */
+typedef struct rdb_string_dict {
+    fi_map *codes;              /* Entry text (char*) -> rdb_string_t* */
+    fi_array *entries;          /* rdb_string_t* indexed by code */
+} rdb_string_dict_t;
+
+/* Longest string stored inside the value itself */
+#define RDB_VALUE_INLINE_MAX 12
+/* str_len marker for strings kept in a shared rdb_string_t */
+#define RDB_VALUE_SHARED_STRING 0xFF
+
+/* Value structure (16 bytes)
+ * A string of up to RDB_VALUE_INLINE_MAX bytes is stored in place, starting
+ * at inline_str and running on through data, so short codes need no extra
+ * allocation. Longer strings point at a shared rdb_string_t and copying the
+ * value only bumps its reference count. Read strings with
+ * rdb_get_string_value() rather than touching the storage directly. */
 typedef struct {
-    rdb_data_type_t type;       /* Value type */
+    uint8_t type;               /* Value type (rdb_data_type_t) */
+    bool is_null;               /* Whether this value is NULL */
+    uint8_t str_len;            /* Inline string length, or RDB_VALUE_SHARED_STRING */
+    char inline_str[5];         /* Start of an inline string */
     union {
         int64_t int_val;
         double float_val;
-        char *string_val;
         bool bool_val;
+        rdb_string_t *string_ref;
     } data;
-    bool is_null;               /* Whether this value is NULL */
 } rdb_value_t;
 
+/* ANALYZE statistics of one column. Fractions are shares of the live rows. */
+typedef struct {
+    double null_fraction;       /* Rows holding NULL */
+    double distinct_count;      /* Distinct non-NULL values (HyperLogLog estimate) */
+    size_t mcv_count;           /* Most common values kept */
+    rdb_value_t **mcv_values;   /* Most common values, most frequent first */
+    double *mcv_fractions;      /* Rows holding each of them */
+    size_t bound_count;         /* Histogram bounds (buckets + 1), or 0 */
+    rdb_value_t **bounds;       /* Equi-depth histogram bounds, ascending */
+} rdb_column_stats_t;
+
+/* ANALYZE statistics of a table */
+struct rdb_table_stats {
+    size_t row_count;           /* Live rows when analyzed */
+    time_t analyzed_time;       /* When ANALYZE ran */
+    size_t column_count;        /* Entries in columns */
+    rdb_column_stats_t *columns;
+};
+
+/* Maximum number of key columns in one index */
+#define RDB_MAX_INDEX_COLUMNS 8
+
+/* Index storage */
+typedef enum {
+    RDB_INDEX_BTREE = 0,        /* Ordered tree: equality, ranges and LIKE prefixes */
+    RDB_INDEX_ART,              /* Radix tree: equality and LIKE prefixes in O(key length) */
+    RDB_INDEX_HASH              /* Hash map of unique keys: PRIMARY KEY / UNIQUE enforcement */
+} rdb_index_kind_t;
+
+/* Secondary index over one or more columns.
+ * The key columns of a row are encoded into one byte string that sorts with
+ * memcmp in the same order as the column tuple, so a single ordered tree
+ * serves equality on any leading prefix of the columns plus a range on the
+ * column that follows it. */
+typedef struct {
+    char name[64];              /* Index name */
+    size_t column_count;        /* Number of key columns */
+    char column_names[RDB_MAX_INDEX_COLUMNS][64]; /* Key columns, most significant first */
+    int column_indexes[RDB_MAX_INDEX_COLUMNS];    /* Ordinals of the key columns in the table */
+    rdb_index_kind_t kind;      /* Storage backing the index */
+    fi_btree *tree;             /* RDB_INDEX_BTREE: ordered set of rdb_index_entry_t */
+    fi_art *art;                /* RDB_INDEX_ART: key || row id -> rdb_row_t* */
+    fi_map *hash;               /* RDB_INDEX_HASH: key -> rdb_row_t*, one row per key */
+    uint8_t *key_prefix;        /* Leading key bytes shared by every entry */
+    size_t key_prefix_length;   /* Length of the shared prefix */
+    size_t misfit_count;        /* RDB_INDEX_BTREE: entries keyed as NULL for a value of another type */
+} rdb_index_t;
+
+/* Bytes of an entry key held in its abbreviated key */
+#define RDB_INDEX_ABBREV_SIZE 8
+
+/* Index entry: encoded key tuple plus the row it refers to.
+ * Only the part of the key after the index's shared prefix is stored. Its
+ * first bytes are also packed big-endian into `abbrev`, so most comparisons
+ * are a single integer compare; short keys need no separate allocation. */
+typedef struct {
+    uint64_t abbrev;            /* First RDB_INDEX_ABBREV_SIZE key bytes, zero padded */
+    uint8_t *key;               /* Key bytes, or NULL when they all fit in abbrev */
+    size_t key_length;          /* Length of the stored key */
+    size_t row_id;              /* Row identifier (tie breaker for duplicate keys) */
+    rdb_row_t *row;             /* Indexed row */
+} rdb_index_entry_t;
+
+/* Rows per columnar row group */
+#define RDB_ROW_GROUP_SIZE 1024
+
+/* Rows per batch when evaluating WHERE clauses */
+#define RDB_BATCH_SIZE 1024
+
+/* Rows per morsel of a parallel scan; scans of fewer than two morsels stay
+ * on the calling thread */
+#define RDB_MORSEL_SIZE (16 * RDB_BATCH_SIZE)
+
+/* Processes rows [begin, end) of a parallel scan. `worker` numbers the
+ * threads taking part in the scan from 0, `morsel` the morsel. */
+typedef void (*rdb_morsel_func_t)(void *context, size_t worker, size_t morsel,
+                                  size_t begin, size_t end);
+
+/* Bit `i` of a row group bitmap */
+#define RDB_BITMAP_TEST(bits, i) (((bits)[(i) >> 6] >> ((i) & 63)) & 1)
+
+/* One column of a row group: a contiguous vector of the column's type.
+ * Strings are stored back to back in `bytes`; slot i spans
+ * [offsets[i], offsets[i + 1]). NULL slots hold zero / an empty string.
+ * A value of another type than the column's is converted or stored as
+ * NULL and counted in `mismatched`; scans only read vectors without any,
+ * and go to the row objects for the others. */
+typedef struct {
+    rdb_data_type_t type;       /* Column type */
+    size_t mismatched;          /* Slots holding a converted or dropped value */
+    uint64_t nulls[RDB_ROW_GROUP_SIZE / 64]; /* Bit set when the slot is NULL */
+    int64_t *ints;              /* RDB_TYPE_INT */
+    double *floats;             /* RDB_TYPE_FLOAT */
+    bool *bools;                /* RDB_TYPE_BOOLEAN */
+    uint32_t *offsets;          /* RDB_TYPE_VARCHAR/TEXT: row_count + 1 offsets */
+    char *bytes;                /* RDB_TYPE_VARCHAR/TEXT: string bytes */
+    size_t bytes_capacity;      /* Allocated size of bytes */
+} rdb_column_vector_t;
+
+/* Up to RDB_ROW_GROUP_SIZE rows stored column by column (PAX layout).
+ * Rows are only appended; deleting or updating a row marks its old slot. */
+typedef struct {
+    size_t row_count;           /* Slots in use */
+    size_t live_count;          /* Slots not marked deleted */
+    size_t capacity;            /* Slots allocated in each column vector */
+    size_t row_ids[RDB_ROW_GROUP_SIZE];        /* Row id of each slot */
+    rdb_row_t *rows[RDB_ROW_GROUP_SIZE];       /* Row object of each slot, valid while live */
+    uint64_t deleted[RDB_ROW_GROUP_SIZE / 64]; /* Bit set when the slot is deleted */
+    size_t column_count;        /* Number of column vectors */
+    rdb_column_vector_t *columns; /* One vector per table column */
+} rdb_row_group_t;
+
+/* Columnar copy of a table */
+struct rdb_column_store {
+    fi_array *groups;           /* rdb_row_group_t* in append order */
+    fi_map *slots;              /* row_id -> group * RDB_ROW_GROUP_SIZE + slot */
+    size_t deleted_count;       /* Deleted slots not yet compacted away */
+    size_t next_row_id;         /* One past the largest row id appended */
+    bool ordered;               /* Slots are in row id order across groups */
+};
+
+/* Summary of one column over the live rows of a columnar table */
+typedef struct {
+    rdb_data_type_t type;       /* Column type */
+    size_t row_count;           /* Live rows */
+    size_t value_count;         /* Non-NULL values */
+    double sum;                 /* Sum of the values (INT/FLOAT/BOOLEAN) */
+    double min;                 /* Smallest value, valid when value_count > 0 */
+    double max;                 /* Largest value, valid when value_count > 0 */
+} rdb_column_summary_t;
+
+/* Row group visitor; return false to stop the scan */
+typedef bool (*rdb_row_group_visit_t)(const rdb_row_group_t *group, void *user_data);
+
 /* Foreign key constraint */
 typedef struct {
     char constraint_name[64];    /* Constraint name */
@@ -93,6 +341,16 @@ typedef struct {
     /* Thread safety */
     pthread_mutex_t rwlock;     /* Mutex for database operations */
     pthread_mutex_t mutex;      /* Mutex for database state changes */
+    /* Background compaction */
+    pthread_t compaction_thread; /* Compacts tables with many tombstones */
+    bool compaction_running;    /* Whether the compaction thread is running */
+    unsigned compaction_interval_ms; /* Idle wake-up period of the thread */
+    pthread_mutex_t compaction_mutex; /* Guards compaction_running and the wake-up */
+    pthread_cond_t compaction_cond; /* Signalled when a table passes the threshold */
+    /* Parallel scans */
+    rdb_worker_pool_t *workers; /* Scan worker pool, shared by the tables */
+    /* Prepared statements */
+    rdb_statement_cache_t *statements; /* Parsed statements kept by SQL text */
 } rdb_database_t;
 
 /* SQL statement types */
@@ -109,7 +367,12 @@ typedef enum {
     RDB_STMT_DROP_FOREIGN_KEY,
     RDB_STMT_BEGIN_TRANSACTION,
     RDB_STMT_COMMIT_TRANSACTION,
-    RDB_STMT_ROLLBACK_TRANSACTION
+    RDB_STMT_ROLLBACK_TRANSACTION,
+    RDB_STMT_VACUUM,
+    RDB_STMT_ANALYZE,
+    RDB_STMT_PREPARE,
+    RDB_STMT_EXECUTE,
+    RDB_STMT_DEALLOCATE
 } rdb_stmt_type_t;
 
 /* JOIN types */
@@ -168,8 +431,7 @@ typedef struct {
     rdb_operation_type_t operation_type;  /* Type of operation */
     char table_name[64];                  /* Table name */
     size_t row_id;                        /* Row ID (for row operations) */
-    rdb_row_t *old_row;                   /* Original row data (for rollback) */
-    rdb_row_t *new_row;                   /* New row data */
+    rdb_record_t *old_record;             /* Packed original row (UPDATE/DELETE rollback) */
     char index_name[64];                  /* Index name (for index operations) */
     char column_name[64];                 /* Column name (for column operations) */
     rdb_column_t *column_def;             /* Column definition (for schema changes) */
@@ -199,25 +461,130 @@ struct rdb_transaction_manager {
     pthread_mutex_t rwlock;                  /* Mutex for transaction state */
 };
 
+/* Expression node kinds */
+typedef enum {
+    RDB_EXPR_LITERAL = 1,       /* Constant value */
+    RDB_EXPR_COLUMN,            /* Column of the current row */
+    RDB_EXPR_UNARY,             /* NOT, unary minus, IS [NOT] NULL */
+    RDB_EXPR_BINARY,            /* Arithmetic, comparison, AND/OR */
+    RDB_EXPR_FUNCTION           /* Function call */
+} rdb_expr_kind_t;
+
+/* Expression operators */
+typedef enum {
+    RDB_EXPR_OP_NONE = 0,
+    RDB_EXPR_OP_ADD,
+    RDB_EXPR_OP_SUB,
+    RDB_EXPR_OP_MUL,
+    RDB_EXPR_OP_DIV,
+    RDB_EXPR_OP_MOD,
+    RDB_EXPR_OP_EQ,
+    RDB_EXPR_OP_NE,
+    RDB_EXPR_OP_LT,
+    RDB_EXPR_OP_GT,
+    RDB_EXPR_OP_LE,
+    RDB_EXPR_OP_GE,
+    RDB_EXPR_OP_LIKE,
+    RDB_EXPR_OP_AND,
+    RDB_EXPR_OP_OR,
+    RDB_EXPR_OP_NOT,
+    RDB_EXPR_OP_NEG,
+    RDB_EXPR_OP_IS_NULL,
+    RDB_EXPR_OP_IS_NOT_NULL
+} rdb_expr_op_t;
+
+/* Expression tree, as parsed from WHERE and SET clauses */
+typedef struct rdb_expr {
+    rdb_expr_kind_t kind;       /* Node kind */
+    rdb_expr_op_t op;           /* UNARY / BINARY operator */
+    rdb_value_t *value;         /* LITERAL value */
+    char name[64];              /* COLUMN or FUNCTION name */
+    struct rdb_expr **args;     /* Operands or function arguments */
+    size_t arg_count;           /* Number of args */
+} rdb_expr_t;
+
+/* One bytecode instruction */
+typedef struct {
+    uint8_t opcode;             /* rdb_vm_opcode_t */
+    uint8_t aux;                /* Comparison operator or argument count */
+    uint16_t column;            /* Column ordinal */
+    int32_t operand;            /* Constant index, jump target or function id */
+} rdb_instruction_t;
+
+/* An expression compiled against a table schema */
+typedef struct {
+    rdb_instruction_t *code;    /* Instructions */
+    size_t length;              /* Number of instructions */
+    rdb_value_t *constants;     /* Literals, owned by the program */
+    size_t constant_count;      /* Number of constants */
+    size_t stack_depth;         /* Deepest stack the code reaches */
+} rdb_program_t;
+
+/* Deepest evaluation stack an expression may need */
+#define RDB_EXPR_MAX_STACK 32
+
+/* Aggregate functions */
+typedef enum {
+    RDB_AGG_NONE = 0,           /* Plain column, must be a GROUP BY column */
+    RDB_AGG_COUNT_STAR,
+    RDB_AGG_COUNT,
+    RDB_AGG_SUM,
+    RDB_AGG_AVG,
+    RDB_AGG_MIN,
+    RDB_AGG_MAX
+} rdb_aggregate_func_t;
+
+/* One ORDER BY item */
+typedef struct {
+    char column[64];            /* Column or select-list name */
+    size_t position;            /* 1-based select-list position, 0 when named */
+    bool descending;            /* DESC */
+} rdb_order_by_t;
+
+/* A resolved sort key: value position in the row and direction */
+typedef struct {
+    int column;                 /* Index into the row's values */
+    bool descending;            /* Largest first, NULL last */
+} rdb_sort_key_t;
+
+/* limit_value of a statement without LIMIT */
+#define RDB_NO_LIMIT SIZE_MAX
+
+/* One item of an aggregating SELECT list */
+typedef struct {
+    rdb_aggregate_func_t func;  /* Function, or RDB_AGG_NONE */
+    char column[64];            /* Argument column (empty for COUNT(*)) */
+} rdb_aggregate_t;
+
 /* SQL statement structure */
 typedef struct {
     rdb_stmt_type_t type;       /* Statement type */
     char table_name[64];        /* Target table name */
     fi_array *columns;          /* Column names */
     fi_array *values;           /* Values for INSERT/UPDATE */
+    fi_array *set_expressions;  /* rdb_expr_t* per SET column (NULL for literals), or NULL */
     fi_array *where_conditions; /* WHERE conditions */
     fi_array *select_columns;   /* Columns to select */
+    fi_array *aggregates;       /* rdb_aggregate_t per select item when aggregating, or NULL */
+    fi_array *group_by;         /* GROUP BY column names, or NULL */
     char index_name[64];        /* Index name for CREATE/DROP INDEX */
     char index_column[64];      /* Column name for index */
+    char index_columns[RDB_MAX_INDEX_COLUMNS][64]; /* All key columns for CREATE INDEX */
+    size_t index_column_count;  /* Number of entries in index_columns */
+    rdb_index_kind_t index_kind; /* Storage requested with USING */
+    rdb_storage_mode_t storage_mode; /* CREATE TABLE ... USING ROW | COLUMNAR */
     /* Multi-table support */
     fi_array *from_tables;      /* Tables in FROM clause */
     fi_array *join_conditions;  /* JOIN conditions */
-    fi_array *order_by;         /* ORDER BY columns */
-    size_t limit_value;         /* LIMIT value */
+    fi_array *order_by;         /* rdb_order_by_t items, or NULL */
+    size_t limit_value;         /* LIMIT value, RDB_NO_LIMIT when absent */
     size_t offset_value;        /* OFFSET value */
     /* Foreign key operations */
     char foreign_key_name[64];  /* Foreign key constraint name */
     rdb_foreign_key_t *foreign_key; /* Foreign key definition */
+    /* PREPARE / EXECUTE / DEALLOCATE (EXECUTE arguments are in values) */
+    char prepared_name[64];     /* Prepared statement name */
+    char *prepared_sql;         /* Statement text of PREPARE, owned */
 } rdb_statement_t;
 
 /* Database operations */
@@ -243,6 +610,8 @@ int rdb_update_rows(rdb_database_t *db, const char *table_name, fi_array *set_co
 int rdb_delete_rows(rdb_database_t *db, const char *table_name, fi_array *where_conditions);
 fi_array* rdb_select_rows(rdb_database_t *db, const char *table_name, fi_array *columns, 
                           fi_array *where_conditions);
+int rdb_table_projection(rdb_table_t *table, fi_array *columns, int **ordinals, size_t *count);
+rdb_row_t* rdb_project_row(const rdb_row_t *row, const int *ordinals, size_t count);
 
 /* Multi-table operations */
 fi_array* rdb_select_join(rdb_database_t *db, const rdb_statement_t *stmt);
@@ -251,11 +620,208 @@ int rdb_validate_foreign_key(rdb_database_t *db, const char *table_name,
 int rdb_enforce_foreign_key_constraints(rdb_database_t *db, const char *table_name, 
                                        rdb_row_t *row);
 
+/* Foreign key enforcement */
+int rdb_link_foreign_key(rdb_database_t *db, rdb_foreign_key_t *foreign_key);
+void rdb_unlink_foreign_key(rdb_database_t *db, rdb_foreign_key_t *foreign_key);
+void rdb_drop_table_foreign_keys(rdb_database_t *db, rdb_table_t *table);
+int rdb_check_delete_references(rdb_database_t *db, rdb_table_t *table, fi_array *rows);
+void rdb_cascade_delete(rdb_database_t *db, rdb_table_t *table, rdb_row_t *row, bool logged);
+int rdb_check_update_references(rdb_database_t *db, rdb_table_t *table, fi_array *rows,
+                                fi_array *set_columns, fi_array *set_values);
+void rdb_cascade_update(rdb_database_t *db, rdb_table_t *table, rdb_row_t *row,
+                        fi_array *set_columns, fi_array *set_values, bool logged);
+
 /* Index operations */
 int rdb_create_index(rdb_database_t *db, const char *table_name, const char *index_name, 
                      const char *column_name);
+int rdb_create_composite_index(rdb_database_t *db, const char *table_name, const char *index_name,
+                               const char **column_names, size_t column_count);
+int rdb_create_index_using(rdb_database_t *db, const char *table_name, const char *index_name,
+                           const char **column_names, size_t column_count, rdb_index_kind_t kind);
 int rdb_drop_index(rdb_database_t *db, const char *table_name, const char *index_name);
 fi_btree* rdb_get_index(rdb_database_t *db, const char *table_name, const char *index_name);
+rdb_index_t* rdb_get_table_index(rdb_table_t *table, const char *index_name);
+
+/* Index maintenance and access paths */
+void rdb_index_destroy(rdb_index_t *index);
+int rdb_index_entry_compare(const void *a, const void *b);
+int rdb_index_insert_row(rdb_index_t *index, rdb_table_t *table, rdb_row_t *row);
+int rdb_index_remove_row(rdb_index_t *index, rdb_table_t *table, rdb_row_t *row);
+void rdb_remove_row_from_indexes(rdb_table_t *table, rdb_row_t *row);
+void rdb_refresh_table_indexes(rdb_table_t *table, const char *dropped_column);
+int rdb_table_build_row_map(rdb_table_t *table);
+rdb_row_t* rdb_table_find_row(const rdb_table_t *table, size_t row_id);
+int rdb_table_row_slot(const rdb_table_t *table, size_t row_id, size_t *slot);
+int rdb_table_insert_row_slot(rdb_table_t *table, rdb_row_t *row);
+
+/* PRIMARY KEY and UNIQUE constraints */
+int rdb_table_create_constraint_indexes(rdb_table_t *table);
+int rdb_table_check_unique(rdb_table_t *table, const rdb_row_t *row);
+int rdb_table_check_unique_assignments(rdb_table_t *table, fi_array *rows,
+                                       fi_array *set_columns, fi_array *row_values);
+int rdb_table_check_unique_update(rdb_table_t *table, fi_array *rows,
+                                  fi_array *set_columns, fi_array *set_values);
+fi_array* rdb_table_rows_with_value(rdb_table_t *table, int column_index,
+                                    const rdb_value_t *value, size_t limit);
+int rdb_table_ensure_column_index(rdb_table_t *table, const char *column_name,
+                                  const char *index_name);
+size_t rdb_table_lower_slot(const rdb_table_t *table, size_t row_id);
+
+/* Zone maps */
+rdb_zone_map_t* rdb_zone_map_create(size_t column_count);
+void rdb_zone_map_destroy(rdb_zone_map_t *map);
+int rdb_zone_map_rebuild(rdb_table_t *table);
+void rdb_zone_map_add_row(rdb_table_t *table, const rdb_row_t *row);
+void rdb_zone_map_remove_row(rdb_table_t *table, const rdb_row_t *row);
+fi_array* rdb_zone_map_candidates(rdb_table_t *table, fi_array *where_conditions);
+
+/* Table statistics (ANALYZE) */
+rdb_table_stats_t* rdb_table_stats_create(size_t column_count);
+void rdb_table_stats_destroy(rdb_table_stats_t *stats);
+int rdb_table_analyze(rdb_table_t *table);
+int rdb_analyze(rdb_database_t *db, const char *table_name);
+double rdb_stats_estimate_rows(rdb_table_t *table, fi_array *where_conditions);
+void rdb_print_table_stats(rdb_table_t *table);
+
+/* Tombstones and compaction */
+void rdb_table_delete_row(rdb_table_t *table, rdb_row_t *row);
+rdb_row_t* rdb_table_restore_row(rdb_table_t *table, size_t row_id);
+size_t rdb_table_live_row_count(const rdb_table_t *table);
+bool rdb_table_needs_compaction(const rdb_table_t *table);
+size_t rdb_table_compact(rdb_table_t *table);
+void rdb_schedule_compaction(rdb_database_t *db, rdb_table_t *table);
+int rdb_vacuum(rdb_database_t *db, const char *table_name);
+int rdb_start_compaction(rdb_database_t *db, unsigned interval_ms);
+int rdb_stop_compaction(rdb_database_t *db);
+
+/* Parallel scans */
+rdb_worker_pool_t* rdb_worker_pool_create(size_t parallelism);
+void rdb_worker_pool_destroy(rdb_worker_pool_t *pool);
+int rdb_set_scan_parallelism(rdb_database_t *db, size_t parallelism);
+size_t rdb_get_scan_parallelism(const rdb_database_t *db);
+size_t rdb_parallel_workers(rdb_worker_pool_t *pool, size_t row_count);
+int rdb_parallel_for(rdb_worker_pool_t *pool, size_t row_count, size_t workers,
+                     rdb_morsel_func_t func, void *context);
+fi_array* rdb_find_matching_rows(rdb_table_t *table, fi_array *where_conditions);
+fi_array* rdb_find_matching_rows_limit(rdb_table_t *table, fi_array *where_conditions, size_t limit);
+bool rdb_row_matches_conditions(rdb_table_t *table, const rdb_row_t *row, fi_array *where_conditions);
+fi_array* rdb_batch_filter_rows(rdb_table_t *table, fi_array *rows, fi_array *where_conditions);
+fi_array* rdb_batch_filter_rows_limit(rdb_table_t *table, fi_array *rows, fi_array *where_conditions,
+                                      size_t limit);
+int rdb_condition_compare(const rdb_value_t *a, const rdb_value_t *b, bool *comparable);
+bool rdb_like_match(const char *text, const char *pattern);
+
+/* Expressions */
+rdb_expr_t* rdb_expr_create_literal(rdb_value_t *value);
+rdb_expr_t* rdb_expr_create_column(const char *column_name);
+rdb_expr_t* rdb_expr_create_unary(rdb_expr_op_t op, rdb_expr_t *operand);
+rdb_expr_t* rdb_expr_create_binary(rdb_expr_op_t op, rdb_expr_t *left, rdb_expr_t *right);
+rdb_expr_t* rdb_expr_create_function(const char *name, fi_array *args);
+void rdb_expr_free(rdb_expr_t *expr);
+rdb_expr_t* rdb_expr_copy(const rdb_expr_t *expr);
+rdb_program_t* rdb_expr_compile(rdb_table_t *table, const rdb_expr_t *expr);
+void rdb_program_free(rdb_program_t *program);
+int rdb_program_eval(const rdb_program_t *program, const rdb_row_t *row, rdb_value_t **result);
+bool rdb_program_matches(const rdb_program_t *program, const rdb_row_t *row);
+int rdb_update_rows_computed(rdb_database_t *db, const char *table_name, fi_array *set_columns,
+                             fi_array *set_values, fi_array *set_expressions, fi_array *where_conditions);
+int rdb_update_rows_computed_thread_safe(rdb_database_t *db, const char *table_name, fi_array *set_columns,
+                                         fi_array *set_values, fi_array *set_expressions,
+                                         fi_array *where_conditions);
+
+/* Aggregation */
+fi_array* rdb_select_aggregate(rdb_database_t *db, const char *table_name, fi_array *aggregates,
+                               fi_array *group_by, fi_array *where_conditions);
+fi_array* rdb_select_aggregate_thread_safe(rdb_database_t *db, const char *table_name,
+                                           fi_array *aggregates, fi_array *group_by,
+                                           fi_array *where_conditions);
+void rdb_aggregate_result_free(fi_array *result);
+fi_array* rdb_table_rows_in_index_order(rdb_table_t *table, const int *column_indexes,
+                                        size_t column_count, fi_array *where_conditions);
+fi_array* rdb_aggregate_order(fi_array *result, fi_array *select_columns, fi_array *order_by,
+                              size_t limit, size_t offset);
+
+/* ORDER BY and LIMIT/OFFSET */
+fi_array* rdb_select_rows_ordered(rdb_database_t *db, const char *table_name, fi_array *columns,
+                                  fi_array *where_conditions, fi_array *order_by,
+                                  size_t limit, size_t offset);
+fi_array* rdb_select_rows_ordered_thread_safe(rdb_database_t *db, const char *table_name,
+                                              fi_array *columns, fi_array *where_conditions,
+                                              fi_array *order_by, size_t limit, size_t offset);
+fi_array* rdb_rows_top_k(fi_array *rows, const rdb_sort_key_t *keys, size_t key_count,
+                         size_t limit, size_t offset);
+int rdb_sort_value_compare(const rdb_value_t *a, const rdb_value_t *b);
+fi_array* rdb_table_rows_in_key_order(rdb_table_t *table, const rdb_sort_key_t *keys,
+                                      size_t key_count, fi_array *where_conditions, size_t limit);
+
+/* Prepared statements */
+#define RDB_STATEMENT_CACHE_SIZE 64  /* Statements a database keeps for reuse */
+#define RDB_STEP_DONE 0              /* rdb_step(): the statement has finished */
+#define RDB_STEP_ROW 1               /* rdb_step(): a result row is available */
+
+rdb_statement_cache_t* rdb_statement_cache_create(void);
+void rdb_statement_cache_destroy(rdb_statement_cache_t *cache);
+rdb_prepared_t* rdb_prepare(rdb_database_t *db, const char *sql);
+void rdb_finalize(rdb_prepared_t *prepared);
+const rdb_statement_t* rdb_prepared_statement(const rdb_prepared_t *prepared);
+size_t rdb_parameter_count(const rdb_prepared_t *prepared);
+int rdb_bind_null(rdb_prepared_t *prepared, size_t index);
+int rdb_bind_int(rdb_prepared_t *prepared, size_t index, int64_t value);
+int rdb_bind_float(rdb_prepared_t *prepared, size_t index, double value);
+int rdb_bind_string(rdb_prepared_t *prepared, size_t index, const char *value);
+int rdb_bind_bool(rdb_prepared_t *prepared, size_t index, bool value);
+int rdb_bind_value(rdb_prepared_t *prepared, size_t index, const rdb_value_t *value);
+int rdb_clear_bindings(rdb_prepared_t *prepared);
+int rdb_step(rdb_prepared_t *prepared);
+int rdb_reset(rdb_prepared_t *prepared);
+size_t rdb_column_count(const rdb_prepared_t *prepared);
+const rdb_value_t* rdb_column_value(const rdb_prepared_t *prepared, size_t column);
+size_t rdb_changes(const rdb_prepared_t *prepared);
+int rdb_statement_cache_stats(rdb_database_t *db, size_t *hits, size_t *misses);
+
+/* Columnar storage */
+int rdb_set_table_storage(rdb_database_t *db, const char *table_name, rdb_storage_mode_t mode);
+rdb_column_store_t* rdb_column_store_create(rdb_table_t *table);
+void rdb_column_store_destroy(rdb_column_store_t *store);
+int rdb_column_store_rebuild(rdb_table_t *table);
+int rdb_column_store_append_row(rdb_table_t *table, rdb_row_t *row);
+int rdb_column_store_remove_row(rdb_table_t *table, const rdb_row_t *row);
+size_t rdb_column_store_scan(rdb_table_t *table, rdb_row_group_visit_t visit, void *user_data);
+bool rdb_column_vector_readable(const rdb_row_group_t *group, int column);
+fi_array* rdb_column_store_filter_rows(rdb_table_t *table, fi_array *where_conditions, size_t limit);
+int rdb_column_summarize(rdb_table_t *table, const char *column_name, rdb_column_summary_t *summary);
+const char* rdb_column_vector_string(const rdb_column_vector_t *vector, size_t slot, size_t *length);
+
+/* Column dictionaries */
+rdb_string_dict_t* rdb_string_dict_create(void);
+void rdb_string_dict_destroy(rdb_string_dict_t *dict);
+rdb_string_t* rdb_string_dict_add(rdb_string_dict_t *dict, const char *text, size_t length);
+const rdb_string_t* rdb_string_dict_find(const rdb_string_dict_t *dict, const char *text);
+const rdb_string_t* rdb_string_dict_entry(const rdb_string_dict_t *dict, uint32_t code);
+size_t rdb_string_dict_count(const rdb_string_dict_t *dict);
+int rdb_string_dict_intern(rdb_string_dict_t *dict, rdb_value_t *value);
+int rdb_set_column_dictionary(rdb_database_t *db, const char *table_name, const char *column_name,
+                              bool enabled);
+rdb_string_dict_t* rdb_table_column_dictionary(const rdb_table_t *table, size_t column);
+int rdb_table_init_dictionaries(rdb_table_t *table);
+void rdb_table_destroy_dictionaries(rdb_table_t *table);
+void rdb_table_intern_row(rdb_table_t *table, rdb_row_t *row);
+void rdb_bind_dictionary_conditions(rdb_table_t *table, fi_array *where_conditions);
+
+/* Packed row records */
+rdb_record_layout_t* rdb_record_layout_create(const rdb_table_t *table);
+void rdb_record_layout_destroy(rdb_record_layout_t *layout);
+const rdb_record_layout_t* rdb_table_record_layout(rdb_table_t *table);
+void rdb_table_invalidate_record_layout(rdb_table_t *table);
+rdb_record_t* rdb_record_pack(const rdb_record_layout_t *layout, const rdb_row_t *row);
+rdb_row_t* rdb_record_unpack(const rdb_record_layout_t *layout, const rdb_record_t *record);
+rdb_record_t* rdb_record_copy(const rdb_record_t *record);
+bool rdb_record_is_null(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column);
+int64_t rdb_record_get_int(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column);
+double rdb_record_get_float(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column);
+bool rdb_record_get_bool(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column);
+const char* rdb_record_get_string(const rdb_record_layout_t *layout, const rdb_record_t *record,
+                                  size_t column, size_t *length);
 
 /* Column operations */
 int rdb_add_column(rdb_database_t *db, const char *table_name, const rdb_column_t *column);
@@ -288,6 +854,7 @@ void rdb_join_condition_free(void *join_condition);
 
 /* Comparison functions */
 int rdb_value_compare(const void *a, const void *b);
+bool rdb_value_equals(const rdb_value_t *a, const rdb_value_t *b);
 int rdb_string_compare(const void *a, const void *b);
 
 /* Hash functions */
@@ -297,6 +864,11 @@ uint32_t rdb_string_hash(const void *key, size_t key_size);
 rdb_value_t* rdb_create_int_value(int64_t value);
 rdb_value_t* rdb_create_float_value(double value);
 rdb_value_t* rdb_create_string_value(const char *value);
+rdb_value_t* rdb_create_string_value_n(const char *value, size_t length);
+rdb_value_t* rdb_create_shared_string_value(rdb_string_t *str);
+rdb_string_t* rdb_string_create(const char *value, size_t length);
+rdb_string_t* rdb_string_retain(rdb_string_t *str);
+void rdb_string_release(rdb_string_t *str);
 rdb_value_t* rdb_create_bool_value(bool value);
 rdb_value_t* rdb_create_null_value(rdb_data_type_t type);
 rdb_value_t* rdb_value_copy(const rdb_value_t *original);
@@ -305,6 +877,7 @@ rdb_value_t* rdb_value_copy(const rdb_value_t *original);
 int64_t rdb_get_int_value(const rdb_value_t *value);
 double rdb_get_float_value(const rdb_value_t *value);
 const char* rdb_get_string_value(const rdb_value_t *value);
+size_t rdb_get_string_length(const rdb_value_t *value);
 bool rdb_get_bool_value(const rdb_value_t *value);
 
 /* String representation */
@@ -336,7 +909,7 @@ int rdb_set_isolation_level(rdb_database_t *db, rdb_isolation_level_t level);
 
 /* Transaction logging functions */
 int rdb_log_operation(rdb_database_t *db, rdb_operation_type_t op_type, const char *table_name, 
-                     size_t row_id, rdb_row_t *old_row, rdb_row_t *new_row);
+                     size_t row_id, rdb_record_t *old_record);
 int rdb_rollback_operations(rdb_database_t *db, rdb_transaction_t *transaction);
 
 /* Transaction-aware database operations */
@@ -350,7 +923,7 @@ int rdb_drop_table_transactional(rdb_database_t *db, const char *table_name);
 /* Transaction log entry management */
 rdb_transaction_log_entry_t* rdb_create_transaction_log_entry(rdb_operation_type_t op_type, 
                                                              const char *table_name, size_t row_id,
-                                                             rdb_row_t *old_row, rdb_row_t *new_row);
+                                                             rdb_record_t *old_record);
 void rdb_destroy_transaction_log_entry(rdb_transaction_log_entry_t *entry);
 void rdb_transaction_log_entry_free(void *entry);
 
@@ -0,0 +1,830 @@
+#include "rdb.h"
+#include <stdint.h>
+#include <strings.h>  /* for strcasecmp */
+
+/* Aggregation
+ *
+ * SELECT lists with COUNT/SUM/AVG/MIN/MAX, optionally under GROUP BY, are
+ * answered in one pass over the rows that satisfy WHERE. Each group keeps a
+ * small running state per aggregate and borrows its key values and its
+ * MIN/MAX candidates from the table, so no row is copied.
+ *
+ * Groups are found through a hash table keyed by the GROUP BY values. When
+ * there is no WHERE clause and a B-tree index is led by the GROUP BY
+ * columns, the rows are read in index order instead: each group is then a
+ * run of consecutive rows and is closed as soon as the key changes, with no
+ * hash table at all. This relies on index order being value order: an
+ * index holding a value of another type than its column (keyed as NULL)
+ * is not used, and the hash table groups the rows instead.
+ *
+ * NULL keys form a group of their own. Aggregates skip NULL inputs, so over
+ * no input COUNT gives 0 and the others give NULL. Without GROUP BY there
+ * is always exactly one result row. SUM of INT values stays INT until it
+ * would overflow and then continues in FLOAT; AVG is always FLOAT.
+ *
+ * On the hash path, inputs large enough for the table's scan workers are
+ * split into morsels. Each worker aggregates into groups of its own, and
+ * the partial groups are merged afterwards and put back in order of first
+ * appearance, so the result matches a single-threaded run (FLOAT sums may
+ * differ in the last bits, as they are added in another order).
+ *
+ * Without WHERE and GROUP BY, a columnar table is aggregated row group by
+ * row group straight from its column vectors (see rdb_columnar.c). */
+
+/* Running state of one aggregate in one group */
+typedef struct {
+    size_t count;               /* Inputs seen (non-NULL ones unless COUNT(*)) */
+    int64_t int_sum;            /* Exact sum while float_mode is false */
+    double float_sum;           /* Sum once a FLOAT input or an overflow was seen */
+    bool float_mode;            /* Whether float_sum is the sum */
+    const rdb_value_t *extreme; /* MIN/MAX so far, borrowed from the table */
+} rdb_agg_state_t;
+
+/* One group: its key values and the state of every select item */
+typedef struct {
+    uint32_t hash;              /* Hash of keys */
+    size_t first_row;           /* Position of the group's first input row */
+    size_t key_count;           /* Number of GROUP BY columns */
+    const rdb_value_t **keys;   /* GROUP BY values, borrowed from the table */
+    rdb_agg_state_t *states;    /* One per select item */
+} rdb_agg_group_t;
+
+/* A resolved aggregating query */
+typedef struct {
+    rdb_table_t *table;
+    fi_array *aggregates;       /* rdb_aggregate_t per select item */
+    size_t item_count;
+    int *item_columns;          /* Column per item, -1 for COUNT(*) */
+    size_t key_count;
+    int *key_columns;           /* Column per GROUP BY entry */
+    fi_array *groups;           /* rdb_agg_group_t* in output order */
+    fi_map *lookup;             /* rdb_agg_group_t* -> rdb_agg_group_t*, NULL when streaming */
+} rdb_aggregation_t;
+
+static const rdb_value_t* rdb_agg_row_value(const rdb_row_t *row, int column) {
+    if (column < 0 || (size_t)column >= fi_array_count(row->values)) return NULL;
+    return *(rdb_value_t**)fi_array_get(row->values, column);
+}
+
+static uint32_t rdb_agg_value_hash(const rdb_value_t *value) {
+    if (!value || value->is_null) return 0x9e3779b9u;
+
+    switch (value->type) {
+        case RDB_TYPE_INT:
+        case RDB_TYPE_FLOAT: {
+            /* INT and FLOAT keys that compare equal must hash alike */
+            double d = value->type == RDB_TYPE_INT ? (double)value->data.int_val : value->data.float_val;
+            d += 0.0; /* -0.0 becomes 0.0 */
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            return (uint32_t)(bits ^ (bits >> 32)) * 0x85ebca6bu;
+        }
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT:
+            return fi_map_hash_bytes(rdb_get_string_value(value), rdb_get_string_length(value));
+        case RDB_TYPE_BOOLEAN:
+            return value->data.bool_val ? 0x27d4eb2fu : 0x165667b1u;
+    }
+    return 0;
+}
+
+/* Key equality for grouping: NULL matches only NULL */
+static bool rdb_agg_value_equal(const rdb_value_t *a, const rdb_value_t *b) {
+    bool a_null = !a || a->is_null;
+    bool b_null = !b || b->is_null;
+    if (a_null || b_null) return a_null && b_null;
+
+    bool comparable;
+    return rdb_condition_compare(a, b, &comparable) == 0 && comparable;
+}
+
+static bool rdb_agg_keys_equal(const rdb_agg_group_t *a, const rdb_agg_group_t *b) {
+    for (size_t i = 0; i < a->key_count; i++) {
+        if (!rdb_agg_value_equal(a->keys[i], b->keys[i])) return false;
+    }
+    return true;
+}
+
+static uint32_t rdb_agg_group_hash(const void *key, size_t key_size) {
+    (void)key_size;
+    return (*(rdb_agg_group_t* const*)key)->hash;
+}
+
+static int rdb_agg_group_compare(const void *a, const void *b) {
+    const rdb_agg_group_t *ga = *(rdb_agg_group_t* const*)a;
+    const rdb_agg_group_t *gb = *(rdb_agg_group_t* const*)b;
+    if (ga->hash != gb->hash) return ga->hash < gb->hash ? -1 : 1;
+    return rdb_agg_keys_equal(ga, gb) ? 0 : 1;
+}
+
+static void rdb_agg_group_free(rdb_agg_group_t *group) {
+    if (!group) return;
+    free(group->keys);
+    free(group->states);
+    free(group);
+}
+
+/* A new group with the keys of `probe`, first seen at input row `position` */
+static rdb_agg_group_t* rdb_agg_group_create(rdb_aggregation_t *agg, const rdb_agg_group_t *probe,
+                                             size_t position) {
+    rdb_agg_group_t *group = calloc(1, sizeof(rdb_agg_group_t));
+    if (!group) return NULL;
+
+    group->hash = probe->hash;
+    group->first_row = position;
+    group->key_count = probe->key_count;
+    group->keys = calloc(probe->key_count ? probe->key_count : 1, sizeof(rdb_value_t*));
+    group->states = calloc(agg->item_count ? agg->item_count : 1, sizeof(rdb_agg_state_t));
+    if (!group->keys || !group->states) {
+        rdb_agg_group_free(group);
+        return NULL;
+    }
+    for (size_t i = 0; i < probe->key_count; i++) group->keys[i] = probe->keys[i];
+
+    if (fi_array_push(agg->groups, &group) != 0) {
+        rdb_agg_group_free(group);
+        return NULL;
+    }
+    return group;
+}
+
+/* The group `row`, input row `position`, belongs to, created on first sight */
+static rdb_agg_group_t* rdb_agg_find_group(rdb_aggregation_t *agg, const rdb_row_t *row,
+                                           rdb_agg_group_t *probe, size_t position) {
+    probe->hash = 0;
+    for (size_t i = 0; i < agg->key_count; i++) {
+        probe->keys[i] = rdb_agg_row_value(row, agg->key_columns[i]);
+        probe->hash = probe->hash * 31 + rdb_agg_value_hash(probe->keys[i]);
+    }
+
+    size_t count = fi_array_count(agg->groups);
+    if (!agg->lookup) {
+        /* Streaming: only the group of the previous row can match */
+        if (count > 0) {
+            rdb_agg_group_t *last = *(rdb_agg_group_t**)fi_array_get(agg->groups, count - 1);
+            if (rdb_agg_keys_equal(last, probe)) return last;
+        }
+        return rdb_agg_group_create(agg, probe, position);
+    }
+
+    rdb_agg_group_t *group = NULL;
+    if (fi_map_get(agg->lookup, &probe, &group) == 0) return group;
+
+    group = rdb_agg_group_create(agg, probe, position);
+    if (group && fi_map_put(agg->lookup, &group, &group) != 0) return NULL;
+    return group;
+}
+
+static void rdb_agg_add_int(rdb_agg_state_t *state, int64_t v) {
+    if (state->float_mode) {
+        state->float_sum += (double)v;
+    } else if ((v > 0 && state->int_sum > INT64_MAX - v) || (v < 0 && state->int_sum < INT64_MIN - v)) {
+        state->float_mode = true;
+        state->float_sum = (double)state->int_sum + (double)v;
+    } else {
+        state->int_sum += v;
+    }
+}
+
+static void rdb_agg_add_float(rdb_agg_state_t *state, double v) {
+    if (!state->float_mode) {
+        state->float_mode = true;
+        state->float_sum = (double)state->int_sum;
+    }
+    state->float_sum += v;
+}
+
+static void rdb_agg_add_sum(rdb_agg_state_t *state, const rdb_value_t *value) {
+    if (value->type == RDB_TYPE_INT) {
+        rdb_agg_add_int(state, value->data.int_val);
+    } else {
+        rdb_agg_add_float(state, value->data.float_val);
+    }
+}
+
+/* Add one input value of a column aggregate */
+static void rdb_agg_accumulate_value(const rdb_aggregate_t *item, rdb_agg_state_t *state,
+                                     const rdb_value_t *value) {
+    if (!value || value->is_null) return;
+
+    switch (item->func) {
+        case RDB_AGG_COUNT:
+            state->count++;
+            break;
+        case RDB_AGG_SUM:
+        case RDB_AGG_AVG:
+            if (value->type != RDB_TYPE_INT && value->type != RDB_TYPE_FLOAT) break;
+            state->count++;
+            rdb_agg_add_sum(state, value);
+            break;
+        case RDB_AGG_MIN:
+        case RDB_AGG_MAX: {
+            bool comparable = true;
+            int cmp = state->extreme ? rdb_condition_compare(value, state->extreme, &comparable) : 0;
+            if (!comparable) break;
+            if (!state->extreme || (item->func == RDB_AGG_MIN ? cmp < 0 : cmp > 0)) {
+                state->extreme = value;
+            }
+            state->count++;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void rdb_agg_accumulate(rdb_aggregation_t *agg, rdb_agg_group_t *group, const rdb_row_t *row) {
+    for (size_t i = 0; i < agg->item_count; i++) {
+        const rdb_aggregate_t *item = (const rdb_aggregate_t*)fi_array_get(agg->aggregates, i);
+        rdb_agg_state_t *state = &group->states[i];
+
+        if (item->func == RDB_AGG_NONE) continue;
+        if (item->func == RDB_AGG_COUNT_STAR) {
+            state->count++;
+            continue;
+        }
+        rdb_agg_accumulate_value(item, state, rdb_agg_row_value(row, agg->item_columns[i]));
+    }
+}
+
+/* Slot of a row group holds a live, non-NULL value in `vector` */
+#define RDB_AGG_SLOT_HAS_VALUE(group, vector, slot) \
+    (!RDB_BITMAP_TEST((group)->deleted, slot) && !RDB_BITMAP_TEST((vector)->nulls, slot))
+
+/* MIN/MAX over a numeric column vector, comparing the way
+ * rdb_condition_compare() does. Only a new extreme is looked up in its row. */
+static void rdb_agg_extreme_vector(const rdb_aggregate_t *item, rdb_agg_state_t *state,
+                                   const rdb_row_group_t *group, int column) {
+    const rdb_column_vector_t *vector = &group->columns[column];
+    bool ints = vector->type == RDB_TYPE_INT;
+
+    for (size_t slot = 0; slot < group->row_count; slot++) {
+        if (!RDB_AGG_SLOT_HAS_VALUE(group, vector, slot)) continue;
+
+        const rdb_value_t *extreme = state->extreme;
+        if (extreme) {
+            int cmp;
+            if (ints && extreme->type == RDB_TYPE_INT) {
+                int64_t v = vector->ints[slot];
+                cmp = (v > extreme->data.int_val) - (v < extreme->data.int_val);
+            } else if (extreme->type == RDB_TYPE_INT || extreme->type == RDB_TYPE_FLOAT) {
+                double v = ints ? (double)vector->ints[slot] : vector->floats[slot];
+                double e = extreme->type == RDB_TYPE_INT ? (double)extreme->data.int_val
+                                                         : extreme->data.float_val;
+                cmp = (v > e) - (v < e);
+            } else {
+                continue;  /* Not comparable */
+            }
+            state->count++;
+            if (item->func == RDB_AGG_MIN ? cmp >= 0 : cmp <= 0) continue;
+        } else {
+            state->count++;
+        }
+        state->extreme = rdb_agg_row_value(group->rows[slot], column);
+    }
+}
+
+/* Add the live rows of a columnar row group to `into`, the single group of
+ * an aggregation without GROUP BY. Readable numeric vectors are summed and
+ * searched in place; other columns are read from the rows. The result is
+ * the one rdb_agg_accumulate() gives over the same rows in slot order. */
+static void rdb_agg_accumulate_row_group(rdb_aggregation_t *agg, rdb_agg_group_t *into,
+                                         const rdb_row_group_t *group) {
+    for (size_t i = 0; i < agg->item_count; i++) {
+        const rdb_aggregate_t *item = (const rdb_aggregate_t*)fi_array_get(agg->aggregates, i);
+        rdb_agg_state_t *state = &into->states[i];
+        int column = agg->item_columns[i];
+
+        if (item->func == RDB_AGG_NONE) continue;
+        if (item->func == RDB_AGG_COUNT_STAR) {
+            state->count += group->live_count;
+            continue;
+        }
+
+        const rdb_column_vector_t *vector = rdb_column_vector_readable(group, column) ?
+                                            &group->columns[column] : NULL;
+        bool numeric = vector && (vector->type == RDB_TYPE_INT || vector->type == RDB_TYPE_FLOAT);
+
+        if (vector && item->func == RDB_AGG_COUNT) {
+            for (size_t slot = 0; slot < group->row_count; slot++) {
+                state->count += RDB_AGG_SLOT_HAS_VALUE(group, vector, slot);
+            }
+        } else if (numeric && (item->func == RDB_AGG_SUM || item->func == RDB_AGG_AVG)) {
+            for (size_t slot = 0; slot < group->row_count; slot++) {
+                if (!RDB_AGG_SLOT_HAS_VALUE(group, vector, slot)) continue;
+                state->count++;
+                if (vector->type == RDB_TYPE_INT) {
+                    rdb_agg_add_int(state, vector->ints[slot]);
+                } else {
+                    rdb_agg_add_float(state, vector->floats[slot]);
+                }
+            }
+        } else if (numeric && (item->func == RDB_AGG_MIN || item->func == RDB_AGG_MAX)) {
+            rdb_agg_extreme_vector(item, state, group, column);
+        } else {
+            for (size_t slot = 0; slot < group->row_count; slot++) {
+                if (RDB_BITMAP_TEST(group->deleted, slot)) continue;
+                rdb_agg_accumulate_value(item, state, rdb_agg_row_value(group->rows[slot], column));
+            }
+        }
+    }
+}
+
+/* Fold the state `from` of a partial group into `into` */
+static void rdb_agg_merge_state(const rdb_aggregate_t *item, rdb_agg_state_t *into,
+                                const rdb_agg_state_t *from) {
+    switch (item->func) {
+        case RDB_AGG_COUNT_STAR:
+        case RDB_AGG_COUNT:
+            into->count += from->count;
+            break;
+        case RDB_AGG_SUM:
+        case RDB_AGG_AVG:
+            if (from->count == 0) break;
+            into->count += from->count;
+            if (from->float_mode) {
+                rdb_agg_add_float(into, from->float_sum);
+            } else {
+                rdb_agg_add_int(into, from->int_sum);
+            }
+            break;
+        case RDB_AGG_MIN:
+        case RDB_AGG_MAX: {
+            if (!from->extreme) break;
+            bool comparable = true;
+            int cmp = into->extreme ? rdb_condition_compare(from->extreme, into->extreme, &comparable) : 0;
+            if (!comparable) break;
+            if (!into->extreme || (item->func == RDB_AGG_MIN ? cmp < 0 : cmp > 0)) {
+                into->extreme = from->extreme;
+            }
+            into->count += from->count;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static rdb_data_type_t rdb_agg_column_type(rdb_table_t *table, int column) {
+    rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, column);
+    return col->type;
+}
+
+/* The output value of item `i` for `group` */
+static rdb_value_t* rdb_agg_finish(rdb_aggregation_t *agg, const rdb_agg_group_t *group, size_t i) {
+    const rdb_aggregate_t *item = (const rdb_aggregate_t*)fi_array_get(agg->aggregates, i);
+    const rdb_agg_state_t *state = &group->states[i];
+    int column = agg->item_columns[i];
+
+    switch (item->func) {
+        case RDB_AGG_NONE:
+            for (size_t k = 0; k < agg->key_count; k++) {
+                if (agg->key_columns[k] != column) continue;
+                if (group->keys[k]) return rdb_value_copy(group->keys[k]);
+                break;
+            }
+            return rdb_create_null_value(rdb_agg_column_type(agg->table, column));
+        case RDB_AGG_COUNT_STAR:
+        case RDB_AGG_COUNT:
+            return rdb_create_int_value((int64_t)state->count);
+        case RDB_AGG_SUM:
+            if (state->count == 0) return rdb_create_null_value(rdb_agg_column_type(agg->table, column));
+            return state->float_mode ? rdb_create_float_value(state->float_sum)
+                                     : rdb_create_int_value(state->int_sum);
+        case RDB_AGG_AVG: {
+            if (state->count == 0) return rdb_create_null_value(RDB_TYPE_FLOAT);
+            double sum = state->float_mode ? state->float_sum : (double)state->int_sum;
+            return rdb_create_float_value(sum / (double)state->count);
+        }
+        case RDB_AGG_MIN:
+        case RDB_AGG_MAX:
+            if (!state->extreme) return rdb_create_null_value(rdb_agg_column_type(agg->table, column));
+            return rdb_value_copy(state->extreme);
+    }
+    return NULL;
+}
+
+/* Resolve names to columns and check that the select list is groupable */
+static int rdb_agg_prepare(rdb_aggregation_t *agg, rdb_table_t *table, fi_array *aggregates,
+                           fi_array *group_by) {
+    agg->table = table;
+    agg->aggregates = aggregates;
+    agg->item_count = fi_array_count(aggregates);
+    agg->key_count = group_by ? fi_array_count(group_by) : 0;
+    agg->item_columns = calloc(agg->item_count ? agg->item_count : 1, sizeof(int));
+    agg->key_columns = calloc(agg->key_count ? agg->key_count : 1, sizeof(int));
+    if (!agg->item_columns || !agg->key_columns) return -1;
+
+    for (size_t k = 0; k < agg->key_count; k++) {
+        const char *name = *(char**)fi_array_get(group_by, k);
+        agg->key_columns[k] = rdb_get_column_index(table, name);
+        if (agg->key_columns[k] < 0) {
+            printf("Error: Column '%s' does not exist in table '%s'\n", name, table->name);
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < agg->item_count; i++) {
+        const rdb_aggregate_t *item = (const rdb_aggregate_t*)fi_array_get(aggregates, i);
+        if (item->func == RDB_AGG_COUNT_STAR) {
+            agg->item_columns[i] = -1;
+            continue;
+        }
+
+        int column = rdb_get_column_index(table, item->column);
+        if (column < 0) {
+            printf("Error: Column '%s' does not exist in table '%s'\n", item->column, table->name);
+            return -1;
+        }
+        agg->item_columns[i] = column;
+
+        if (item->func == RDB_AGG_NONE) {
+            bool grouped = false;
+            for (size_t k = 0; k < agg->key_count && !grouped; k++) {
+                grouped = agg->key_columns[k] == column;
+            }
+            if (!grouped) {
+                printf("Error: Column '%s' must appear in GROUP BY or be used in an aggregate\n",
+                       item->column);
+                return -1;
+            }
+        } else if (item->func == RDB_AGG_SUM || item->func == RDB_AGG_AVG) {
+            rdb_data_type_t type = rdb_agg_column_type(table, column);
+            if (type != RDB_TYPE_INT && type != RDB_TYPE_FLOAT) {
+                printf("Error: %s needs a numeric column, '%s' is not\n",
+                       item->func == RDB_AGG_SUM ? "SUM" : "AVG", item->column);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void rdb_agg_free_groups(rdb_aggregation_t *agg) {
+    if (agg->groups) {
+        for (size_t i = 0; i < fi_array_count(agg->groups); i++) {
+            rdb_agg_group_free(*(rdb_agg_group_t**)fi_array_get(agg->groups, i));
+        }
+        fi_array_destroy(agg->groups);
+    }
+    if (agg->lookup) fi_map_destroy(agg->lookup);
+    agg->groups = NULL;
+    agg->lookup = NULL;
+}
+
+static void rdb_agg_cleanup(rdb_aggregation_t *agg) {
+    rdb_agg_free_groups(agg);
+    free(agg->item_columns);
+    free(agg->key_columns);
+}
+
+/* Groups of one scan worker. The query fields are shared with the main
+ * aggregation; groups, lookup and probe belong to the worker. */
+typedef struct {
+    rdb_aggregation_t agg;
+    rdb_agg_group_t probe;
+} rdb_agg_partial_t;
+
+typedef struct {
+    fi_array *rows;
+    rdb_agg_partial_t *partials; /* One per worker */
+    atomic_bool failed;
+} rdb_agg_scan_t;
+
+static void rdb_agg_morsel(void *context, size_t worker, size_t morsel, size_t begin, size_t end) {
+    rdb_agg_scan_t *scan = (rdb_agg_scan_t*)context;
+    rdb_agg_partial_t *partial = &scan->partials[worker];
+    (void)morsel;
+
+    for (size_t r = begin; r < end; r++) {
+        const rdb_row_t *row = *(rdb_row_t**)fi_array_get(scan->rows, r);
+        rdb_agg_group_t *group = rdb_agg_find_group(&partial->agg, row, &partial->probe, r);
+        if (!group) {
+            atomic_store(&scan->failed, true);
+            return;
+        }
+        rdb_agg_accumulate(&partial->agg, group, row);
+    }
+}
+
+/* Move the groups of `partial` into `agg`, folding them into the groups
+ * `agg` already has for the same keys */
+static int rdb_agg_merge(rdb_aggregation_t *agg, rdb_aggregation_t *partial) {
+    for (size_t g = 0; g < fi_array_count(partial->groups); g++) {
+        rdb_agg_group_t **slot = (rdb_agg_group_t**)fi_array_get(partial->groups, g);
+        rdb_agg_group_t *from = *slot;
+        rdb_agg_group_t *into = NULL;
+
+        if (agg->key_count == 0) {
+            into = *(rdb_agg_group_t**)fi_array_get(agg->groups, 0);
+        } else if (fi_map_get(agg->lookup, &from, &into) != 0) {
+            if (fi_array_push(agg->groups, &from) != 0) return -1;
+            *slot = NULL;
+            if (fi_map_put(agg->lookup, &from, &from) != 0) return -1;
+            continue;
+        }
+
+        /* The output keeps the key values of the first row of the group */
+        if (from->first_row < into->first_row) {
+            into->first_row = from->first_row;
+            for (size_t k = 0; k < from->key_count; k++) into->keys[k] = from->keys[k];
+        }
+        for (size_t i = 0; i < agg->item_count; i++) {
+            const rdb_aggregate_t *item = (const rdb_aggregate_t*)fi_array_get(agg->aggregates, i);
+            rdb_agg_merge_state(item, &into->states[i], &from->states[i]);
+        }
+    }
+    return 0;
+}
+
+static int rdb_agg_group_order(const void *a, const void *b) {
+    const rdb_agg_group_t *ga = *(rdb_agg_group_t* const*)a;
+    const rdb_agg_group_t *gb = *(rdb_agg_group_t* const*)b;
+    return (ga->first_row > gb->first_row) - (ga->first_row < gb->first_row);
+}
+
+/* Aggregate `rows` into the groups of `agg` with `workers` threads */
+static int rdb_agg_accumulate_parallel(rdb_aggregation_t *agg, fi_array *rows, size_t workers) {
+    rdb_agg_scan_t scan;
+    scan.rows = rows;
+    scan.partials = calloc(workers, sizeof(rdb_agg_partial_t));
+    atomic_init(&scan.failed, scan.partials == NULL);
+
+    for (size_t w = 0; !atomic_load(&scan.failed) && w < workers; w++) {
+        rdb_agg_partial_t *partial = &scan.partials[w];
+        partial->agg = *agg;
+        partial->agg.groups = fi_array_create(16, sizeof(rdb_agg_group_t*));
+        partial->agg.lookup = NULL;
+        if (agg->key_count > 0) {
+            partial->agg.lookup = fi_map_create(64, sizeof(rdb_agg_group_t*), sizeof(rdb_agg_group_t*),
+                                                rdb_agg_group_hash, rdb_agg_group_compare);
+        }
+        partial->probe.key_count = agg->key_count;
+        partial->probe.keys = calloc(agg->key_count ? agg->key_count : 1, sizeof(rdb_value_t*));
+
+        bool ready = partial->agg.groups && partial->probe.keys && (agg->key_count == 0 || partial->agg.lookup);
+        if (ready && agg->key_count == 0) ready = rdb_agg_group_create(&partial->agg, &partial->probe, 0) != NULL;
+        if (!ready) atomic_store(&scan.failed, true);
+    }
+
+    if (!atomic_load(&scan.failed)) {
+        rdb_parallel_for(agg->table->workers, fi_array_count(rows), workers, rdb_agg_morsel, &scan);
+    }
+    for (size_t w = 0; !atomic_load(&scan.failed) && w < workers; w++) {
+        if (rdb_agg_merge(agg, &scan.partials[w].agg) != 0) atomic_store(&scan.failed, true);
+    }
+
+    for (size_t w = 0; scan.partials && w < workers; w++) {
+        rdb_agg_partial_t *partial = &scan.partials[w];
+        for (size_t g = 0; partial->agg.groups && g < fi_array_count(partial->agg.groups); g++) {
+            rdb_agg_group_free(*(rdb_agg_group_t**)fi_array_get(partial->agg.groups, g));
+        }
+        if (partial->agg.groups) fi_array_destroy(partial->agg.groups);
+        if (partial->agg.lookup) fi_map_destroy(partial->agg.lookup);
+        free(partial->probe.keys);
+    }
+    free(scan.partials);
+    if (atomic_load(&scan.failed)) return -1;
+
+    /* Back to order of first appearance */
+    size_t count = fi_array_count(agg->groups);
+    rdb_agg_group_t **groups = malloc((count ? count : 1) * sizeof(rdb_agg_group_t*));
+    if (!groups) return -1;
+    for (size_t g = 0; g < count; g++) groups[g] = *(rdb_agg_group_t**)fi_array_get(agg->groups, g);
+    qsort(groups, count, sizeof(rdb_agg_group_t*), rdb_agg_group_order);
+    for (size_t g = 0; g < count; g++) *(rdb_agg_group_t**)fi_array_get(agg->groups, g) = groups[g];
+    free(groups);
+    return 0;
+}
+
+static fi_array* rdb_aggregate_table(rdb_table_t *table, fi_array *aggregates, fi_array *group_by,
+                                     fi_array *where_conditions) {
+    rdb_aggregation_t agg = {0};
+    fi_array *rows = NULL;
+    fi_array *result = NULL;
+    const rdb_value_t **probe_keys = NULL;
+
+    if (rdb_agg_prepare(&agg, table, aggregates, group_by) != 0) goto done;
+
+    bool has_conditions = where_conditions && fi_array_count(where_conditions) > 0;
+
+    /* A whole columnar table in row id order is aggregated from its vectors */
+    const rdb_column_store_t *store = table->column_store;
+    bool columnar = agg.key_count == 0 && !has_conditions && store && store->ordered;
+
+    if (agg.key_count > 0 && !has_conditions) {
+        rows = rdb_table_rows_in_index_order(table, agg.key_columns, agg.key_count, NULL);
+    }
+    if (!rows && !columnar) {
+        rows = rdb_find_matching_rows(table, where_conditions);
+        if (!rows) goto done;
+        if (agg.key_count > 0) {
+            agg.lookup = fi_map_create(64, sizeof(rdb_agg_group_t*), sizeof(rdb_agg_group_t*),
+                                       rdb_agg_group_hash, rdb_agg_group_compare);
+            if (!agg.lookup) goto done;
+        }
+    }
+
+    agg.groups = fi_array_create(16, sizeof(rdb_agg_group_t*));
+    probe_keys = calloc(agg.key_count ? agg.key_count : 1, sizeof(rdb_value_t*));
+    if (!agg.groups || !probe_keys) goto done;
+    rdb_agg_group_t probe = {0, 0, agg.key_count, probe_keys, NULL};
+
+    /* Without GROUP BY the single group exists even when no row matches */
+    if (agg.key_count == 0 && !rdb_agg_group_create(&agg, &probe, 0)) goto done;
+
+    bool streaming = agg.key_count > 0 && !agg.lookup;
+    size_t workers = streaming || columnar ? 1 : rdb_parallel_workers(table->workers, fi_array_count(rows));
+    if (columnar) {
+        rdb_agg_group_t *single = *(rdb_agg_group_t**)fi_array_get(agg.groups, 0);
+        for (size_t g = 0; g < fi_array_count(store->groups); g++) {
+            const rdb_row_group_t *group = *(rdb_row_group_t**)fi_array_get(store->groups, g);
+            if (group->live_count > 0) rdb_agg_accumulate_row_group(&agg, single, group);
+        }
+    } else if (workers > 1) {
+        if (rdb_agg_accumulate_parallel(&agg, rows, workers) != 0) goto done;
+    } else {
+        for (size_t r = 0; r < fi_array_count(rows); r++) {
+            const rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, r);
+            rdb_agg_group_t *group = rdb_agg_find_group(&agg, row, &probe, r);
+            if (!group) goto done;
+            rdb_agg_accumulate(&agg, group, row);
+        }
+    }
+
+    result = fi_array_create(fi_array_count(agg.groups) ? fi_array_count(agg.groups) : 1,
+                             sizeof(rdb_row_t*));
+    for (size_t g = 0; result && g < fi_array_count(agg.groups); g++) {
+        const rdb_agg_group_t *group = *(rdb_agg_group_t**)fi_array_get(agg.groups, g);
+        rdb_row_t *out = malloc(sizeof(rdb_row_t));
+        fi_array *values = fi_array_create(agg.item_count ? agg.item_count : 1, sizeof(rdb_value_t*));
+        if (!out || !values) {
+            free(out);
+            if (values) fi_array_destroy(values);
+            rdb_aggregate_result_free(result);
+            result = NULL;
+            break;
+        }
+        out->row_id = g + 1;
+        out->values = values;
+        out->deleted = false;
+        fi_array_push(result, &out);
+
+        for (size_t i = 0; i < agg.item_count; i++) {
+            rdb_value_t *value = rdb_agg_finish(&agg, group, i);
+            if (!value || fi_array_push(values, &value) != 0) {
+                rdb_value_free(value);
+                rdb_aggregate_result_free(result);
+                result = NULL;
+                break;
+            }
+        }
+    }
+
+done:
+    if (rows) fi_array_destroy(rows);
+    free(probe_keys);
+    rdb_agg_cleanup(&agg);
+    return result;
+}
+
+/* SELECT with aggregates. `aggregates` holds one rdb_aggregate_t per select
+ * item and `group_by` the GROUP BY column names (NULL or empty for none).
+ * Returns one rdb_row_t* per group whose values follow the select list and
+ * whose row_id numbers the groups from 1; release it with
+ * rdb_aggregate_result_free(). */
+fi_array* rdb_select_aggregate(rdb_database_t *db, const char *table_name, fi_array *aggregates,
+                               fi_array *group_by, fi_array *where_conditions) {
+    if (!db || !table_name || !aggregates) return NULL;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return NULL;
+    }
+
+    return rdb_aggregate_table(table, aggregates, group_by, where_conditions);
+}
+
+fi_array* rdb_select_aggregate_thread_safe(rdb_database_t *db, const char *table_name,
+                                           fi_array *aggregates, fi_array *group_by,
+                                           fi_array *where_conditions) {
+    if (!db || !table_name || !aggregates) return NULL;
+
+    if (rdb_lock_database_read(db) != 0) return NULL;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        rdb_unlock_database(db);
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return NULL;
+    }
+
+    if (rdb_lock_table_read(table) != 0) {
+        rdb_unlock_database(db);
+        return NULL;
+    }
+    rdb_unlock_database(db);
+
+    fi_array *result = rdb_aggregate_table(table, aggregates, group_by, where_conditions);
+
+    rdb_unlock_table(table);
+    return result;
+}
+
+void rdb_aggregate_result_free(fi_array *result) {
+    if (!result) return;
+
+    for (size_t i = 0; i < fi_array_count(result); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(result, i);
+        if (!row) continue;
+        for (size_t j = 0; row->values && j < fi_array_count(row->values); j++) {
+            rdb_value_free(*(rdb_value_t**)fi_array_get(row->values, j));
+        }
+        rdb_row_free(row);
+    }
+    fi_array_destroy(result);
+}
+
+/* Apply ORDER BY and LIMIT/OFFSET to an aggregate result. ORDER BY names
+ * select items by their text (e.g. "customer" or "SUM(amount)") or by
+ * position. Takes over `result`: rows left out are freed. Returns the kept
+ * rows in order, or NULL on error (after freeing `result`). */
+fi_array* rdb_aggregate_order(fi_array *result, fi_array *select_columns, fi_array *order_by,
+                              size_t limit, size_t offset) {
+    if (!result) return NULL;
+
+    size_t key_count = order_by ? fi_array_count(order_by) : 0;
+    size_t item_count = select_columns ? fi_array_count(select_columns) : 0;
+    rdb_sort_key_t *keys = calloc(key_count ? key_count : 1, sizeof(rdb_sort_key_t));
+    if (!keys) {
+        rdb_aggregate_result_free(result);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < key_count; i++) {
+        const rdb_order_by_t *item = (const rdb_order_by_t*)fi_array_get(order_by, i);
+        keys[i].descending = item->descending;
+        keys[i].column = -1;
+
+        if (item->position > 0 && item->position <= item_count) {
+            keys[i].column = (int)item->position - 1;
+        }
+        for (size_t j = 0; j < item_count && item->position == 0 && keys[i].column < 0; j++) {
+            if (strcasecmp(*(char**)fi_array_get(select_columns, j), item->column) == 0) {
+                keys[i].column = (int)j;
+            }
+        }
+
+        if (keys[i].column < 0) {
+            if (item->position > 0) {
+                printf("Error: ORDER BY position %zu is out of range\n", item->position);
+            } else {
+                printf("Error: ORDER BY '%s' is not in the select list\n", item->column);
+            }
+            free(keys);
+            rdb_aggregate_result_free(result);
+            return NULL;
+        }
+    }
+
+    fi_array *ordered = rdb_rows_top_k(result, keys, key_count, limit, offset);
+    free(keys);
+    if (!ordered) {
+        rdb_aggregate_result_free(result);
+        return NULL;
+    }
+
+    /* Free the rows that fell outside the window. Result rows are numbered
+     * by position, which finds each kept row without a search. */
+    size_t count = fi_array_count(result);
+    bool *kept = calloc(count ? count : 1, sizeof(bool));
+    if (!kept) {
+        fi_array_destroy(ordered);
+        rdb_aggregate_result_free(result);
+        return NULL;
+    }
+    for (size_t j = 0; j < fi_array_count(ordered); j++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(ordered, j);
+        size_t i = row->row_id - 1;
+        if (i < count && *(rdb_row_t**)fi_array_get(result, i) == row) {
+            kept[i] = true;
+            continue;
+        }
+        for (i = 0; i < count; i++) {
+            if (*(rdb_row_t**)fi_array_get(result, i) == row) kept[i] = true;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (kept[i]) continue;
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(result, i);
+        for (size_t j = 0; j < fi_array_count(row->values); j++) {
+            rdb_value_free(*(rdb_value_t**)fi_array_get(row->values, j));
+        }
+        rdb_row_free(row);
+    }
+    free(kept);
+    fi_array_destroy(result);
+    return ordered;
+}
@@ -0,0 +1,624 @@
+#include "rdb.h"
+#include "sql_parser.h"
+#include <strings.h>  /* for strcasecmp */
+
+/* Batch execution of WHERE clauses
+ *
+ * rdb_find_matching_rows() filters its candidate rows RDB_BATCH_SIZE at a
+ * time instead of one at a time. The WHERE clause is compiled once per
+ * statement: each condition gets its column ordinal resolved and its
+ * literal converted to the machine type of the comparison, and the OR
+ * groups are split up front.
+ *
+ * For every batch, each AND group narrows a selection vector of batch
+ * positions, predicate by predicate. A typed predicate gathers its column
+ * for the selected rows into a dense int64 or double vector, compares the
+ * whole vector against the literal in one branch-free loop (plain array
+ * code the compiler turns into SIMD compares when optimizing), and keeps
+ * the positions that passed. Later predicates of the group only look at
+ * rows that are still selected, and each OR group only runs over the rows
+ * no earlier group has matched.
+ *
+ * Conditions with no typed kernel (strings, LIKE, mixed types) go through
+ * rdb_condition_matches() for each selected row, without the per-row column
+ * lookup. Conditions holding a general expression run its compiled
+ * program (rdb_expr.c) for each selected row. Results are the same as
+ * rdb_row_matches_conditions().
+ *
+ * On a columnar table a full scan runs one batch per row group instead
+ * (rdb_column_store_filter_rows()): typed predicates and IS NULL take
+ * their values straight from the group's column vectors, and only rows that
+ * are still selected are touched for the other predicates. Without a
+ * limit, the scan workers take whole row groups a morsel at a time. */
+
+/* A row group must fit in one batch, and a morsel must hold whole groups */
+#if RDB_ROW_GROUP_SIZE > RDB_BATCH_SIZE
+#error "RDB_ROW_GROUP_SIZE must not exceed RDB_BATCH_SIZE"
+#endif
+#if RDB_MORSEL_SIZE % RDB_ROW_GROUP_SIZE != 0
+#error "RDB_MORSEL_SIZE must be a multiple of RDB_ROW_GROUP_SIZE"
+#endif
+
+/* How a compiled predicate is evaluated */
+typedef enum {
+    RDB_PREDICATE_NEVER,        /* Unknown column or NULL literal: never true */
+    RDB_PREDICATE_IS_NULL,      /* IS NULL */
+    RDB_PREDICATE_INT,          /* INT column against an INT literal */
+    RDB_PREDICATE_BOOL,         /* BOOLEAN column against a BOOLEAN literal */
+    RDB_PREDICATE_FLOAT,        /* Numeric column against a numeric literal, as doubles */
+    RDB_PREDICATE_GENERIC,      /* Anything else, row by row */
+    RDB_PREDICATE_EXPR          /* Compiled expression, row by row */
+} rdb_predicate_kind_t;
+
+typedef struct {
+    rdb_predicate_kind_t kind;
+    int column;                 /* Ordinal of the column in the table */
+    sql_operator_t operator;    /* Comparison, with IS folded into EQUAL */
+    int64_t int_operand;        /* RDB_PREDICATE_INT / BOOL literal */
+    double float_operand;       /* RDB_PREDICATE_FLOAT literal */
+    bool float_literal;         /* The literal is a FLOAT (INT values convert to double) */
+    const sql_where_condition_t *condition; /* Source condition */
+    rdb_program_t *program;     /* RDB_PREDICATE_EXPR program, owned */
+} rdb_predicate_t;
+
+/* A WHERE clause as OR groups of AND-ed predicates */
+typedef struct {
+    rdb_predicate_t *predicates;
+    size_t predicate_count;
+    size_t *group_ends;         /* Group i spans [group_ends[i - 1], group_ends[i]) */
+    size_t group_count;
+} rdb_batch_filter_t;
+
+/* Working set of one batch */
+typedef struct {
+    size_t count;                          /* Rows in the batch */
+    rdb_row_t *rows[RDB_BATCH_SIZE];       /* Live candidate rows */
+    const rdb_row_group_t *group;          /* Row group the rows come from, or NULL */
+    uint16_t slots[RDB_BATCH_SIZE];        /* Slot of each row in group */
+    bool matched[RDB_BATCH_SIZE];          /* Row matched an earlier OR group */
+    uint16_t selection[RDB_BATCH_SIZE];    /* Positions still selected */
+    size_t selected;                       /* Entries in selection */
+    int64_t ints[RDB_BATCH_SIZE];          /* Gathered INT/BOOLEAN column */
+    double floats[RDB_BATCH_SIZE];         /* Gathered numeric column */
+    uint8_t valid[RDB_BATCH_SIZE];         /* Gathered value is usable by the kernel */
+    uint8_t result[RDB_BATCH_SIZE];        /* Kernel output */
+    uint8_t fallback[RDB_BATCH_SIZE];      /* Row-by-row result for values of another type */
+} rdb_batch_t;
+
+static void rdb_batch_filter_free(rdb_batch_filter_t *filter) {
+    for (size_t i = 0; filter->predicates && i < filter->predicate_count; i++) {
+        rdb_program_free(filter->predicates[i].program);
+    }
+    free(filter->predicates);
+    free(filter->group_ends);
+}
+
+static bool rdb_is_numeric_type(rdb_data_type_t type) {
+    return type == RDB_TYPE_INT || type == RDB_TYPE_FLOAT;
+}
+
+static int rdb_predicate_compile(rdb_table_t *table, const sql_where_condition_t *cond,
+                                 rdb_predicate_t *predicate) {
+    predicate->condition = cond;
+    predicate->program = NULL;
+    if (cond->expr) {
+        predicate->kind = RDB_PREDICATE_EXPR;
+        predicate->program = rdb_expr_compile(table, cond->expr);
+        return predicate->program ? 0 : -1;
+    }
+
+    predicate->column = rdb_get_column_index(table, cond->column_name);
+    predicate->operator = cond->operator == SQL_OP_IS ? SQL_OP_EQUAL : cond->operator;
+    predicate->kind = RDB_PREDICATE_GENERIC;
+
+    bool literal_null = !cond->value || cond->value->is_null;
+    if (predicate->column < 0) {
+        predicate->kind = RDB_PREDICATE_NEVER;
+        return 0;
+    }
+    if (literal_null) {
+        predicate->kind = cond->operator == SQL_OP_IS ? RDB_PREDICATE_IS_NULL : RDB_PREDICATE_NEVER;
+        return 0;
+    }
+
+    switch (predicate->operator) {
+        case SQL_OP_EQUAL:
+        case SQL_OP_IN:         /* The parser accepts a single IN value */
+        case SQL_OP_NOT_EQUAL:
+        case SQL_OP_LESS_THAN:
+        case SQL_OP_GREATER_THAN:
+        case SQL_OP_LESS_EQUAL:
+        case SQL_OP_GREATER_EQUAL:
+            break;
+        default:
+            return 0;
+    }
+    if (predicate->operator == SQL_OP_IN) predicate->operator = SQL_OP_EQUAL;
+
+    rdb_column_t *column = *(rdb_column_t**)fi_array_get(table->columns, predicate->column);
+    rdb_data_type_t literal_type = cond->value->type;
+
+    if (column->type == RDB_TYPE_INT && literal_type == RDB_TYPE_INT) {
+        predicate->kind = RDB_PREDICATE_INT;
+        predicate->int_operand = cond->value->data.int_val;
+    } else if (column->type == RDB_TYPE_BOOLEAN && literal_type == RDB_TYPE_BOOLEAN) {
+        predicate->kind = RDB_PREDICATE_BOOL;
+        predicate->int_operand = cond->value->data.bool_val ? 1 : 0;
+    } else if (rdb_is_numeric_type(column->type) && rdb_is_numeric_type(literal_type)) {
+        predicate->kind = RDB_PREDICATE_FLOAT;
+        predicate->float_literal = literal_type == RDB_TYPE_FLOAT;
+        predicate->float_operand = predicate->float_literal ? cond->value->data.float_val
+                                                            : (double)cond->value->data.int_val;
+    }
+    return 0;
+}
+
+/* Split the conditions into OR groups and compile them. Conditions are
+ * joined left to right by their connectors, AND binding tighter than OR. */
+static int rdb_batch_filter_compile(rdb_table_t *table, fi_array *where_conditions,
+                                    rdb_batch_filter_t *filter) {
+    size_t count = where_conditions ? fi_array_count(where_conditions) : 0;
+    memset(filter, 0, sizeof(*filter));
+
+    filter->predicates = malloc((count ? count : 1) * sizeof(rdb_predicate_t));
+    filter->group_ends = malloc((count ? count : 1) * sizeof(size_t));
+    if (!filter->predicates || !filter->group_ends) {
+        rdb_batch_filter_free(filter);
+        return -1;
+    }
+
+    /* No conditions: one empty group, which every row satisfies */
+    if (count == 0) {
+        filter->group_ends[filter->group_count++] = 0;
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(where_conditions, i);
+        if (cond && rdb_predicate_compile(table, cond, &filter->predicates[filter->predicate_count++]) != 0) {
+            rdb_batch_filter_free(filter);
+            return -1;
+        }
+
+        bool ends_group = i + 1 == count ||
+                          (cond && strcasecmp(cond->logical_connector, "OR") == 0);
+        if (ends_group) {
+            filter->group_ends[filter->group_count++] = filter->predicate_count;
+        }
+    }
+    return 0;
+}
+
+/* Value of `column` in `row`; NULL when the row is shorter than the schema */
+static const rdb_value_t* rdb_batch_value(const rdb_row_t *row, int column) {
+    if (column >= (int)fi_array_count(row->values)) return NULL;
+    return *(rdb_value_t**)fi_array_get(row->values, column);
+}
+
+/* Comparison kernels: result[i] = values[i] <op> operand over a dense vector */
+
+static void rdb_batch_compare_ints(const int64_t *values, size_t count, sql_operator_t op,
+                                   int64_t operand, uint8_t *result) {
+    switch (op) {
+        case SQL_OP_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] == operand;
+            break;
+        case SQL_OP_NOT_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] != operand;
+            break;
+        case SQL_OP_LESS_THAN:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] < operand;
+            break;
+        case SQL_OP_GREATER_THAN:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] > operand;
+            break;
+        case SQL_OP_LESS_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] <= operand;
+            break;
+        case SQL_OP_GREATER_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] >= operand;
+            break;
+        default:
+            memset(result, 0, count);
+            break;
+    }
+}
+
+/* Written in terms of < and > only, so that NaN compares the way
+ * rdb_condition_matches() orders it (neither less nor greater: equal) */
+static void rdb_batch_compare_floats(const double *values, size_t count, sql_operator_t op,
+                                     double operand, uint8_t *result) {
+    switch (op) {
+        case SQL_OP_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = !(values[i] < operand) & !(values[i] > operand);
+            break;
+        case SQL_OP_NOT_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = (values[i] < operand) | (values[i] > operand);
+            break;
+        case SQL_OP_LESS_THAN:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] < operand;
+            break;
+        case SQL_OP_GREATER_THAN:
+            for (size_t i = 0; i < count; i++) result[i] = values[i] > operand;
+            break;
+        case SQL_OP_LESS_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = !(values[i] > operand);
+            break;
+        case SQL_OP_GREATER_EQUAL:
+            for (size_t i = 0; i < count; i++) result[i] = !(values[i] < operand);
+            break;
+        default:
+            memset(result, 0, count);
+            break;
+    }
+}
+
+/* rdb_batch_gather() from a column vector holding values of the column
+ * type only, which are all of the type the predicate kernel takes */
+static void rdb_batch_gather_vector(rdb_batch_t *batch, const rdb_predicate_t *predicate) {
+    const rdb_column_vector_t *vector = &batch->group->columns[predicate->column];
+    size_t selected = batch->selected;
+
+    for (size_t k = 0; k < selected; k++) {
+        size_t slot = batch->slots[batch->selection[k]];
+        batch->valid[k] = !RDB_BITMAP_TEST(vector->nulls, slot);
+        batch->fallback[k] = 0;
+    }
+
+    switch (vector->type) {
+        case RDB_TYPE_INT:
+            if (predicate->kind == RDB_PREDICATE_FLOAT) {
+                for (size_t k = 0; k < selected; k++) {
+                    batch->floats[k] = (double)vector->ints[batch->slots[batch->selection[k]]];
+                }
+            } else {
+                for (size_t k = 0; k < selected; k++) {
+                    batch->ints[k] = vector->ints[batch->slots[batch->selection[k]]];
+                }
+            }
+            break;
+        case RDB_TYPE_FLOAT:
+            for (size_t k = 0; k < selected; k++) {
+                batch->floats[k] = vector->floats[batch->slots[batch->selection[k]]];
+            }
+            break;
+        case RDB_TYPE_BOOLEAN:
+            for (size_t k = 0; k < selected; k++) {
+                batch->ints[k] = vector->bools[batch->slots[batch->selection[k]]];
+            }
+            break;
+        default:
+            memset(batch->valid, 0, selected);
+            break;
+    }
+}
+
+/* Gather the predicate column of the selected rows into the typed vectors.
+ * NULLs are not valid; values of a type the kernel does not take are
+ * evaluated row by row into `fallback`. */
+static void rdb_batch_gather(rdb_batch_t *batch, const rdb_predicate_t *predicate) {
+    if (batch->group && rdb_column_vector_readable(batch->group, predicate->column)) {
+        rdb_batch_gather_vector(batch, predicate);
+        return;
+    }
+
+    for (size_t k = 0; k < batch->selected; k++) {
+        const rdb_value_t *value = rdb_batch_value(batch->rows[batch->selection[k]], predicate->column);
+        batch->valid[k] = 0;
+        batch->fallback[k] = 0;
+        batch->ints[k] = 0;
+        batch->floats[k] = 0.0;
+        if (!value || value->is_null) continue;
+
+        switch (predicate->kind) {
+            case RDB_PREDICATE_INT:
+                if (value->type == RDB_TYPE_INT) {
+                    batch->ints[k] = value->data.int_val;
+                    batch->valid[k] = 1;
+                    continue;
+                }
+                break;
+            case RDB_PREDICATE_BOOL:
+                if (value->type == RDB_TYPE_BOOLEAN) {
+                    batch->ints[k] = value->data.bool_val ? 1 : 0;
+                    batch->valid[k] = 1;
+                    continue;
+                }
+                break;
+            case RDB_PREDICATE_FLOAT:
+                if (value->type == RDB_TYPE_FLOAT) {
+                    batch->floats[k] = value->data.float_val;
+                    batch->valid[k] = 1;
+                    continue;
+                }
+                /* INT against INT compares exactly, not as doubles */
+                if (value->type == RDB_TYPE_INT && predicate->float_literal) {
+                    batch->floats[k] = (double)value->data.int_val;
+                    batch->valid[k] = 1;
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        batch->fallback[k] = rdb_condition_matches(value, predicate->condition);
+    }
+}
+
+/* Narrow the selection to the rows that satisfy `predicate` */
+static void rdb_batch_apply(rdb_batch_t *batch, const rdb_predicate_t *predicate) {
+    size_t selected = batch->selected;
+    size_t kept = 0;
+
+    switch (predicate->kind) {
+        case RDB_PREDICATE_NEVER:
+            break;
+
+        case RDB_PREDICATE_IS_NULL:
+            if (batch->group && rdb_column_vector_readable(batch->group, predicate->column)) {
+                const uint64_t *nulls = batch->group->columns[predicate->column].nulls;
+                for (size_t k = 0; k < selected; k++) {
+                    batch->selection[kept] = batch->selection[k];
+                    kept += RDB_BITMAP_TEST(nulls, batch->slots[batch->selection[k]]);
+                }
+                break;
+            }
+            for (size_t k = 0; k < selected; k++) {
+                const rdb_value_t *value = rdb_batch_value(batch->rows[batch->selection[k]], predicate->column);
+                batch->selection[kept] = batch->selection[k];
+                kept += !value || value->is_null;
+            }
+            break;
+
+        case RDB_PREDICATE_INT:
+        case RDB_PREDICATE_BOOL:
+        case RDB_PREDICATE_FLOAT:
+            rdb_batch_gather(batch, predicate);
+            if (predicate->kind == RDB_PREDICATE_FLOAT) {
+                rdb_batch_compare_floats(batch->floats, selected, predicate->operator,
+                                         predicate->float_operand, batch->result);
+            } else {
+                rdb_batch_compare_ints(batch->ints, selected, predicate->operator,
+                                       predicate->int_operand, batch->result);
+            }
+            for (size_t k = 0; k < selected; k++) {
+                batch->selection[kept] = batch->selection[k];
+                kept += (batch->result[k] & batch->valid[k]) | batch->fallback[k];
+            }
+            break;
+
+        case RDB_PREDICATE_GENERIC:
+            for (size_t k = 0; k < selected; k++) {
+                const rdb_value_t *value = rdb_batch_value(batch->rows[batch->selection[k]], predicate->column);
+                batch->selection[kept] = batch->selection[k];
+                kept += rdb_condition_matches(value, predicate->condition);
+            }
+            break;
+
+        case RDB_PREDICATE_EXPR:
+            for (size_t k = 0; k < selected; k++) {
+                batch->selection[kept] = batch->selection[k];
+                kept += rdb_program_matches(predicate->program, batch->rows[batch->selection[k]]);
+            }
+            break;
+    }
+
+    batch->selected = kept;
+}
+
+/* Evaluate the filter over the rows of the batch, setting matched[] */
+static void rdb_batch_evaluate(rdb_batch_t *batch, const rdb_batch_filter_t *filter) {
+    memset(batch->matched, 0, batch->count * sizeof(bool));
+
+    size_t start = 0;
+    for (size_t g = 0; g < filter->group_count; g++) {
+        size_t end = filter->group_ends[g];
+
+        /* Only rows no earlier group has matched */
+        batch->selected = 0;
+        for (size_t i = 0; i < batch->count; i++) {
+            batch->selection[batch->selected] = (uint16_t)i;
+            batch->selected += !batch->matched[i];
+        }
+
+        for (size_t p = start; p < end && batch->selected > 0; p++) {
+            rdb_batch_apply(batch, &filter->predicates[p]);
+        }
+        for (size_t k = 0; k < batch->selected; k++) {
+            batch->matched[batch->selection[k]] = true;
+        }
+        start = end;
+    }
+}
+
+/* Append the rows of `rows[begin, end)` that match to `result`, stopping
+ * once it holds `limit` rows (0 for no limit) */
+static void rdb_batch_filter_range(const rdb_batch_filter_t *filter, rdb_batch_t *batch, fi_array *rows,
+                                   size_t begin, size_t end, fi_array *result, size_t limit) {
+    size_t next = begin;
+    batch->group = NULL;
+    while (next < end && (!limit || fi_array_count(result) < limit)) {
+        batch->count = 0;
+        while (next < end && batch->count < RDB_BATCH_SIZE) {
+            rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, next++);
+            if (row && !row->deleted && row->values) batch->rows[batch->count++] = row;
+        }
+
+        rdb_batch_evaluate(batch, filter);
+        for (size_t i = 0; i < batch->count && (!limit || fi_array_count(result) < limit); i++) {
+            if (batch->matched[i]) fi_array_push(result, &batch->rows[i]);
+        }
+    }
+}
+
+/* The same over row groups [begin, end) of a column store, one batch per
+ * group */
+static void rdb_batch_filter_groups(const rdb_batch_filter_t *filter, rdb_batch_t *batch,
+                                    const rdb_column_store_t *store, size_t begin, size_t end,
+                                    fi_array *result, size_t limit) {
+    for (size_t g = begin; g < end && (!limit || fi_array_count(result) < limit); g++) {
+        const rdb_row_group_t *group = *(rdb_row_group_t**)fi_array_get(store->groups, g);
+        if (group->live_count == 0) continue;
+
+        batch->group = group;
+        batch->count = 0;
+        for (size_t slot = 0; slot < group->row_count; slot++) {
+            batch->rows[batch->count] = group->rows[slot];
+            batch->slots[batch->count] = (uint16_t)slot;
+            batch->count += !RDB_BITMAP_TEST(group->deleted, slot);
+        }
+
+        rdb_batch_evaluate(batch, filter);
+        for (size_t i = 0; i < batch->count && (!limit || fi_array_count(result) < limit); i++) {
+            if (batch->matched[i]) fi_array_push(result, &batch->rows[i]);
+        }
+    }
+}
+
+/* A WHERE clause evaluated over morsels by the scan workers. A morsel spans
+ * rows of `rows`, or RDB_MORSEL_SIZE / RDB_ROW_GROUP_SIZE groups of `store`. */
+typedef struct {
+    const rdb_batch_filter_t *filter;
+    fi_array *rows;
+    const rdb_column_store_t *store;
+    rdb_batch_t **batches;      /* Scratch batch per worker */
+    fi_array **outputs;         /* Matching rows per morsel */
+} rdb_batch_scan_t;
+
+static void rdb_batch_filter_morsel(void *context, size_t worker, size_t morsel,
+                                    size_t begin, size_t end) {
+    rdb_batch_scan_t *scan = (rdb_batch_scan_t*)context;
+
+    fi_array *output = fi_array_create(16, sizeof(rdb_row_t*));
+    if (output && scan->store) {
+        rdb_batch_filter_groups(scan->filter, scan->batches[worker], scan->store,
+                                begin / RDB_ROW_GROUP_SIZE, end / RDB_ROW_GROUP_SIZE, output, 0);
+    } else if (output) {
+        rdb_batch_filter_range(scan->filter, scan->batches[worker], scan->rows, begin, end, output, 0);
+    }
+    scan->outputs[morsel] = output;
+}
+
+/* Filter `rows`, or the groups of `store` when it is set, with `workers`
+ * threads; per-morsel matches are concatenated in morsel order, so the
+ * result keeps input order */
+static fi_array* rdb_batch_filter_parallel(rdb_table_t *table, const rdb_batch_filter_t *filter,
+                                           fi_array *rows, const rdb_column_store_t *store,
+                                           size_t workers) {
+    size_t total = store ? fi_array_count(store->groups) * RDB_ROW_GROUP_SIZE : fi_array_count(rows);
+    size_t morsels = (total + RDB_MORSEL_SIZE - 1) / RDB_MORSEL_SIZE;
+
+    rdb_batch_scan_t scan = {filter, rows, store, NULL, NULL};
+    scan.batches = calloc(workers, sizeof(rdb_batch_t*));
+    scan.outputs = calloc(morsels, sizeof(fi_array*));
+    bool ready = scan.batches && scan.outputs;
+    for (size_t w = 0; ready && w < workers; w++) {
+        scan.batches[w] = malloc(sizeof(rdb_batch_t));
+        ready = scan.batches[w] != NULL;
+    }
+
+    fi_array *result = NULL;
+    if (ready && rdb_parallel_for(table->workers, total, workers, rdb_batch_filter_morsel, &scan) == 0) {
+        size_t matched = 0;
+        for (size_t m = 0; m < morsels && scan.outputs[m]; m++) matched += fi_array_count(scan.outputs[m]);
+
+        result = fi_array_create(matched ? matched : 16, sizeof(rdb_row_t*));
+        for (size_t m = 0; result && m < morsels; m++) {
+            if (!scan.outputs[m] || fi_array_merge(result, scan.outputs[m]) != 0) {
+                fi_array_destroy(result);
+                result = NULL;
+            }
+        }
+    }
+
+    for (size_t m = 0; scan.outputs && m < morsels; m++) {
+        if (scan.outputs[m]) fi_array_destroy(scan.outputs[m]);
+    }
+    for (size_t w = 0; scan.batches && w < workers; w++) free(scan.batches[w]);
+    free(scan.outputs);
+    free(scan.batches);
+    return result;
+}
+
+/* Rows of `rows` (live ones only) that satisfy the WHERE conditions of
+ * `table`. The returned array holds borrowed row pointers, in input order.
+ * Large inputs are split into morsels filtered by the table's scan workers. */
+fi_array* rdb_batch_filter_rows(rdb_table_t *table, fi_array *rows, fi_array *where_conditions) {
+    return rdb_batch_filter_rows_limit(table, rows, where_conditions, 0);
+}
+
+/* The same, stopping once `limit` rows matched (0 for no limit). A limited
+ * filter stays on the calling thread so it can stop early. */
+fi_array* rdb_batch_filter_rows_limit(rdb_table_t *table, fi_array *rows, fi_array *where_conditions,
+                                      size_t limit) {
+    if (!table || !rows) return NULL;
+
+    rdb_batch_filter_t filter;
+    if (rdb_batch_filter_compile(table, where_conditions, &filter) != 0) return NULL;
+
+    size_t workers = limit ? 1 : rdb_parallel_workers(table->workers, fi_array_count(rows));
+    if (workers > 1) {
+        fi_array *result = rdb_batch_filter_parallel(table, &filter, rows, NULL, workers);
+        rdb_batch_filter_free(&filter);
+        return result;
+    }
+
+    fi_array *result = fi_array_create(16, sizeof(rdb_row_t*));
+    rdb_batch_t *batch = malloc(sizeof(rdb_batch_t));
+    if (!result || !batch) {
+        if (result) fi_array_destroy(result);
+        free(batch);
+        rdb_batch_filter_free(&filter);
+        return NULL;
+    }
+
+    rdb_batch_filter_range(&filter, batch, rows, 0, fi_array_count(rows), result, limit);
+
+    free(batch);
+    rdb_batch_filter_free(&filter);
+    return result;
+}
+
+static int rdb_batch_row_id_order(const void *a, const void *b) {
+    /* fi_array keeps each element in its own allocation */
+    const rdb_row_t *ra = **(rdb_row_t** const*)a;
+    const rdb_row_t *rb = **(rdb_row_t** const*)b;
+    return (ra->row_id > rb->row_id) - (ra->row_id < rb->row_id);
+}
+
+/* Rows of a columnar table matching `where_conditions` (all rows when it is
+ * NULL), at most `limit` of them when it is not 0, read from the column
+ * store one batch per row group. Matches come back in row id order, like a
+ * scan of the rows. Returns NULL on error and when the table has no column
+ * store, or when a limit applies but updates have moved rows out of order;
+ * the caller then scans the rows. */
+fi_array* rdb_column_store_filter_rows(rdb_table_t *table, fi_array *where_conditions, size_t limit) {
+    if (!table || !table->column_store) return NULL;
+
+    const rdb_column_store_t *store = table->column_store;
+    if (limit && !store->ordered) return NULL;
+
+    rdb_batch_filter_t filter;
+    if (rdb_batch_filter_compile(table, where_conditions, &filter) != 0) return NULL;
+
+    size_t group_count = fi_array_count(store->groups);
+    size_t workers = limit ? 1 : rdb_parallel_workers(table->workers, group_count * RDB_ROW_GROUP_SIZE);
+    fi_array *result = NULL;
+    if (workers > 1) {
+        result = rdb_batch_filter_parallel(table, &filter, NULL, store, workers);
+    } else {
+        result = fi_array_create(16, sizeof(rdb_row_t*));
+        rdb_batch_t *batch = malloc(sizeof(rdb_batch_t));
+        if (result && batch) {
+            rdb_batch_filter_groups(&filter, batch, store, 0, group_count, result, limit);
+        } else if (result) {
+            fi_array_destroy(result);
+            result = NULL;
+        }
+        free(batch);
+    }
+    rdb_batch_filter_free(&filter);
+
+    if (result && !store->ordered) fi_array_sort(result, rdb_batch_row_id_order);
+    return result;
+}
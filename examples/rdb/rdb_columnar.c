@@ -0,0 +1,481 @@
+#include "rdb.h"
+#include "sql_parser.h"
+
+/* Columnar storage
+ *
+ * A table switched to RDB_STORAGE_COLUMNAR keeps, next to its row objects,
+ * a copy of every row laid out column by column in row groups of up to
+ * RDB_ROW_GROUP_SIZE rows: each column of a group is one contiguous typed
+ * vector (int64, double, bool, or string offsets plus a byte heap) with a
+ * null bitmap. A scan over a few columns of a wide table touches only those
+ * vectors, and the per-column loops are plain array walks the compiler can
+ * vectorize.
+ *
+ * The row objects stay the source of truth for transactions, the WAL,
+ * indexes and persistence; the column store is maintained through the same
+ * hooks as the secondary indexes. Groups are append-only: removing a row
+ * marks its slot deleted, and an update is a removal followed by an append.
+ * Once deleted slots outnumber live ones, the removal that tips the balance
+ * rebuilds the store from the rows, so scans under a read lock never
+ * modify it.
+ *
+ * WHERE filters without a usable index read the vectors of columnar tables
+ * (rdb_column_store_filter_rows() in rdb_batch.c). Each slot also points at
+ * its row object: results are rows, and a column vector holding a value of
+ * a type other than the column's is never read,
+ * so every scan gives the same answer from the row objects as the row
+ * store does. An update moves its row to the end of the store; scans then
+ * put their matches back in row id order. */
+
+/* Slots allocated for a new row group; vectors double up to RDB_ROW_GROUP_SIZE */
+#define RDB_ROW_GROUP_INITIAL_CAPACITY 64
+
+static bool rdb_is_string_column(rdb_data_type_t type) {
+    return type == RDB_TYPE_VARCHAR || type == RDB_TYPE_TEXT;
+}
+
+static void rdb_column_vector_free(rdb_column_vector_t *vector) {
+    free(vector->ints);
+    free(vector->floats);
+    free(vector->bools);
+    free(vector->offsets);
+    free(vector->bytes);
+}
+
+/* Resize the slot storage of a vector to `capacity` rows */
+static int rdb_column_vector_reserve(rdb_column_vector_t *vector, size_t capacity) {
+    switch (vector->type) {
+        case RDB_TYPE_INT: {
+            int64_t *ints = realloc(vector->ints, capacity * sizeof(int64_t));
+            if (!ints) return -1;
+            vector->ints = ints;
+            break;
+        }
+        case RDB_TYPE_FLOAT: {
+            double *floats = realloc(vector->floats, capacity * sizeof(double));
+            if (!floats) return -1;
+            vector->floats = floats;
+            break;
+        }
+        case RDB_TYPE_BOOLEAN: {
+            bool *bools = realloc(vector->bools, capacity * sizeof(bool));
+            if (!bools) return -1;
+            vector->bools = bools;
+            break;
+        }
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT: {
+            bool first = vector->offsets == NULL;
+            uint32_t *offsets = realloc(vector->offsets, (capacity + 1) * sizeof(uint32_t));
+            if (!offsets) return -1;
+            vector->offsets = offsets;
+            if (first) vector->offsets[0] = 0;
+            break;
+        }
+    }
+    return 0;
+}
+
+static void rdb_row_group_destroy(rdb_row_group_t *group) {
+    if (!group) return;
+
+    for (size_t i = 0; i < group->column_count; i++) {
+        rdb_column_vector_free(&group->columns[i]);
+    }
+    free(group->columns);
+    free(group);
+}
+
+static rdb_row_group_t* rdb_row_group_create(rdb_table_t *table) {
+    rdb_row_group_t *group = calloc(1, sizeof(rdb_row_group_t));
+    if (!group) return NULL;
+
+    group->column_count = fi_array_count(table->columns);
+    group->columns = calloc(group->column_count ? group->column_count : 1, sizeof(rdb_column_vector_t));
+    if (!group->columns) {
+        free(group);
+        return NULL;
+    }
+
+    group->capacity = RDB_ROW_GROUP_INITIAL_CAPACITY;
+    for (size_t i = 0; i < group->column_count; i++) {
+        rdb_column_t *column = *(rdb_column_t**)fi_array_get(table->columns, i);
+        group->columns[i].type = column->type;
+        if (rdb_column_vector_reserve(&group->columns[i], group->capacity) != 0) {
+            rdb_row_group_destroy(group);
+            return NULL;
+        }
+    }
+
+    return group;
+}
+
+/* Make room for one more slot in `group` */
+static int rdb_row_group_grow(rdb_row_group_t *group) {
+    if (group->row_count < group->capacity) return 0;
+
+    size_t capacity = group->capacity * 2;
+    if (capacity > RDB_ROW_GROUP_SIZE) capacity = RDB_ROW_GROUP_SIZE;
+
+    for (size_t i = 0; i < group->column_count; i++) {
+        if (rdb_column_vector_reserve(&group->columns[i], capacity) != 0) return -1;
+    }
+    group->capacity = capacity;
+    return 0;
+}
+
+/* Store `value` in `slot`, converting between numeric types. Values that do
+ * not fit the column type are stored as NULL. Both count as mismatched. */
+static int rdb_column_vector_set(rdb_column_vector_t *vector, size_t slot, const rdb_value_t *value) {
+    bool is_null = !value || value->is_null;
+    bool matches = is_null || value->type == vector->type ||
+                   (rdb_is_string_column(vector->type) && rdb_is_string_column(value->type));
+
+    switch (vector->type) {
+        case RDB_TYPE_INT:
+            vector->ints[slot] = 0;
+            if (is_null) break;
+            if (value->type == RDB_TYPE_INT) vector->ints[slot] = value->data.int_val;
+            else if (value->type == RDB_TYPE_FLOAT) vector->ints[slot] = (int64_t)value->data.float_val;
+            else if (value->type == RDB_TYPE_BOOLEAN) vector->ints[slot] = value->data.bool_val;
+            else is_null = true;
+            break;
+        case RDB_TYPE_FLOAT:
+            vector->floats[slot] = 0.0;
+            if (is_null) break;
+            if (value->type == RDB_TYPE_FLOAT) vector->floats[slot] = value->data.float_val;
+            else if (value->type == RDB_TYPE_INT) vector->floats[slot] = (double)value->data.int_val;
+            else is_null = true;
+            break;
+        case RDB_TYPE_BOOLEAN:
+            vector->bools[slot] = false;
+            if (is_null) break;
+            if (value->type == RDB_TYPE_BOOLEAN) vector->bools[slot] = value->data.bool_val;
+            else if (value->type == RDB_TYPE_INT) vector->bools[slot] = value->data.int_val != 0;
+            else is_null = true;
+            break;
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT: {
+            uint32_t start = vector->offsets[slot];
+            size_t length = 0;
+            if (!is_null && rdb_is_string_column(value->type)) {
+                length = rdb_get_string_length(value);
+            } else {
+                is_null = true;
+            }
+
+            if ((uint64_t)start + length > UINT32_MAX) {
+                printf("Error: Row group string data exceeds 4GB\n");
+                return -1;
+            }
+            if (start + length > vector->bytes_capacity) {
+                size_t capacity = vector->bytes_capacity ? vector->bytes_capacity * 2 : 256;
+                while (capacity < start + length) capacity *= 2;
+                char *bytes = realloc(vector->bytes, capacity);
+                if (!bytes) return -1;
+                vector->bytes = bytes;
+                vector->bytes_capacity = capacity;
+            }
+            if (length > 0) memcpy(vector->bytes + start, rdb_get_string_value(value), length);
+            vector->offsets[slot + 1] = start + (uint32_t)length;
+            break;
+        }
+    }
+
+    if (is_null) {
+        vector->nulls[slot >> 6] |= (uint64_t)1 << (slot & 63);
+    } else {
+        vector->nulls[slot >> 6] &= ~((uint64_t)1 << (slot & 63));
+    }
+    if (!matches) vector->mismatched++;
+    return 0;
+}
+
+/* Whether scans may read column `column` of `group` from its vector rather
+ * than from the row objects */
+bool rdb_column_vector_readable(const rdb_row_group_t *group, int column) {
+    return column >= 0 && (size_t)column < group->column_count && group->columns[column].mismatched == 0;
+}
+
+const char* rdb_column_vector_string(const rdb_column_vector_t *vector, size_t slot, size_t *length) {
+    if (!vector || !rdb_is_string_column(vector->type) || RDB_BITMAP_TEST(vector->nulls, slot)) {
+        return NULL;
+    }
+    if (length) *length = vector->offsets[slot + 1] - vector->offsets[slot];
+    return vector->bytes ? vector->bytes + vector->offsets[slot] : "";
+}
+
+void rdb_column_store_destroy(rdb_column_store_t *store) {
+    if (!store) return;
+
+    if (store->groups) {
+        for (size_t i = 0; i < fi_array_count(store->groups); i++) {
+            rdb_row_group_destroy(*(rdb_row_group_t**)fi_array_get(store->groups, i));
+        }
+        fi_array_destroy(store->groups);
+    }
+    if (store->slots) fi_map_destroy(store->slots);
+    free(store);
+}
+
+/* Append `row` to the last row group of `store`, opening a new group when
+ * it is full */
+static int rdb_column_store_append(rdb_column_store_t *store, rdb_table_t *table, rdb_row_t *row) {
+    size_t group_count = fi_array_count(store->groups);
+    rdb_row_group_t *group = group_count ? *(rdb_row_group_t**)fi_array_get(store->groups, group_count - 1) : NULL;
+
+    if (!group || group->row_count == RDB_ROW_GROUP_SIZE ||
+        group->column_count != fi_array_count(table->columns)) {
+        group = rdb_row_group_create(table);
+        if (!group) return -1;
+        if (fi_array_push(store->groups, &group) != 0) {
+            rdb_row_group_destroy(group);
+            return -1;
+        }
+        group_count++;
+    }
+
+    if (rdb_row_group_grow(group) != 0) return -1;
+
+    size_t slot = group->row_count;
+    size_t value_count = row->values ? fi_array_count(row->values) : 0;
+    for (size_t i = 0; i < group->column_count; i++) {
+        const rdb_value_t *value = i < value_count ? *(rdb_value_t**)fi_array_get(row->values, i) : NULL;
+        if (rdb_column_vector_set(&group->columns[i], slot, value) != 0) return -1;
+    }
+
+    uint64_t row_id = row->row_id;
+    uint64_t location = (uint64_t)(group_count - 1) * RDB_ROW_GROUP_SIZE + slot;
+    if (fi_map_put(store->slots, &row_id, &location) != 0) return -1;
+
+    group->row_ids[slot] = row->row_id;
+    group->rows[slot] = row;
+    group->deleted[slot >> 6] &= ~((uint64_t)1 << (slot & 63));
+    group->row_count++;
+    group->live_count++;
+
+    /* Rollbacks and updates append rows behind later ones */
+    if (row->row_id < store->next_row_id) store->ordered = false;
+    else store->next_row_id = row->row_id + 1;
+    return 0;
+}
+
+rdb_column_store_t* rdb_column_store_create(rdb_table_t *table) {
+    if (!table) return NULL;
+
+    rdb_column_store_t *store = calloc(1, sizeof(rdb_column_store_t));
+    if (!store) return NULL;
+    store->ordered = true;
+
+    size_t row_count = table->rows ? fi_array_count(table->rows) : 0;
+    store->groups = fi_array_create(row_count / RDB_ROW_GROUP_SIZE + 1, sizeof(rdb_row_group_t*));
+    store->slots = fi_map_create(row_count > 16 ? row_count : 16, sizeof(uint64_t), sizeof(uint64_t),
+                                 fi_map_hash_int64, fi_map_compare_int64);
+    if (!store->groups || !store->slots) {
+        rdb_column_store_destroy(store);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < row_count; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (row && !row->deleted && row->values && rdb_column_store_append(store, table, row) != 0) {
+            rdb_column_store_destroy(store);
+            return NULL;
+        }
+    }
+
+    return store;
+}
+
+/* Rebuild the column store from the row objects, dropping deleted slots
+ * and picking up schema changes */
+int rdb_column_store_rebuild(rdb_table_t *table) {
+    if (!table || !table->column_store) return -1;
+
+    rdb_column_store_t *store = rdb_column_store_create(table);
+    if (!store) return -1;
+
+    rdb_column_store_destroy(table->column_store);
+    table->column_store = store;
+    return 0;
+}
+
+int rdb_column_store_append_row(rdb_table_t *table, rdb_row_t *row) {
+    if (!table || !row || !table->column_store) return -1;
+
+    if (rdb_column_store_append(table->column_store, table, row) != 0) {
+        printf("Error: Failed to add row %zu to the column store of table '%s'\n", row->row_id, table->name);
+        return -1;
+    }
+    return 0;
+}
+
+int rdb_column_store_remove_row(rdb_table_t *table, const rdb_row_t *row) {
+    if (!table || !row || !table->column_store) return -1;
+
+    /* Compact once deleted slots would outnumber live ones. `row` is still
+     * live in the rows, so the rebuilt store holds it and it is removed
+     * below like from the old one. */
+    rdb_column_store_t *store = table->column_store;
+    if (store->deleted_count + 1 >= RDB_ROW_GROUP_SIZE && store->deleted_count + 1 > fi_map_size(store->slots)) {
+        rdb_column_store_rebuild(table);
+        store = table->column_store;
+    }
+
+    uint64_t row_id = row->row_id;
+    uint64_t location;
+    if (fi_map_get(store->slots, &row_id, &location) != 0) return -1;
+
+    rdb_row_group_t *group = *(rdb_row_group_t**)fi_array_get(store->groups, location / RDB_ROW_GROUP_SIZE);
+    size_t slot = location % RDB_ROW_GROUP_SIZE;
+    group->deleted[slot >> 6] |= (uint64_t)1 << (slot & 63);
+    group->live_count--;
+    store->deleted_count++;
+
+    fi_map_remove(store->slots, &row_id);
+    return 0;
+}
+
+size_t rdb_column_store_scan(rdb_table_t *table, rdb_row_group_visit_t visit, void *user_data) {
+    if (!table || !table->column_store || !visit) return 0;
+
+    rdb_column_store_t *store = table->column_store;
+    size_t visited = 0;
+    for (size_t i = 0; i < fi_array_count(store->groups); i++) {
+        rdb_row_group_t *group = *(rdb_row_group_t**)fi_array_get(store->groups, i);
+        if (group->live_count == 0) continue;
+
+        visited++;
+        if (!visit(group, user_data)) break;
+    }
+    return visited;
+}
+
+/* Summary state threaded through rdb_column_store_scan */
+typedef struct {
+    int column;
+    rdb_column_summary_t *summary;
+} rdb_column_summary_scan_t;
+
+static void rdb_column_summary_add(rdb_column_summary_t *summary, double value) {
+    if (summary->value_count == 0 || value < summary->min) summary->min = value;
+    if (summary->value_count == 0 || value > summary->max) summary->max = value;
+    summary->sum += value;
+    summary->value_count++;
+}
+
+/* Slot holds a live, non-NULL value */
+#define RDB_SLOT_HAS_VALUE(group, vector, slot) \
+    (!RDB_BITMAP_TEST((group)->deleted, slot) && !RDB_BITMAP_TEST((vector)->nulls, slot))
+
+static bool rdb_column_summary_visit(const rdb_row_group_t *group, void *user_data) {
+    rdb_column_summary_scan_t *scan = (rdb_column_summary_scan_t*)user_data;
+    rdb_column_summary_t *summary = scan->summary;
+    const rdb_column_vector_t *vector = &group->columns[scan->column];
+    size_t count = group->row_count;
+
+    summary->row_count += group->live_count;
+
+    /* Values of other types were converted in the vector: read the rows */
+    if (!rdb_column_vector_readable(group, scan->column)) {
+        for (size_t slot = 0; slot < count; slot++) {
+            if (RDB_BITMAP_TEST(group->deleted, slot)) continue;
+            const rdb_row_t *row = group->rows[slot];
+            if ((size_t)scan->column >= fi_array_count(row->values)) continue;
+            const rdb_value_t *value = *(rdb_value_t**)fi_array_get(row->values, scan->column);
+            if (!value || value->is_null) continue;
+
+            if (rdb_is_string_column(vector->type)) {
+                summary->value_count += rdb_is_string_column(value->type);
+            } else if (value->type == RDB_TYPE_INT) {
+                rdb_column_summary_add(summary, (double)value->data.int_val);
+            } else if (value->type == RDB_TYPE_FLOAT) {
+                rdb_column_summary_add(summary, value->data.float_val);
+            } else if (value->type == RDB_TYPE_BOOLEAN) {
+                rdb_column_summary_add(summary, value->data.bool_val);
+            }
+        }
+        return true;
+    }
+
+    /* One loop per type so each walks a single contiguous vector */
+    switch (vector->type) {
+        case RDB_TYPE_INT:
+            for (size_t slot = 0; slot < count; slot++) {
+                if (RDB_SLOT_HAS_VALUE(group, vector, slot)) {
+                    rdb_column_summary_add(summary, (double)vector->ints[slot]);
+                }
+            }
+            break;
+        case RDB_TYPE_FLOAT:
+            for (size_t slot = 0; slot < count; slot++) {
+                if (RDB_SLOT_HAS_VALUE(group, vector, slot)) {
+                    rdb_column_summary_add(summary, vector->floats[slot]);
+                }
+            }
+            break;
+        case RDB_TYPE_BOOLEAN:
+            for (size_t slot = 0; slot < count; slot++) {
+                if (RDB_SLOT_HAS_VALUE(group, vector, slot)) {
+                    rdb_column_summary_add(summary, vector->bools[slot]);
+                }
+            }
+            break;
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT:
+            for (size_t slot = 0; slot < count; slot++) {
+                summary->value_count += RDB_SLOT_HAS_VALUE(group, vector, slot);
+            }
+            break;
+    }
+    return true;
+}
+
+int rdb_column_summarize(rdb_table_t *table, const char *column_name, rdb_column_summary_t *summary) {
+    if (!table || !column_name || !summary) return -1;
+
+    if (!table->column_store) {
+        printf("Error: Table '%s' does not use columnar storage\n", table->name);
+        return -1;
+    }
+
+    int column = rdb_get_column_index(table, column_name);
+    if (column < 0) {
+        printf("Error: Column '%s' does not exist in table '%s'\n", column_name, table->name);
+        return -1;
+    }
+
+    rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, column);
+    memset(summary, 0, sizeof(*summary));
+    summary->type = col->type;
+
+    rdb_column_summary_scan_t scan = {column, summary};
+    rdb_column_store_scan(table, rdb_column_summary_visit, &scan);
+    return 0;
+}
+
+/* Table operations - switch between row and columnar storage */
+int rdb_set_table_storage(rdb_database_t *db, const char *table_name, rdb_storage_mode_t mode) {
+    if (!db || !table_name) return -1;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return -1;
+    }
+
+    if (mode == RDB_STORAGE_COLUMNAR && !table->column_store) {
+        table->column_store = rdb_column_store_create(table);
+        if (!table->column_store) {
+            printf("Error: Failed to build column store for table '%s'\n", table_name);
+            return -1;
+        }
+    } else if (mode == RDB_STORAGE_ROW && table->column_store) {
+        rdb_column_store_destroy(table->column_store);
+        table->column_store = NULL;
+    }
+
+    table->storage = mode;
+    printf("Table '%s' uses %s storage\n", table_name, mode == RDB_STORAGE_COLUMNAR ? "columnar" : "row");
+    return 0;
+}
@@ -314,6 +314,7 @@ rdb_column_t* create_column(const char *name, rdb_data_type_t type, bool primary
     column->unique = unique;
     column->nullable = nullable;
     column->default_value[0] = '\0';
+    column->dictionary = false;
     
     return column;
 }
@@ -0,0 +1,297 @@
+#include "rdb.h"
+#include "sql_parser.h"
+
+/* Column dictionaries
+ *
+ * A dictionary-encoded VARCHAR/TEXT column keeps every distinct string once,
+ * as an rdb_string_t entry tagged with the dictionary and a dense code. Cells
+ * reference the entry instead of owning a copy, so a low-cardinality column
+ * costs one buffer per distinct value, and two cells of the column are equal
+ * exactly when they reference the same entry. Codes give entries a compact
+ * identity on disk.
+ *
+ * Entries are append-only: a string stays in the dictionary after the last
+ * row using it is gone, until the dictionaries are rebuilt (DROP COLUMN, or
+ * turning the encoding off and on again). */
+
+rdb_string_dict_t* rdb_string_dict_create(void) {
+    rdb_string_dict_t *dict = malloc(sizeof(rdb_string_dict_t));
+    if (!dict) return NULL;
+
+    dict->codes = fi_map_create(64, sizeof(char*), sizeof(rdb_string_t*),
+                                fi_map_hash_string, fi_map_compare_string);
+    dict->entries = fi_array_create(64, sizeof(rdb_string_t*));
+    if (!dict->codes || !dict->entries) {
+        if (dict->codes) fi_map_destroy(dict->codes);
+        if (dict->entries) fi_array_destroy(dict->entries);
+        free(dict);
+        return NULL;
+    }
+
+    return dict;
+}
+
+/* Entries still referenced by values outlive the dictionary as plain strings */
+void rdb_string_dict_destroy(rdb_string_dict_t *dict) {
+    if (!dict) return;
+
+    for (size_t i = 0; i < fi_array_count(dict->entries); i++) {
+        rdb_string_t *entry = *(rdb_string_t**)fi_array_get(dict->entries, i);
+        entry->dict = NULL;
+        rdb_string_release(entry);
+    }
+
+    fi_map_destroy(dict->codes);
+    fi_array_destroy(dict->entries);
+    free(dict);
+}
+
+const rdb_string_t* rdb_string_dict_find(const rdb_string_dict_t *dict, const char *text) {
+    if (!dict || !text) return NULL;
+
+    rdb_string_t *entry = NULL;
+    if (fi_map_get(dict->codes, &text, &entry) != 0) return NULL;
+    return entry;
+}
+
+/* Entry for `text`, added with the next code if it is new */
+rdb_string_t* rdb_string_dict_add(rdb_string_dict_t *dict, const char *text, size_t length) {
+    if (!dict || !text) return NULL;
+
+    rdb_string_t *entry = (rdb_string_t*)rdb_string_dict_find(dict, text);
+    if (entry) return entry;
+
+    size_t code = fi_array_count(dict->entries);
+    if (code >= UINT32_MAX) {
+        printf("Error: Column dictionary is full\n");
+        return NULL;
+    }
+
+    entry = rdb_string_create(text, length);
+    if (!entry) return NULL;
+
+    entry->dict = dict;
+    entry->code = (uint32_t)code;
+
+    const char *key = entry->data;
+    if (fi_array_push(dict->entries, &entry) != 0) {
+        rdb_string_release(entry);
+        return NULL;
+    }
+    if (fi_map_put(dict->codes, &key, &entry) != 0) {
+        fi_array_pop(dict->entries, NULL);
+        rdb_string_release(entry);
+        return NULL;
+    }
+
+    return entry;
+}
+
+const rdb_string_t* rdb_string_dict_entry(const rdb_string_dict_t *dict, uint32_t code) {
+    if (!dict || code >= fi_array_count(dict->entries)) return NULL;
+    return *(rdb_string_t**)fi_array_get(dict->entries, code);
+}
+
+size_t rdb_string_dict_count(const rdb_string_dict_t *dict) {
+    return dict ? fi_array_count(dict->entries) : 0;
+}
+
+static bool rdb_dict_is_string_value(const rdb_value_t *value) {
+    return value && !value->is_null &&
+           (value->type == RDB_TYPE_VARCHAR || value->type == RDB_TYPE_TEXT);
+}
+
+static bool rdb_dict_references(const rdb_string_dict_t *dict, const rdb_value_t *value) {
+    return value->str_len == RDB_VALUE_SHARED_STRING && value->data.string_ref->dict == dict;
+}
+
+/* Point a string value at `entry`, dropping its own storage */
+static void rdb_dict_reference_entry(rdb_value_t *value, rdb_string_t *entry) {
+    if (value->str_len == RDB_VALUE_SHARED_STRING) {
+        rdb_string_release(value->data.string_ref);
+    }
+    value->str_len = RDB_VALUE_SHARED_STRING;
+    value->data.string_ref = rdb_string_retain(entry);
+}
+
+/* Re-encode a string value in place to reference its dictionary entry */
+int rdb_string_dict_intern(rdb_string_dict_t *dict, rdb_value_t *value) {
+    if (!dict || !rdb_dict_is_string_value(value)) return 0;
+    if (rdb_dict_references(dict, value)) return 0;
+
+    rdb_string_t *entry = rdb_string_dict_add(dict, rdb_get_string_value(value),
+                                              rdb_get_string_length(value));
+    if (!entry) return -1;
+
+    rdb_dict_reference_entry(value, entry);
+    return 0;
+}
+
+/* Give a value referencing `dict` storage of its own again */
+static void rdb_dict_detach_value(const rdb_string_dict_t *dict, rdb_value_t *value) {
+    if (!rdb_dict_is_string_value(value) || !rdb_dict_references(dict, value)) return;
+
+    rdb_string_t *entry = value->data.string_ref;
+    rdb_value_t *plain = rdb_create_string_value_n(entry->data, entry->length);
+    if (!plain) return; /* Keeps the entry, which stays valid on its own */
+
+    uint8_t type = value->type;
+    memcpy(value, plain, sizeof(rdb_value_t));
+    value->type = type;
+    free(plain);
+    rdb_string_release(entry);
+}
+
+rdb_string_dict_t* rdb_table_column_dictionary(const rdb_table_t *table, size_t column) {
+    if (!table || !table->dictionaries || column >= fi_array_count(table->dictionaries)) return NULL;
+    return *(rdb_string_dict_t**)fi_array_get(table->dictionaries, column);
+}
+
+/* Run the cells of `column` through `dict` (interning) or out of it */
+static void rdb_dict_recode_column(rdb_table_t *table, size_t column, rdb_string_dict_t *dict,
+                                   bool intern) {
+    for (size_t i = 0; table->rows && i < fi_array_count(table->rows); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (!row || !row->values || column >= fi_array_count(row->values)) continue;
+
+        rdb_value_t *value = *(rdb_value_t**)fi_array_get(row->values, column);
+        if (intern) {
+            rdb_string_dict_intern(dict, value);
+        } else {
+            rdb_dict_detach_value(dict, value);
+        }
+    }
+}
+
+/* Bring the per-column dictionaries in line with the column definitions:
+ * build (and fill) one for each newly encoded column, and decode and drop
+ * those of columns no longer encoded. Called after the schema changes. */
+int rdb_table_init_dictionaries(rdb_table_t *table) {
+    if (!table || !table->columns) return -1;
+
+    size_t column_count = fi_array_count(table->columns);
+    bool any = false;
+    for (size_t i = 0; i < column_count; i++) {
+        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
+        if (col->dictionary && col->type != RDB_TYPE_VARCHAR && col->type != RDB_TYPE_TEXT) {
+            col->dictionary = false;
+        }
+        any = any || col->dictionary;
+    }
+    if (!any && !table->dictionaries) return 0;
+
+    if (!table->dictionaries) {
+        table->dictionaries = fi_array_create(column_count, sizeof(rdb_string_dict_t*));
+        if (!table->dictionaries) return -1;
+    }
+    while (fi_array_count(table->dictionaries) < column_count) {
+        rdb_string_dict_t *none = NULL;
+        if (fi_array_push(table->dictionaries, &none) != 0) return -1;
+    }
+
+    for (size_t i = 0; i < column_count; i++) {
+        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
+        rdb_string_dict_t *dict = rdb_table_column_dictionary(table, i);
+
+        if (col->dictionary && !dict) {
+            dict = rdb_string_dict_create();
+            if (!dict) return -1;
+            fi_array_set(table->dictionaries, i, &dict);
+            rdb_dict_recode_column(table, i, dict, true);
+        } else if (!col->dictionary && dict) {
+            rdb_dict_recode_column(table, i, dict, false);
+            rdb_string_dict_destroy(dict);
+            dict = NULL;
+            fi_array_set(table->dictionaries, i, &dict);
+        }
+    }
+
+    if (!any) {
+        fi_array_destroy(table->dictionaries);
+        table->dictionaries = NULL;
+    }
+    return 0;
+}
+
+void rdb_table_destroy_dictionaries(rdb_table_t *table) {
+    if (!table || !table->dictionaries) return;
+
+    for (size_t i = 0; i < fi_array_count(table->dictionaries); i++) {
+        rdb_string_dict_destroy(*(rdb_string_dict_t**)fi_array_get(table->dictionaries, i));
+    }
+    fi_array_destroy(table->dictionaries);
+    table->dictionaries = NULL;
+}
+
+/* Encode the cells of a row added to or changed in the table */
+void rdb_table_intern_row(rdb_table_t *table, rdb_row_t *row) {
+    if (!table || !table->dictionaries || !row || !row->values) return;
+
+    size_t count = fi_array_count(row->values);
+    if (count > fi_array_count(table->dictionaries)) count = fi_array_count(table->dictionaries);
+
+    for (size_t i = 0; i < count; i++) {
+        rdb_string_dict_t *dict = *(rdb_string_dict_t**)fi_array_get(table->dictionaries, i);
+        if (dict) rdb_string_dict_intern(dict, *(rdb_value_t**)fi_array_get(row->values, i));
+    }
+}
+
+/* Point = and != literals on encoded columns at their dictionary entries so
+ * the scan compares entries instead of text. Literals absent from the
+ * dictionary are left alone: no cell can equal them. */
+void rdb_bind_dictionary_conditions(rdb_table_t *table, fi_array *where_conditions) {
+    if (!table || !table->dictionaries || !where_conditions) return;
+
+    for (size_t i = 0; i < fi_array_count(where_conditions); i++) {
+        sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(where_conditions, i);
+        if (!cond || (cond->operator != SQL_OP_EQUAL && cond->operator != SQL_OP_NOT_EQUAL)) continue;
+        if (!rdb_dict_is_string_value(cond->value)) continue;
+
+        int col_index = rdb_get_column_index(table, cond->column_name);
+        if (col_index < 0) continue;
+
+        rdb_string_dict_t *dict = rdb_table_column_dictionary(table, col_index);
+        if (!dict || rdb_dict_references(dict, cond->value)) continue;
+
+        rdb_string_t *entry = (rdb_string_t*)rdb_string_dict_find(dict, rdb_get_string_value(cond->value));
+        if (entry) rdb_dict_reference_entry(cond->value, entry);
+    }
+}
+
+int rdb_set_column_dictionary(rdb_database_t *db, const char *table_name, const char *column_name,
+                              bool enabled) {
+    if (!db || !table_name || !column_name) return -1;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return -1;
+    }
+
+    int col_index = rdb_get_column_index(table, column_name);
+    if (col_index < 0) {
+        printf("Error: Column '%s' does not exist in table '%s'\n", column_name, table_name);
+        return -1;
+    }
+
+    rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, col_index);
+    if (enabled && col->type != RDB_TYPE_VARCHAR && col->type != RDB_TYPE_TEXT) {
+        printf("Error: Dictionary encoding requires a VARCHAR or TEXT column\n");
+        return -1;
+    }
+
+    if (rdb_lock_table_write(table) != 0) return -1;
+
+    col->dictionary = enabled;
+    int result = rdb_table_init_dictionaries(table);
+
+    rdb_unlock_table(table);
+
+    if (result != 0) {
+        printf("Error: Failed to build dictionary for column '%s'\n", column_name);
+        return -1;
+    }
+    printf("Column '%s' of table '%s' %s dictionary encoding\n", column_name, table_name,
+           enabled ? "uses" : "no longer uses");
+    return 0;
+}
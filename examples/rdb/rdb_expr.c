@@ -0,0 +1,1180 @@
+#include "rdb.h"
+#include "sql_parser.h"
+#include <ctype.h>
+#include <math.h>
+#include <strings.h>  /* for strcasecmp */
+
+/* Expressions
+ *
+ * WHERE and SET clauses that do not fit the flat `column op literal` form
+ * are parsed into an rdb_expr_t tree. Before a statement runs, the tree is
+ * compiled against the table into a short stack-machine program: column
+ * names become ordinals, literals become constants, and operators whose
+ * operand types are known from the schema get type-specialized opcodes
+ * (integer add, double compare, a fused column-against-constant compare).
+ * A specialized opcode checks the tags of its operands and drops to the
+ * generic code when a row holds a value of another type, so rows that do
+ * not follow the schema still evaluate correctly.
+ *
+ * Logic is three-valued: comparisons and arithmetic involving NULL yield
+ * NULL, AND/OR follow SQL rules and short-circuit, and a WHERE expression
+ * keeps a row only when it evaluates to TRUE. Division by zero yields NULL.
+ *
+ * Stack slots hold rdb_value_t copies. Values loaded from the row or the
+ * constant pool are borrowed; strings produced by functions are owned by
+ * their slot and released when it is consumed. */
+
+/* Bytecode */
+typedef enum {
+    RDB_VM_LOAD_COLUMN = 1,     /* push row[column] */
+    RDB_VM_LOAD_CONST,          /* push constants[operand] */
+    RDB_VM_ADD_INT,             /* INT arithmetic */
+    RDB_VM_SUB_INT,
+    RDB_VM_MUL_INT,
+    RDB_VM_DIV_INT,
+    RDB_VM_MOD_INT,
+    RDB_VM_ADD_FLOAT,           /* Numeric arithmetic in doubles */
+    RDB_VM_SUB_FLOAT,
+    RDB_VM_MUL_FLOAT,
+    RDB_VM_DIV_FLOAT,
+    RDB_VM_ARITH,               /* Arithmetic on values of unknown type, aux = operator */
+    RDB_VM_NEG,
+    RDB_VM_CMP_INT,             /* Comparisons, aux = operator */
+    RDB_VM_CMP_FLOAT,
+    RDB_VM_CMP,
+    RDB_VM_CMP_COLUMN_INT,      /* push row[column] <aux> constants[operand], INT column and constant */
+    RDB_VM_CMP_COLUMN_FLOAT,    /* The same for a numeric column against a numeric constant */
+    RDB_VM_LIKE,
+    RDB_VM_IS_NULL,
+    RDB_VM_IS_NOT_NULL,
+    RDB_VM_NOT,
+    RDB_VM_AND,
+    RDB_VM_OR,
+    RDB_VM_JUMP_IF_FALSE,       /* Jump to operand, keeping the top, when it is FALSE */
+    RDB_VM_JUMP_IF_TRUE,        /* Jump to operand, keeping the top, when it is TRUE */
+    RDB_VM_CALL                 /* Function operand over the top aux values */
+} rdb_vm_opcode_t;
+
+/* Built-in functions */
+typedef enum {
+    RDB_FN_ABS = 1,
+    RDB_FN_LENGTH,
+    RDB_FN_LOWER,
+    RDB_FN_UPPER,
+    RDB_FN_COALESCE
+} rdb_function_id_t;
+
+static const struct {
+    const char *name;
+    rdb_function_id_t id;
+    size_t min_args;
+    size_t max_args;
+} rdb_functions[] = {
+    {"ABS", RDB_FN_ABS, 1, 1},
+    {"LENGTH", RDB_FN_LENGTH, 1, 1},
+    {"LOWER", RDB_FN_LOWER, 1, 1},
+    {"UPPER", RDB_FN_UPPER, 1, 1},
+    {"COALESCE", RDB_FN_COALESCE, 1, RDB_EXPR_MAX_STACK / 2}
+};
+
+/* Static type of a compiled subexpression; -1 when unknown */
+#define RDB_EXPR_TYPE_UNKNOWN (-1)
+
+/* ===== EXPRESSION TREES ===== */
+
+static rdb_expr_t* rdb_expr_alloc(rdb_expr_kind_t kind, size_t arg_count) {
+    rdb_expr_t *expr = calloc(1, sizeof(rdb_expr_t));
+    if (!expr) return NULL;
+
+    expr->kind = kind;
+    if (arg_count > 0) {
+        expr->args = calloc(arg_count, sizeof(rdb_expr_t*));
+        if (!expr->args) {
+            free(expr);
+            return NULL;
+        }
+        expr->arg_count = arg_count;
+    }
+    return expr;
+}
+
+/* Literal node; takes ownership of `value` */
+rdb_expr_t* rdb_expr_create_literal(rdb_value_t *value) {
+    if (!value) return NULL;
+
+    rdb_expr_t *expr = rdb_expr_alloc(RDB_EXPR_LITERAL, 0);
+    if (!expr) {
+        rdb_value_free(value);
+        return NULL;
+    }
+    expr->value = value;
+    return expr;
+}
+
+rdb_expr_t* rdb_expr_create_column(const char *column_name) {
+    if (!column_name) return NULL;
+
+    rdb_expr_t *expr = rdb_expr_alloc(RDB_EXPR_COLUMN, 0);
+    if (!expr) return NULL;
+
+    strncpy(expr->name, column_name, sizeof(expr->name) - 1);
+    return expr;
+}
+
+/* Unary node; takes ownership of `operand`, freeing it on failure */
+rdb_expr_t* rdb_expr_create_unary(rdb_expr_op_t op, rdb_expr_t *operand) {
+    if (!operand) return NULL;
+
+    rdb_expr_t *expr = rdb_expr_alloc(RDB_EXPR_UNARY, 1);
+    if (!expr) {
+        rdb_expr_free(operand);
+        return NULL;
+    }
+    expr->op = op;
+    expr->args[0] = operand;
+    return expr;
+}
+
+/* Binary node; takes ownership of both operands, freeing them on failure */
+rdb_expr_t* rdb_expr_create_binary(rdb_expr_op_t op, rdb_expr_t *left, rdb_expr_t *right) {
+    rdb_expr_t *expr = left && right ? rdb_expr_alloc(RDB_EXPR_BINARY, 2) : NULL;
+    if (!expr) {
+        rdb_expr_free(left);
+        rdb_expr_free(right);
+        return NULL;
+    }
+    expr->op = op;
+    expr->args[0] = left;
+    expr->args[1] = right;
+    return expr;
+}
+
+/* Function call; takes ownership of the rdb_expr_t* in `args` (which may
+ * be NULL for no arguments) and frees them on failure */
+rdb_expr_t* rdb_expr_create_function(const char *name, fi_array *args) {
+    size_t arg_count = args ? fi_array_count(args) : 0;
+    rdb_expr_t *expr = name ? rdb_expr_alloc(RDB_EXPR_FUNCTION, arg_count) : NULL;
+    if (!expr) {
+        for (size_t i = 0; i < arg_count; i++) {
+            rdb_expr_free(*(rdb_expr_t**)fi_array_get(args, i));
+        }
+        return NULL;
+    }
+
+    strncpy(expr->name, name, sizeof(expr->name) - 1);
+    for (size_t i = 0; i < arg_count; i++) {
+        expr->args[i] = *(rdb_expr_t**)fi_array_get(args, i);
+    }
+    return expr;
+}
+
+void rdb_expr_free(rdb_expr_t *expr) {
+    if (!expr) return;
+
+    for (size_t i = 0; i < expr->arg_count; i++) {
+        rdb_expr_free(expr->args[i]);
+    }
+    free(expr->args);
+    rdb_value_free(expr->value);
+    free(expr);
+}
+
+rdb_expr_t* rdb_expr_copy(const rdb_expr_t *expr) {
+    if (!expr) return NULL;
+
+    rdb_expr_t *copy = rdb_expr_alloc(expr->kind, expr->arg_count);
+    if (!copy) return NULL;
+
+    copy->op = expr->op;
+    memcpy(copy->name, expr->name, sizeof(copy->name));
+    if (expr->value && !(copy->value = rdb_value_copy(expr->value))) {
+        rdb_expr_free(copy);
+        return NULL;
+    }
+    for (size_t i = 0; i < expr->arg_count; i++) {
+        if (!(copy->args[i] = rdb_expr_copy(expr->args[i]))) {
+            rdb_expr_free(copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+/* ===== COMPILER ===== */
+
+typedef struct {
+    rdb_table_t *table;
+    rdb_program_t *program;
+    size_t code_capacity;
+    size_t constant_capacity;
+    size_t depth;               /* Stack depth at the current instruction */
+} rdb_compiler_t;
+
+static bool rdb_expr_type_numeric(int type) {
+    return type == RDB_TYPE_INT || type == RDB_TYPE_FLOAT;
+}
+
+static bool rdb_expr_is_comparison(rdb_expr_op_t op) {
+    return op >= RDB_EXPR_OP_EQ && op <= RDB_EXPR_OP_GE;
+}
+
+/* The comparison that holds with the operands swapped */
+static rdb_expr_op_t rdb_expr_swap_comparison(rdb_expr_op_t op) {
+    switch (op) {
+        case RDB_EXPR_OP_LT: return RDB_EXPR_OP_GT;
+        case RDB_EXPR_OP_GT: return RDB_EXPR_OP_LT;
+        case RDB_EXPR_OP_LE: return RDB_EXPR_OP_GE;
+        case RDB_EXPR_OP_GE: return RDB_EXPR_OP_LE;
+        default: return op;
+    }
+}
+
+/* Append an instruction, tracking the stack depth it leaves. Returns its
+ * address, or -1. */
+static int rdb_compiler_emit(rdb_compiler_t *c, rdb_vm_opcode_t opcode, uint8_t aux, int column,
+                             int32_t operand, int stack_effect) {
+    rdb_program_t *program = c->program;
+    if (program->length == c->code_capacity) {
+        size_t capacity = c->code_capacity ? c->code_capacity * 2 : 16;
+        rdb_instruction_t *code = realloc(program->code, capacity * sizeof(rdb_instruction_t));
+        if (!code) return -1;
+        program->code = code;
+        c->code_capacity = capacity;
+    }
+
+    c->depth = (size_t)((long)c->depth + stack_effect);
+    if (c->depth > RDB_EXPR_MAX_STACK) {
+        printf("Error: Expression is too deeply nested\n");
+        return -1;
+    }
+    if (c->depth > program->stack_depth) program->stack_depth = c->depth;
+
+    rdb_instruction_t *instruction = &program->code[program->length];
+    instruction->opcode = (uint8_t)opcode;
+    instruction->aux = aux;
+    instruction->column = (uint16_t)(column > 0 ? column : 0);
+    instruction->operand = operand;
+    return (int)program->length++;
+}
+
+/* Add a literal to the constant pool. Returns its index, or -1. */
+static int rdb_compiler_constant(rdb_compiler_t *c, const rdb_value_t *value) {
+    rdb_program_t *program = c->program;
+    if (program->constant_count == c->constant_capacity) {
+        size_t capacity = c->constant_capacity ? c->constant_capacity * 2 : 4;
+        rdb_value_t *constants = realloc(program->constants, capacity * sizeof(rdb_value_t));
+        if (!constants) return -1;
+        program->constants = constants;
+        c->constant_capacity = capacity;
+    }
+
+    rdb_value_t *slot = &program->constants[program->constant_count];
+    memcpy(slot, value, sizeof(rdb_value_t));
+    if (slot->str_len == RDB_VALUE_SHARED_STRING) {
+        rdb_string_retain(slot->data.string_ref);
+    }
+    return (int)program->constant_count++;
+}
+
+static int rdb_compile_node(rdb_compiler_t *c, const rdb_expr_t *expr, int *type);
+
+static int rdb_compile_column(rdb_compiler_t *c, const rdb_expr_t *expr, int *type) {
+    int col_index = rdb_get_column_index(c->table, expr->name);
+    if (col_index < 0 || col_index > UINT16_MAX) {
+        printf("Error: Column '%s' does not exist in table '%s'\n", expr->name, c->table->name);
+        return -1;
+    }
+
+    rdb_column_t *column = *(rdb_column_t**)fi_array_get(c->table->columns, col_index);
+    *type = column->type;
+    return rdb_compiler_emit(c, RDB_VM_LOAD_COLUMN, 0, col_index, 0, 1) < 0 ? -1 : 0;
+}
+
+/* `column op literal` on numbers compiles to one fused instruction */
+static bool rdb_compile_fused_comparison(rdb_compiler_t *c, const rdb_expr_t *expr, int *result) {
+    const rdb_expr_t *column = expr->args[0];
+    const rdb_expr_t *literal = expr->args[1];
+    rdb_expr_op_t op = expr->op;
+    if (column->kind == RDB_EXPR_LITERAL && literal->kind == RDB_EXPR_COLUMN) {
+        column = expr->args[1];
+        literal = expr->args[0];
+        op = rdb_expr_swap_comparison(op);
+    }
+    if (column->kind != RDB_EXPR_COLUMN || literal->kind != RDB_EXPR_LITERAL) return false;
+    if (!literal->value || literal->value->is_null || !rdb_expr_type_numeric(literal->value->type)) return false;
+
+    int col_index = rdb_get_column_index(c->table, column->name);
+    if (col_index < 0 || col_index > UINT16_MAX) return false;
+    rdb_column_t *col = *(rdb_column_t**)fi_array_get(c->table->columns, col_index);
+    if (!rdb_expr_type_numeric(col->type)) return false;
+
+    rdb_vm_opcode_t opcode = col->type == RDB_TYPE_INT && literal->value->type == RDB_TYPE_INT
+                             ? RDB_VM_CMP_COLUMN_INT : RDB_VM_CMP_COLUMN_FLOAT;
+    int constant = rdb_compiler_constant(c, literal->value);
+    *result = constant < 0 || rdb_compiler_emit(c, opcode, (uint8_t)op, col_index, constant, 1) < 0 ? -1 : 0;
+    return true;
+}
+
+static int rdb_compile_binary(rdb_compiler_t *c, const rdb_expr_t *expr, int *type) {
+    rdb_expr_op_t op = expr->op;
+
+    /* AND/OR skip their right side once the left one decides */
+    if (op == RDB_EXPR_OP_AND || op == RDB_EXPR_OP_OR) {
+        int ignored;
+        if (rdb_compile_node(c, expr->args[0], &ignored) != 0) return -1;
+        int jump = rdb_compiler_emit(c, op == RDB_EXPR_OP_AND ? RDB_VM_JUMP_IF_FALSE : RDB_VM_JUMP_IF_TRUE,
+                                     0, 0, 0, 0);
+        if (jump < 0 || rdb_compile_node(c, expr->args[1], &ignored) != 0) return -1;
+        if (rdb_compiler_emit(c, op == RDB_EXPR_OP_AND ? RDB_VM_AND : RDB_VM_OR, 0, 0, 0, -1) < 0) return -1;
+        c->program->code[jump].operand = (int32_t)c->program->length;
+        *type = RDB_TYPE_BOOLEAN;
+        return 0;
+    }
+
+    if (rdb_expr_is_comparison(op)) {
+        int result;
+        *type = RDB_TYPE_BOOLEAN;
+        if (rdb_compile_fused_comparison(c, expr, &result)) return result;
+    }
+
+    int left, right;
+    if (rdb_compile_node(c, expr->args[0], &left) != 0 ||
+        rdb_compile_node(c, expr->args[1], &right) != 0) {
+        return -1;
+    }
+
+    bool ints = left == RDB_TYPE_INT && right == RDB_TYPE_INT;
+    bool numbers = rdb_expr_type_numeric(left) && rdb_expr_type_numeric(right);
+    rdb_vm_opcode_t opcode;
+
+    if (rdb_expr_is_comparison(op)) {
+        opcode = ints ? RDB_VM_CMP_INT : numbers ? RDB_VM_CMP_FLOAT : RDB_VM_CMP;
+    } else if (op == RDB_EXPR_OP_LIKE) {
+        opcode = RDB_VM_LIKE;
+        *type = RDB_TYPE_BOOLEAN;
+    } else {
+        static const rdb_vm_opcode_t int_ops[] = {RDB_VM_ADD_INT, RDB_VM_SUB_INT, RDB_VM_MUL_INT,
+                                                  RDB_VM_DIV_INT, RDB_VM_MOD_INT};
+        static const rdb_vm_opcode_t float_ops[] = {RDB_VM_ADD_FLOAT, RDB_VM_SUB_FLOAT,
+                                                    RDB_VM_MUL_FLOAT, RDB_VM_DIV_FLOAT, RDB_VM_ARITH};
+        size_t slot = (size_t)(op - RDB_EXPR_OP_ADD);
+        if (op < RDB_EXPR_OP_ADD || op > RDB_EXPR_OP_MOD) {
+            printf("Error: Invalid binary operator in expression\n");
+            return -1;
+        }
+        opcode = ints ? int_ops[slot] : numbers ? float_ops[slot] : RDB_VM_ARITH;
+        *type = ints ? RDB_TYPE_INT : numbers ? RDB_TYPE_FLOAT : RDB_EXPR_TYPE_UNKNOWN;
+    }
+
+    return rdb_compiler_emit(c, opcode, (uint8_t)op, 0, 0, -1) < 0 ? -1 : 0;
+}
+
+static int rdb_compile_unary(rdb_compiler_t *c, const rdb_expr_t *expr, int *type) {
+    int operand;
+    if (rdb_compile_node(c, expr->args[0], &operand) != 0) return -1;
+
+    rdb_vm_opcode_t opcode;
+    switch (expr->op) {
+        case RDB_EXPR_OP_NOT:
+            opcode = RDB_VM_NOT;
+            *type = RDB_TYPE_BOOLEAN;
+            break;
+        case RDB_EXPR_OP_NEG:
+            opcode = RDB_VM_NEG;
+            *type = rdb_expr_type_numeric(operand) ? operand : RDB_EXPR_TYPE_UNKNOWN;
+            break;
+        case RDB_EXPR_OP_IS_NULL:
+            opcode = RDB_VM_IS_NULL;
+            *type = RDB_TYPE_BOOLEAN;
+            break;
+        case RDB_EXPR_OP_IS_NOT_NULL:
+            opcode = RDB_VM_IS_NOT_NULL;
+            *type = RDB_TYPE_BOOLEAN;
+            break;
+        default:
+            printf("Error: Invalid unary operator in expression\n");
+            return -1;
+    }
+    return rdb_compiler_emit(c, opcode, 0, 0, 0, 0) < 0 ? -1 : 0;
+}
+
+static int rdb_compile_function(rdb_compiler_t *c, const rdb_expr_t *expr, int *type) {
+    size_t f = 0;
+    size_t function_count = sizeof(rdb_functions) / sizeof(rdb_functions[0]);
+    while (f < function_count && strcasecmp(rdb_functions[f].name, expr->name) != 0) f++;
+    if (f == function_count) {
+        printf("Error: Unknown function '%s'\n", expr->name);
+        return -1;
+    }
+    if (expr->arg_count < rdb_functions[f].min_args || expr->arg_count > rdb_functions[f].max_args) {
+        printf("Error: Wrong number of arguments to function '%s'\n", rdb_functions[f].name);
+        return -1;
+    }
+
+    int first = RDB_EXPR_TYPE_UNKNOWN;
+    for (size_t i = 0; i < expr->arg_count; i++) {
+        int arg_type;
+        if (rdb_compile_node(c, expr->args[i], &arg_type) != 0) return -1;
+        if (i == 0) first = arg_type;
+    }
+
+    switch (rdb_functions[f].id) {
+        case RDB_FN_ABS:    *type = rdb_expr_type_numeric(first) ? first : RDB_EXPR_TYPE_UNKNOWN; break;
+        case RDB_FN_LENGTH: *type = RDB_TYPE_INT; break;
+        case RDB_FN_LOWER:
+        case RDB_FN_UPPER:  *type = RDB_TYPE_VARCHAR; break;
+        default:            *type = RDB_EXPR_TYPE_UNKNOWN; break;
+    }
+    return rdb_compiler_emit(c, RDB_VM_CALL, (uint8_t)expr->arg_count, 0, rdb_functions[f].id,
+                             1 - (int)expr->arg_count) < 0 ? -1 : 0;
+}
+
+static int rdb_compile_node(rdb_compiler_t *c, const rdb_expr_t *expr, int *type) {
+    *type = RDB_EXPR_TYPE_UNKNOWN;
+    if (!expr) return -1;
+
+    switch (expr->kind) {
+        case RDB_EXPR_LITERAL: {
+            if (!expr->value) return -1;
+            if (!expr->value->is_null) *type = expr->value->type;
+            int constant = rdb_compiler_constant(c, expr->value);
+            return constant < 0 || rdb_compiler_emit(c, RDB_VM_LOAD_CONST, 0, 0, constant, 1) < 0 ? -1 : 0;
+        }
+        case RDB_EXPR_COLUMN:
+            return rdb_compile_column(c, expr, type);
+        case RDB_EXPR_UNARY:
+            return expr->arg_count == 1 ? rdb_compile_unary(c, expr, type) : -1;
+        case RDB_EXPR_BINARY:
+            return expr->arg_count == 2 ? rdb_compile_binary(c, expr, type) : -1;
+        case RDB_EXPR_FUNCTION:
+            return rdb_compile_function(c, expr, type);
+    }
+    return -1;
+}
+
+/* Compile `expr` against the schema of `table` */
+rdb_program_t* rdb_expr_compile(rdb_table_t *table, const rdb_expr_t *expr) {
+    if (!table || !expr) return NULL;
+
+    rdb_program_t *program = calloc(1, sizeof(rdb_program_t));
+    if (!program) return NULL;
+
+    rdb_compiler_t compiler = {0};
+    compiler.table = table;
+    compiler.program = program;
+
+    int type;
+    if (rdb_compile_node(&compiler, expr, &type) != 0) {
+        rdb_program_free(program);
+        return NULL;
+    }
+    return program;
+}
+
+void rdb_program_free(rdb_program_t *program) {
+    if (!program) return;
+
+    for (size_t i = 0; i < program->constant_count; i++) {
+        rdb_value_t *constant = &program->constants[i];
+        if (constant->str_len == RDB_VALUE_SHARED_STRING) {
+            rdb_string_release(constant->data.string_ref);
+        }
+    }
+    free(program->constants);
+    free(program->code);
+    free(program);
+}
+
+/* ===== VIRTUAL MACHINE ===== */
+
+typedef struct {
+    rdb_value_t slots[RDB_EXPR_MAX_STACK];
+    bool owned[RDB_EXPR_MAX_STACK];     /* Slot holds a string reference of its own */
+    size_t top;                         /* Number of slots in use */
+} rdb_vm_stack_t;
+
+static void rdb_vm_release(rdb_vm_stack_t *stack, size_t slot) {
+    if (stack->owned[slot]) {
+        rdb_string_release(stack->slots[slot].data.string_ref);
+        stack->owned[slot] = false;
+    }
+}
+
+static void rdb_vm_set_null(rdb_vm_stack_t *stack, size_t slot) {
+    rdb_vm_release(stack, slot);
+    rdb_value_t *value = &stack->slots[slot];
+    value->type = RDB_TYPE_INT;
+    value->is_null = true;
+    value->str_len = 0;
+    value->data.int_val = 0;
+}
+
+static void rdb_vm_set_int(rdb_vm_stack_t *stack, size_t slot, int64_t v) {
+    rdb_vm_release(stack, slot);
+    rdb_value_t *value = &stack->slots[slot];
+    value->type = RDB_TYPE_INT;
+    value->is_null = false;
+    value->str_len = 0;
+    value->data.int_val = v;
+}
+
+static void rdb_vm_set_float(rdb_vm_stack_t *stack, size_t slot, double v) {
+    rdb_vm_release(stack, slot);
+    rdb_value_t *value = &stack->slots[slot];
+    value->type = RDB_TYPE_FLOAT;
+    value->is_null = false;
+    value->str_len = 0;
+    value->data.float_val = v;
+}
+
+static void rdb_vm_set_bool(rdb_vm_stack_t *stack, size_t slot, bool v) {
+    rdb_vm_release(stack, slot);
+    rdb_value_t *value = &stack->slots[slot];
+    value->type = RDB_TYPE_BOOLEAN;
+    value->is_null = false;
+    value->str_len = 0;
+    value->data.int_val = 0;
+    value->data.bool_val = v;
+}
+
+/* Move a freshly created value into `slot`, taking over its string */
+static void rdb_vm_set_created(rdb_vm_stack_t *stack, size_t slot, rdb_value_t *created) {
+    if (!created) {
+        rdb_vm_set_null(stack, slot);
+        return;
+    }
+    rdb_vm_release(stack, slot);
+    stack->slots[slot] = *created;
+    stack->owned[slot] = created->str_len == RDB_VALUE_SHARED_STRING;
+    free(created);
+}
+
+/* Move slot `from` into slot `to` */
+static void rdb_vm_move(rdb_vm_stack_t *stack, size_t to, size_t from) {
+    if (to == from) return;
+    rdb_vm_release(stack, to);
+    stack->slots[to] = stack->slots[from];
+    stack->owned[to] = stack->owned[from];
+    stack->owned[from] = false;
+}
+
+static void rdb_vm_push(rdb_vm_stack_t *stack, const rdb_value_t *value) {
+    size_t slot = stack->top++;
+    stack->owned[slot] = false;
+    if (value) {
+        stack->slots[slot] = *value;
+    } else {
+        rdb_vm_set_null(stack, slot);
+    }
+}
+
+/* Truth value: 1 TRUE, 0 FALSE, -1 NULL (or not a truth value) */
+static int rdb_vm_truth(const rdb_value_t *value) {
+    if (value->is_null) return -1;
+    switch (value->type) {
+        case RDB_TYPE_BOOLEAN: return value->data.bool_val ? 1 : 0;
+        case RDB_TYPE_INT:     return value->data.int_val != 0;
+        case RDB_TYPE_FLOAT:   return value->data.float_val != 0.0;
+        default:               return -1;
+    }
+}
+
+static bool rdb_vm_comparison_holds(rdb_expr_op_t op, int cmp) {
+    switch (op) {
+        case RDB_EXPR_OP_EQ: return cmp == 0;
+        case RDB_EXPR_OP_NE: return cmp != 0;
+        case RDB_EXPR_OP_LT: return cmp < 0;
+        case RDB_EXPR_OP_GT: return cmp > 0;
+        case RDB_EXPR_OP_LE: return cmp <= 0;
+        case RDB_EXPR_OP_GE: return cmp >= 0;
+        default:             return false;
+    }
+}
+
+static int rdb_vm_compare_doubles(double a, double b) {
+    return (a > b) - (a < b);
+}
+
+/* a <op> b into slot `dst`, with the semantics of WHERE comparisons */
+static void rdb_vm_compare(rdb_vm_stack_t *stack, size_t dst, const rdb_value_t *a, const rdb_value_t *b,
+                           rdb_expr_op_t op) {
+    if (a->is_null || b->is_null) {
+        rdb_vm_set_null(stack, dst);
+        return;
+    }
+
+    bool comparable;
+    int cmp = rdb_condition_compare(a, b, &comparable);
+    if (comparable) {
+        rdb_vm_set_bool(stack, dst, rdb_vm_comparison_holds(op, cmp));
+    } else {
+        rdb_vm_set_null(stack, dst);
+    }
+}
+
+static double rdb_vm_number(const rdb_value_t *value) {
+    return value->type == RDB_TYPE_INT ? (double)value->data.int_val : value->data.float_val;
+}
+
+/* Integer arithmetic wraps around instead of overflowing */
+static bool rdb_vm_int_arith(rdb_expr_op_t op, int64_t a, int64_t b, int64_t *result) {
+    switch (op) {
+        case RDB_EXPR_OP_ADD: *result = (int64_t)((uint64_t)a + (uint64_t)b); return true;
+        case RDB_EXPR_OP_SUB: *result = (int64_t)((uint64_t)a - (uint64_t)b); return true;
+        case RDB_EXPR_OP_MUL: *result = (int64_t)((uint64_t)a * (uint64_t)b); return true;
+        case RDB_EXPR_OP_DIV:
+            if (b == 0) return false;
+            *result = b == -1 ? (int64_t)(0 - (uint64_t)a) : a / b;
+            return true;
+        case RDB_EXPR_OP_MOD:
+            if (b == 0) return false;
+            *result = b == -1 ? 0 : a % b;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool rdb_vm_float_arith(rdb_expr_op_t op, double a, double b, double *result) {
+    switch (op) {
+        case RDB_EXPR_OP_ADD: *result = a + b; return true;
+        case RDB_EXPR_OP_SUB: *result = a - b; return true;
+        case RDB_EXPR_OP_MUL: *result = a * b; return true;
+        case RDB_EXPR_OP_DIV:
+            if (b == 0.0) return false;
+            *result = a / b;
+            return true;
+        case RDB_EXPR_OP_MOD:
+            if (b == 0.0) return false;
+            *result = fmod(a, b);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* a <op> b into slot `dst` for operands of any type */
+static void rdb_vm_arith(rdb_vm_stack_t *stack, size_t dst, const rdb_value_t *a, const rdb_value_t *b,
+                         rdb_expr_op_t op) {
+    bool numbers = !a->is_null && !b->is_null &&
+                   rdb_expr_type_numeric(a->type) && rdb_expr_type_numeric(b->type);
+    if (!numbers) {
+        rdb_vm_set_null(stack, dst);
+        return;
+    }
+
+    if (a->type == RDB_TYPE_INT && b->type == RDB_TYPE_INT) {
+        int64_t result;
+        if (rdb_vm_int_arith(op, a->data.int_val, b->data.int_val, &result)) {
+            rdb_vm_set_int(stack, dst, result);
+        } else {
+            rdb_vm_set_null(stack, dst);
+        }
+        return;
+    }
+
+    double result;
+    if (rdb_vm_float_arith(op, rdb_vm_number(a), rdb_vm_number(b), &result)) {
+        rdb_vm_set_float(stack, dst, result);
+    } else {
+        rdb_vm_set_null(stack, dst);
+    }
+}
+
+static bool rdb_vm_is_string(const rdb_value_t *value) {
+    return !value->is_null && (value->type == RDB_TYPE_VARCHAR || value->type == RDB_TYPE_TEXT);
+}
+
+/* LOWER/UPPER of the string in `slot` */
+static void rdb_vm_change_case(rdb_vm_stack_t *stack, size_t slot, bool upper) {
+    const rdb_value_t *value = &stack->slots[slot];
+    if (!rdb_vm_is_string(value)) {
+        rdb_vm_set_null(stack, slot);
+        return;
+    }
+
+    size_t length = rdb_get_string_length(value);
+    const char *text = rdb_get_string_value(value);
+    char *buffer = malloc(length + 1);
+    if (!buffer) {
+        rdb_vm_set_null(stack, slot);
+        return;
+    }
+    for (size_t i = 0; i < length; i++) {
+        unsigned char ch = (unsigned char)text[i];
+        buffer[i] = (char)(upper ? toupper(ch) : tolower(ch));
+    }
+    buffer[length] = '\0';
+
+    rdb_vm_set_created(stack, slot, rdb_create_string_value_n(buffer, length));
+    free(buffer);
+}
+
+/* Call function `id` over the top `argc` slots, leaving the result in the
+ * first of them */
+static void rdb_vm_call(rdb_vm_stack_t *stack, rdb_function_id_t id, size_t argc) {
+    size_t base = stack->top - argc;
+    rdb_value_t *arg = &stack->slots[base];
+
+    switch (id) {
+        case RDB_FN_ABS:
+            if (!arg->is_null && arg->type == RDB_TYPE_INT) {
+                int64_t v = arg->data.int_val;
+                rdb_vm_set_int(stack, base, v < 0 ? (int64_t)(0 - (uint64_t)v) : v);
+            } else if (!arg->is_null && arg->type == RDB_TYPE_FLOAT) {
+                rdb_vm_set_float(stack, base, fabs(arg->data.float_val));
+            } else {
+                rdb_vm_set_null(stack, base);
+            }
+            break;
+
+        case RDB_FN_LENGTH:
+            if (rdb_vm_is_string(arg)) {
+                rdb_vm_set_int(stack, base, (int64_t)rdb_get_string_length(arg));
+            } else {
+                rdb_vm_set_null(stack, base);
+            }
+            break;
+
+        case RDB_FN_LOWER:
+        case RDB_FN_UPPER:
+            rdb_vm_change_case(stack, base, id == RDB_FN_UPPER);
+            break;
+
+        case RDB_FN_COALESCE: {
+            size_t chosen = base;
+            while (chosen + 1 < stack->top && stack->slots[chosen].is_null) chosen++;
+            rdb_vm_move(stack, base, chosen);
+            break;
+        }
+    }
+
+    for (size_t i = base + 1; i < stack->top; i++) {
+        rdb_vm_release(stack, i);
+    }
+    stack->top = base + 1;
+}
+
+/* Run `program` over `row`, leaving the result in slot 0 */
+static void rdb_vm_run(const rdb_program_t *program, const rdb_row_t *row, rdb_vm_stack_t *stack) {
+    size_t value_count = row && row->values ? fi_array_count(row->values) : 0;
+    size_t pc = 0;
+    stack->top = 0;
+
+    while (pc < program->length) {
+        const rdb_instruction_t *in = &program->code[pc++];
+        rdb_value_t *slots = stack->slots;
+        size_t top = stack->top;
+
+        switch ((rdb_vm_opcode_t)in->opcode) {
+            case RDB_VM_LOAD_COLUMN: {
+                const rdb_value_t *value = NULL;
+                if (in->column < value_count) value = *(rdb_value_t**)fi_array_get(row->values, in->column);
+                rdb_vm_push(stack, value);
+                break;
+            }
+
+            case RDB_VM_LOAD_CONST:
+                rdb_vm_push(stack, &program->constants[in->operand]);
+                break;
+
+            case RDB_VM_ADD_INT:
+            case RDB_VM_SUB_INT:
+            case RDB_VM_MUL_INT:
+            case RDB_VM_DIV_INT:
+            case RDB_VM_MOD_INT: {
+                rdb_value_t *a = &slots[top - 2], *b = &slots[top - 1];
+                int64_t result;
+                if (!a->is_null && !b->is_null && a->type == RDB_TYPE_INT && b->type == RDB_TYPE_INT) {
+                    if (rdb_vm_int_arith((rdb_expr_op_t)in->aux, a->data.int_val, b->data.int_val, &result)) {
+                        a->data.int_val = result;
+                    } else {
+                        rdb_vm_set_null(stack, top - 2);
+                    }
+                } else {
+                    rdb_vm_arith(stack, top - 2, a, b, (rdb_expr_op_t)in->aux);
+                }
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+            }
+
+            case RDB_VM_ADD_FLOAT:
+            case RDB_VM_SUB_FLOAT:
+            case RDB_VM_MUL_FLOAT:
+            case RDB_VM_DIV_FLOAT: {
+                rdb_value_t *a = &slots[top - 2], *b = &slots[top - 1];
+                double result;
+                if (!a->is_null && !b->is_null && rdb_expr_type_numeric(a->type) &&
+                    rdb_expr_type_numeric(b->type) &&
+                    !(a->type == RDB_TYPE_INT && b->type == RDB_TYPE_INT)) {
+                    if (rdb_vm_float_arith((rdb_expr_op_t)in->aux, rdb_vm_number(a), rdb_vm_number(b), &result)) {
+                        rdb_vm_set_float(stack, top - 2, result);
+                    } else {
+                        rdb_vm_set_null(stack, top - 2);
+                    }
+                } else {
+                    rdb_vm_arith(stack, top - 2, a, b, (rdb_expr_op_t)in->aux);
+                }
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+            }
+
+            case RDB_VM_ARITH:
+                rdb_vm_arith(stack, top - 2, &slots[top - 2], &slots[top - 1], (rdb_expr_op_t)in->aux);
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+
+            case RDB_VM_NEG: {
+                rdb_value_t *a = &slots[top - 1];
+                if (!a->is_null && a->type == RDB_TYPE_INT) {
+                    rdb_vm_set_int(stack, top - 1, (int64_t)(0 - (uint64_t)a->data.int_val));
+                } else if (!a->is_null && a->type == RDB_TYPE_FLOAT) {
+                    rdb_vm_set_float(stack, top - 1, -a->data.float_val);
+                } else {
+                    rdb_vm_set_null(stack, top - 1);
+                }
+                break;
+            }
+
+            case RDB_VM_CMP_INT: {
+                rdb_value_t *a = &slots[top - 2], *b = &slots[top - 1];
+                if (!a->is_null && !b->is_null && a->type == RDB_TYPE_INT && b->type == RDB_TYPE_INT) {
+                    int cmp = (a->data.int_val > b->data.int_val) - (a->data.int_val < b->data.int_val);
+                    rdb_vm_set_bool(stack, top - 2, rdb_vm_comparison_holds((rdb_expr_op_t)in->aux, cmp));
+                } else {
+                    rdb_vm_compare(stack, top - 2, a, b, (rdb_expr_op_t)in->aux);
+                }
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+            }
+
+            case RDB_VM_CMP_FLOAT: {
+                rdb_value_t *a = &slots[top - 2], *b = &slots[top - 1];
+                if (!a->is_null && !b->is_null && rdb_expr_type_numeric(a->type) &&
+                    rdb_expr_type_numeric(b->type) &&
+                    !(a->type == RDB_TYPE_INT && b->type == RDB_TYPE_INT)) {
+                    int cmp = rdb_vm_compare_doubles(rdb_vm_number(a), rdb_vm_number(b));
+                    rdb_vm_set_bool(stack, top - 2, rdb_vm_comparison_holds((rdb_expr_op_t)in->aux, cmp));
+                } else {
+                    rdb_vm_compare(stack, top - 2, a, b, (rdb_expr_op_t)in->aux);
+                }
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+            }
+
+            case RDB_VM_CMP:
+                rdb_vm_compare(stack, top - 2, &slots[top - 2], &slots[top - 1], (rdb_expr_op_t)in->aux);
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+
+            case RDB_VM_CMP_COLUMN_INT:
+            case RDB_VM_CMP_COLUMN_FLOAT: {
+                const rdb_value_t *value = NULL;
+                if (in->column < value_count) value = *(rdb_value_t**)fi_array_get(row->values, in->column);
+                const rdb_value_t *constant = &program->constants[in->operand];
+                rdb_expr_op_t op = (rdb_expr_op_t)in->aux;
+                size_t dst = stack->top++;
+                stack->owned[dst] = false;
+
+                if (!value || value->is_null) {
+                    rdb_vm_set_null(stack, dst);
+                } else if (in->opcode == RDB_VM_CMP_COLUMN_INT && value->type == RDB_TYPE_INT) {
+                    int64_t a = value->data.int_val, b = constant->data.int_val;
+                    rdb_vm_set_bool(stack, dst, rdb_vm_comparison_holds(op, (a > b) - (a < b)));
+                } else if (in->opcode == RDB_VM_CMP_COLUMN_FLOAT && rdb_expr_type_numeric(value->type) &&
+                           !(value->type == RDB_TYPE_INT && constant->type == RDB_TYPE_INT)) {
+                    int cmp = rdb_vm_compare_doubles(rdb_vm_number(value), rdb_vm_number(constant));
+                    rdb_vm_set_bool(stack, dst, rdb_vm_comparison_holds(op, cmp));
+                } else {
+                    rdb_vm_compare(stack, dst, value, constant, op);
+                }
+                break;
+            }
+
+            case RDB_VM_LIKE: {
+                rdb_value_t *a = &slots[top - 2], *b = &slots[top - 1];
+                if (rdb_vm_is_string(a) && rdb_vm_is_string(b)) {
+                    bool match = rdb_like_match(rdb_get_string_value(a), rdb_get_string_value(b));
+                    rdb_vm_set_bool(stack, top - 2, match);
+                } else {
+                    rdb_vm_set_null(stack, top - 2);
+                }
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+            }
+
+            case RDB_VM_IS_NULL:
+            case RDB_VM_IS_NOT_NULL: {
+                bool is_null = slots[top - 1].is_null;
+                rdb_vm_set_bool(stack, top - 1, in->opcode == RDB_VM_IS_NULL ? is_null : !is_null);
+                break;
+            }
+
+            case RDB_VM_NOT: {
+                int truth = rdb_vm_truth(&slots[top - 1]);
+                if (truth < 0) {
+                    rdb_vm_set_null(stack, top - 1);
+                } else {
+                    rdb_vm_set_bool(stack, top - 1, !truth);
+                }
+                break;
+            }
+
+            case RDB_VM_AND:
+            case RDB_VM_OR: {
+                int a = rdb_vm_truth(&slots[top - 2]);
+                int b = rdb_vm_truth(&slots[top - 1]);
+                int decisive = in->opcode == RDB_VM_AND ? 0 : 1;
+                if (a == decisive || b == decisive) {
+                    rdb_vm_set_bool(stack, top - 2, decisive);
+                } else if (a < 0 || b < 0) {
+                    rdb_vm_set_null(stack, top - 2);
+                } else {
+                    rdb_vm_set_bool(stack, top - 2, !decisive);
+                }
+                rdb_vm_release(stack, top - 1);
+                stack->top--;
+                break;
+            }
+
+            case RDB_VM_JUMP_IF_FALSE:
+            case RDB_VM_JUMP_IF_TRUE: {
+                int truth = rdb_vm_truth(&slots[top - 1]);
+                if (truth == (in->opcode == RDB_VM_JUMP_IF_TRUE ? 1 : 0)) {
+                    rdb_vm_set_bool(stack, top - 1, truth);
+                    pc = (size_t)in->operand;
+                }
+                break;
+            }
+
+            case RDB_VM_CALL:
+                rdb_vm_call(stack, (rdb_function_id_t)in->operand, in->aux);
+                break;
+        }
+    }
+}
+
+/* Evaluate `program` over `row`. On success *result is a new value the
+ * caller frees with rdb_value_free(). */
+int rdb_program_eval(const rdb_program_t *program, const rdb_row_t *row, rdb_value_t **result) {
+    if (!program || !result || program->length == 0) return -1;
+
+    rdb_vm_stack_t stack;
+    rdb_vm_run(program, row, &stack);
+
+    *result = rdb_value_copy(&stack.slots[0]);
+    rdb_vm_release(&stack, 0);
+    return *result ? 0 : -1;
+}
+
+/* Whether `row` satisfies a compiled WHERE expression (it is TRUE) */
+bool rdb_program_matches(const rdb_program_t *program, const rdb_row_t *row) {
+    if (!program || program->length == 0) return false;
+
+    rdb_vm_stack_t stack;
+    rdb_vm_run(program, row, &stack);
+
+    bool matches = rdb_vm_truth(&stack.slots[0]) == 1;
+    rdb_vm_release(&stack, 0);
+    return matches;
+}
+
+/* ===== UPDATE WITH SET EXPRESSIONS ===== */
+
+static void rdb_row_values_free(fi_array *row_values) {
+    if (!row_values) return;
+
+    for (size_t i = 0; i < fi_array_count(row_values); i++) {
+        fi_array *values = *(fi_array**)fi_array_get(row_values, i);
+        for (size_t j = 0; values && j < fi_array_count(values); j++) {
+            rdb_value_free(*(rdb_value_t**)fi_array_get(values, j));
+        }
+        if (values) fi_array_destroy(values);
+    }
+    fi_array_destroy(row_values);
+}
+
+/* The SET values of every row in `rows`: set_values[j], or set_expressions[j]
+ * evaluated over the row's current values when it is not NULL */
+static fi_array* rdb_evaluate_assignments(rdb_table_t *table, fi_array *rows, fi_array *set_values,
+                                          fi_array *set_expressions) {
+    size_t count = fi_array_count(set_values);
+    rdb_program_t **programs = calloc(count ? count : 1, sizeof(rdb_program_t*));
+    fi_array *row_values = fi_array_create(fi_array_count(rows) + 1, sizeof(fi_array*));
+    bool failed = !programs || !row_values;
+
+    for (size_t j = 0; !failed && j < count; j++) {
+        rdb_expr_t *expr = *(rdb_expr_t**)fi_array_get(set_expressions, j);
+        if (expr && !(programs[j] = rdb_expr_compile(table, expr))) failed = true;
+    }
+
+    for (size_t i = 0; !failed && i < fi_array_count(rows); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, i);
+        fi_array *values = fi_array_create(count + 1, sizeof(rdb_value_t*));
+        if (!values || fi_array_push(row_values, &values) != 0) {
+            if (values) fi_array_destroy(values);
+            failed = true;
+            break;
+        }
+
+        for (size_t j = 0; j < count && !failed; j++) {
+            rdb_value_t *value = NULL;
+            if (programs[j]) {
+                if (rdb_program_eval(programs[j], row, &value) != 0) value = NULL;
+            } else {
+                value = rdb_value_copy(*(rdb_value_t**)fi_array_get(set_values, j));
+            }
+            if (!value || fi_array_push(values, &value) != 0) {
+                rdb_value_free(value);
+                failed = true;
+            }
+        }
+    }
+
+    for (size_t j = 0; programs && j < count; j++) {
+        rdb_program_free(programs[j]);
+    }
+    free(programs);
+
+    if (failed) {
+        if (row_values) rdb_row_values_free(row_values);
+        return NULL;
+    }
+    return row_values;
+}
+
+/* UPDATE where each matching row gets values computed from its own old
+ * values. Logs the changes when `logged`. The caller holds any locks. */
+static int rdb_update_computed(rdb_database_t *db, rdb_table_t *table, fi_array *set_columns,
+                               fi_array *set_values, fi_array *set_expressions,
+                               fi_array *where_conditions, bool logged) {
+    size_t count = fi_array_count(set_columns);
+    if (fi_array_count(set_values) != count || fi_array_count(set_expressions) != count) {
+        printf("Error: Number of columns (%zu) does not match number of values (%zu)\n",
+               count, fi_array_count(set_values));
+        return -1;
+    }
+
+    fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+    if (!matches) return -1;
+
+    fi_array *row_values = rdb_evaluate_assignments(table, matches, set_values, set_expressions);
+    fi_array *single = fi_array_create(1, sizeof(rdb_row_t*));
+    int *col_indexes = malloc((count ? count : 1) * sizeof(int));
+    if (!row_values || !single || !col_indexes ||
+        rdb_table_check_unique_assignments(table, matches, set_columns, row_values) != 0) {
+        if (row_values) rdb_row_values_free(row_values);
+        if (single) fi_array_destroy(single);
+        free(col_indexes);
+        fi_array_destroy(matches);
+        return -1;
+    }
+
+    /* Foreign keys are checked row by row, each against its own values */
+    int result = 0;
+    for (size_t i = 0; i < fi_array_count(matches) && result == 0; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        fi_array *values = *(fi_array**)fi_array_get(row_values, i);
+        if (fi_array_count(single) == 0) {
+            fi_array_push(single, &row);
+        } else {
+            fi_array_set(single, 0, &row);
+        }
+        result = rdb_check_update_references(db, table, single, set_columns, values);
+    }
+    fi_array_destroy(single);
+
+    for (size_t j = 0; j < count; j++) {
+        const char *col_name = *(const char**)fi_array_get(set_columns, j);
+        col_indexes[j] = col_name ? rdb_get_column_index(table, col_name) : -1;
+    }
+
+    const rdb_record_layout_t *layout = logged ? rdb_table_record_layout(table) : NULL;
+    int updated_count = 0;
+
+    for (size_t i = 0; i < fi_array_count(matches) && result == 0; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(matches, i);
+        fi_array *values = *(fi_array**)fi_array_get(row_values, i);
+        rdb_cascade_update(db, table, row, set_columns, values, logged);
+
+        rdb_record_t *old_record = logged ? rdb_record_pack(layout, row) : NULL;
+
+        /* Index keys are derived from the values being replaced */
+        rdb_remove_row_from_indexes(table, row);
+
+        for (size_t j = 0; j < count; j++) {
+            int col_index = col_indexes[j];
+            if (col_index < 0 || col_index >= (int)fi_array_count(row->values)) continue;
+
+            rdb_value_t *value_copy = rdb_value_copy(*(rdb_value_t**)fi_array_get(values, j));
+            if (!value_copy) continue;
+
+            rdb_value_t *old_value = *(rdb_value_t**)fi_array_get(row->values, col_index);
+            rdb_value_free(old_value);
+            fi_array_set(row->values, col_index, &value_copy);
+        }
+
+        rdb_update_table_indexes(table, row);
+        if (logged) rdb_log_operation(db, RDB_OP_UPDATE, table->name, row->row_id, old_record);
+        updated_count++;
+    }
+
+    rdb_row_values_free(row_values);
+    free(col_indexes);
+    fi_array_destroy(matches);
+    if (result != 0) return -1;
+
+    printf("Updated %d rows in table '%s'\n", updated_count, table->name);
+    return updated_count;
+}
+
+/* UPDATE with per-row SET expressions. set_expressions[j] is an
+ * rdb_expr_t* computing the new value of set_columns[j] from the row, or
+ * NULL to assign the constant set_values[j]. */
+int rdb_update_rows_computed(rdb_database_t *db, const char *table_name, fi_array *set_columns,
+                             fi_array *set_values, fi_array *set_expressions, fi_array *where_conditions) {
+    if (!db || !table_name || !set_columns || !set_values || !set_expressions) return -1;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return -1;
+    }
+
+    return rdb_update_computed(db, table, set_columns, set_values, set_expressions, where_conditions,
+                               db->transaction_manager != NULL);
+}
+
+int rdb_update_rows_computed_thread_safe(rdb_database_t *db, const char *table_name, fi_array *set_columns,
+                                         fi_array *set_values, fi_array *set_expressions,
+                                         fi_array *where_conditions) {
+    if (!db || !table_name || !set_columns || !set_values || !set_expressions) return -1;
+
+    if (rdb_lock_database_read(db) != 0) return -1;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        rdb_unlock_database(db);
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return -1;
+    }
+
+    if (rdb_lock_table_write(table) != 0) {
+        rdb_unlock_database(db);
+        return -1;
+    }
+    rdb_unlock_database(db);
+
+    int result = rdb_update_computed(db, table, set_columns, set_values, set_expressions,
+                                     where_conditions, false);
+
+    rdb_unlock_table(table);
+    return result;
+}
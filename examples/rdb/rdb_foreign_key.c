@@ -0,0 +1,370 @@
+#include "rdb.h"
+
+/* Foreign keys
+ *
+ * Every table lists the constraints it declares (foreign_keys) and the ones
+ * that point at it (referenced_by), so a statement only looks at the
+ * constraints of the tables it touches. A referenced value is looked up
+ * through the parent column's PRIMARY KEY / UNIQUE hash index, which makes
+ * checking an inserted row one probe per constraint. Linking a constraint
+ * also makes sure an index is led by the referencing column, so the child
+ * rows of a parent key are found without scanning the child table.
+ *
+ * Deleting a referenced row, or changing its key, fails while child rows
+ * point at it unless the constraint cascades. Cascades tombstone or rewrite
+ * the child rows and are logged with the statement when it runs in a
+ * transaction. NULL foreign key values reference nothing and always pass. */
+
+/* Cascading constraints followed by the check that runs before a delete */
+#define RDB_FK_MAX_CASCADE_DEPTH 16
+
+static int rdb_fk_list_add(fi_array **list, rdb_foreign_key_t *foreign_key) {
+    if (!*list) {
+        *list = fi_array_create(4, sizeof(rdb_foreign_key_t*));
+        if (!*list) return -1;
+    }
+    return fi_array_push(*list, &foreign_key);
+}
+
+static void rdb_fk_list_remove(fi_array *list, const rdb_foreign_key_t *foreign_key) {
+    for (size_t i = 0; list && i < fi_array_count(list); i++) {
+        if (*(rdb_foreign_key_t**)fi_array_get(list, i) == foreign_key) {
+            fi_array_splice(list, i, 1, NULL);
+            return;
+        }
+    }
+}
+
+static size_t rdb_fk_count(const fi_array *list) {
+    return list ? fi_array_count(list) : 0;
+}
+
+static rdb_foreign_key_t* rdb_fk_at(fi_array *list, size_t i) {
+    return *(rdb_foreign_key_t**)fi_array_get(list, i);
+}
+
+/* Register a constraint of db->foreign_keys with both of its tables */
+int rdb_link_foreign_key(rdb_database_t *db, rdb_foreign_key_t *foreign_key) {
+    if (!db || !foreign_key) return -1;
+
+    rdb_table_t *table = rdb_get_table(db, foreign_key->table_name);
+    rdb_table_t *ref_table = rdb_get_table(db, foreign_key->ref_table_name);
+    if (!table || !ref_table) return -1;
+
+    if (rdb_fk_list_add(&table->foreign_keys, foreign_key) != 0) return -1;
+    if (rdb_fk_list_add(&ref_table->referenced_by, foreign_key) != 0) {
+        rdb_fk_list_remove(table->foreign_keys, foreign_key);
+        return -1;
+    }
+
+    char index_name[64];
+    snprintf(index_name, sizeof(index_name), "%.30s_%.27s_fkey", table->name,
+             foreign_key->column_name);
+    rdb_table_ensure_column_index(table, foreign_key->column_name, index_name);
+    return 0;
+}
+
+void rdb_unlink_foreign_key(rdb_database_t *db, rdb_foreign_key_t *foreign_key) {
+    if (!db || !foreign_key) return;
+
+    rdb_table_t *table = rdb_get_table(db, foreign_key->table_name);
+    if (table) rdb_fk_list_remove(table->foreign_keys, foreign_key);
+
+    rdb_table_t *ref_table = rdb_get_table(db, foreign_key->ref_table_name);
+    if (ref_table) rdb_fk_list_remove(ref_table->referenced_by, foreign_key);
+}
+
+/* Drop every constraint declared by or referencing a table being dropped */
+void rdb_drop_table_foreign_keys(rdb_database_t *db, rdb_table_t *table) {
+    if (!db || !table) return;
+
+    fi_array **lists[2] = {&table->foreign_keys, &table->referenced_by};
+    for (int l = 0; l < 2; l++) {
+        while (rdb_fk_count(*lists[l]) > 0) {
+            rdb_foreign_key_t *foreign_key = rdb_fk_at(*lists[l], 0);
+            rdb_unlink_foreign_key(db, foreign_key);
+
+            const char *constraint_name = foreign_key->constraint_name;
+            printf("Foreign key constraint '%s' dropped with table '%s'\n",
+                   constraint_name, table->name);
+            fi_map_remove(db->foreign_keys, &constraint_name);
+            rdb_foreign_key_free(foreign_key);
+        }
+    }
+}
+
+/* Whether the referenced column holds `value` */
+static bool rdb_fk_parent_exists(rdb_database_t *db, const rdb_foreign_key_t *foreign_key,
+                                 const rdb_value_t *value) {
+    rdb_table_t *ref_table = rdb_get_table(db, foreign_key->ref_table_name);
+    if (!ref_table) return false;
+
+    int ref_col_index = rdb_get_column_index(ref_table, foreign_key->ref_column_name);
+    fi_array *rows = rdb_table_rows_with_value(ref_table, ref_col_index, value, 1);
+    bool found = rows && fi_array_count(rows) > 0;
+    if (rows) fi_array_destroy(rows);
+    return found;
+}
+
+/* Live child rows pointing at `row` through `foreign_key`, or NULL when the
+ * parent key is NULL */
+static fi_array* rdb_fk_children(rdb_database_t *db, rdb_table_t *table,
+                                 const rdb_foreign_key_t *foreign_key, const rdb_row_t *row,
+                                 rdb_table_t **child_table, size_t limit) {
+    int ref_col_index = rdb_get_column_index(table, foreign_key->ref_column_name);
+    if (ref_col_index < 0 || ref_col_index >= (int)fi_array_count(row->values)) return NULL;
+
+    rdb_value_t *key = *(rdb_value_t**)fi_array_get(row->values, ref_col_index);
+    if (!key || key->is_null) return NULL;
+
+    *child_table = rdb_get_table(db, foreign_key->table_name);
+    if (!*child_table) return NULL;
+
+    int col_index = rdb_get_column_index(*child_table, foreign_key->column_name);
+    return rdb_table_rows_with_value(*child_table, col_index, key, limit);
+}
+
+/* Whether a child row other than `row` itself points at `row` */
+static bool rdb_fk_has_children(rdb_database_t *db, rdb_table_t *table,
+                                const rdb_foreign_key_t *foreign_key, const rdb_row_t *row) {
+    rdb_table_t *child_table = NULL;
+    fi_array *children = rdb_fk_children(db, table, foreign_key, row, &child_table, 2);
+    bool found = false;
+    for (size_t i = 0; children && i < fi_array_count(children) && !found; i++) {
+        found = *(rdb_row_t**)fi_array_get(children, i) != row;
+    }
+    if (children) fi_array_destroy(children);
+    return found;
+}
+
+/* Value assigned to `column` by an UPDATE; the last assignment wins */
+static bool rdb_fk_assigned_value(fi_array *set_columns, fi_array *set_values, const char *column,
+                                  const rdb_value_t **value) {
+    bool assigned = false;
+    for (size_t j = 0; j < fi_array_count(set_columns) && j < fi_array_count(set_values); j++) {
+        const char *col_name = *(const char**)fi_array_get(set_columns, j);
+        if (col_name && strcmp(col_name, column) == 0) {
+            *value = *(rdb_value_t**)fi_array_get(set_values, j);
+            assigned = true;
+        }
+    }
+    return assigned;
+}
+
+int rdb_validate_foreign_key(rdb_database_t *db, const char *table_name,
+                            const char *column_name, const rdb_value_t *value) {
+    if (!db || !table_name || !column_name) return -1;
+    if (!value || value->is_null) return 0;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) return -1;
+
+    for (size_t i = 0; i < rdb_fk_count(table->foreign_keys); i++) {
+        rdb_foreign_key_t *foreign_key = rdb_fk_at(table->foreign_keys, i);
+        if (strcmp(foreign_key->column_name, column_name) == 0 &&
+            !rdb_fk_parent_exists(db, foreign_key, value)) {
+            return -1; /* Foreign key violation */
+        }
+    }
+
+    return 0;
+}
+
+int rdb_enforce_foreign_key_constraints(rdb_database_t *db, const char *table_name,
+                                       rdb_row_t *row) {
+    if (!db || !table_name || !row) return -1;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) return -1;
+
+    /* Check each constraint the table declares */
+    for (size_t i = 0; i < rdb_fk_count(table->foreign_keys); i++) {
+        rdb_foreign_key_t *foreign_key = rdb_fk_at(table->foreign_keys, i);
+        int col_index = rdb_get_column_index(table, foreign_key->column_name);
+        if (col_index < 0 || col_index >= (int)fi_array_count(row->values)) continue;
+
+        rdb_value_t *val = *(rdb_value_t**)fi_array_get(row->values, col_index);
+        if (!val || val->is_null) continue;
+
+        if (!rdb_fk_parent_exists(db, foreign_key, val)) {
+            printf("Error: Foreign key constraint violation on column '%s'\n",
+                   foreign_key->column_name);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int rdb_fk_check_delete_row(rdb_database_t *db, rdb_table_t *table, rdb_row_t *row,
+                                   int depth) {
+    if (depth > RDB_FK_MAX_CASCADE_DEPTH) return 0;
+
+    for (size_t f = 0; f < rdb_fk_count(table->referenced_by); f++) {
+        rdb_foreign_key_t *foreign_key = rdb_fk_at(table->referenced_by, f);
+
+        if (!foreign_key->on_delete_cascade) {
+            if (rdb_fk_has_children(db, table, foreign_key, row)) {
+                printf("Error: Row %zu of table '%s' is still referenced from table '%s' "
+                       "(constraint '%s')\n", row->row_id, table->name, foreign_key->table_name,
+                       foreign_key->constraint_name);
+                return -1;
+            }
+            continue;
+        }
+
+        /* Rows removed by the cascade must not be referenced either */
+        rdb_table_t *child_table = NULL;
+        fi_array *children = rdb_fk_children(db, table, foreign_key, row, &child_table, 0);
+        int result = 0;
+        for (size_t i = 0; children && i < fi_array_count(children) && result == 0; i++) {
+            rdb_row_t *child = *(rdb_row_t**)fi_array_get(children, i);
+            if (child != row) result = rdb_fk_check_delete_row(db, child_table, child, depth + 1);
+        }
+        if (children) fi_array_destroy(children);
+        if (result != 0) return -1;
+    }
+
+    return 0;
+}
+
+/* Check that the rows a DELETE is about to remove can go. Returns -1 after
+ * printing the reason when a non-cascading constraint still references one
+ * of them, directly or through a cascade. */
+int rdb_check_delete_references(rdb_database_t *db, rdb_table_t *table, fi_array *rows) {
+    if (!db || !table || !rows) return -1;
+    if (rdb_fk_count(table->referenced_by) == 0) return 0;
+
+    for (size_t i = 0; i < fi_array_count(rows); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, i);
+        if (rdb_fk_check_delete_row(db, table, row, 0) != 0) return -1;
+    }
+    return 0;
+}
+
+/* Delete the child rows of a row that was just tombstoned, following
+ * ON DELETE CASCADE constraints. Child tables are compacted by later
+ * statements or the compaction thread, never under the running one. */
+void rdb_cascade_delete(rdb_database_t *db, rdb_table_t *table, rdb_row_t *row, bool logged) {
+    if (!db || !table || !row) return;
+
+    for (size_t f = 0; f < rdb_fk_count(table->referenced_by); f++) {
+        rdb_foreign_key_t *foreign_key = rdb_fk_at(table->referenced_by, f);
+        if (!foreign_key->on_delete_cascade) continue;
+
+        rdb_table_t *child_table = NULL;
+        fi_array *children = rdb_fk_children(db, table, foreign_key, row, &child_table, 0);
+        for (size_t i = 0; children && i < fi_array_count(children); i++) {
+            rdb_row_t *child = *(rdb_row_t**)fi_array_get(children, i);
+            if (child->deleted) continue; /* Reached through another path already */
+
+            if (logged) {
+                rdb_log_operation(db, RDB_OP_DELETE, child_table->name, child->row_id,
+                                  rdb_record_pack(rdb_table_record_layout(child_table), child));
+            }
+            rdb_table_delete_row(child_table, child);
+            rdb_cascade_delete(db, child_table, child, logged);
+        }
+        if (children) fi_array_destroy(children);
+    }
+}
+
+/* Check an UPDATE before any row changes: new foreign key values must exist
+ * in the referenced table, and keys of referenced rows may only change when
+ * the constraint cascades. */
+int rdb_check_update_references(rdb_database_t *db, rdb_table_t *table, fi_array *rows,
+                                fi_array *set_columns, fi_array *set_values) {
+    if (!db || !table || !rows || !set_columns || !set_values) return -1;
+    if (fi_array_count(rows) == 0) return 0;
+
+    for (size_t f = 0; f < rdb_fk_count(table->foreign_keys); f++) {
+        rdb_foreign_key_t *foreign_key = rdb_fk_at(table->foreign_keys, f);
+        const rdb_value_t *value = NULL;
+        if (!rdb_fk_assigned_value(set_columns, set_values, foreign_key->column_name, &value)) continue;
+
+        if (value && !value->is_null && !rdb_fk_parent_exists(db, foreign_key, value)) {
+            printf("Error: Foreign key constraint violation on column '%s'\n",
+                   foreign_key->column_name);
+            return -1;
+        }
+    }
+
+    for (size_t f = 0; f < rdb_fk_count(table->referenced_by); f++) {
+        rdb_foreign_key_t *foreign_key = rdb_fk_at(table->referenced_by, f);
+        const rdb_value_t *value = NULL;
+        if (foreign_key->on_update_cascade ||
+            !rdb_fk_assigned_value(set_columns, set_values, foreign_key->ref_column_name, &value)) {
+            continue;
+        }
+
+        int ref_col_index = rdb_get_column_index(table, foreign_key->ref_column_name);
+        for (size_t i = 0; i < fi_array_count(rows); i++) {
+            rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, i);
+            rdb_value_t *old_value = *(rdb_value_t**)fi_array_get(row->values, ref_col_index);
+            if (value && old_value && rdb_value_compare(&value, &old_value) == 0) {
+                continue; /* Key left as it is */
+            }
+
+            if (rdb_fk_has_children(db, table, foreign_key, row)) {
+                printf("Error: Key of row %zu in table '%s' is still referenced from table '%s' "
+                       "(constraint '%s')\n", row->row_id, table->name, foreign_key->table_name,
+                       foreign_key->constraint_name);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Carry a key change of `row`, which is about to be updated, over to its
+ * child rows along ON UPDATE CASCADE constraints */
+void rdb_cascade_update(rdb_database_t *db, rdb_table_t *table, rdb_row_t *row,
+                        fi_array *set_columns, fi_array *set_values, bool logged) {
+    if (!db || !table || !row || !set_columns || !set_values) return;
+
+    for (size_t f = 0; f < rdb_fk_count(table->referenced_by); f++) {
+        rdb_foreign_key_t *foreign_key = rdb_fk_at(table->referenced_by, f);
+        const rdb_value_t *value = NULL;
+        if (!foreign_key->on_update_cascade ||
+            !rdb_fk_assigned_value(set_columns, set_values, foreign_key->ref_column_name, &value) ||
+            !value) {
+            continue;
+        }
+
+        rdb_table_t *child_table = NULL;
+        fi_array *children = rdb_fk_children(db, table, foreign_key, row, &child_table, 0);
+        if (!children) continue;
+
+        int col_index = rdb_get_column_index(child_table, foreign_key->column_name);
+        const char *child_column = foreign_key->column_name;
+        fi_array *child_columns = fi_array_create(1, sizeof(char*));
+        fi_array *child_values = fi_array_create(1, sizeof(rdb_value_t*));
+        if (child_columns && child_values) {
+            fi_array_push(child_columns, &child_column);
+            fi_array_push(child_values, &value);
+        }
+
+        for (size_t i = 0; child_columns && child_values && i < fi_array_count(children); i++) {
+            rdb_row_t *child = *(rdb_row_t**)fi_array_get(children, i);
+            rdb_value_t *value_copy = rdb_value_copy(value);
+            if (!value_copy) break;
+
+            rdb_cascade_update(db, child_table, child, child_columns, child_values, logged);
+            if (logged) {
+                rdb_log_operation(db, RDB_OP_UPDATE, child_table->name, child->row_id,
+                                  rdb_record_pack(rdb_table_record_layout(child_table), child));
+            }
+
+            rdb_remove_row_from_indexes(child_table, child);
+            rdb_value_t **slot = (rdb_value_t**)fi_array_get(child->values, col_index);
+            rdb_value_free(*slot);
+            *slot = value_copy;
+            rdb_update_table_indexes(child_table, child);
+        }
+
+        if (child_columns) fi_array_destroy(child_columns);
+        if (child_values) fi_array_destroy(child_values);
+        fi_array_destroy(children);
+    }
+}
@@ -0,0 +1,1734 @@
+#include "rdb.h"
+#include "sql_parser.h"
+#include <strings.h>  /* for strcasecmp */
+
+/* Secondary indexes
+ *
+ * Every index stores one rdb_index_entry_t per row. The entry key is the
+ * tuple of key column values encoded so that memcmp order equals tuple
+ * order:
+ *
+ *   NULL            0x00
+ *   INT/FLOAT       0x01 + 8 bytes of the value's IEEE double bits,
+ *                   sign-adjusted, + 0x01 when the double is exact, or
+ *                   0x00/0x02 + 8 bytes of the (negative/positive) integer
+ *                   rounding error, sign bit flipped, for |INT| > 2^53
+ *   VARCHAR/TEXT    0x01 + the string bytes + 0x00
+ *   BOOLEAN         0x01 + 0x00 or 0x01
+ *
+ * Each component is self-delimiting, so the encoding of a leading prefix of
+ * the columns is a byte prefix of the full key. That lets the planner turn
+ * "a = ? AND b = ? AND c BETWEEN ? AND ?" into a single ordered range scan.
+ *
+ * Keys are stored prefix-compressed: the index keeps the leading bytes that
+ * all of its keys share (e.g. "https://www." on a URL column, or the high
+ * exponent bytes of similar numbers) and entries hold only the remainder. The
+ * first 8 bytes of the remainder form the entry's abbreviated key, so a
+ * probe usually resolves with an integer compare and never touches the
+ * heap. The shared prefix only ever shrinks while the index is non-empty.
+ *
+ * Indexes created USING ART keep the same encoded key followed by the 8-byte
+ * big-endian row id in an adaptive radix tree instead. Equality on a prefix
+ * of the columns and LIKE 'abc%' on the next one become a single prefix
+ * descent costing O(key length); ranges need the ordered tree.
+ *
+ * Every PRIMARY KEY and UNIQUE column gets a hash index (RDB_INDEX_HASH)
+ * when the table is created. It maps the encoded key to the one row holding
+ * it, so inserts and updates reject duplicates with a single probe, and the
+ * planner answers "col = ?" on those columns without walking a tree. Keys
+ * with a NULL component are not indexed: UNIQUE admits any number of NULLs,
+ * and a PRIMARY KEY refuses them outright. */
+
+/* Hash index key: encoded key bytes, owned by the map entry */
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+} rdb_hash_key_t;
+
+/* Growable byte buffer used while encoding keys */
+typedef struct {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+} rdb_key_buffer_t;
+
+/* Chosen access path for a WHERE clause */
+typedef struct {
+    rdb_index_t *index;                                 /* Index to scan */
+    size_t eq_count;                                    /* Leading columns bound by equality */
+    const rdb_value_t *eq_values[RDB_MAX_INDEX_COLUMNS];/* Equality values, in key order */
+    const rdb_value_t *low;                             /* Lower bound on the next column */
+    const rdb_value_t *high;                            /* Upper bound on the next column */
+    const char *like_prefix;                            /* Literal LIKE prefix on the next column */
+    size_t like_length;                                 /* Length of like_prefix */
+    size_t limit;                                       /* Stop after this many rows (0 for all) */
+    bool reverse;                                       /* Walk from the largest key (unbounded plans only) */
+    size_t run_columns;                                 /* Rows equal on this many key columns form a run:
+                                                           the limit never splits one, and each comes out in
+                                                           row id order (0 for plain key order) */
+} rdb_index_plan_t;
+
+/* Most fully bound equality plans combined by row id intersection */
+#define RDB_MAX_INDEX_INTERSECT 4
+
+/* Analyzed tables scan instead of using an index expected to return more
+ * than this share of their rows */
+#define RDB_INDEX_MAX_FRACTION 0.25
+
+/* Planner state threaded through fi_map_for_each */
+typedef struct {
+    rdb_table_t *table;
+    fi_array *conditions;
+    rdb_index_plan_t best;
+    size_t best_score;
+    rdb_index_plan_t exact[RDB_MAX_INDEX_INTERSECT]; /* Plans binding every key column */
+    size_t exact_count;
+} rdb_index_planner_t;
+
+/* Row maintenance state threaded through fi_map_for_each */
+typedef struct {
+    rdb_table_t *table;
+    rdb_row_t *row;
+} rdb_index_row_visit_t;
+
+static int rdb_key_buffer_put(rdb_key_buffer_t *buf, const void *bytes, size_t count) {
+    if (buf->length + count > buf->capacity) {
+        size_t new_capacity = buf->capacity ? buf->capacity * 2 : 32;
+        while (new_capacity < buf->length + count) {
+            new_capacity *= 2;
+        }
+        uint8_t *new_data = realloc(buf->data, new_capacity);
+        if (!new_data) return -1;
+        buf->data = new_data;
+        buf->capacity = new_capacity;
+    }
+    memcpy(buf->data + buf->length, bytes, count);
+    buf->length += count;
+    return 0;
+}
+
+static int rdb_key_buffer_put_u64(rdb_key_buffer_t *buf, uint64_t bits) {
+    uint8_t bytes[8];
+    for (int i = 7; i >= 0; i--) {
+        bytes[i] = (uint8_t)(bits & 0xFF);
+        bits >>= 8;
+    }
+    return rdb_key_buffer_put(buf, bytes, sizeof(bytes));
+}
+
+static bool rdb_is_numeric_type(rdb_data_type_t type) {
+    return type == RDB_TYPE_INT || type == RDB_TYPE_FLOAT;
+}
+
+static bool rdb_is_string_type(rdb_data_type_t type) {
+    return type == RDB_TYPE_VARCHAR || type == RDB_TYPE_TEXT;
+}
+
+/* Whether a value can be encoded as a key component of the given column type */
+static bool rdb_index_value_fits(rdb_data_type_t column_type, const rdb_value_t *value) {
+    if (!value || value->is_null) return false;
+
+    if (rdb_is_numeric_type(column_type)) return rdb_is_numeric_type(value->type);
+    if (rdb_is_string_type(column_type)) {
+        return rdb_is_string_type(value->type);
+    }
+    return column_type == value->type;
+}
+
+/* Append one key component. Values that do not fit the column type are
+ * encoded as NULL; the WHERE evaluator never matches them either, and every
+ * index scan re-checks the full condition list. */
+static int rdb_index_encode_value(rdb_key_buffer_t *buf, rdb_data_type_t column_type,
+                                  const rdb_value_t *value) {
+    uint8_t marker = 0x00;
+    if (!rdb_index_value_fits(column_type, value)) {
+        return rdb_key_buffer_put(buf, &marker, 1);
+    }
+
+    marker = 0x01;
+    if (rdb_key_buffer_put(buf, &marker, 1) != 0) return -1;
+
+    switch (column_type) {
+        case RDB_TYPE_INT:
+        case RDB_TYPE_FLOAT: {
+            /* INT and FLOAT values share one encoding, so 2 and 2.0 give the
+             * same key and 2.5 sorts between 2 and 3 whatever the column */
+            double d;
+            int64_t delta = 0;
+            if (value->type == RDB_TYPE_INT) {
+                int64_t v = value->data.int_val;
+                d = (double)v;
+                /* Rounding lost low bits of a large integer; keep them as the tiebreak */
+                delta = d >= 9223372036854775808.0 ? (v - INT64_MAX) - 1 : v - (int64_t)d;
+            } else {
+                d = value->data.float_val;
+            }
+            if (d == 0.0) d = 0.0; /* Fold -0.0 into 0.0 */
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            bits = (bits & 0x8000000000000000ULL) ? ~bits : bits ^ 0x8000000000000000ULL;
+            if (rdb_key_buffer_put_u64(buf, bits) != 0) return -1;
+
+            uint8_t tiebreak = delta < 0 ? 0x00 : delta > 0 ? 0x02 : 0x01;
+            if (rdb_key_buffer_put(buf, &tiebreak, 1) != 0) return -1;
+            if (delta == 0) return 0;
+            return rdb_key_buffer_put_u64(buf, (uint64_t)delta ^ 0x8000000000000000ULL);
+        }
+
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT:
+            /* C strings contain no NUL, so the terminator alone keeps it prefix-free */
+            return rdb_key_buffer_put(buf, rdb_get_string_value(value),
+                                      rdb_get_string_length(value) + 1);
+
+        case RDB_TYPE_BOOLEAN: {
+            uint8_t b = value->data.bool_val ? 1 : 0;
+            return rdb_key_buffer_put(buf, &b, 1);
+        }
+
+        default:
+            return 0;
+    }
+}
+
+static uint32_t rdb_hash_key_hash(const void *key, size_t key_size) {
+    (void)key_size;
+    const rdb_hash_key_t *hash_key = (const rdb_hash_key_t*)key;
+    return fi_map_hash_bytes(hash_key->bytes, hash_key->length);
+}
+
+static int rdb_hash_key_compare(const void *key1, const void *key2) {
+    const rdb_hash_key_t *a = (const rdb_hash_key_t*)key1;
+    const rdb_hash_key_t *b = (const rdb_hash_key_t*)key2;
+    if (a->length != b->length) return a->length < b->length ? -1 : 1;
+    return memcmp(a->bytes, b->bytes, a->length);
+}
+
+static void rdb_hash_key_free(void *key) {
+    rdb_hash_key_t *hash_key = (rdb_hash_key_t*)key;
+    if (hash_key) free(hash_key->bytes);
+    free(hash_key);
+}
+
+/* Row holding `bytes` in a hash index, or NULL */
+static rdb_row_t* rdb_hash_lookup(const rdb_index_t *index, const uint8_t *bytes, size_t length) {
+    rdb_hash_key_t probe = {(uint8_t*)bytes, length};
+    rdb_row_t *row = NULL;
+    if (fi_map_get(index->hash, &probe, &row) != 0) return NULL;
+    return row;
+}
+
+static rdb_data_type_t rdb_index_column_type(rdb_table_t *table, int column_index) {
+    rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, column_index);
+    return col ? col->type : RDB_TYPE_INT;
+}
+
+/* Encode the key columns of a row */
+static int rdb_index_encode_row(rdb_index_t *index, rdb_table_t *table, const rdb_row_t *row,
+                                rdb_key_buffer_t *buf) {
+    for (size_t i = 0; i < index->column_count; i++) {
+        int col_index = index->column_indexes[i];
+        rdb_value_t *value = NULL;
+        if (col_index < (int)fi_array_count(row->values)) {
+            value = *(rdb_value_t**)fi_array_get(row->values, col_index);
+        }
+        if (rdb_index_encode_value(buf, rdb_index_column_type(table, col_index), value) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Whether a key column of the row holds NULL (or a value its type cannot
+ * index). Such keys never conflict and stay out of hash indexes. */
+static bool rdb_index_row_has_null(rdb_index_t *index, rdb_table_t *table, const rdb_row_t *row) {
+    for (size_t i = 0; i < index->column_count; i++) {
+        int col_index = index->column_indexes[i];
+        rdb_value_t *value = NULL;
+        if (col_index < (int)fi_array_count(row->values)) {
+            value = *(rdb_value_t**)fi_array_get(row->values, col_index);
+        }
+        if (!rdb_index_value_fits(rdb_index_column_type(table, col_index), value)) return true;
+    }
+    return false;
+}
+
+/* Whether a key column of the row holds a non-NULL value its type cannot
+ * index. The key then sorts with the NULLs, out of value order. */
+static bool rdb_index_row_has_misfit(rdb_index_t *index, rdb_table_t *table, const rdb_row_t *row) {
+    for (size_t i = 0; i < index->column_count; i++) {
+        int col_index = index->column_indexes[i];
+        rdb_value_t *value = NULL;
+        if (col_index < (int)fi_array_count(row->values)) {
+            value = *(rdb_value_t**)fi_array_get(row->values, col_index);
+        }
+        if (value && !value->is_null && !rdb_index_value_fits(rdb_index_column_type(table, col_index), value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t rdb_index_abbreviate(const uint8_t *bytes, size_t length) {
+    uint64_t abbrev = 0;
+    for (size_t i = 0; i < RDB_INDEX_ABBREV_SIZE; i++) {
+        abbrev = (abbrev << 8) | (i < length ? bytes[i] : 0);
+    }
+    return abbrev;
+}
+
+/* Stored key bytes of an entry; short keys are unpacked from the abbreviation */
+static const uint8_t* rdb_index_entry_bytes(const rdb_index_entry_t *entry,
+                                            uint8_t scratch[RDB_INDEX_ABBREV_SIZE]) {
+    if (entry->key) return entry->key;
+
+    uint64_t abbrev = entry->abbrev;
+    for (int i = RDB_INDEX_ABBREV_SIZE - 1; i >= 0; i--) {
+        scratch[i] = (uint8_t)(abbrev & 0xFF);
+        abbrev >>= 8;
+    }
+    return scratch;
+}
+
+/* Fill an entry for the given stored key bytes. Probe entries borrow the
+ * bytes; with `copy` the entry gets its own copy when it needs one. */
+static int rdb_index_entry_init(rdb_index_entry_t *entry, const uint8_t *bytes, size_t length,
+                                rdb_row_t *row, bool copy) {
+    entry->abbrev = rdb_index_abbreviate(bytes, length);
+    entry->key = NULL;
+    entry->key_length = length;
+    entry->row_id = row ? row->row_id : 0;
+    entry->row = row;
+
+    if (length > RDB_INDEX_ABBREV_SIZE) {
+        if (!copy) {
+            entry->key = (uint8_t*)bytes;
+        } else {
+            entry->key = malloc(length);
+            if (!entry->key) return -1;
+            memcpy(entry->key, bytes, length);
+        }
+    }
+    return 0;
+}
+
+static size_t rdb_common_prefix_length(const uint8_t *a, size_t a_length,
+                                       const uint8_t *b, size_t b_length) {
+    size_t limit = a_length < b_length ? a_length : b_length;
+    size_t i = 0;
+    while (i < limit && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+/* Place a full encoded key relative to the shared prefix. Returns 0 and the
+ * bytes after the prefix when the key agrees with it (a key that is itself a
+ * prefix of the shared prefix gets an empty remainder), a negative value when
+ * it sorts before every stored key and a positive value when after. */
+static int rdb_index_split_key(const rdb_index_t *index, const uint8_t *key, size_t length,
+                               const uint8_t **suffix, size_t *suffix_length) {
+    size_t common = length < index->key_prefix_length ? length : index->key_prefix_length;
+    int cmp = common ? memcmp(key, index->key_prefix, common) : 0;
+    if (cmp != 0) return cmp;
+
+    *suffix = key + common;
+    *suffix_length = length - common;
+    return 0;
+}
+
+/* Shorten the shared prefix to `length` bytes and move the dropped bytes
+ * back into every entry. All entries gain the same leading bytes, so their
+ * relative order and the tree shape stay as they are. */
+static int rdb_index_shrink_prefix(rdb_index_t *index, size_t length) {
+    size_t moved = index->key_prefix_length - length;
+    const uint8_t *moved_bytes = index->key_prefix + length;
+    size_t count = fi_btree_size(index->tree);
+
+    /* Allocate every new key first so a failure leaves the index untouched */
+    uint8_t **keys = calloc(count ? count : 1, sizeof(uint8_t*));
+    if (!keys) return -1;
+
+    size_t i = 0;
+    for (fi_btree_node *node = fi_btree_find_min(index->tree->root); node;
+         node = fi_btree_successor(node), i++) {
+        rdb_index_entry_t *entry = (rdb_index_entry_t*)FI_BTREE_NODE_DATA(node);
+        size_t new_length = entry->key_length + moved;
+        if (new_length <= RDB_INDEX_ABBREV_SIZE) continue;
+
+        keys[i] = malloc(new_length);
+        if (!keys[i]) {
+            for (size_t j = 0; j < i; j++) {
+                free(keys[j]);
+            }
+            free(keys);
+            return -1;
+        }
+        uint8_t scratch[RDB_INDEX_ABBREV_SIZE];
+        memcpy(keys[i], moved_bytes, moved);
+        memcpy(keys[i] + moved, rdb_index_entry_bytes(entry, scratch), entry->key_length);
+    }
+
+    i = 0;
+    for (fi_btree_node *node = fi_btree_find_min(index->tree->root); node;
+         node = fi_btree_successor(node), i++) {
+        rdb_index_entry_t *entry = (rdb_index_entry_t*)FI_BTREE_NODE_DATA(node);
+        size_t new_length = entry->key_length + moved;
+
+        if (keys[i]) {
+            free(entry->key);
+            entry->key = keys[i];
+            entry->abbrev = rdb_index_abbreviate(keys[i], new_length);
+        } else {
+            uint8_t scratch[RDB_INDEX_ABBREV_SIZE];
+            uint8_t bytes[RDB_INDEX_ABBREV_SIZE];
+            memcpy(bytes, moved_bytes, moved);
+            memcpy(bytes + moved, rdb_index_entry_bytes(entry, scratch), entry->key_length);
+            entry->abbrev = rdb_index_abbreviate(bytes, new_length);
+        }
+        entry->key_length = new_length;
+    }
+
+    free(keys);
+    index->key_prefix_length = length;
+    return 0;
+}
+
+int rdb_index_entry_compare(const void *a, const void *b) {
+    const rdb_index_entry_t *entry_a = (const rdb_index_entry_t*)a;
+    const rdb_index_entry_t *entry_b = (const rdb_index_entry_t*)b;
+
+    /* Zero padding keeps abbreviation order consistent with memcmp order */
+    if (entry_a->abbrev != entry_b->abbrev) {
+        return entry_a->abbrev < entry_b->abbrev ? -1 : 1;
+    }
+
+    if (entry_a->key_length > RDB_INDEX_ABBREV_SIZE && entry_b->key_length > RDB_INDEX_ABBREV_SIZE) {
+        size_t common = entry_a->key_length < entry_b->key_length ?
+                        entry_a->key_length : entry_b->key_length;
+        int cmp = memcmp(entry_a->key + RDB_INDEX_ABBREV_SIZE, entry_b->key + RDB_INDEX_ABBREV_SIZE,
+                         common - RDB_INDEX_ABBREV_SIZE);
+        if (cmp != 0) return cmp;
+    }
+
+    if (entry_a->key_length != entry_b->key_length) {
+        return entry_a->key_length < entry_b->key_length ? -1 : 1;
+    }
+    if (entry_a->row_id != entry_b->row_id) {
+        return entry_a->row_id < entry_b->row_id ? -1 : 1;
+    }
+    return 0;
+}
+
+void rdb_index_destroy(rdb_index_t *index) {
+    if (!index) return;
+
+    if (index->art) {
+        fi_art_destroy(index->art);
+    }
+    if (index->hash) {
+        fi_map_destroy(index->hash);
+    }
+    if (index->tree) {
+        /* Entry keys are owned by the tree */
+        for (fi_btree_node *node = fi_btree_find_min(index->tree->root); node;
+             node = fi_btree_successor(node)) {
+            free(((rdb_index_entry_t*)FI_BTREE_NODE_DATA(node))->key);
+        }
+        fi_btree_destroy(index->tree);
+    }
+    free(index->key_prefix);
+    free(index);
+}
+
+/* Add `row` to `index`. A hash key already held by another row stays with
+ * it unless `take_over`; see rdb_update_table_indexes(). */
+static int rdb_index_add_row(rdb_index_t *index, rdb_table_t *table, rdb_row_t *row, bool take_over) {
+    if (!index || !table || !row || !row->values) return -1;
+    if (index->kind == RDB_INDEX_HASH && rdb_index_row_has_null(index, table, row)) return 0;
+
+    rdb_key_buffer_t buf = {0};
+    if (rdb_index_encode_row(index, table, row, &buf) != 0) {
+        free(buf.data);
+        return -1;
+    }
+
+    if (index->kind == RDB_INDEX_ART) {
+        /* Re-adding the same row just refreshes the stored row pointer */
+        int result = rdb_key_buffer_put_u64(&buf, row->row_id);
+        if (result == 0) result = fi_art_insert(index->art, buf.data, buf.length, &row);
+        free(buf.data);
+        return result;
+    }
+
+    if (index->kind == RDB_INDEX_HASH) {
+        rdb_row_t *holder = rdb_hash_lookup(index, buf.data, buf.length);
+        rdb_hash_key_t key = {buf.data, buf.length};
+        if (holder == row || (holder && !take_over)) {
+            free(buf.data);
+            return holder == row ? 0 : -1;
+        }
+        if (holder) fi_map_remove(index->hash, &key);
+        if (fi_map_put(index->hash, &key, &row) != 0) {
+            free(buf.data);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (fi_btree_size(index->tree) == 0) {
+        /* An empty index takes the whole first key as its shared prefix */
+        uint8_t *prefix = malloc(buf.length ? buf.length : 1);
+        if (!prefix) {
+            free(buf.data);
+            return -1;
+        }
+        memcpy(prefix, buf.data, buf.length);
+        free(index->key_prefix);
+        index->key_prefix = prefix;
+        index->key_prefix_length = buf.length;
+    } else {
+        size_t common = rdb_common_prefix_length(buf.data, buf.length,
+                                                 index->key_prefix, index->key_prefix_length);
+        if (common < index->key_prefix_length && rdb_index_shrink_prefix(index, common) != 0) {
+            free(buf.data);
+            return -1;
+        }
+    }
+
+    const uint8_t *suffix = buf.data + index->key_prefix_length;
+    size_t suffix_length = buf.length - index->key_prefix_length;
+
+    rdb_index_entry_t entry;
+    rdb_index_entry_init(&entry, suffix, suffix_length, row, false);
+    fi_btree_node *existing = fi_btree_search(index->tree, &entry);
+    if (existing) {
+        /* Same row re-added with an unchanged key: just refresh the row pointer */
+        ((rdb_index_entry_t*)FI_BTREE_NODE_DATA(existing))->row = row;
+        free(buf.data);
+        return 0;
+    }
+
+    int result = rdb_index_entry_init(&entry, suffix, suffix_length, row, true);
+    if (result == 0 && fi_btree_insert(index->tree, &entry) != 0) {
+        free(entry.key);
+        result = -1;
+    }
+    if (result == 0 && rdb_index_row_has_misfit(index, table, row)) index->misfit_count++;
+    free(buf.data);
+    return result;
+}
+
+int rdb_index_insert_row(rdb_index_t *index, rdb_table_t *table, rdb_row_t *row) {
+    return rdb_index_add_row(index, table, row, false);
+}
+
+int rdb_index_remove_row(rdb_index_t *index, rdb_table_t *table, rdb_row_t *row) {
+    if (!index || !table || !row || !row->values) return -1;
+    if (index->kind == RDB_INDEX_HASH && rdb_index_row_has_null(index, table, row)) return 0;
+
+    rdb_key_buffer_t buf = {0};
+    if (rdb_index_encode_row(index, table, row, &buf) != 0) {
+        free(buf.data);
+        return -1;
+    }
+
+    if (index->kind == RDB_INDEX_ART) {
+        int result = rdb_key_buffer_put_u64(&buf, row->row_id);
+        if (result == 0) result = fi_art_delete(index->art, buf.data, buf.length);
+        free(buf.data);
+        return result;
+    }
+
+    if (index->kind == RDB_INDEX_HASH) {
+        int result = -1;
+        if (rdb_hash_lookup(index, buf.data, buf.length) == row) {
+            rdb_hash_key_t probe = {buf.data, buf.length};
+            result = fi_map_remove(index->hash, &probe);
+        }
+        free(buf.data);
+        return result;
+    }
+
+    const uint8_t *suffix = NULL;
+    size_t suffix_length = 0;
+    fi_btree_node *node = NULL;
+    if (rdb_index_split_key(index, buf.data, buf.length, &suffix, &suffix_length) == 0 &&
+        suffix_length + index->key_prefix_length == buf.length) {
+        rdb_index_entry_t probe;
+        rdb_index_entry_init(&probe, suffix, suffix_length, row, false);
+        node = fi_btree_search(index->tree, &probe);
+    }
+    free(buf.data);
+    if (!node) return -1;
+
+    uint8_t *stored_key = ((rdb_index_entry_t*)FI_BTREE_NODE_DATA(node))->key;
+    fi_btree_delete_node(index->tree, node);
+    free(stored_key);
+    if (index->misfit_count > 0 && rdb_index_row_has_misfit(index, table, row)) index->misfit_count--;
+    return 0;
+}
+
+/* Callers check uniqueness first, so a key still held by another row here
+ * belongs to a row that is itself changing (an UPDATE moving keys between
+ * rows, or its rollback). The new holder takes the key over; the old one
+ * no longer owns it when its own turn comes, so its removal skips it. */
+static void rdb_index_insert_visit(const void *key, const void *value, void *user_data) {
+    (void)key;
+    rdb_index_row_visit_t *visit = (rdb_index_row_visit_t*)user_data;
+    rdb_index_add_row(*(rdb_index_t**)value, visit->table, visit->row, true);
+}
+
+static void rdb_index_remove_visit(const void *key, const void *value, void *user_data) {
+    (void)key;
+    rdb_index_row_visit_t *visit = (rdb_index_row_visit_t*)user_data;
+    rdb_index_remove_row(*(rdb_index_t**)value, visit->table, visit->row);
+}
+
+void rdb_update_table_indexes(rdb_table_t *table, rdb_row_t *row) {
+    if (!table || !row) return;
+
+    /* Encoded columns reference their dictionary entries */
+    rdb_table_intern_row(table, row);
+
+    if (table->row_map) {
+        uint64_t row_id = row->row_id;
+        fi_map_put(table->row_map, &row_id, &row);
+    }
+
+    /* The columnar copy and the zone maps are maintained like secondary indexes */
+    if (table->column_store) rdb_column_store_append_row(table, row);
+    rdb_zone_map_add_row(table, row);
+    if (!table->indexes || fi_map_empty(table->indexes)) return;
+
+    rdb_index_row_visit_t visit = {table, row};
+    fi_map_for_each(table->indexes, rdb_index_insert_visit, &visit);
+}
+
+void rdb_remove_row_from_indexes(rdb_table_t *table, rdb_row_t *row) {
+    if (!table || !row) return;
+
+    if (table->column_store) rdb_column_store_remove_row(table, row);
+    rdb_zone_map_remove_row(table, row);
+    if (!table->indexes || fi_map_empty(table->indexes)) return;
+
+    rdb_index_row_visit_t visit = {table, row};
+    fi_map_for_each(table->indexes, rdb_index_remove_visit, &visit);
+}
+
+/* Row-id map
+ *
+ * Every table maps row ids to their row objects, so point operations by id
+ * (transaction rollback, WAL replay) cost a hash lookup instead of a scan of
+ * the table. table->rows stays in row_id order, which lets the slot of a
+ * row be found by binary search when it has to be replaced. */
+
+int rdb_table_build_row_map(rdb_table_t *table) {
+    if (!table) return -1;
+
+    size_t row_count = table->rows ? fi_array_count(table->rows) : 0;
+    fi_map *map = fi_map_create(row_count > 16 ? row_count : 16, sizeof(uint64_t), sizeof(rdb_row_t*),
+                                fi_map_hash_int64, fi_map_compare_int64);
+    if (!map) return -1;
+
+    for (size_t i = 0; i < row_count; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (!row) continue;
+
+        uint64_t row_id = row->row_id;
+        if (fi_map_put(map, &row_id, &row) != 0) {
+            fi_map_destroy(map);
+            return -1;
+        }
+    }
+
+    if (table->row_map) fi_map_destroy(table->row_map);
+    table->row_map = map;
+    return 0;
+}
+
+/* Live row with `row_id`, or NULL (tombstoned rows stay in the map until
+ * compaction but are not returned) */
+rdb_row_t* rdb_table_find_row(const rdb_table_t *table, size_t row_id) {
+    if (!table || !table->row_map) return NULL;
+
+    uint64_t key = row_id;
+    rdb_row_t *row = NULL;
+    if (fi_map_get(table->row_map, &key, &row) != 0 || !row || row->deleted) return NULL;
+    return row;
+}
+
+/* First slot whose row id is not below `row_id` */
+size_t rdb_table_lower_slot(const rdb_table_t *table, size_t row_id) {
+    size_t low = 0;
+    size_t high = fi_array_count(table->rows);
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, mid);
+        if (row && row->row_id < row_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int rdb_table_row_slot(const rdb_table_t *table, size_t row_id, size_t *slot) {
+    if (!slot) return -1;
+
+    rdb_row_t *row = rdb_table_find_row(table, row_id);
+    if (!row || !table->rows) return -1;
+
+    size_t count = fi_array_count(table->rows);
+    size_t found = rdb_table_lower_slot(table, row_id);
+    if (found < count && *(rdb_row_t**)fi_array_get(table->rows, found) == row) {
+        *slot = found;
+        return 0;
+    }
+
+    /* Rows out of order (e.g. replayed from a WAL): scan */
+    for (size_t i = 0; i < count; i++) {
+        if (*(rdb_row_t**)fi_array_get(table->rows, i) == row) {
+            *slot = i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Put a row back into table->rows at the slot its row id orders it to.
+ * Callers register it with rdb_update_table_indexes as for new rows. */
+int rdb_table_insert_row_slot(rdb_table_t *table, rdb_row_t *row) {
+    if (!table || !table->rows || !row) return -1;
+
+    size_t slot = rdb_table_lower_slot(table, row->row_id);
+    if (slot >= fi_array_count(table->rows)) {
+        return fi_array_push(table->rows, &row);
+    }
+    return fi_array_splice(table->rows, slot, 0, &row);
+}
+
+/* Re-resolve key column ordinals after a schema change. Indexes that cover
+ * a dropped column are removed. */
+void rdb_refresh_table_indexes(rdb_table_t *table, const char *dropped_column) {
+    if (!table || !table->indexes || fi_map_empty(table->indexes)) return;
+
+    fi_array *indexes = fi_map_values(table->indexes);
+    if (!indexes) return;
+
+    for (size_t i = 0; i < fi_array_count(indexes); i++) {
+        rdb_index_t *index = *(rdb_index_t**)fi_array_get(indexes, i);
+        bool stale = false;
+
+        for (size_t c = 0; c < index->column_count; c++) {
+            if (dropped_column && strcmp(index->column_names[c], dropped_column) == 0) {
+                stale = true;
+                break;
+            }
+            index->column_indexes[c] = rdb_get_column_index(table, index->column_names[c]);
+            if (index->column_indexes[c] < 0) {
+                stale = true;
+                break;
+            }
+        }
+
+        if (stale) {
+            const char *name = index->name;
+            fi_map_remove(table->indexes, &name);
+            printf("Index '%s' dropped from table '%s'\n", index->name, table->name);
+            rdb_index_destroy(index);
+        }
+    }
+
+    fi_array_destroy(indexes);
+}
+
+rdb_index_t* rdb_get_table_index(rdb_table_t *table, const char *index_name) {
+    if (!table || !table->indexes || !index_name) return NULL;
+
+    rdb_index_t *index = NULL;
+    if (fi_map_get(table->indexes, &index_name, &index) != 0) {
+        return NULL;
+    }
+    return index;
+}
+
+/* Build an index over the existing rows and register it with the table.
+ * Returns NULL after printing the reason on failure. */
+static rdb_index_t* rdb_table_add_index(rdb_table_t *table, const char *index_name,
+                                        const char **column_names, size_t column_count,
+                                        rdb_index_kind_t kind) {
+    if (!table->indexes) {
+        table->indexes = fi_map_create(8, sizeof(char*), sizeof(rdb_index_t*),
+                                       fi_map_hash_string, fi_map_compare_string);
+        if (!table->indexes) return NULL;
+    }
+
+    if (rdb_get_table_index(table, index_name)) {
+        printf("Error: Index '%s' already exists in table '%s'\n", index_name, table->name);
+        return NULL;
+    }
+
+    rdb_index_t *index = calloc(1, sizeof(rdb_index_t));
+    if (!index) return NULL;
+
+    strncpy(index->name, index_name, sizeof(index->name) - 1);
+    index->column_count = column_count;
+    index->kind = kind;
+
+    for (size_t i = 0; i < column_count; i++) {
+        int col_index = column_names[i] ? rdb_get_column_index(table, column_names[i]) : -1;
+        if (col_index < 0) {
+            printf("Error: Column '%s' does not exist in table '%s'\n",
+                   column_names[i] ? column_names[i] : "(null)", table->name);
+            free(index);
+            return NULL;
+        }
+        strncpy(index->column_names[i], column_names[i], sizeof(index->column_names[i]) - 1);
+        index->column_indexes[i] = col_index;
+    }
+
+    size_t row_count = table->rows ? fi_array_count(table->rows) : 0;
+    if (kind == RDB_INDEX_ART) {
+        index->art = fi_art_create(sizeof(rdb_row_t*));
+    } else if (kind == RDB_INDEX_HASH) {
+        index->hash = fi_map_create_with_destructors(row_count > 8 ? row_count : 8,
+                                                     sizeof(rdb_hash_key_t), sizeof(rdb_row_t*),
+                                                     rdb_hash_key_hash, rdb_hash_key_compare,
+                                                     rdb_hash_key_free, NULL);
+    } else {
+        index->tree = fi_btree_create(sizeof(rdb_index_entry_t), rdb_index_entry_compare);
+    }
+    if (!index->art && !index->tree && !index->hash) {
+        free(index);
+        return NULL;
+    }
+
+    /* Build index from existing rows */
+    if (index->tree) fi_btree_reserve(index->tree, row_count);
+    for (size_t i = 0; i < row_count; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (row && !row->deleted && row->values && rdb_index_insert_row(index, table, row) != 0) {
+            if (kind == RDB_INDEX_HASH) {
+                printf("Error: Duplicate values in table '%s' prevent building index '%s'\n",
+                       table->name, index->name);
+            }
+            rdb_index_destroy(index);
+            return NULL;
+        }
+    }
+
+    /* The map key points at the name stored inside the index itself */
+    const char *key = index->name;
+    if (fi_map_put(table->indexes, &key, &index) != 0) {
+        rdb_index_destroy(index);
+        return NULL;
+    }
+    return index;
+}
+
+/* Index operations - CREATE INDEX */
+int rdb_create_index_using(rdb_database_t *db, const char *table_name, const char *index_name,
+                           const char **column_names, size_t column_count, rdb_index_kind_t kind) {
+    if (!db || !table_name || !index_name || !column_names || column_count == 0) return -1;
+
+    if (column_count > RDB_MAX_INDEX_COLUMNS) {
+        printf("Error: An index can have at most %d columns\n", RDB_MAX_INDEX_COLUMNS);
+        return -1;
+    }
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return -1;
+    }
+
+    rdb_index_t *index = rdb_table_add_index(table, index_name, column_names, column_count, kind);
+    if (!index) return -1;
+
+    printf("Index '%s' created on column%s '", index->name, column_count > 1 ? "s" : "");
+    for (size_t i = 0; i < column_count; i++) {
+        printf("%s%s", i ? ", " : "", index->column_names[i]);
+    }
+    printf("' in table '%s'%s\n", table_name, kind == RDB_INDEX_ART ? " using ART" :
+                                               kind == RDB_INDEX_HASH ? " using HASH" : "");
+    return 0;
+}
+
+int rdb_create_composite_index(rdb_database_t *db, const char *table_name, const char *index_name,
+                               const char **column_names, size_t column_count) {
+    return rdb_create_index_using(db, table_name, index_name, column_names, column_count,
+                                  RDB_INDEX_BTREE);
+}
+
+int rdb_create_index(rdb_database_t *db, const char *table_name, const char *index_name,
+                     const char *column_name) {
+    return rdb_create_composite_index(db, table_name, index_name, &column_name, 1);
+}
+
+/* Index operations - DROP INDEX */
+int rdb_drop_index(rdb_database_t *db, const char *table_name, const char *index_name) {
+    if (!db || !table_name || !index_name) return -1;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return -1;
+    }
+
+    rdb_index_t *index = rdb_get_table_index(table, index_name);
+    if (!index) {
+        printf("Error: Index '%s' does not exist in table '%s'\n", index_name, table_name);
+        return -1;
+    }
+
+    if (index->kind == RDB_INDEX_HASH) {
+        printf("Error: Index '%s' enforces a PRIMARY KEY or UNIQUE constraint of table '%s'\n",
+               index_name, table_name);
+        return -1;
+    }
+
+    /* Remove index from map and destroy it */
+    fi_map_remove(table->indexes, &index_name);
+    rdb_index_destroy(index);
+
+    printf("Index '%s' dropped from table '%s'\n", index_name, table_name);
+    return 0;
+}
+
+/* Index operations - GET INDEX (ordered indexes only) */
+fi_btree* rdb_get_index(rdb_database_t *db, const char *table_name, const char *index_name) {
+    if (!db || !table_name || !index_name) return NULL;
+
+    rdb_index_t *index = rdb_get_table_index(rdb_get_table(db, table_name), index_name);
+    return index ? index->tree : NULL;
+}
+
+/* ===== CONSTRAINTS ===== */
+
+/* Name of the hash index enforcing the constraint on `col` */
+static void rdb_constraint_index_name(const rdb_table_t *table, const rdb_column_t *col,
+                                      char *name, size_t size) {
+    if (col->primary_key && strcmp(table->primary_key, col->name) == 0) {
+        snprintf(name, size, "%.50s_pkey", table->name);
+    } else {
+        snprintf(name, size, "%.30s_%.27s_key", table->name, col->name);
+    }
+}
+
+static rdb_index_t* rdb_constraint_index(rdb_table_t *table, const rdb_column_t *col) {
+    char name[64];
+    rdb_constraint_index_name(table, col, name, sizeof(name));
+    rdb_index_t *index = rdb_get_table_index(table, name);
+    return index && index->kind == RDB_INDEX_HASH ? index : NULL;
+}
+
+/* Create the hash index of every PRIMARY KEY and UNIQUE column that does
+ * not have one yet. Fails when existing rows already hold duplicates. */
+int rdb_table_create_constraint_indexes(rdb_table_t *table) {
+    if (!table || !table->columns) return -1;
+
+    int result = 0;
+    for (size_t i = 0; i < fi_array_count(table->columns); i++) {
+        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
+        if (!col || (!col->primary_key && !col->unique) || rdb_constraint_index(table, col)) continue;
+
+        char name[64];
+        rdb_constraint_index_name(table, col, name, sizeof(name));
+        const char *column_name = col->name;
+        if (!rdb_table_add_index(table, name, &column_name, 1, RDB_INDEX_HASH)) result = -1;
+    }
+    return result;
+}
+
+/* Make sure some index is led by `column_name`, building `index_name` over
+ * it otherwise. Used for the referencing side of foreign keys. */
+int rdb_table_ensure_column_index(rdb_table_t *table, const char *column_name,
+                                  const char *index_name) {
+    if (!table || !column_name || !index_name) return -1;
+
+    int col_index = rdb_get_column_index(table, column_name);
+    if (col_index < 0) return -1;
+
+    fi_array *indexes = table->indexes ? fi_map_values(table->indexes) : NULL;
+    bool found = false;
+    for (size_t i = 0; indexes && i < fi_array_count(indexes) && !found; i++) {
+        rdb_index_t *index = *(rdb_index_t**)fi_array_get(indexes, i);
+        found = index->column_indexes[0] == col_index;
+    }
+    if (indexes) fi_array_destroy(indexes);
+    if (found) return 0;
+
+    return rdb_table_add_index(table, index_name, &column_name, 1, RDB_INDEX_BTREE) ? 0 : -1;
+}
+
+/* Whether two key values are the same value. A hash hit only says their
+ * encodings agree; the values themselves decide. */
+static bool rdb_key_values_equal(const rdb_value_t *a, const rdb_value_t *b) {
+    if (!a || !b || a->is_null || b->is_null) return false;
+    bool comparable;
+    return rdb_condition_compare(a, b, &comparable) == 0 && comparable;
+}
+
+/* Value of column `col_index` in `row`, or NULL */
+static const rdb_value_t* rdb_row_column_value(const rdb_row_t *row, int col_index) {
+    if (!row || !row->values || col_index < 0 || col_index >= (int)fi_array_count(row->values)) return NULL;
+    return *(rdb_value_t**)fi_array_get(row->values, col_index);
+}
+
+/* Whether a row other than `self` holds `value` in the constraint's
+ * column. NULLs never conflict. */
+static bool rdb_constraint_conflict(rdb_table_t *table, rdb_index_t *index,
+                                    const rdb_value_t *value, const rdb_row_t *self) {
+    int col_index = index->column_indexes[0];
+    rdb_data_type_t type = rdb_index_column_type(table, col_index);
+    if (!rdb_index_value_fits(type, value)) return false;
+
+    rdb_key_buffer_t buf = {0};
+    rdb_row_t *holder = NULL;
+    if (rdb_index_encode_value(&buf, type, value) == 0) {
+        holder = rdb_hash_lookup(index, buf.data, buf.length);
+    }
+    free(buf.data);
+    return holder && holder != self && rdb_key_values_equal(rdb_row_column_value(holder, col_index), value);
+}
+
+static int rdb_constraint_violation(rdb_table_t *table, const rdb_column_t *col,
+                                    const rdb_value_t *value) {
+    const char *constraint = col->primary_key ? "PRIMARY KEY" : "UNIQUE";
+    if (!value || value->is_null) {
+        printf("Error: %s column '%s' of table '%s' cannot be NULL\n",
+               constraint, col->name, table->name);
+        return -1;
+    }
+
+    char *text = rdb_value_to_string(value);
+    printf("Error: Duplicate value %s for column '%s' violates the %s constraint of table '%s'\n",
+           text ? text : "?", col->name, constraint, table->name);
+    free(text);
+    return -1;
+}
+
+/* Check a row about to be inserted. Returns 0 when every PRIMARY KEY and
+ * UNIQUE column takes a value no other live row holds, -1 otherwise. */
+int rdb_table_check_unique(rdb_table_t *table, const rdb_row_t *row) {
+    if (!table || !row || !row->values) return -1;
+
+    for (size_t i = 0; i < fi_array_count(table->columns); i++) {
+        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
+        if (!col || (!col->primary_key && !col->unique)) continue;
+
+        rdb_value_t *value = NULL;
+        if (i < fi_array_count(row->values)) value = *(rdb_value_t**)fi_array_get(row->values, i);
+        if (col->primary_key && (!value || value->is_null)) {
+            return rdb_constraint_violation(table, col, value);
+        }
+
+        rdb_index_t *index = rdb_constraint_index(table, col);
+        if (index && rdb_constraint_conflict(table, index, value, row)) {
+            return rdb_constraint_violation(table, col, value);
+        }
+    }
+    return 0;
+}
+
+/* Check an UPDATE of `rows` before any of them changes, so a violation
+ * leaves the table untouched. Every updated row takes the same new value,
+ * so more than one row can never share a non-NULL value of a constrained
+ * column; a single row only conflicts with rows outside the update. */
+int rdb_table_check_unique_update(rdb_table_t *table, fi_array *rows,
+                                  fi_array *set_columns, fi_array *set_values) {
+    if (!table || !rows || !set_columns || !set_values) return -1;
+
+    size_t row_count = fi_array_count(rows);
+    if (row_count == 0) return 0;
+
+    for (size_t i = 0; i < fi_array_count(table->columns); i++) {
+        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
+        if (!col || (!col->primary_key && !col->unique)) continue;
+
+        /* The last assignment to a column is the one that sticks */
+        const rdb_value_t *value = NULL;
+        bool assigned = false;
+        for (size_t j = 0; j < fi_array_count(set_columns) && j < fi_array_count(set_values); j++) {
+            const char *col_name = *(const char**)fi_array_get(set_columns, j);
+            if (col_name && strcmp(col_name, col->name) == 0) {
+                value = *(rdb_value_t**)fi_array_get(set_values, j);
+                assigned = true;
+            }
+        }
+        if (!assigned) continue;
+
+        if (col->primary_key && (!value || value->is_null)) {
+            return rdb_constraint_violation(table, col, value);
+        }
+        if (!rdb_index_value_fits(col->type, value)) continue;
+        if (row_count > 1) return rdb_constraint_violation(table, col, value);
+
+        rdb_index_t *index = rdb_constraint_index(table, col);
+        rdb_row_t *self = *(rdb_row_t**)fi_array_get(rows, 0);
+        if (index && rdb_constraint_conflict(table, index, value, self)) {
+            return rdb_constraint_violation(table, col, value);
+        }
+    }
+    return 0;
+}
+
+/* Check an UPDATE whose rows each take their own new values (SET
+ * expressions). row_values[i] holds the values assigned to rows[i], in
+ * set_columns order. The new values of a constrained column must differ
+ * between the updated rows, and a value may only be held already by a row
+ * that is itself being updated. */
+int rdb_table_check_unique_assignments(rdb_table_t *table, fi_array *rows,
+                                       fi_array *set_columns, fi_array *row_values) {
+    if (!table || !rows || !set_columns || !row_values) return -1;
+
+    size_t row_count = fi_array_count(rows);
+    if (row_count == 0) return 0;
+    if (fi_array_count(row_values) != row_count) return -1;
+
+    fi_map *updated = NULL;
+    int result = 0;
+
+    for (size_t i = 0; i < fi_array_count(table->columns) && result == 0; i++) {
+        rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, i);
+        if (!col || (!col->primary_key && !col->unique)) continue;
+
+        /* The last assignment to a column is the one that sticks */
+        int slot = -1;
+        for (size_t j = 0; j < fi_array_count(set_columns); j++) {
+            const char *col_name = *(const char**)fi_array_get(set_columns, j);
+            if (col_name && strcmp(col_name, col->name) == 0) slot = (int)j;
+        }
+        if (slot < 0) continue;
+
+        /* Row ids of the updated rows, built the first time it is needed */
+        if (!updated) {
+            updated = fi_map_create(row_count > 16 ? row_count : 16, sizeof(uint64_t), sizeof(rdb_row_t*),
+                                    fi_map_hash_int64, fi_map_compare_int64);
+            for (size_t r = 0; updated && r < row_count; r++) {
+                rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, r);
+                uint64_t row_id = row->row_id;
+                fi_map_put(updated, &row_id, &row);
+            }
+            if (!updated) return -1;
+        }
+
+        /* Encoded new value -> the new value, per updated row */
+        fi_map *seen = fi_map_create_with_destructors(row_count > 8 ? row_count : 8,
+                                                      sizeof(rdb_hash_key_t), sizeof(rdb_value_t*),
+                                                      rdb_hash_key_hash, rdb_hash_key_compare,
+                                                      rdb_hash_key_free, NULL);
+        if (!seen) {
+            result = -1;
+            break;
+        }
+
+        rdb_index_t *index = rdb_constraint_index(table, col);
+        for (size_t r = 0; r < row_count && result == 0; r++) {
+            fi_array *values = *(fi_array**)fi_array_get(row_values, r);
+            const rdb_value_t *value = NULL;
+            if (values && (size_t)slot < fi_array_count(values)) {
+                value = *(rdb_value_t**)fi_array_get(values, slot);
+            }
+
+            if (col->primary_key && (!value || value->is_null)) {
+                result = rdb_constraint_violation(table, col, value);
+                break;
+            }
+            if (!rdb_index_value_fits(col->type, value)) continue;
+
+            rdb_key_buffer_t buf = {0};
+            if (rdb_index_encode_value(&buf, col->type, value) != 0) {
+                free(buf.data);
+                result = -1;
+                break;
+            }
+
+            /* A current holder outside the update keeps its value */
+            rdb_hash_key_t key = {buf.data, buf.length};
+            rdb_row_t *holder = index ? rdb_hash_lookup(index, buf.data, buf.length) : NULL;
+            bool conflict = false;
+            if (holder) {
+                uint64_t holder_id = holder->row_id;
+                conflict = !fi_map_contains(updated, &holder_id) &&
+                           rdb_key_values_equal(rdb_row_column_value(holder, (int)i), value);
+            }
+            const rdb_value_t *taken = NULL;
+            if (!conflict && fi_map_get(seen, &key, &taken) == 0) {
+                conflict = rdb_key_values_equal(taken, value);
+            }
+
+            if (conflict) {
+                free(buf.data);
+                result = rdb_constraint_violation(table, col, value);
+            } else if (taken) {
+                free(buf.data);
+            } else if (fi_map_put(seen, &key, &value) != 0) {
+                free(buf.data);
+                result = -1;
+            }
+        }
+        fi_map_destroy(seen);
+    }
+
+    if (updated) fi_map_destroy(updated);
+    return result;
+}
+
+/* ===== QUERY PLANNING ===== */
+
+static bool rdb_conditions_are_conjunctive(fi_array *conditions) {
+    for (size_t i = 0; i + 1 < fi_array_count(conditions); i++) {
+        sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(conditions, i);
+        if (cond && strcasecmp(cond->logical_connector, "OR") == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Look for a condition on `column` with one of the given operators whose
+ * value can be probed against the index */
+static const rdb_value_t* rdb_find_probe(fi_array *conditions, const char *column,
+                                         rdb_data_type_t column_type,
+                                         sql_operator_t op1, sql_operator_t op2) {
+    for (size_t i = 0; i < fi_array_count(conditions); i++) {
+        sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(conditions, i);
+        if (!cond || strcmp(cond->column_name, column) != 0) continue;
+        if (cond->operator != op1 && cond->operator != op2) continue;
+        if (rdb_index_value_fits(column_type, cond->value)) {
+            return cond->value;
+        }
+    }
+    return NULL;
+}
+
+/* Literal prefix of a LIKE pattern on a string column, up to the first
+ * wildcard. Patterns that start with a wildcard have no usable prefix. */
+static const char* rdb_find_like_prefix(fi_array *conditions, const char *column,
+                                        rdb_data_type_t column_type, size_t *length) {
+    if (!rdb_is_string_type(column_type)) return NULL;
+
+    for (size_t i = 0; i < fi_array_count(conditions); i++) {
+        sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(conditions, i);
+        if (!cond || cond->operator != SQL_OP_LIKE || strcmp(cond->column_name, column) != 0) continue;
+        if (!rdb_index_value_fits(column_type, cond->value)) continue;
+
+        const char *pattern = rdb_get_string_value(cond->value);
+        size_t literal = strcspn(pattern, "%_");
+        if (literal > 0) {
+            *length = literal;
+            return pattern;
+        }
+    }
+    return NULL;
+}
+
+static void rdb_index_plan_visit(const void *key, const void *value, void *user_data) {
+    (void)key;
+    rdb_index_planner_t *planner = (rdb_index_planner_t*)user_data;
+    rdb_index_t *index = *(rdb_index_t**)value;
+    rdb_index_plan_t plan = {0};
+    plan.index = index;
+
+    /* Longest prefix of key columns bound by equality */
+    while (plan.eq_count < index->column_count) {
+        size_t c = plan.eq_count;
+        rdb_data_type_t type = rdb_index_column_type(planner->table, index->column_indexes[c]);
+        const rdb_value_t *probe = rdb_find_probe(planner->conditions, index->column_names[c],
+                                                  type, SQL_OP_EQUAL, SQL_OP_IN);
+        if (!probe) break;
+        plan.eq_values[plan.eq_count++] = probe;
+    }
+
+    /* A hash index answers equality on the whole key and nothing else */
+    if (index->kind == RDB_INDEX_HASH && plan.eq_count < index->column_count) return;
+
+    /* Optional range on the column that follows the prefix */
+    if (plan.eq_count < index->column_count) {
+        size_t c = plan.eq_count;
+        rdb_data_type_t type = rdb_index_column_type(planner->table, index->column_indexes[c]);
+        plan.low = rdb_find_probe(planner->conditions, index->column_names[c], type,
+                                  SQL_OP_GREATER_THAN, SQL_OP_GREATER_EQUAL);
+        plan.high = rdb_find_probe(planner->conditions, index->column_names[c], type,
+                                   SQL_OP_LESS_THAN, SQL_OP_LESS_EQUAL);
+
+        /* A radix tree can only follow prefixes */
+        if (index->kind == RDB_INDEX_ART) {
+            plan.low = NULL;
+            plan.high = NULL;
+        }
+        if (!plan.low && !plan.high) {
+            plan.like_prefix = rdb_find_like_prefix(planner->conditions, index->column_names[c],
+                                                    type, &plan.like_length);
+        }
+    }
+
+    /* Prefer more equality columns, then a bounded range, then narrower indexes.
+     * A LIKE prefix bounds the column on both sides. */
+    size_t score = plan.eq_count * 4 + (plan.low ? 1 : 0) + (plan.high ? 1 : 0) +
+                   (plan.like_prefix ? 2 : 0);
+    if (score == 0) return;
+    if (plan.eq_count == index->column_count) {
+        /* A unique hash probe yields at most one row: nothing beats it */
+        score += index->kind == RDB_INDEX_HASH ? RDB_MAX_INDEX_COLUMNS * 4 : 1;
+        if (planner->exact_count < RDB_MAX_INDEX_INTERSECT) {
+            planner->exact[planner->exact_count++] = plan;
+        }
+    }
+
+    if (score > planner->best_score ||
+        (score == planner->best_score &&
+         index->column_count < planner->best.index->column_count)) {
+        planner->best = plan;
+        planner->best_score = score;
+    }
+}
+
+static bool rdb_collect_art_row(const uint8_t *key, size_t key_length, void *value, void *user_data) {
+    (void)key;
+    (void)key_length;
+    return fi_array_push((fi_array*)user_data, value) == 0;
+}
+
+/* Whether `a` and `b` agree on the first `columns` key columns of `index` */
+static bool rdb_index_same_run(const rdb_index_t *index, size_t columns, const rdb_row_t *a,
+                               const rdb_row_t *b) {
+    for (size_t i = 0; i < columns; i++) {
+        size_t column = (size_t)index->column_indexes[i];
+        const rdb_value_t *va = column < fi_array_count(a->values) ?
+                                *(rdb_value_t**)fi_array_get(a->values, column) : NULL;
+        const rdb_value_t *vb = column < fi_array_count(b->values) ?
+                                *(rdb_value_t**)fi_array_get(b->values, column) : NULL;
+        if (rdb_sort_value_compare(va, vb) != 0) return false;
+    }
+    return true;
+}
+
+/* Whether the walk of `plan` may stop before `row`: the limit is reached
+ * and `row` does not continue the run of the last row taken */
+static bool rdb_index_scan_full(const rdb_index_plan_t *plan, fi_array *rows, const rdb_row_t *row) {
+    size_t count = fi_array_count(rows);
+    if (!plan->limit || count < plan->limit) return false;
+    if (!plan->run_columns) return true;
+    const rdb_row_t *last = *(rdb_row_t**)fi_array_get(rows, count - 1);
+    return !rdb_index_same_run(plan->index, plan->run_columns, last, row);
+}
+
+static int rdb_row_id_compare(const void *a, const void *b) {
+    size_t id_a = (*(rdb_row_t* const*)a)->row_id;
+    size_t id_b = (*(rdb_row_t* const*)b)->row_id;
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+/* Put every run of `rows` (see rdb_index_plan_t.run_columns) in row id
+ * order. A reverse walk meets equal keys by descending row id, and an index
+ * longer than the run orders them by its later columns. */
+static int rdb_index_sort_runs(const rdb_index_plan_t *plan, fi_array *rows) {
+    size_t count = fi_array_count(rows);
+    rdb_row_t **run = malloc((count ? count : 1) * sizeof(rdb_row_t*));
+    if (!run) return -1;
+
+    size_t start = 0;
+    for (size_t i = 0; i <= count; i++) {
+        if (i < count) run[i] = *(rdb_row_t**)fi_array_get(rows, i);
+        if (i < count && rdb_index_same_run(plan->index, plan->run_columns, run[start], run[i])) continue;
+
+        if (i - start > 1) {
+            qsort(run + start, i - start, sizeof(rdb_row_t*), rdb_row_id_compare);
+            for (size_t r = start; r < i; r++) *(rdb_row_t**)fi_array_get(rows, r) = run[r];
+        }
+        start = i;
+    }
+    free(run);
+    return 0;
+}
+
+/* Collect the rows reachable through the plan's key range. Bounds are
+ * inclusive; strict comparisons are left to the residual filter.
+ *
+ * With P the encoded equality prefix, the scan starts at P||lo and stops at
+ * the first key that sorts above P||hi over their common length. That one
+ * test covers both leaving the prefix and passing the upper bound. */
+static fi_array* rdb_index_scan(rdb_table_t *table, const rdb_index_plan_t *plan) {
+    rdb_index_t *index = plan->index;
+    rdb_key_buffer_t start = {0};
+    rdb_key_buffer_t limit = {0};
+    fi_array *rows = NULL;
+
+    for (size_t i = 0; i < plan->eq_count; i++) {
+        rdb_data_type_t type = rdb_index_column_type(table, index->column_indexes[i]);
+        if (rdb_index_encode_value(&start, type, plan->eq_values[i]) != 0) goto done;
+    }
+    if (start.length && rdb_key_buffer_put(&limit, start.data, start.length) != 0) goto done;
+
+    if (plan->eq_count < index->column_count) {
+        rdb_data_type_t type = rdb_index_column_type(table, index->column_indexes[plan->eq_count]);
+        if (plan->low && rdb_index_encode_value(&start, type, plan->low) != 0) goto done;
+        if (plan->high && rdb_index_encode_value(&limit, type, plan->high) != 0) goto done;
+    }
+
+    if (plan->like_prefix) {
+        /* The string component without its terminator is a key prefix */
+        uint8_t marker = 0x01;
+        if (rdb_key_buffer_put(&start, &marker, 1) != 0 ||
+            rdb_key_buffer_put(&start, plan->like_prefix, plan->like_length) != 0 ||
+            rdb_key_buffer_put(&limit, &marker, 1) != 0 ||
+            rdb_key_buffer_put(&limit, plan->like_prefix, plan->like_length) != 0) {
+            goto done;
+        }
+    }
+
+    rows = fi_array_create(16, sizeof(rdb_row_t*));
+    if (!rows) goto done;
+
+    if (index->kind == RDB_INDEX_ART) {
+        fi_art_prefix_iterate(index->art, start.data, start.length, rdb_collect_art_row, rows);
+        goto done;
+    }
+
+    if (index->kind == RDB_INDEX_HASH) {
+        rdb_row_t *row = rdb_hash_lookup(index, start.data, start.length);
+        if (row) fi_array_push(rows, &row);
+        goto done;
+    }
+
+    /* Translate both bounds past the shared key prefix */
+    const uint8_t *start_suffix = NULL, *limit_suffix = NULL;
+    size_t start_length = 0, limit_length = 0;
+    int start_pos = rdb_index_split_key(index, start.data, start.length, &start_suffix, &start_length);
+    int limit_pos = limit.length ? rdb_index_split_key(index, limit.data, limit.length,
+                                                       &limit_suffix, &limit_length) : 1;
+    if (start_pos > 0 || limit_pos < 0) goto done;
+
+    if (plan->reverse) {
+        for (fi_btree_node *node = fi_btree_find_max(index->tree->root); node;
+             node = fi_btree_predecessor(node)) {
+            rdb_row_t *row = ((rdb_index_entry_t*)FI_BTREE_NODE_DATA(node))->row;
+            if (rdb_index_scan_full(plan, rows, row)) break;
+            fi_array_push(rows, &row);
+        }
+        goto done;
+    }
+
+    fi_btree_node *node;
+    if (start_pos < 0 || start_length == 0) {
+        node = fi_btree_find_min(index->tree->root);
+    } else {
+        rdb_index_entry_t probe;
+        rdb_index_entry_init(&probe, start_suffix, start_length, NULL, false);
+        node = fi_btree_lower_bound(index->tree, &probe);
+    }
+
+    for (; node; node = fi_btree_successor(node)) {
+        rdb_index_entry_t *entry = (rdb_index_entry_t*)FI_BTREE_NODE_DATA(node);
+
+        if (limit_pos == 0) {
+            uint8_t scratch[RDB_INDEX_ABBREV_SIZE];
+            size_t common = entry->key_length < limit_length ? entry->key_length : limit_length;
+            if (common && memcmp(rdb_index_entry_bytes(entry, scratch), limit_suffix, common) > 0) {
+                break;
+            }
+        }
+
+        if (rdb_index_scan_full(plan, rows, entry->row)) break;
+        fi_array_push(rows, &entry->row);
+    }
+
+done:
+    free(start.data);
+    free(limit.data);
+    return rows;
+}
+
+static bool rdb_collect_row(const void *data, void *user_data) {
+    return fi_array_push((fi_array*)user_data, data) == 0;
+}
+
+/* Whether `plan` binds a column that none of the `used` plans bind */
+static bool rdb_index_plan_adds_columns(const rdb_index_plan_t *plan,
+                                        const rdb_index_plan_t **used, size_t used_count) {
+    for (size_t c = 0; c < plan->index->column_count; c++) {
+        bool covered = false;
+        for (size_t u = 0; u < used_count && !covered; u++) {
+            for (size_t k = 0; k < used[u]->index->column_count; k++) {
+                if (used[u]->index->column_indexes[k] == plan->index->column_indexes[c]) {
+                    covered = true;
+                    break;
+                }
+            }
+        }
+        if (!covered) return true;
+    }
+    return false;
+}
+
+/* Narrow the candidates of a fully bound equality plan with the other such
+ * plans, e.g. "a = ? AND b = ?" over single-column indexes on a and b.
+ * Equal keys are ordered by row id, so every one of these scans comes back
+ * in row id order and each narrowing step is a single linear merge. */
+static fi_array* rdb_index_intersect(rdb_table_t *table, rdb_index_planner_t *planner,
+                                     fi_array *candidates) {
+    const rdb_index_plan_t *used[RDB_MAX_INDEX_INTERSECT + 1];
+    size_t used_count = 0;
+    used[used_count++] = &planner->best;
+
+    for (size_t i = 0; i < planner->exact_count && fi_array_count(candidates) > 0; i++) {
+        const rdb_index_plan_t *plan = &planner->exact[i];
+        if (!rdb_index_plan_adds_columns(plan, used, used_count)) continue;
+
+        fi_array *other = rdb_index_scan(table, plan);
+        fi_btree *set = fi_btree_from_sorted_array(candidates, rdb_row_id_compare);
+        fi_array *narrowed = fi_array_create(fi_array_count(candidates), sizeof(rdb_row_t*));
+        if (!other || !set || !narrowed) {
+            if (other) fi_array_destroy(other);
+            if (set) fi_btree_destroy(set);
+            if (narrowed) fi_array_destroy(narrowed);
+            break;
+        }
+
+        fi_btree_merge_array(set, other, FI_BTREE_SET_INTERSECT, rdb_collect_row, narrowed);
+        fi_array_destroy(other);
+        fi_btree_destroy(set);
+        fi_array_destroy(candidates);
+        candidates = narrowed;
+        used[used_count++] = plan;
+    }
+
+    return candidates;
+}
+
+/* Estimated share of the table `plan` reads, from the ANALYZE statistics
+ * of the conditions it binds, or a negative value when unknown */
+static double rdb_index_plan_fraction(rdb_table_t *table, const rdb_index_plan_t *plan,
+                                      fi_array *conditions) {
+    if (!table->stats) return -1.0;
+
+    bool ranged = plan->low || plan->high || plan->like_prefix;
+    double fraction = 1.0;
+    bool known = false;
+    for (size_t i = 0; i < fi_array_count(conditions); i++) {
+        sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(conditions, i);
+        if (!cond || cond->expr) continue;
+
+        for (size_t c = 0; c < plan->eq_count + (ranged ? 1 : 0); c++) {
+            if (strcmp(plan->index->column_names[c], cond->column_name) != 0) continue;
+
+            bool equality = cond->operator == SQL_OP_EQUAL || cond->operator == SQL_OP_IN;
+            if (c < plan->eq_count ? !equality : equality) continue;
+
+            double selectivity = rdb_stats_condition_selectivity(table, cond);
+            if (selectivity >= 0.0) {
+                fraction *= selectivity;
+                known = true;
+            }
+            break;
+        }
+    }
+    return known ? fraction : -1.0;
+}
+
+/* Rows of `table` that satisfy the WHERE conditions. Uses the best matching
+ * index when the conditions are a plain conjunction and the table's
+ * statistics do not expect it to return much of the table, otherwise scans
+ * the table (only the blocks its zone maps allow), and evaluates the
+ * conditions over the candidates in batches. The returned array holds
+ * borrowed row pointers. */
+fi_array* rdb_find_matching_rows(rdb_table_t *table, fi_array *where_conditions) {
+    return rdb_find_matching_rows_limit(table, where_conditions, 0);
+}
+
+/* The same, stopping once `limit` rows matched (0 for no limit) */
+fi_array* rdb_find_matching_rows_limit(rdb_table_t *table, fi_array *where_conditions, size_t limit) {
+    if (!table) return NULL;
+
+    fi_array *candidates = NULL;
+    bool has_conditions = where_conditions && fi_array_count(where_conditions) > 0;
+    if (has_conditions) rdb_bind_dictionary_conditions(table, where_conditions);
+
+    if (has_conditions && table->indexes && !fi_map_empty(table->indexes) &&
+        rdb_conditions_are_conjunctive(where_conditions)) {
+        rdb_index_planner_t planner = {0};
+        planner.table = table;
+        planner.conditions = where_conditions;
+        fi_map_for_each(table->indexes, rdb_index_plan_visit, &planner);
+
+        /* Walking an index over a large share of the table costs more than
+         * scanning it */
+        if (planner.best_score > 0 &&
+            rdb_index_plan_fraction(table, &planner.best, where_conditions) > RDB_INDEX_MAX_FRACTION) {
+            planner.best_score = 0;
+        }
+
+        if (planner.best_score > 0) {
+            candidates = rdb_index_scan(table, &planner.best);
+            if (candidates && planner.best.eq_count == planner.best.index->column_count &&
+                planner.best.index->kind != RDB_INDEX_HASH) {
+                candidates = rdb_index_intersect(table, &planner, candidates);
+            }
+        }
+    }
+
+    /* Without a usable index, read only the blocks the zone maps allow */
+    if (has_conditions && !candidates) {
+        candidates = rdb_zone_map_candidates(table, where_conditions);
+    }
+
+    /* A full scan of a columnar table reads its column vectors */
+    if (!candidates && table->column_store) {
+        fi_array *result = rdb_column_store_filter_rows(table, has_conditions ? where_conditions : NULL,
+                                                        limit);
+        if (result) return result;
+    }
+
+    /* Filter the candidates a batch at a time */
+    fi_array *source = candidates ? candidates : table->rows;
+    fi_array *result = rdb_batch_filter_rows_limit(table, source, has_conditions ? where_conditions : NULL,
+                                                   limit);
+
+    if (candidates) fi_array_destroy(candidates);
+    return result;
+}
+
+/* Live rows of `table` whose column `column_index` equals `value`, at most
+ * `limit` of them (0 for no limit). Probes the column's hash index or an
+ * index led by the column when there is one, and scans the table otherwise.
+ * The returned array holds borrowed row pointers. */
+fi_array* rdb_table_rows_with_value(rdb_table_t *table, int column_index,
+                                    const rdb_value_t *value, size_t limit) {
+    if (!table || column_index < 0 || !value) return NULL;
+
+    rdb_index_plan_t plan = {0};
+    if (table->indexes && rdb_index_value_fits(rdb_index_column_type(table, column_index), value)) {
+        fi_array *indexes = fi_map_values(table->indexes);
+        for (size_t i = 0; indexes && i < fi_array_count(indexes); i++) {
+            rdb_index_t *index = *(rdb_index_t**)fi_array_get(indexes, i);
+            if (index->column_indexes[0] != column_index) continue;
+            if (index->kind == RDB_INDEX_HASH && index->column_count > 1) continue;
+            if (!plan.index || index->kind == RDB_INDEX_HASH) plan.index = index;
+        }
+        if (indexes) fi_array_destroy(indexes);
+    }
+
+    fi_array *candidates = NULL;
+    if (plan.index) {
+        plan.eq_count = 1;
+        plan.eq_values[0] = value;
+        candidates = rdb_index_scan(table, &plan);
+    }
+
+    fi_array *source = candidates ? candidates : table->rows;
+    fi_array *result = fi_array_create(limit ? limit : 16, sizeof(rdb_row_t*));
+    for (size_t i = 0; result && source && i < fi_array_count(source); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(source, i);
+        if (!row || row->deleted || !row->values) continue;
+        if (column_index >= (int)fi_array_count(row->values)) continue;
+
+        rdb_value_t *row_value = *(rdb_value_t**)fi_array_get(row->values, column_index);
+        if (!row_value || row_value->is_null || rdb_value_compare(&value, &row_value) != 0) continue;
+
+        fi_array_push(result, &row);
+        if (limit && fi_array_count(result) >= limit) break;
+    }
+
+    if (candidates) fi_array_destroy(candidates);
+    return result;
+}
+
+/* A B-tree index of `table` whose leading columns are `column_indexes`,
+ * in that order or, with `any_order`, in some order */
+static rdb_index_t* rdb_index_find_leading(rdb_table_t *table, const int *column_indexes,
+                                           size_t column_count, bool any_order) {
+    rdb_index_t *found = NULL;
+    fi_array *indexes = fi_map_values(table->indexes);
+    for (size_t i = 0; indexes && i < fi_array_count(indexes) && !found; i++) {
+        rdb_index_t *index = *(rdb_index_t**)fi_array_get(indexes, i);
+        if (index->kind != RDB_INDEX_BTREE || index->column_count < column_count) continue;
+        /* Misfit values sort with the NULLs, so the walk would not be in value order */
+        if (index->misfit_count > 0) continue;
+
+        bool leads = true;
+        for (size_t c = 0; c < column_count && leads; c++) {
+            if (!any_order) {
+                leads = index->column_indexes[c] == column_indexes[c];
+                continue;
+            }
+            leads = false;
+            for (size_t k = 0; k < column_count; k++) {
+                if (index->column_indexes[k] == column_indexes[c]) leads = true;
+            }
+        }
+        if (leads) found = index;
+    }
+    if (indexes) fi_array_destroy(indexes);
+    return found;
+}
+
+/* Walk `plan` and keep the live rows that satisfy `where_conditions`, at
+ * most `limit` of them (0 for all). Without conditions the walk itself
+ * stops at the limit. */
+static fi_array* rdb_index_scan_filtered(rdb_table_t *table, rdb_index_plan_t *plan,
+                                         fi_array *where_conditions, size_t limit) {
+    bool has_conditions = where_conditions && fi_array_count(where_conditions) > 0;
+    if (!has_conditions) plan->limit = limit;
+
+    fi_array *ordered = rdb_index_scan(table, plan);
+    if (!ordered) return NULL;
+    if (plan->run_columns && rdb_index_sort_runs(plan, ordered) != 0) {
+        fi_array_destroy(ordered);
+        return NULL;
+    }
+
+    if (has_conditions) rdb_bind_dictionary_conditions(table, where_conditions);
+    fi_array *result = rdb_batch_filter_rows_limit(table, ordered, has_conditions ? where_conditions : NULL,
+                                                   limit);
+    fi_array_destroy(ordered);
+    return result;
+}
+
+/* Live rows of `table` that satisfy `where_conditions`, in the key order of
+ * a B-tree index whose leading columns are `column_indexes` in some order,
+ * so rows agreeing on those columns come out next to each other. Returns
+ * NULL when the table has no such index. The returned array holds borrowed
+ * row pointers. */
+fi_array* rdb_table_rows_in_index_order(rdb_table_t *table, const int *column_indexes,
+                                        size_t column_count, fi_array *where_conditions) {
+    if (!table || !column_indexes || column_count == 0 || !table->indexes) return NULL;
+
+    rdb_index_plan_t plan = {0};
+    plan.index = rdb_index_find_leading(table, column_indexes, column_count, true);
+    if (!plan.index) return NULL;
+
+    /* An unbounded plan walks the whole tree */
+    return rdb_index_scan_filtered(table, &plan, where_conditions, 0);
+}
+
+/* Live rows of `table` that satisfy `where_conditions`, sorted by `keys`
+ * through a B-tree index led by the key columns in order, at most `limit`
+ * of them (0 for all). Keys must share one direction: a descending sort
+ * walks the index backwards. NULL sorts first, as in the index, and rows
+ * with equal keys come in row id order, as from the sort. Returns NULL
+ * when no index gives this order. */
+fi_array* rdb_table_rows_in_key_order(rdb_table_t *table, const rdb_sort_key_t *keys,
+                                      size_t key_count, fi_array *where_conditions, size_t limit) {
+    if (!table || !keys || key_count == 0 || key_count > RDB_MAX_INDEX_COLUMNS || !table->indexes) {
+        return NULL;
+    }
+
+    int column_indexes[RDB_MAX_INDEX_COLUMNS];
+    for (size_t i = 0; i < key_count; i++) {
+        if (keys[i].descending != keys[0].descending) return NULL;
+        column_indexes[i] = keys[i].column;
+    }
+
+    rdb_index_plan_t plan = {0};
+    plan.index = rdb_index_find_leading(table, column_indexes, key_count, false);
+    if (!plan.index) return NULL;
+    plan.reverse = keys[0].descending;
+    plan.run_columns = key_count;
+
+    return rdb_index_scan_filtered(table, &plan, where_conditions, limit);
+}
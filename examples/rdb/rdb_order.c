@@ -0,0 +1,282 @@
+#include "rdb.h"
+
+/* ORDER BY and LIMIT/OFFSET
+ *
+ * A sorted or limited SELECT takes the cheapest of three paths:
+ *
+ * - Without ORDER BY, filtering stops as soon as OFFSET + LIMIT rows have
+ *   matched, so a LIMIT over a large table reads only what it needs.
+ * - When a B-tree index is led by the ORDER BY columns (all ASC or all
+ *   DESC), rows are read in index order, backwards for DESC, and the walk
+ *   stops at OFFSET + LIMIT once the run of equal keys it is in ends.
+ *   Each run is put in row id order, as a backward walk or an index with
+ *   more columns would order it otherwise. Without a LIMIT this path is
+ *   only taken when there is no WHERE clause, since the WHERE planner may
+ *   know a narrower index.
+ * - Otherwise the matching rows pass through a bounded heap that keeps the
+ *   best OFFSET + LIMIT rows seen so far, which costs O(n log k) instead of
+ *   sorting everything. Without a LIMIT the heap holds every row and is
+ *   drained as a heap sort.
+ *
+ * NULL sorts before every value: first ascending, last descending. Rows
+ * with equal keys keep row_id order. */
+
+/* Sort order of two values: NULL first, then values by rdb_condition_compare */
+int rdb_sort_value_compare(const rdb_value_t *a, const rdb_value_t *b) {
+    bool a_null = !a || a->is_null;
+    bool b_null = !b || b->is_null;
+    if (a_null || b_null) return (int)b_null - (int)a_null;
+
+    bool comparable;
+    int cmp = rdb_condition_compare(a, b, &comparable);
+    if (comparable) return cmp;
+    return (a->type > b->type) - (a->type < b->type);
+}
+
+typedef struct {
+    const rdb_sort_key_t *keys;
+    size_t key_count;
+} rdb_sort_spec_t;
+
+/* Negative when `a` sorts before `b` */
+static int rdb_sort_row_compare(const rdb_sort_spec_t *spec, const rdb_row_t *a, const rdb_row_t *b) {
+    for (size_t i = 0; i < spec->key_count; i++) {
+        size_t column = (size_t)spec->keys[i].column;
+        const rdb_value_t *va = column < fi_array_count(a->values) ?
+                                *(rdb_value_t**)fi_array_get(a->values, column) : NULL;
+        const rdb_value_t *vb = column < fi_array_count(b->values) ?
+                                *(rdb_value_t**)fi_array_get(b->values, column) : NULL;
+
+        int cmp = rdb_sort_value_compare(va, vb);
+        if (cmp != 0) return spec->keys[i].descending ? -cmp : cmp;
+    }
+    return (a->row_id > b->row_id) - (a->row_id < b->row_id);
+}
+
+/* Max-heap on sort order: heap[0] is the row that sorts last */
+static void rdb_heap_sift_up(const rdb_sort_spec_t *spec, rdb_row_t **heap, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (rdb_sort_row_compare(spec, heap[parent], heap[i]) >= 0) break;
+        rdb_row_t *tmp = heap[parent];
+        heap[parent] = heap[i];
+        heap[i] = tmp;
+        i = parent;
+    }
+}
+
+static void rdb_heap_sift_down(const rdb_sort_spec_t *spec, rdb_row_t **heap, size_t count, size_t i) {
+    while (true) {
+        size_t largest = i;
+        size_t left = 2 * i + 1, right = left + 1;
+        if (left < count && rdb_sort_row_compare(spec, heap[left], heap[largest]) > 0) largest = left;
+        if (right < count && rdb_sort_row_compare(spec, heap[right], heap[largest]) > 0) largest = right;
+        if (largest == i) break;
+        rdb_row_t *tmp = heap[largest];
+        heap[largest] = heap[i];
+        heap[i] = tmp;
+        i = largest;
+    }
+}
+
+/* Number of rows a LIMIT/OFFSET window needs, or 0 when it is unbounded */
+static size_t rdb_window_size(size_t limit, size_t offset) {
+    if (limit == RDB_NO_LIMIT || offset > SIZE_MAX - 1 - limit) return 0;
+    return offset + limit;
+}
+
+/* Rows [offset, offset + limit) of `rows` sorted by `keys`. The returned
+ * array holds the borrowed row pointers of `rows`. */
+fi_array* rdb_rows_top_k(fi_array *rows, const rdb_sort_key_t *keys, size_t key_count,
+                         size_t limit, size_t offset) {
+    if (!rows || (!keys && key_count > 0)) return NULL;
+
+    size_t total = fi_array_count(rows);
+    size_t k = rdb_window_size(limit, offset);
+    if (k == 0 || k > total) k = total;
+    if (limit == 0) k = 0;
+
+    fi_array *result = fi_array_create(k > offset ? k - offset : 1, sizeof(rdb_row_t*));
+    rdb_row_t **heap = malloc((k ? k : 1) * sizeof(rdb_row_t*));
+    if (!result || !heap) {
+        if (result) fi_array_destroy(result);
+        free(heap);
+        return NULL;
+    }
+
+    /* Keep the k rows that sort first; the worst of them sits on top */
+    rdb_sort_spec_t spec = {keys, key_count};
+    size_t count = 0;
+    for (size_t i = 0; i < total && k > 0; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, i);
+        if (count < k) {
+            heap[count] = row;
+            rdb_heap_sift_up(&spec, heap, count++);
+        } else if (rdb_sort_row_compare(&spec, row, heap[0]) < 0) {
+            heap[0] = row;
+            rdb_heap_sift_down(&spec, heap, count, 0);
+        }
+    }
+
+    /* Drain the heap from the back to leave it sorted */
+    for (size_t end = count; end > 1; end--) {
+        rdb_row_t *tmp = heap[0];
+        heap[0] = heap[end - 1];
+        heap[end - 1] = tmp;
+        rdb_heap_sift_down(&spec, heap, end - 1, 0);
+    }
+
+    for (size_t i = offset; i < count; i++) {
+        fi_array_push(result, &heap[i]);
+    }
+
+    free(heap);
+    return result;
+}
+
+/* Resolve ORDER BY items against the table. A position refers to the
+ * select list, or to the table columns for SELECT *. */
+static int rdb_order_resolve(rdb_table_t *table, fi_array *columns, fi_array *order_by,
+                             rdb_sort_key_t *keys) {
+    bool star = !columns || fi_array_count(columns) == 0 ||
+                strcmp(*(char**)fi_array_get(columns, 0), "*") == 0;
+
+    for (size_t i = 0; i < fi_array_count(order_by); i++) {
+        const rdb_order_by_t *item = (const rdb_order_by_t*)fi_array_get(order_by, i);
+        keys[i].descending = item->descending;
+
+        if (item->position > 0) {
+            size_t available = star ? fi_array_count(table->columns) : fi_array_count(columns);
+            if (item->position > available) {
+                printf("Error: ORDER BY position %zu is out of range\n", item->position);
+                return -1;
+            }
+            keys[i].column = star ? (int)item->position - 1 :
+                rdb_get_column_index(table, *(char**)fi_array_get(columns, item->position - 1));
+        } else {
+            keys[i].column = rdb_get_column_index(table, item->column);
+        }
+
+        if (keys[i].column < 0) {
+            printf("Error: ORDER BY column '%s' does not exist in table '%s'\n",
+                   item->position > 0 ? *(char**)fi_array_get(columns, item->position - 1) : item->column,
+                   table->name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Result rows for `rows[offset..]`, projected like rdb_select_rows() */
+static fi_array* rdb_order_copy_rows(fi_array *rows, size_t offset, const int *ordinals,
+                                     size_t ordinal_count) {
+    size_t count = fi_array_count(rows);
+    fi_array *result = fi_array_create(count > offset ? count - offset : 16, sizeof(rdb_row_t*));
+    if (!result) return NULL;
+
+    for (size_t i = offset; i < count; i++) {
+        rdb_row_t *row_copy = rdb_project_row(*(rdb_row_t**)fi_array_get(rows, i), ordinals,
+                                              ordinal_count);
+        if (row_copy) fi_array_push(result, &row_copy);
+    }
+    return result;
+}
+
+static fi_array* rdb_order_table(rdb_table_t *table, fi_array *columns, fi_array *where_conditions,
+                                 fi_array *order_by, size_t limit, size_t offset) {
+    size_t key_count = order_by ? fi_array_count(order_by) : 0;
+    rdb_sort_key_t *keys = calloc(key_count ? key_count : 1, sizeof(rdb_sort_key_t));
+    if (!keys) return NULL;
+    if (rdb_order_resolve(table, columns, order_by, keys) != 0) {
+        free(keys);
+        return NULL;
+    }
+
+    int *ordinals;
+    size_t ordinal_count;
+    if (rdb_table_projection(table, columns, &ordinals, &ordinal_count) != 0) {
+        free(keys);
+        return NULL;
+    }
+
+    if (limit == 0) {
+        free(keys);
+        free(ordinals);
+        return fi_array_create(16, sizeof(rdb_row_t*));
+    }
+
+    size_t window = rdb_window_size(limit, offset);
+    bool has_conditions = where_conditions && fi_array_count(where_conditions) > 0;
+    fi_array *rows = NULL;
+    size_t skip = offset;
+
+    if (key_count == 0) {
+        rows = rdb_find_matching_rows_limit(table, where_conditions, window);
+    } else {
+        if (!has_conditions || window) {
+            rows = rdb_table_rows_in_key_order(table, keys, key_count, where_conditions, window);
+        }
+        if (!rows) {
+            fi_array *matches = rdb_find_matching_rows(table, where_conditions);
+            if (matches) {
+                rows = rdb_rows_top_k(matches, keys, key_count, limit, offset);
+                fi_array_destroy(matches);
+                skip = 0;
+            }
+        }
+    }
+    free(keys);
+    if (!rows) {
+        free(ordinals);
+        return NULL;
+    }
+
+    fi_array *result = rdb_order_copy_rows(rows, skip, ordinals, ordinal_count);
+    fi_array_destroy(rows);
+    free(ordinals);
+    return result;
+}
+
+/* SELECT with ORDER BY (rdb_order_by_t items, may be NULL) and LIMIT/OFFSET.
+ * Pass RDB_NO_LIMIT for no LIMIT. Rows are projected like rdb_select_rows(). */
+fi_array* rdb_select_rows_ordered(rdb_database_t *db, const char *table_name, fi_array *columns,
+                                  fi_array *where_conditions, fi_array *order_by,
+                                  size_t limit, size_t offset) {
+    if (!db || !table_name) return NULL;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return NULL;
+    }
+
+    return rdb_order_table(table, columns, where_conditions, order_by, limit, offset);
+}
+
+fi_array* rdb_select_rows_ordered_thread_safe(rdb_database_t *db, const char *table_name,
+                                              fi_array *columns, fi_array *where_conditions,
+                                              fi_array *order_by, size_t limit, size_t offset) {
+    if (!db || !table_name) return NULL;
+
+    if (rdb_lock_database_read(db) != 0) return NULL;
+
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    if (!table) {
+        rdb_unlock_database(db);
+        printf("Error: Table '%s' does not exist\n", table_name);
+        return NULL;
+    }
+
+    if (rdb_lock_table_read(table) != 0) {
+        rdb_unlock_database(db);
+        return NULL;
+    }
+    rdb_unlock_database(db);
+
+    fi_array *result = rdb_order_table(table, columns, where_conditions, order_by, limit, offset);
+
+    rdb_unlock_table(table);
+
+    if (result) printf("Selected %zu rows from table '%s'\n", fi_array_count(result), table_name);
+    return result;
+}
@@ -0,0 +1,217 @@
+#include "rdb.h"
+#include <unistd.h>
+
+/* Parallel scans
+ *
+ * Each database owns a pool of worker threads. A scan over n rows is cut
+ * into morsels of RDB_MORSEL_SIZE rows and posted to the pool as a job; the
+ * calling thread takes part in its own job, and idle workers join it until
+ * the job has as many participants as the scan asked for. Every participant
+ * claims the next unclaimed morsel until none are left, so a slow morsel
+ * does not hold up the others. The caller returns once all morsels are done.
+ *
+ * Participants are numbered from 0 (the caller), which lets a scan keep
+ * per-participant scratch space and partial results without locking, and
+ * merge them once rdb_parallel_for() returns. Morsel functions only read
+ * the table; the caller holds whatever lock the scan needs for the whole
+ * job. Threads are started on the first scan that needs them. */
+
+typedef struct rdb_parallel_job {
+    rdb_morsel_func_t func;
+    void *context;
+    size_t row_count;
+    size_t morsel_count;
+    size_t next_morsel;         /* First morsel nobody has claimed */
+    size_t done_morsels;        /* Morsels finished */
+    size_t participants;        /* Threads that joined, caller included */
+    size_t max_participants;
+    struct rdb_parallel_job *next;
+} rdb_parallel_job_t;
+
+struct rdb_worker_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;   /* A job was posted, or the pool shuts down */
+    pthread_cond_t done_cond;   /* A job finished its last morsel */
+    pthread_t *threads;
+    size_t thread_count;        /* Threads started */
+    size_t parallelism;         /* Threads a scan may use, caller included */
+    rdb_parallel_job_t *jobs;   /* Jobs still open to new participants */
+    bool shutdown;
+};
+
+/* Online CPUs, used when no parallelism is given */
+static size_t rdb_parallel_default(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+}
+
+/* Take `job` off the open list if it is still there. Called with the lock held. */
+static void rdb_parallel_unlink(rdb_worker_pool_t *pool, rdb_parallel_job_t *job) {
+    for (rdb_parallel_job_t **link = &pool->jobs; *link; link = &(*link)->next) {
+        if (*link == job) {
+            *link = job->next;
+            return;
+        }
+    }
+}
+
+/* Claim and run morsels of `job` until none are left. Called with the lock
+ * held; the lock is released while a morsel runs. */
+static void rdb_parallel_run(rdb_worker_pool_t *pool, rdb_parallel_job_t *job, size_t worker) {
+    while (job->next_morsel < job->morsel_count) {
+        size_t morsel = job->next_morsel++;
+        if (job->next_morsel == job->morsel_count) rdb_parallel_unlink(pool, job);
+
+        size_t begin = morsel * RDB_MORSEL_SIZE;
+        size_t end = begin + RDB_MORSEL_SIZE < job->row_count ? begin + RDB_MORSEL_SIZE : job->row_count;
+
+        pthread_mutex_unlock(&pool->mutex);
+        job->func(job->context, worker, morsel, begin, end);
+        pthread_mutex_lock(&pool->mutex);
+
+        if (++job->done_morsels == job->morsel_count) pthread_cond_broadcast(&pool->done_cond);
+    }
+}
+
+static void* rdb_worker_thread(void *arg) {
+    rdb_worker_pool_t *pool = (rdb_worker_pool_t*)arg;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->shutdown && !pool->jobs) pthread_cond_wait(&pool->work_cond, &pool->mutex);
+        if (pool->shutdown) break;
+
+        rdb_parallel_job_t *job = pool->jobs;
+        size_t worker = job->participants++;
+        if (job->participants == job->max_participants) rdb_parallel_unlink(pool, job);
+        rdb_parallel_run(pool, job, worker);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+/* A pool letting scans use `parallelism` threads (0 for one per online CPU).
+ * No thread is started until a scan needs it. */
+rdb_worker_pool_t* rdb_worker_pool_create(size_t parallelism) {
+    rdb_worker_pool_t *pool = calloc(1, sizeof(rdb_worker_pool_t));
+    if (!pool) return NULL;
+
+    pool->parallelism = parallelism > 0 ? parallelism : rdb_parallel_default();
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    return pool;
+}
+
+void rdb_worker_pool_destroy(rdb_worker_pool_t *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    free(pool->threads);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool);
+}
+
+/* Start workers until a scan can use `parallelism` threads. Called with the
+ * lock held. Returns how many threads a scan can use now. */
+static size_t rdb_worker_pool_grow(rdb_worker_pool_t *pool, size_t parallelism) {
+    if (pool->thread_count + 1 < parallelism) {
+        pthread_t *threads = realloc(pool->threads, (parallelism - 1) * sizeof(pthread_t));
+        if (threads) {
+            pool->threads = threads;
+            while (pool->thread_count + 1 < parallelism &&
+                   pthread_create(&pool->threads[pool->thread_count], NULL, rdb_worker_thread, pool) == 0) {
+                pool->thread_count++;
+            }
+        }
+    }
+    return pool->thread_count + 1 < parallelism ? pool->thread_count + 1 : parallelism;
+}
+
+/* Set how many threads one scan of `db` may use, the calling thread
+ * included. 0 means one per online CPU, 1 turns parallel scans off. */
+int rdb_set_scan_parallelism(rdb_database_t *db, size_t parallelism) {
+    if (!db || !db->workers) return -1;
+
+    pthread_mutex_lock(&db->workers->mutex);
+    db->workers->parallelism = parallelism > 0 ? parallelism : rdb_parallel_default();
+    pthread_mutex_unlock(&db->workers->mutex);
+    return 0;
+}
+
+size_t rdb_get_scan_parallelism(const rdb_database_t *db) {
+    if (!db || !db->workers) return 1;
+
+    pthread_mutex_lock(&db->workers->mutex);
+    size_t parallelism = db->workers->parallelism;
+    pthread_mutex_unlock(&db->workers->mutex);
+    return parallelism;
+}
+
+/* Threads a scan of `row_count` rows should use: 1 when the pool is
+ * missing, parallel scans are off, or the scan is under two morsels */
+size_t rdb_parallel_workers(rdb_worker_pool_t *pool, size_t row_count) {
+    if (!pool) return 1;
+
+    size_t morsels = (row_count + RDB_MORSEL_SIZE - 1) / RDB_MORSEL_SIZE;
+    if (morsels < 2) return 1;
+
+    pthread_mutex_lock(&pool->mutex);
+    size_t workers = pool->parallelism < morsels ? pool->parallelism : morsels;
+    pthread_mutex_unlock(&pool->mutex);
+    return workers;
+}
+
+/* Run `func` over every morsel of rows [0, row_count) with at most
+ * `workers` threads, the calling thread being worker 0. Returns when all
+ * morsels are done. Runs on the calling thread alone when no worker thread
+ * can be started. */
+int rdb_parallel_for(rdb_worker_pool_t *pool, size_t row_count, size_t workers,
+                     rdb_morsel_func_t func, void *context) {
+    if (!func) return -1;
+
+    rdb_parallel_job_t job = {0};
+    job.func = func;
+    job.context = context;
+    job.row_count = row_count;
+    job.morsel_count = (row_count + RDB_MORSEL_SIZE - 1) / RDB_MORSEL_SIZE;
+    if (job.morsel_count == 0) return 0;
+
+    if (!pool || workers <= 1) {
+        for (size_t m = 0; m < job.morsel_count; m++) {
+            size_t begin = m * RDB_MORSEL_SIZE;
+            func(context, 0, m, begin, begin + RDB_MORSEL_SIZE < row_count ? begin + RDB_MORSEL_SIZE : row_count);
+        }
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    job.max_participants = rdb_worker_pool_grow(pool, workers);
+    job.participants = 1;
+
+    /* Post the job behind the ones already open */
+    if (job.max_participants > 1) {
+        rdb_parallel_job_t **link = &pool->jobs;
+        while (*link) link = &(*link)->next;
+        *link = &job;
+        pthread_cond_broadcast(&pool->work_cond);
+    }
+
+    rdb_parallel_run(pool, &job, 0);
+    while (job.done_morsels < job.morsel_count) pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    rdb_parallel_unlink(pool, &job);
+    pthread_mutex_unlock(&pool->mutex);
+
+    return 0;
+}
@@ -0,0 +1,478 @@
+#include "rdb.h"
+#include "sql_parser.h"
+
+/* Prepared statements
+ *
+ * rdb_prepare() parses a statement once. Each ? in it is parsed as a NULL
+ * literal that is also recorded as a parameter slot; rdb_bind_*() rewrite
+ * these literals in place, so the parse tree is executed as is by every
+ * rdb_step() without being parsed, copied or rebuilt.
+ *
+ * A database keeps up to RDB_STATEMENT_CACHE_SIZE prepared statements keyed
+ * by their SQL text. rdb_finalize() hands a statement back to the cache
+ * instead of freeing it, and the next rdb_prepare() of the same text takes
+ * it out again. A statement serves one caller at a time: preparing a text
+ * whose cached statements are all taken parses another one. When the cache
+ * is full, the least recently prepared idle statement makes room.
+ *
+ * Parse trees name tables and columns instead of pointing at them, so no
+ * schema change invalidates a cached statement. The access path is chosen
+ * at each rdb_step(), since which index pays off depends on the bound
+ * values. */
+
+struct rdb_prepared {
+    rdb_database_t *db;
+    char *sql;                  /* Text the statement was prepared from */
+    uint64_t hash;              /* Hash of sql */
+    rdb_statement_t *stmt;      /* Parse tree, executed by rdb_step() */
+    fi_array *parameters;       /* rdb_value_t* literal of each ?, in order */
+    fi_array *rows;             /* Result rows of the SELECT being stepped, or NULL */
+    bool aggregate_rows;        /* rows came from an aggregate and own their values */
+    size_t next_row;            /* Next row rdb_step() returns */
+    const rdb_row_t *row;       /* Current row, or NULL */
+    size_t changes;             /* Rows changed by the last INSERT/UPDATE/DELETE */
+    bool cached;                /* Kept by the statement cache */
+    bool in_use;                /* Handed out by rdb_prepare() */
+    uint64_t last_used;         /* Cache clock of the last rdb_prepare() */
+};
+
+struct rdb_statement_cache {
+    pthread_mutex_t mutex;
+    rdb_prepared_t *entries[RDB_STATEMENT_CACHE_SIZE];
+    size_t count;
+    uint64_t clock;             /* Advances at every rdb_prepare() */
+    size_t hits;                /* rdb_prepare() calls served from the cache */
+    size_t misses;              /* rdb_prepare() calls that had to parse */
+};
+
+/* FNV-1a */
+static uint64_t rdb_statement_hash(const char *sql) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char *p = (const unsigned char*)sql; *p; p++) {
+        h ^= *p;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* Statements rdb_step() can run */
+static bool rdb_statement_preparable(const rdb_statement_t *stmt) {
+    switch (stmt->type) {
+        case RDB_STMT_SELECT:
+            return !stmt->from_tables || fi_array_count(stmt->from_tables) <= 1;
+        case RDB_STMT_INSERT:
+        case RDB_STMT_UPDATE:
+        case RDB_STMT_DELETE:
+        case RDB_STMT_BEGIN_TRANSACTION:
+        case RDB_STMT_COMMIT_TRANSACTION:
+        case RDB_STMT_ROLLBACK_TRANSACTION:
+        case RDB_STMT_VACUUM:
+        case RDB_STMT_ANALYZE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void rdb_prepared_free(rdb_prepared_t *prepared) {
+    if (!prepared) return;
+
+    rdb_reset(prepared);
+    sql_statement_free(prepared->stmt);
+    if (prepared->parameters) fi_array_destroy(prepared->parameters);
+    free(prepared->sql);
+    free(prepared);
+}
+
+static rdb_prepared_t* rdb_prepared_parse(rdb_database_t *db, const char *sql, uint64_t hash) {
+    rdb_prepared_t *prepared = calloc(1, sizeof(rdb_prepared_t));
+    if (!prepared) return NULL;
+
+    prepared->db = db;
+    prepared->hash = hash;
+    prepared->sql = malloc(strlen(sql) + 1);
+    prepared->parameters = fi_array_create(4, sizeof(rdb_value_t*));
+    sql_parser_t *parser = sql_parser_create(sql);
+    if (!prepared->sql || !prepared->parameters || !parser) {
+        sql_parser_destroy(parser);
+        rdb_prepared_free(prepared);
+        return NULL;
+    }
+    strcpy(prepared->sql, sql);
+
+    parser->parameters = prepared->parameters;
+    prepared->stmt = sql_parse_statement(parser);
+    if (!prepared->stmt) {
+        printf("Error: %s\n", sql_parser_has_error(parser) ? sql_parser_get_error(parser) :
+                                                             "Failed to parse SQL statement");
+    } else if (!rdb_statement_preparable(prepared->stmt)) {
+        printf("Error: Only single-table SELECT, INSERT, UPDATE, DELETE, transaction control, "
+               "VACUUM and ANALYZE can be prepared\n");
+        sql_statement_free(prepared->stmt);
+        prepared->stmt = NULL;
+    }
+    sql_parser_destroy(parser);
+
+    if (!prepared->stmt) {
+        rdb_prepared_free(prepared);
+        return NULL;
+    }
+    return prepared;
+}
+
+rdb_statement_cache_t* rdb_statement_cache_create(void) {
+    rdb_statement_cache_t *cache = calloc(1, sizeof(rdb_statement_cache_t));
+    if (!cache) return NULL;
+
+    pthread_mutex_init(&cache->mutex, NULL);
+    return cache;
+}
+
+/* Frees every cached statement; statements still handed out must have
+ * been finalized first */
+void rdb_statement_cache_destroy(rdb_statement_cache_t *cache) {
+    if (!cache) return;
+
+    for (size_t i = 0; i < cache->count; i++) {
+        rdb_prepared_free(cache->entries[i]);
+    }
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache);
+}
+
+/* Idle cached statement prepared from `sql`, taken out for the caller */
+static rdb_prepared_t* rdb_statement_cache_take(rdb_statement_cache_t *cache, const char *sql,
+                                                uint64_t hash) {
+    rdb_prepared_t *found = NULL;
+
+    pthread_mutex_lock(&cache->mutex);
+    cache->clock++;
+    for (size_t i = 0; i < cache->count; i++) {
+        rdb_prepared_t *entry = cache->entries[i];
+        if (!entry->in_use && entry->hash == hash && strcmp(entry->sql, sql) == 0) {
+            found = entry;
+            found->in_use = true;
+            found->last_used = cache->clock;
+            break;
+        }
+    }
+    if (found) cache->hits++;
+    else cache->misses++;
+    pthread_mutex_unlock(&cache->mutex);
+
+    return found;
+}
+
+/* Keep a newly parsed statement, evicting the least recently prepared idle
+ * one when the cache is full. The statement stays uncached when every
+ * entry is in use. */
+static void rdb_statement_cache_add(rdb_statement_cache_t *cache, rdb_prepared_t *prepared) {
+    rdb_prepared_t *evicted = NULL;
+
+    pthread_mutex_lock(&cache->mutex);
+    size_t slot = cache->count;
+    if (slot == RDB_STATEMENT_CACHE_SIZE) {
+        for (size_t i = 0; i < cache->count; i++) {
+            rdb_prepared_t *entry = cache->entries[i];
+            if (!entry->in_use &&
+                (slot == cache->count || entry->last_used < cache->entries[slot]->last_used)) {
+                slot = i;
+            }
+        }
+        if (slot < cache->count) evicted = cache->entries[slot];
+    }
+
+    if (slot < RDB_STATEMENT_CACHE_SIZE) {
+        cache->entries[slot] = prepared;
+        if (slot == cache->count) cache->count++;
+        prepared->cached = true;
+    }
+    prepared->last_used = cache->clock;
+    pthread_mutex_unlock(&cache->mutex);
+
+    rdb_prepared_free(evicted);
+}
+
+/* Prepare `sql`, which may hold ? placeholders. The statement is reused
+ * from the database's cache when the same text was prepared and finalized
+ * before; its parameters then start out NULL. Returns NULL on error. */
+rdb_prepared_t* rdb_prepare(rdb_database_t *db, const char *sql) {
+    if (!db || !sql) return NULL;
+
+    uint64_t hash = rdb_statement_hash(sql);
+    if (db->statements) {
+        rdb_prepared_t *cached = rdb_statement_cache_take(db->statements, sql, hash);
+        if (cached) return cached;
+    }
+
+    rdb_prepared_t *prepared = rdb_prepared_parse(db, sql, hash);
+    if (!prepared) return NULL;
+
+    prepared->in_use = true;
+    if (db->statements) rdb_statement_cache_add(db->statements, prepared);
+    return prepared;
+}
+
+/* How many rdb_prepare() calls on `db` reused a cached statement and how
+ * many parsed a new one. Returns -1 when the database has no cache. */
+int rdb_statement_cache_stats(rdb_database_t *db, size_t *hits, size_t *misses) {
+    if (!db || !db->statements) return -1;
+
+    pthread_mutex_lock(&db->statements->mutex);
+    if (hits) *hits = db->statements->hits;
+    if (misses) *misses = db->statements->misses;
+    pthread_mutex_unlock(&db->statements->mutex);
+    return 0;
+}
+
+/* Done with `prepared`: it goes back to the cache, or is freed when the
+ * cache did not keep it */
+void rdb_finalize(rdb_prepared_t *prepared) {
+    if (!prepared) return;
+
+    rdb_reset(prepared);
+    rdb_clear_bindings(prepared);
+
+    rdb_statement_cache_t *cache = prepared->db->statements;
+    if (cache) {
+        pthread_mutex_lock(&cache->mutex);
+        bool cached = prepared->cached;
+        if (cached) prepared->in_use = false;
+        pthread_mutex_unlock(&cache->mutex);
+        if (cached) return;
+    }
+    rdb_prepared_free(prepared);
+}
+
+/* The parse tree, with the current bindings in place */
+const rdb_statement_t* rdb_prepared_statement(const rdb_prepared_t *prepared) {
+    return prepared ? prepared->stmt : NULL;
+}
+
+size_t rdb_parameter_count(const rdb_prepared_t *prepared) {
+    return prepared ? fi_array_count(prepared->parameters) : 0;
+}
+
+/* Literal of parameter `index` (1-based), emptied for a new value */
+static rdb_value_t* rdb_parameter_slot(rdb_prepared_t *prepared, size_t index) {
+    if (!prepared) return NULL;
+
+    if (index == 0 || index > fi_array_count(prepared->parameters)) {
+        printf("Error: Parameter index %zu is out of range (1..%zu)\n", index,
+               fi_array_count(prepared->parameters));
+        return NULL;
+    }
+
+    rdb_value_t *slot = *(rdb_value_t**)fi_array_get(prepared->parameters, index - 1);
+    if (slot->str_len == RDB_VALUE_SHARED_STRING) {
+        rdb_string_release(slot->data.string_ref);
+    }
+    slot->str_len = 0;
+    return slot;
+}
+
+int rdb_bind_null(rdb_prepared_t *prepared, size_t index) {
+    rdb_value_t *slot = rdb_parameter_slot(prepared, index);
+    if (!slot) return -1;
+
+    slot->type = RDB_TYPE_INT;
+    slot->is_null = true;
+    memset(&slot->data, 0, sizeof(slot->data));
+    return 0;
+}
+
+int rdb_bind_int(rdb_prepared_t *prepared, size_t index, int64_t value) {
+    rdb_value_t *slot = rdb_parameter_slot(prepared, index);
+    if (!slot) return -1;
+
+    slot->type = RDB_TYPE_INT;
+    slot->is_null = false;
+    slot->data.int_val = value;
+    return 0;
+}
+
+int rdb_bind_float(rdb_prepared_t *prepared, size_t index, double value) {
+    rdb_value_t *slot = rdb_parameter_slot(prepared, index);
+    if (!slot) return -1;
+
+    slot->type = RDB_TYPE_FLOAT;
+    slot->is_null = false;
+    slot->data.float_val = value;
+    return 0;
+}
+
+int rdb_bind_bool(rdb_prepared_t *prepared, size_t index, bool value) {
+    rdb_value_t *slot = rdb_parameter_slot(prepared, index);
+    if (!slot) return -1;
+
+    slot->type = RDB_TYPE_BOOLEAN;
+    slot->is_null = false;
+    slot->data.bool_val = value;
+    return 0;
+}
+
+/* Bind a copy of `value` (NULL binds SQL NULL) */
+int rdb_bind_value(rdb_prepared_t *prepared, size_t index, const rdb_value_t *value) {
+    if (!value) return rdb_bind_null(prepared, index);
+
+    rdb_value_t *copy = rdb_value_copy(value);
+    if (!copy) return -1;
+
+    rdb_value_t *slot = rdb_parameter_slot(prepared, index);
+    if (!slot) {
+        rdb_value_free(copy);
+        return -1;
+    }
+
+    /* The slot keeps its address: the parse tree points at it */
+    memcpy(slot, copy, sizeof(rdb_value_t));
+    free(copy);
+    return 0;
+}
+
+/* Bind a copy of `value` (NULL binds SQL NULL) */
+int rdb_bind_string(rdb_prepared_t *prepared, size_t index, const char *value) {
+    if (!value) return rdb_bind_null(prepared, index);
+
+    rdb_value_t *str = rdb_create_string_value(value);
+    if (!str) return -1;
+
+    int result = rdb_bind_value(prepared, index, str);
+    rdb_value_free(str);
+    return result;
+}
+
+/* Set every parameter back to NULL */
+int rdb_clear_bindings(rdb_prepared_t *prepared) {
+    if (!prepared) return -1;
+
+    for (size_t i = 1; i <= fi_array_count(prepared->parameters); i++) {
+        rdb_bind_null(prepared, i);
+    }
+    return 0;
+}
+
+static fi_array* rdb_prepared_select(rdb_database_t *db, const rdb_statement_t *stmt) {
+    const char *table_name = stmt->from_tables && fi_array_count(stmt->from_tables) > 0 ?
+                             *(char**)fi_array_get(stmt->from_tables, 0) : stmt->table_name;
+    bool ordered = stmt->order_by || stmt->limit_value != RDB_NO_LIMIT || stmt->offset_value > 0;
+
+    if (stmt->aggregates) {
+        fi_array *rows = rdb_select_aggregate_thread_safe(db, table_name, stmt->aggregates,
+                                                          stmt->group_by, stmt->where_conditions);
+        if (rows && ordered) {
+            rows = rdb_aggregate_order(rows, stmt->select_columns, stmt->order_by,
+                                       stmt->limit_value, stmt->offset_value);
+        }
+        return rows;
+    }
+    if (ordered) {
+        return rdb_select_rows_ordered_thread_safe(db, table_name, stmt->select_columns,
+                                                   stmt->where_conditions, stmt->order_by,
+                                                   stmt->limit_value, stmt->offset_value);
+    }
+    return rdb_select_rows_thread_safe(db, table_name, stmt->select_columns, stmt->where_conditions);
+}
+
+/* Run the statement with the current bindings. A SELECT leaves its result
+ * in prepared->rows. */
+static int rdb_prepared_execute(rdb_prepared_t *prepared) {
+    rdb_database_t *db = prepared->db;
+    const rdb_statement_t *stmt = prepared->stmt;
+    int result;
+
+    prepared->changes = 0;
+    switch (stmt->type) {
+        case RDB_STMT_SELECT:
+            prepared->rows = rdb_prepared_select(db, stmt);
+            prepared->aggregate_rows = stmt->aggregates != NULL;
+            prepared->next_row = 0;
+            return prepared->rows ? 0 : -1;
+
+        case RDB_STMT_INSERT:
+            result = rdb_insert_row_thread_safe(db, stmt->table_name, stmt->values) == 0 ? 1 : -1;
+            break;
+
+        case RDB_STMT_UPDATE:
+            if (stmt->set_expressions) {
+                result = rdb_update_rows_computed_thread_safe(db, stmt->table_name, stmt->columns,
+                                                              stmt->values, stmt->set_expressions,
+                                                              stmt->where_conditions);
+            } else {
+                result = rdb_update_rows_thread_safe(db, stmt->table_name, stmt->columns,
+                                                     stmt->values, stmt->where_conditions);
+            }
+            break;
+
+        case RDB_STMT_DELETE:
+            result = rdb_delete_rows_thread_safe(db, stmt->table_name, stmt->where_conditions);
+            break;
+
+        default:
+            return sql_execute_statement(db, stmt);
+    }
+
+    if (result < 0) return -1;
+    prepared->changes = (size_t)result;
+    return 0;
+}
+
+/* Run the statement, or advance to its next result row. Returns
+ * RDB_STEP_ROW while a SELECT has rows (read them with rdb_column_value()),
+ * then RDB_STEP_DONE; other statements run to completion and return
+ * RDB_STEP_DONE. Stepping a finished statement runs it again. Returns -1
+ * when the statement fails. */
+int rdb_step(rdb_prepared_t *prepared) {
+    if (!prepared) return -1;
+
+    if (!prepared->rows) {
+        if (rdb_prepared_execute(prepared) != 0) return -1;
+        if (!prepared->rows) return RDB_STEP_DONE;
+    }
+
+    if (prepared->next_row < fi_array_count(prepared->rows)) {
+        prepared->row = *(rdb_row_t**)fi_array_get(prepared->rows, prepared->next_row++);
+        return RDB_STEP_ROW;
+    }
+
+    rdb_reset(prepared);
+    return RDB_STEP_DONE;
+}
+
+/* Drop the rows of a SELECT being stepped; the bindings stay */
+int rdb_reset(rdb_prepared_t *prepared) {
+    if (!prepared) return -1;
+
+    if (prepared->rows && prepared->aggregate_rows) {
+        rdb_aggregate_result_free(prepared->rows);
+    } else if (prepared->rows) {
+        for (size_t i = 0; i < fi_array_count(prepared->rows); i++) {
+            rdb_row_free(*(rdb_row_t**)fi_array_get(prepared->rows, i));
+        }
+        fi_array_destroy(prepared->rows);
+    }
+
+    prepared->rows = NULL;
+    prepared->row = NULL;
+    prepared->next_row = 0;
+    return 0;
+}
+
+/* Number of values in the current row, 0 when there is none */
+size_t rdb_column_count(const rdb_prepared_t *prepared) {
+    if (!prepared || !prepared->row) return 0;
+    return fi_array_count(prepared->row->values);
+}
+
+/* Value `column` of the current row, in select-list order, valid until the
+ * next rdb_step() or rdb_reset(). Like the rows of rdb_select_rows(), plain
+ * SELECT rows share their values with the table. */
+const rdb_value_t* rdb_column_value(const rdb_prepared_t *prepared, size_t column) {
+    if (column >= rdb_column_count(prepared)) return NULL;
+    return *(rdb_value_t**)fi_array_get(prepared->row->values, column);
+}
+
+/* Rows inserted, updated or deleted by the last run */
+size_t rdb_changes(const rdb_prepared_t *prepared) {
+    return prepared ? prepared->changes : 0;
+}
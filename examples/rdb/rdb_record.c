@@ -0,0 +1,378 @@
+#include "rdb.h"
+
+/* Packed row records
+ *
+ * A record holds a whole row in one allocation, laid out from the table
+ * schema:
+ *
+ *   [rdb_record_t header][null bitmap][other-type bitmap][fixed slots][tail]
+ *
+ * INT and FLOAT slots are 8 bytes and BOOLEAN slots 1 byte. A VARCHAR/TEXT
+ * slot holds the 4-byte offset and 4-byte length of its string in the tail,
+ * where strings are stored NUL terminated so they can be read in place.
+ *
+ * Columns may hold values of another type (2.5 in an INT column, 'x' in a
+ * BOOLEAN one). Such a value is flagged in the other-type bitmap, leaves its
+ * slot zeroed and is stored at the head of the tail, in column order, as a
+ * type byte and its payload, so unpacking gives back exactly the row that
+ * was packed. The field getters only read slots and return the zero value
+ * for these columns.
+ *
+ * Copying a record is a single memcpy, and fields can be read without
+ * unpacking the row, which makes records the cheap form for row images
+ * that are kept aside, such as the before-images in the transaction log.
+ * Live table rows stay rdb_row_t value arrays. */
+
+/* Slot width of a column type */
+static size_t rdb_record_slot_size(rdb_data_type_t type) {
+    switch (type) {
+        case RDB_TYPE_INT:
+        case RDB_TYPE_FLOAT:
+            return 8;
+        case RDB_TYPE_BOOLEAN:
+            return 1;
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT:
+            return 2 * sizeof(uint32_t);
+    }
+    return 0;
+}
+
+static bool rdb_record_is_string_type(rdb_data_type_t type) {
+    return type == RDB_TYPE_VARCHAR || type == RDB_TYPE_TEXT;
+}
+
+rdb_record_layout_t* rdb_record_layout_create(const rdb_table_t *table) {
+    if (!table || !table->columns) return NULL;
+
+    rdb_record_layout_t *layout = calloc(1, sizeof(rdb_record_layout_t));
+    if (!layout) return NULL;
+
+    layout->column_count = fi_array_count(table->columns);
+    size_t slots = layout->column_count ? layout->column_count : 1;
+    layout->slot_offsets = malloc(slots * sizeof(size_t));
+    layout->types = malloc(slots * sizeof(rdb_data_type_t));
+    if (!layout->slot_offsets || !layout->types) {
+        rdb_record_layout_destroy(layout);
+        return NULL;
+    }
+
+    layout->null_bytes = (layout->column_count + 7) / 8;
+    size_t offset = 2 * layout->null_bytes;
+    for (size_t i = 0; i < layout->column_count; i++) {
+        rdb_column_t *column = *(rdb_column_t**)fi_array_get(table->columns, i);
+        layout->types[i] = column->type;
+        layout->slot_offsets[i] = offset;
+        offset += rdb_record_slot_size(column->type);
+    }
+    layout->fixed_size = offset;
+
+    return layout;
+}
+
+void rdb_record_layout_destroy(rdb_record_layout_t *layout) {
+    if (!layout) return;
+
+    free(layout->slot_offsets);
+    free(layout->types);
+    free(layout);
+}
+
+/* Layout for the current schema of `table`, built on first use */
+const rdb_record_layout_t* rdb_table_record_layout(rdb_table_t *table) {
+    if (!table) return NULL;
+
+    if (!table->record_layout) {
+        table->record_layout = rdb_record_layout_create(table);
+    }
+    return table->record_layout;
+}
+
+/* Forget the cached layout after a schema change */
+void rdb_table_invalidate_record_layout(rdb_table_t *table) {
+    if (!table) return;
+
+    rdb_record_layout_destroy(table->record_layout);
+    table->record_layout = NULL;
+}
+
+/* Value of column `i`, or NULL when it is missing or SQL NULL */
+static const rdb_value_t* rdb_record_source_value(const rdb_row_t *row, size_t i) {
+    if (!row->values || i >= fi_array_count(row->values)) return NULL;
+
+    const rdb_value_t *value = *(rdb_value_t**)fi_array_get(row->values, i);
+    return value && !value->is_null ? value : NULL;
+}
+
+/* Whether `value` goes in the slot of a `column_type` column */
+static bool rdb_record_value_fits(rdb_data_type_t column_type, const rdb_value_t *value) {
+    if (rdb_record_is_string_type(column_type)) return rdb_record_is_string_type(value->type);
+    return value->type == column_type;
+}
+
+/* Tail bytes of a value of another type than its column */
+static size_t rdb_record_other_size(const rdb_value_t *value) {
+    if (rdb_record_is_string_type(value->type)) {
+        return 1 + sizeof(uint32_t) + rdb_get_string_length(value) + 1;
+    }
+    return 1 + (value->type == RDB_TYPE_BOOLEAN ? 1 : 8);
+}
+
+static void rdb_record_put_other(uint8_t *out, const rdb_value_t *value) {
+    *out++ = (uint8_t)value->type;
+    switch (value->type) {
+        case RDB_TYPE_INT:
+            memcpy(out, &value->data.int_val, 8);
+            break;
+        case RDB_TYPE_FLOAT:
+            memcpy(out, &value->data.float_val, 8);
+            break;
+        case RDB_TYPE_BOOLEAN:
+            *out = value->data.bool_val;
+            break;
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT: {
+            uint32_t length = (uint32_t)rdb_get_string_length(value);
+            memcpy(out, &length, sizeof(uint32_t));
+            memcpy(out + sizeof(uint32_t), rdb_get_string_value(value), length + 1);
+            break;
+        }
+    }
+}
+
+rdb_record_t* rdb_record_pack(const rdb_record_layout_t *layout, const rdb_row_t *row) {
+    if (!layout || !row) return NULL;
+
+    /* Size the tail first so the record is a single allocation */
+    size_t other_size = 0, string_size = 0;
+    for (size_t i = 0; i < layout->column_count; i++) {
+        const rdb_value_t *value = rdb_record_source_value(row, i);
+        if (!value) continue;
+        if (!rdb_record_value_fits(layout->types[i], value)) {
+            other_size += rdb_record_other_size(value);
+        } else if (rdb_record_is_string_type(layout->types[i])) {
+            string_size += rdb_get_string_length(value) + 1;
+        }
+    }
+
+    size_t size = sizeof(rdb_record_t) + layout->fixed_size + other_size + string_size;
+    if (size > UINT32_MAX) {
+        printf("Error: Row %zu is too large to pack\n", row->row_id);
+        return NULL;
+    }
+
+    rdb_record_t *record = calloc(1, size);
+    if (!record) return NULL;
+
+    record->size = (uint32_t)size;
+    record->column_count = (uint32_t)layout->column_count;
+    record->row_id = row->row_id;
+
+    uint8_t *tail = record->data + layout->fixed_size;
+    size_t other_offset = 0;
+    uint32_t string_offset = (uint32_t)other_size;
+
+    for (size_t i = 0; i < layout->column_count; i++) {
+        const rdb_value_t *value = rdb_record_source_value(row, i);
+        uint8_t *slot = record->data + layout->slot_offsets[i];
+
+        if (!value) {
+            record->data[i >> 3] |= (uint8_t)(1 << (i & 7));
+            continue;
+        }
+        if (!rdb_record_value_fits(layout->types[i], value)) {
+            record->data[layout->null_bytes + (i >> 3)] |= (uint8_t)(1 << (i & 7));
+            rdb_record_put_other(tail + other_offset, value);
+            other_offset += rdb_record_other_size(value);
+            continue;
+        }
+
+        switch (layout->types[i]) {
+            case RDB_TYPE_INT:
+                memcpy(slot, &value->data.int_val, 8);
+                break;
+            case RDB_TYPE_FLOAT:
+                memcpy(slot, &value->data.float_val, 8);
+                break;
+            case RDB_TYPE_BOOLEAN:
+                *slot = value->data.bool_val;
+                break;
+            case RDB_TYPE_VARCHAR:
+            case RDB_TYPE_TEXT: {
+                uint32_t length = (uint32_t)rdb_get_string_length(value);
+                memcpy(tail + string_offset, rdb_get_string_value(value), length + 1);
+                memcpy(slot, &string_offset, sizeof(uint32_t));
+                memcpy(slot + sizeof(uint32_t), &length, sizeof(uint32_t));
+                string_offset += length + 1;
+                break;
+            }
+        }
+    }
+
+    return record;
+}
+
+rdb_record_t* rdb_record_copy(const rdb_record_t *record) {
+    if (!record) return NULL;
+
+    rdb_record_t *copy = malloc(record->size);
+    if (!copy) return NULL;
+
+    memcpy(copy, record, record->size);
+    return copy;
+}
+
+bool rdb_record_is_null(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column) {
+    if (!layout || !record || column >= record->column_count) return true;
+    return (record->data[column >> 3] >> (column & 7)) & 1;
+}
+
+/* Whether the column holds a value of another type, kept in the tail */
+static bool rdb_record_is_other(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column) {
+    return (record->data[layout->null_bytes + (column >> 3)] >> (column & 7)) & 1;
+}
+
+/* Whether column `column` has a slot value of the column's type */
+static bool rdb_record_has_slot_value(const rdb_record_layout_t *layout, const rdb_record_t *record,
+                                      size_t column) {
+    return !rdb_record_is_null(layout, record, column) && !rdb_record_is_other(layout, record, column);
+}
+
+int64_t rdb_record_get_int(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column) {
+    int64_t value = 0;
+    if (rdb_record_has_slot_value(layout, record, column) && layout->types[column] == RDB_TYPE_INT) {
+        memcpy(&value, record->data + layout->slot_offsets[column], sizeof(value));
+    }
+    return value;
+}
+
+double rdb_record_get_float(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column) {
+    double value = 0.0;
+    if (rdb_record_has_slot_value(layout, record, column) && layout->types[column] == RDB_TYPE_FLOAT) {
+        memcpy(&value, record->data + layout->slot_offsets[column], sizeof(value));
+    }
+    return value;
+}
+
+bool rdb_record_get_bool(const rdb_record_layout_t *layout, const rdb_record_t *record, size_t column) {
+    if (!rdb_record_has_slot_value(layout, record, column) || layout->types[column] != RDB_TYPE_BOOLEAN) {
+        return false;
+    }
+    return record->data[layout->slot_offsets[column]] != 0;
+}
+
+const char* rdb_record_get_string(const rdb_record_layout_t *layout, const rdb_record_t *record,
+                                  size_t column, size_t *length) {
+    if (!rdb_record_has_slot_value(layout, record, column) || !rdb_record_is_string_type(layout->types[column])) {
+        return NULL;
+    }
+
+    uint32_t offset, string_length;
+    const uint8_t *slot = record->data + layout->slot_offsets[column];
+    memcpy(&offset, slot, sizeof(uint32_t));
+    memcpy(&string_length, slot + sizeof(uint32_t), sizeof(uint32_t));
+    if (length) *length = string_length;
+    return (const char*)record->data + layout->fixed_size + offset;
+}
+
+/* Value stored with its own type at `*cursor` in the tail; moves the cursor past it */
+static rdb_value_t* rdb_record_take_other(const uint8_t **cursor) {
+    const uint8_t *in = *cursor;
+    rdb_data_type_t type = (rdb_data_type_t)*in++;
+    rdb_value_t *value = NULL;
+
+    switch (type) {
+        case RDB_TYPE_INT: {
+            int64_t int_val;
+            memcpy(&int_val, in, 8);
+            value = rdb_create_int_value(int_val);
+            in += 8;
+            break;
+        }
+        case RDB_TYPE_FLOAT: {
+            double float_val;
+            memcpy(&float_val, in, 8);
+            value = rdb_create_float_value(float_val);
+            in += 8;
+            break;
+        }
+        case RDB_TYPE_BOOLEAN:
+            value = rdb_create_bool_value(*in++ != 0);
+            break;
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT: {
+            uint32_t length;
+            memcpy(&length, in, sizeof(uint32_t));
+            in += sizeof(uint32_t);
+            value = rdb_create_string_value_n((const char*)in, length);
+            in += length + 1;
+            break;
+        }
+    }
+
+    *cursor = in;
+    return value;
+}
+
+rdb_row_t* rdb_record_unpack(const rdb_record_layout_t *layout, const rdb_record_t *record) {
+    if (!layout || !record) return NULL;
+
+    if (record->column_count != layout->column_count) {
+        printf("Error: Record of row %zu was packed with %u columns, table has %zu\n",
+               record->row_id, record->column_count, layout->column_count);
+        return NULL;
+    }
+
+    rdb_row_t *row = malloc(sizeof(rdb_row_t));
+    if (!row) return NULL;
+
+    row->row_id = record->row_id;
+    row->deleted = false;
+    row->values = fi_array_create(layout->column_count, sizeof(rdb_value_t*));
+    if (!row->values) {
+        free(row);
+        return NULL;
+    }
+
+    const uint8_t *other = record->data + layout->fixed_size;
+
+    for (size_t i = 0; i < layout->column_count; i++) {
+        rdb_value_t *value = NULL;
+
+        if (rdb_record_is_null(layout, record, i)) {
+            value = rdb_create_null_value(layout->types[i]);
+        } else if (rdb_record_is_other(layout, record, i)) {
+            value = rdb_record_take_other(&other);
+        } else {
+            switch (layout->types[i]) {
+                case RDB_TYPE_INT:
+                    value = rdb_create_int_value(rdb_record_get_int(layout, record, i));
+                    break;
+                case RDB_TYPE_FLOAT:
+                    value = rdb_create_float_value(rdb_record_get_float(layout, record, i));
+                    break;
+                case RDB_TYPE_BOOLEAN:
+                    value = rdb_create_bool_value(rdb_record_get_bool(layout, record, i));
+                    break;
+                case RDB_TYPE_VARCHAR:
+                case RDB_TYPE_TEXT: {
+                    size_t length;
+                    const char *text = rdb_record_get_string(layout, record, i, &length);
+                    value = rdb_create_string_value_n(text, length);
+                    break;
+                }
+            }
+        }
+
+        if (!value || fi_array_push(row->values, &value) != 0) {
+            rdb_value_free(value);
+            for (size_t j = 0; j < fi_array_count(row->values); j++) {
+                rdb_value_free(*(rdb_value_t**)fi_array_get(row->values, j));
+            }
+            rdb_row_free(row);
+            return NULL;
+        }
+    }
+
+    return row;
+}
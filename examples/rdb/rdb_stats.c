@@ -0,0 +1,475 @@
+#include "rdb.h"
+#include "sql_parser.h"
+#include <math.h>
+#include <strings.h>  /* for strcasecmp */
+
+/* Table statistics
+ *
+ * ANALYZE [table] summarizes every column of a table for the planner:
+ *
+ * - the share of NULLs, counted over all live rows;
+ * - the number of distinct values, estimated over all live rows with a
+ *   HyperLogLog sketch of 2^RDB_STATS_HLL_BITS one-byte registers (about
+ *   1.6% standard error);
+ * - the most common values, each with the share of rows holding it;
+ * - an equi-depth histogram: bounds splitting the values into buckets that
+ *   hold the same number of rows each.
+ *
+ * The last two come from a sample of at most RDB_STATS_SAMPLE_ROWS live
+ * rows taken at even intervals, so analyzing a large table sorts a bounded
+ * amount of data. Statistics are a snapshot: writes do not update them, and
+ * estimates are fractions applied to the table's current row count. They
+ * are dropped when a column is added or removed, and saved with the table. */
+
+#define RDB_STATS_HLL_BITS 12
+#define RDB_STATS_HLL_REGISTERS (1u << RDB_STATS_HLL_BITS)
+#define RDB_STATS_SAMPLE_ROWS 30000
+#define RDB_STATS_BUCKETS 32
+#define RDB_STATS_MCV_COUNT 8
+
+/* Selectivity assumed for conditions the statistics cannot judge */
+#define RDB_STATS_DEFAULT_SELECTIVITY (1.0 / 3.0)
+
+static uint64_t rdb_stats_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/* 64-bit hash of a non-NULL value. INT and FLOAT values that compare equal
+ * hash alike, so they count as one distinct value. */
+static uint64_t rdb_stats_value_hash(const rdb_value_t *value) {
+    switch (value->type) {
+        case RDB_TYPE_INT:
+            return rdb_stats_mix((uint64_t)value->data.int_val);
+        case RDB_TYPE_FLOAT: {
+            double d = value->data.float_val;
+            if (d >= -9.2e18 && d <= 9.2e18 && d == floor(d)) {
+                return rdb_stats_mix((uint64_t)(int64_t)d);
+            }
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            return rdb_stats_mix(bits ^ 0x9e3779b97f4a7c15ULL);
+        }
+        case RDB_TYPE_VARCHAR:
+        case RDB_TYPE_TEXT: {
+            const unsigned char *s = (const unsigned char*)rdb_get_string_value(value);
+            size_t length = rdb_get_string_length(value);
+            uint64_t h = 0xcbf29ce484222325ULL;  /* FNV-1a offset basis */
+            for (size_t i = 0; i < length; i++) {
+                h ^= s[i];
+                h *= 0x100000001b3ULL;           /* FNV prime */
+            }
+            return rdb_stats_mix(h);
+        }
+        case RDB_TYPE_BOOLEAN:
+            return rdb_stats_mix(value->data.bool_val ? 0x27d4eb2fu : 0x165667b1u);
+    }
+    return 0;
+}
+
+/* Record a hash: the leading bits pick a register, which keeps the longest
+ * run of leading zeros (plus one) seen in the remaining bits */
+static void rdb_hll_add(uint8_t *registers, uint64_t hash) {
+    size_t index = (size_t)(hash >> (64 - RDB_STATS_HLL_BITS));
+    uint64_t rest = hash << RDB_STATS_HLL_BITS;
+    uint8_t rank = 1;
+    while (rank <= 64 - RDB_STATS_HLL_BITS && !(rest & (1ULL << 63))) {
+        rest <<= 1;
+        rank++;
+    }
+    if (rank > registers[index]) registers[index] = rank;
+}
+
+static double rdb_hll_estimate(const uint8_t *registers) {
+    double m = RDB_STATS_HLL_REGISTERS;
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < RDB_STATS_HLL_REGISTERS; i++) {
+        sum += ldexp(1.0, -registers[i]);
+        if (registers[i] == 0) zeros++;
+    }
+
+    double estimate = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+    /* Small cardinalities: linear counting over the empty registers */
+    if (estimate <= 2.5 * m && zeros > 0) estimate = m * log(m / (double)zeros);
+    return estimate;
+}
+
+static int rdb_stats_value_compare(const void *a, const void *b) {
+    return rdb_sort_value_compare(*(rdb_value_t* const*)a, *(rdb_value_t* const*)b);
+}
+
+static void rdb_column_stats_free(rdb_column_stats_t *column) {
+    for (size_t i = 0; i < column->bound_count; i++) rdb_value_free(column->bounds[i]);
+    for (size_t i = 0; i < column->mcv_count; i++) rdb_value_free(column->mcv_values[i]);
+    free(column->bounds);
+    free(column->mcv_values);
+    free(column->mcv_fractions);
+}
+
+void rdb_table_stats_destroy(rdb_table_stats_t *stats) {
+    if (!stats) return;
+    for (size_t c = 0; c < stats->column_count; c++) rdb_column_stats_free(&stats->columns[c]);
+    free(stats->columns);
+    free(stats);
+}
+
+/* Statistics for `column_count` columns, all empty */
+rdb_table_stats_t* rdb_table_stats_create(size_t column_count) {
+    rdb_table_stats_t *stats = calloc(1, sizeof(rdb_table_stats_t));
+    if (!stats) return NULL;
+
+    stats->columns = calloc(column_count ? column_count : 1, sizeof(rdb_column_stats_t));
+    if (!stats->columns) {
+        free(stats);
+        return NULL;
+    }
+    stats->column_count = column_count;
+    return stats;
+}
+
+/* Fill the most common values and histogram of a column from its sorted
+ * non-NULL sample. `taken` counts the sampled rows, NULLs included. */
+static int rdb_column_stats_from_sample(rdb_column_stats_t *column, rdb_value_t **sample,
+                                        size_t count, size_t taken) {
+    if (count == 0) return 0;
+
+    /* Distinct values in the sample, to know what "common" means */
+    size_t runs = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (rdb_sort_value_compare(sample[i - 1], sample[i]) != 0) runs++;
+    }
+
+    /* Keep the RDB_STATS_MCV_COUNT most frequent values seen at least twice
+     * and clearly more often than the average value */
+    size_t best_start[RDB_STATS_MCV_COUNT];
+    size_t best_length[RDB_STATS_MCV_COUNT];
+    size_t best = 0;
+    for (size_t start = 0; start < count; ) {
+        size_t end = start + 1;
+        while (end < count && rdb_sort_value_compare(sample[start], sample[end]) == 0) end++;
+
+        size_t length = end - start;
+        if (length >= 2 && (double)length * (double)runs > 1.25 * (double)count &&
+            (best < RDB_STATS_MCV_COUNT || length > best_length[best - 1])) {
+            size_t pos = best < RDB_STATS_MCV_COUNT ? best++ : best - 1;
+            while (pos > 0 && best_length[pos - 1] < length) {
+                best_start[pos] = best_start[pos - 1];
+                best_length[pos] = best_length[pos - 1];
+                pos--;
+            }
+            best_start[pos] = start;
+            best_length[pos] = length;
+        }
+        start = end;
+    }
+
+    if (best > 0) {
+        column->mcv_values = calloc(best, sizeof(rdb_value_t*));
+        column->mcv_fractions = calloc(best, sizeof(double));
+        if (!column->mcv_values || !column->mcv_fractions) return -1;
+        for (size_t i = 0; i < best; i++) {
+            column->mcv_values[i] = rdb_value_copy(sample[best_start[i]]);
+            if (!column->mcv_values[i]) return -1;
+            column->mcv_fractions[i] = (double)best_length[i] / (double)taken;
+            column->mcv_count++;
+        }
+    }
+
+    /* Equi-depth histogram: bound i sits at the i-th quantile */
+    if (count >= 2) {
+        size_t buckets = count - 1 < RDB_STATS_BUCKETS ? count - 1 : RDB_STATS_BUCKETS;
+        column->bounds = calloc(buckets + 1, sizeof(rdb_value_t*));
+        if (!column->bounds) return -1;
+        for (size_t i = 0; i <= buckets; i++) {
+            column->bounds[i] = rdb_value_copy(sample[i * (count - 1) / buckets]);
+            if (!column->bounds[i]) return -1;
+            column->bound_count++;
+        }
+    }
+    return 0;
+}
+
+/* Collect the statistics of every column of `table` and replace its
+ * previous ones. The caller holds the table write lock. */
+int rdb_table_analyze(rdb_table_t *table) {
+    if (!table || !table->columns) return -1;
+
+    size_t column_count = fi_array_count(table->columns);
+    size_t row_slots = table->rows ? fi_array_count(table->rows) : 0;
+    size_t live = rdb_table_live_row_count(table);
+    size_t target = live < RDB_STATS_SAMPLE_ROWS ? live : RDB_STATS_SAMPLE_ROWS;
+
+    rdb_table_stats_t *stats = rdb_table_stats_create(column_count);
+    uint8_t *registers = malloc(RDB_STATS_HLL_REGISTERS);
+    rdb_value_t **sample = malloc((target ? target : 1) * sizeof(rdb_value_t*));
+    if (!stats || !registers || !sample) {
+        rdb_table_stats_destroy(stats);
+        free(registers);
+        free(sample);
+        return -1;
+    }
+    stats->row_count = live;
+    stats->analyzed_time = time(NULL);
+
+    int result = 0;
+    for (size_t c = 0; c < column_count && result == 0; c++) {
+        memset(registers, 0, RDB_STATS_HLL_REGISTERS);
+        size_t nulls = 0, count = 0, taken = 0, seen = 0;
+
+        for (size_t i = 0; i < row_slots; i++) {
+            rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+            if (!row || row->deleted) continue;
+
+            /* Take `target` of the `live` rows at even intervals */
+            bool take = (seen + 1) * target / live > seen * target / live;
+            seen++;
+            if (take) taken++;
+
+            const rdb_value_t *value = row->values && c < fi_array_count(row->values) ?
+                                       *(rdb_value_t**)fi_array_get(row->values, c) : NULL;
+            if (!value || value->is_null) {
+                nulls++;
+                continue;
+            }
+            rdb_hll_add(registers, rdb_stats_value_hash(value));
+            if (take) sample[count++] = (rdb_value_t*)value;
+        }
+
+        rdb_column_stats_t *column = &stats->columns[c];
+        column->null_fraction = live ? (double)nulls / (double)live : 0.0;
+        if (live > nulls) {
+            double distinct = rdb_hll_estimate(registers);
+            if (distinct > (double)(live - nulls)) distinct = (double)(live - nulls);
+            column->distinct_count = distinct < 1.0 ? 1.0 : distinct;
+        }
+
+        qsort(sample, count, sizeof(rdb_value_t*), rdb_stats_value_compare);
+        result = rdb_column_stats_from_sample(column, sample, count, taken);
+    }
+
+    free(registers);
+    free(sample);
+    if (result != 0) {
+        rdb_table_stats_destroy(stats);
+        return -1;
+    }
+
+    rdb_table_stats_destroy(table->stats);
+    table->stats = stats;
+    return 0;
+}
+
+/* ANALYZE [table]: collect statistics for one table, or all of them.
+ * Returns the number of tables analyzed. */
+int rdb_analyze(rdb_database_t *db, const char *table_name) {
+    if (!db) return -1;
+
+    if (rdb_lock_database_write(db) != 0) return -1;
+
+    fi_array *tables = NULL;
+    if (table_name && table_name[0] != '\0') {
+        rdb_table_t *table = rdb_get_table(db, table_name);
+        if (!table) {
+            rdb_unlock_database(db);
+            printf("Error: Table '%s' does not exist\n", table_name);
+            return -1;
+        }
+        tables = fi_array_create(1, sizeof(rdb_table_t*));
+        if (tables) fi_array_push(tables, &table);
+    } else {
+        tables = fi_map_values(db->tables);
+    }
+    if (!tables) {
+        rdb_unlock_database(db);
+        return -1;
+    }
+
+    int analyzed = 0;
+    for (size_t i = 0; i < fi_array_count(tables); i++) {
+        rdb_table_t *table = *(rdb_table_t**)fi_array_get(tables, i);
+        if (!table || rdb_lock_table_write(table) != 0) continue;
+
+        if (rdb_table_analyze(table) == 0) {
+            analyzed++;
+            printf("Analyzed table '%s': %zu rows\n", table->name, table->stats->row_count);
+        } else {
+            printf("Error: Failed to analyze table '%s'\n", table->name);
+        }
+        rdb_unlock_table(table);
+    }
+    fi_array_destroy(tables);
+
+    rdb_unlock_database(db);
+    return analyzed;
+}
+
+/* Share of rows equal to `value`: its own frequency when it is a common
+ * value, else the rows outside the common values spread evenly over the
+ * other distinct values */
+static double rdb_stats_equal_fraction(const rdb_column_stats_t *column, const rdb_value_t *value) {
+    double rest = 1.0 - column->null_fraction;
+    double others = column->distinct_count;
+    for (size_t i = 0; i < column->mcv_count; i++) {
+        if (rdb_sort_value_compare(column->mcv_values[i], value) == 0) return column->mcv_fractions[i];
+        rest -= column->mcv_fractions[i];
+        others -= 1.0;
+    }
+    if (rest <= 0.0) return 0.0;
+    return others > 1.0 ? rest / others : rest;
+}
+
+static bool rdb_stats_numeric(const rdb_value_t *value, double *number) {
+    if (value->type == RDB_TYPE_INT) {
+        *number = (double)value->data.int_val;
+        return true;
+    }
+    if (value->type == RDB_TYPE_FLOAT && !isnan(value->data.float_val)) {
+        *number = value->data.float_val;
+        return true;
+    }
+    return false;
+}
+
+/* Share of the non-NULL values that sort below `value`, read from the
+ * histogram and interpolated within numeric buckets */
+static double rdb_stats_histogram_position(const rdb_column_stats_t *column, const rdb_value_t *value) {
+    if (column->bound_count < 2) return 0.5;
+
+    size_t buckets = column->bound_count - 1;
+    if (rdb_sort_value_compare(value, column->bounds[0]) <= 0) return 0.0;
+    if (rdb_sort_value_compare(value, column->bounds[buckets]) > 0) return 1.0;
+
+    /* Bucket [bounds[low], bounds[high]] holding the value */
+    size_t low = 0, high = buckets;
+    while (high - low > 1) {
+        size_t mid = low + (high - low) / 2;
+        if (rdb_sort_value_compare(column->bounds[mid], value) < 0) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    double within = 0.5;
+    double v, lo, hi;
+    if (rdb_stats_numeric(value, &v) && rdb_stats_numeric(column->bounds[low], &lo) &&
+        rdb_stats_numeric(column->bounds[high], &hi) && hi > lo) {
+        within = (v - lo) / (hi - lo);
+    }
+    return ((double)low + within) / (double)buckets;
+}
+
+/* Estimated share of the live rows of `table` satisfying `cond`, following
+ * rdb_condition_matches(), or a negative value when the table has no
+ * statistics or they cannot judge the condition */
+double rdb_stats_condition_selectivity(rdb_table_t *table, const sql_where_condition_t *cond) {
+    if (!table || !table->stats || !cond || cond->expr) return -1.0;
+
+    int index = rdb_get_column_index(table, cond->column_name);
+    if (index < 0 || (size_t)index >= table->stats->column_count) return -1.0;
+    const rdb_column_stats_t *column = &table->stats->columns[index];
+
+    bool literal_null = !cond->value || cond->value->is_null;
+    if (cond->operator == SQL_OP_IS && literal_null) return column->null_fraction;
+    if (literal_null) return 0.0;
+
+    /* Numbers never match strings and the other way round */
+    const rdb_value_t *literal = cond->value;
+    const rdb_value_t *sample = column->bound_count ? column->bounds[0] :
+                                column->mcv_count ? column->mcv_values[0] : NULL;
+    bool comparable = true;
+    if (sample) rdb_condition_compare(sample, literal, &comparable);
+    if (!comparable) return 0.0;
+
+    double non_null = 1.0 - column->null_fraction;
+    double selectivity;
+    switch (cond->operator) {
+        case SQL_OP_EQUAL:
+        case SQL_OP_IS:
+        case SQL_OP_IN:
+            selectivity = rdb_stats_equal_fraction(column, literal);
+            break;
+        case SQL_OP_NOT_EQUAL:
+            selectivity = non_null - rdb_stats_equal_fraction(column, literal);
+            break;
+        case SQL_OP_LESS_THAN:
+        case SQL_OP_LESS_EQUAL:
+            selectivity = non_null * rdb_stats_histogram_position(column, literal);
+            if (cond->operator == SQL_OP_LESS_EQUAL) selectivity += rdb_stats_equal_fraction(column, literal);
+            break;
+        case SQL_OP_GREATER_THAN:
+        case SQL_OP_GREATER_EQUAL:
+            selectivity = non_null * (1.0 - rdb_stats_histogram_position(column, literal));
+            if (cond->operator == SQL_OP_GREATER_THAN) selectivity -= rdb_stats_equal_fraction(column, literal);
+            break;
+        case SQL_OP_LIKE:
+            /* Only a pattern without wildcards has a known selectivity */
+            if ((literal->type != RDB_TYPE_VARCHAR && literal->type != RDB_TYPE_TEXT) ||
+                strpbrk(rdb_get_string_value(literal), "%_")) {
+                return -1.0;
+            }
+            selectivity = rdb_stats_equal_fraction(column, literal);
+            break;
+        default:
+            return -1.0;
+    }
+
+    if (selectivity < 0.0) return 0.0;
+    return selectivity > non_null ? non_null : selectivity;
+}
+
+/* Estimated number of live rows of `table` satisfying the WHERE clause.
+ * Conditions of an AND group multiply their selectivities, OR groups
+ * combine as independent events, and conditions the statistics cannot
+ * judge count as RDB_STATS_DEFAULT_SELECTIVITY. */
+double rdb_stats_estimate_rows(rdb_table_t *table, fi_array *where_conditions) {
+    if (!table) return 0.0;
+
+    double rows = (double)rdb_table_live_row_count(table);
+    size_t count = where_conditions ? fi_array_count(where_conditions) : 0;
+    if (count == 0) return rows;
+
+    double none = 1.0;          /* Chance that no OR group holds */
+    double group = 1.0;
+    for (size_t i = 0; i < count; i++) {
+        const sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(where_conditions, i);
+        double selectivity = rdb_stats_condition_selectivity(table, cond);
+        group *= selectivity < 0.0 ? RDB_STATS_DEFAULT_SELECTIVITY : selectivity;
+
+        if (i + 1 == count || (cond && strcasecmp(cond->logical_connector, "OR") == 0)) {
+            none *= 1.0 - group;
+            group = 1.0;
+        }
+    }
+    return rows * (1.0 - none);
+}
+
+/* Print the statistics of `table`, if it has been analyzed */
+void rdb_print_table_stats(rdb_table_t *table) {
+    if (!table || !table->stats) return;
+
+    rdb_table_stats_t *stats = table->stats;
+    char analyzed[32];
+    strftime(analyzed, sizeof(analyzed), "%Y-%m-%d %H:%M:%S", localtime(&stats->analyzed_time));
+    printf("\nStatistics (%zu rows, analyzed %s):\n", stats->row_count, analyzed);
+    printf("%-20s %-12s %-10s %-8s %s\n", "Column", "Distinct", "Null %", "Buckets", "Most common");
+    printf("%s\n", "------------------------------------------------------------------------");
+
+    for (size_t c = 0; c < stats->column_count && c < fi_array_count(table->columns); c++) {
+        const rdb_column_t *col = *(rdb_column_t**)fi_array_get(table->columns, c);
+        const rdb_column_stats_t *column = &stats->columns[c];
+        printf("%-20s %-12.0f %-10.2f %-8zu ", col->name, column->distinct_count,
+               column->null_fraction * 100.0, column->bound_count ? column->bound_count - 1 : 0);
+        for (size_t i = 0; i < column->mcv_count && i < 3; i++) {
+            char *text = rdb_value_to_string(column->mcv_values[i]);
+            printf("%s%s (%.1f%%)", i ? ", " : "", text ? text : "?", column->mcv_fractions[i] * 100.0);
+            free(text);
+        }
+        printf("%s\n", column->mcv_count ? "" : "-");
+    }
+}
@@ -0,0 +1,213 @@
+#include "rdb.h"
+#include <errno.h>
+
+/* Tombstones and compaction
+ *
+ * Deleting a row only marks it dead: it leaves the indexes and the column
+ * store at once, but keeps its slot in table->rows and its row-id map entry
+ * until the table is compacted. Scans skip dead rows, and slots of live rows
+ * do not move under a delete. Compaction rewrites table->rows without the
+ * dead rows in one pass once they pass RDB_COMPACT_DEAD_PERCENT of the
+ * table: on the background compaction thread when one is running, inline at
+ * the end of the deleting statement otherwise. VACUUM forces it.
+ *
+ * The compaction thread takes the database and then the table lock, like the
+ * thread-safe operations, so it is meant to be paired with those. */
+
+void rdb_table_delete_row(rdb_table_t *table, rdb_row_t *row) {
+    if (!table || !row || row->deleted) return;
+
+    rdb_remove_row_from_indexes(table, row);
+    row->deleted = true;
+    table->dead_rows++;
+}
+
+/* Bring back a row whose tombstone is still in place (rollback of a
+ * delete). Returns NULL when the row has been compacted away. */
+rdb_row_t* rdb_table_restore_row(rdb_table_t *table, size_t row_id) {
+    if (!table || !table->row_map) return NULL;
+
+    uint64_t key = row_id;
+    rdb_row_t *row = NULL;
+    if (fi_map_get(table->row_map, &key, &row) != 0 || !row || !row->deleted) return NULL;
+
+    row->deleted = false;
+    table->dead_rows--;
+    rdb_update_table_indexes(table, row);
+    return row;
+}
+
+size_t rdb_table_live_row_count(const rdb_table_t *table) {
+    if (!table || !table->rows) return 0;
+    return fi_array_count(table->rows) - table->dead_rows;
+}
+
+bool rdb_table_needs_compaction(const rdb_table_t *table) {
+    if (!table || !table->rows || table->dead_rows < RDB_COMPACT_MIN_DEAD_ROWS) return false;
+    return table->dead_rows * 100 >= fi_array_count(table->rows) * RDB_COMPACT_DEAD_PERCENT;
+}
+
+/* Rewrite table->rows without its tombstones. The caller holds the table
+ * lock (or runs single-threaded). Returns the number of rows reclaimed. */
+size_t rdb_table_compact(rdb_table_t *table) {
+    if (!table || !table->rows || table->dead_rows == 0) return 0;
+
+    size_t count = fi_array_count(table->rows);
+    fi_array *live = fi_array_create(count - table->dead_rows + 16, sizeof(rdb_row_t*));
+    if (!live) return 0;
+
+    for (size_t i = 0; i < count; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (row && !row->deleted && fi_array_push(live, &row) != 0) {
+            fi_array_destroy(live);
+            return 0;
+        }
+    }
+
+    size_t reclaimed = 0;
+    for (size_t i = 0; i < count; i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (!row || !row->deleted) continue;
+
+        uint64_t row_id = row->row_id;
+        if (table->row_map) fi_map_remove(table->row_map, &row_id);
+        rdb_row_free(row);
+        reclaimed++;
+    }
+
+    fi_array_destroy(table->rows);
+    table->rows = live;
+    table->dead_rows = 0;
+
+    /* Deletes only widen zone ranges; tighten them again */
+    rdb_zone_map_rebuild(table);
+    return reclaimed;
+}
+
+/* Called after a statement tombstoned rows of `table` */
+void rdb_schedule_compaction(rdb_database_t *db, rdb_table_t *table) {
+    if (!db || !rdb_table_needs_compaction(table)) return;
+
+    pthread_mutex_lock(&db->compaction_mutex);
+    bool background = db->compaction_running;
+    if (background) pthread_cond_signal(&db->compaction_cond);
+    pthread_mutex_unlock(&db->compaction_mutex);
+
+    if (!background) rdb_table_compact(table);
+}
+
+/* Compact every table (`force`) or those past the threshold */
+static size_t rdb_compact_tables(rdb_database_t *db, bool force) {
+    if (rdb_lock_database_write(db) != 0) return 0;
+
+    size_t reclaimed = 0;
+    fi_array *tables = fi_map_values(db->tables);
+    for (size_t i = 0; tables && i < fi_array_count(tables); i++) {
+        rdb_table_t *table = *(rdb_table_t**)fi_array_get(tables, i);
+        if (!table || (!force && !rdb_table_needs_compaction(table))) continue;
+
+        if (rdb_lock_table_write(table) != 0) continue;
+        reclaimed += rdb_table_compact(table);
+        rdb_unlock_table(table);
+    }
+    if (tables) fi_array_destroy(tables);
+
+    rdb_unlock_database(db);
+    return reclaimed;
+}
+
+/* VACUUM [table]: compact one table, or all of them. Returns the number of
+ * rows reclaimed. */
+int rdb_vacuum(rdb_database_t *db, const char *table_name) {
+    if (!db) return -1;
+
+    size_t reclaimed;
+    if (table_name && table_name[0] != '\0') {
+        if (rdb_lock_database_write(db) != 0) return -1;
+
+        rdb_table_t *table = rdb_get_table(db, table_name);
+        if (!table) {
+            rdb_unlock_database(db);
+            printf("Error: Table '%s' does not exist\n", table_name);
+            return -1;
+        }
+        if (rdb_lock_table_write(table) != 0) {
+            rdb_unlock_database(db);
+            return -1;
+        }
+        reclaimed = rdb_table_compact(table);
+        rdb_unlock_table(table);
+        rdb_unlock_database(db);
+
+        printf("Vacuumed table '%s': %zu dead rows reclaimed\n", table_name, reclaimed);
+    } else {
+        reclaimed = rdb_compact_tables(db, true);
+        printf("Vacuumed database '%s': %zu dead rows reclaimed\n", db->name, reclaimed);
+    }
+
+    return (int)reclaimed;
+}
+
+static void* rdb_compaction_thread(void *arg) {
+    rdb_database_t *db = (rdb_database_t*)arg;
+
+    pthread_mutex_lock(&db->compaction_mutex);
+    while (db->compaction_running) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += db->compaction_interval_ms / 1000;
+        deadline.tv_nsec += (long)(db->compaction_interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        int wait = pthread_cond_timedwait(&db->compaction_cond, &db->compaction_mutex, &deadline);
+        if (!db->compaction_running) break;
+        if (wait != 0 && wait != ETIMEDOUT) continue;
+
+        pthread_mutex_unlock(&db->compaction_mutex);
+        rdb_compact_tables(db, false);
+        pthread_mutex_lock(&db->compaction_mutex);
+    }
+    pthread_mutex_unlock(&db->compaction_mutex);
+
+    return NULL;
+}
+
+int rdb_start_compaction(rdb_database_t *db, unsigned interval_ms) {
+    if (!db) return -1;
+
+    pthread_mutex_lock(&db->compaction_mutex);
+    if (db->compaction_running) {
+        pthread_mutex_unlock(&db->compaction_mutex);
+        return -1;
+    }
+
+    db->compaction_interval_ms = interval_ms > 0 ? interval_ms : 1000;
+    db->compaction_running = true;
+    if (pthread_create(&db->compaction_thread, NULL, rdb_compaction_thread, db) != 0) {
+        db->compaction_running = false;
+        pthread_mutex_unlock(&db->compaction_mutex);
+        printf("Error: Failed to start the compaction thread\n");
+        return -1;
+    }
+    pthread_mutex_unlock(&db->compaction_mutex);
+
+    return 0;
+}
+
+int rdb_stop_compaction(rdb_database_t *db) {
+    if (!db) return -1;
+
+    pthread_mutex_lock(&db->compaction_mutex);
+    if (!db->compaction_running) {
+        pthread_mutex_unlock(&db->compaction_mutex);
+        return -1;
+    }
+    db->compaction_running = false;
+    pthread_cond_signal(&db->compaction_cond);
+    pthread_mutex_unlock(&db->compaction_mutex);
+
+    return pthread_join(db->compaction_thread, NULL) == 0 ? 0 : -1;
+}
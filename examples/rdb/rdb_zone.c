@@ -0,0 +1,317 @@
+#include "rdb.h"
+#include "sql_parser.h"
+#include <math.h>
+#include <strings.h>  /* for strcasecmp */
+
+/* Zone maps
+ *
+ * Every table keeps, for each block of RDB_ZONE_ROWS consecutive row ids and
+ * each column, the number of live rows and NULLs in the block and the range
+ * of its INT and FLOAT values. The maps are maintained like a secondary
+ * index: rows entering the indexes widen the ranges of their block and
+ * count, rows leaving them are uncounted. Ranges never shrink under deletes
+ * or updates; compaction rebuilds them exactly.
+ *
+ * Blocks are keyed by row id rather than by slot, so compaction and rows put
+ * back by a rollback never move them. Since table->rows is kept in row id
+ * order, the slots of a block are found by binary search.
+ *
+ * A full scan with a WHERE clause first asks the zone maps which blocks
+ * can hold a matching row: a block is ruled out when every OR group of the
+ * clause has a `column op literal` condition that none of the block's
+ * values can satisfy. On append-ordered columns (ids, timestamps) a range
+ * predicate rules out all but a few blocks, and only their rows are read.
+ * Values that are not INT or FLOAT (strings, booleans, NaN) make a column
+ * unbounded in their block, so it is never ruled out by that column. */
+
+/* Number of blocks needed for row ids up to `row_id` */
+static size_t rdb_zone_block(size_t row_id) {
+    return row_id > 0 ? (row_id - 1) / RDB_ZONE_ROWS : 0;
+}
+
+rdb_zone_map_t* rdb_zone_map_create(size_t column_count) {
+    rdb_zone_map_t *map = calloc(1, sizeof(rdb_zone_map_t));
+    if (!map) return NULL;
+
+    map->column_count = column_count;
+    return map;
+}
+
+void rdb_zone_map_destroy(rdb_zone_map_t *map) {
+    if (!map) return;
+    free(map->row_counts);
+    free(map->zones);
+    free(map);
+}
+
+/* Make room for block `block`; new blocks start empty */
+static int rdb_zone_map_reserve(rdb_zone_map_t *map, size_t block) {
+    if (block < map->block_count) return 0;
+
+    size_t count = map->block_count ? map->block_count : 4;
+    while (count <= block) count *= 2;
+
+    uint32_t *row_counts = realloc(map->row_counts, count * sizeof(uint32_t));
+    if (!row_counts) return -1;
+    map->row_counts = row_counts;
+
+    rdb_zone_t *zones = realloc(map->zones, count * (map->column_count ? map->column_count : 1) *
+                                            sizeof(rdb_zone_t));
+    if (!zones) return -1;
+    map->zones = zones;
+
+    memset(map->row_counts + map->block_count, 0, (count - map->block_count) * sizeof(uint32_t));
+    memset(map->zones + map->block_count * map->column_count, 0,
+           (count - map->block_count) * map->column_count * sizeof(rdb_zone_t));
+    map->block_count = count;
+    return 0;
+}
+
+static void rdb_zone_widen(rdb_zone_t *zone, const rdb_value_t *value) {
+    if (!value || value->is_null) {
+        zone->null_count++;
+        return;
+    }
+
+    if (value->type == RDB_TYPE_INT) {
+        int64_t v = value->data.int_val;
+        if (!(zone->flags & RDB_ZONE_HAS_INT)) {
+            zone->int_min = zone->int_max = v;
+            zone->flags |= RDB_ZONE_HAS_INT;
+        } else if (v < zone->int_min) {
+            zone->int_min = v;
+        } else if (v > zone->int_max) {
+            zone->int_max = v;
+        }
+    } else if (value->type == RDB_TYPE_FLOAT && !isnan(value->data.float_val)) {
+        double v = value->data.float_val;
+        if (!(zone->flags & RDB_ZONE_HAS_FLOAT)) {
+            zone->float_min = zone->float_max = v;
+            zone->flags |= RDB_ZONE_HAS_FLOAT;
+        } else if (v < zone->float_min) {
+            zone->float_min = v;
+        } else if (v > zone->float_max) {
+            zone->float_max = v;
+        }
+    } else {
+        zone->flags |= RDB_ZONE_UNBOUNDED;
+    }
+}
+
+/* Count `row` in its block. Called for every row entering the indexes. */
+void rdb_zone_map_add_row(rdb_table_t *table, const rdb_row_t *row) {
+    if (!table || !table->zones || !row || !row->values) return;
+
+    rdb_zone_map_t *map = table->zones;
+    size_t block = rdb_zone_block(row->row_id);
+    if (rdb_zone_map_reserve(map, block) != 0) {
+        /* Without a summary the block could be skipped wrongly */
+        rdb_zone_map_destroy(map);
+        table->zones = NULL;
+        return;
+    }
+
+    map->row_counts[block]++;
+    rdb_zone_t *zones = map->zones + block * map->column_count;
+    for (size_t c = 0; c < map->column_count; c++) {
+        const rdb_value_t *value = c < fi_array_count(row->values) ?
+                                   *(rdb_value_t**)fi_array_get(row->values, c) : NULL;
+        rdb_zone_widen(&zones[c], value);
+    }
+}
+
+/* Uncount `row`, whose values are still the ones it was counted with */
+void rdb_zone_map_remove_row(rdb_table_t *table, const rdb_row_t *row) {
+    if (!table || !table->zones || !row || !row->values) return;
+
+    rdb_zone_map_t *map = table->zones;
+    size_t block = rdb_zone_block(row->row_id);
+    if (block >= map->block_count || map->row_counts[block] == 0) return;
+
+    map->row_counts[block]--;
+    rdb_zone_t *zones = map->zones + block * map->column_count;
+    for (size_t c = 0; c < map->column_count; c++) {
+        const rdb_value_t *value = c < fi_array_count(row->values) ?
+                                   *(rdb_value_t**)fi_array_get(row->values, c) : NULL;
+        if ((!value || value->is_null) && zones[c].null_count > 0) zones[c].null_count--;
+    }
+}
+
+/* Recompute the zone maps of `table` from its live rows */
+int rdb_zone_map_rebuild(rdb_table_t *table) {
+    if (!table || !table->columns) return -1;
+
+    rdb_zone_map_t *map = rdb_zone_map_create(fi_array_count(table->columns));
+    if (!map) return -1;
+
+    rdb_zone_map_destroy(table->zones);
+    table->zones = map;
+    for (size_t i = 0; table->rows && i < fi_array_count(table->rows); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (row && !row->deleted) rdb_zone_map_add_row(table, row);
+    }
+    return table->zones ? 0 : -1;
+}
+
+/* Whether some value in [low, high] compares to `literal` as `op` asks */
+static bool rdb_zone_range_may_match(double low, double high, sql_operator_t op, double literal) {
+    switch (op) {
+        case SQL_OP_EQUAL:
+        case SQL_OP_IS:
+        case SQL_OP_IN:
+            return low <= literal && literal <= high;
+        case SQL_OP_NOT_EQUAL:
+            return !(low == literal && high == literal);
+        case SQL_OP_LESS_THAN:
+            return low < literal;
+        case SQL_OP_LESS_EQUAL:
+            return low <= literal;
+        case SQL_OP_GREATER_THAN:
+            return high > literal;
+        case SQL_OP_GREATER_EQUAL:
+            return high >= literal;
+        default:
+            return true;
+    }
+}
+
+static bool rdb_zone_int_range_may_match(int64_t low, int64_t high, sql_operator_t op, int64_t literal) {
+    switch (op) {
+        case SQL_OP_EQUAL:
+        case SQL_OP_IS:
+        case SQL_OP_IN:
+            return low <= literal && literal <= high;
+        case SQL_OP_NOT_EQUAL:
+            return !(low == literal && high == literal);
+        case SQL_OP_LESS_THAN:
+            return low < literal;
+        case SQL_OP_LESS_EQUAL:
+            return low <= literal;
+        case SQL_OP_GREATER_THAN:
+            return high > literal;
+        case SQL_OP_GREATER_EQUAL:
+            return high >= literal;
+        default:
+            return true;
+    }
+}
+
+/* Whether a row of the block summarized by `zone` (holding `rows` live
+ * rows) may satisfy `cond`, following rdb_condition_matches() */
+static bool rdb_zone_may_match(const rdb_zone_t *zone, uint32_t rows, const sql_where_condition_t *cond) {
+    bool literal_null = !cond->value || cond->value->is_null;
+    if (cond->operator == SQL_OP_IS && literal_null) return zone->null_count > 0;
+    if (literal_null) return false;
+
+    /* Only NULLs in the block: no comparison is true */
+    if (zone->null_count >= rows) return false;
+    if (zone->flags & RDB_ZONE_UNBOUNDED) return true;
+
+    const rdb_value_t *literal = cond->value;
+    if (literal->type != RDB_TYPE_INT && literal->type != RDB_TYPE_FLOAT) {
+        /* Numbers never compare with other literals */
+        return false;
+    }
+    if (cond->operator == SQL_OP_LIKE) return false;
+
+    bool may_match = false;
+    if (zone->flags & RDB_ZONE_HAS_INT) {
+        if (literal->type == RDB_TYPE_INT) {
+            may_match = rdb_zone_int_range_may_match(zone->int_min, zone->int_max, cond->operator,
+                                                     literal->data.int_val);
+        } else {
+            may_match = rdb_zone_range_may_match((double)zone->int_min, (double)zone->int_max,
+                                                 cond->operator, literal->data.float_val);
+        }
+    }
+    if (!may_match && (zone->flags & RDB_ZONE_HAS_FLOAT)) {
+        double value = literal->type == RDB_TYPE_INT ? (double)literal->data.int_val : literal->data.float_val;
+        may_match = rdb_zone_range_may_match(zone->float_min, zone->float_max, cond->operator, value);
+    }
+    return may_match;
+}
+
+/* Whether block `block` may hold a row satisfying the WHERE clause.
+ * `columns` holds the ordinal of each condition's column (-1 if none). */
+static bool rdb_zone_block_may_match(const rdb_zone_map_t *map, size_t block, fi_array *where_conditions,
+                                     const int *columns) {
+    uint32_t rows = map->row_counts[block];
+    if (rows == 0) return false;
+
+    const rdb_zone_t *zones = map->zones + block * map->column_count;
+    bool group_may_match = true;
+    size_t count = fi_array_count(where_conditions);
+    for (size_t i = 0; i < count; i++) {
+        const sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(where_conditions, i);
+        if (group_may_match && columns[i] >= 0) {
+            group_may_match = rdb_zone_may_match(&zones[columns[i]], rows, cond);
+        }
+
+        /* AND binds tighter than OR: an OR ends the group */
+        bool group_end = i + 1 == count || (cond && strcasecmp(cond->logical_connector, "OR") == 0);
+        if (group_end) {
+            if (group_may_match) return true;
+            group_may_match = true;
+        }
+    }
+    return false;
+}
+
+/* Rows of the blocks of `table` that may satisfy the WHERE clause, as
+ * borrowed row pointers in slot order. Returns NULL when the zone maps
+ * cannot rule out at least half of the table, as scanning it all is then
+ * cheaper than collecting the candidates. */
+fi_array* rdb_zone_map_candidates(rdb_table_t *table, fi_array *where_conditions) {
+    if (!table || !table->zones || !table->rows || !where_conditions) return NULL;
+
+    rdb_zone_map_t *map = table->zones;
+    size_t total = fi_array_count(table->rows);
+    size_t count = fi_array_count(where_conditions);
+    if (total < 2 * RDB_ZONE_ROWS || count == 0) return NULL;
+
+    int *columns = malloc(count * sizeof(int));
+    if (!columns) return NULL;
+
+    bool usable = false;
+    for (size_t i = 0; i < count; i++) {
+        const sql_where_condition_t *cond = *(sql_where_condition_t**)fi_array_get(where_conditions, i);
+        columns[i] = cond && !cond->expr ? rdb_get_column_index(table, cond->column_name) : -1;
+        if (columns[i] >= (int)map->column_count) columns[i] = -1;
+        usable |= columns[i] >= 0;
+    }
+
+    /* Slot ranges of the blocks that may match; the rows of block b have
+     * ids in [b * RDB_ZONE_ROWS + 1, (b + 1) * RDB_ZONE_ROWS] */
+    fi_array *ranges = usable ? fi_array_create(16, sizeof(size_t) * 2) : NULL;
+    size_t kept = 0;
+    size_t start = 0;
+    for (size_t block = 0; ranges && block < map->block_count && start < total; block++) {
+        size_t end = rdb_table_lower_slot(table, (block + 1) * RDB_ZONE_ROWS + 1);
+        if (end > start && rdb_zone_block_may_match(map, block, where_conditions, columns)) {
+            size_t range[2] = {start, end};
+            fi_array_push(ranges, range);
+            kept += end - start;
+        }
+        start = end;
+    }
+    /* Rows past the last summarized block are always candidates */
+    if (ranges && start < total) {
+        size_t range[2] = {start, total};
+        fi_array_push(ranges, range);
+        kept += total - start;
+    }
+    free(columns);
+
+    fi_array *candidates = NULL;
+    if (ranges && kept <= total / 2) {
+        candidates = fi_array_create(kept ? kept : 16, sizeof(rdb_row_t*));
+        for (size_t r = 0; candidates && r < fi_array_count(ranges); r++) {
+            const size_t *range = (const size_t*)fi_array_get(ranges, r);
+            for (size_t slot = range[0]; slot < range[1]; slot++) {
+                fi_array_push(candidates, fi_array_get(table->rows, slot));
+            }
+        }
+    }
+    if (ranges) fi_array_destroy(ranges);
+    return candidates;
+}
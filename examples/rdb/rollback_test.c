@@ -0,0 +1,132 @@
+#include "test_support.h"
+
+#define ROW_COUNT 500
+
+/* Every live row is reachable by id through the row map, tombstones are
+ * not, and table->rows stays in row id order */
+static void check_row_map(rdb_database_t *db, const char *table_name) {
+    rdb_table_t *table = rdb_get_table(db, table_name);
+    assert(table != NULL && table->row_map != NULL);
+    assert(fi_map_size(table->row_map) == fi_array_count(table->rows));
+
+    size_t dead = 0;
+    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        if (row->deleted) dead++;
+        assert(rdb_table_find_row(table, row->row_id) == (row->deleted ? NULL : row));
+        if (i > 0) {
+            rdb_row_t *previous = *(rdb_row_t**)fi_array_get(table->rows, i - 1);
+            assert(previous->row_id < row->row_id);
+        }
+    }
+    assert(dead == table->dead_rows);
+    assert(rdb_table_find_row(table, table->next_row_id) == NULL);
+}
+
+/* The same changes, logged in a transaction on "t" and applied directly to
+ * "mirror" when `mirror` is set */
+static void make_changes(rdb_database_t *db, bool mirror) {
+    for (int i = 0; i < 20; i++) {
+        assert(test_exec_transactional(db, "INSERT INTO t VALUES (%d, %d, 'new %d')", ROW_COUNT + i, i, i) == 0);
+        if (mirror) assert(test_exec(db, "INSERT INTO mirror VALUES (%d, %d, 'new %d')", ROW_COUNT + i, i, i) == 0);
+    }
+
+    const char *changes[] = {
+        "UPDATE %s SET v = 1000, s = 'a value long enough to live outside the row' WHERE v < 10",
+        "DELETE FROM %s WHERE v = 20",
+        "DELETE FROM %s WHERE id > 490",
+        "UPDATE %s SET v = 2000 WHERE v = 1000 AND id < 100",
+    };
+    for (size_t c = 0; c < sizeof(changes) / sizeof(changes[0]); c++) {
+        assert(test_exec_transactional(db, changes[c], "t") >= 0);
+        if (mirror) assert(test_exec(db, changes[c], "mirror") >= 0);
+    }
+}
+
+/* Values of another type than their column (2.5 and 'x' in an INT column,
+ * 7 in a VARCHAR one) come back from a rollback with their own type and
+ * value */
+static void check_other_types(rdb_database_t *db) {
+    assert(test_exec(db, "CREATE TABLE o (id INT, v INT, f FLOAT, b BOOLEAN, s VARCHAR(16))") == 0);
+    const char *rows[] = {
+        "0, 2.5, 1, TRUE, 7",
+        "1, 'x', 'y', 3, 2.25",
+        "2, TRUE, NULL, 1.5, 'a value long enough to live outside the row'",
+        "3, -4, 0.5, FALSE, NULL",
+    };
+    for (size_t r = 0; r < sizeof(rows) / sizeof(rows[0]); r++) {
+        assert(test_exec(db, "INSERT INTO o VALUES (%s)", rows[r]) == 0);
+    }
+
+    test_result_t *before = test_query(db, "SELECT * FROM o");
+    assert(before != NULL && before->rows == 4);
+    assert(test_value(before, 0, 1)->type == RDB_TYPE_FLOAT && test_value(before, 1, 1)->type == RDB_TYPE_VARCHAR);
+
+    assert(rdb_begin_transaction(db, RDB_ISOLATION_READ_COMMITTED) == 0);
+    assert(test_exec_transactional(db, "UPDATE o SET v = 9, f = 9.0, b = FALSE, s = 'z' WHERE id < 2") == 2);
+    assert(test_exec_transactional(db, "DELETE FROM o WHERE id >= 2") == 2);
+    assert(rdb_rollback_transaction(db) == 0);
+
+    test_result_t *after = test_query(db, "SELECT * FROM o");
+    assert(test_same_result(before, after));
+    test_result_free(before);
+    test_result_free(after);
+}
+
+int main() {
+    printf("=== FI RDB Rollback Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("rollback_test");
+    assert(test_exec(db, "CREATE TABLE t (id INT, v INT, s VARCHAR(64))") == 0);
+    assert(test_exec(db, "CREATE TABLE mirror (id INT, v INT, s VARCHAR(64))") == 0);
+    assert(test_exec(db, "CREATE INDEX idx_t_v ON t (v)") == 0);
+    for (int i = 0; i < ROW_COUNT; i++) {
+        assert(test_exec(db, "INSERT INTO t VALUES (%d, %d, 's%d')", i, (i * 7) % 50, i) == 0);
+        assert(test_exec(db, "INSERT INTO mirror VALUES (%d, %d, 's%d')", i, (i * 7) % 50, i) == 0);
+    }
+    check_row_map(db, "t");
+
+    /* A rolled-back transaction leaves the table exactly as it was,
+     * rows in their original order */
+    printf("Checking rollback...\n");
+    test_result_t *before = test_query(db, "SELECT * FROM t");
+    assert(rdb_begin_transaction(db, RDB_ISOLATION_READ_COMMITTED) == 0);
+    make_changes(db, false);
+    assert(rdb_rollback_transaction(db) == 0);
+
+    test_result_t *after = test_query(db, "SELECT * FROM t");
+    assert(test_same_result(before, after));
+    test_result_free(before);
+    test_result_free(after);
+    check_row_map(db, "t");
+    test_expect_same_rows(db, "SELECT * FROM t WHERE v = 3", "SELECT * FROM mirror WHERE v = 3");
+    test_expect_same_rows(db, "SELECT * FROM t WHERE v = 20", "SELECT * FROM mirror WHERE v = 20");
+
+    check_other_types(db);
+
+    /* A committed one matches the same changes made directly */
+    printf("Checking commit...\n");
+    assert(rdb_begin_transaction(db, RDB_ISOLATION_READ_COMMITTED) == 0);
+    make_changes(db, true);
+    assert(rdb_commit_transaction(db) == 0);
+
+    test_expect_same(db, "SELECT * FROM t", "SELECT * FROM mirror");
+    check_row_map(db, "t");
+    check_row_map(db, "mirror");
+    test_expect_same_rows(db, "SELECT * FROM t WHERE v = 2000", "SELECT * FROM mirror WHERE v = 2000");
+    test_expect_same_rows(db, "SELECT * FROM t WHERE v = 20", "SELECT * FROM mirror WHERE v = 20");
+
+    /* Compaction drops the tombstones and nothing else */
+    printf("Checking compaction...\n");
+    assert(rdb_get_table(db, "t")->dead_rows > 0);
+    assert(rdb_vacuum(db, "t") >= 0);
+    assert(rdb_get_table(db, "t")->dead_rows == 0);
+    check_row_map(db, "t");
+    test_expect_same(db, "SELECT * FROM t", "SELECT * FROM mirror");
+    test_expect_same_rows(db, "SELECT * FROM t WHERE v = 2000", "SELECT * FROM mirror WHERE v = 2000");
+
+    rdb_destroy_database(db);
+
+    printf("\nRollback test PASSED!\n");
+    return 0;
+}
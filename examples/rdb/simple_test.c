@@ -60,6 +60,7 @@ int main() {
     strcpy(id_col->foreign_table, "");
     strcpy(id_col->foreign_column, "");
     id_col->is_foreign_key = false;
+    id_col->dictionary = false;
     fi_array_push(columns, &id_col);
     
     /* Create name column */
@@ -74,6 +75,7 @@ int main() {
     strcpy(name_col->foreign_table, "");
     strcpy(name_col->foreign_column, "");
     name_col->is_foreign_key = false;
+    name_col->dictionary = false;
     fi_array_push(columns, &name_col);
     
     /* Create table */
@@ -126,7 +128,7 @@ int main() {
             printf("Table '%s' found with %zu columns and %zu rows\n", 
                    table_name, 
                    fi_array_count(table->columns),
-                   table->rows ? fi_array_count(table->rows) : 0);
+                   rdb_table_live_row_count(table));
         }
     }
     
@@ -7,11 +7,13 @@
 static rdb_statement_t* sql_parse_create_statement(sql_parser_t *parser);
 static rdb_statement_t* sql_parse_drop_statement(sql_parser_t *parser);
 static rdb_statement_t* sql_parse_create_index_simple(sql_parser_t *parser, rdb_statement_t *stmt);
+static rdb_statement_t* sql_statement_create(rdb_stmt_type_t type);
 static int sql_parse_string_literal(sql_parser_t *parser, char quote_char);
 static int sql_parse_number(sql_parser_t *parser);
 static int sql_parse_identifier(sql_parser_t *parser);
 static int sql_parse_operator(sql_parser_t *parser);
 static bool sql_is_operator_char(char c);
+static sql_keyword_t sql_keyword_lookup(const char *word, size_t length);
 
 /* Parser creation and destruction */
 sql_parser_t* sql_parser_create(const char *sql) {
@@ -20,20 +22,27 @@ sql_parser_t* sql_parser_create(const char *sql) {
     sql_parser_t *parser = malloc(sizeof(sql_parser_t));
     if (!parser) return NULL;
     
-    parser->sql = malloc(strlen(sql) + 1);
+    /* One allocation holds the statement and the token buffer behind it */
+    size_t length = strlen(sql);
+    parser->sql = malloc(2 * (length + 1));
     if (!parser->sql) {
         free(parser);
         return NULL;
     }
     
-    strcpy(parser->sql, sql);
+    memcpy(parser->sql, sql, length + 1);
+    parser->text = parser->sql + length + 1;
+    memcpy(parser->text, sql, length + 1);
+    parser->terminator = length;
     parser->pos = 0;
-    parser->length = strlen(sql);
+    parser->length = length;
     parser->has_error = false;
     parser->error_message[0] = '\0';
+    parser->parameters = NULL;
     
     /* Initialize current token */
     parser->current_token.type = SQL_TOKEN_UNKNOWN;
+    parser->current_token.keyword = 0;
     parser->current_token.value = NULL;
     parser->current_token.length = 0;
     parser->current_token.position = 0;
@@ -44,14 +53,11 @@ sql_parser_t* sql_parser_create(const char *sql) {
 void sql_parser_destroy(sql_parser_t *parser) {
     if (!parser) return;
     
+    /* text shares the allocation of sql */
     if (parser->sql) {
         free(parser->sql);
     }
     
-    if (parser->current_token.value) {
-        free(parser->current_token.value);
-    }
-    
     free(parser);
 }
 
@@ -72,20 +78,40 @@ char sql_parser_next_char(sql_parser_t *parser) {
     return parser->sql[parser->pos++];
 }
 
+/* Make sql[start, start + length) the current token.
+ *
+ * The token buffer is a copy of the statement, so the token's bytes are
+ * already in place: only the byte after the previous token is restored
+ * and the byte after this one becomes its terminator. */
+static void sql_token_set(sql_parser_t *parser, sql_token_type_t type, size_t start, size_t length) {
+    parser->text[start + length] = '\0';
+    parser->terminator = start + length;
+    
+    parser->current_token.type = type;
+    parser->current_token.value = parser->text + start;
+    parser->current_token.length = length;
+}
+
 int sql_parser_next_token(sql_parser_t *parser) {
     if (!parser) return -1;
     
-    /* Free previous token value */
-    if (parser->current_token.value) {
-        free(parser->current_token.value);
-        parser->current_token.value = NULL;
-    }
+    /* After an operand a '-' is a subtraction, not the sign of a number */
+    sql_token_t *previous = &parser->current_token;
+    bool after_operand = previous->type == SQL_TOKEN_IDENTIFIER ||
+                         previous->type == SQL_TOKEN_NUMBER ||
+                         previous->type == SQL_TOKEN_STRING ||
+                         (previous->type == SQL_TOKEN_PUNCTUATION && previous->value &&
+                          (previous->value[0] == ')' || previous->value[0] == '?'));
+    
+    /* Drop the previous token */
+    parser->text[parser->terminator] = parser->sql[parser->terminator];
+    parser->current_token.keyword = 0;
+    parser->current_token.value = NULL;
     
     sql_parser_skip_whitespace(parser);
     
     if (parser->pos >= parser->length) {
         parser->current_token.type = SQL_TOKEN_EOF;
-        parser->current_token.value = NULL;
         parser->current_token.length = 0;
         parser->current_token.position = parser->pos;
         return 0;
@@ -100,7 +126,8 @@ int sql_parser_next_token(sql_parser_t *parser) {
     }
     
     /* Handle numbers */
-    if (isdigit(c) || c == '-') {
+    char next = parser->pos + 1 < parser->length ? parser->sql[parser->pos + 1] : '\0';
+    if (isdigit(c) || (c == '-' && !after_operand && (isdigit(next) || next == '.'))) {
         return sql_parse_number(parser);
     }
     
@@ -116,25 +143,13 @@ int sql_parser_next_token(sql_parser_t *parser) {
     
     /* Handle punctuation */
     if (sql_is_punctuation(c)) {
-        parser->current_token.type = SQL_TOKEN_PUNCTUATION;
-        parser->current_token.value = malloc(2);
-        if (!parser->current_token.value) return -1;
-        
-        parser->current_token.value[0] = c;
-        parser->current_token.value[1] = '\0';
-        parser->current_token.length = 1;
+        sql_token_set(parser, SQL_TOKEN_PUNCTUATION, parser->pos, 1);
         parser->pos++;
         return 0;
     }
     
     /* Unknown character */
-    parser->current_token.type = SQL_TOKEN_UNKNOWN;
-    parser->current_token.value = malloc(2);
-    if (!parser->current_token.value) return -1;
-    
-    parser->current_token.value[0] = c;
-    parser->current_token.value[1] = '\0';
-    parser->current_token.length = 1;
+    sql_token_set(parser, SQL_TOKEN_UNKNOWN, parser->pos, 1);
     parser->pos++;
     
     sql_parser_set_error(parser, "Unknown character: '%c'", c);
@@ -142,33 +157,25 @@ int sql_parser_next_token(sql_parser_t *parser) {
 }
 
 int sql_parse_string_literal(sql_parser_t *parser, char quote_char) {
-    parser->current_token.type = SQL_TOKEN_STRING;
     parser->pos++; /* Skip opening quote */
     
     size_t start = parser->pos;
-    while (parser->pos < parser->length && parser->sql[parser->pos] != quote_char) {
-        parser->pos++;
-    }
-    
-    if (parser->pos >= parser->length) {
+    const char *close = memchr(parser->sql + start, quote_char, parser->length - start);
+    if (!close) {
+        parser->current_token.type = SQL_TOKEN_STRING;
+        parser->pos = parser->length;
         sql_parser_set_error(parser, "Unterminated string literal");
         return -1;
     }
     
-    size_t length = parser->pos - start;
-    parser->current_token.value = malloc(length + 1);
-    if (!parser->current_token.value) return -1;
-    
-    strncpy(parser->current_token.value, parser->sql + start, length);
-    parser->current_token.value[length] = '\0';
-    parser->current_token.length = length;
+    parser->pos = close - parser->sql;
+    sql_token_set(parser, SQL_TOKEN_STRING, start, parser->pos - start);
     
     parser->pos++; /* Skip closing quote */
     return 0;
 }
 
 int sql_parse_number(sql_parser_t *parser) {
-    parser->current_token.type = SQL_TOKEN_NUMBER;
     size_t start = parser->pos;
     
     /* Handle negative numbers */
@@ -189,14 +196,7 @@ int sql_parse_number(sql_parser_t *parser) {
         }
     }
     
-    size_t length = parser->pos - start;
-    parser->current_token.value = malloc(length + 1);
-    if (!parser->current_token.value) return -1;
-    
-    strncpy(parser->current_token.value, parser->sql + start, length);
-    parser->current_token.value[length] = '\0';
-    parser->current_token.length = length;
-    
+    sql_token_set(parser, SQL_TOKEN_NUMBER, start, parser->pos - start);
     return 0;
 }
 
@@ -207,26 +207,16 @@ int sql_parse_identifier(sql_parser_t *parser) {
         parser->pos++;
     }
     
-    size_t length = parser->pos - start;
-    parser->current_token.value = malloc(length + 1);
-    if (!parser->current_token.value) return -1;
-    
-    strncpy(parser->current_token.value, parser->sql + start, length);
-    parser->current_token.value[length] = '\0';
-    parser->current_token.length = length;
-    
     /* Check if it's a keyword */
-    if (sql_is_keyword(parser->current_token.value)) {
-        parser->current_token.type = SQL_TOKEN_KEYWORD;
-    } else {
-        parser->current_token.type = SQL_TOKEN_IDENTIFIER;
-    }
+    size_t length = parser->pos - start;
+    sql_keyword_t keyword = sql_keyword_lookup(parser->sql + start, length);
+    sql_token_set(parser, keyword ? SQL_TOKEN_KEYWORD : SQL_TOKEN_IDENTIFIER, start, length);
+    parser->current_token.keyword = keyword;
     
     return 0;
 }
 
 int sql_parse_operator(sql_parser_t *parser) {
-    parser->current_token.type = SQL_TOKEN_OPERATOR;
     size_t start = parser->pos;
     
     char c1 = parser->sql[parser->pos];
@@ -235,6 +225,7 @@ int sql_parse_operator(sql_parser_t *parser) {
     /* Check for two-character operators */
     if ((c1 == '=' && c2 == '=') ||
         (c1 == '!' && c2 == '=') ||
+        (c1 == '<' && c2 == '>') ||
         (c1 == '<' && c2 == '=') ||
         (c1 == '>' && c2 == '=')) {
         parser->pos += 2;
@@ -242,43 +233,180 @@ int sql_parse_operator(sql_parser_t *parser) {
         parser->pos++;
     }
     
-    size_t length = parser->pos - start;
-    parser->current_token.value = malloc(length + 1);
-    if (!parser->current_token.value) return -1;
-    
-    strncpy(parser->current_token.value, parser->sql + start, length);
-    parser->current_token.value[length] = '\0';
-    parser->current_token.length = length;
-    
+    sql_token_set(parser, SQL_TOKEN_OPERATOR, start, parser->pos - start);
+    return 0;
+}
+
+/* Keyword recognition
+ *
+ * Words are classified once, in the lexer, by switching on their length
+ * and first letter; no bucket holds more than two keywords. Each keyword
+ * needs its case here in addition to its sql_keyword_t entry. */
+static bool sql_word_is(const char *word, const char *keyword) {
+    for (; *keyword; word++, keyword++) {
+        if (toupper((unsigned char)*word) != *keyword) return false;
+    }
+    return true;
+}
+
+static sql_keyword_t sql_keyword_lookup(const char *word, size_t length) {
+    switch (length) {
+        case 2:
+            switch (toupper((unsigned char)word[0])) {
+                case 'A': return sql_word_is(word, "AS") ? SQL_KW_AS : 0;
+                case 'B': return sql_word_is(word, "BY") ? SQL_KW_BY : 0;
+                case 'I':
+                    if (sql_word_is(word, "IS")) return SQL_KW_IS;
+                    if (sql_word_is(word, "IN")) return SQL_KW_IN;
+                    return 0;
+                case 'O':
+                    if (sql_word_is(word, "OR")) return SQL_KW_OR;
+                    if (sql_word_is(word, "ON")) return SQL_KW_ON;
+                    return 0;
+            }
+            return 0;
+        case 3:
+            switch (toupper((unsigned char)word[0])) {
+                case 'A':
+                    if (sql_word_is(word, "AND")) return SQL_KW_AND;
+                    if (sql_word_is(word, "ASC")) return SQL_KW_ASC;
+                    return 0;
+                case 'I': return sql_word_is(word, "INT") ? SQL_KW_INT : 0;
+                case 'K': return sql_word_is(word, "KEY") ? SQL_KW_KEY : 0;
+                case 'N': return sql_word_is(word, "NOT") ? SQL_KW_NOT : 0;
+                case 'S': return sql_word_is(word, "SET") ? SQL_KW_SET : 0;
+            }
+            return 0;
+        case 4:
+            switch (toupper((unsigned char)word[0])) {
+                case 'D':
+                    if (sql_word_is(word, "DROP")) return SQL_KW_DROP;
+                    if (sql_word_is(word, "DESC")) return SQL_KW_DESC;
+                    return 0;
+                case 'F':
+                    if (sql_word_is(word, "FROM")) return SQL_KW_FROM;
+                    if (sql_word_is(word, "FULL")) return SQL_KW_FULL;
+                    return 0;
+                case 'I': return sql_word_is(word, "INTO") ? SQL_KW_INTO : 0;
+                case 'J': return sql_word_is(word, "JOIN") ? SQL_KW_JOIN : 0;
+                case 'L':
+                    if (sql_word_is(word, "LEFT")) return SQL_KW_LEFT;
+                    if (sql_word_is(word, "LIKE")) return SQL_KW_LIKE;
+                    return 0;
+                case 'N': return sql_word_is(word, "NULL") ? SQL_KW_NULL : 0;
+                case 'R': return sql_word_is(word, "READ") ? SQL_KW_READ : 0;
+                case 'T':
+                    if (sql_word_is(word, "TEXT")) return SQL_KW_TEXT;
+                    if (sql_word_is(word, "TRUE")) return SQL_KW_TRUE;
+                    return 0;
+            }
+            return 0;
+        case 5:
+            switch (toupper((unsigned char)word[0])) {
+                case 'B': return sql_word_is(word, "BEGIN") ? SQL_KW_BEGIN : 0;
+                case 'F':
+                    if (sql_word_is(word, "FLOAT")) return SQL_KW_FLOAT;
+                    if (sql_word_is(word, "FALSE")) return SQL_KW_FALSE;
+                    return 0;
+                case 'G': return sql_word_is(word, "GROUP") ? SQL_KW_GROUP : 0;
+                case 'I':
+                    if (sql_word_is(word, "INDEX")) return SQL_KW_INDEX;
+                    if (sql_word_is(word, "INNER")) return SQL_KW_INNER;
+                    return 0;
+                case 'L':
+                    if (sql_word_is(word, "LIMIT")) return SQL_KW_LIMIT;
+                    if (sql_word_is(word, "LEVEL")) return SQL_KW_LEVEL;
+                    return 0;
+                case 'O': return sql_word_is(word, "ORDER") ? SQL_KW_ORDER : 0;
+                case 'R': return sql_word_is(word, "RIGHT") ? SQL_KW_RIGHT : 0;
+                case 'T': return sql_word_is(word, "TABLE") ? SQL_KW_TABLE : 0;
+                case 'U': return sql_word_is(word, "USING") ? SQL_KW_USING : 0;
+                case 'W': return sql_word_is(word, "WHERE") ? SQL_KW_WHERE : 0;
+            }
+            return 0;
+        case 6:
+            switch (toupper((unsigned char)word[0])) {
+                case 'C':
+                    if (sql_word_is(word, "CREATE")) return SQL_KW_CREATE;
+                    if (sql_word_is(word, "COMMIT")) return SQL_KW_COMMIT;
+                    return 0;
+                case 'D': return sql_word_is(word, "DELETE") ? SQL_KW_DELETE : 0;
+                case 'I': return sql_word_is(word, "INSERT") ? SQL_KW_INSERT : 0;
+                case 'O': return sql_word_is(word, "OFFSET") ? SQL_KW_OFFSET : 0;
+                case 'S': return sql_word_is(word, "SELECT") ? SQL_KW_SELECT : 0;
+                case 'U':
+                    if (sql_word_is(word, "UPDATE")) return SQL_KW_UPDATE;
+                    if (sql_word_is(word, "UNIQUE")) return SQL_KW_UNIQUE;
+                    return 0;
+                case 'V':
+                    if (sql_word_is(word, "VALUES")) return SQL_KW_VALUES;
+                    if (sql_word_is(word, "VACUUM")) return SQL_KW_VACUUM;
+                    return 0;
+            }
+            return 0;
+        case 7:
+            switch (toupper((unsigned char)word[0])) {
+                case 'A': return sql_word_is(word, "ANALYZE") ? SQL_KW_ANALYZE : 0;
+                case 'B': return sql_word_is(word, "BOOLEAN") ? SQL_KW_BOOLEAN : 0;
+                case 'C': return sql_word_is(word, "CASCADE") ? SQL_KW_CASCADE : 0;
+                case 'D': return sql_word_is(word, "DEFAULT") ? SQL_KW_DEFAULT : 0;
+                case 'E': return sql_word_is(word, "EXECUTE") ? SQL_KW_EXECUTE : 0;
+                case 'F': return sql_word_is(word, "FOREIGN") ? SQL_KW_FOREIGN : 0;
+                case 'P':
+                    if (sql_word_is(word, "PRIMARY")) return SQL_KW_PRIMARY;
+                    if (sql_word_is(word, "PREPARE")) return SQL_KW_PREPARE;
+                    return 0;
+                case 'V': return sql_word_is(word, "VARCHAR") ? SQL_KW_VARCHAR : 0;
+            }
+            return 0;
+        case 8:
+            switch (toupper((unsigned char)word[0])) {
+                case 'R': return sql_word_is(word, "ROLLBACK") ? SQL_KW_ROLLBACK : 0;
+            }
+            return 0;
+        case 9:
+            switch (toupper((unsigned char)word[0])) {
+                case 'C': return sql_word_is(word, "COMMITTED") ? SQL_KW_COMMITTED : 0;
+                case 'I': return sql_word_is(word, "ISOLATION") ? SQL_KW_ISOLATION : 0;
+            }
+            return 0;
+        case 10:
+            switch (toupper((unsigned char)word[0])) {
+                case 'A': return sql_word_is(word, "AUTOCOMMIT") ? SQL_KW_AUTOCOMMIT : 0;
+                case 'C': return sql_word_is(word, "CONSTRAINT") ? SQL_KW_CONSTRAINT : 0;
+                case 'D':
+                    if (sql_word_is(word, "DICTIONARY")) return SQL_KW_DICTIONARY;
+                    if (sql_word_is(word, "DEALLOCATE")) return SQL_KW_DEALLOCATE;
+                    return 0;
+                case 'R':
+                    if (sql_word_is(word, "REFERENCES")) return SQL_KW_REFERENCES;
+                    if (sql_word_is(word, "REPEATABLE")) return SQL_KW_REPEATABLE;
+                    return 0;
+            }
+            return 0;
+        case 11:
+            switch (toupper((unsigned char)word[0])) {
+                case 'T': return sql_word_is(word, "TRANSACTION") ? SQL_KW_TRANSACTION : 0;
+                case 'U': return sql_word_is(word, "UNCOMMITTED") ? SQL_KW_UNCOMMITTED : 0;
+            }
+            return 0;
+        case 12:
+            switch (toupper((unsigned char)word[0])) {
+                case 'S': return sql_word_is(word, "SERIALIZABLE") ? SQL_KW_SERIALIZABLE : 0;
+            }
+            return 0;
+    }
     return 0;
 }
 
 /* Helper functions */
 bool sql_is_keyword(const char *word) {
-    const char *keywords[] = {
-        "SELECT", "FROM", "WHERE", "INSERT", "INTO", "VALUES",
-        "UPDATE", "SET", "DELETE", "CREATE", "TABLE", "INDEX",
-        "DROP", "INT", "FLOAT", "VARCHAR", "TEXT", "BOOLEAN",
-        "PRIMARY", "KEY", "UNIQUE", "NOT", "NULL", "DEFAULT",
-        "AND", "OR", "ORDER", "BY", "LIMIT", "OFFSET", "JOIN",
-        "INNER", "LEFT", "RIGHT", "FULL", "ON", "FOREIGN",
-        "REFERENCES", "CASCADE", "CONSTRAINT", "BEGIN", "COMMIT",
-        "ROLLBACK", "TRANSACTION", "AUTOCOMMIT", "ISOLATION", "LEVEL",
-        "READ", "UNCOMMITTED", "COMMITTED", "REPEATABLE", "SERIALIZABLE",
-        "TRUE", "FALSE", "LIKE", "IS", "IN"
-    };
-    
-    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
-        if (strcasecmp(word, keywords[i]) == 0) {
-            return true;
-        }
-    }
-    return false;
+    return sql_keyword_lookup(word, strlen(word)) != 0;
 }
 
 bool sql_is_operator(const char *op) {
     const char *operators[] = {
-        "=", "!=", "<", ">", "<=", ">=", "LIKE", "IS", "IN"
+        "=", "!=", "<>", "<", ">", "<=", ">=", "+", "-", "/", "%", "LIKE", "IS", "IN"
     };
     
     for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); i++) {
@@ -290,7 +418,7 @@ bool sql_is_operator(const char *op) {
 }
 
 bool sql_is_punctuation(char c) {
-    return c == ',' || c == ';' || c == '(' || c == ')' || c == '.' || c == '*';
+    return c == ',' || c == ';' || c == '(' || c == ')' || c == '.' || c == '*' || c == '?';
 }
 
 bool sql_is_whitespace(char c) {
@@ -302,34 +430,17 @@ bool sql_is_identifier_char(char c) {
 }
 
 bool sql_is_operator_char(char c) {
-    return c == '=' || c == '!' || c == '<' || c == '>' || c == '~';
+    return c == '=' || c == '!' || c == '<' || c == '>' || c == '~' ||
+           c == '+' || c == '-' || c == '/' || c == '%';
 }
 
 sql_keyword_t sql_get_keyword(const char *keyword) {
-    const char *keywords[] = {
-        "SELECT", "FROM", "WHERE", "INSERT", "INTO", "VALUES",
-        "UPDATE", "SET", "DELETE", "CREATE", "TABLE", "INDEX",
-        "DROP", "INT", "FLOAT", "VARCHAR", "TEXT", "BOOLEAN",
-        "PRIMARY", "KEY", "UNIQUE", "NOT", "NULL", "DEFAULT",
-        "AND", "OR", "ORDER", "BY", "LIMIT", "OFFSET", "JOIN",
-        "INNER", "LEFT", "RIGHT", "FULL", "ON", "FOREIGN",
-        "REFERENCES", "CASCADE", "CONSTRAINT", "BEGIN", "COMMIT",
-        "ROLLBACK", "TRANSACTION", "AUTOCOMMIT", "ISOLATION", "LEVEL",
-        "READ", "UNCOMMITTED", "COMMITTED", "REPEATABLE", "SERIALIZABLE",
-        "TRUE", "FALSE", "LIKE", "IS", "IN"
-    };
-    
-    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
-        if (strcasecmp(keyword, keywords[i]) == 0) {
-            return i + 1;
-        }
-    }
-    return 0;
+    return sql_keyword_lookup(keyword, strlen(keyword));
 }
 
 sql_operator_t sql_get_operator(const char *op) {
     if (strcmp(op, "=") == 0) return SQL_OP_EQUAL;
-    if (strcmp(op, "!=") == 0) return SQL_OP_NOT_EQUAL;
+    if (strcmp(op, "!=") == 0 || strcmp(op, "<>") == 0) return SQL_OP_NOT_EQUAL;
     if (strcmp(op, "<") == 0) return SQL_OP_LESS_THAN;
     if (strcmp(op, ">") == 0) return SQL_OP_GREATER_THAN;
     if (strcmp(op, "<=") == 0) return SQL_OP_LESS_EQUAL;
@@ -353,7 +464,7 @@ rdb_statement_t* sql_parse_statement(sql_parser_t *parser) {
         return NULL;
     }
     
-    sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
+    sql_keyword_t keyword = parser->current_token.keyword;
     
     switch (keyword) {
         case SQL_KW_CREATE:
@@ -374,6 +485,16 @@ rdb_statement_t* sql_parse_statement(sql_parser_t *parser) {
             return sql_parse_commit_transaction(parser);
         case SQL_KW_ROLLBACK:
             return sql_parse_rollback_transaction(parser);
+        case SQL_KW_VACUUM:
+            return sql_parse_vacuum(parser);
+        case SQL_KW_ANALYZE:
+            return sql_parse_analyze(parser);
+        case SQL_KW_PREPARE:
+            return sql_parse_prepare(parser);
+        case SQL_KW_EXECUTE:
+            return sql_parse_execute(parser);
+        case SQL_KW_DEALLOCATE:
+            return sql_parse_deallocate(parser);
         default:
             sql_parser_set_error(parser, "Unsupported SQL statement type");
             return NULL;
@@ -382,7 +503,7 @@ rdb_statement_t* sql_parse_statement(sql_parser_t *parser) {
 
 
 rdb_statement_t* sql_parse_create_statement(sql_parser_t *parser) {
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = sql_statement_create(RDB_STMT_CREATE_TABLE);
     if (!stmt) return NULL;
     
     /* Parse CREATE TABLE or CREATE INDEX */
@@ -397,7 +518,7 @@ rdb_statement_t* sql_parse_create_statement(sql_parser_t *parser) {
         return NULL;
     }
     
-    sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
+    sql_keyword_t keyword = parser->current_token.keyword;
     if (keyword == SQL_KW_TABLE) {
         stmt->type = RDB_STMT_CREATE_TABLE;
         return sql_parse_create_table(parser, stmt);
@@ -426,6 +547,7 @@ rdb_statement_t* sql_parse_create_table(sql_parser_t *parser, rdb_statement_t *s
     
     strncpy(stmt->table_name, parser->current_token.value, sizeof(stmt->table_name) - 1);
     stmt->table_name[sizeof(stmt->table_name) - 1] = '\0';
+    stmt->storage_mode = RDB_STORAGE_ROW;
     
     /* Parse opening parenthesis */
     if (sql_parser_next_token(parser) != 0) {
@@ -493,12 +615,38 @@ rdb_statement_t* sql_parse_create_table(sql_parser_t *parser, rdb_statement_t *s
         }
     }
     
+    /* Optional USING ROW | COLUMNAR after the column list */
+    if (parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
+        parser->current_token.value[0] == ')' &&
+        sql_parser_next_token(parser) == 0 &&
+        parser->current_token.type == SQL_TOKEN_KEYWORD &&
+        parser->current_token.keyword == SQL_KW_USING) {
+        if (sql_parser_next_token(parser) != 0) {
+            fi_array_destroy(stmt->columns);
+            free(stmt);
+            return NULL;
+        }
+        
+        if (parser->current_token.type == SQL_TOKEN_IDENTIFIER &&
+            strcasecmp(parser->current_token.value, "COLUMNAR") == 0) {
+            stmt->storage_mode = RDB_STORAGE_COLUMNAR;
+        } else if (parser->current_token.type == SQL_TOKEN_IDENTIFIER &&
+                   strcasecmp(parser->current_token.value, "ROW") == 0) {
+            stmt->storage_mode = RDB_STORAGE_ROW;
+        } else {
+            sql_parser_set_error(parser, "Expected ROW or COLUMNAR after USING");
+            fi_array_destroy(stmt->columns);
+            free(stmt);
+            return NULL;
+        }
+    }
+    
     return stmt;
 }
 
 /* DROP statement parsing */
 static rdb_statement_t* sql_parse_drop_statement(sql_parser_t *parser) {
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
     /* Parse DROP TABLE or DROP INDEX */
@@ -513,7 +661,7 @@ static rdb_statement_t* sql_parse_drop_statement(sql_parser_t *parser) {
         return NULL;
     }
     
-    sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
+    sql_keyword_t keyword = parser->current_token.keyword;
     if (keyword == SQL_KW_TABLE) {
         stmt->type = RDB_STMT_DROP_TABLE;
         return sql_parse_drop_table(parser, stmt);
@@ -550,13 +698,20 @@ rdb_statement_t* sql_parse_drop_table(sql_parser_t *parser, rdb_statement_t *stm
     stmt->select_columns = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     return stmt;
 }
@@ -584,7 +739,7 @@ rdb_statement_t* sql_parse_drop_index(sql_parser_t *parser, rdb_statement_t *stm
     }
     
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_FROM) {
+        parser->current_token.keyword != SQL_KW_FROM) {
         sql_parser_set_error(parser, "Expected FROM after index name");
         free(stmt);
         return NULL;
@@ -610,19 +765,26 @@ rdb_statement_t* sql_parse_drop_index(sql_parser_t *parser, rdb_statement_t *stm
     stmt->where_conditions = NULL;
     stmt->select_columns = NULL;
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     return stmt;
 }
 
 rdb_statement_t* sql_parse_insert(sql_parser_t *parser) {
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
     stmt->type = RDB_STMT_INSERT;
@@ -634,7 +796,7 @@ rdb_statement_t* sql_parse_insert(sql_parser_t *parser) {
     }
     
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_INTO) {
+        parser->current_token.keyword != SQL_KW_INTO) {
         sql_parser_set_error(parser, "Expected INTO after INSERT");
         free(stmt);
         return NULL;
@@ -680,7 +842,7 @@ rdb_statement_t* sql_parse_insert(sql_parser_t *parser) {
     
     /* Parse VALUES keyword */
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_VALUES) {
+        parser->current_token.keyword != SQL_KW_VALUES) {
         sql_parser_set_error(parser, "Expected VALUES");
         if (stmt->columns) fi_array_destroy(stmt->columns);
         free(stmt);
@@ -707,22 +869,46 @@ rdb_statement_t* sql_parse_insert(sql_parser_t *parser) {
     stmt->select_columns = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     return stmt;
 }
 
+/* Free a GROUP BY column list */
+static void sql_group_by_free(fi_array *group_by) {
+    if (!group_by) return;
+    for (size_t i = 0; i < fi_array_count(group_by); i++) {
+        free(*(char**)fi_array_get(group_by, i));
+    }
+    fi_array_destroy(group_by);
+}
+
 rdb_statement_t* sql_parse_select(sql_parser_t *parser) {
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
+    int aggregate_count = 0;
     stmt->type = RDB_STMT_SELECT;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
+    stmt->order_by = NULL;
+    stmt->limit_value = RDB_NO_LIMIT;
+    stmt->offset_value = 0;
     
     /* Parse column list */
     stmt->select_columns = fi_array_create(16, sizeof(char*));
@@ -748,26 +934,31 @@ rdb_statement_t* sql_parse_select(sql_parser_t *parser) {
         }
         strcpy(star, "*");
         fi_array_push(stmt->select_columns, &star);
+        
+        if (sql_parser_next_token(parser) != 0) {
+            fi_array_destroy(stmt->select_columns);
+            free(stmt);
+            return NULL;
+        }
     } else {
-        /* Parse column list */
-        if (sql_parse_column_list(parser, stmt->select_columns) != 0) {
+        /* Parse column list, which may hold aggregates */
+        stmt->aggregates = fi_array_create(16, sizeof(rdb_aggregate_t));
+        aggregate_count = stmt->aggregates ?
+            sql_parse_select_list(parser, stmt->select_columns, stmt->aggregates) : -1;
+        if (aggregate_count < 0) {
             fi_array_destroy(stmt->select_columns);
+            if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
             free(stmt);
             return NULL;
         }
     }
     
-    /* Parse FROM clause */
-    if (sql_parser_next_token(parser) != 0) {
-        fi_array_destroy(stmt->select_columns);
-        free(stmt);
-        return NULL;
-    }
-    
+    /* Parse FROM clause (the select list already read the next token) */
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_FROM) {
+        parser->current_token.keyword != SQL_KW_FROM) {
         sql_parser_set_error(parser, "Expected FROM clause");
         fi_array_destroy(stmt->select_columns);
+        if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
         free(stmt);
         return NULL;
     }
@@ -776,25 +967,27 @@ rdb_statement_t* sql_parse_select(sql_parser_t *parser) {
     stmt->from_tables = fi_array_create(16, sizeof(char*));
     if (!stmt->from_tables) {
         fi_array_destroy(stmt->select_columns);
+        if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
         free(stmt);
         return NULL;
     }
     
     if (sql_parse_from_clause(parser, stmt->from_tables) != 0) {
         fi_array_destroy(stmt->select_columns);
+        if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
         fi_array_destroy(stmt->from_tables);
         free(stmt);
         return NULL;
     }
     
-    /* Parse optional WHERE clause */
-    if (sql_parser_next_token(parser) == 0 &&
-        parser->current_token.type == SQL_TOKEN_KEYWORD &&
-        sql_get_keyword(parser->current_token.value) == SQL_KW_WHERE) {
+    /* Parse optional WHERE clause (the previous clause already read the next token) */
+    if (parser->current_token.type == SQL_TOKEN_KEYWORD &&
+        parser->current_token.keyword == SQL_KW_WHERE) {
         
         stmt->where_conditions = fi_array_create(16, sizeof(sql_where_condition_t*));
         if (!stmt->where_conditions) {
             fi_array_destroy(stmt->select_columns);
+            if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
             fi_array_destroy(stmt->from_tables);
             free(stmt);
             return NULL;
@@ -802,6 +995,7 @@ rdb_statement_t* sql_parse_select(sql_parser_t *parser) {
         
         if (sql_parse_where_clause(parser, stmt->where_conditions) != 0) {
             fi_array_destroy(stmt->select_columns);
+            if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
             fi_array_destroy(stmt->from_tables);
             fi_array_destroy(stmt->where_conditions);
             free(stmt);
@@ -811,10 +1005,55 @@ rdb_statement_t* sql_parse_select(sql_parser_t *parser) {
         stmt->where_conditions = NULL;
     }
     
+    /* Parse optional GROUP BY clause */
+    if (parser->current_token.type == SQL_TOKEN_KEYWORD &&
+        parser->current_token.keyword == SQL_KW_GROUP) {
+        
+        stmt->group_by = fi_array_create(4, sizeof(char*));
+        if (!stmt->group_by || sql_parse_group_by_clause(parser, stmt->group_by) != 0 ||
+            !stmt->aggregates) {
+            if (stmt->group_by && !stmt->aggregates) {
+                sql_parser_set_error(parser, "SELECT * cannot be used with GROUP BY");
+            }
+            fi_array_destroy(stmt->select_columns);
+            if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
+            sql_group_by_free(stmt->group_by);
+            fi_array_destroy(stmt->from_tables);
+            if (stmt->where_conditions) fi_array_destroy(stmt->where_conditions);
+            free(stmt);
+            return NULL;
+        }
+    }
+    
+    /* A plain column list does not aggregate */
+    if (aggregate_count == 0 && !stmt->group_by && stmt->aggregates) {
+        fi_array_destroy(stmt->aggregates);
+        stmt->aggregates = NULL;
+    }
+    
+    /* Parse optional ORDER BY and LIMIT/OFFSET clauses */
+    bool has_order = parser->current_token.type == SQL_TOKEN_KEYWORD &&
+                     parser->current_token.keyword == SQL_KW_ORDER;
+    if (has_order) stmt->order_by = fi_array_create(4, sizeof(rdb_order_by_t));
+    if ((has_order && (!stmt->order_by || sql_parse_order_by_clause(parser, stmt->order_by) != 0)) ||
+        sql_parse_limit_clause(parser, &stmt->limit_value, &stmt->offset_value) != 0) {
+        fi_array_destroy(stmt->select_columns);
+        if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
+        sql_group_by_free(stmt->group_by);
+        if (stmt->order_by) fi_array_destroy(stmt->order_by);
+        fi_array_destroy(stmt->from_tables);
+        if (stmt->where_conditions) fi_array_destroy(stmt->where_conditions);
+        free(stmt);
+        return NULL;
+    }
+    
     /* Parse optional JOIN clauses */
     stmt->join_conditions = fi_array_create(16, sizeof(rdb_join_condition_t*));
     if (!stmt->join_conditions) {
         fi_array_destroy(stmt->select_columns);
+        if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
+        sql_group_by_free(stmt->group_by);
+        if (stmt->order_by) fi_array_destroy(stmt->order_by);
         fi_array_destroy(stmt->from_tables);
         if (stmt->where_conditions) fi_array_destroy(stmt->where_conditions);
         free(stmt);
@@ -825,13 +1064,16 @@ rdb_statement_t* sql_parse_select(sql_parser_t *parser) {
     while (sql_parser_next_token(parser) == 0 &&
            parser->current_token.type == SQL_TOKEN_KEYWORD) {
         
-        sql_keyword_t join_keyword = sql_get_keyword(parser->current_token.value);
+        sql_keyword_t join_keyword = parser->current_token.keyword;
         if (join_keyword == SQL_KW_JOIN || join_keyword == SQL_KW_INNER ||
             join_keyword == SQL_KW_LEFT || join_keyword == SQL_KW_RIGHT ||
             join_keyword == SQL_KW_FULL) {
             
             if (sql_parse_join_clause(parser, stmt->join_conditions) != 0) {
                 fi_array_destroy(stmt->select_columns);
+                if (stmt->aggregates) fi_array_destroy(stmt->aggregates);
+                sql_group_by_free(stmt->group_by);
+                if (stmt->order_by) fi_array_destroy(stmt->order_by);
                 fi_array_destroy(stmt->from_tables);
                 if (stmt->where_conditions) fi_array_destroy(stmt->where_conditions);
                 fi_array_destroy(stmt->join_conditions);
@@ -849,20 +1091,34 @@ rdb_statement_t* sql_parse_select(sql_parser_t *parser) {
     stmt->values = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
-    stmt->order_by = NULL;
-    stmt->limit_value = 0;
-    stmt->offset_value = 0;
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
     
     return stmt;
 }
 
+/* Free a list of rdb_expr_t* (entries may be NULL) */
+static void sql_expression_list_free(fi_array *expressions) {
+    if (!expressions) return;
+    for (size_t i = 0; i < fi_array_count(expressions); i++) {
+        rdb_expr_free(*(rdb_expr_t**)fi_array_get(expressions, i));
+    }
+    fi_array_destroy(expressions);
+}
+
 rdb_statement_t* sql_parse_update(sql_parser_t *parser) {
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
     stmt->type = RDB_STMT_UPDATE;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     /* Parse table name */
     if (sql_parser_next_token(parser) != 0) {
@@ -886,7 +1142,7 @@ rdb_statement_t* sql_parse_update(sql_parser_t *parser) {
     }
     
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_SET) {
+        parser->current_token.keyword != SQL_KW_SET) {
         sql_parser_set_error(parser, "Expected SET after table name");
         free(stmt);
         return NULL;
@@ -895,30 +1151,39 @@ rdb_statement_t* sql_parse_update(sql_parser_t *parser) {
     /* Parse SET clause */
     stmt->columns = fi_array_create(16, sizeof(char*));
     stmt->values = fi_array_create(16, sizeof(rdb_value_t*));
+    fi_array *expressions = fi_array_create(16, sizeof(rdb_expr_t*));
     
-    if (!stmt->columns || !stmt->values) {
+    if (!stmt->columns || !stmt->values || !expressions) {
         if (stmt->columns) fi_array_destroy(stmt->columns);
         if (stmt->values) fi_array_destroy(stmt->values);
+        if (expressions) fi_array_destroy(expressions);
         free(stmt);
         return NULL;
     }
     
-    if (sql_parse_set_clause(parser, stmt->columns, stmt->values) != 0) {
+    if (sql_parse_set_clause(parser, stmt->columns, stmt->values, expressions) != 0) {
         fi_array_destroy(stmt->columns);
         fi_array_destroy(stmt->values);
+        sql_expression_list_free(expressions);
         free(stmt);
         return NULL;
     }
     
-    /* Parse optional WHERE clause */
-    if (sql_parser_next_token(parser) == 0 &&
-        parser->current_token.type == SQL_TOKEN_KEYWORD &&
-        sql_get_keyword(parser->current_token.value) == SQL_KW_WHERE) {
+    /* Keep the expressions only when some column is computed */
+    for (size_t i = 0; i < fi_array_count(expressions) && !stmt->set_expressions; i++) {
+        if (*(rdb_expr_t**)fi_array_get(expressions, i)) stmt->set_expressions = expressions;
+    }
+    if (!stmt->set_expressions) fi_array_destroy(expressions);
+    
+    /* Parse optional WHERE clause (the previous clause already read the next token) */
+    if (parser->current_token.type == SQL_TOKEN_KEYWORD &&
+        parser->current_token.keyword == SQL_KW_WHERE) {
         
         stmt->where_conditions = fi_array_create(16, sizeof(sql_where_condition_t*));
         if (!stmt->where_conditions) {
             fi_array_destroy(stmt->columns);
             fi_array_destroy(stmt->values);
+            sql_expression_list_free(stmt->set_expressions);
             free(stmt);
             return NULL;
         }
@@ -927,6 +1192,7 @@ rdb_statement_t* sql_parse_update(sql_parser_t *parser) {
             fi_array_destroy(stmt->columns);
             fi_array_destroy(stmt->values);
             fi_array_destroy(stmt->where_conditions);
+            sql_expression_list_free(stmt->set_expressions);
             free(stmt);
             return NULL;
         }
@@ -938,10 +1204,12 @@ rdb_statement_t* sql_parse_update(sql_parser_t *parser) {
     stmt->select_columns = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
@@ -950,7 +1218,7 @@ rdb_statement_t* sql_parse_update(sql_parser_t *parser) {
 }
 
 rdb_statement_t* sql_parse_delete(sql_parser_t *parser) {
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
     stmt->type = RDB_STMT_DELETE;
@@ -962,7 +1230,7 @@ rdb_statement_t* sql_parse_delete(sql_parser_t *parser) {
     }
     
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_FROM) {
+        parser->current_token.keyword != SQL_KW_FROM) {
         sql_parser_set_error(parser, "Expected FROM after DELETE");
         free(stmt);
         return NULL;
@@ -986,7 +1254,7 @@ rdb_statement_t* sql_parse_delete(sql_parser_t *parser) {
     /* Parse optional WHERE clause */
     if (sql_parser_next_token(parser) == 0 &&
         parser->current_token.type == SQL_TOKEN_KEYWORD &&
-        sql_get_keyword(parser->current_token.value) == SQL_KW_WHERE) {
+        parser->current_token.keyword == SQL_KW_WHERE) {
         
         stmt->where_conditions = fi_array_create(16, sizeof(sql_where_condition_t*));
         if (!stmt->where_conditions) {
@@ -1009,13 +1277,20 @@ rdb_statement_t* sql_parse_delete(sql_parser_t *parser) {
     stmt->select_columns = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     return stmt;
 }
@@ -1043,7 +1318,7 @@ static rdb_statement_t* sql_parse_create_index_simple(sql_parser_t *parser, rdb_
     }
     
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_ON) {
+        parser->current_token.keyword != SQL_KW_ON) {
         sql_parser_set_error(parser, "Expected ON after index name");
         free(stmt);
         return NULL;
@@ -1076,34 +1351,81 @@ static rdb_statement_t* sql_parse_create_index_simple(sql_parser_t *parser, rdb_
         return NULL;
     }
     
-    /* Parse column name */
-    if (sql_parser_next_token(parser) != 0) {
-        free(stmt);
-        return NULL;
-    }
-    
-    if (parser->current_token.type != SQL_TOKEN_IDENTIFIER) {
-        sql_parser_set_error(parser, "Expected column name");
-        free(stmt);
-        return NULL;
+    /* Parse column list: ( col [, col ...] ) */
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
+    while (true) {
+        if (sql_parser_next_token(parser) != 0) {
+            free(stmt);
+            return NULL;
+        }
+        
+        if (parser->current_token.type != SQL_TOKEN_IDENTIFIER) {
+            sql_parser_set_error(parser, "Expected column name");
+            free(stmt);
+            return NULL;
+        }
+        
+        if (stmt->index_column_count >= RDB_MAX_INDEX_COLUMNS) {
+            sql_parser_set_error(parser, "Too many index columns (max %d)", RDB_MAX_INDEX_COLUMNS);
+            free(stmt);
+            return NULL;
+        }
+        
+        char *column = stmt->index_columns[stmt->index_column_count++];
+        strncpy(column, parser->current_token.value, sizeof(stmt->index_columns[0]) - 1);
+        column[sizeof(stmt->index_columns[0]) - 1] = '\0';
+        
+        /* Parse comma or closing parenthesis */
+        if (sql_parser_next_token(parser) != 0) {
+            free(stmt);
+            return NULL;
+        }
+        
+        if (parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
+            parser->current_token.value[0] == ',') {
+            continue;
+        }
+        
+        if (parser->current_token.type != SQL_TOKEN_PUNCTUATION ||
+            parser->current_token.value[0] != ')') {
+            sql_parser_set_error(parser, "Expected closing parenthesis");
+            free(stmt);
+            return NULL;
+        }
+        break;
     }
     
-    strncpy(stmt->index_column, parser->current_token.value, sizeof(stmt->index_column) - 1);
-    stmt->index_column[sizeof(stmt->index_column) - 1] = '\0';
-    
-    /* Parse closing parenthesis */
+    /* Optional USING BTREE | ART */
     if (sql_parser_next_token(parser) != 0) {
         free(stmt);
         return NULL;
     }
     
-    if (parser->current_token.type != SQL_TOKEN_PUNCTUATION ||
-        parser->current_token.value[0] != ')') {
-        sql_parser_set_error(parser, "Expected closing parenthesis");
-        free(stmt);
-        return NULL;
+    if (parser->current_token.type == SQL_TOKEN_KEYWORD &&
+        parser->current_token.keyword == SQL_KW_USING) {
+        if (sql_parser_next_token(parser) != 0) {
+            free(stmt);
+            return NULL;
+        }
+        
+        if (parser->current_token.type == SQL_TOKEN_IDENTIFIER &&
+            strcasecmp(parser->current_token.value, "ART") == 0) {
+            stmt->index_kind = RDB_INDEX_ART;
+        } else if (parser->current_token.type == SQL_TOKEN_IDENTIFIER &&
+                   strcasecmp(parser->current_token.value, "BTREE") == 0) {
+            stmt->index_kind = RDB_INDEX_BTREE;
+        } else {
+            sql_parser_set_error(parser, "Expected BTREE or ART after USING");
+            free(stmt);
+            return NULL;
+        }
     }
     
+    /* The leading column doubles as the single-column form */
+    strncpy(stmt->index_column, stmt->index_columns[0], sizeof(stmt->index_column) - 1);
+    stmt->index_column[sizeof(stmt->index_column) - 1] = '\0';
+    
     /* Initialize other fields */
     stmt->columns = NULL;
     stmt->values = NULL;
@@ -1112,10 +1434,15 @@ static rdb_statement_t* sql_parse_create_index_simple(sql_parser_t *parser, rdb_
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     return stmt;
 }
@@ -1141,7 +1468,7 @@ int sql_parse_column_definition(sql_parser_t *parser, rdb_column_t *column) {
         return -1;
     }
     
-    sql_keyword_t type_keyword = sql_get_keyword(parser->current_token.value);
+    sql_keyword_t type_keyword = parser->current_token.keyword;
     switch (type_keyword) {
         case SQL_KW_INT:
             column->type = RDB_TYPE_INT;
@@ -1202,6 +1529,7 @@ int sql_parse_column_definition(sql_parser_t *parser, rdb_column_t *column) {
     column->primary_key = false;
     column->unique = false;
     column->default_value[0] = '\0';
+    column->dictionary = false;
     
     /* Parse column constraints */
     while (sql_parser_next_token(parser) == 0) {
@@ -1210,22 +1538,29 @@ int sql_parse_column_definition(sql_parser_t *parser, rdb_column_t *column) {
         }
         
         if (parser->current_token.type == SQL_TOKEN_KEYWORD) {
-            sql_keyword_t constraint = sql_get_keyword(parser->current_token.value);
+            sql_keyword_t constraint = parser->current_token.keyword;
             switch (constraint) {
                 case SQL_KW_PRIMARY:
                     if (sql_parser_next_token(parser) == 0 && 
                         parser->current_token.type == SQL_TOKEN_KEYWORD &&
-                        sql_get_keyword(parser->current_token.value) == SQL_KW_KEY) {
+                        parser->current_token.keyword == SQL_KW_KEY) {
                         column->primary_key = true;
                     }
                     break;
                 case SQL_KW_UNIQUE:
                     column->unique = true;
                     break;
+                case SQL_KW_DICTIONARY:
+                    if (column->type != RDB_TYPE_VARCHAR && column->type != RDB_TYPE_TEXT) {
+                        sql_parser_set_error(parser, "DICTIONARY requires a VARCHAR or TEXT column");
+                        return -1;
+                    }
+                    column->dictionary = true;
+                    break;
                 case SQL_KW_NOT:
                     if (sql_parser_next_token(parser) == 0 && 
                         parser->current_token.type == SQL_TOKEN_KEYWORD &&
-                        sql_get_keyword(parser->current_token.value) == SQL_KW_NULL) {
+                        parser->current_token.keyword == SQL_KW_NULL) {
                         column->nullable = false;
                     }
                     break;
@@ -1267,7 +1602,7 @@ bool sql_parser_match_keyword(sql_parser_t *parser, const char *keyword) {
     if (!parser || parser->current_token.type != SQL_TOKEN_KEYWORD) {
         return false;
     }
-    return strcasecmp(parser->current_token.value, keyword) == 0;
+    return sql_get_keyword(keyword) == parser->current_token.keyword;
 }
 
 bool sql_parser_match_punctuation(sql_parser_t *parser, char punct) {
@@ -1321,6 +1656,7 @@ void sql_statement_free(rdb_statement_t *stmt) {
             if (cond && cond->value) {
                 rdb_value_free(cond->value);
             }
+            if (cond) rdb_expr_free(cond->expr);
             free(cond);
         }
         fi_array_destroy(stmt->where_conditions);
@@ -1330,6 +1666,18 @@ void sql_statement_free(rdb_statement_t *stmt) {
         fi_array_destroy(stmt->select_columns);
     }
     
+    sql_expression_list_free(stmt->set_expressions);
+    
+    if (stmt->aggregates) {
+        fi_array_destroy(stmt->aggregates);
+    }
+    sql_group_by_free(stmt->group_by);
+    
+    if (stmt->order_by) {
+        fi_array_destroy(stmt->order_by);
+    }
+    
+    free(stmt->prepared_sql);
     free(stmt);
 }
 
@@ -1337,7 +1685,7 @@ void sql_statement_free(rdb_statement_t *stmt) {
 rdb_statement_t* sql_parse_begin_transaction(sql_parser_t *parser) {
     if (!parser) return NULL;
     
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
     /* Initialize statement */
@@ -1349,18 +1697,25 @@ rdb_statement_t* sql_parse_begin_transaction(sql_parser_t *parser) {
     stmt->select_columns = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     /* Parse optional TRANSACTION keyword */
     if (sql_parser_next_token(parser) == 0 && 
         parser->current_token.type == SQL_TOKEN_KEYWORD &&
-        sql_get_keyword(parser->current_token.value) == SQL_KW_TRANSACTION) {
+        parser->current_token.keyword == SQL_KW_TRANSACTION) {
         sql_parser_next_token(parser);
     }
     
@@ -1370,7 +1725,7 @@ rdb_statement_t* sql_parse_begin_transaction(sql_parser_t *parser) {
 rdb_statement_t* sql_parse_commit_transaction(sql_parser_t *parser) {
     if (!parser) return NULL;
     
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
     /* Initialize statement */
@@ -1382,18 +1737,25 @@ rdb_statement_t* sql_parse_commit_transaction(sql_parser_t *parser) {
     stmt->select_columns = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     /* Parse optional TRANSACTION keyword */
     if (sql_parser_next_token(parser) == 0 && 
         parser->current_token.type == SQL_TOKEN_KEYWORD &&
-        sql_get_keyword(parser->current_token.value) == SQL_KW_TRANSACTION) {
+        parser->current_token.keyword == SQL_KW_TRANSACTION) {
         sql_parser_next_token(parser);
     }
     
@@ -1403,7 +1765,7 @@ rdb_statement_t* sql_parse_commit_transaction(sql_parser_t *parser) {
 rdb_statement_t* sql_parse_rollback_transaction(sql_parser_t *parser) {
     if (!parser) return NULL;
     
-    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    rdb_statement_t *stmt = calloc(1, sizeof(rdb_statement_t));
     if (!stmt) return NULL;
     
     /* Initialize statement */
@@ -1415,35 +1777,229 @@ rdb_statement_t* sql_parse_rollback_transaction(sql_parser_t *parser) {
     stmt->select_columns = NULL;
     stmt->index_name[0] = '\0';
     stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
     stmt->from_tables = NULL;
     stmt->join_conditions = NULL;
     stmt->order_by = NULL;
-    stmt->limit_value = 0;
+    stmt->limit_value = RDB_NO_LIMIT;
     stmt->offset_value = 0;
     stmt->foreign_key_name[0] = '\0';
     stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
     
     /* Parse optional TRANSACTION keyword */
     if (sql_parser_next_token(parser) == 0 && 
         parser->current_token.type == SQL_TOKEN_KEYWORD &&
-        sql_get_keyword(parser->current_token.value) == SQL_KW_TRANSACTION) {
+        parser->current_token.keyword == SQL_KW_TRANSACTION) {
         sql_parser_next_token(parser);
     }
     
     return stmt;
 }
 
-int sql_parse_isolation_level(sql_parser_t *parser, rdb_isolation_level_t *level) {
-    if (!parser || !level) return -1;
+/* VACUUM [table] */
+rdb_statement_t* sql_parse_vacuum(sql_parser_t *parser) {
+    if (!parser) return NULL;
+    
+    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    if (!stmt) return NULL;
+    
+    /* Initialize statement */
+    stmt->type = RDB_STMT_VACUUM;
+    stmt->table_name[0] = '\0';
+    stmt->columns = NULL;
+    stmt->values = NULL;
+    stmt->where_conditions = NULL;
+    stmt->select_columns = NULL;
+    stmt->index_name[0] = '\0';
+    stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
+    stmt->storage_mode = RDB_STORAGE_ROW;
+    stmt->from_tables = NULL;
+    stmt->join_conditions = NULL;
+    stmt->order_by = NULL;
+    stmt->limit_value = RDB_NO_LIMIT;
+    stmt->offset_value = 0;
+    stmt->foreign_key_name[0] = '\0';
+    stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
+    
+    /* Parse optional table name */
+    if (sql_parser_next_token(parser) == 0 &&
+        parser->current_token.type == SQL_TOKEN_IDENTIFIER) {
+        strncpy(stmt->table_name, parser->current_token.value, sizeof(stmt->table_name) - 1);
+        stmt->table_name[sizeof(stmt->table_name) - 1] = '\0';
+        sql_parser_next_token(parser);
+    }
+    
+    return stmt;
+}
+
+/* ANALYZE [table] */
+rdb_statement_t* sql_parse_analyze(sql_parser_t *parser) {
+    /* Same shape as VACUUM: an optional table name */
+    rdb_statement_t *stmt = sql_parse_vacuum(parser);
+    if (stmt) stmt->type = RDB_STMT_ANALYZE;
+    return stmt;
+}
+
+/* Statement of `type` with every field empty */
+static rdb_statement_t* sql_statement_create(rdb_stmt_type_t type) {
+    rdb_statement_t *stmt = malloc(sizeof(rdb_statement_t));
+    if (!stmt) return NULL;
     
+    stmt->type = type;
+    stmt->table_name[0] = '\0';
+    stmt->columns = NULL;
+    stmt->values = NULL;
+    stmt->where_conditions = NULL;
+    stmt->select_columns = NULL;
+    stmt->index_name[0] = '\0';
+    stmt->index_column[0] = '\0';
+    stmt->index_column_count = 0;
+    stmt->index_kind = RDB_INDEX_BTREE;
+    stmt->storage_mode = RDB_STORAGE_ROW;
+    stmt->from_tables = NULL;
+    stmt->join_conditions = NULL;
+    stmt->order_by = NULL;
+    stmt->limit_value = RDB_NO_LIMIT;
+    stmt->offset_value = 0;
+    stmt->foreign_key_name[0] = '\0';
+    stmt->foreign_key = NULL;
+    stmt->set_expressions = NULL;
+    stmt->aggregates = NULL;
+    stmt->group_by = NULL;
+    stmt->prepared_name[0] = '\0';
+    stmt->prepared_sql = NULL;
+    return stmt;
+}
+
+/* Read the statement name of PREPARE / EXECUTE / DEALLOCATE */
+static int sql_parse_prepared_name(sql_parser_t *parser, rdb_statement_t *stmt, const char *clause) {
     if (sql_parser_next_token(parser) != 0) return -1;
     
-    if (parser->current_token.type != SQL_TOKEN_KEYWORD) {
-        sql_parser_set_error(parser, "Expected isolation level keyword");
+    if (parser->current_token.type != SQL_TOKEN_IDENTIFIER) {
+        sql_parser_set_error(parser, "Expected statement name after %s", clause);
         return -1;
     }
+    strncpy(stmt->prepared_name, parser->current_token.value, sizeof(stmt->prepared_name) - 1);
+    stmt->prepared_name[sizeof(stmt->prepared_name) - 1] = '\0';
+    return 0;
+}
+
+/* PREPARE name AS statement
+ *
+ * The statement text is kept as written, up to an optional trailing ';',
+ * and parsed when the statement is prepared. */
+rdb_statement_t* sql_parse_prepare(sql_parser_t *parser) {
+    if (!parser) return NULL;
     
-    sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
+    rdb_statement_t *stmt = sql_statement_create(RDB_STMT_PREPARE);
+    if (!stmt) return NULL;
+    
+    if (sql_parse_prepared_name(parser, stmt, "PREPARE") != 0 ||
+        sql_parser_next_token(parser) != 0) {
+        sql_statement_free(stmt);
+        return NULL;
+    }
+    if (!sql_parser_match_keyword(parser, "AS")) {
+        sql_parser_set_error(parser, "Expected AS after PREPARE %s", stmt->prepared_name);
+        sql_statement_free(stmt);
+        return NULL;
+    }
+    
+    sql_parser_skip_whitespace(parser);
+    size_t start = parser->pos;
+    size_t end = parser->length;
+    while (end > start && (sql_is_whitespace(parser->sql[end - 1]) || parser->sql[end - 1] == ';')) {
+        end--;
+    }
+    if (end == start) {
+        sql_parser_set_error(parser, "Expected statement after AS");
+        sql_statement_free(stmt);
+        return NULL;
+    }
+    
+    stmt->prepared_sql = malloc(end - start + 1);
+    if (!stmt->prepared_sql) {
+        sql_statement_free(stmt);
+        return NULL;
+    }
+    memcpy(stmt->prepared_sql, parser->sql + start, end - start);
+    stmt->prepared_sql[end - start] = '\0';
+    
+    parser->pos = parser->length;
+    sql_parser_next_token(parser);
+    return stmt;
+}
+
+/* EXECUTE name [(value, ...)] */
+rdb_statement_t* sql_parse_execute(sql_parser_t *parser) {
+    if (!parser) return NULL;
+    
+    rdb_statement_t *stmt = sql_statement_create(RDB_STMT_EXECUTE);
+    if (!stmt) return NULL;
+    
+    stmt->values = fi_array_create(8, sizeof(rdb_value_t*));
+    if (!stmt->values || sql_parse_prepared_name(parser, stmt, "EXECUTE") != 0) {
+        sql_statement_free(stmt);
+        return NULL;
+    }
+    
+    sql_parser_skip_whitespace(parser);
+    if (sql_parser_peek_char(parser) == '(' && sql_parse_value_list(parser, stmt->values) != 0) {
+        sql_statement_free(stmt);
+        return NULL;
+    }
+    
+    sql_parser_next_token(parser);
+    return stmt;
+}
+
+/* DEALLOCATE [PREPARE] name */
+rdb_statement_t* sql_parse_deallocate(sql_parser_t *parser) {
+    if (!parser) return NULL;
+    
+    rdb_statement_t *stmt = sql_statement_create(RDB_STMT_DEALLOCATE);
+    if (!stmt) return NULL;
+    
+    /* Step over PREPARE, leaving the name for sql_parse_prepared_name */
+    size_t pos = parser->pos;
+    if (sql_parser_next_token(parser) != 0 ||
+        !sql_parser_match_keyword(parser, "PREPARE")) {
+        parser->pos = pos;
+    }
+    
+    if (sql_parse_prepared_name(parser, stmt, "DEALLOCATE") != 0) {
+        sql_statement_free(stmt);
+        return NULL;
+    }
+    
+    sql_parser_next_token(parser);
+    return stmt;
+}
+
+int sql_parse_isolation_level(sql_parser_t *parser, rdb_isolation_level_t *level) {
+    if (!parser || !level) return -1;
+    
+    if (sql_parser_next_token(parser) != 0) return -1;
+    
+    if (parser->current_token.type != SQL_TOKEN_KEYWORD) {
+        sql_parser_set_error(parser, "Expected isolation level keyword");
+        return -1;
+    }
+    
+    sql_keyword_t keyword = parser->current_token.keyword;
     
     switch (keyword) {
         case SQL_KW_READ:
@@ -1454,7 +2010,7 @@ int sql_parse_isolation_level(sql_parser_t *parser, rdb_isolation_level_t *level
                 return -1;
             }
             
-            sql_keyword_t read_keyword = sql_get_keyword(parser->current_token.value);
+            sql_keyword_t read_keyword = parser->current_token.keyword;
             if (read_keyword == SQL_KW_UNCOMMITTED) {
                 *level = RDB_ISOLATION_READ_UNCOMMITTED;
             } else if (read_keyword == SQL_KW_COMMITTED) {
@@ -1469,7 +2025,7 @@ int sql_parse_isolation_level(sql_parser_t *parser, rdb_isolation_level_t *level
             /* Check for REPEATABLE READ */
             if (sql_parser_next_token(parser) != 0) return -1;
             if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-                sql_get_keyword(parser->current_token.value) != SQL_KW_READ) {
+                parser->current_token.keyword != SQL_KW_READ) {
                 sql_parser_set_error(parser, "Expected READ after REPEATABLE");
                 return -1;
             }
@@ -1556,14 +2112,32 @@ int sql_parse_value_list(sql_parser_t *parser, fi_array *values) {
     return 0;
 }
 
+/* A ? placeholder reads as a NULL literal that is recorded as the next
+ * parameter, for rdb_bind_*() to overwrite in place */
+static rdb_value_t* sql_parse_parameter(sql_parser_t *parser) {
+    if (!parser->parameters) {
+        sql_parser_set_error(parser, "Parameter ? is only allowed in prepared statements");
+        return NULL;
+    }
+    
+    rdb_value_t *value = rdb_create_null_value(RDB_TYPE_INT);
+    if (value && fi_array_push(parser->parameters, &value) != 0) {
+        rdb_value_free(value);
+        return NULL;
+    }
+    return value;
+}
+
 /* Value parsing */
 rdb_value_t* sql_parse_value(sql_parser_t *parser) {
-    if (parser->current_token.type == SQL_TOKEN_STRING) {
+    if (sql_parser_match_punctuation(parser, '?')) {
+        return sql_parse_parameter(parser);
+    } else if (parser->current_token.type == SQL_TOKEN_STRING) {
         return sql_parse_string_value(parser->current_token.value);
     } else if (parser->current_token.type == SQL_TOKEN_NUMBER) {
         return sql_parse_number_value(parser->current_token.value);
     } else if (parser->current_token.type == SQL_TOKEN_KEYWORD) {
-        sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
+        sql_keyword_t keyword = parser->current_token.keyword;
         if (keyword == SQL_KW_NULL) {
             return rdb_create_null_value(RDB_TYPE_INT); /* Default type for NULL */
         } else if (keyword == SQL_KW_TRUE || keyword == SQL_KW_FALSE) {
@@ -1637,88 +2211,726 @@ int sql_parse_from_clause(sql_parser_t *parser, fi_array *from_tables) {
     return 0;
 }
 
-/* WHERE clause parsing */
-int sql_parse_where_clause(sql_parser_t *parser, fi_array *conditions) {
-    if (sql_parser_next_token(parser) != 0) return -1;
+/* SELECT list parsing: column names and COUNT(*), COUNT/SUM/AVG/MIN/MAX(column).
+ * Starts at the first item and leaves the parser on the token after the
+ * list. `columns` gets a display name per item and `aggregates` an
+ * rdb_aggregate_t per item. Returns the number of aggregate items. */
+int sql_parse_select_list(sql_parser_t *parser, fi_array *columns, fi_array *aggregates) {
+    static const struct {
+        const char *name;
+        rdb_aggregate_func_t func;
+    } functions[] = {
+        {"COUNT", RDB_AGG_COUNT}, {"SUM", RDB_AGG_SUM}, {"AVG", RDB_AGG_AVG},
+        {"MIN", RDB_AGG_MIN}, {"MAX", RDB_AGG_MAX}
+    };
+    int aggregate_count = 0;
     
     while (true) {
-        sql_where_condition_t *condition = malloc(sizeof(sql_where_condition_t));
-        if (!condition) return -1;
-        
-        /* Parse column name */
         if (parser->current_token.type != SQL_TOKEN_IDENTIFIER) {
-            sql_parser_set_error(parser, "Expected column name in WHERE clause");
-            free(condition);
+            sql_parser_set_error(parser, "Expected column name");
             return -1;
         }
         
-        strncpy(condition->column_name, parser->current_token.value, sizeof(condition->column_name) - 1);
-        condition->column_name[sizeof(condition->column_name) - 1] = '\0';
+        rdb_aggregate_t item = {RDB_AGG_NONE, ""};
+        char name[64];
+        strncpy(name, parser->current_token.value, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
         
-        /* Parse operator */
-        if (sql_parser_next_token(parser) != 0) {
-            free(condition);
-            return -1;
-        }
+        if (sql_parser_next_token(parser) != 0) return -1;
         
-        if (parser->current_token.type == SQL_TOKEN_OPERATOR) {
-            condition->operator = sql_get_operator(parser->current_token.value);
-        } else if (parser->current_token.type == SQL_TOKEN_KEYWORD) {
-            sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
-            if (keyword == SQL_KW_LIKE) {
-                condition->operator = SQL_OP_LIKE;
-            } else if (keyword == SQL_KW_IS) {
-                condition->operator = SQL_OP_IS;
-            } else if (keyword == SQL_KW_IN) {
-                condition->operator = SQL_OP_IN;
+        if (parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
+            parser->current_token.value[0] == '(') {
+            for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+                if (strcasecmp(name, functions[i].name) == 0) item.func = functions[i].func;
+            }
+            if (item.func == RDB_AGG_NONE) {
+                sql_parser_set_error(parser, "Unknown aggregate function '%s'", name);
+                return -1;
+            }
+            
+            if (sql_parser_next_token(parser) != 0) return -1;
+            if (item.func == RDB_AGG_COUNT && parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
+                parser->current_token.value[0] == '*') {
+                item.func = RDB_AGG_COUNT_STAR;
+            } else if (parser->current_token.type == SQL_TOKEN_IDENTIFIER) {
+                strncpy(item.column, parser->current_token.value, sizeof(item.column) - 1);
+                item.column[sizeof(item.column) - 1] = '\0';
             } else {
-                sql_parser_set_error(parser, "Invalid operator in WHERE clause");
-                free(condition);
+                sql_parser_set_error(parser, "Expected column name in %s()", name);
+                return -1;
+            }
+            
+            if (sql_parser_next_token(parser) != 0) return -1;
+            if (parser->current_token.type != SQL_TOKEN_PUNCTUATION ||
+                parser->current_token.value[0] != ')') {
+                sql_parser_set_error(parser, "Expected closing parenthesis after aggregate argument");
                 return -1;
             }
+            if (sql_parser_next_token(parser) != 0) return -1;
+            
+            aggregate_count++;
         } else {
-            sql_parser_set_error(parser, "Expected operator in WHERE clause");
-            free(condition);
-            return -1;
+            memcpy(item.column, name, sizeof(item.column));
         }
         
-        /* Parse value */
-        if (sql_parser_next_token(parser) != 0) {
-            free(condition);
+        /* Display name, e.g. "SUM(amount)" */
+        char *display = malloc(strlen(name) + strlen(item.column) + 4);
+        if (!display) return -1;
+        if (item.func == RDB_AGG_NONE) {
+            strcpy(display, name);
+        } else {
+            for (char *c = strcpy(display, name); *c; c++) *c = toupper((unsigned char)*c);
+            strcat(display, "(");
+            strcat(display, item.func == RDB_AGG_COUNT_STAR ? "*" : item.column);
+            strcat(display, ")");
+        }
+        
+        if (fi_array_push(columns, &display) != 0) {
+            free(display);
             return -1;
         }
+        if (fi_array_push(aggregates, &item) != 0) return -1;
         
-        condition->value = sql_parse_value(parser);
-        if (!condition->value) {
-            free(condition);
+        if (parser->current_token.type != SQL_TOKEN_PUNCTUATION ||
+            parser->current_token.value[0] != ',') {
+            break;
+        }
+        if (sql_parser_next_token(parser) != 0) return -1;
+    }
+    
+    return aggregate_count;
+}
+
+/* GROUP BY parsing: starts at GROUP and leaves the parser on the token
+ * after the last column */
+int sql_parse_group_by_clause(sql_parser_t *parser, fi_array *columns) {
+    if (sql_parser_next_token(parser) != 0) return -1;
+    if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
+        parser->current_token.keyword != SQL_KW_BY) {
+        sql_parser_set_error(parser, "Expected BY after GROUP");
+        return -1;
+    }
+    
+    while (true) {
+        if (sql_parser_next_token(parser) != 0) return -1;
+        if (parser->current_token.type != SQL_TOKEN_IDENTIFIER) {
+            sql_parser_set_error(parser, "Expected column name in GROUP BY");
             return -1;
         }
         
-        /* Initialize logical connector */
-        condition->logical_connector[0] = '\0';
+        char *column_name = malloc(strlen(parser->current_token.value) + 1);
+        if (!column_name) return -1;
+        strcpy(column_name, parser->current_token.value);
+        if (fi_array_push(columns, &column_name) != 0) {
+            free(column_name);
+            return -1;
+        }
         
-        fi_array_push(conditions, &condition);
+        if (sql_parser_next_token(parser) != 0) return -1;
+        if (parser->current_token.type != SQL_TOKEN_PUNCTUATION ||
+            parser->current_token.value[0] != ',') {
+            break;
+        }
+    }
+    
+    return 0;
+}
+
+/* ORDER BY parsing: starts at ORDER and leaves the parser on the token
+ * after the last item. An item is a column, a select-list position or an
+ * aggregate such as SUM(amount), optionally followed by ASC or DESC. */
+int sql_parse_order_by_clause(sql_parser_t *parser, fi_array *order_by) {
+    if (sql_parser_next_token(parser) != 0) return -1;
+    if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
+        parser->current_token.keyword != SQL_KW_BY) {
+        sql_parser_set_error(parser, "Expected BY after ORDER");
+        return -1;
+    }
+    
+    while (true) {
+        rdb_order_by_t item = {"", 0, false};
         
         if (sql_parser_next_token(parser) != 0) return -1;
+        if (parser->current_token.type == SQL_TOKEN_NUMBER) {
+            char *end;
+            unsigned long long position = strtoull(parser->current_token.value, &end, 10);
+            if (*end != '\0' || position == 0) {
+                sql_parser_set_error(parser, "Invalid ORDER BY position '%s'", parser->current_token.value);
+                return -1;
+            }
+            item.position = (size_t)position;
+            if (sql_parser_next_token(parser) != 0) return -1;
+        } else if (parser->current_token.type == SQL_TOKEN_IDENTIFIER) {
+            strncpy(item.column, parser->current_token.value, sizeof(item.column) - 1);
+            if (sql_parser_next_token(parser) != 0) return -1;
+            
+            /* An aggregate is matched against the select list by its text */
+            if (parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
+                parser->current_token.value[0] == '(') {
+                if (sql_parser_next_token(parser) != 0) return -1;
+                if (parser->current_token.type != SQL_TOKEN_IDENTIFIER &&
+                    !(parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
+                      parser->current_token.value[0] == '*')) {
+                    sql_parser_set_error(parser, "Expected column name in %s()", item.column);
+                    return -1;
+                }
+                for (char *c = item.column; *c; c++) *c = toupper((unsigned char)*c);
+                size_t used = strlen(item.column);
+                snprintf(item.column + used, sizeof(item.column) - used, "(%s)",
+                         parser->current_token.value);
+                
+                if (sql_parser_next_token(parser) != 0) return -1;
+                if (parser->current_token.type != SQL_TOKEN_PUNCTUATION ||
+                    parser->current_token.value[0] != ')') {
+                    sql_parser_set_error(parser, "Expected closing parenthesis in ORDER BY");
+                    return -1;
+                }
+                if (sql_parser_next_token(parser) != 0) return -1;
+            }
+        } else {
+            sql_parser_set_error(parser, "Expected column name in ORDER BY");
+            return -1;
+        }
         
-        /* Check for logical operators */
         if (parser->current_token.type == SQL_TOKEN_KEYWORD) {
-            sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
-            if (keyword == SQL_KW_AND || keyword == SQL_KW_OR) {
-                strncpy(condition->logical_connector, parser->current_token.value, sizeof(condition->logical_connector) - 1);
-                condition->logical_connector[sizeof(condition->logical_connector) - 1] = '\0';
-                
+            sql_keyword_t direction = parser->current_token.keyword;
+            if (direction == SQL_KW_ASC || direction == SQL_KW_DESC) {
+                item.descending = direction == SQL_KW_DESC;
                 if (sql_parser_next_token(parser) != 0) return -1;
-                continue;
             }
         }
         
-        break;
+        if (fi_array_push(order_by, &item) != 0) return -1;
+        
+        if (parser->current_token.type != SQL_TOKEN_PUNCTUATION ||
+            parser->current_token.value[0] != ',') {
+            break;
+        }
+    }
+    
+    return 0;
+}
+
+/* Read a non-negative integer literal for LIMIT/OFFSET and step past it */
+static int sql_parse_count(sql_parser_t *parser, const char *clause, size_t *count) {
+    if (sql_parser_next_token(parser) != 0) return -1;
+    
+    char *end = NULL;
+    unsigned long long value = 0;
+    if (parser->current_token.type == SQL_TOKEN_NUMBER) {
+        value = strtoull(parser->current_token.value, &end, 10);
+    }
+    if (!end || *end != '\0' || value >= RDB_NO_LIMIT) {
+        sql_parser_set_error(parser, "Expected a non-negative integer after %s", clause);
+        return -1;
+    }
+    *count = (size_t)value;
+    
+    return sql_parser_next_token(parser);
+}
+
+/* Optional LIMIT n [OFFSET m]; leaves the parser on the token after it */
+int sql_parse_limit_clause(sql_parser_t *parser, size_t *limit, size_t *offset) {
+    if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
+        parser->current_token.keyword != SQL_KW_LIMIT) {
+        return 0;
     }
+    if (sql_parse_count(parser, "LIMIT", limit) != 0) return -1;
     
+    if (parser->current_token.type == SQL_TOKEN_KEYWORD &&
+        parser->current_token.keyword == SQL_KW_OFFSET) {
+        return sql_parse_count(parser, "OFFSET", offset);
+    }
     return 0;
 }
 
+/* Expression parsing
+ *
+ * Precedence, lowest first: OR, AND, NOT, comparison (= != <> < > <= >=,
+ * IS [NOT] NULL, [NOT] LIKE, [NOT] IN), + -, * / %, unary minus. Each
+ * function starts at the first token of its construct and leaves the
+ * parser on the first token after it. */
+static rdb_expr_t* sql_parse_or_expression(sql_parser_t *parser);
+
+static bool sql_token_is_keyword(sql_parser_t *parser, sql_keyword_t keyword) {
+    return parser->current_token.type == SQL_TOKEN_KEYWORD &&
+           parser->current_token.keyword == keyword;
+}
+
+static bool sql_token_is_operator(sql_parser_t *parser, const char *op) {
+    return parser->current_token.type == SQL_TOKEN_OPERATOR &&
+           strcmp(parser->current_token.value, op) == 0;
+}
+
+static bool sql_token_is_punctuation(sql_parser_t *parser, char punct) {
+    return parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
+           parser->current_token.value[0] == punct;
+}
+
+/* Comparison operator of the current token, or RDB_EXPR_OP_NONE */
+static rdb_expr_op_t sql_comparison_operator(sql_parser_t *parser) {
+    if (parser->current_token.type != SQL_TOKEN_OPERATOR) return RDB_EXPR_OP_NONE;
+    if (strcmp(parser->current_token.value, "==") == 0) return RDB_EXPR_OP_EQ;
+
+    switch (sql_get_operator(parser->current_token.value)) {
+        case SQL_OP_EQUAL:         return RDB_EXPR_OP_EQ;
+        case SQL_OP_NOT_EQUAL:     return RDB_EXPR_OP_NE;
+        case SQL_OP_LESS_THAN:     return RDB_EXPR_OP_LT;
+        case SQL_OP_GREATER_THAN:  return RDB_EXPR_OP_GT;
+        case SQL_OP_LESS_EQUAL:    return RDB_EXPR_OP_LE;
+        case SQL_OP_GREATER_EQUAL: return RDB_EXPR_OP_GE;
+        default:                   return RDB_EXPR_OP_NONE;
+    }
+}
+
+/* Arguments of a function call, starting at '(' */
+static rdb_expr_t* sql_parse_function_call(sql_parser_t *parser, const char *name) {
+    fi_array *args = fi_array_create(4, sizeof(rdb_expr_t*));
+    if (!args) return NULL;
+
+    bool ok = sql_parser_next_token(parser) == 0;
+    if (ok && !sql_token_is_punctuation(parser, ')')) {
+        while (ok) {
+            rdb_expr_t *arg = sql_parse_or_expression(parser);
+            if (!arg || fi_array_push(args, &arg) != 0) {
+                rdb_expr_free(arg);
+                ok = false;
+                break;
+            }
+            if (!sql_token_is_punctuation(parser, ',')) break;
+            ok = sql_parser_next_token(parser) == 0;
+        }
+    }
+
+    if (ok && !sql_token_is_punctuation(parser, ')')) {
+        sql_parser_set_error(parser, "Expected ) after arguments of %s", name);
+        ok = false;
+    }
+    if (ok) ok = sql_parser_next_token(parser) == 0;
+
+    if (!ok) {
+        for (size_t i = 0; i < fi_array_count(args); i++) {
+            rdb_expr_free(*(rdb_expr_t**)fi_array_get(args, i));
+        }
+        fi_array_destroy(args);
+        return NULL;
+    }
+
+    rdb_expr_t *expr = rdb_expr_create_function(name, args);
+    fi_array_destroy(args);
+    return expr;
+}
+
+static rdb_expr_t* sql_parse_primary(sql_parser_t *parser) {
+    sql_token_type_t type = parser->current_token.type;
+
+    if (type == SQL_TOKEN_NUMBER || type == SQL_TOKEN_STRING || sql_token_is_punctuation(parser, '?') ||
+        sql_token_is_keyword(parser, SQL_KW_NULL) ||
+        sql_token_is_keyword(parser, SQL_KW_TRUE) || sql_token_is_keyword(parser, SQL_KW_FALSE)) {
+        rdb_value_t *value = sql_parse_value(parser);
+        if (!value) return NULL;
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_value_free(value);
+            return NULL;
+        }
+        return rdb_expr_create_literal(value);
+    }
+
+    if (sql_token_is_punctuation(parser, '(')) {
+        if (sql_parser_next_token(parser) != 0) return NULL;
+        rdb_expr_t *expr = sql_parse_or_expression(parser);
+        if (!expr) return NULL;
+        if (!sql_token_is_punctuation(parser, ')')) {
+            sql_parser_set_error(parser, "Expected ) in expression");
+            rdb_expr_free(expr);
+            return NULL;
+        }
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(expr);
+            return NULL;
+        }
+        return expr;
+    }
+
+    if (type == SQL_TOKEN_IDENTIFIER) {
+        char name[64];
+        strncpy(name, parser->current_token.value, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+
+        if (sql_parser_next_token(parser) != 0) return NULL;
+        if (sql_token_is_punctuation(parser, '(')) {
+            return sql_parse_function_call(parser, name);
+        }
+        return rdb_expr_create_column(name);
+    }
+
+    sql_parser_set_error(parser, "Expected expression");
+    return NULL;
+}
+
+static rdb_expr_t* sql_parse_unary(sql_parser_t *parser) {
+    bool negate = sql_token_is_operator(parser, "-");
+    if (negate || sql_token_is_operator(parser, "+")) {
+        if (sql_parser_next_token(parser) != 0) return NULL;
+        rdb_expr_t *operand = sql_parse_unary(parser);
+        if (!operand || !negate) return operand;
+
+        /* Fold the sign into a numeric literal */
+        rdb_value_t *value = operand->kind == RDB_EXPR_LITERAL ? operand->value : NULL;
+        if (value && !value->is_null && value->type == RDB_TYPE_INT) {
+            value->data.int_val = (int64_t)(0 - (uint64_t)value->data.int_val);
+            return operand;
+        }
+        if (value && !value->is_null && value->type == RDB_TYPE_FLOAT) {
+            value->data.float_val = -value->data.float_val;
+            return operand;
+        }
+        return rdb_expr_create_unary(RDB_EXPR_OP_NEG, operand);
+    }
+
+    return sql_parse_primary(parser);
+}
+
+static rdb_expr_t* sql_parse_multiplicative(sql_parser_t *parser) {
+    rdb_expr_t *left = sql_parse_unary(parser);
+
+    while (left) {
+        rdb_expr_op_t op;
+        if (sql_token_is_punctuation(parser, '*')) {
+            op = RDB_EXPR_OP_MUL;
+        } else if (sql_token_is_operator(parser, "/")) {
+            op = RDB_EXPR_OP_DIV;
+        } else if (sql_token_is_operator(parser, "%")) {
+            op = RDB_EXPR_OP_MOD;
+        } else {
+            break;
+        }
+
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        left = rdb_expr_create_binary(op, left, sql_parse_unary(parser));
+    }
+    return left;
+}
+
+static rdb_expr_t* sql_parse_additive(sql_parser_t *parser) {
+    rdb_expr_t *left = sql_parse_multiplicative(parser);
+
+    while (left) {
+        rdb_expr_op_t op;
+        if (sql_token_is_operator(parser, "+")) {
+            op = RDB_EXPR_OP_ADD;
+        } else if (sql_token_is_operator(parser, "-")) {
+            op = RDB_EXPR_OP_SUB;
+        } else {
+            break;
+        }
+
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        left = rdb_expr_create_binary(op, left, sql_parse_multiplicative(parser));
+    }
+    return left;
+}
+
+/* Whether `expr` holds a ? placeholder of this parser */
+static bool sql_expression_has_parameter(sql_parser_t *parser, const rdb_expr_t *expr) {
+    if (!parser->parameters || !expr) return false;
+
+    if (expr->kind == RDB_EXPR_LITERAL) {
+        for (size_t i = 0; i < fi_array_count(parser->parameters); i++) {
+            if (*(rdb_value_t**)fi_array_get(parser->parameters, i) == expr->value) return true;
+        }
+    }
+    for (size_t i = 0; i < expr->arg_count; i++) {
+        if (sql_expression_has_parameter(parser, expr->args[i])) return true;
+    }
+    return false;
+}
+
+/* IN (a, b, ...) becomes left = a OR left = b OR ... */
+static rdb_expr_t* sql_parse_in_list(sql_parser_t *parser, rdb_expr_t *left) {
+    rdb_expr_t *result = NULL;
+
+    /* Each copy of `left` would need binding of its own */
+    if (sql_expression_has_parameter(parser, left)) {
+        sql_parser_set_error(parser, "Parameter ? cannot be tested with IN (...)");
+        rdb_expr_free(left);
+        return NULL;
+    }
+
+    if (sql_parser_next_token(parser) != 0) {
+        rdb_expr_free(left);
+        return NULL;
+    }
+    while (true) {
+        rdb_expr_t *item = sql_parse_additive(parser);
+        rdb_expr_t *test = item ? rdb_expr_create_binary(RDB_EXPR_OP_EQ, rdb_expr_copy(left), item) : NULL;
+        if (!test) {
+            rdb_expr_free(result);
+            rdb_expr_free(left);
+            return NULL;
+        }
+        result = result ? rdb_expr_create_binary(RDB_EXPR_OP_OR, result, test) : test;
+        if (!result) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+
+        if (!sql_token_is_punctuation(parser, ',')) break;
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(result);
+            rdb_expr_free(left);
+            return NULL;
+        }
+    }
+    rdb_expr_free(left);
+
+    if (!sql_token_is_punctuation(parser, ')')) {
+        sql_parser_set_error(parser, "Expected ) after IN list");
+        rdb_expr_free(result);
+        return NULL;
+    }
+    if (sql_parser_next_token(parser) != 0) {
+        rdb_expr_free(result);
+        return NULL;
+    }
+    return result;
+}
+
+static rdb_expr_t* sql_parse_comparison(sql_parser_t *parser) {
+    rdb_expr_t *left = sql_parse_additive(parser);
+    if (!left) return NULL;
+
+    rdb_expr_op_t op = sql_comparison_operator(parser);
+    if (op != RDB_EXPR_OP_NONE) {
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        return rdb_expr_create_binary(op, left, sql_parse_additive(parser));
+    }
+
+    if (sql_token_is_keyword(parser, SQL_KW_IS)) {
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        bool negate = sql_token_is_keyword(parser, SQL_KW_NOT);
+        if (negate && sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+
+        if (sql_token_is_keyword(parser, SQL_KW_NULL)) {
+            if (sql_parser_next_token(parser) != 0) {
+                rdb_expr_free(left);
+                return NULL;
+            }
+            return rdb_expr_create_unary(negate ? RDB_EXPR_OP_IS_NOT_NULL : RDB_EXPR_OP_IS_NULL, left);
+        }
+
+        /* IS <value> compares like = */
+        return rdb_expr_create_binary(negate ? RDB_EXPR_OP_NE : RDB_EXPR_OP_EQ, left, sql_parse_additive(parser));
+    }
+
+    bool negate = sql_token_is_keyword(parser, SQL_KW_NOT);
+    if (negate) {
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        if (!sql_token_is_keyword(parser, SQL_KW_LIKE) && !sql_token_is_keyword(parser, SQL_KW_IN)) {
+            sql_parser_set_error(parser, "Expected LIKE or IN after NOT");
+            rdb_expr_free(left);
+            return NULL;
+        }
+    }
+
+    rdb_expr_t *expr = left;
+    if (sql_token_is_keyword(parser, SQL_KW_LIKE)) {
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        expr = rdb_expr_create_binary(RDB_EXPR_OP_LIKE, left, sql_parse_additive(parser));
+    } else if (sql_token_is_keyword(parser, SQL_KW_IN)) {
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        if (sql_token_is_punctuation(parser, '(')) {
+            expr = sql_parse_in_list(parser, left);
+        } else {
+            /* A single IN value compares like = */
+            expr = rdb_expr_create_binary(RDB_EXPR_OP_EQ, left, sql_parse_additive(parser));
+        }
+    }
+
+    return negate ? rdb_expr_create_unary(RDB_EXPR_OP_NOT, expr) : expr;
+}
+
+static rdb_expr_t* sql_parse_not(sql_parser_t *parser) {
+    if (sql_token_is_keyword(parser, SQL_KW_NOT)) {
+        if (sql_parser_next_token(parser) != 0) return NULL;
+        return rdb_expr_create_unary(RDB_EXPR_OP_NOT, sql_parse_not(parser));
+    }
+    return sql_parse_comparison(parser);
+}
+
+static rdb_expr_t* sql_parse_and(sql_parser_t *parser) {
+    rdb_expr_t *left = sql_parse_not(parser);
+
+    while (left && sql_token_is_keyword(parser, SQL_KW_AND)) {
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        left = rdb_expr_create_binary(RDB_EXPR_OP_AND, left, sql_parse_not(parser));
+    }
+    return left;
+}
+
+static rdb_expr_t* sql_parse_or_expression(sql_parser_t *parser) {
+    rdb_expr_t *left = sql_parse_and(parser);
+
+    while (left && sql_token_is_keyword(parser, SQL_KW_OR)) {
+        if (sql_parser_next_token(parser) != 0) {
+            rdb_expr_free(left);
+            return NULL;
+        }
+        left = rdb_expr_create_binary(RDB_EXPR_OP_OR, left, sql_parse_and(parser));
+    }
+    return left;
+}
+
+rdb_expr_t* sql_parse_expression(sql_parser_t *parser) {
+    if (!parser) return NULL;
+    return sql_parse_or_expression(parser);
+}
+
+/* Split `expr` at its top-level `op` nodes, appending the operands in
+ * order and freeing the connecting nodes */
+static void sql_expression_split(rdb_expr_t *expr, rdb_expr_op_t op, fi_array *parts) {
+    if (expr->kind == RDB_EXPR_BINARY && expr->op == op) {
+        sql_expression_split(expr->args[0], op, parts);
+        sql_expression_split(expr->args[1], op, parts);
+        free(expr->args);
+        free(expr);
+        return;
+    }
+    if (fi_array_push(parts, &expr) != 0) rdb_expr_free(expr);
+}
+
+/* Fill `condition` from `expr` when it has the flat `column op literal`
+ * form the index planner understands. Takes the literal on success. */
+static bool sql_condition_from_expression(sql_where_condition_t *condition, rdb_expr_t *expr) {
+    if (expr->kind == RDB_EXPR_UNARY && expr->op == RDB_EXPR_OP_IS_NULL &&
+        expr->args[0]->kind == RDB_EXPR_COLUMN) {
+        condition->value = rdb_create_null_value(RDB_TYPE_INT);
+        if (!condition->value) return false;
+        condition->operator = SQL_OP_IS;
+        memcpy(condition->column_name, expr->args[0]->name, sizeof(condition->column_name));
+        return true;
+    }
+
+    if (expr->kind != RDB_EXPR_BINARY) return false;
+
+    rdb_expr_t *column = expr->args[0];
+    rdb_expr_t *literal = expr->args[1];
+    bool swapped = column->kind == RDB_EXPR_LITERAL && literal->kind == RDB_EXPR_COLUMN &&
+                   expr->op != RDB_EXPR_OP_LIKE;
+    if (swapped) {
+        column = expr->args[1];
+        literal = expr->args[0];
+    }
+    if (column->kind != RDB_EXPR_COLUMN || literal->kind != RDB_EXPR_LITERAL) return false;
+
+    switch (expr->op) {
+        case RDB_EXPR_OP_EQ:   condition->operator = SQL_OP_EQUAL; break;
+        case RDB_EXPR_OP_NE:   condition->operator = SQL_OP_NOT_EQUAL; break;
+        case RDB_EXPR_OP_LT:   condition->operator = swapped ? SQL_OP_GREATER_THAN : SQL_OP_LESS_THAN; break;
+        case RDB_EXPR_OP_GT:   condition->operator = swapped ? SQL_OP_LESS_THAN : SQL_OP_GREATER_THAN; break;
+        case RDB_EXPR_OP_LE:   condition->operator = swapped ? SQL_OP_GREATER_EQUAL : SQL_OP_LESS_EQUAL; break;
+        case RDB_EXPR_OP_GE:   condition->operator = swapped ? SQL_OP_LESS_EQUAL : SQL_OP_GREATER_EQUAL; break;
+        case RDB_EXPR_OP_LIKE: condition->operator = SQL_OP_LIKE; break;
+        default:               return false;
+    }
+
+    memcpy(condition->column_name, column->name, sizeof(condition->column_name));
+    condition->value = literal->value;
+    literal->value = NULL;
+    return true;
+}
+
+/* WHERE clause parsing
+ *
+ * The expression is flattened into the OR-of-ANDs condition list the
+ * executor and index planner work with: each `column op literal` factor
+ * becomes a plain condition and anything else is carried in `expr`. */
+int sql_parse_where_clause(sql_parser_t *parser, fi_array *conditions) {
+    if (sql_parser_next_token(parser) != 0) return -1;
+
+    rdb_expr_t *where = sql_parse_expression(parser);
+    if (!where) return -1;
+
+    fi_array *terms = fi_array_create(4, sizeof(rdb_expr_t*));
+    if (!terms) {
+        rdb_expr_free(where);
+        return -1;
+    }
+
+    sql_expression_split(where, RDB_EXPR_OP_OR, terms);
+
+    int result = 0;
+    size_t term_count = fi_array_count(terms);
+    for (size_t i = 0; i < term_count; i++) {
+        rdb_expr_t *term = *(rdb_expr_t**)fi_array_get(terms, i);
+        fi_array *factors = fi_array_create(8, sizeof(rdb_expr_t*));
+        if (!factors) {
+            rdb_expr_free(term);
+            result = -1;
+            continue;
+        }
+        sql_expression_split(term, RDB_EXPR_OP_AND, factors);
+
+        size_t factor_count = fi_array_count(factors);
+        for (size_t j = 0; j < factor_count; j++) {
+            rdb_expr_t *factor = *(rdb_expr_t**)fi_array_get(factors, j);
+            sql_where_condition_t *condition = result == 0 ? calloc(1, sizeof(sql_where_condition_t)) : NULL;
+            if (!condition) {
+                rdb_expr_free(factor);
+                result = -1;
+                continue;
+            }
+
+            if (sql_condition_from_expression(condition, factor)) {
+                rdb_expr_free(factor);
+            } else {
+                condition->expr = factor;
+            }
+
+            const char *connector = j + 1 < factor_count ? "AND" : i + 1 < term_count ? "OR" : "";
+            strcpy(condition->logical_connector, connector);
+
+            if (fi_array_push(conditions, &condition) != 0) {
+                rdb_value_free(condition->value);
+                rdb_expr_free(condition->expr);
+                free(condition);
+                result = -1;
+            }
+        }
+        fi_array_destroy(factors);
+    }
+
+    fi_array_destroy(terms);
+    return result;
+}
+
 /* JOIN clause parsing */
 int sql_parse_join_clause(sql_parser_t *parser, fi_array *join_conditions) {
     rdb_join_condition_t *condition = malloc(sizeof(rdb_join_condition_t));
@@ -1752,7 +2964,7 @@ int sql_parse_join_clause(sql_parser_t *parser, fi_array *join_conditions) {
     }
     
     if (parser->current_token.type != SQL_TOKEN_KEYWORD ||
-        sql_get_keyword(parser->current_token.value) != SQL_KW_ON) {
+        parser->current_token.keyword != SQL_KW_ON) {
         sql_parser_set_error(parser, "Expected ON in JOIN clause");
         free(condition);
         return -1;
@@ -1773,7 +2985,7 @@ int sql_parse_join_type(sql_parser_t *parser, rdb_join_type_t *join_type) {
         return -1;
     }
     
-    sql_keyword_t keyword = sql_get_keyword(parser->current_token.value);
+    sql_keyword_t keyword = parser->current_token.keyword;
     switch (keyword) {
         case SQL_KW_JOIN:
         case SQL_KW_INNER:
@@ -1851,8 +3063,10 @@ int sql_parse_join_condition(sql_parser_t *parser, rdb_join_condition_t *conditi
     return 0;
 }
 
-/* SET clause parsing */
-int sql_parse_set_clause(sql_parser_t *parser, fi_array *columns, fi_array *values) {
+/* SET clause parsing
+ * A literal goes to `values` with a NULL entry in `expressions`; any other
+ * expression goes to `expressions` with a NULL placeholder in `values`. */
+int sql_parse_set_clause(sql_parser_t *parser, fi_array *columns, fi_array *values, fi_array *expressions) {
     while (true) {
         /* Parse column name */
         if (sql_parser_next_token(parser) != 0) return -1;
@@ -1877,17 +3091,30 @@ int sql_parse_set_clause(sql_parser_t *parser, fi_array *columns, fi_array *valu
             return -1;
         }
         
-        /* Parse value */
+        /* Parse value (the expression parser reads one token past it) */
         if (sql_parser_next_token(parser) != 0) return -1;
         
-        rdb_value_t *value = sql_parse_value(parser);
-        if (!value) return -1;
+        rdb_expr_t *expr = sql_parse_expression(parser);
+        if (!expr) return -1;
+        
+        rdb_value_t *value;
+        if (expr->kind == RDB_EXPR_LITERAL) {
+            value = expr->value;
+            expr->value = NULL;
+            rdb_expr_free(expr);
+            expr = NULL;
+        } else if (expressions) {
+            value = rdb_create_null_value(RDB_TYPE_INT);
+        } else {
+            sql_parser_set_error(parser, "Expected value in SET clause");
+            rdb_expr_free(expr);
+            return -1;
+        }
         
         fi_array_push(values, &value);
+        if (expressions) fi_array_push(expressions, &expr);
         
         /* Check for comma */
-        if (sql_parser_next_token(parser) != 0) return -1;
-        
         if (parser->current_token.type == SQL_TOKEN_PUNCTUATION &&
             parser->current_token.value[0] == ',') {
             continue;
@@ -1913,6 +3140,12 @@ int sql_execute_statement(rdb_database_t *db, const rdb_statement_t *stmt) {
         case RDB_STMT_ROLLBACK_TRANSACTION:
             return rdb_rollback_transaction(db);
             
+        case RDB_STMT_VACUUM:
+            return rdb_vacuum(db, stmt->table_name) >= 0 ? 0 : -1;
+            
+        case RDB_STMT_ANALYZE:
+            return rdb_analyze(db, stmt->table_name) >= 0 ? 0 : -1;
+            
         default:
             printf("Error: Unsupported statement type for execution\n");
             return -1;
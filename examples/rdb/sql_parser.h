@@ -15,24 +15,6 @@ typedef enum {
     SQL_TOKEN_UNKNOWN
 } sql_token_type_t;
 
-/* SQL token structure */
-typedef struct {
-    sql_token_type_t type;
-    char *value;
-    size_t length;
-    size_t position;
-} sql_token_t;
-
-/* SQL parser state */
-typedef struct {
-    char *sql;
-    size_t pos;
-    size_t length;
-    sql_token_t current_token;
-    bool has_error;
-    char error_message[256];
-} sql_parser_t;
-
 /* SQL keywords */
 typedef enum {
     SQL_KW_SELECT = 1,
@@ -91,9 +73,45 @@ typedef enum {
     SQL_KW_FALSE,
     SQL_KW_LIKE,
     SQL_KW_IS,
-    SQL_KW_IN
+    SQL_KW_IN,
+    SQL_KW_USING,
+    SQL_KW_DICTIONARY,
+    SQL_KW_VACUUM,
+    SQL_KW_GROUP,
+    SQL_KW_ASC,
+    SQL_KW_DESC,
+    SQL_KW_ANALYZE,
+    SQL_KW_PREPARE,
+    SQL_KW_EXECUTE,
+    SQL_KW_DEALLOCATE,
+    SQL_KW_AS
 } sql_keyword_t;
 
+/* SQL token structure
+ *
+ * A token is a slice of the statement text. `value` points into the
+ * parser's token buffer and stays valid until the next token is read. */
+typedef struct {
+    sql_token_type_t type;
+    sql_keyword_t keyword;      /* Keyword id when type is SQL_TOKEN_KEYWORD, else 0 */
+    char *value;
+    size_t length;
+    size_t position;
+} sql_token_t;
+
+/* SQL parser state */
+typedef struct {
+    char *sql;
+    char *text;                 /* Copy of sql holding the NUL-terminated current token */
+    size_t terminator;          /* Offset in text of the current token's terminator */
+    size_t pos;
+    size_t length;
+    sql_token_t current_token;
+    bool has_error;
+    char error_message[256];
+    fi_array *parameters;       /* rdb_value_t* per ? placeholder, or NULL when ? is not allowed */
+} sql_parser_t;
+
 /* SQL operators */
 typedef enum {
     SQL_OP_EQUAL = 1,
@@ -113,6 +131,7 @@ typedef struct {
     sql_operator_t operator;
     rdb_value_t *value;
     char logical_connector[8]; /* AND, OR */
+    rdb_expr_t *expr;          /* General expression, or NULL for column op value */
 } sql_where_condition_t;
 
 /* Parser functions */
@@ -138,6 +157,11 @@ rdb_statement_t* sql_parse_drop_index(sql_parser_t *parser, rdb_statement_t *stm
 rdb_statement_t* sql_parse_begin_transaction(sql_parser_t *parser);
 rdb_statement_t* sql_parse_commit_transaction(sql_parser_t *parser);
 rdb_statement_t* sql_parse_rollback_transaction(sql_parser_t *parser);
+rdb_statement_t* sql_parse_vacuum(sql_parser_t *parser);
+rdb_statement_t* sql_parse_analyze(sql_parser_t *parser);
+rdb_statement_t* sql_parse_prepare(sql_parser_t *parser);
+rdb_statement_t* sql_parse_execute(sql_parser_t *parser);
+rdb_statement_t* sql_parse_deallocate(sql_parser_t *parser);
 
 /* Helper functions */
 sql_keyword_t sql_get_keyword(const char *keyword);
@@ -153,7 +177,14 @@ int sql_parse_column_definition(sql_parser_t *parser, rdb_column_t *column);
 int sql_parse_column_list(sql_parser_t *parser, fi_array *columns);
 int sql_parse_value_list(sql_parser_t *parser, fi_array *values);
 int sql_parse_where_clause(sql_parser_t *parser, fi_array *conditions);
-int sql_parse_set_clause(sql_parser_t *parser, fi_array *columns, fi_array *values);
+int sql_parse_set_clause(sql_parser_t *parser, fi_array *columns, fi_array *values, fi_array *expressions);
+int sql_parse_select_list(sql_parser_t *parser, fi_array *columns, fi_array *aggregates);
+int sql_parse_group_by_clause(sql_parser_t *parser, fi_array *columns);
+int sql_parse_order_by_clause(sql_parser_t *parser, fi_array *order_by);
+int sql_parse_limit_clause(sql_parser_t *parser, size_t *limit, size_t *offset);
+
+/* Expression parsing */
+rdb_expr_t* sql_parse_expression(sql_parser_t *parser);
 
 /* JOIN parsing */
 int sql_parse_join_clause(sql_parser_t *parser, fi_array *join_conditions);
@@ -177,6 +208,12 @@ rdb_value_t* sql_parse_boolean_value(const char *str);
 /* Statement execution */
 int sql_execute_statement(rdb_database_t *db, const rdb_statement_t *stmt);
 
+/* WHERE evaluation of a single condition against a column value (rdb.c) */
+bool rdb_condition_matches(const rdb_value_t *value, const sql_where_condition_t *cond);
+
+/* Estimated share of rows satisfying a condition, from ANALYZE (rdb_stats.c) */
+double rdb_stats_condition_selectivity(rdb_table_t *table, const sql_where_condition_t *cond);
+
 /* Utility functions */
 void sql_parser_skip_whitespace(sql_parser_t *parser);
 char sql_parser_peek_char(sql_parser_t *parser);
@@ -50,6 +50,7 @@ int main() {
     strcpy(id_col->foreign_table, "");
     strcpy(id_col->foreign_column, "");
     id_col->is_foreign_key = false;
+    id_col->dictionary = false;
     fi_array_push(columns, &id_col);
 
     rdb_column_t *name_col = malloc(sizeof(rdb_column_t));
@@ -63,6 +64,7 @@ int main() {
     strcpy(name_col->foreign_table, "");
     strcpy(name_col->foreign_column, "");
     name_col->is_foreign_key = false;
+    name_col->dictionary = false;
     fi_array_push(columns, &name_col);
 
     rdb_column_t *age_col = malloc(sizeof(rdb_column_t));
@@ -76,6 +78,7 @@ int main() {
     strcpy(age_col->foreign_table, "");
     strcpy(age_col->foreign_column, "");
     age_col->is_foreign_key = false;
+    age_col->dictionary = false;
     fi_array_push(columns, &age_col);
 
     /* Create table */
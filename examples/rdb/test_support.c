@@ -0,0 +1,332 @@
+#include "test_support.h"
+#include <stdarg.h>
+
+rdb_database_t* test_open_database(const char *name) {
+    rdb_database_t *db = rdb_create_database(name);
+    assert(db != NULL);
+    assert(rdb_open_database(db) == 0);
+    return db;
+}
+
+/* printf() into a new string */
+static char* test_format(const char *format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    assert(length >= 0);
+
+    char *sql = malloc((size_t)length + 1);
+    assert(sql != NULL);
+    vsnprintf(sql, (size_t)length + 1, format, args);
+    return sql;
+}
+
+static rdb_statement_t* test_parse(const char *sql) {
+    sql_parser_t *parser = sql_parser_create(sql);
+    assert(parser != NULL);
+
+    rdb_statement_t *stmt = sql_parse_statement(parser);
+    if (!stmt) {
+        printf("Error: Cannot parse '%s': %s\n", sql,
+               sql_parser_has_error(parser) ? sql_parser_get_error(parser) : "unknown error");
+    }
+    sql_parser_destroy(parser);
+    return stmt;
+}
+
+static int test_run(rdb_database_t *db, const rdb_statement_t *stmt) {
+    switch (stmt->type) {
+        case RDB_STMT_CREATE_TABLE: {
+            int result = rdb_create_table_thread_safe(db, stmt->table_name, stmt->columns);
+            if (result == 0 && stmt->storage_mode == RDB_STORAGE_COLUMNAR) {
+                result = rdb_set_table_storage(db, stmt->table_name, RDB_STORAGE_COLUMNAR);
+            }
+            return result;
+        }
+
+        case RDB_STMT_DROP_TABLE:
+            return rdb_drop_table_thread_safe(db, stmt->table_name);
+
+        case RDB_STMT_INSERT:
+            return rdb_insert_row_thread_safe(db, stmt->table_name, stmt->values);
+
+        case RDB_STMT_UPDATE:
+            if (stmt->set_expressions) {
+                return rdb_update_rows_computed_thread_safe(db, stmt->table_name, stmt->columns, stmt->values,
+                                                            stmt->set_expressions, stmt->where_conditions);
+            }
+            return rdb_update_rows_thread_safe(db, stmt->table_name, stmt->columns, stmt->values,
+                                               stmt->where_conditions);
+
+        case RDB_STMT_DELETE:
+            return rdb_delete_rows_thread_safe(db, stmt->table_name, stmt->where_conditions);
+
+        case RDB_STMT_CREATE_INDEX: {
+            const char *index_columns[RDB_MAX_INDEX_COLUMNS];
+            for (size_t i = 0; i < stmt->index_column_count; i++) {
+                index_columns[i] = stmt->index_columns[i];
+            }
+            return rdb_create_index_using(db, stmt->table_name, stmt->index_name,
+                                          index_columns, stmt->index_column_count, stmt->index_kind);
+        }
+
+        case RDB_STMT_DROP_INDEX:
+            return rdb_drop_index(db, stmt->table_name, stmt->index_name);
+
+        default:
+            return sql_execute_statement(db, stmt);
+    }
+}
+
+int test_exec(rdb_database_t *db, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    char *sql = test_format(format, args);
+    va_end(args);
+
+    rdb_statement_t *stmt = test_parse(sql);
+    int result = stmt ? test_run(db, stmt) : -1;
+
+    sql_statement_free(stmt);
+    free(sql);
+    return result;
+}
+
+int test_exec_transactional(rdb_database_t *db, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    char *sql = test_format(format, args);
+    va_end(args);
+
+    rdb_statement_t *stmt = test_parse(sql);
+    int result = -1;
+    if (stmt && stmt->type == RDB_STMT_INSERT) {
+        result = rdb_insert_row_transactional(db, stmt->table_name, stmt->values);
+        if (result == 0) {
+            /* The new row took the values over */
+            fi_array_destroy(stmt->values);
+            stmt->values = NULL;
+        }
+    } else if (stmt && stmt->type == RDB_STMT_UPDATE && stmt->set_expressions) {
+        result = rdb_update_rows_computed(db, stmt->table_name, stmt->columns, stmt->values,
+                                          stmt->set_expressions, stmt->where_conditions);
+    } else if (stmt && stmt->type == RDB_STMT_UPDATE) {
+        result = rdb_update_rows_transactional(db, stmt->table_name, stmt->columns, stmt->values,
+                                               stmt->where_conditions);
+    } else if (stmt && stmt->type == RDB_STMT_DELETE) {
+        result = rdb_delete_rows_transactional(db, stmt->table_name, stmt->where_conditions);
+    } else if (stmt) {
+        printf("Error: Cannot run '%s' in a transaction\n", sql);
+    }
+
+    sql_statement_free(stmt);
+    free(sql);
+    return result;
+}
+
+/* Copy the rows the engine returned into a test result */
+static test_result_t* test_collect(fi_array *rows) {
+    test_result_t *result = calloc(1, sizeof(test_result_t));
+    assert(result != NULL);
+
+    result->rows = fi_array_count(rows);
+    for (size_t r = 0; r < result->rows; r++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, r);
+        if (fi_array_count(row->values) > result->columns) result->columns = fi_array_count(row->values);
+    }
+
+    result->values = calloc(result->rows * result->columns + 1, sizeof(rdb_value_t*));
+    assert(result->values != NULL);
+    for (size_t r = 0; r < result->rows; r++) {
+        rdb_row_t *row = *(rdb_row_t**)fi_array_get(rows, r);
+        for (size_t c = 0; c < fi_array_count(row->values); c++) {
+            const rdb_value_t *value = *(rdb_value_t**)fi_array_get(row->values, c);
+            result->values[r * result->columns + c] = value ? rdb_value_copy(value) : NULL;
+        }
+    }
+    return result;
+}
+
+test_result_t* test_query(rdb_database_t *db, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    char *sql = test_format(format, args);
+    va_end(args);
+
+    rdb_statement_t *stmt = test_parse(sql);
+    test_result_t *result = NULL;
+    if (stmt && stmt->type == RDB_STMT_SELECT) {
+        const char *table_name = stmt->from_tables && fi_array_count(stmt->from_tables) > 0 ?
+                                 *(char**)fi_array_get(stmt->from_tables, 0) : stmt->table_name;
+        bool ordered = stmt->order_by || stmt->limit_value != RDB_NO_LIMIT || stmt->offset_value > 0;
+        if (stmt->aggregates) {
+            /* Aggregate results own their rows and values */
+            fi_array *rows = rdb_select_aggregate_thread_safe(db, table_name, stmt->aggregates,
+                                                              stmt->group_by, stmt->where_conditions);
+            if (rows && ordered) {
+                rows = rdb_aggregate_order(rows, stmt->select_columns, stmt->order_by,
+                                           stmt->limit_value, stmt->offset_value);
+            }
+            if (rows) {
+                result = test_collect(rows);
+                rdb_aggregate_result_free(rows);
+            }
+        } else {
+            fi_array *rows = ordered ?
+                rdb_select_rows_ordered_thread_safe(db, table_name, stmt->select_columns, stmt->where_conditions,
+                                                    stmt->order_by, stmt->limit_value, stmt->offset_value) :
+                rdb_select_rows_thread_safe(db, table_name, stmt->select_columns, stmt->where_conditions);
+            if (rows) {
+                result = test_collect(rows);
+                for (size_t r = 0; r < fi_array_count(rows); r++) {
+                    rdb_row_free(*(rdb_row_t**)fi_array_get(rows, r));
+                }
+                fi_array_destroy(rows);
+            }
+        }
+    }
+
+    sql_statement_free(stmt);
+    free(sql);
+    return result;
+}
+
+void test_result_free(test_result_t *result) {
+    if (!result) return;
+
+    for (size_t i = 0; i < result->rows * result->columns; i++) {
+        rdb_value_free(result->values[i]);
+    }
+    free(result->values);
+    free(result);
+}
+
+const rdb_value_t* test_value(const test_result_t *result, size_t row, size_t column) {
+    assert(result != NULL && row < result->rows && column < result->columns);
+    return result->values[row * result->columns + column];
+}
+
+int64_t test_int(const test_result_t *result, size_t row, size_t column) {
+    const rdb_value_t *value = test_value(result, row, column);
+    assert(value != NULL && !value->is_null && value->type == RDB_TYPE_INT);
+    return value->data.int_val;
+}
+
+bool test_same_value(const rdb_value_t *a, const rdb_value_t *b) {
+    if (!a || !b) return a == b;
+    if (a->is_null || b->is_null) return a->is_null && b->is_null;
+    if (a->type != b->type) return false;
+
+    switch (a->type) {
+        case RDB_TYPE_INT:
+            return a->data.int_val == b->data.int_val;
+        case RDB_TYPE_FLOAT:
+            return memcmp(&a->data.float_val, &b->data.float_val, sizeof(double)) == 0;
+        case RDB_TYPE_BOOLEAN:
+            return a->data.bool_val == b->data.bool_val;
+        default:
+            return strcmp(rdb_get_string_value(a), rdb_get_string_value(b)) == 0;
+    }
+}
+
+bool test_same_result(const test_result_t *a, const test_result_t *b) {
+    if (!a || !b) return a == b;
+    if (a->rows != b->rows || (a->rows > 0 && a->columns != b->columns)) return false;
+
+    for (size_t i = 0; i < a->rows * a->columns; i++) {
+        if (!test_same_value(a->values[i], b->values[i])) return false;
+    }
+    return true;
+}
+
+/* Total order on values for sorting: NULL first, then by type, then by value */
+static int test_compare_values(const rdb_value_t *a, const rdb_value_t *b) {
+    bool a_null = !a || a->is_null, b_null = !b || b->is_null;
+    if (a_null || b_null) return (int)b_null - (int)a_null;
+    if (a->type != b->type) return a->type < b->type ? -1 : 1;
+
+    switch (a->type) {
+        case RDB_TYPE_INT:
+            return (a->data.int_val > b->data.int_val) - (a->data.int_val < b->data.int_val);
+        case RDB_TYPE_FLOAT:
+            return (a->data.float_val > b->data.float_val) - (a->data.float_val < b->data.float_val);
+        case RDB_TYPE_BOOLEAN:
+            return (int)a->data.bool_val - (int)b->data.bool_val;
+        default:
+            return strcmp(rdb_get_string_value(a), rdb_get_string_value(b));
+    }
+}
+
+static int test_compare_rows(const test_result_t *result, size_t a, size_t b) {
+    for (size_t c = 0; c < result->columns; c++) {
+        int cmp = test_compare_values(result->values[a * result->columns + c],
+                                      result->values[b * result->columns + c]);
+        if (cmp != 0) return cmp;
+    }
+    return 0;
+}
+
+void test_sort_result(test_result_t *result) {
+    if (!result || result->rows < 2) return;
+
+    /* Merge sort of row numbers, then one pass to move the values */
+    size_t *order = malloc(result->rows * sizeof(size_t));
+    size_t *merged = malloc(result->rows * sizeof(size_t));
+    assert(order != NULL && merged != NULL);
+    for (size_t r = 0; r < result->rows; r++) order[r] = r;
+
+    for (size_t width = 1; width < result->rows; width *= 2) {
+        for (size_t lo = 0; lo < result->rows; lo += 2 * width) {
+            size_t mid = lo + width < result->rows ? lo + width : result->rows;
+            size_t hi = mid + width < result->rows ? mid + width : result->rows;
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                merged[k++] = test_compare_rows(result, order[j], order[i]) < 0 ? order[j++] : order[i++];
+            }
+            while (i < mid) merged[k++] = order[i++];
+            while (j < hi) merged[k++] = order[j++];
+        }
+        size_t *swap = order;
+        order = merged;
+        merged = swap;
+    }
+
+    rdb_value_t **values = malloc((result->rows * result->columns + 1) * sizeof(rdb_value_t*));
+    assert(values != NULL);
+    for (size_t r = 0; r < result->rows; r++) {
+        memcpy(&values[r * result->columns], &result->values[order[r] * result->columns],
+               result->columns * sizeof(rdb_value_t*));
+    }
+    free(result->values);
+    result->values = values;
+    free(order);
+    free(merged);
+}
+
+static void test_compare_queries(rdb_database_t *db, const char *query, const char *expected_query,
+                                 bool any_order) {
+    test_result_t *result = test_query(db, "%s", query);
+    test_result_t *expected = test_query(db, "%s", expected_query);
+    if (any_order) {
+        test_sort_result(result);
+        test_sort_result(expected);
+    }
+
+    if (!result || !expected || !test_same_result(result, expected)) {
+        printf("Mismatch: '%s' gives %zu rows, '%s' gives %zu rows\n", query, result ? result->rows : 0,
+               expected_query, expected ? expected->rows : 0);
+        fflush(stdout);
+        assert(false);
+    }
+    test_result_free(result);
+    test_result_free(expected);
+}
+
+void test_expect_same(rdb_database_t *db, const char *query, const char *expected_query) {
+    test_compare_queries(db, query, expected_query, false);
+}
+
+void test_expect_same_rows(rdb_database_t *db, const char *query, const char *expected_query) {
+    test_compare_queries(db, query, expected_query, true);
+}
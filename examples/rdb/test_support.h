@@ -0,0 +1,52 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include "rdb.h"
+#include "sql_parser.h"
+#include <assert.h>
+
+/* Helpers shared by the rdb test programs
+ *
+ * Statements are given as SQL text, parsed, and run through the same
+ * thread-safe API calls interactive_sql makes. Query results are copied
+ * out, so a test can keep, compare and free them without knowing how the
+ * engine owns its result rows. */
+
+/* Rows of a query result; every row has `columns` values */
+typedef struct {
+    size_t rows;
+    size_t columns;
+    rdb_value_t **values;       /* rows * columns copies, row after row */
+} test_result_t;
+
+rdb_database_t* test_open_database(const char *name);
+
+/* Run a statement that returns no rows. Returns what the API call
+ * returned, or -1 when the SQL does not parse. */
+int test_exec(rdb_database_t *db, const char *format, ...);
+
+/* The same for INSERT, UPDATE and DELETE, through the transactional API so
+ * the change is logged in the current transaction */
+int test_exec_transactional(rdb_database_t *db, const char *format, ...);
+
+/* Run a SELECT, with or without aggregates, ORDER BY and LIMIT/OFFSET.
+ * Returns NULL on error. */
+test_result_t* test_query(rdb_database_t *db, const char *format, ...);
+void test_result_free(test_result_t *result);
+
+const rdb_value_t* test_value(const test_result_t *result, size_t row, size_t column);
+int64_t test_int(const test_result_t *result, size_t row, size_t column);
+
+/* Same type and value; FLOATs must match to the last bit */
+bool test_same_value(const rdb_value_t *a, const rdb_value_t *b);
+bool test_same_result(const test_result_t *a, const test_result_t *b);
+
+/* Sort the rows of a result by their values, column by column */
+void test_sort_result(test_result_t *result);
+
+/* Run two queries and require identical results, rows in the same order */
+void test_expect_same(rdb_database_t *db, const char *query, const char *expected_query);
+/* Same, but the rows may come back in any order */
+void test_expect_same_rows(rdb_database_t *db, const char *query, const char *expected_query);
+
+#endif /* TEST_SUPPORT_H */
@@ -163,6 +163,7 @@ rdb_column_t* create_column(const char *name, rdb_data_type_t type, bool nullabl
     col->foreign_table[0] = '\0';
     col->foreign_column[0] = '\0';
     col->is_foreign_key = false;
+    col->dictionary = false;
     
     return col;
 }
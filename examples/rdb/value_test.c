@@ -0,0 +1,159 @@
+#include "test_support.h"
+#include "persistence.h"
+
+/* Strings of every length around the inline limit survive creation,
+ * copying, storage in a table and packing into a record */
+
+#define MAX_LENGTH (RDB_VALUE_INLINE_MAX + 20)
+
+/* "abc..." of `length` characters */
+static void make_string(char *buffer, size_t length) {
+    for (size_t i = 0; i < length; i++) buffer[i] = (char)('a' + i % 26);
+    buffer[length] = '\0';
+}
+
+static void check_values(void) {
+    assert(sizeof(rdb_value_t) == 16);
+
+    char text[MAX_LENGTH + 1];
+    for (size_t length = 0; length <= MAX_LENGTH; length++) {
+        make_string(text, length);
+
+        rdb_value_t *value = rdb_create_string_value(text);
+        assert(value != NULL && !value->is_null && value->type == RDB_TYPE_VARCHAR);
+        assert(rdb_get_string_length(value) == length);
+        assert(strcmp(rdb_get_string_value(value), text) == 0);
+        assert((value->str_len == RDB_VALUE_SHARED_STRING) == (length > RDB_VALUE_INLINE_MAX));
+
+        /* A copy of a long string shares its buffer; freeing the original
+         * leaves the copy intact */
+        rdb_value_t *copy = rdb_value_copy(value);
+        assert(copy != NULL && test_same_value(value, copy));
+        assert((rdb_get_string_value(copy) == rdb_get_string_value(value)) == (length > RDB_VALUE_INLINE_MAX));
+        rdb_value_free(value);
+        assert(rdb_get_string_length(copy) == length);
+        assert(strcmp(rdb_get_string_value(copy), text) == 0);
+        rdb_value_free(copy);
+
+        /* Only the first `length` bytes are taken */
+        value = rdb_create_string_value_n("0123456789abcdefghijklmnopqrstuvwxyz", length);
+        assert(rdb_get_string_length(value) == length);
+        assert(strncmp(rdb_get_string_value(value), "0123456789abcdefghijklmnopqrstuvwxyz", length) == 0);
+        assert(rdb_get_string_value(value)[length] == '\0');
+        rdb_value_free(value);
+    }
+
+    rdb_value_t *number = rdb_create_int_value(-42);
+    rdb_value_t *copy = rdb_value_copy(number);
+    assert(copy->type == RDB_TYPE_INT && copy->data.int_val == -42);
+    rdb_value_free(number);
+    rdb_value_free(copy);
+}
+
+static void check_table(rdb_database_t *db) {
+    assert(test_exec(db, "CREATE TABLE words (id INT, word VARCHAR(64), note TEXT)") == 0);
+
+    char text[MAX_LENGTH + 1];
+    for (size_t length = 0; length <= MAX_LENGTH; length++) {
+        make_string(text, length);
+        assert(test_exec(db, "INSERT INTO words VALUES (%zu, '%s', '%s')", length, text, text) == 0);
+    }
+
+    /* Long values replaced by short ones and the other way round */
+    assert(test_exec(db, "UPDATE words SET note = 'short' WHERE id > %d", RDB_VALUE_INLINE_MAX) >= 0);
+    assert(test_exec(db, "UPDATE words SET word = 'a string well past the inline limit' WHERE id < 3") >= 0);
+
+    rdb_table_t *table = rdb_get_table(db, "words");
+    const rdb_record_layout_t *layout = rdb_table_record_layout(table);
+    assert(layout != NULL);
+
+    test_result_t *result = test_query(db, "SELECT * FROM words");
+    assert(result != NULL && result->rows == MAX_LENGTH + 1);
+    for (size_t r = 0; r < result->rows; r++) {
+        size_t length = (size_t)test_int(result, r, 0);
+        make_string(text, length);
+
+        const char *word = length < 3 ? "a string well past the inline limit" : text;
+        const char *note = length > RDB_VALUE_INLINE_MAX ? "short" : text;
+        assert(strcmp(rdb_get_string_value(test_value(result, r, 1)), word) == 0);
+        assert(strcmp(rdb_get_string_value(test_value(result, r, 2)), note) == 0);
+    }
+    test_result_free(result);
+
+    /* Rows pack into records and unpack to the same values */
+    for (size_t i = 0; i < fi_array_count(table->rows); i++) {
+        const rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+        rdb_record_t *record = rdb_record_pack(layout, row);
+        assert(record != NULL);
+
+        size_t length = 0;
+        const rdb_value_t *word = *(rdb_value_t**)fi_array_get(row->values, 1);
+        assert(strcmp(rdb_record_get_string(layout, record, 1, &length), rdb_get_string_value(word)) == 0);
+        assert(length == rdb_get_string_length(word));
+
+        rdb_row_t *unpacked = rdb_record_unpack(layout, record);
+        assert(unpacked != NULL && unpacked->row_id == row->row_id);
+        for (size_t c = 0; c < fi_array_count(row->values); c++) {
+            assert(test_same_value(*(rdb_value_t**)fi_array_get(row->values, c),
+                                   *(rdb_value_t**)fi_array_get(unpacked->values, c)));
+            rdb_value_free(*(rdb_value_t**)fi_array_get(unpacked->values, c));
+        }
+        rdb_row_free(unpacked);
+        free(record);
+    }
+}
+
+/* A dictionary column keeps one entry per distinct string, and its rows
+ * read back the same after a save and reload */
+static void check_dictionary(void) {
+    const char *cities[] = {"Oslo", "Lima", "a city name longer than the inline limit", "Kyiv"};
+    rdb_database_t *db = test_open_database("value_test");
+    assert(test_exec(db, "CREATE TABLE visits (id INT, city VARCHAR(64) DICTIONARY)") == 0);
+    assert(test_exec(db, "CREATE TABLE visits_plain (id INT, city VARCHAR(64))") == 0);
+    for (int i = 0; i < 400; i++) {
+        assert(test_exec(db, "INSERT INTO visits VALUES (%d, '%s')", i, cities[i % 4]) == 0);
+        assert(test_exec(db, "INSERT INTO visits_plain VALUES (%d, '%s')", i, cities[i % 4]) == 0);
+    }
+    assert(test_exec(db, "UPDATE visits SET city = 'Quito' WHERE id < 10") >= 0);
+    assert(test_exec(db, "UPDATE visits_plain SET city = 'Quito' WHERE id < 10") >= 0);
+
+    rdb_string_dict_t *dict = rdb_table_column_dictionary(rdb_get_table(db, "visits"), 1);
+    assert(dict != NULL && rdb_string_dict_count(dict) <= 5);
+    test_expect_same(db, "SELECT * FROM visits", "SELECT * FROM visits_plain");
+    test_expect_same(db, "SELECT * FROM visits WHERE city = 'Lima'", "SELECT * FROM visits_plain WHERE city = 'Lima'");
+
+    system("rm -rf ./value_test_data");
+    rdb_persistence_manager_t *pm = rdb_persistence_create("./value_test_data", RDB_PERSISTENCE_FULL);
+    assert(pm != NULL && rdb_persistence_init(pm) == 0);
+    assert(rdb_persistence_save_database(pm, db) == 0);
+    rdb_destroy_database(db);
+
+    db = rdb_create_database("value_test");
+    assert(db != NULL && rdb_persistence_load_database(pm, db) == 0);
+    assert(rdb_table_column_dictionary(rdb_get_table(db, "visits"), 1) != NULL);
+    test_expect_same(db, "SELECT * FROM visits", "SELECT * FROM visits_plain");
+    test_expect_same(db, "SELECT * FROM visits WHERE city = 'a city name longer than the inline limit'",
+                     "SELECT * FROM visits_plain WHERE city = 'a city name longer than the inline limit'");
+
+    rdb_persistence_destroy(pm);
+    rdb_destroy_database(db);
+    system("rm -rf ./value_test_data");
+}
+
+int main() {
+    printf("=== FI RDB Value Test ===\n\n");
+
+    printf("Checking string values around the inline limit...\n");
+    check_values();
+
+    printf("Checking strings stored in a table...\n");
+    rdb_database_t *db = test_open_database("value_test");
+    check_table(db);
+    rdb_destroy_database(db);
+
+    printf("Checking dictionary-encoded strings...\n");
+    check_dictionary();
+
+    printf("\nValue test PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "test_support.h"
+#include "persistence.h"
+
+#define ROW_COUNT (5 * RDB_ZONE_ROWS + 100)
+#define DATA_DIR "./zone_test_data"
+
+/* Zone maps must never drop a matching row, and must rule out the blocks
+ * an append-ordered column excludes. Every query is counted against a C
+ * model of the table, and its zone map candidates must hold every row the
+ * WHERE clause matches. Column id grows with the row, g cycles and can not
+ * be pruned on. */
+
+typedef struct {
+    int64_t id;
+    bool deleted;
+} model_row_t;
+
+static model_row_t model[ROW_COUNT];
+
+static int g_of(int i) { return i % 50; }
+static double ts_of(int i) { return i * 0.5; }
+
+static bool q_low(int i, int64_t id) { (void)i; return id < 1000; }
+static bool q_range(int i, int64_t id) { (void)i; return id >= 12300 && id < 13000; }
+static bool q_tail(int i, int64_t id) { (void)id; return ts_of(i) > 10240.0; }
+static bool q_either(int i, int64_t id) { (void)i; return id < 100 || id > 20500; }
+static bool q_in(int i, int64_t id) { (void)i; return id == 5 || id == 15000; }
+static bool q_and_g(int i, int64_t id) { return g_of(i) == 7 && id >= 4096 && id < 8192; }
+static bool q_g(int i, int64_t id) { (void)id; return g_of(i) == 7; }
+static bool q_none(int i, int64_t id) { (void)i; (void)id; return false; }
+static bool q_moved(int i, int64_t id) { (void)i; return id > 100000; }
+
+static const struct {
+    const char *where;
+    bool (*expected)(int i, int64_t id);
+    size_t max_candidates;      /* Candidates allowed on the freshly loaded table */
+} queries[] = {
+    {"id < 1000", q_low, RDB_ZONE_ROWS},
+    {"id >= 12300 AND id < 13000", q_range, RDB_ZONE_ROWS},
+    {"ts > 10240.0", q_tail, RDB_ZONE_ROWS},
+    {"id < 100 OR id > 20500", q_either, 2 * RDB_ZONE_ROWS},
+    {"id IN (5, 15000)", q_in, 2 * RDB_ZONE_ROWS},
+    {"g = 7 AND id >= 4096 AND id < 8192", q_and_g, RDB_ZONE_ROWS},
+    {"g = 7", q_g, ROW_COUNT},
+    {"g IS NULL", q_none, 0},
+    {"id > 100000", q_moved, 0},
+};
+
+/* Candidates of the WHERE clause hold every matching row; returns their
+ * number, or the row count when the zone maps give none */
+static size_t check_candidates(rdb_table_t *table, const char *where) {
+    char sql[256];
+    snprintf(sql, sizeof(sql), "SELECT * FROM z WHERE %s", where);
+    sql_parser_t *parser = sql_parser_create(sql);
+    assert(parser != NULL);
+    rdb_statement_t *stmt = sql_parse_statement(parser);
+    assert(stmt != NULL && stmt->where_conditions != NULL);
+
+    fi_array *candidates = rdb_zone_map_candidates(table, stmt->where_conditions);
+    size_t count = candidates ? fi_array_count(candidates) : fi_array_count(table->rows);
+    if (candidates) {
+        size_t c = 0;
+        for (size_t i = 0; i < fi_array_count(table->rows); i++) {
+            rdb_row_t *row = *(rdb_row_t**)fi_array_get(table->rows, i);
+            if (c < count && *(rdb_row_t**)fi_array_get(candidates, c) == row) {
+                c++;
+                continue;
+            }
+            if (!row->deleted && rdb_row_matches_conditions(table, row, stmt->where_conditions)) {
+                printf("Row %zu of '%s' was ruled out\n", row->row_id, where);
+                fflush(stdout);
+                assert(false);
+            }
+        }
+        assert(c == count);
+        fi_array_destroy(candidates);
+    }
+
+    sql_statement_free(stmt);
+    sql_parser_destroy(parser);
+    return count;
+}
+
+static void check_queries(rdb_database_t *db, bool pruned) {
+    rdb_table_t *table = rdb_get_table(db, "z");
+    assert(table != NULL && table->zones != NULL);
+
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+        int64_t expected = 0;
+        for (int i = 0; i < ROW_COUNT; i++) {
+            expected += !model[i].deleted && queries[q].expected(i, model[i].id);
+        }
+
+        test_result_t *result = test_query(db, "SELECT COUNT(*) FROM z WHERE %s", queries[q].where);
+        assert(result != NULL && result->rows == 1);
+        if (test_int(result, 0, 0) != expected) {
+            printf("'%s' counted %lld rows, expected %lld\n", queries[q].where,
+                   (long long)test_int(result, 0, 0), (long long)expected);
+            fflush(stdout);
+            assert(false);
+        }
+        test_result_free(result);
+
+        size_t candidates = check_candidates(table, queries[q].where);
+        if (pruned) assert(candidates <= queries[q].max_candidates);
+    }
+}
+
+int main() {
+    printf("=== FI RDB Zone Map Test ===\n\n");
+
+    rdb_database_t *db = test_open_database("zone_test");
+    assert(test_exec(db, "CREATE TABLE z (id INT, ts FLOAT, g INT, s VARCHAR(8))") == 0);
+    for (int i = 0; i < ROW_COUNT; i++) {
+        model[i].id = i;
+        assert(test_exec(db, "INSERT INTO z VALUES (%d, %.1f, %d, 's%d')", i, ts_of(i), g_of(i), i % 7) == 0);
+    }
+
+    printf("Checking block skipping...\n");
+    check_queries(db, true);
+
+    /* A value moved out of its block's range widens it */
+    printf("Checking updates and deletes...\n");
+    assert(test_exec(db, "UPDATE z SET id = id + 100000 WHERE id = 10") == 1);
+    model[10].id += 100000;
+    assert(test_exec(db, "DELETE FROM z WHERE id >= 4000 AND id < 9000") > 0);
+    for (int i = 4000; i < 9000; i++) model[i].deleted = true;
+    check_queries(db, false);
+
+    /* Compaction rebuilds the maps exactly */
+    assert(rdb_vacuum(db, "z") >= 0);
+    check_queries(db, false);
+
+    /* The maps are saved with the table */
+    printf("Checking persistence...\n");
+    system("rm -rf " DATA_DIR);
+    rdb_persistence_manager_t *pm = rdb_persistence_create(DATA_DIR, RDB_PERSISTENCE_FULL);
+    assert(pm != NULL);
+    assert(rdb_persistence_init(pm) == 0);
+    assert(rdb_persistence_save_database(pm, db) == 0);
+    rdb_destroy_database(db);
+
+    db = rdb_create_database("zone_test");
+    assert(db != NULL);
+    assert(rdb_persistence_load_database(pm, db) == 0);
+    check_queries(db, false);
+    assert(check_candidates(rdb_get_table(db, "z"), "id < 1000") <= RDB_ZONE_ROWS);
+
+    rdb_persistence_destroy(pm);
+    rdb_destroy_database(db);
+    system("rm -rf " DATA_DIR);
+
+    printf("\nZone map test PASSED!\n");
+    return 0;
+}
@@ -58,8 +58,8 @@ int main() {
     fi_btree_node *min_node = fi_btree_find_min(tree->root);
     fi_btree_node *max_node = fi_btree_find_max(tree->root);
     
-    if (min_node) printf("Min: %d\n", *(int*)min_node->data);
-    if (max_node) printf("Max: %d\n", *(int*)max_node->data);
+    if (min_node) printf("Min: %d\n", *(int*)FI_BTREE_NODE_DATA(min_node));
+    if (max_node) printf("Max: %d\n", *(int*)FI_BTREE_NODE_DATA(max_node));
     
     // Test deletion
     printf("Deleting 5...\n");
@@ -0,0 +1,779 @@
+#include "fi_art.h"
+
+/* Node layouts
+ *
+ * Node4/Node16 keep parallel sorted key and child arrays, Node48 maps each
+ * byte to a slot in a 48-entry child array, Node256 indexes its children by
+ * byte directly. Children are either inner nodes or leaves; leaves are
+ * tagged in the low pointer bit. */
+typedef struct {
+    fi_art_node n;
+    uint8_t keys[4];
+    void *children[4];
+} fi_art_node4;
+
+typedef struct {
+    fi_art_node n;
+    uint8_t keys[16];
+    void *children[16];
+} fi_art_node16;
+
+typedef struct {
+    fi_art_node n;
+    uint8_t child_index[256];      /* Slot + 1, or 0 when the byte has no child */
+    void *children[48];
+} fi_art_node48;
+
+typedef struct {
+    fi_art_node n;
+    void *children[256];
+} fi_art_node256;
+
+#define FI_ART_IS_LEAF(p) (((uintptr_t)(p)) & 1)
+#define FI_ART_LEAF_TAG(l) ((void*)((uintptr_t)(l) | 1))
+#define FI_ART_LEAF_UNTAG(p) ((fi_art_leaf*)((uintptr_t)(p) & ~(uintptr_t)1))
+
+/* Iteration state */
+typedef struct {
+    fi_art *tree;
+    fi_art_visit_func visit;
+    void *user_data;
+    size_t visited;
+} fi_art_iterator;
+
+/* Static function declarations */
+static void fi_art_destroy_recursive(void *node);
+static int fi_art_insert_recursive(fi_art *tree, void **ref, const uint8_t *key, size_t key_length,
+                                   size_t depth, const void *value);
+static int fi_art_delete_recursive(fi_art *tree, void **ref, const uint8_t *key, size_t key_length,
+                                   size_t depth);
+static bool fi_art_iterate_recursive(fi_art_iterator *it, void *node);
+
+static size_t fi_art_min(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+/* Leaf helpers */
+static uint8_t* fi_art_leaf_key(fi_art *tree, fi_art_leaf *leaf) {
+    return (uint8_t*)FI_ART_LEAF_VALUE(leaf) + tree->value_size;
+}
+
+static fi_art_leaf* fi_art_leaf_create(fi_art *tree, const uint8_t *key, size_t key_length, const void *value) {
+    fi_art_leaf *leaf = malloc(sizeof(fi_art_leaf) + tree->value_size + key_length);
+    if (!leaf) return NULL;
+
+    leaf->key_length = key_length;
+    if (value) {
+        memcpy(FI_ART_LEAF_VALUE(leaf), value, tree->value_size);
+    } else {
+        memset(FI_ART_LEAF_VALUE(leaf), 0, tree->value_size);
+    }
+    if (key_length) {
+        memcpy(fi_art_leaf_key(tree, leaf), key, key_length);
+    }
+    return leaf;
+}
+
+static bool fi_art_leaf_matches(fi_art *tree, fi_art_leaf *leaf, const uint8_t *key, size_t key_length) {
+    return leaf->key_length == key_length &&
+           (key_length == 0 || memcmp(fi_art_leaf_key(tree, leaf), key, key_length) == 0);
+}
+
+/* Node allocation */
+static fi_art_node* fi_art_node_create(uint8_t type) {
+    size_t size;
+    switch (type) {
+        case FI_ART_NODE4:   size = sizeof(fi_art_node4); break;
+        case FI_ART_NODE16:  size = sizeof(fi_art_node16); break;
+        case FI_ART_NODE48:  size = sizeof(fi_art_node48); break;
+        case FI_ART_NODE256: size = sizeof(fi_art_node256); break;
+        default: return NULL;
+    }
+
+    fi_art_node *node = calloc(1, size);
+    if (node) node->type = type;
+    return node;
+}
+
+static void fi_art_copy_header(fi_art_node *dest, const fi_art_node *src) {
+    dest->child_count = src->child_count;
+    dest->prefix_length = src->prefix_length;
+    memcpy(dest->prefix, src->prefix, fi_art_min(src->prefix_length, FI_ART_MAX_PREFIX));
+    dest->leaf = src->leaf;
+}
+
+/* Child slot for a key byte, or NULL */
+static void** fi_art_find_child(fi_art_node *node, uint8_t byte) {
+    switch (node->type) {
+        case FI_ART_NODE4: {
+            fi_art_node4 *n = (fi_art_node4*)node;
+            for (int i = 0; i < node->child_count; i++) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return NULL;
+        }
+        case FI_ART_NODE16: {
+            fi_art_node16 *n = (fi_art_node16*)node;
+            for (int i = 0; i < node->child_count; i++) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return NULL;
+        }
+        case FI_ART_NODE48: {
+            fi_art_node48 *n = (fi_art_node48*)node;
+            uint8_t slot = n->child_index[byte];
+            return slot ? &n->children[slot - 1] : NULL;
+        }
+        case FI_ART_NODE256: {
+            fi_art_node256 *n = (fi_art_node256*)node;
+            return n->children[byte] ? &n->children[byte] : NULL;
+        }
+    }
+    return NULL;
+}
+
+/* Leftmost leaf below a node (the shortest, smallest key) */
+static fi_art_leaf* fi_art_minimum(void *node) {
+    while (node && !FI_ART_IS_LEAF(node)) {
+        fi_art_node *n = (fi_art_node*)node;
+        if (n->leaf) return n->leaf;
+
+        switch (n->type) {
+            case FI_ART_NODE4:
+                node = ((fi_art_node4*)n)->children[0];
+                break;
+            case FI_ART_NODE16:
+                node = ((fi_art_node16*)n)->children[0];
+                break;
+            case FI_ART_NODE48: {
+                fi_art_node48 *n48 = (fi_art_node48*)n;
+                int i = 0;
+                while (!n48->child_index[i]) i++;
+                node = n48->children[n48->child_index[i] - 1];
+                break;
+            }
+            case FI_ART_NODE256: {
+                fi_art_node256 *n256 = (fi_art_node256*)n;
+                int i = 0;
+                while (!n256->children[i]) i++;
+                node = n256->children[i];
+                break;
+            }
+            default:
+                return NULL;
+        }
+    }
+    return node ? FI_ART_LEAF_UNTAG(node) : NULL;
+}
+
+/* Number of leading bytes of the compressed path that match the key,
+ * checking only the bytes stored in the node (optimistic) */
+static size_t fi_art_check_prefix(const fi_art_node *node, const uint8_t *key, size_t key_length, size_t depth) {
+    size_t limit = fi_art_min(fi_art_min(node->prefix_length, FI_ART_MAX_PREFIX), key_length - depth);
+    size_t i = 0;
+    while (i < limit && node->prefix[i] == key[depth + i]) {
+        i++;
+    }
+    return i;
+}
+
+/* Index of the first byte where the key leaves the compressed path. Bytes
+ * beyond the stored part of the path are read from a leaf below the node. */
+static size_t fi_art_prefix_mismatch(fi_art *tree, fi_art_node *node, const uint8_t *key,
+                                     size_t key_length, size_t depth) {
+    size_t limit = fi_art_min(fi_art_min(node->prefix_length, FI_ART_MAX_PREFIX), key_length - depth);
+    size_t i = 0;
+    while (i < limit) {
+        if (node->prefix[i] != key[depth + i]) return i;
+        i++;
+    }
+
+    if (node->prefix_length > FI_ART_MAX_PREFIX) {
+        fi_art_leaf *leaf = fi_art_minimum(node);
+        const uint8_t *leaf_key = fi_art_leaf_key(tree, leaf);
+        limit = fi_art_min(node->prefix_length, key_length - depth);
+        while (i < limit) {
+            if (leaf_key[depth + i] != key[depth + i]) return i;
+            i++;
+        }
+    }
+    return i;
+}
+
+/* Add a child, growing the node into the next size when it is full */
+static int fi_art_add_child(void **ref, fi_art_node *node, uint8_t byte, void *child) {
+    switch (node->type) {
+        case FI_ART_NODE4: {
+            fi_art_node4 *n = (fi_art_node4*)node;
+            if (node->child_count < 4) {
+                int pos = 0;
+                while (pos < node->child_count && n->keys[pos] < byte) pos++;
+                memmove(n->keys + pos + 1, n->keys + pos, node->child_count - pos);
+                memmove(n->children + pos + 1, n->children + pos, (node->child_count - pos) * sizeof(void*));
+                n->keys[pos] = byte;
+                n->children[pos] = child;
+                node->child_count++;
+                return 0;
+            }
+
+            fi_art_node16 *grown = (fi_art_node16*)fi_art_node_create(FI_ART_NODE16);
+            if (!grown) return -1;
+            fi_art_copy_header(&grown->n, node);
+            memcpy(grown->keys, n->keys, 4);
+            memcpy(grown->children, n->children, 4 * sizeof(void*));
+            *ref = grown;
+            free(node);
+            return fi_art_add_child(ref, &grown->n, byte, child);
+        }
+
+        case FI_ART_NODE16: {
+            fi_art_node16 *n = (fi_art_node16*)node;
+            if (node->child_count < 16) {
+                int pos = 0;
+                while (pos < node->child_count && n->keys[pos] < byte) pos++;
+                memmove(n->keys + pos + 1, n->keys + pos, node->child_count - pos);
+                memmove(n->children + pos + 1, n->children + pos, (node->child_count - pos) * sizeof(void*));
+                n->keys[pos] = byte;
+                n->children[pos] = child;
+                node->child_count++;
+                return 0;
+            }
+
+            fi_art_node48 *grown = (fi_art_node48*)fi_art_node_create(FI_ART_NODE48);
+            if (!grown) return -1;
+            fi_art_copy_header(&grown->n, node);
+            for (int i = 0; i < 16; i++) {
+                grown->children[i] = n->children[i];
+                grown->child_index[n->keys[i]] = (uint8_t)(i + 1);
+            }
+            *ref = grown;
+            free(node);
+            return fi_art_add_child(ref, &grown->n, byte, child);
+        }
+
+        case FI_ART_NODE48: {
+            fi_art_node48 *n = (fi_art_node48*)node;
+            if (node->child_count < 48) {
+                int slot = 0;
+                while (n->children[slot]) slot++;
+                n->children[slot] = child;
+                n->child_index[byte] = (uint8_t)(slot + 1);
+                node->child_count++;
+                return 0;
+            }
+
+            fi_art_node256 *grown = (fi_art_node256*)fi_art_node_create(FI_ART_NODE256);
+            if (!grown) return -1;
+            fi_art_copy_header(&grown->n, node);
+            for (int i = 0; i < 256; i++) {
+                if (n->child_index[i]) {
+                    grown->children[i] = n->children[n->child_index[i] - 1];
+                }
+            }
+            *ref = grown;
+            free(node);
+            return fi_art_add_child(ref, &grown->n, byte, child);
+        }
+
+        case FI_ART_NODE256: {
+            fi_art_node256 *n = (fi_art_node256*)node;
+            n->children[byte] = child;
+            node->child_count++;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Remove the child for a key byte, shrinking the node when it gets sparse */
+static void fi_art_remove_child(void **ref, fi_art_node *node, uint8_t byte) {
+    switch (node->type) {
+        case FI_ART_NODE4: {
+            fi_art_node4 *n = (fi_art_node4*)node;
+            int pos = 0;
+            while (pos < node->child_count && n->keys[pos] != byte) pos++;
+            if (pos == node->child_count) return;
+            memmove(n->keys + pos, n->keys + pos + 1, node->child_count - pos - 1);
+            memmove(n->children + pos, n->children + pos + 1, (node->child_count - pos - 1) * sizeof(void*));
+            node->child_count--;
+            return;
+        }
+
+        case FI_ART_NODE16: {
+            fi_art_node16 *n = (fi_art_node16*)node;
+            int pos = 0;
+            while (pos < node->child_count && n->keys[pos] != byte) pos++;
+            if (pos == node->child_count) return;
+            memmove(n->keys + pos, n->keys + pos + 1, node->child_count - pos - 1);
+            memmove(n->children + pos, n->children + pos + 1, (node->child_count - pos - 1) * sizeof(void*));
+            node->child_count--;
+
+            if (node->child_count == 3) {
+                fi_art_node4 *shrunk = (fi_art_node4*)fi_art_node_create(FI_ART_NODE4);
+                if (!shrunk) return;
+                fi_art_copy_header(&shrunk->n, node);
+                memcpy(shrunk->keys, n->keys, 3);
+                memcpy(shrunk->children, n->children, 3 * sizeof(void*));
+                *ref = shrunk;
+                free(node);
+            }
+            return;
+        }
+
+        case FI_ART_NODE48: {
+            fi_art_node48 *n = (fi_art_node48*)node;
+            uint8_t slot = n->child_index[byte];
+            if (!slot) return;
+            n->children[slot - 1] = NULL;
+            n->child_index[byte] = 0;
+            node->child_count--;
+
+            if (node->child_count == 12) {
+                fi_art_node16 *shrunk = (fi_art_node16*)fi_art_node_create(FI_ART_NODE16);
+                if (!shrunk) return;
+                fi_art_copy_header(&shrunk->n, node);
+                int pos = 0;
+                for (int i = 0; i < 256; i++) {
+                    if (n->child_index[i]) {
+                        shrunk->keys[pos] = (uint8_t)i;
+                        shrunk->children[pos++] = n->children[n->child_index[i] - 1];
+                    }
+                }
+                *ref = shrunk;
+                free(node);
+            }
+            return;
+        }
+
+        case FI_ART_NODE256: {
+            fi_art_node256 *n = (fi_art_node256*)node;
+            if (!n->children[byte]) return;
+            n->children[byte] = NULL;
+            node->child_count--;
+
+            if (node->child_count == 37) {
+                fi_art_node48 *shrunk = (fi_art_node48*)fi_art_node_create(FI_ART_NODE48);
+                if (!shrunk) return;
+                fi_art_copy_header(&shrunk->n, node);
+                int slot = 0;
+                for (int i = 0; i < 256; i++) {
+                    if (n->children[i]) {
+                        shrunk->children[slot] = n->children[i];
+                        shrunk->child_index[i] = (uint8_t)(slot + 1);
+                        slot++;
+                    }
+                }
+                *ref = shrunk;
+                free(node);
+            }
+            return;
+        }
+    }
+}
+
+/* Collapse a node that no longer needs to branch: a node left with only its
+ * own leaf becomes that leaf, and a node with a single child and no leaf is
+ * merged into the child's compressed path. */
+static void fi_art_compact(void **ref) {
+    fi_art_node *node = (fi_art_node*)*ref;
+    if (node->type != FI_ART_NODE4) return;
+    fi_art_node4 *n = (fi_art_node4*)node;
+
+    if (node->child_count == 0) {
+        *ref = node->leaf ? FI_ART_LEAF_TAG(node->leaf) : NULL;
+        free(node);
+        return;
+    }
+
+    if (node->child_count != 1 || node->leaf) return;
+
+    void *child = n->children[0];
+    if (!FI_ART_IS_LEAF(child)) {
+        /* Path becomes: node prefix + branch byte + child prefix */
+        fi_art_node *c = (fi_art_node*)child;
+        size_t length = node->prefix_length;
+        if (length < FI_ART_MAX_PREFIX) {
+            node->prefix[length] = n->keys[0];
+            length++;
+        }
+        if (length < FI_ART_MAX_PREFIX) {
+            size_t take = fi_art_min(c->prefix_length, FI_ART_MAX_PREFIX - length);
+            memcpy(node->prefix + length, c->prefix, take);
+            length += take;
+        }
+        memcpy(c->prefix, node->prefix, fi_art_min(length, FI_ART_MAX_PREFIX));
+        c->prefix_length += node->prefix_length + 1;
+    }
+    *ref = child;
+    free(node);
+}
+
+/* Tree creation and destruction */
+fi_art* fi_art_create(size_t value_size) {
+    fi_art *tree = malloc(sizeof(fi_art));
+    if (!tree) return NULL;
+
+    tree->root = NULL;
+    tree->count = 0;
+    tree->value_size = value_size;
+    return tree;
+}
+
+static void fi_art_destroy_recursive(void *node) {
+    if (!node) return;
+    if (FI_ART_IS_LEAF(node)) {
+        free(FI_ART_LEAF_UNTAG(node));
+        return;
+    }
+
+    fi_art_node *n = (fi_art_node*)node;
+    free(n->leaf);
+
+    switch (n->type) {
+        case FI_ART_NODE4:
+            for (int i = 0; i < n->child_count; i++) {
+                fi_art_destroy_recursive(((fi_art_node4*)n)->children[i]);
+            }
+            break;
+        case FI_ART_NODE16:
+            for (int i = 0; i < n->child_count; i++) {
+                fi_art_destroy_recursive(((fi_art_node16*)n)->children[i]);
+            }
+            break;
+        case FI_ART_NODE48:
+            for (int i = 0; i < 48; i++) {
+                fi_art_destroy_recursive(((fi_art_node48*)n)->children[i]);
+            }
+            break;
+        case FI_ART_NODE256:
+            for (int i = 0; i < 256; i++) {
+                fi_art_destroy_recursive(((fi_art_node256*)n)->children[i]);
+            }
+            break;
+    }
+    free(n);
+}
+
+void fi_art_destroy(fi_art *tree) {
+    if (!tree) return;
+    fi_art_destroy_recursive(tree->root);
+    free(tree);
+}
+
+void fi_art_clear(fi_art *tree) {
+    if (!tree) return;
+    fi_art_destroy_recursive(tree->root);
+    tree->root = NULL;
+    tree->count = 0;
+}
+
+/* Insertion. Returns 1 for a new key, 0 for a replaced value, -1 on error. */
+static int fi_art_insert_recursive(fi_art *tree, void **ref, const uint8_t *key, size_t key_length,
+                                   size_t depth, const void *value) {
+    void *node = *ref;
+
+    if (!node) {
+        fi_art_leaf *leaf = fi_art_leaf_create(tree, key, key_length, value);
+        if (!leaf) return -1;
+        *ref = FI_ART_LEAF_TAG(leaf);
+        return 1;
+    }
+
+    if (FI_ART_IS_LEAF(node)) {
+        fi_art_leaf *existing = FI_ART_LEAF_UNTAG(node);
+        if (fi_art_leaf_matches(tree, existing, key, key_length)) {
+            memcpy(FI_ART_LEAF_VALUE(existing), value, tree->value_size);
+            return 0;
+        }
+
+        /* Split the leaf: a new node holds the common part of both keys */
+        const uint8_t *existing_key = fi_art_leaf_key(tree, existing);
+        size_t limit = fi_art_min(existing->key_length, key_length);
+        size_t common = depth;
+        while (common < limit && existing_key[common] == key[common]) {
+            common++;
+        }
+
+        fi_art_node *split = fi_art_node_create(FI_ART_NODE4);
+        fi_art_leaf *leaf = fi_art_leaf_create(tree, key, key_length, value);
+        if (!split || !leaf) {
+            free(split);
+            free(leaf);
+            return -1;
+        }
+        split->prefix_length = (uint32_t)(common - depth);
+        memcpy(split->prefix, key + depth, fi_art_min(common - depth, FI_ART_MAX_PREFIX));
+
+        if (existing->key_length == common) {
+            split->leaf = existing;
+        } else {
+            fi_art_add_child(NULL, split, existing_key[common], node);
+        }
+        if (key_length == common) {
+            split->leaf = leaf;
+        } else {
+            fi_art_add_child(NULL, split, key[common], FI_ART_LEAF_TAG(leaf));
+        }
+        *ref = split;
+        return 1;
+    }
+
+    fi_art_node *n = (fi_art_node*)node;
+    if (n->prefix_length) {
+        size_t mismatch = fi_art_prefix_mismatch(tree, n, key, key_length, depth);
+        if (mismatch < n->prefix_length) {
+            /* The key leaves the compressed path: split the path */
+            fi_art_node *split = fi_art_node_create(FI_ART_NODE4);
+            fi_art_leaf *leaf = fi_art_leaf_create(tree, key, key_length, value);
+            if (!split || !leaf) {
+                free(split);
+                free(leaf);
+                return -1;
+            }
+            split->prefix_length = (uint32_t)mismatch;
+            memcpy(split->prefix, n->prefix, fi_art_min(mismatch, FI_ART_MAX_PREFIX));
+
+            /* The old node keeps the path after the branch byte */
+            if (n->prefix_length <= FI_ART_MAX_PREFIX) {
+                fi_art_add_child(NULL, split, n->prefix[mismatch], n);
+                n->prefix_length -= (uint32_t)(mismatch + 1);
+                memmove(n->prefix, n->prefix + mismatch + 1, fi_art_min(n->prefix_length, FI_ART_MAX_PREFIX));
+            } else {
+                const uint8_t *path = fi_art_leaf_key(tree, fi_art_minimum(n)) + depth;
+                fi_art_add_child(NULL, split, path[mismatch], n);
+                n->prefix_length -= (uint32_t)(mismatch + 1);
+                memcpy(n->prefix, path + mismatch + 1, fi_art_min(n->prefix_length, FI_ART_MAX_PREFIX));
+            }
+
+            if (key_length == depth + mismatch) {
+                split->leaf = leaf;
+            } else {
+                fi_art_add_child(NULL, split, key[depth + mismatch], FI_ART_LEAF_TAG(leaf));
+            }
+            *ref = split;
+            return 1;
+        }
+        depth += n->prefix_length;
+    }
+
+    if (depth == key_length) {
+        if (n->leaf) {
+            memcpy(FI_ART_LEAF_VALUE(n->leaf), value, tree->value_size);
+            return 0;
+        }
+        n->leaf = fi_art_leaf_create(tree, key, key_length, value);
+        return n->leaf ? 1 : -1;
+    }
+
+    void **child = fi_art_find_child(n, key[depth]);
+    if (child) {
+        return fi_art_insert_recursive(tree, child, key, key_length, depth + 1, value);
+    }
+
+    fi_art_leaf *leaf = fi_art_leaf_create(tree, key, key_length, value);
+    if (!leaf) return -1;
+    if (fi_art_add_child(ref, n, key[depth], FI_ART_LEAF_TAG(leaf)) != 0) {
+        free(leaf);
+        return -1;
+    }
+    return 1;
+}
+
+int fi_art_insert(fi_art *tree, const uint8_t *key, size_t key_length, const void *value) {
+    if (!tree || (!key && key_length)) return -1;
+
+    int result = fi_art_insert_recursive(tree, &tree->root, key, key_length, 0, value);
+    if (result < 0) return -1;
+    if (result > 0) tree->count++;
+    return 0;
+}
+
+/* Deletion */
+static int fi_art_delete_recursive(fi_art *tree, void **ref, const uint8_t *key, size_t key_length,
+                                   size_t depth) {
+    void *node = *ref;
+    if (!node) return -1;
+
+    if (FI_ART_IS_LEAF(node)) {
+        fi_art_leaf *leaf = FI_ART_LEAF_UNTAG(node);
+        if (!fi_art_leaf_matches(tree, leaf, key, key_length)) return -1;
+        free(leaf);
+        *ref = NULL;
+        return 0;
+    }
+
+    fi_art_node *n = (fi_art_node*)node;
+    if (n->prefix_length) {
+        if (fi_art_check_prefix(n, key, key_length, depth) != fi_art_min(n->prefix_length, FI_ART_MAX_PREFIX)) {
+            return -1;
+        }
+        depth += n->prefix_length;
+    }
+    if (depth > key_length) return -1;
+
+    if (depth == key_length) {
+        if (!n->leaf || !fi_art_leaf_matches(tree, n->leaf, key, key_length)) return -1;
+        free(n->leaf);
+        n->leaf = NULL;
+        fi_art_compact(ref);
+        return 0;
+    }
+
+    uint8_t byte = key[depth];
+    void **child = fi_art_find_child(n, byte);
+    if (!child) return -1;
+
+    if (fi_art_delete_recursive(tree, child, key, key_length, depth + 1) != 0) return -1;
+
+    if (!*child) {
+        fi_art_remove_child(ref, n, byte);
+        fi_art_compact(ref);
+    }
+    return 0;
+}
+
+int fi_art_delete(fi_art *tree, const uint8_t *key, size_t key_length) {
+    if (!tree || (!key && key_length)) return -1;
+
+    if (fi_art_delete_recursive(tree, &tree->root, key, key_length, 0) != 0) return -1;
+    tree->count--;
+    return 0;
+}
+
+/* Search: compare the path optimistically and verify the full key at the leaf */
+void* fi_art_search(fi_art *tree, const uint8_t *key, size_t key_length) {
+    if (!tree || (!key && key_length)) return NULL;
+
+    void *node = tree->root;
+    size_t depth = 0;
+
+    while (node) {
+        if (FI_ART_IS_LEAF(node)) {
+            fi_art_leaf *leaf = FI_ART_LEAF_UNTAG(node);
+            return fi_art_leaf_matches(tree, leaf, key, key_length) ? FI_ART_LEAF_VALUE(leaf) : NULL;
+        }
+
+        fi_art_node *n = (fi_art_node*)node;
+        if (n->prefix_length) {
+            if (depth + n->prefix_length > key_length ||
+                fi_art_check_prefix(n, key, key_length, depth) != fi_art_min(n->prefix_length, FI_ART_MAX_PREFIX)) {
+                return NULL;
+            }
+            depth += n->prefix_length;
+        }
+
+        if (depth == key_length) {
+            return n->leaf && fi_art_leaf_matches(tree, n->leaf, key, key_length) ?
+                   FI_ART_LEAF_VALUE(n->leaf) : NULL;
+        }
+
+        void **child = fi_art_find_child(n, key[depth]);
+        node = child ? *child : NULL;
+        depth++;
+    }
+    return NULL;
+}
+
+bool fi_art_contains(fi_art *tree, const uint8_t *key, size_t key_length) {
+    return fi_art_search(tree, key, key_length) != NULL;
+}
+
+size_t fi_art_size(fi_art *tree) {
+    return tree ? tree->count : 0;
+}
+
+bool fi_art_empty(fi_art *tree) {
+    return !tree || tree->count == 0;
+}
+
+/* Iteration in key order: a node's own leaf comes before its children */
+static bool fi_art_iterate_recursive(fi_art_iterator *it, void *node) {
+    if (!node) return true;
+
+    if (FI_ART_IS_LEAF(node)) {
+        fi_art_leaf *leaf = FI_ART_LEAF_UNTAG(node);
+        it->visited++;
+        return it->visit(fi_art_leaf_key(it->tree, leaf), leaf->key_length, FI_ART_LEAF_VALUE(leaf), it->user_data);
+    }
+
+    fi_art_node *n = (fi_art_node*)node;
+    if (n->leaf && !fi_art_iterate_recursive(it, FI_ART_LEAF_TAG(n->leaf))) return false;
+
+    switch (n->type) {
+        case FI_ART_NODE4:
+            for (int i = 0; i < n->child_count; i++) {
+                if (!fi_art_iterate_recursive(it, ((fi_art_node4*)n)->children[i])) return false;
+            }
+            break;
+        case FI_ART_NODE16:
+            for (int i = 0; i < n->child_count; i++) {
+                if (!fi_art_iterate_recursive(it, ((fi_art_node16*)n)->children[i])) return false;
+            }
+            break;
+        case FI_ART_NODE48: {
+            fi_art_node48 *n48 = (fi_art_node48*)n;
+            for (int i = 0; i < 256; i++) {
+                if (n48->child_index[i] &&
+                    !fi_art_iterate_recursive(it, n48->children[n48->child_index[i] - 1])) return false;
+            }
+            break;
+        }
+        case FI_ART_NODE256:
+            for (int i = 0; i < 256; i++) {
+                if (!fi_art_iterate_recursive(it, ((fi_art_node256*)n)->children[i])) return false;
+            }
+            break;
+    }
+    return true;
+}
+
+size_t fi_art_iterate(fi_art *tree, fi_art_visit_func visit, void *user_data) {
+    if (!tree || !visit) return 0;
+
+    fi_art_iterator it = {tree, visit, user_data, 0};
+    fi_art_iterate_recursive(&it, tree->root);
+    return it.visited;
+}
+
+/* Visit every key that starts with `prefix`, in order */
+size_t fi_art_prefix_iterate(fi_art *tree, const uint8_t *prefix, size_t prefix_length,
+                             fi_art_visit_func visit, void *user_data) {
+    if (!tree || !visit || (!prefix && prefix_length)) return 0;
+
+    fi_art_iterator it = {tree, visit, user_data, 0};
+    void *node = tree->root;
+    size_t depth = 0;
+
+    while (node) {
+        if (FI_ART_IS_LEAF(node)) {
+            fi_art_leaf *leaf = FI_ART_LEAF_UNTAG(node);
+            if (leaf->key_length >= prefix_length &&
+                (prefix_length == 0 || memcmp(fi_art_leaf_key(tree, leaf), prefix, prefix_length) == 0)) {
+                fi_art_iterate_recursive(&it, node);
+            }
+            break;
+        }
+
+        fi_art_node *n = (fi_art_node*)node;
+        if (depth == prefix_length) {
+            fi_art_iterate_recursive(&it, node);
+            break;
+        }
+
+        if (n->prefix_length) {
+            /* Exact comparison: everything below shares the whole path */
+            size_t mismatch = fi_art_prefix_mismatch(tree, n, prefix, prefix_length, depth);
+            if (depth + mismatch == prefix_length) {
+                fi_art_iterate_recursive(&it, node);
+                break;
+            }
+            if (mismatch < n->prefix_length) break;
+            depth += n->prefix_length;
+        }
+
+        void **child = fi_art_find_child(n, prefix[depth]);
+        node = child ? *child : NULL;
+        depth++;
+    }
+    return it.visited;
+}
@@ -2,15 +2,29 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+/* Node pool tuning */
+#define FI_BTREE_SLAB_MIN_NODES 32
+#define FI_BTREE_SLAB_MAX_NODES 4096
+
+/* Slab of nodes; the nodes follow the header */
+typedef struct fi_btree_slab {
+    struct fi_btree_slab *next;    /* Next (newer) slab */
+    size_t capacity;               /* Number of nodes in this slab */
+    size_t used;                   /* Nodes handed out by bump allocation */
+} fi_btree_slab;
+
+#define FI_BTREE_SLAB_HEADER \
+    ((sizeof(fi_btree_slab) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
 /* Forward declarations for static functions */
-static void fi_btree_clear_recursive(fi_btree_node *node);
 static void fi_btree_inorder_recursive(fi_btree_node *node, fi_btree_visit_func visit, void *user_data, size_t depth);
 static void fi_btree_preorder_recursive(fi_btree_node *node, fi_btree_visit_func visit, void *user_data, size_t depth);
 static void fi_btree_postorder_recursive(fi_btree_node *node, fi_btree_visit_func visit, void *user_data, size_t depth);
 static void fi_btree_collect_data(void *data, size_t depth, void *user_data);
-static fi_btree_node* fi_btree_build_from_sorted_recursive(fi_array *arr, size_t start, size_t end, size_t element_size);
+static fi_btree_node* fi_btree_build_from_sorted_recursive(fi_btree *tree, fi_array *arr, size_t start, size_t end);
 static bool fi_btree_is_bst_recursive(fi_btree_node *node, const void *min, const void *max, int (*compare_func)(const void *a, const void *b));
 static void fi_btree_print_visit(void *data, size_t depth, void *user_data);
 
@@ -20,6 +34,76 @@ static int compare_node_data(fi_btree *tree, const void *data1, const void *data
     return tree->compare_func(data1, data2);
 }
 
+/* Size of a node with its inline element, rounded up so nodes stay aligned */
+static size_t fi_btree_node_alloc_size(size_t element_size) {
+    size_t align = element_size >= _Alignof(max_align_t) ? _Alignof(max_align_t) : sizeof(void*);
+    size_t size = sizeof(fi_btree_node) + element_size;
+    return (size + align - 1) & ~(align - 1);
+}
+
+/* Add a slab with room for at least `min_nodes` nodes */
+static fi_btree_slab* fi_btree_pool_grow(fi_btree *tree, size_t min_nodes) {
+    size_t capacity = tree->slab_capacity;
+    if (capacity < min_nodes) capacity = min_nodes;
+    
+    fi_btree_slab *slab = malloc(FI_BTREE_SLAB_HEADER + capacity * tree->node_size);
+    if (!slab) return NULL;
+    
+    slab->next = NULL;
+    slab->capacity = capacity;
+    slab->used = 0;
+    
+    /* Append so that slabs kept by fi_btree_clear are reused in order */
+    if (!tree->slabs) {
+        tree->slabs = slab;
+    } else {
+        fi_btree_slab *last = tree->current ? tree->current : tree->slabs;
+        while (last->next) last = last->next;
+        last->next = slab;
+    }
+    
+    if (tree->slab_capacity < FI_BTREE_SLAB_MAX_NODES) {
+        tree->slab_capacity *= 2;
+    }
+    return slab;
+}
+
+/* Take a node from the tree's pool and fill in its inline data */
+static fi_btree_node* fi_btree_pool_alloc(fi_btree *tree, const void *data) {
+    fi_btree_node *node = tree->free_nodes;
+    
+    if (node) {
+        tree->free_nodes = node->right;
+    } else {
+        fi_btree_slab *slab = tree->current ? tree->current : tree->slabs;
+        while (slab && slab->used == slab->capacity) {
+            slab = slab->next;
+        }
+        if (!slab) {
+            slab = fi_btree_pool_grow(tree, 1);
+            if (!slab) return NULL;
+        }
+        tree->current = slab;
+        node = (fi_btree_node*)((char*)slab + FI_BTREE_SLAB_HEADER + slab->used * tree->node_size);
+        slab->used++;
+    }
+    
+    memcpy(FI_BTREE_NODE_DATA(node), data, tree->element_size);
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = NULL;
+    
+    return node;
+}
+
+/* Return a node to the tree's pool */
+static void fi_btree_pool_free(fi_btree *tree, fi_btree_node *node) {
+    node->left = NULL;
+    node->parent = NULL;
+    node->right = tree->free_nodes;
+    tree->free_nodes = node;
+}
+
 /* Create a new BTree */
 fi_btree* fi_btree_create(size_t element_size, int (*compare_func)(const void *a, const void *b)) {
     fi_btree *tree = malloc(sizeof(fi_btree));
@@ -28,23 +112,24 @@ fi_btree* fi_btree_create(size_t element_size, int (*compare_func)(const void *a
     tree->root = NULL;
     tree->element_size = element_size;
     tree->count = 0;
+    tree->max_count = 0;
     tree->compare_func = compare_func;
     
+    tree->node_size = fi_btree_node_alloc_size(element_size);
+    tree->slabs = NULL;
+    tree->current = NULL;
+    tree->free_nodes = NULL;
+    tree->slab_capacity = FI_BTREE_SLAB_MIN_NODES;
+    
     return tree;
 }
 
-/* Create a new BTree node */
+/* Create a new standalone BTree node (node and data in one allocation) */
 fi_btree_node* fi_btree_create_node(const void *data, size_t element_size) {
-    fi_btree_node *node = malloc(sizeof(fi_btree_node));
+    fi_btree_node *node = malloc(fi_btree_node_alloc_size(element_size));
     if (!node) return NULL;
     
-    node->data = malloc(element_size);
-    if (!node->data) {
-        free(node);
-        return NULL;
-    }
-    
-    memcpy(node->data, data, element_size);
+    memcpy(FI_BTREE_NODE_DATA(node), data, element_size);
     node->left = NULL;
     node->right = NULL;
     node->parent = NULL;
@@ -52,13 +137,10 @@ fi_btree_node* fi_btree_create_node(const void *data, size_t element_size) {
     return node;
 }
 
-/* Destroy a BTree node */
+/* Destroy a standalone BTree node */
 void fi_btree_destroy_node(fi_btree_node *node) {
     if (!node) return;
     
-    if (node->data) {
-        free(node->data);
-    }
     free(node);
 }
 
@@ -66,47 +148,170 @@ void fi_btree_destroy_node(fi_btree_node *node) {
 void fi_btree_destroy(fi_btree *tree) {
     if (!tree) return;
     
-    fi_btree_clear(tree);
+    fi_btree_slab *slab = tree->slabs;
+    while (slab) {
+        fi_btree_slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
     free(tree);
 }
 
-/* Clear all nodes from the tree */
+/* Clear all nodes from the tree; the slabs are kept for reuse */
 void fi_btree_clear(fi_btree *tree) {
     if (!tree) return;
     
-    fi_btree_clear_recursive(tree->root);
+    for (fi_btree_slab *slab = tree->slabs; slab; slab = slab->next) {
+        slab->used = 0;
+    }
+    tree->current = tree->slabs;
+    tree->free_nodes = NULL;
     tree->root = NULL;
     tree->count = 0;
+    tree->max_count = 0;
 }
 
-/* Recursive helper to clear nodes */
-static void fi_btree_clear_recursive(fi_btree_node *node) {
-    if (!node) return;
+/* Make sure `count` more nodes can be inserted without touching malloc */
+int fi_btree_reserve(fi_btree *tree, size_t count) {
+    if (!tree) return -1;
+    
+    size_t available = 0;
+    for (fi_btree_node *node = tree->free_nodes; node && available < count; node = node->right) {
+        available++;
+    }
+    for (fi_btree_slab *slab = tree->current ? tree->current : tree->slabs; slab && available < count; slab = slab->next) {
+        available += slab->capacity - slab->used;
+    }
+    if (available >= count) return 0;
+    
+    return fi_btree_pool_grow(tree, count - available) ? 0 : -1;
+}
+
+/* Bytes held by the tree, including unused pool capacity */
+size_t fi_btree_memory_usage(fi_btree *tree) {
+    if (!tree) return 0;
+    
+    size_t bytes = sizeof(fi_btree);
+    for (fi_btree_slab *slab = tree->slabs; slab; slab = slab->next) {
+        bytes += FI_BTREE_SLAB_HEADER + slab->capacity * tree->node_size;
+    }
+    return bytes;
+}
+
+/* Balancing
+ *
+ * The tree is a scapegoat tree (alpha = 2/3): nodes carry no balance
+ * information, and no node is ever deeper than log_{3/2}(n) + 1 after an
+ * insert. An insert that lands too deep walks back up to the lowest
+ * ancestor with a child holding more than 2/3 of its subtree and rebuilds
+ * that subtree perfectly balanced; once deletes have shrunk the tree below
+ * 2/3 of its size at the last full rebuild, the whole tree is rebuilt. Both
+ * cost O(log n) amortized, so sorted input no longer degrades the tree into
+ * a list. Rebuilds only relink nodes: node addresses and their data stay
+ * where they are. */
+
+static size_t fi_btree_subtree_size(const fi_btree_node *node) {
+    if (!node) return 0;
+    return 1 + fi_btree_subtree_size(node->left) + fi_btree_subtree_size(node->right);
+}
+
+/* Whether a node at `depth` (root = 0) is too deep for `count` nodes,
+ * i.e. depth > log_{3/2}(count) */
+static bool fi_btree_too_deep(size_t depth, size_t count) {
+    double bound = 1.0;
+    for (size_t i = 0; i < depth; i++) {
+        bound *= 1.5;
+        if (bound > (double)count) return true;
+    }
+    return false;
+}
+
+/* Link nodes[start, end), in order, as a perfectly balanced subtree */
+static fi_btree_node* fi_btree_link_balanced(fi_btree_node **nodes, size_t start, size_t end) {
+    if (start >= end) return NULL;
+    
+    size_t mid = start + (end - start) / 2;
+    fi_btree_node *node = nodes[mid];
+    
+    node->left = fi_btree_link_balanced(nodes, start, mid);
+    node->right = fi_btree_link_balanced(nodes, mid + 1, end);
+    if (node->left) node->left->parent = node;
+    if (node->right) node->right->parent = node;
+    
+    return node;
+}
+
+/* Rebuild the subtree rooted at `node`, of `size` nodes, balanced. Left as
+ * it is when the scratch array cannot be allocated. */
+static void fi_btree_rebuild(fi_btree *tree, fi_btree_node *node, size_t size) {
+    if (!node || size < 3) return;
+    
+    fi_btree_node **nodes = malloc(size * sizeof(fi_btree_node*));
+    if (!nodes) return;
+    
+    fi_btree_node *current = fi_btree_find_min(node);
+    for (size_t i = 0; i < size; i++) {
+        nodes[i] = current;
+        current = fi_btree_successor(current);
+    }
+    
+    fi_btree_node *parent = node->parent;
+    bool left_child = parent && parent->left == node;
+    
+    fi_btree_node *root = fi_btree_link_balanced(nodes, 0, size);
+    root->parent = parent;
+    if (!parent) {
+        tree->root = root;
+    } else if (left_child) {
+        parent->left = root;
+    } else {
+        parent->right = root;
+    }
+    
+    free(nodes);
+}
+
+/* Restore the depth bound after inserting `node` */
+static void fi_btree_rebalance_insert(fi_btree *tree, fi_btree_node *node) {
+    size_t size = 1;
     
-    fi_btree_clear_recursive(node->left);
-    fi_btree_clear_recursive(node->right);
-    fi_btree_destroy_node(node);
+    while (node->parent) {
+        fi_btree_node *parent = node->parent;
+        fi_btree_node *sibling = parent->left == node ? parent->right : parent->left;
+        size_t parent_size = size + fi_btree_subtree_size(sibling) + 1;
+        
+        if (3 * size > 2 * parent_size) {
+            fi_btree_rebuild(tree, parent, parent_size);
+            return;
+        }
+        
+        node = parent;
+        size = parent_size;
+    }
 }
 
 /* Insert data into the tree */
 int fi_btree_insert(fi_btree *tree, const void *data) {
     if (!tree || !data) return -1;
     
-    fi_btree_node *new_node = fi_btree_create_node(data, tree->element_size);
-    if (!new_node) return -1;
-    
     if (!tree->root) {
+        fi_btree_node *new_node = fi_btree_pool_alloc(tree, data);
+        if (!new_node) return -1;
         tree->root = new_node;
         tree->count = 1;
+        if (tree->max_count < 1) tree->max_count = 1;
         return 0;
     }
     
     fi_btree_node *current = tree->root;
+    int cmp = 0;
     fi_btree_node *parent = NULL;
+    size_t depth = 0;
     
     while (current) {
         parent = current;
-        int cmp = compare_node_data(tree, data, current->data);
+        depth++;
+        cmp = compare_node_data(tree, data, FI_BTREE_NODE_DATA(current));
         
         if (cmp < 0) {
             current = current->left;
@@ -114,15 +319,15 @@ int fi_btree_insert(fi_btree *tree, const void *data) {
             current = current->right;
         } else {
             /* Duplicate found - replace data */
-            memcpy(current->data, data, tree->element_size);
-            fi_btree_destroy_node(new_node);
+            memcpy(FI_BTREE_NODE_DATA(current), data, tree->element_size);
             return 0;
         }
     }
     
     /* Insert new node */
+    fi_btree_node *new_node = fi_btree_pool_alloc(tree, data);
+    if (!new_node) return -1;
     new_node->parent = parent;
-    int cmp = compare_node_data(tree, data, parent->data);
     
     if (cmp < 0) {
         parent->left = new_node;
@@ -131,6 +336,11 @@ int fi_btree_insert(fi_btree *tree, const void *data) {
     }
     
     tree->count++;
+    if (tree->count > tree->max_count) tree->max_count = tree->count;
+    
+    if (fi_btree_too_deep(depth, tree->count)) {
+        fi_btree_rebalance_insert(tree, new_node);
+    }
     return 0;
 }
 
@@ -141,7 +351,7 @@ fi_btree_node* fi_btree_search(fi_btree *tree, const void *data) {
     fi_btree_node *current = tree->root;
     
     while (current) {
-        int cmp = compare_node_data(tree, data, current->data);
+        int cmp = compare_node_data(tree, data, FI_BTREE_NODE_DATA(current));
         
         if (cmp < 0) {
             current = current->left;
@@ -155,6 +365,44 @@ fi_btree_node* fi_btree_search(fi_btree *tree, const void *data) {
     return NULL;
 }
 
+/* Find the first node whose data is not less than the given data */
+fi_btree_node* fi_btree_lower_bound(fi_btree *tree, const void *data) {
+    if (!tree || !data) return NULL;
+    
+    fi_btree_node *current = tree->root;
+    fi_btree_node *result = NULL;
+    
+    while (current) {
+        if (compare_node_data(tree, FI_BTREE_NODE_DATA(current), data) >= 0) {
+            result = current;
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+    
+    return result;
+}
+
+/* Find the first node whose data is greater than the given data */
+fi_btree_node* fi_btree_upper_bound(fi_btree *tree, const void *data) {
+    if (!tree || !data) return NULL;
+    
+    fi_btree_node *current = tree->root;
+    fi_btree_node *result = NULL;
+    
+    while (current) {
+        if (compare_node_data(tree, FI_BTREE_NODE_DATA(current), data) > 0) {
+            result = current;
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+    
+    return result;
+}
+
 /* Find minimum node in subtree */
 fi_btree_node* fi_btree_find_min(fi_btree_node *node) {
     if (!node) return NULL;
@@ -248,14 +496,20 @@ fi_btree_node* fi_btree_delete_node(fi_btree *tree, fi_btree_node *node) {
         fi_btree_node *successor = fi_btree_successor(node);
         
         /* Copy successor's data to current node */
-        memcpy(node->data, successor->data, tree->element_size);
+        memcpy(FI_BTREE_NODE_DATA(node), FI_BTREE_NODE_DATA(successor), tree->element_size);
         
         /* Delete the successor */
         return fi_btree_delete_node(tree, successor);
     }
     
     tree->count--;
-    fi_btree_destroy_node(node);
+    fi_btree_pool_free(tree, node);
+    
+    /* Rebuild everything once the tree has lost a third of its nodes */
+    if (3 * tree->count < 2 * tree->max_count) {
+        fi_btree_rebuild(tree, tree->root, tree->count);
+        tree->max_count = tree->count;
+    }
     return node_to_delete;
 }
 
@@ -311,7 +565,7 @@ static void fi_btree_inorder_recursive(fi_btree_node *node, fi_btree_visit_func
     if (!node) return;
     
     fi_btree_inorder_recursive(node->left, visit, user_data, depth + 1);
-    visit(node->data, depth, user_data);
+    visit(FI_BTREE_NODE_DATA(node), depth, user_data);
     fi_btree_inorder_recursive(node->right, visit, user_data, depth + 1);
 }
 
@@ -325,7 +579,7 @@ void fi_btree_preorder(fi_btree *tree, fi_btree_visit_func visit, void *user_dat
 static void fi_btree_preorder_recursive(fi_btree_node *node, fi_btree_visit_func visit, void *user_data, size_t depth) {
     if (!node) return;
     
-    visit(node->data, depth, user_data);
+    visit(FI_BTREE_NODE_DATA(node), depth, user_data);
     fi_btree_preorder_recursive(node->left, visit, user_data, depth + 1);
     fi_btree_preorder_recursive(node->right, visit, user_data, depth + 1);
 }
@@ -342,7 +596,7 @@ static void fi_btree_postorder_recursive(fi_btree_node *node, fi_btree_visit_fun
     
     fi_btree_postorder_recursive(node->left, visit, user_data, depth + 1);
     fi_btree_postorder_recursive(node->right, visit, user_data, depth + 1);
-    visit(node->data, depth, user_data);
+    visit(FI_BTREE_NODE_DATA(node), depth, user_data);
 }
 
 /* Level order traversal using array as queue */
@@ -361,8 +615,8 @@ void fi_btree_level_order(fi_btree *tree, fi_btree_visit_func visit, void *user_
         fi_btree_node *node = *node_ptr;
         fi_array_shift(queue, NULL);
         
-        if (node && node->data) {
-            visit(node->data, 0, user_data); /* Depth not tracked in level order */
+        if (node) {
+            visit(FI_BTREE_NODE_DATA(node), 0, user_data); /* Depth not tracked in level order */
             
             if (node->left) {
                 fi_array_push(queue, &node->left);
@@ -449,24 +703,30 @@ fi_btree* fi_btree_from_sorted_array(fi_array *arr, int (*compare_func)(const vo
     fi_btree *tree = fi_btree_create(arr->element_size, compare_func);
     if (!tree) return NULL;
     
-    tree->root = fi_btree_build_from_sorted_recursive(arr, 0, fi_array_count(arr) - 1, tree->element_size);
+    if (fi_btree_reserve(tree, fi_array_count(arr)) != 0) {
+        fi_btree_destroy(tree);
+        return NULL;
+    }
+    
+    tree->root = fi_btree_build_from_sorted_recursive(tree, arr, 0, fi_array_count(arr));
     tree->count = fi_array_count(arr);
+    tree->max_count = tree->count;
     
     return tree;
 }
 
-/* Recursive helper to build balanced tree from sorted array */
-static fi_btree_node* fi_btree_build_from_sorted_recursive(fi_array *arr, size_t start, size_t end, size_t element_size) {
-    if (start > end) return NULL;
+/* Recursive helper to build balanced tree from sorted array range [start, end) */
+static fi_btree_node* fi_btree_build_from_sorted_recursive(fi_btree *tree, fi_array *arr, size_t start, size_t end) {
+    if (start >= end) return NULL;
     
     size_t mid = start + (end - start) / 2;
     void *data = fi_array_get(arr, mid);
     
-    fi_btree_node *node = fi_btree_create_node(data, element_size);
+    fi_btree_node *node = fi_btree_pool_alloc(tree, data);
     if (!node) return NULL;
     
-    node->left = fi_btree_build_from_sorted_recursive(arr, start, mid - 1, element_size);
-    node->right = fi_btree_build_from_sorted_recursive(arr, mid + 1, end, element_size);
+    node->left = fi_btree_build_from_sorted_recursive(tree, arr, start, mid);
+    node->right = fi_btree_build_from_sorted_recursive(tree, arr, mid + 1, end);
     
     if (node->left) node->left->parent = node;
     if (node->right) node->right->parent = node;
@@ -474,6 +734,138 @@ static fi_btree_node* fi_btree_build_from_sorted_recursive(fi_array *arr, size_t
     return node;
 }
 
+/* Merge cursor over either a tree (in order) or a sorted array */
+typedef struct {
+    fi_btree_node *node;           /* Current tree node, when walking a tree */
+    fi_array *array;               /* Sorted array, when walking an array */
+    size_t index;                  /* Current array position */
+} fi_btree_cursor;
+
+static const void* fi_btree_cursor_peek(fi_btree_cursor *cursor) {
+    if (cursor->array) {
+        return cursor->index < fi_array_count(cursor->array) ?
+               fi_array_get(cursor->array, cursor->index) : NULL;
+    }
+    return cursor->node ? FI_BTREE_NODE_DATA(cursor->node) : NULL;
+}
+
+static void fi_btree_cursor_next(fi_btree_cursor *cursor, int (*compare_func)(const void *a, const void *b)) {
+    if (!cursor->array) {
+        cursor->node = fi_btree_successor(cursor->node);
+        return;
+    }
+
+    /* Skip the rest of an equal run */
+    const void *current = fi_array_get(cursor->array, cursor->index);
+    size_t count = fi_array_count(cursor->array);
+    do {
+        cursor->index++;
+    } while (cursor->index < count &&
+             compare_func(fi_array_get(cursor->array, cursor->index), current) == 0);
+}
+
+/* Walk both cursors in lockstep and emit the elements selected by `op` */
+static size_t fi_btree_merge_cursors(fi_btree_cursor *left, fi_btree_cursor *right,
+                                     int (*compare_func)(const void *a, const void *b),
+                                     fi_btree_set_op op, fi_btree_emit_func emit, void *user_data) {
+    size_t emitted = 0;
+    const void *a = fi_btree_cursor_peek(left);
+    const void *b = fi_btree_cursor_peek(right);
+
+    while (a || b) {
+        const void *out = NULL;
+        int cmp = !a ? 1 : (!b ? -1 : compare_func(a, b));
+
+        if (cmp < 0) {
+            if (op != FI_BTREE_SET_INTERSECT) out = a;
+            fi_btree_cursor_next(left, compare_func);
+        } else if (cmp > 0) {
+            /* Once the left side is exhausted only a union has anything left */
+            if (op != FI_BTREE_SET_UNION && !a) break;
+            if (op == FI_BTREE_SET_UNION) out = b;
+            fi_btree_cursor_next(right, compare_func);
+        } else {
+            if (op != FI_BTREE_SET_DIFFERENCE) out = a;
+            fi_btree_cursor_next(left, compare_func);
+            fi_btree_cursor_next(right, compare_func);
+        }
+
+        if (out) {
+            emitted++;
+            if (emit && !emit(out, user_data)) break;
+        }
+
+        /* Intersection is done as soon as either side runs out */
+        a = fi_btree_cursor_peek(left);
+        b = fi_btree_cursor_peek(right);
+        if (op == FI_BTREE_SET_INTERSECT && (!a || !b)) break;
+    }
+
+    return emitted;
+}
+
+/* Stream the result of a set operation between two trees */
+size_t fi_btree_merge(fi_btree *a, fi_btree *b, fi_btree_set_op op,
+                      fi_btree_emit_func emit, void *user_data) {
+    if (!a || !b || a->element_size != b->element_size) return 0;
+
+    fi_btree_cursor left = {fi_btree_find_min(a->root), NULL, 0};
+    fi_btree_cursor right = {fi_btree_find_min(b->root), NULL, 0};
+    return fi_btree_merge_cursors(&left, &right, a->compare_func, op, emit, user_data);
+}
+
+/* Stream the result of a set operation between a tree and a sorted array */
+size_t fi_btree_merge_array(fi_btree *tree, fi_array *sorted, fi_btree_set_op op,
+                            fi_btree_emit_func emit, void *user_data) {
+    if (!tree || !sorted || tree->element_size != sorted->element_size) return 0;
+
+    fi_btree_cursor left = {fi_btree_find_min(tree->root), NULL, 0};
+    fi_btree_cursor right = {NULL, sorted, 0};
+    return fi_btree_merge_cursors(&left, &right, tree->compare_func, op, emit, user_data);
+}
+
+static bool fi_btree_collect_emit(const void *data, void *user_data) {
+    return fi_array_push((fi_array*)user_data, data) == 0;
+}
+
+/* Materialize a set operation as a new balanced tree */
+static fi_btree* fi_btree_set_operation(fi_btree *a, fi_btree *b, fi_btree_set_op op) {
+    if (!a || !b || a->element_size != b->element_size) return NULL;
+
+    size_t capacity = op == FI_BTREE_SET_UNION ? a->count + b->count : a->count;
+    fi_array *merged = fi_array_create(capacity > 0 ? capacity : 1, a->element_size);
+    if (!merged) return NULL;
+
+    fi_btree_merge(a, b, op, fi_btree_collect_emit, merged);
+
+    fi_btree *result = fi_btree_create(a->element_size, a->compare_func);
+    if (result && fi_array_count(merged) > 0) {
+        if (fi_btree_reserve(result, fi_array_count(merged)) != 0) {
+            fi_btree_destroy(result);
+            result = NULL;
+        } else {
+            result->root = fi_btree_build_from_sorted_recursive(result, merged, 0, fi_array_count(merged));
+            result->count = fi_array_count(merged);
+            result->max_count = result->count;
+        }
+    }
+
+    fi_array_destroy(merged);
+    return result;
+}
+
+fi_btree* fi_btree_union(fi_btree *a, fi_btree *b) {
+    return fi_btree_set_operation(a, b, FI_BTREE_SET_UNION);
+}
+
+fi_btree* fi_btree_intersect(fi_btree *a, fi_btree *b) {
+    return fi_btree_set_operation(a, b, FI_BTREE_SET_INTERSECT);
+}
+
+fi_btree* fi_btree_difference(fi_btree *a, fi_btree *b) {
+    return fi_btree_set_operation(a, b, FI_BTREE_SET_DIFFERENCE);
+}
+
 /* Check if tree is a valid BST */
 bool fi_btree_is_bst(fi_btree *tree) {
     if (!tree) return true;
@@ -484,11 +876,11 @@ bool fi_btree_is_bst(fi_btree *tree) {
 static bool fi_btree_is_bst_recursive(fi_btree_node *node, const void *min, const void *max, int (*compare_func)(const void *a, const void *b)) {
     if (!node) return true;
     
-    if (min && compare_func(node->data, min) <= 0) return false;
-    if (max && compare_func(node->data, max) >= 0) return false;
+    if (min && compare_func(FI_BTREE_NODE_DATA(node), min) <= 0) return false;
+    if (max && compare_func(FI_BTREE_NODE_DATA(node), max) >= 0) return false;
     
-    return fi_btree_is_bst_recursive(node->left, min, node->data, compare_func) &&
-           fi_btree_is_bst_recursive(node->right, node->data, max, compare_func);
+    return fi_btree_is_bst_recursive(node->left, min, FI_BTREE_NODE_DATA(node), compare_func) &&
+           fi_btree_is_bst_recursive(node->right, FI_BTREE_NODE_DATA(node), max, compare_func);
 }
 
 /* Print tree (simple) */
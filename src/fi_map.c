@@ -358,9 +358,22 @@ int fi_map_remove(fi_map *map, const void *key) {
             free(entry->value);
         }
         
-        entry->key = NULL;
-        entry->value = NULL;
-        entry->is_deleted = true;
+        /* Backward-shift deletion: pull the following entries of the probe
+         * chain one slot closer to home so lookups never stop early at the
+         * hole left behind */
+        size_t index = (size_t)(entry - map->buckets);
+        size_t next = (index + 1) & (map->bucket_count - 1);
+        while (map->buckets[next].key != NULL && map->buckets[next].distance > 0) {
+            map->buckets[index] = map->buckets[next];
+            map->buckets[index].distance--;
+            index = next;
+            next = (next + 1) & (map->bucket_count - 1);
+        }
+        
+        map->buckets[index].key = NULL;
+        map->buckets[index].value = NULL;
+        map->buckets[index].distance = 0;
+        map->buckets[index].is_deleted = false;
         map->size--;
         return 0;
     }
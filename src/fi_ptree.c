@@ -0,0 +1,413 @@
+#include "fi_ptree.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* State threaded through a path-copying update */
+typedef struct {
+    fi_ptree *tree;
+    bool failed;                   /* An allocation failed; unwind without building */
+    bool changed;                  /* An element was added or removed */
+} fi_ptree_update;
+
+/* Forward declarations for static functions */
+static fi_ptree_node* fi_ptree_retain(fi_ptree_node *node);
+static void fi_ptree_release(fi_ptree_node *node);
+static fi_ptree_node* fi_ptree_make(fi_ptree_update *u, const void *data, fi_ptree_node *left, fi_ptree_node *right);
+static fi_ptree_node* fi_ptree_balance(fi_ptree_update *u, fi_ptree_node *node);
+static fi_ptree_node* fi_ptree_insert_recursive(fi_ptree_update *u, fi_ptree_node *node, const void *data);
+static fi_ptree_node* fi_ptree_delete_recursive(fi_ptree_update *u, fi_ptree_node *node, const void *data);
+static fi_ptree_node* fi_ptree_delete_min(fi_ptree_update *u, fi_ptree_node *node);
+static fi_ptree_node* fi_ptree_search(fi_ptree_node *node, const void *key, int (*compare_func)(const void *a, const void *b));
+static void fi_ptree_publish(fi_ptree *tree, fi_ptree_node *root, size_t count);
+static bool fi_ptree_range_recursive(const fi_ptree_snapshot *snapshot, fi_ptree_node *node,
+                                     const void *from, const void *to,
+                                     fi_ptree_visit_func visit, void *user_data, size_t *visited);
+static bool fi_ptree_collect_data(void *data, void *user_data);
+
+static int fi_ptree_height(fi_ptree_node *node) {
+    return node ? node->height : 0;
+}
+
+/* Take a reference to a node */
+static fi_ptree_node* fi_ptree_retain(fi_ptree_node *node) {
+    if (node) {
+        atomic_fetch_add_explicit(&node->refcount, 1, memory_order_relaxed);
+    }
+    return node;
+}
+
+/* Drop a reference; frees the node and releases its children on the last one */
+static void fi_ptree_release(fi_ptree_node *node) {
+    while (node) {
+        if (atomic_fetch_sub_explicit(&node->refcount, 1, memory_order_acq_rel) != 1) return;
+
+        fi_ptree_node *left = node->left;
+        fi_ptree_node *right = node->right;
+        free(node);
+
+        /* Recurse on one side, loop on the other */
+        fi_ptree_release(left);
+        node = right;
+    }
+}
+
+/* Build a new node owning the given child references.
+ * On failure (or once the update has failed) the children are released. */
+static fi_ptree_node* fi_ptree_make(fi_ptree_update *u, const void *data, fi_ptree_node *left, fi_ptree_node *right) {
+    fi_ptree_node *node = u->failed ? NULL : malloc(sizeof(fi_ptree_node) + u->tree->element_size);
+    if (!node) {
+        u->failed = true;
+        fi_ptree_release(left);
+        fi_ptree_release(right);
+        return NULL;
+    }
+
+    atomic_init(&node->refcount, 1);
+    node->left = left;
+    node->right = right;
+    int lh = fi_ptree_height(left);
+    int rh = fi_ptree_height(right);
+    node->height = (lh > rh ? lh : rh) + 1;
+    memcpy(FI_PTREE_NODE_DATA(node), data, u->tree->element_size);
+
+    return node;
+}
+
+/* Restore the AVL property on a freshly built node.
+ * Children may be shared with older versions, so rotations copy them. */
+static fi_ptree_node* fi_ptree_balance(fi_ptree_update *u, fi_ptree_node *node) {
+    if (!node) return NULL;
+
+    int balance = fi_ptree_height(node->left) - fi_ptree_height(node->right);
+
+    if (balance > 1) {
+        fi_ptree_node *l = node->left;
+        fi_ptree_node *new_left;
+
+        if (fi_ptree_height(l->left) < fi_ptree_height(l->right)) {
+            /* Left-right case: rotate the left child left first */
+            fi_ptree_node *lr = l->right;
+            fi_ptree_node *a = fi_ptree_make(u, FI_PTREE_NODE_DATA(l), fi_ptree_retain(l->left), fi_ptree_retain(lr->left));
+            fi_ptree_node *b = fi_ptree_make(u, FI_PTREE_NODE_DATA(node), fi_ptree_retain(lr->right), fi_ptree_retain(node->right));
+            new_left = fi_ptree_make(u, FI_PTREE_NODE_DATA(lr), a, b);
+        } else {
+            fi_ptree_node *b = fi_ptree_make(u, FI_PTREE_NODE_DATA(node), fi_ptree_retain(l->right), fi_ptree_retain(node->right));
+            new_left = fi_ptree_make(u, FI_PTREE_NODE_DATA(l), fi_ptree_retain(l->left), b);
+        }
+        fi_ptree_release(node);
+        return new_left;
+    }
+
+    if (balance < -1) {
+        fi_ptree_node *r = node->right;
+        fi_ptree_node *new_right;
+
+        if (fi_ptree_height(r->right) < fi_ptree_height(r->left)) {
+            /* Right-left case: rotate the right child right first */
+            fi_ptree_node *rl = r->left;
+            fi_ptree_node *a = fi_ptree_make(u, FI_PTREE_NODE_DATA(node), fi_ptree_retain(node->left), fi_ptree_retain(rl->left));
+            fi_ptree_node *b = fi_ptree_make(u, FI_PTREE_NODE_DATA(r), fi_ptree_retain(rl->right), fi_ptree_retain(r->right));
+            new_right = fi_ptree_make(u, FI_PTREE_NODE_DATA(rl), a, b);
+        } else {
+            fi_ptree_node *a = fi_ptree_make(u, FI_PTREE_NODE_DATA(node), fi_ptree_retain(node->left), fi_ptree_retain(r->left));
+            new_right = fi_ptree_make(u, FI_PTREE_NODE_DATA(r), a, fi_ptree_retain(r->right));
+        }
+        fi_ptree_release(node);
+        return new_right;
+    }
+
+    return node;
+}
+
+/* Return a new version of `node` with `data` inserted (duplicates replace) */
+static fi_ptree_node* fi_ptree_insert_recursive(fi_ptree_update *u, fi_ptree_node *node, const void *data) {
+    if (!node) {
+        u->changed = true;
+        return fi_ptree_make(u, data, NULL, NULL);
+    }
+
+    int cmp = u->tree->compare_func(data, FI_PTREE_NODE_DATA(node));
+    if (cmp < 0) {
+        fi_ptree_node *left = fi_ptree_insert_recursive(u, node->left, data);
+        return fi_ptree_balance(u, fi_ptree_make(u, FI_PTREE_NODE_DATA(node), left, fi_ptree_retain(node->right)));
+    }
+    if (cmp > 0) {
+        fi_ptree_node *right = fi_ptree_insert_recursive(u, node->right, data);
+        return fi_ptree_balance(u, fi_ptree_make(u, FI_PTREE_NODE_DATA(node), fi_ptree_retain(node->left), right));
+    }
+
+    return fi_ptree_make(u, data, fi_ptree_retain(node->left), fi_ptree_retain(node->right));
+}
+
+/* Return a new version of `node` without its minimum element */
+static fi_ptree_node* fi_ptree_delete_min(fi_ptree_update *u, fi_ptree_node *node) {
+    if (!node->left) {
+        return fi_ptree_retain(node->right);
+    }
+
+    fi_ptree_node *left = fi_ptree_delete_min(u, node->left);
+    return fi_ptree_balance(u, fi_ptree_make(u, FI_PTREE_NODE_DATA(node), left, fi_ptree_retain(node->right)));
+}
+
+/* Return a new version of `node` with `data` removed; `data` must be present */
+static fi_ptree_node* fi_ptree_delete_recursive(fi_ptree_update *u, fi_ptree_node *node, const void *data) {
+    int cmp = u->tree->compare_func(data, FI_PTREE_NODE_DATA(node));
+
+    if (cmp < 0) {
+        fi_ptree_node *left = fi_ptree_delete_recursive(u, node->left, data);
+        return fi_ptree_balance(u, fi_ptree_make(u, FI_PTREE_NODE_DATA(node), left, fi_ptree_retain(node->right)));
+    }
+    if (cmp > 0) {
+        fi_ptree_node *right = fi_ptree_delete_recursive(u, node->right, data);
+        return fi_ptree_balance(u, fi_ptree_make(u, FI_PTREE_NODE_DATA(node), fi_ptree_retain(node->left), right));
+    }
+
+    u->changed = true;
+    if (!node->left) return fi_ptree_retain(node->right);
+    if (!node->right) return fi_ptree_retain(node->left);
+
+    /* Two children: the successor takes this node's place */
+    fi_ptree_node *successor = node->right;
+    while (successor->left) {
+        successor = successor->left;
+    }
+    fi_ptree_node *right = fi_ptree_delete_min(u, node->right);
+    return fi_ptree_balance(u, fi_ptree_make(u, FI_PTREE_NODE_DATA(successor), fi_ptree_retain(node->left), right));
+}
+
+/* Find the node equal to `key` */
+static fi_ptree_node* fi_ptree_search(fi_ptree_node *node, const void *key, int (*compare_func)(const void *a, const void *b)) {
+    while (node) {
+        int cmp = compare_func(key, FI_PTREE_NODE_DATA(node));
+        if (cmp == 0) return node;
+        node = cmp < 0 ? node->left : node->right;
+    }
+    return NULL;
+}
+
+/* Swap in a new root and drop the writer's reference to the old one */
+static void fi_ptree_publish(fi_ptree *tree, fi_ptree_node *root, size_t count) {
+    pthread_mutex_lock(&tree->root_lock);
+    fi_ptree_node *old_root = tree->root;
+    tree->root = root;
+    tree->count = count;
+    tree->version++;
+    pthread_mutex_unlock(&tree->root_lock);
+
+    /* Snapshots still holding the old version keep its nodes alive */
+    fi_ptree_release(old_root);
+}
+
+/* Create a new persistent tree */
+fi_ptree* fi_ptree_create(size_t element_size, int (*compare_func)(const void *a, const void *b)) {
+    if (element_size == 0 || !compare_func) return NULL;
+
+    fi_ptree *tree = malloc(sizeof(fi_ptree));
+    if (!tree) return NULL;
+
+    tree->root = NULL;
+    tree->count = 0;
+    tree->version = 0;
+    tree->element_size = element_size;
+    tree->compare_func = compare_func;
+
+    if (pthread_mutex_init(&tree->write_lock, NULL) != 0) {
+        free(tree);
+        return NULL;
+    }
+    if (pthread_mutex_init(&tree->root_lock, NULL) != 0) {
+        pthread_mutex_destroy(&tree->write_lock);
+        free(tree);
+        return NULL;
+    }
+
+    return tree;
+}
+
+/* Destroy the tree; outstanding snapshots remain valid until released */
+void fi_ptree_destroy(fi_ptree *tree) {
+    if (!tree) return;
+
+    fi_ptree_release(tree->root);
+    pthread_mutex_destroy(&tree->write_lock);
+    pthread_mutex_destroy(&tree->root_lock);
+    free(tree);
+}
+
+/* Insert data, replacing an equal element; returns 0 on success, -1 on error */
+int fi_ptree_insert(fi_ptree *tree, const void *data) {
+    if (!tree || !data) return -1;
+
+    pthread_mutex_lock(&tree->write_lock);
+
+    fi_ptree_update u = { tree, false, false };
+    fi_ptree_node *root = fi_ptree_insert_recursive(&u, tree->root, data);
+    if (u.failed) {
+        pthread_mutex_unlock(&tree->write_lock);
+        return -1;
+    }
+
+    fi_ptree_publish(tree, root, tree->count + (u.changed ? 1 : 0));
+    pthread_mutex_unlock(&tree->write_lock);
+    return 0;
+}
+
+/* Delete data; returns 0 on success, -1 if not found or on error */
+int fi_ptree_delete(fi_ptree *tree, const void *data) {
+    if (!tree || !data) return -1;
+
+    pthread_mutex_lock(&tree->write_lock);
+
+    /* Avoid copying a path for a key that is not there */
+    if (!fi_ptree_search(tree->root, data, tree->compare_func)) {
+        pthread_mutex_unlock(&tree->write_lock);
+        return -1;
+    }
+
+    fi_ptree_update u = { tree, false, false };
+    fi_ptree_node *root = fi_ptree_delete_recursive(&u, tree->root, data);
+    if (u.failed) {
+        pthread_mutex_unlock(&tree->write_lock);
+        return -1;
+    }
+
+    fi_ptree_publish(tree, root, tree->count - 1);
+    pthread_mutex_unlock(&tree->write_lock);
+    return 0;
+}
+
+/* Copy the element equal to `key` from the current version */
+int fi_ptree_find(fi_ptree *tree, const void *key, void *out) {
+    fi_ptree_snapshot *snapshot = fi_ptree_snapshot_acquire(tree);
+    if (!snapshot) return -1;
+
+    int result = fi_ptree_snapshot_find(snapshot, key, out);
+    fi_ptree_snapshot_release(snapshot);
+    return result;
+}
+
+/* Check if the current version contains data */
+bool fi_ptree_contains(fi_ptree *tree, const void *data) {
+    if (!tree || !data) return false;
+
+    fi_ptree_snapshot *snapshot = fi_ptree_snapshot_acquire(tree);
+    if (!snapshot) return false;
+
+    bool found = fi_ptree_search(snapshot->root, data, snapshot->compare_func) != NULL;
+    fi_ptree_snapshot_release(snapshot);
+    return found;
+}
+
+/* Get the number of elements in the current version */
+size_t fi_ptree_size(fi_ptree *tree) {
+    if (!tree) return 0;
+
+    pthread_mutex_lock(&tree->root_lock);
+    size_t count = tree->count;
+    pthread_mutex_unlock(&tree->root_lock);
+    return count;
+}
+
+/* Get the current version number */
+uint64_t fi_ptree_version(fi_ptree *tree) {
+    if (!tree) return 0;
+
+    pthread_mutex_lock(&tree->root_lock);
+    uint64_t version = tree->version;
+    pthread_mutex_unlock(&tree->root_lock);
+    return version;
+}
+
+/* Take an O(1) snapshot of the current version */
+fi_ptree_snapshot* fi_ptree_snapshot_acquire(fi_ptree *tree) {
+    if (!tree) return NULL;
+
+    fi_ptree_snapshot *snapshot = malloc(sizeof(fi_ptree_snapshot));
+    if (!snapshot) return NULL;
+
+    pthread_mutex_lock(&tree->root_lock);
+    snapshot->root = fi_ptree_retain(tree->root);
+    snapshot->count = tree->count;
+    snapshot->version = tree->version;
+    pthread_mutex_unlock(&tree->root_lock);
+
+    snapshot->element_size = tree->element_size;
+    snapshot->compare_func = tree->compare_func;
+    return snapshot;
+}
+
+/* Release a snapshot; nodes only it could reach are freed */
+void fi_ptree_snapshot_release(fi_ptree_snapshot *snapshot) {
+    if (!snapshot) return;
+
+    fi_ptree_release(snapshot->root);
+    free(snapshot);
+}
+
+/* Copy the element equal to `key` from the snapshot */
+int fi_ptree_snapshot_find(const fi_ptree_snapshot *snapshot, const void *key, void *out) {
+    if (!snapshot || !key || !out) return -1;
+
+    fi_ptree_node *node = fi_ptree_search(snapshot->root, key, snapshot->compare_func);
+    if (!node) return -1;
+
+    memcpy(out, FI_PTREE_NODE_DATA(node), snapshot->element_size);
+    return 0;
+}
+
+/* Get the number of elements in the snapshot */
+size_t fi_ptree_snapshot_size(const fi_ptree_snapshot *snapshot) {
+    return snapshot ? snapshot->count : 0;
+}
+
+/* Recursive helper for range traversal; returns false to stop */
+static bool fi_ptree_range_recursive(const fi_ptree_snapshot *snapshot, fi_ptree_node *node,
+                                     const void *from, const void *to,
+                                     fi_ptree_visit_func visit, void *user_data, size_t *visited) {
+    if (!node) return true;
+
+    void *data = FI_PTREE_NODE_DATA(node);
+    bool above_from = !from || snapshot->compare_func(data, from) >= 0;
+    bool below_to = !to || snapshot->compare_func(data, to) < 0;
+
+    if (above_from && !fi_ptree_range_recursive(snapshot, node->left, from, to, visit, user_data, visited)) {
+        return false;
+    }
+    if (above_from && below_to) {
+        (*visited)++;
+        if (!visit(data, user_data)) return false;
+    }
+    if (below_to) {
+        return fi_ptree_range_recursive(snapshot, node->right, from, to, visit, user_data, visited);
+    }
+    return true;
+}
+
+/* Visit elements of the snapshot in [from, to) in order; NULL bounds are open */
+size_t fi_ptree_snapshot_range(const fi_ptree_snapshot *snapshot, const void *from, const void *to,
+                               fi_ptree_visit_func visit, void *user_data) {
+    if (!snapshot || !visit) return 0;
+
+    size_t visited = 0;
+    fi_ptree_range_recursive(snapshot, snapshot->root, from, to, visit, user_data, &visited);
+    return visited;
+}
+
+/* Helper to collect elements into an array */
+static bool fi_ptree_collect_data(void *data, void *user_data) {
+    fi_array_push((fi_array*)user_data, data);
+    return true;
+}
+
+/* Convert the snapshot to an ordered array */
+fi_array* fi_ptree_snapshot_to_array(const fi_ptree_snapshot *snapshot) {
+    if (!snapshot) return NULL;
+
+    fi_array *arr = fi_array_create(snapshot->count, snapshot->element_size);
+    if (!arr) return NULL;
+
+    fi_ptree_snapshot_range(snapshot, NULL, NULL, fi_ptree_collect_data, arr);
+    return arr;
+}
@@ -0,0 +1,379 @@
+#include "fi_skiplist.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Forward declarations for static functions */
+static fi_skiplist_node* fi_skiplist_node_create(const void *data, size_t element_size, int top_level);
+static void fi_skiplist_node_destroy(fi_skiplist_node *node);
+static int fi_skiplist_find_position(fi_skiplist *list, const void *data,
+                                     fi_skiplist_node **preds, fi_skiplist_node **succs);
+static void fi_skiplist_unlock_preds(fi_skiplist_node **preds, int highest_locked);
+static int fi_skiplist_random_level(void);
+static bool fi_skiplist_collect_data(void *data, void *user_data);
+
+/* Per-thread generator state for level selection */
+static _Thread_local uint64_t fi_skiplist_rng_state;
+
+/* Pick a level with P(level > k) = 1/4^k */
+static int fi_skiplist_random_level(void) {
+    uint64_t x = fi_skiplist_rng_state;
+    if (x == 0) {
+        x = (uint64_t)(uintptr_t)&fi_skiplist_rng_state ^ 0x9e3779b97f4a7c15ULL;
+    }
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    fi_skiplist_rng_state = x;
+
+    int level = 1;
+    while (level < FI_SKIPLIST_MAX_LEVEL && (x & 3) == 0) {
+        level++;
+        x >>= 2;
+    }
+    return level;
+}
+
+/* Create a node spanning `top_level` levels with its data stored inline */
+static fi_skiplist_node* fi_skiplist_node_create(const void *data, size_t element_size, int top_level) {
+    size_t links = sizeof(fi_skiplist_node) + (size_t)top_level * sizeof(fi_skiplist_node*);
+    fi_skiplist_node *node = malloc(links + element_size);
+    if (!node) return NULL;
+
+    if (pthread_mutex_init(&node->lock, NULL) != 0) {
+        free(node);
+        return NULL;
+    }
+    atomic_init(&node->marked, false);
+    atomic_init(&node->fully_linked, false);
+    node->top_level = top_level;
+    node->retired_next = NULL;
+    node->data = (char*)node + links;
+    if (data) {
+        memcpy(node->data, data, element_size);
+    }
+    for (int i = 0; i < top_level; i++) {
+        atomic_init(&node->next[i], NULL);
+    }
+
+    return node;
+}
+
+/* Free a node */
+static void fi_skiplist_node_destroy(fi_skiplist_node *node) {
+    pthread_mutex_destroy(&node->lock);
+    free(node);
+}
+
+/* Create a new skip list */
+fi_skiplist* fi_skiplist_create(size_t element_size, int (*compare_func)(const void *a, const void *b)) {
+    if (element_size == 0 || !compare_func) return NULL;
+
+    fi_skiplist *list = malloc(sizeof(fi_skiplist));
+    if (!list) return NULL;
+
+    list->head = fi_skiplist_node_create(NULL, 0, FI_SKIPLIST_MAX_LEVEL);
+    if (!list->head) {
+        free(list);
+        return NULL;
+    }
+    atomic_init(&list->head->fully_linked, true);
+
+    list->element_size = element_size;
+    atomic_init(&list->count, 0);
+    list->compare_func = compare_func;
+    atomic_init(&list->retired, NULL);
+
+    return list;
+}
+
+/* Destroy the skip list; no other thread may be using it */
+void fi_skiplist_destroy(fi_skiplist *list) {
+    if (!list) return;
+
+    fi_skiplist_node *node = atomic_load(&list->head->next[0]);
+    while (node) {
+        fi_skiplist_node *next = atomic_load(&node->next[0]);
+        fi_skiplist_node_destroy(node);
+        node = next;
+    }
+
+    fi_skiplist_reclaim(list);
+    fi_skiplist_node_destroy(list->head);
+    free(list);
+}
+
+/* Free nodes removed so far.
+ *
+ * Removed nodes stay readable until this is called, because a concurrent
+ * reader may still be standing on one. Call it only at a quiescent point,
+ * i.e. when no other thread is inside a skip list operation. */
+void fi_skiplist_reclaim(fi_skiplist *list) {
+    if (!list) return;
+
+    fi_skiplist_node *node = atomic_exchange(&list->retired, NULL);
+    while (node) {
+        fi_skiplist_node *next = node->retired_next;
+        fi_skiplist_node_destroy(node);
+        node = next;
+    }
+}
+
+/* Locate predecessors and successors of `data` at every level.
+ * Returns the highest level at which `data` was found, or -1. */
+static int fi_skiplist_find_position(fi_skiplist *list, const void *data,
+                                     fi_skiplist_node **preds, fi_skiplist_node **succs) {
+    int found_level = -1;
+    fi_skiplist_node *pred = list->head;
+
+    for (int level = FI_SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+        fi_skiplist_node *curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+        int cmp = 1;
+
+        while (curr && (cmp = list->compare_func(curr->data, data)) < 0) {
+            pred = curr;
+            curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+        }
+        if (found_level == -1 && curr && cmp == 0) {
+            found_level = level;
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+
+    return found_level;
+}
+
+/* Unlock the distinct predecessors locked on levels [0, highest_locked] */
+static void fi_skiplist_unlock_preds(fi_skiplist_node **preds, int highest_locked) {
+    for (int level = 0; level <= highest_locked; level++) {
+        if (level == 0 || preds[level] != preds[level - 1]) {
+            pthread_mutex_unlock(&preds[level]->lock);
+        }
+    }
+}
+
+/* Insert data; returns 0 if inserted, 1 if an equal element exists, -1 on error */
+int fi_skiplist_insert(fi_skiplist *list, const void *data) {
+    if (!list || !data) return -1;
+
+    fi_skiplist_node *preds[FI_SKIPLIST_MAX_LEVEL];
+    fi_skiplist_node *succs[FI_SKIPLIST_MAX_LEVEL];
+    int top_level = fi_skiplist_random_level();
+
+    while (true) {
+        int found_level = fi_skiplist_find_position(list, data, preds, succs);
+        if (found_level != -1) {
+            fi_skiplist_node *found = succs[found_level];
+            if (!atomic_load(&found->marked)) {
+                /* Wait for a concurrent insert of the same key to finish */
+                while (!atomic_load(&found->fully_linked)) {
+                }
+                return 1;
+            }
+            /* Being removed; retry once it is unlinked */
+            continue;
+        }
+
+        int highest_locked = -1;
+        bool valid = true;
+        fi_skiplist_node *prev_pred = NULL;
+
+        for (int level = 0; valid && level < top_level; level++) {
+            fi_skiplist_node *pred = preds[level];
+            fi_skiplist_node *succ = succs[level];
+            if (pred != prev_pred) {
+                pthread_mutex_lock(&pred->lock);
+                highest_locked = level;
+                prev_pred = pred;
+            }
+            valid = !atomic_load(&pred->marked) &&
+                    (!succ || !atomic_load(&succ->marked)) &&
+                    atomic_load(&pred->next[level]) == succ;
+        }
+
+        if (!valid) {
+            fi_skiplist_unlock_preds(preds, highest_locked);
+            continue;
+        }
+
+        fi_skiplist_node *node = fi_skiplist_node_create(data, list->element_size, top_level);
+        if (!node) {
+            fi_skiplist_unlock_preds(preds, highest_locked);
+            return -1;
+        }
+
+        for (int level = 0; level < top_level; level++) {
+            atomic_init(&node->next[level], succs[level]);
+        }
+        for (int level = 0; level < top_level; level++) {
+            atomic_store_explicit(&preds[level]->next[level], node, memory_order_release);
+        }
+        atomic_store(&node->fully_linked, true);
+
+        fi_skiplist_unlock_preds(preds, highest_locked);
+        atomic_fetch_add(&list->count, 1);
+        return 0;
+    }
+}
+
+/* Remove data; returns 0 if removed, -1 if not found */
+int fi_skiplist_remove(fi_skiplist *list, const void *data) {
+    if (!list || !data) return -1;
+
+    fi_skiplist_node *preds[FI_SKIPLIST_MAX_LEVEL];
+    fi_skiplist_node *succs[FI_SKIPLIST_MAX_LEVEL];
+    fi_skiplist_node *victim = NULL;
+    bool is_marked = false;
+    int top_level = -1;
+
+    while (true) {
+        int found_level = fi_skiplist_find_position(list, data, preds, succs);
+
+        if (!is_marked) {
+            if (found_level == -1) return -1;
+
+            victim = succs[found_level];
+            if (!atomic_load(&victim->fully_linked) ||
+                victim->top_level - 1 != found_level ||
+                atomic_load(&victim->marked)) {
+                return -1;
+            }
+
+            top_level = victim->top_level;
+            pthread_mutex_lock(&victim->lock);
+            if (atomic_load(&victim->marked)) {
+                pthread_mutex_unlock(&victim->lock);
+                return -1;
+            }
+            atomic_store(&victim->marked, true);
+            is_marked = true;
+        }
+
+        int highest_locked = -1;
+        bool valid = true;
+        fi_skiplist_node *prev_pred = NULL;
+
+        for (int level = 0; valid && level < top_level; level++) {
+            fi_skiplist_node *pred = preds[level];
+            if (pred != prev_pred) {
+                pthread_mutex_lock(&pred->lock);
+                highest_locked = level;
+                prev_pred = pred;
+            }
+            valid = !atomic_load(&pred->marked) && atomic_load(&pred->next[level]) == victim;
+        }
+
+        if (!valid) {
+            fi_skiplist_unlock_preds(preds, highest_locked);
+            continue;
+        }
+
+        for (int level = top_level - 1; level >= 0; level--) {
+            atomic_store_explicit(&preds[level]->next[level],
+                                  atomic_load(&victim->next[level]), memory_order_release);
+        }
+
+        pthread_mutex_unlock(&victim->lock);
+        fi_skiplist_unlock_preds(preds, highest_locked);
+
+        /* Push onto the retired list; readers may still hold it */
+        fi_skiplist_node *head = atomic_load(&list->retired);
+        do {
+            victim->retired_next = head;
+        } while (!atomic_compare_exchange_weak(&list->retired, &head, victim));
+
+        atomic_fetch_sub(&list->count, 1);
+        return 0;
+    }
+}
+
+/* Check if the list contains data */
+bool fi_skiplist_contains(fi_skiplist *list, const void *data) {
+    if (!list || !data) return false;
+
+    fi_skiplist_node *preds[FI_SKIPLIST_MAX_LEVEL];
+    fi_skiplist_node *succs[FI_SKIPLIST_MAX_LEVEL];
+    int found_level = fi_skiplist_find_position(list, data, preds, succs);
+
+    return found_level != -1 &&
+           atomic_load(&succs[found_level]->fully_linked) &&
+           !atomic_load(&succs[found_level]->marked);
+}
+
+/* Copy the element equal to `key` into `out`; returns 0 if found, -1 otherwise */
+int fi_skiplist_find(fi_skiplist *list, const void *key, void *out) {
+    if (!list || !key || !out) return -1;
+
+    fi_skiplist_node *preds[FI_SKIPLIST_MAX_LEVEL];
+    fi_skiplist_node *succs[FI_SKIPLIST_MAX_LEVEL];
+    int found_level = fi_skiplist_find_position(list, key, preds, succs);
+    if (found_level == -1) return -1;
+
+    fi_skiplist_node *node = succs[found_level];
+    if (!atomic_load(&node->fully_linked) || atomic_load(&node->marked)) return -1;
+
+    memcpy(out, node->data, list->element_size);
+    return 0;
+}
+
+/* Get the number of elements */
+size_t fi_skiplist_size(fi_skiplist *list) {
+    return list ? atomic_load(&list->count) : 0;
+}
+
+/* Check if the list is empty */
+bool fi_skiplist_empty(fi_skiplist *list) {
+    return fi_skiplist_size(list) == 0;
+}
+
+/* Visit live elements in [from, to) in order until `visit` returns false.
+ * Concurrent updates outside the visited range are not blocked; updates
+ * inside it may or may not be observed. Returns the number of visits. */
+size_t fi_skiplist_range(fi_skiplist *list, const void *from, const void *to,
+                         fi_skiplist_visit_func visit, void *user_data) {
+    if (!list || !visit) return 0;
+
+    fi_skiplist_node *pred = list->head;
+    if (from) {
+        for (int level = FI_SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+            fi_skiplist_node *curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+            while (curr && list->compare_func(curr->data, from) < 0) {
+                pred = curr;
+                curr = atomic_load_explicit(&pred->next[level], memory_order_acquire);
+            }
+        }
+    }
+
+    size_t visited = 0;
+    fi_skiplist_node *node = atomic_load_explicit(&pred->next[0], memory_order_acquire);
+    while (node) {
+        if (to && list->compare_func(node->data, to) >= 0) break;
+
+        if (atomic_load(&node->fully_linked) && !atomic_load(&node->marked)) {
+            visited++;
+            if (!visit(node->data, user_data)) break;
+        }
+        node = atomic_load_explicit(&node->next[0], memory_order_acquire);
+    }
+
+    return visited;
+}
+
+/* Helper to collect elements into an array */
+static bool fi_skiplist_collect_data(void *data, void *user_data) {
+    fi_array_push((fi_array*)user_data, data);
+    return true;
+}
+
+/* Convert the list to an ordered array */
+fi_array* fi_skiplist_to_array(fi_skiplist *list) {
+    if (!list) return NULL;
+
+    fi_array *arr = fi_array_create(fi_skiplist_size(list), list->element_size);
+    if (!arr) return NULL;
+
+    fi_skiplist_range(list, NULL, NULL, fi_skiplist_collect_data, arr);
+    return arr;
+}
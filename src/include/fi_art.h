@@ -0,0 +1,70 @@
+#ifndef __FI_ART_H__
+#define __FI_ART_H__
+
+#include "fi.h"
+
+/* Adaptive radix tree keyed by byte strings.
+ *
+ * Lookups walk one byte of the key per level, so they cost O(key length)
+ * regardless of the number of keys. Inner nodes grow through four sizes
+ * (4, 16, 48 and 256 children) as they fill up, and runs of single-child
+ * levels are collapsed into a compressed path prefix. Keys may be prefixes
+ * of one another; iteration visits keys in lexicographic byte order. */
+
+/* Bytes of a compressed path stored in the node itself; longer paths are
+ * checked against a leaf below the node */
+#define FI_ART_MAX_PREFIX 10
+
+typedef enum {
+    FI_ART_NODE4 = 1,
+    FI_ART_NODE16,
+    FI_ART_NODE48,
+    FI_ART_NODE256
+} fi_art_node_type;
+
+/* Leaf: value bytes followed by the key bytes, in one allocation */
+typedef struct fi_art_leaf {
+    size_t key_length;             /* Length of the key */
+} fi_art_leaf;
+
+#define FI_ART_LEAF_VALUE(leaf) ((void*)((fi_art_leaf*)(leaf) + 1))
+
+/* Inner node header shared by all node sizes */
+typedef struct fi_art_node {
+    uint8_t type;                  /* fi_art_node_type */
+    uint16_t child_count;          /* Number of children in use */
+    uint32_t prefix_length;        /* Length of the compressed path */
+    uint8_t prefix[FI_ART_MAX_PREFIX]; /* Leading bytes of the compressed path */
+    fi_art_leaf *leaf;             /* Key that ends exactly at this node */
+} fi_art_node;
+
+/* Radix tree structure */
+typedef struct fi_art {
+    void *root;                    /* Root node or tagged leaf */
+    size_t count;                  /* Number of keys */
+    size_t value_size;             /* Size of each value in bytes */
+} fi_art;
+
+/* Tree operations */
+fi_art* fi_art_create(size_t value_size);
+void fi_art_destroy(fi_art *tree);
+void fi_art_clear(fi_art *tree);
+
+/* Updates (insert replaces the value of an existing key) */
+int fi_art_insert(fi_art *tree, const uint8_t *key, size_t key_length, const void *value);
+int fi_art_delete(fi_art *tree, const uint8_t *key, size_t key_length);
+
+/* Lookups */
+void* fi_art_search(fi_art *tree, const uint8_t *key, size_t key_length);
+bool fi_art_contains(fi_art *tree, const uint8_t *key, size_t key_length);
+size_t fi_art_size(fi_art *tree);
+bool fi_art_empty(fi_art *tree);
+
+/* Ordered iteration; return false from the visitor to stop early */
+typedef bool (*fi_art_visit_func)(const uint8_t *key, size_t key_length, void *value, void *user_data);
+
+size_t fi_art_iterate(fi_art *tree, fi_art_visit_func visit, void *user_data);
+size_t fi_art_prefix_iterate(fi_art *tree, const uint8_t *prefix, size_t prefix_length,
+                             fi_art_visit_func visit, void *user_data);
+
+#endif //__FI_ART_H__
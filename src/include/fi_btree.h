@@ -3,28 +3,46 @@
 
 #include "fi.h"
 
-/* BTree node structure */
+/* BTree node structure
+ *
+ * The element bytes live in the same allocation, directly after the node
+ * header. FI_BTREE_NODE_DATA gives their address. */
 typedef struct fi_btree_node {
-    void *data;                    /* Pointer to the data */
     struct fi_btree_node *left;    /* Left child */
     struct fi_btree_node *right;   /* Right child */
     struct fi_btree_node *parent;  /* Parent node */
 } fi_btree_node;
 
-/* BTree structure */
+#define FI_BTREE_NODE_DATA(node) ((void*)((fi_btree_node*)(node) + 1))
+
+/* BTree structure
+ *
+ * A binary search tree kept balanced as a scapegoat tree: inserts and
+ * deletes rebuild subtrees that have grown lopsided, so lookups stay
+ * O(log n) whatever the insert order. */
 typedef struct fi_btree {
     fi_btree_node *root;           /* Root node */
     size_t element_size;           /* Size of each element in bytes */
     size_t count;                  /* Number of nodes */
+    size_t max_count;              /* Largest count since the last full rebuild */
     int (*compare_func)(const void *a, const void *b); /* Comparison function */
+
+    /* Node pool: nodes are carved out of slabs instead of malloc'd one by one */
+    size_t node_size;              /* Node header plus inline element, aligned */
+    struct fi_btree_slab *slabs;   /* Slabs owned by the tree, oldest first */
+    struct fi_btree_slab *current; /* Slab currently handing out fresh nodes */
+    fi_btree_node *free_nodes;     /* Recycled nodes, chained through ->right */
+    size_t slab_capacity;          /* Node capacity of the next new slab */
 } fi_btree;
 
 /* BTree operations */
 fi_btree* fi_btree_create(size_t element_size, int (*compare_func)(const void *a, const void *b));
 void fi_btree_destroy(fi_btree *tree);
 void fi_btree_clear(fi_btree *tree);
+int fi_btree_reserve(fi_btree *tree, size_t count);
+size_t fi_btree_memory_usage(fi_btree *tree);
 
-/* Node operations */
+/* Node operations (standalone nodes; nodes owned by a tree come from its pool) */
 fi_btree_node* fi_btree_create_node(const void *data, size_t element_size);
 void fi_btree_destroy_node(fi_btree_node *node);
 
@@ -35,6 +53,8 @@ fi_btree_node* fi_btree_delete_node(fi_btree *tree, fi_btree_node *node);
 
 /* Search operations */
 fi_btree_node* fi_btree_search(fi_btree *tree, const void *data);
+fi_btree_node* fi_btree_lower_bound(fi_btree *tree, const void *data);
+fi_btree_node* fi_btree_upper_bound(fi_btree *tree, const void *data);
 fi_btree_node* fi_btree_find_min(fi_btree_node *node);
 fi_btree_node* fi_btree_find_max(fi_btree_node *node);
 fi_btree_node* fi_btree_successor(fi_btree_node *node);
@@ -65,6 +85,30 @@ fi_array* fi_btree_to_array_postorder(fi_btree *tree);
 fi_btree* fi_btree_from_array(fi_array *arr, int (*compare_func)(const void *a, const void *b));
 fi_btree* fi_btree_from_sorted_array(fi_array *arr, int (*compare_func)(const void *a, const void *b));
 
+/* Set operations
+ *
+ * Both inputs are walked in lockstep in sort order, so each operation is
+ * O(n + m). The trees must share the same ordering (the first tree's
+ * comparison function is used). Sorted arrays may contain duplicates; equal
+ * runs are treated as one element. Union keeps the first input's copy of
+ * elements present in both. */
+typedef enum {
+    FI_BTREE_SET_UNION,            /* Elements in either input */
+    FI_BTREE_SET_INTERSECT,        /* Elements in both inputs */
+    FI_BTREE_SET_DIFFERENCE        /* Elements in the first input only */
+} fi_btree_set_op;
+
+/* Streamed result callback; return false to stop the merge early */
+typedef bool (*fi_btree_emit_func)(const void *data, void *user_data);
+
+fi_btree* fi_btree_union(fi_btree *a, fi_btree *b);
+fi_btree* fi_btree_intersect(fi_btree *a, fi_btree *b);
+fi_btree* fi_btree_difference(fi_btree *a, fi_btree *b);
+size_t fi_btree_merge(fi_btree *a, fi_btree *b, fi_btree_set_op op,
+                      fi_btree_emit_func emit, void *user_data);
+size_t fi_btree_merge_array(fi_btree *tree, fi_array *sorted, fi_btree_set_op op,
+                            fi_btree_emit_func emit, void *user_data);
+
 /* Utility functions */
 bool fi_btree_is_bst(fi_btree *tree);
 bool fi_btree_is_balanced(fi_btree *tree);
@@ -0,0 +1,71 @@
+#ifndef __FI_PTREE_H__
+#define __FI_PTREE_H__
+
+#include "fi.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Persistent (copy-on-write) ordered tree.
+ *
+ * Nodes are immutable once published. An update copies the path from the
+ * root to the changed node and shares every other subtree with the previous
+ * version, so taking a snapshot is O(1) and a snapshot stays stable while
+ * writers continue. Old versions are reclaimed by reference counting when
+ * the last snapshot that can reach them is released. */
+
+/* Tree node structure (element bytes stored inline after the header) */
+typedef struct fi_ptree_node {
+    atomic_size_t refcount;        /* Parents and roots referencing this node */
+    struct fi_ptree_node *left;    /* Left child */
+    struct fi_ptree_node *right;   /* Right child */
+    int height;                    /* AVL height */
+} fi_ptree_node;
+
+#define FI_PTREE_NODE_DATA(node) ((void*)((fi_ptree_node*)(node) + 1))
+
+/* Read-only view of one version of the tree */
+typedef struct fi_ptree_snapshot {
+    fi_ptree_node *root;           /* Root of this version (holds a reference) */
+    size_t count;                  /* Number of elements in this version */
+    uint64_t version;              /* Version number the snapshot was taken at */
+    size_t element_size;           /* Size of each element in bytes */
+    int (*compare_func)(const void *a, const void *b); /* Comparison function */
+} fi_ptree_snapshot;
+
+/* Persistent tree structure */
+typedef struct fi_ptree {
+    fi_ptree_node *root;           /* Current version */
+    size_t count;                  /* Number of elements in the current version */
+    uint64_t version;              /* Incremented on every successful update */
+    size_t element_size;           /* Size of each element in bytes */
+    int (*compare_func)(const void *a, const void *b); /* Comparison function */
+    pthread_mutex_t write_lock;    /* Serializes writers */
+    pthread_mutex_t root_lock;     /* Guards root/count/version swaps */
+} fi_ptree;
+
+/* Tree operations */
+fi_ptree* fi_ptree_create(size_t element_size, int (*compare_func)(const void *a, const void *b));
+void fi_ptree_destroy(fi_ptree *tree);
+
+/* Updates (each publishes a new version) */
+int fi_ptree_insert(fi_ptree *tree, const void *data);
+int fi_ptree_delete(fi_ptree *tree, const void *data);
+
+/* Lookups against the current version */
+int fi_ptree_find(fi_ptree *tree, const void *key, void *out);
+bool fi_ptree_contains(fi_ptree *tree, const void *data);
+size_t fi_ptree_size(fi_ptree *tree);
+uint64_t fi_ptree_version(fi_ptree *tree);
+
+/* Snapshots */
+typedef bool (*fi_ptree_visit_func)(void *data, void *user_data);
+
+fi_ptree_snapshot* fi_ptree_snapshot_acquire(fi_ptree *tree);
+void fi_ptree_snapshot_release(fi_ptree_snapshot *snapshot);
+int fi_ptree_snapshot_find(const fi_ptree_snapshot *snapshot, const void *key, void *out);
+size_t fi_ptree_snapshot_size(const fi_ptree_snapshot *snapshot);
+size_t fi_ptree_snapshot_range(const fi_ptree_snapshot *snapshot, const void *from, const void *to,
+                               fi_ptree_visit_func visit, void *user_data);
+fi_array* fi_ptree_snapshot_to_array(const fi_ptree_snapshot *snapshot);
+
+#endif //__FI_PTREE_H__
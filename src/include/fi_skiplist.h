@@ -0,0 +1,57 @@
+#ifndef __FI_SKIPLIST_H__
+#define __FI_SKIPLIST_H__
+
+#include "fi.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define FI_SKIPLIST_MAX_LEVEL 24
+
+/* Skip list node structure
+ *
+ * Nodes are linked lazily: a writer locks only the predecessors it splices
+ * into, validates them and publishes the node level by level. Readers never
+ * lock; they skip nodes that are marked or not yet fully linked. The element
+ * bytes are stored inline after the `next` array. */
+typedef struct fi_skiplist_node {
+    pthread_mutex_t lock;                   /* Held while splicing around this node */
+    atomic_bool marked;                     /* Logically deleted */
+    atomic_bool fully_linked;               /* Linked at all of its levels */
+    int top_level;                          /* Number of levels this node spans */
+    struct fi_skiplist_node *retired_next;  /* Link in the retired list */
+    void *data;                             /* Pointer to the inline data */
+    _Atomic(struct fi_skiplist_node*) next[]; /* Forward pointers, one per level */
+} fi_skiplist_node;
+
+/* Concurrent skip list structure */
+typedef struct fi_skiplist {
+    fi_skiplist_node *head;                 /* Sentinel, spans every level */
+    size_t element_size;                    /* Size of each element in bytes */
+    atomic_size_t count;                    /* Number of live elements */
+    int (*compare_func)(const void *a, const void *b); /* Comparison function */
+    _Atomic(fi_skiplist_node*) retired;     /* Unlinked nodes awaiting reclamation */
+} fi_skiplist;
+
+/* Skip list operations */
+fi_skiplist* fi_skiplist_create(size_t element_size, int (*compare_func)(const void *a, const void *b));
+void fi_skiplist_destroy(fi_skiplist *list);
+void fi_skiplist_reclaim(fi_skiplist *list);
+
+/* Insertion and deletion (safe to call from several threads at once) */
+int fi_skiplist_insert(fi_skiplist *list, const void *data);
+int fi_skiplist_remove(fi_skiplist *list, const void *data);
+
+/* Search operations (lock-free) */
+bool fi_skiplist_contains(fi_skiplist *list, const void *data);
+int fi_skiplist_find(fi_skiplist *list, const void *key, void *out);
+size_t fi_skiplist_size(fi_skiplist *list);
+bool fi_skiplist_empty(fi_skiplist *list);
+
+/* Range traversal over [from, to); NULL bounds are open */
+typedef bool (*fi_skiplist_visit_func)(void *data, void *user_data);
+
+size_t fi_skiplist_range(fi_skiplist *list, const void *from, const void *to,
+                         fi_skiplist_visit_func visit, void *user_data);
+fi_array* fi_skiplist_to_array(fi_skiplist *list);
+
+#endif //__FI_SKIPLIST_H__
@@ -71,7 +71,7 @@ int main() {
     printf("Search for '%s': %s\n", search_word, found ? "Found" : "Not found");
     
     if (found) {
-        char **found_str = (char**)found->data;
+        char **found_str = (char**)FI_BTREE_NODE_DATA(found);
         printf("Found word: \"%s\"\n", *found_str);
     }
     
@@ -80,11 +80,11 @@ int main() {
     fi_btree_node *max_node = fi_btree_find_max(tree->root);
     
     if (min_node) {
-        char **min_str = (char**)min_node->data;
+        char **min_str = (char**)FI_BTREE_NODE_DATA(min_node);
         printf("Alphabetically first: \"%s\"\n", *min_str);
     }
     if (max_node) {
-        char **max_str = (char**)max_node->data;
+        char **max_str = (char**)FI_BTREE_NODE_DATA(max_node);
         printf("Alphabetically last: \"%s\"\n", *max_str);
     }
     
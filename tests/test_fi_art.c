@@ -0,0 +1,272 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/include/fi.h"
+#include "../src/include/fi_art.h"
+
+/* Helper functions for testing */
+static int insert_string(fi_art *tree, const char *key, int value) {
+    return fi_art_insert(tree, (const uint8_t*)key, strlen(key), &value);
+}
+
+static int *search_string(fi_art *tree, const char *key) {
+    return (int*)fi_art_search(tree, (const uint8_t*)key, strlen(key));
+}
+
+typedef struct {
+    char keys[64][32];
+    int count;
+} key_list;
+
+static bool collect_keys(const uint8_t *key, size_t key_length, void *value, void *user_data) {
+    (void)value;
+    key_list *list = (key_list*)user_data;
+    if (list->count < 64) {
+        memcpy(list->keys[list->count], key, key_length);
+        list->keys[list->count][key_length] = '\0';
+        list->count++;
+    }
+    return true;
+}
+
+typedef struct {
+    char last[32];
+    size_t last_length;
+    bool has_last;
+} order_check;
+
+static bool check_order(const uint8_t *key, size_t key_length, void *value, void *user_data) {
+    (void)value;
+    order_check *check = (order_check*)user_data;
+    if (check->has_last) {
+        size_t common = check->last_length < key_length ? check->last_length : key_length;
+        int cmp = memcmp(check->last, key, common);
+        ck_assert(cmp < 0 || (cmp == 0 && check->last_length < key_length));
+    }
+    memcpy(check->last, key, key_length);
+    check->last_length = key_length;
+    check->has_last = true;
+    return true;
+}
+
+static bool stop_after_two(const uint8_t *key, size_t key_length, void *value, void *user_data) {
+    (void)key;
+    (void)key_length;
+    (void)value;
+    return ++(*(int*)user_data) < 2;
+}
+
+/* Basic Operations Tests */
+START_TEST(test_art_insert_search) {
+    fi_art *tree = fi_art_create(sizeof(int));
+    ck_assert_ptr_nonnull(tree);
+    ck_assert(fi_art_empty(tree));
+
+    /* Keys that are prefixes of each other */
+    const char *keys[] = {"a", "ab", "abc", "abcd", "abd", "b", "", "bcdefghijklmnopqrstuvwxyz"};
+    for (int i = 0; i < 8; i++) {
+        ck_assert_int_eq(insert_string(tree, keys[i], i), 0);
+    }
+    ck_assert_uint_eq(fi_art_size(tree), 8);
+
+    for (int i = 0; i < 8; i++) {
+        int *value = search_string(tree, keys[i]);
+        ck_assert_ptr_nonnull(value);
+        ck_assert_int_eq(*value, i);
+    }
+    ck_assert_ptr_null(search_string(tree, "abce"));
+    ck_assert_ptr_null(search_string(tree, "bcdefghijklmnopqrstuvwxy"));
+    ck_assert_ptr_null(search_string(tree, "bcdefghijklmnopqrstuvwxyzz"));
+    ck_assert(!fi_art_contains(tree, (const uint8_t*)"c", 1));
+
+    /* Inserting an existing key replaces its value */
+    ck_assert_int_eq(insert_string(tree, "abc", 42), 0);
+    ck_assert_uint_eq(fi_art_size(tree), 8);
+    ck_assert_int_eq(*search_string(tree, "abc"), 42);
+
+    fi_art_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_art_node_growth) {
+    fi_art *tree = fi_art_create(sizeof(int));
+
+    /* 256 distinct bytes under one parent exercise every node size */
+    for (int i = 0; i < 256; i++) {
+        uint8_t key[2] = {'x', (uint8_t)i};
+        ck_assert_int_eq(fi_art_insert(tree, key, 2, &i), 0);
+    }
+    ck_assert_uint_eq(fi_art_size(tree), 256);
+    for (int i = 0; i < 256; i++) {
+        uint8_t key[2] = {'x', (uint8_t)i};
+        int *value = fi_art_search(tree, key, 2);
+        ck_assert_ptr_nonnull(value);
+        ck_assert_int_eq(*value, i);
+    }
+
+    /* Shrink back down through every node size */
+    for (int i = 0; i < 256; i += 2) {
+        uint8_t key[2] = {'x', (uint8_t)i};
+        ck_assert_int_eq(fi_art_delete(tree, key, 2), 0);
+    }
+    for (int i = 1; i < 250; i += 2) {
+        uint8_t key[2] = {'x', (uint8_t)i};
+        ck_assert_int_eq(fi_art_delete(tree, key, 2), 0);
+    }
+    ck_assert_uint_eq(fi_art_size(tree), 3);
+    for (int i = 0; i < 256; i++) {
+        uint8_t key[2] = {'x', (uint8_t)i};
+        ck_assert(fi_art_contains(tree, key, 2) == (i >= 250 && i % 2 == 1));
+    }
+
+    fi_art_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_art_delete) {
+    fi_art *tree = fi_art_create(sizeof(int));
+    const char *keys[] = {"romane", "romanus", "romulus", "rubens", "ruber", "rubicon", "rubicundus", "rub"};
+    for (int i = 0; i < 8; i++) {
+        insert_string(tree, keys[i], i);
+    }
+
+    ck_assert_int_eq(fi_art_delete(tree, (const uint8_t*)"ro", 2), -1);
+    ck_assert_int_eq(fi_art_delete(tree, (const uint8_t*)"rub", 3), 0);
+    ck_assert_int_eq(fi_art_delete(tree, (const uint8_t*)"rub", 3), -1);
+    ck_assert_ptr_null(search_string(tree, "rub"));
+    ck_assert_int_eq(*search_string(tree, "rubens"), 3);
+
+    for (int i = 0; i < 7; i++) {
+        ck_assert_int_eq(fi_art_delete(tree, (const uint8_t*)keys[i], strlen(keys[i])), 0);
+        for (int j = i + 1; j < 7; j++) {
+            ck_assert_int_eq(*search_string(tree, keys[j]), j);
+        }
+    }
+    ck_assert(fi_art_empty(tree));
+    ck_assert_ptr_null(tree->root);
+
+    fi_art_destroy(tree);
+}
+END_TEST
+
+/* Iteration Tests */
+START_TEST(test_art_prefix_iterate) {
+    fi_art *tree = fi_art_create(sizeof(int));
+    const char *keys[] = {"alice", "alicia", "alfred", "bob", "al", "alice.smith@example.com",
+                          "alice.jones@example.com", "zed"};
+    for (int i = 0; i < 8; i++) {
+        insert_string(tree, keys[i], i);
+    }
+
+    key_list list = {.count = 0};
+    ck_assert_uint_eq(fi_art_prefix_iterate(tree, (const uint8_t*)"ali", 3, collect_keys, &list), 4);
+    ck_assert_str_eq(list.keys[0], "alice");
+    ck_assert_str_eq(list.keys[1], "alice.jones@example.com");
+    ck_assert_str_eq(list.keys[2], "alice.smith@example.com");
+    ck_assert_str_eq(list.keys[3], "alicia");
+
+    /* Prefix ending inside a compressed path */
+    list.count = 0;
+    ck_assert_uint_eq(fi_art_prefix_iterate(tree, (const uint8_t*)"alice.s", 7, collect_keys, &list), 1);
+    ck_assert_str_eq(list.keys[0], "alice.smith@example.com");
+
+    list.count = 0;
+    ck_assert_uint_eq(fi_art_prefix_iterate(tree, (const uint8_t*)"al", 2, collect_keys, &list), 6);
+    ck_assert_str_eq(list.keys[0], "al");
+    ck_assert_uint_eq(fi_art_prefix_iterate(tree, (const uint8_t*)"alx", 3, collect_keys, &list), 0);
+    ck_assert_uint_eq(fi_art_prefix_iterate(tree, (const uint8_t*)"alice.smith@example.comx", 24,
+                                            collect_keys, &list), 0);
+
+    /* Empty prefix visits everything; visitors can stop early */
+    ck_assert_uint_eq(fi_art_prefix_iterate(tree, NULL, 0, collect_keys, &list), 8);
+    int seen = 0;
+    ck_assert_uint_eq(fi_art_iterate(tree, stop_after_two, &seen), 2);
+
+    fi_art_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_art_random_against_reference) {
+    fi_art *tree = fi_art_create(sizeof(int));
+    char present[2000] = {0};
+    char key[32];
+    srand(7);
+
+    for (int round = 0; round < 20000; round++) {
+        int id = rand() % 2000;
+        /* Long shared prefixes, varied lengths and some keys prefixing others */
+        int length = snprintf(key, sizeof(key), "https://host/%d", id);
+        if (id % 3 == 0) length = snprintf(key, sizeof(key), "%d", id);
+
+        if (rand() % 3) {
+            ck_assert_int_eq(fi_art_insert(tree, (const uint8_t*)key, length, &id), 0);
+            present[id] = 1;
+        } else {
+            ck_assert_int_eq(fi_art_delete(tree, (const uint8_t*)key, length), present[id] ? 0 : -1);
+            present[id] = 0;
+        }
+    }
+
+    size_t expected = 0;
+    for (int id = 0; id < 2000; id++) {
+        int length = id % 3 == 0 ? snprintf(key, sizeof(key), "%d", id)
+                                 : snprintf(key, sizeof(key), "https://host/%d", id);
+        int *value = fi_art_search(tree, (const uint8_t*)key, length);
+        ck_assert(!value == !present[id]);
+        if (value) {
+            ck_assert_int_eq(*value, id);
+            expected++;
+        }
+    }
+    ck_assert_uint_eq(fi_art_size(tree), expected);
+
+    order_check check = {.has_last = false};
+    ck_assert_uint_eq(fi_art_iterate(tree, check_order, &check), expected);
+
+    fi_art_clear(tree);
+    ck_assert(fi_art_empty(tree));
+    fi_art_destroy(tree);
+}
+END_TEST
+
+// Create test suite
+Suite *fi_art_suite(void) {
+    Suite *s;
+    TCase *tc_basic;
+    TCase *tc_iterate;
+
+    s = suite_create("fi_art");
+
+    // Basic operations test case
+    tc_basic = tcase_create("Basic Operations");
+    tcase_add_test(tc_basic, test_art_insert_search);
+    tcase_add_test(tc_basic, test_art_node_growth);
+    tcase_add_test(tc_basic, test_art_delete);
+    suite_add_tcase(s, tc_basic);
+
+    // Iteration test case
+    tc_iterate = tcase_create("Iteration");
+    tcase_add_test(tc_iterate, test_art_prefix_iterate);
+    tcase_add_test(tc_iterate, test_art_random_against_reference);
+    suite_add_tcase(s, tc_iterate);
+
+    return s;
+}
+
+// Main function
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = fi_art_suite();
+    sr = srunner_create(s);
+
+    // Run tests
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
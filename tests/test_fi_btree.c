@@ -1,26 +1,388 @@
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../src/include/fi.h"
+#include "../src/include/fi_btree.h"
 
-// Test: Example test case for fi_btree
-START_TEST(test_example) {
-    // TODO: Add your test implementation
-    ck_assert_int_eq(1, 1);
+/* Helper functions for testing */
+static int int_compare(const void *a, const void *b) {
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
+}
+
+static int long_compare(const void *a, const void *b) {
+    long la = *(const long*)a;
+    long lb = *(const long*)b;
+    return (la > lb) - (la < lb);
+}
+
+static void collect_int(void *data, size_t depth, void *user_data) {
+    (void)depth;
+    fi_array *out = (fi_array*)user_data;
+    fi_array_push(out, data);
+}
+
+/* Basic Operations Tests */
+START_TEST(test_btree_insert_search) {
+    fi_btree *tree = fi_btree_create(sizeof(int), int_compare);
+    ck_assert_ptr_nonnull(tree);
+
+    int values[] = {50, 30, 70, 20, 40, 60, 80};
+    for (int i = 0; i < 7; i++) {
+        ck_assert_int_eq(fi_btree_insert(tree, &values[i]), 0);
+    }
+    ck_assert_uint_eq(fi_btree_size(tree), 7);
+    ck_assert(fi_btree_is_bst(tree));
+
+    int key = 60;
+    fi_btree_node *node = fi_btree_search(tree, &key);
+    ck_assert_ptr_nonnull(node);
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(node), 60);
+
+    key = 65;
+    ck_assert_ptr_null(fi_btree_search(tree, &key));
+
+    /* Duplicates replace the existing element */
+    key = 40;
+    ck_assert_int_eq(fi_btree_insert(tree, &key), 0);
+    ck_assert_uint_eq(fi_btree_size(tree), 7);
+
+    fi_btree_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_btree_delete_inorder) {
+    fi_btree *tree = fi_btree_create(sizeof(int), int_compare);
+    int values[] = {50, 30, 70, 20, 40, 60, 80};
+    for (int i = 0; i < 7; i++) {
+        fi_btree_insert(tree, &values[i]);
+    }
+
+    int key = 50;  /* Node with two children */
+    ck_assert_int_eq(fi_btree_delete(tree, &key), 0);
+    key = 20;      /* Leaf */
+    ck_assert_int_eq(fi_btree_delete(tree, &key), 0);
+    key = 99;
+    ck_assert_int_eq(fi_btree_delete(tree, &key), -1);
+    ck_assert_uint_eq(fi_btree_size(tree), 5);
+    ck_assert(fi_btree_is_bst(tree));
+
+    fi_array *out = fi_array_create(8, sizeof(int));
+    fi_btree_inorder(tree, collect_int, out);
+    int expected[] = {30, 40, 60, 70, 80};
+    ck_assert_uint_eq(fi_array_count(out), 5);
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(*(int*)fi_array_get(out, i), expected[i]);
+    }
+
+    fi_array_destroy(out);
+    fi_btree_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_btree_from_sorted_array) {
+    fi_array *arr = fi_array_create(16, sizeof(int));
+    for (int i = 0; i < 15; i++) {
+        fi_array_push(arr, &i);
+    }
+
+    fi_btree *tree = fi_btree_from_sorted_array(arr, int_compare);
+    ck_assert_ptr_nonnull(tree);
+    ck_assert_uint_eq(fi_btree_size(tree), 15);
+    ck_assert_uint_eq(fi_btree_height(tree), 4);
+    ck_assert(fi_btree_is_bst(tree));
+
+    /* Single element arrays must not underflow the range */
+    fi_array *one = fi_array_create(1, sizeof(int));
+    int v = 7;
+    fi_array_push(one, &v);
+    fi_btree *single = fi_btree_from_sorted_array(one, int_compare);
+    ck_assert_ptr_nonnull(single);
+    ck_assert_uint_eq(fi_btree_size(single), 1);
+
+    fi_btree_destroy(single);
+    fi_array_destroy(one);
+    fi_btree_destroy(tree);
+    fi_array_destroy(arr);
+}
+END_TEST
+
+START_TEST(test_btree_bounds) {
+    fi_btree *tree = fi_btree_create(sizeof(int), int_compare);
+    for (int i = 0; i < 100; i += 10) {
+        fi_btree_insert(tree, &i);
+    }
+
+    int key = 35;
+    fi_btree_node *node = fi_btree_lower_bound(tree, &key);
+    ck_assert_ptr_nonnull(node);
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(node), 40);
+
+    key = 40;
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(fi_btree_lower_bound(tree, &key)), 40);
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(fi_btree_upper_bound(tree, &key)), 50);
+
+    key = -5;
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(fi_btree_lower_bound(tree, &key)), 0);
+    key = 90;
+    ck_assert_ptr_null(fi_btree_upper_bound(tree, &key));
+
+    /* Walk the half-open range [20, 60) */
+    int from = 20, to = 60, sum = 0;
+    for (node = fi_btree_lower_bound(tree, &from);
+         node && int_compare(FI_BTREE_NODE_DATA(node), &to) < 0;
+         node = fi_btree_successor(node)) {
+        sum += *(int*)FI_BTREE_NODE_DATA(node);
+    }
+    ck_assert_int_eq(sum, 20 + 30 + 40 + 50);
+
+    fi_btree_destroy(tree);
+}
+END_TEST
+
+/* Set Operations Tests */
+static fi_btree *range_tree(int from, int to, int step) {
+    fi_btree *tree = fi_btree_create(sizeof(int), int_compare);
+    for (int i = from; i < to; i += step) {
+        fi_btree_insert(tree, &i);
+    }
+    return tree;
+}
+
+static bool push_emit(const void *data, void *user_data) {
+    return fi_array_push((fi_array*)user_data, data) == 0;
+}
+
+static bool count_emit(const void *data, void *user_data) {
+    (void)data;
+    return ++(*(int*)user_data) < 3;
+}
+
+START_TEST(test_btree_set_operations) {
+    fi_btree *evens = range_tree(0, 100, 2);
+    fi_btree *threes = range_tree(0, 100, 3);
+
+    fi_btree *both = fi_btree_intersect(evens, threes);
+    ck_assert_ptr_nonnull(both);
+    ck_assert_uint_eq(fi_btree_size(both), 17);
+    ck_assert(fi_btree_is_bst(both));
+    ck_assert_uint_le(fi_btree_height(both), 5);
+    for (int i = 0; i < 100; i++) {
+        ck_assert(fi_btree_contains(both, &i) == (i % 6 == 0));
+    }
+
+    fi_btree *either = fi_btree_union(evens, threes);
+    ck_assert_uint_eq(fi_btree_size(either), 50 + 34 - 17);
+    ck_assert(fi_btree_is_bst(either));
+
+    fi_btree *only_evens = fi_btree_difference(evens, threes);
+    ck_assert_uint_eq(fi_btree_size(only_evens), 50 - 17);
+    for (int i = 0; i < 100; i++) {
+        ck_assert(fi_btree_contains(only_evens, &i) == (i % 2 == 0 && i % 3 != 0));
+    }
+
+    /* Empty operands */
+    fi_btree *empty = fi_btree_create(sizeof(int), int_compare);
+    fi_btree *none = fi_btree_intersect(evens, empty);
+    ck_assert_ptr_nonnull(none);
+    ck_assert(fi_btree_empty(none));
+    fi_btree *same = fi_btree_difference(evens, empty);
+    ck_assert_uint_eq(fi_btree_size(same), 50);
+
+    /* Streamed results stop when the callback says so */
+    int seen = 0;
+    ck_assert_uint_eq(fi_btree_merge(evens, threes, FI_BTREE_SET_UNION, count_emit, &seen), 3);
+
+    fi_btree_destroy(both);
+    fi_btree_destroy(either);
+    fi_btree_destroy(only_evens);
+    fi_btree_destroy(none);
+    fi_btree_destroy(same);
+    fi_btree_destroy(empty);
+    fi_btree_destroy(evens);
+    fi_btree_destroy(threes);
+}
+END_TEST
+
+START_TEST(test_btree_merge_array) {
+    fi_btree *tree = range_tree(0, 20, 1);
+    fi_array *sorted = fi_array_create(8, sizeof(int));
+    int values[] = {-4, 3, 3, 3, 7, 19, 25, 25};
+    for (int i = 0; i < 8; i++) {
+        fi_array_push(sorted, &values[i]);
+    }
+
+    /* Duplicate runs in the array count once */
+    fi_array *out = fi_array_create(8, sizeof(int));
+    ck_assert_uint_eq(fi_btree_merge_array(tree, sorted, FI_BTREE_SET_INTERSECT,
+                                           push_emit, out), 3);
+    ck_assert_int_eq(*(int*)fi_array_get(out, 0), 3);
+    ck_assert_int_eq(*(int*)fi_array_get(out, 1), 7);
+    ck_assert_int_eq(*(int*)fi_array_get(out, 2), 19);
+
+    ck_assert_uint_eq(fi_btree_merge_array(tree, sorted, FI_BTREE_SET_UNION, NULL, NULL), 22);
+    ck_assert_uint_eq(fi_btree_merge_array(tree, sorted, FI_BTREE_SET_DIFFERENCE, NULL, NULL), 17);
+
+    fi_array_destroy(out);
+    fi_array_destroy(sorted);
+    fi_btree_destroy(tree);
+}
+END_TEST
+
+/* Node Pool Tests */
+START_TEST(test_btree_inline_data) {
+    fi_btree *tree = fi_btree_create(sizeof(int), int_compare);
+    int key = 42;
+    fi_btree_insert(tree, &key);
+
+    /* The header is the three links; element bytes follow it */
+    ck_assert_uint_eq(sizeof(fi_btree_node), 3 * sizeof(void*));
+    fi_btree_node *node = fi_btree_search(tree, &key);
+    ck_assert_ptr_nonnull(node);
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(node), 42);
+    ck_assert_uint_eq((uintptr_t)FI_BTREE_NODE_DATA(node) % sizeof(void*), 0);
+
+    fi_btree_node *standalone = fi_btree_create_node(&key, sizeof(int));
+    ck_assert_ptr_nonnull(standalone);
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(standalone), 42);
+    fi_btree_destroy_node(standalone);
+
+    fi_btree_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_btree_pool_reuse) {
+    fi_btree *tree = fi_btree_create(sizeof(int), int_compare);
+    for (int i = 0; i < 1000; i++) {
+        int v = (i * 7919) % 1000;
+        fi_btree_insert(tree, &v);
+    }
+    ck_assert_uint_eq(fi_btree_size(tree), 1000);
+    size_t usage = fi_btree_memory_usage(tree);
+
+    /* Deleted nodes are recycled, so churn does not grow the pool */
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 500; i++) {
+            fi_btree_delete(tree, &i);
+        }
+        for (int i = 0; i < 500; i++) {
+            fi_btree_insert(tree, &i);
+        }
+    }
+    ck_assert_uint_eq(fi_btree_size(tree), 1000);
+    ck_assert_uint_eq(fi_btree_memory_usage(tree), usage);
+    ck_assert(fi_btree_is_bst(tree));
+
+    /* Clearing keeps the slabs around for the next fill */
+    fi_btree_clear(tree);
+    ck_assert_uint_eq(fi_btree_size(tree), 0);
+    for (int i = 0; i < 1000; i++) {
+        fi_btree_insert(tree, &i);
+    }
+    ck_assert_uint_eq(fi_btree_memory_usage(tree), usage);
+
+    fi_btree_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_btree_reserve) {
+    fi_btree *tree = fi_btree_create(sizeof(long), long_compare);
+    ck_assert_int_eq(fi_btree_reserve(tree, 10000), 0);
+    size_t usage = fi_btree_memory_usage(tree);
+
+    for (int i = 0; i < 10000; i++) {
+        long v = i;
+        fi_btree_insert(tree, &v);
+    }
+    ck_assert_uint_eq(fi_btree_memory_usage(tree), usage);
+    /* One node per key plus a little slab overhead */
+    ck_assert_uint_lt(usage, 10000 * (sizeof(fi_btree_node) + sizeof(long)) + 256);
+
+    ck_assert_int_eq(fi_btree_reserve(NULL, 1), -1);
+    fi_btree_destroy(tree);
+}
+END_TEST
+
+/* Balancing Tests */
+START_TEST(test_btree_sorted_inserts_stay_balanced) {
+    fi_btree *tree = fi_btree_create(sizeof(int), int_compare);
+    const int n = 100000;
+
+    /* log_{3/2}(100000) ~ 28.4, so no node may sit below depth 29 */
+    for (int i = 0; i < n; i++) {
+        ck_assert_int_eq(fi_btree_insert(tree, &i), 0);
+    }
+    ck_assert_uint_eq(fi_btree_size(tree), n);
+    ck_assert_uint_le(fi_btree_height(tree), 30);
+    ck_assert(fi_btree_is_bst(tree));
+
+    for (int i = 2 * n; i > n; i--) {
+        ck_assert_int_eq(fi_btree_insert(tree, &i), 0);
+    }
+    ck_assert_uint_le(fi_btree_height(tree), 31);
+    ck_assert(fi_btree_is_bst(tree));
+
+    /* Deleting the low half rebuilds instead of leaving a long spine */
+    for (int i = 0; i < n; i++) {
+        ck_assert_int_eq(fi_btree_delete(tree, &i), 0);
+    }
+    ck_assert_uint_eq(fi_btree_size(tree), n);
+    ck_assert_uint_le(fi_btree_height(tree), 30);
+    ck_assert(fi_btree_is_bst(tree));
+
+    int key = n + 1;
+    fi_btree_node *node = fi_btree_find_min(tree->root);
+    ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(node), key);
+    for (int i = 1; i < n; i++) {
+        node = fi_btree_successor(node);
+        ck_assert_ptr_nonnull(node);
+        ck_assert_int_eq(*(int*)FI_BTREE_NODE_DATA(node), key + i);
+    }
+    ck_assert_ptr_null(fi_btree_successor(node));
+
+    fi_btree_destroy(tree);
 }
 END_TEST
 
 // Create test suite
 Suite *fi_btree_suite(void) {
     Suite *s;
-    TCase *tc_core;
-    
+    TCase *tc_basic;
+    TCase *tc_sets;
+    TCase *tc_pool;
+    TCase *tc_balance;
+
     s = suite_create("fi_btree");
-    
-    // Core test case
-    tc_core = tcase_create("Core");
-    tcase_add_test(tc_core, test_example);
-    suite_add_tcase(s, tc_core);
-    
+
+    // Basic operations test case
+    tc_basic = tcase_create("Basic Operations");
+    tcase_add_test(tc_basic, test_btree_insert_search);
+    tcase_add_test(tc_basic, test_btree_delete_inorder);
+    tcase_add_test(tc_basic, test_btree_from_sorted_array);
+    tcase_add_test(tc_basic, test_btree_bounds);
+    suite_add_tcase(s, tc_basic);
+
+    // Set operations test case
+    tc_sets = tcase_create("Set Operations");
+    tcase_add_test(tc_sets, test_btree_set_operations);
+    tcase_add_test(tc_sets, test_btree_merge_array);
+    suite_add_tcase(s, tc_sets);
+
+    // Node pool test case
+    tc_pool = tcase_create("Node Pool");
+    tcase_add_test(tc_pool, test_btree_inline_data);
+    tcase_add_test(tc_pool, test_btree_pool_reuse);
+    tcase_add_test(tc_pool, test_btree_reserve);
+    suite_add_tcase(s, tc_pool);
+
+    // Balancing test case
+    tc_balance = tcase_create("Balancing");
+    tcase_add_test(tc_balance, test_btree_sorted_inserts_stay_balanced);
+    suite_add_tcase(s, tc_balance);
+
     return s;
 }
 
@@ -29,14 +391,14 @@ int main(void) {
     int number_failed;
     Suite *s;
     SRunner *sr;
-    
+
     s = fi_btree_suite();
     sr = srunner_create(s);
-    
+
     // Run tests
     srunner_run_all(sr, CK_NORMAL);
     number_failed = srunner_ntests_failed(sr);
     srunner_free(sr);
-    
+
     return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
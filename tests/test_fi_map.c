@@ -147,6 +147,40 @@ START_TEST(test_map_remove_nonexistent) {
 }
 END_TEST
 
+START_TEST(test_map_remove_keeps_probe_chains) {
+    fi_map *map = fi_map_create(16, sizeof(int64_t), sizeof(int64_t), 
+                               fi_map_hash_int64, fi_map_compare_int64);
+    char present[500] = {0};
+    srand(5);
+    
+    /* Colliding keys must stay reachable after entries before them are removed */
+    for (int round = 0; round < 20000; round++) {
+        int64_t key = rand() % 500;
+        int64_t value = key * 7;
+        if (rand() % 2) {
+            ck_assert_int_eq(fi_map_put(map, &key, &value), 0);
+            present[key] = 1;
+        } else {
+            ck_assert_int_eq(fi_map_remove(map, &key), present[key] ? 0 : -1);
+            present[key] = 0;
+        }
+    }
+    
+    size_t expected = 0;
+    for (int64_t key = 0; key < 500; key++) {
+        int64_t value = 0;
+        ck_assert_int_eq(fi_map_get(map, &key, &value), present[key] ? 0 : -1);
+        if (present[key]) {
+            ck_assert_int_eq(value, key * 7);
+            expected++;
+        }
+    }
+    ck_assert_uint_eq(fi_map_size(map), expected);
+    
+    fi_map_destroy(map);
+}
+END_TEST
+
 START_TEST(test_map_clear) {
     fi_map *map = fi_map_create(10, sizeof(int), sizeof(int), 
                                fi_map_hash_int32, fi_map_compare_int32);
@@ -849,6 +883,7 @@ Suite *fi_map_suite(void) {
     tcase_add_test(tc_basic, test_map_put_update);
     tcase_add_test(tc_basic, test_map_remove);
     tcase_add_test(tc_basic, test_map_remove_nonexistent);
+    tcase_add_test(tc_basic, test_map_remove_keeps_probe_chains);
     tcase_add_test(tc_basic, test_map_clear);
     suite_add_tcase(s, tc_basic);
     
@@ -0,0 +1,237 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../src/include/fi.h"
+#include "../src/include/fi_ptree.h"
+
+/* Helper functions for testing */
+static int int_compare(const void *a, const void *b) {
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
+}
+
+/* Check ordering and AVL balance of a subtree, return its height */
+static int check_subtree(fi_ptree_node *node, const int *min, const int *max) {
+    if (!node) return 0;
+
+    int value = *(int*)FI_PTREE_NODE_DATA(node);
+    if (min && value <= *min) return -1;
+    if (max && value >= *max) return -1;
+
+    int lh = check_subtree(node->left, min, &value);
+    int rh = check_subtree(node->right, &value, max);
+    if (lh < 0 || rh < 0 || lh - rh > 1 || rh - lh > 1) return -1;
+
+    int h = (lh > rh ? lh : rh) + 1;
+    return h == node->height ? h : -1;
+}
+
+static bool sum_visit(void *data, void *user_data) {
+    *(long*)user_data += *(int*)data;
+    return true;
+}
+
+/* Basic Operations Tests */
+START_TEST(test_ptree_insert_find) {
+    fi_ptree *tree = fi_ptree_create(sizeof(int), int_compare);
+    ck_assert_ptr_nonnull(tree);
+
+    for (int i = 0; i < 1000; i++) {
+        ck_assert_int_eq(fi_ptree_insert(tree, &i), 0);
+    }
+    ck_assert_uint_eq(fi_ptree_size(tree), 1000);
+    ck_assert_uint_eq(fi_ptree_version(tree), 1000);
+    ck_assert_int_ge(check_subtree(tree->root, NULL, NULL), 0);
+    /* Sequential inserts stay balanced */
+    ck_assert_int_le(tree->root->height, 11);
+
+    int key = 500, out = -1;
+    ck_assert_int_eq(fi_ptree_find(tree, &key, &out), 0);
+    ck_assert_int_eq(out, 500);
+    key = 5000;
+    ck_assert(!fi_ptree_contains(tree, &key));
+
+    /* Duplicates replace without growing the tree */
+    key = 10;
+    ck_assert_int_eq(fi_ptree_insert(tree, &key), 0);
+    ck_assert_uint_eq(fi_ptree_size(tree), 1000);
+
+    fi_ptree_destroy(tree);
+}
+END_TEST
+
+START_TEST(test_ptree_delete) {
+    fi_ptree *tree = fi_ptree_create(sizeof(int), int_compare);
+    for (int i = 0; i < 500; i++) {
+        int v = (i * 37) % 500;
+        fi_ptree_insert(tree, &v);
+    }
+
+    for (int i = 0; i < 500; i += 3) {
+        ck_assert_int_eq(fi_ptree_delete(tree, &i), 0);
+        ck_assert_int_ge(check_subtree(tree->root, NULL, NULL), 0);
+    }
+    int missing = 0;
+    ck_assert_int_eq(fi_ptree_delete(tree, &missing), -1);
+    ck_assert_uint_eq(fi_ptree_size(tree), 333);
+
+    for (int i = 0; i < 500; i++) {
+        ck_assert(fi_ptree_contains(tree, &i) == (i % 3 != 0));
+    }
+
+    fi_ptree_destroy(tree);
+}
+END_TEST
+
+/* Snapshot Tests */
+START_TEST(test_ptree_snapshot_isolation) {
+    fi_ptree *tree = fi_ptree_create(sizeof(int), int_compare);
+    for (int i = 0; i < 100; i++) {
+        fi_ptree_insert(tree, &i);
+    }
+
+    fi_ptree_snapshot *snap = fi_ptree_snapshot_acquire(tree);
+    ck_assert_ptr_nonnull(snap);
+    ck_assert_uint_eq(snap->version, 100);
+
+    /* Writers continue after the snapshot is taken */
+    for (int i = 0; i < 50; i++) {
+        fi_ptree_delete(tree, &i);
+    }
+    for (int i = 100; i < 200; i++) {
+        fi_ptree_insert(tree, &i);
+    }
+    ck_assert_uint_eq(fi_ptree_size(tree), 150);
+
+    /* The snapshot still sees exactly the original 100 elements */
+    ck_assert_uint_eq(fi_ptree_snapshot_size(snap), 100);
+    fi_array *arr = fi_ptree_snapshot_to_array(snap);
+    ck_assert_uint_eq(fi_array_count(arr), 100);
+    for (int i = 0; i < 100; i++) {
+        ck_assert_int_eq(*(int*)fi_array_get(arr, i), i);
+    }
+    int key = 150, out;
+    ck_assert_int_eq(fi_ptree_snapshot_find(snap, &key, &out), -1);
+    fi_array_destroy(arr);
+
+    /* Range over [10, 20) */
+    int from = 10, to = 20;
+    long sum = 0;
+    ck_assert_uint_eq(fi_ptree_snapshot_range(snap, &from, &to, sum_visit, &sum), 10);
+    ck_assert_int_eq(sum, 145);
+
+    /* Snapshots outlive the tree */
+    fi_ptree_destroy(tree);
+    ck_assert_int_ge(check_subtree(snap->root, NULL, NULL), 0);
+    fi_ptree_snapshot_release(snap);
+}
+END_TEST
+
+START_TEST(test_ptree_structural_sharing) {
+    fi_ptree *tree = fi_ptree_create(sizeof(int), int_compare);
+    for (int i = 0; i < 1024; i++) {
+        fi_ptree_insert(tree, &i);
+    }
+
+    fi_ptree_snapshot *before = fi_ptree_snapshot_acquire(tree);
+    int key = 2000;
+    fi_ptree_insert(tree, &key);
+    fi_ptree_snapshot *after = fi_ptree_snapshot_acquire(tree);
+
+    /* Only the rightmost path was copied; the left subtree is shared */
+    ck_assert_ptr_ne(before->root, after->root);
+    ck_assert_ptr_eq(before->root->left, after->root->left);
+
+    fi_ptree_snapshot_release(before);
+    fi_ptree_snapshot_release(after);
+    fi_ptree_destroy(tree);
+}
+END_TEST
+
+typedef struct {
+    fi_ptree *tree;
+    int failures;
+} reader_args;
+
+static void *snapshot_reader(void *arg) {
+    reader_args *args = (reader_args*)arg;
+    for (int round = 0; round < 200; round++) {
+        fi_ptree_snapshot *snap = fi_ptree_snapshot_acquire(args->tree);
+        fi_array *arr = fi_ptree_snapshot_to_array(snap);
+        if (fi_array_count(arr) != snap->count) args->failures++;
+        for (size_t i = 1; i < fi_array_count(arr); i++) {
+            if (*(int*)fi_array_get(arr, i - 1) >= *(int*)fi_array_get(arr, i)) args->failures++;
+        }
+        fi_array_destroy(arr);
+        fi_ptree_snapshot_release(snap);
+    }
+    return NULL;
+}
+
+START_TEST(test_ptree_concurrent_snapshots) {
+    fi_ptree *tree = fi_ptree_create(sizeof(int), int_compare);
+    pthread_t readers[3];
+    reader_args args[3];
+
+    for (int r = 0; r < 3; r++) {
+        args[r].tree = tree;
+        args[r].failures = 0;
+        pthread_create(&readers[r], NULL, snapshot_reader, &args[r]);
+    }
+    for (int i = 0; i < 5000; i++) {
+        int v = (i * 7919) % 5000;
+        fi_ptree_insert(tree, &v);
+        if (i % 3 == 0) fi_ptree_delete(tree, &v);
+    }
+    for (int r = 0; r < 3; r++) {
+        pthread_join(readers[r], NULL);
+        ck_assert_int_eq(args[r].failures, 0);
+    }
+
+    fi_ptree_destroy(tree);
+}
+END_TEST
+
+// Create test suite
+Suite *fi_ptree_suite(void) {
+    Suite *s;
+    TCase *tc_basic;
+    TCase *tc_snapshot;
+
+    s = suite_create("fi_ptree");
+
+    // Basic operations test case
+    tc_basic = tcase_create("Basic Operations");
+    tcase_add_test(tc_basic, test_ptree_insert_find);
+    tcase_add_test(tc_basic, test_ptree_delete);
+    suite_add_tcase(s, tc_basic);
+
+    // Snapshot test case
+    tc_snapshot = tcase_create("Snapshots");
+    tcase_add_test(tc_snapshot, test_ptree_snapshot_isolation);
+    tcase_add_test(tc_snapshot, test_ptree_structural_sharing);
+    tcase_add_test(tc_snapshot, test_ptree_concurrent_snapshots);
+    suite_add_tcase(s, tc_snapshot);
+
+    return s;
+}
+
+// Main function
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = fi_ptree_suite();
+    sr = srunner_create(s);
+
+    // Run tests
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
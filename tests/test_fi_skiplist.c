@@ -0,0 +1,249 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../src/include/fi.h"
+#include "../src/include/fi_skiplist.h"
+
+#define THREAD_COUNT 4
+#define KEYS_PER_THREAD 5000
+
+/* Helper functions for testing */
+static int int_compare(const void *a, const void *b) {
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    return (ia > ib) - (ia < ib);
+}
+
+static bool sum_visit(void *data, void *user_data) {
+    *(long*)user_data += *(int*)data;
+    return true;
+}
+
+static bool stop_after_three(void *data, void *user_data) {
+    (void)data;
+    int *seen = (int*)user_data;
+    return ++(*seen) < 3;
+}
+
+typedef struct {
+    fi_skiplist *list;
+    int base;
+} worker_args;
+
+static void *insert_worker(void *arg) {
+    worker_args *args = (worker_args*)arg;
+    for (int i = 0; i < KEYS_PER_THREAD; i++) {
+        int key = args->base + i;
+        fi_skiplist_insert(args->list, &key);
+    }
+    return NULL;
+}
+
+static void *remove_odd_worker(void *arg) {
+    worker_args *args = (worker_args*)arg;
+    for (int i = 1; i < KEYS_PER_THREAD; i += 2) {
+        int key = args->base + i;
+        fi_skiplist_remove(args->list, &key);
+    }
+    return NULL;
+}
+
+static void *reader_worker(void *arg) {
+    worker_args *args = (worker_args*)arg;
+    long sum = 0;
+    for (int round = 0; round < 50; round++) {
+        fi_skiplist_range(args->list, NULL, NULL, sum_visit, &sum);
+    }
+    return NULL;
+}
+
+/* Basic Operations Tests */
+START_TEST(test_skiplist_insert_contains) {
+    fi_skiplist *list = fi_skiplist_create(sizeof(int), int_compare);
+    ck_assert_ptr_nonnull(list);
+    ck_assert(fi_skiplist_empty(list));
+
+    int values[] = {50, 30, 70, 20, 40, 60, 80};
+    for (int i = 0; i < 7; i++) {
+        ck_assert_int_eq(fi_skiplist_insert(list, &values[i]), 0);
+    }
+    ck_assert_uint_eq(fi_skiplist_size(list), 7);
+
+    int key = 40;
+    ck_assert_int_eq(fi_skiplist_insert(list, &key), 1);
+    ck_assert_uint_eq(fi_skiplist_size(list), 7);
+    ck_assert(fi_skiplist_contains(list, &key));
+
+    int out = 0;
+    ck_assert_int_eq(fi_skiplist_find(list, &key, &out), 0);
+    ck_assert_int_eq(out, 40);
+
+    key = 45;
+    ck_assert(!fi_skiplist_contains(list, &key));
+    ck_assert_int_eq(fi_skiplist_find(list, &key, &out), -1);
+
+    fi_skiplist_destroy(list);
+}
+END_TEST
+
+START_TEST(test_skiplist_remove_order) {
+    fi_skiplist *list = fi_skiplist_create(sizeof(int), int_compare);
+    for (int i = 100; i > 0; i--) {
+        fi_skiplist_insert(list, &i);
+    }
+
+    for (int i = 2; i <= 100; i += 2) {
+        ck_assert_int_eq(fi_skiplist_remove(list, &i), 0);
+    }
+    int missing = 2;
+    ck_assert_int_eq(fi_skiplist_remove(list, &missing), -1);
+    ck_assert_uint_eq(fi_skiplist_size(list), 50);
+
+    fi_array *arr = fi_skiplist_to_array(list);
+    ck_assert_uint_eq(fi_array_count(arr), 50);
+    for (size_t i = 0; i < fi_array_count(arr); i++) {
+        ck_assert_int_eq(*(int*)fi_array_get(arr, i), (int)(2 * i + 1));
+    }
+
+    fi_array_destroy(arr);
+    fi_skiplist_reclaim(list);
+    fi_skiplist_destroy(list);
+}
+END_TEST
+
+START_TEST(test_skiplist_range) {
+    fi_skiplist *list = fi_skiplist_create(sizeof(int), int_compare);
+    for (int i = 0; i < 100; i++) {
+        fi_skiplist_insert(list, &i);
+    }
+
+    int from = 10, to = 20;
+    long sum = 0;
+    ck_assert_uint_eq(fi_skiplist_range(list, &from, &to, sum_visit, &sum), 10);
+    ck_assert_int_eq(sum, 145);
+
+    /* Early termination */
+    int seen = 0;
+    ck_assert_uint_eq(fi_skiplist_range(list, &from, NULL, stop_after_three, &seen), 3);
+
+    fi_skiplist_destroy(list);
+}
+END_TEST
+
+/* Concurrency Tests */
+START_TEST(test_skiplist_concurrent_insert) {
+    fi_skiplist *list = fi_skiplist_create(sizeof(int), int_compare);
+    pthread_t threads[THREAD_COUNT];
+    worker_args args[THREAD_COUNT];
+
+    /* Each writer fills its own key range */
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        args[t].list = list;
+        args[t].base = t * KEYS_PER_THREAD;
+        pthread_create(&threads[t], NULL, insert_worker, &args[t]);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    ck_assert_uint_eq(fi_skiplist_size(list), THREAD_COUNT * KEYS_PER_THREAD);
+
+    /* Overlapping inserts of the same keys must not duplicate */
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        args[t].base = 0;
+        pthread_create(&threads[t], NULL, insert_worker, &args[t]);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    ck_assert_uint_eq(fi_skiplist_size(list), THREAD_COUNT * KEYS_PER_THREAD);
+
+    fi_array *arr = fi_skiplist_to_array(list);
+    for (size_t i = 0; i < fi_array_count(arr); i++) {
+        ck_assert_int_eq(*(int*)fi_array_get(arr, i), (int)i);
+    }
+
+    fi_array_destroy(arr);
+    fi_skiplist_destroy(list);
+}
+END_TEST
+
+START_TEST(test_skiplist_concurrent_remove_and_read) {
+    fi_skiplist *list = fi_skiplist_create(sizeof(int), int_compare);
+    pthread_t writers[THREAD_COUNT];
+    pthread_t readers[2];
+    worker_args args[THREAD_COUNT];
+
+    for (int i = 0; i < THREAD_COUNT * KEYS_PER_THREAD; i++) {
+        fi_skiplist_insert(list, &i);
+    }
+
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        args[t].list = list;
+        args[t].base = t * KEYS_PER_THREAD;
+    }
+
+    for (int r = 0; r < 2; r++) {
+        pthread_create(&readers[r], NULL, reader_worker, &args[0]);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_create(&writers[t], NULL, remove_odd_worker, &args[t]);
+    }
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_join(writers[t], NULL);
+    }
+    for (int r = 0; r < 2; r++) {
+        pthread_join(readers[r], NULL);
+    }
+
+    ck_assert_uint_eq(fi_skiplist_size(list), THREAD_COUNT * KEYS_PER_THREAD / 2);
+    for (int i = 0; i < THREAD_COUNT * KEYS_PER_THREAD; i++) {
+        ck_assert(fi_skiplist_contains(list, &i) == (i % 2 == 0));
+    }
+
+    fi_skiplist_reclaim(list);
+    fi_skiplist_destroy(list);
+}
+END_TEST
+
+// Create test suite
+Suite *fi_skiplist_suite(void) {
+    Suite *s;
+    TCase *tc_basic;
+    TCase *tc_concurrent;
+
+    s = suite_create("fi_skiplist");
+
+    // Basic operations test case
+    tc_basic = tcase_create("Basic Operations");
+    tcase_add_test(tc_basic, test_skiplist_insert_contains);
+    tcase_add_test(tc_basic, test_skiplist_remove_order);
+    tcase_add_test(tc_basic, test_skiplist_range);
+    suite_add_tcase(s, tc_basic);
+
+    // Concurrency test case
+    tc_concurrent = tcase_create("Concurrency");
+    tcase_add_test(tc_concurrent, test_skiplist_concurrent_insert);
+    tcase_add_test(tc_concurrent, test_skiplist_concurrent_remove_and_read);
+    suite_add_tcase(s, tc_concurrent);
+
+    return s;
+}
+
+// Main function
+int main(void) {
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    s = fi_skiplist_suite();
+    sr = srunner_create(s);
+
+    // Run tests
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}